@@ -4,6 +4,7 @@
 #include "unity/unity.h"
 #include "unity/unity_hw_setup.h"
 #include "test_runner.h"
+#include "sam3x8e/wdt.h"
 
 int main(void) {
 	// basic initialization of hardware and UART communication.
@@ -11,4 +12,11 @@ int main(void) {
 
 	// run unit tests
 	run_tests();
+
+#if UNITY_TEST_TIMEOUT_MS
+	// keep the watchdog from running the tests again
+	for (;;) {
+		wdt_restart();
+	}
+#endif
 }
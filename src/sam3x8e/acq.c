@@ -0,0 +1,186 @@
+/*
+ * acq.c
+ *
+ * Date:	14 October 2026
+ */
+
+#include <string.h>
+#include "acq.h"
+
+uint8_t acq_add(acq_t *acq, acq_sensor_t *sensor, uint32_t now) {
+	uint32_t frame = sensor->length;
+
+	if (sensor->spi) {
+		frame += sensor->address_length;
+	}
+	if ((sensor->twi == 0) == (sensor->spi == 0) ||
+		sensor->address_length > 3 || sensor->length == 0 ||
+		frame > ACQ_MAX_FRAME || sensor->period == 0 || sensor->out == 0 ||
+		ACQ_RECORD_SIZE(sensor->length) > sensor->out->mask + 1) {
+		return 0;
+	}
+	sensor->stats.samples = 0;
+	sensor->stats.skipped = 0;
+	sensor->stats.errors = 0;
+	sensor->stats.dropped = 0;
+	sensor->due = now;
+	sensor->busy = 0;
+	sensor->next = acq->sensors;
+	acq->sensors = sensor;
+	return 1;
+}
+
+void acq_remove(acq_t *acq, acq_sensor_t *sensor) {
+	acq_sensor_t **link;
+
+	for (link = &acq->sensors; *link; link = &(*link)->next) {
+		if (*link == sensor) {
+			*link = sensor->next;
+			return;
+		}
+	}
+}
+
+/*
+ * Queues the read of a sensor. With SPI the address goes out first and the
+ * data is received over the 0xFF bytes after it, in the same frame.
+ */
+static uint8_t acq_queue(acq_sensor_t *s) {
+	spi_transaction_t *spi = &s->transaction.spi;
+	twi_transaction_t *twi = &s->transaction.twi;
+	uint32_t i;
+
+	if (s->twi) {
+		twi->packet.chip = s->device;
+		twi->packet.address = s->address;
+		twi->packet.address_length = s->address_length;
+		twi->packet.buffer = s->frame;
+		twi->packet.length = s->length;
+		twi->direction = TWI_BUS_READ;
+		twi->flag = TWI_NO_FLAG;
+		return twi_bus_submit(s->twi, twi) == 0;
+	}
+	for (i = 0; i < s->address_length; i++) {
+		s->frame[i] = (uint8_t) (s->address >>
+				(8 * (s->address_length - 1 - i)));
+	}
+	memset(s->frame + s->address_length, 0xFF, s->length);
+	spi->tx = s->frame;
+	spi->rx = s->frame;
+	spi->len = s->address_length + s->length;
+	spi->selector = s->device;
+	spi->flags = 0;
+	spi->flag = SPI_QUEUE_NO_FLAG;
+	return spi_queue_submit(s->spi, spi);
+}
+
+static inline uint8_t acq_done(const acq_sensor_t *s) {
+	return s->twi ? s->transaction.twi.done : s->transaction.spi.done;
+}
+
+/*
+ * Stores the read of a sensor if it is done.
+ */
+static void acq_store(acq_sensor_t *s) {
+	uint8_t record[ACQ_RECORD_SIZE(ACQ_MAX_FRAME)];
+	const uint8_t *data = s->frame;
+	uint32_t size = ACQ_RECORD_SIZE(s->length);
+
+	if (!acq_done(s)) {
+		return;
+	}
+	s->busy = 0;
+	if (s->spi) {
+		data += s->address_length;
+	} else if (s->transaction.twi.result != TWI_RESULT_OK) {
+		s->stats.errors++;
+		return;
+	}
+	if (ring_space(s->out) < size) {
+		s->stats.dropped++;
+		return;
+	}
+	// one write, the consumer sees the whole record or nothing
+	record[0] = (uint8_t) s->queued;
+	record[1] = (uint8_t) (s->queued >> 8);
+	record[2] = (uint8_t) (s->queued >> 16);
+	record[3] = (uint8_t) (s->queued >> 24);
+	memcpy(record + 4, data, s->length);
+	(void) ring_write(s->out, record, size);
+	s->stats.samples++;
+}
+
+void acq_poll(acq_t *acq) {
+	acq_sensor_t *s;
+
+	for (s = acq->sensors; s; s = s->next) {
+		if (s->busy) {
+			acq_store(s);
+		}
+	}
+}
+
+void acq_tick(acq_t *acq, uint32_t now) {
+	acq_sensor_t *s;
+	acq_sensor_t *bus;
+
+	acq_poll(acq);
+	// the due reads of one bus after the other, so that each bus gets its
+	// batch queued at once; the first sensor of a bus takes the others
+	for (bus = acq->sensors; bus; bus = bus->next) {
+		for (s = acq->sensors; s != bus; s = s->next) {
+			if (s->twi == bus->twi && s->spi == bus->spi) {
+				break;
+			}
+		}
+		if (s != bus) {
+			continue;
+		}
+		for (s = bus; s; s = s->next) {
+			if (s->twi != bus->twi || s->spi != bus->spi ||
+				(int32_t) (now - s->due) < 0) {
+				continue;
+			}
+			s->due += s->period;
+			// more than a period late, e.g. after a pause of the ticks
+			if ((int32_t) (now - s->due) >= 0) {
+				s->due = now + s->period;
+			}
+			if (s->busy) {
+				s->stats.skipped++;
+			} else if (acq_queue(s)) {
+				s->queued = now;
+				s->busy = 1;
+			} else {
+				s->stats.errors++;
+			}
+		}
+	}
+}
+
+uint8_t acq_idle(const acq_t *acq) {
+	const acq_sensor_t *s;
+
+	for (s = acq->sensors; s; s = s->next) {
+		if (s->busy && !acq_done(s)) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+uint8_t acq_read(acq_sensor_t *sensor, uint32_t *time, uint8_t *data) {
+	uint8_t record[ACQ_RECORD_SIZE(ACQ_MAX_FRAME)];
+	uint32_t size = ACQ_RECORD_SIZE(sensor->length);
+
+	if (ring_count(sensor->out) < size) {
+		return 0;
+	}
+	(void) ring_read(sensor->out, record, size);
+	if (time) {
+		*time = (uint32_t) record[0] | ((uint32_t) record[1] << 8) |
+				((uint32_t) record[2] << 16) | ((uint32_t) record[3] << 24);
+	}
+	memcpy(data, record + 4, sensor->length);
+	return 1;
+}
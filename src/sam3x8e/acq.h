@@ -0,0 +1,161 @@
+/**
+ * @file acq.h
+ * @brief Acquisition - Periodic reads of TWI and SPI sensors
+ * @details Reads registers of many sensors at their own rates without a
+ * blocking call per sensor. A sensor is registered with its bus, device,
+ * register address, sample length and period; acq_tick() is called once per
+ * tick, e.g. from a task every millisecond:
+ * @code
+ *	static uint8_t accel_data[16 * ACQ_RECORD_SIZE(6)];
+ *	static ring_t accel_ring = RING_INIT(accel_data, sizeof(accel_data));
+ *	static acq_sensor_t accel = {
+ *		.twi = TWI1, .device = 0x68, .address = 0x3B, .address_length = 1,
+ *		.length = 6, .period = 10, .out = &accel_ring
+ *	};
+ *	static acq_t acq;
+ *
+ *	acq_add(&acq, &accel, CoGetOSTime());
+ *	for (;;) {
+ *		acq_tick(&acq, CoGetOSTime());
+ *		CoTickDelay(1);
+ *	}
+ * @endcode
+ *
+ * Each tick queues the reads of all the sensors that are due, bus by bus,
+ * with twi_bus.h and spi_queue.h. Those do the reads of one bus back to back
+ * from their interrupts (the TWI with its PDC), so the buses stay busy and
+ * the CPU is free until the next tick. The next tick, or acq_poll(), stores
+ * each read that is done in the ring of its sensor as a record: the tick it
+ * was queued in (4 bytes, little-endian) and the data. A consumer takes them
+ * with acq_read().
+ *
+ * A sensor whose read is still queued when it is due again skips that read,
+ * a read that failed or found the ring full is counted and dropped.
+ *
+ * @pre The TWI instances must be set up with twi_bus_init() and the SPIs
+ * with spi_queue_init(), their selectors with 8 bits per transfer. All the
+ * functions of an acq_t must be called from one task, acq_read() of a
+ * sensor from one task (it may be another).
+ * @date 14 October 2026
+ */
+
+#ifndef ACQ_H_
+#define ACQ_H_
+
+#include <inttypes.h>
+#include "ring.h"
+#include "spi_queue.h"
+#include "twi_bus.h"
+
+/// Most bytes of a read: the data, plus the register address with SPI.
+#ifndef ACQ_MAX_FRAME
+#define ACQ_MAX_FRAME			(16)
+#endif
+
+/// Bytes of a record of a sample of length bytes in the ring of a sensor.
+#define ACQ_RECORD_SIZE(length)	(4u + (length))
+
+/**
+ * Counters of a sensor since acq_add().
+ */
+typedef struct acq_sensor_stats {
+	uint32_t samples;	///< Records stored
+	uint32_t skipped;	///< Reads not queued, the one before was not done
+	uint32_t errors;	///< Reads that failed on the bus
+	uint32_t dropped;	///< Reads done while the ring was full
+} acq_sensor_stats_t;
+
+/**
+ * A sensor and its read. The fields up to out are set by the user before
+ * acq_add(), the sensor must stay valid while it is registered.
+ */
+typedef struct acq_sensor {
+	/** The TWI of the sensor, or 0 for an SPI sensor */
+	twi_reg_t *twi;
+	/** The SPI of the sensor, or 0 for a TWI sensor */
+	spi_reg_t *spi;
+	/** Device address (TWI) or selector (SPI, prefix SPI_SELECTOR_) */
+	uint8_t device;
+	/**
+	 * Register address: the internal address of the TWI read, or the bytes
+	 * sent before the data with SPI, most significant byte first, e.g.
+	 * 0x80 | register for many SPI sensors.
+	 */
+	uint32_t address;
+	/** Bytes of address (0-3) */
+	uint8_t address_length;
+	/** Bytes of a sample (1-ACQ_MAX_FRAME, less the address with SPI) */
+	uint8_t length;
+	/** Ticks between two reads (at least 1) */
+	uint32_t period;
+	/** Ring of the records, see ACQ_RECORD_SIZE() */
+	ring_t *out;
+
+	/** Counters, kept by the scheduler */
+	acq_sensor_stats_t stats;
+	///@cond
+	union {
+		twi_transaction_t twi;
+		spi_transaction_t spi;
+	} transaction;
+	uint8_t frame[ACQ_MAX_FRAME];
+	uint32_t due;
+	uint32_t queued;
+	uint8_t busy;
+	struct acq_sensor *next;
+	///@endcond
+} acq_sensor_t;
+
+/**
+ * A scheduler, all zero when empty.
+ */
+typedef struct acq {
+	acq_sensor_t *sensors;	///< Registered sensors
+} acq_t;
+
+/**
+ * Registers a sensor, its first read is queued by the next acq_tick().
+ * @param acq The scheduler.
+ * @param sensor The sensor.
+ * @param now The current tick.
+ * @return 1 on success, 0 if the recipe is invalid.
+ */
+uint8_t acq_add(acq_t *acq, acq_sensor_t *sensor, uint32_t now);
+
+/**
+ * Removes a sensor.
+ * @param acq The scheduler.
+ * @param sensor The sensor.
+ * @pre The read of the sensor is done, see acq_idle().
+ */
+void acq_remove(acq_t *acq, acq_sensor_t *sensor);
+
+/**
+ * Stores the reads that are done, then queues the reads that are due.
+ * @param acq The scheduler.
+ * @param now The current tick.
+ */
+void acq_tick(acq_t *acq, uint32_t now);
+
+/**
+ * Stores the reads that are done, without queueing new ones.
+ * @param acq The scheduler.
+ */
+void acq_poll(acq_t *acq);
+
+/**
+ * @param acq The scheduler.
+ * @return 1 if all the queued reads are done, otherwise 0.
+ */
+uint8_t acq_idle(const acq_t *acq);
+
+/**
+ * Takes the oldest record of a sensor.
+ * @param sensor The sensor.
+ * @param time Receives the tick the read was queued in, may be 0.
+ * @param data Receives length bytes.
+ * @return 1 on success, 0 if there is no record.
+ */
+uint8_t acq_read(acq_sensor_t *sensor, uint32_t *time, uint8_t *data);
+
+#endif
@@ -11,6 +11,57 @@
  */
 
 #include "adc.h"
+#include "pdc.h"
+#include "id.h"
+#include "pmc.h"
+#include "pwm.h"
+#include "tc.h"
+#if ADC_COOS
+#include "rtos/CoOS.h"
+#endif
+
+// NVIC Interrupt Set/Clear-Enable Register 1 (peripheral ID 32-63)
+#define NVIC_ISER1		(*((volatile uint32_t *) PERIPH_ADDR(0xE000E104U)))
+#define NVIC_ICER1		(*((volatile uint32_t *) PERIPH_ADDR(0xE000E184U)))
+
+// Highest number of samples in one PDC buffer
+#define ADC_PDC_MAX_COUNT	(0xFFFFu)
+
+// Most ADC clocks of tracking (TRACKTIM + 1)
+#define ADC_TRACKING_MAX	(16u)
+
+// Transfer period of (2 * TRANSFER + 3) ADC clocks, part of a conversion
+#define ADC_TRANSFER		(1u)
+
+// ADC clocks of each STARTUP value
+static const uint16_t startup_clocks[] = {
+	0, 8, 16, 24, 64, 80, 96, 112, 512, 576, 640, 704, 768, 832, 896, 960
+};
+
+// Peripheral clock of the timer of the trigger, 0 for none
+static uint32_t trigger_clock;
+
+// State of the continuous acquisition
+static struct {
+	uint16_t *half[2];
+	uint32_t half_samples;
+	uint32_t filling;
+	volatile uint32_t halves;
+	adc_stream_callback_t callback;
+	uint8_t flag;
+} stream = { .flag = ADC_NO_FLAG };
+
+// Number of slots in the user sequence, 0 when it is off
+static uint32_t sequence_count;
+
+// Request of adc_scan_req(), 0 when no scan is running
+static io_req_t *volatile scan_req;
+
+// State of the comparison window
+static struct {
+	volatile uint32_t events;
+	uint8_t flag;
+} compare = { .flag = ADC_NO_FLAG };
 
 void adc_init(adc_settings_t * adc_settings) {
 	// Software reset
@@ -24,6 +75,44 @@ void adc_init(adc_settings_t * adc_settings) {
 
 	// Configure startup time
 	ADC->ADC_MR |= adc_settings->startup_time;
+
+	// Configure hardware trigger
+	if (adc_settings->trigger != ADC_TRIGGER_SOFTWARE &&
+		adc_settings->trigger <= ADC_TRIGGER_PWM_EVENT1) {
+		ADC->ADC_MR |= ADC_MR_TRGEN |
+				((adc_settings->trigger - 1) << ADC_MR_TRGSEL_POS);
+	}
+}
+
+/*
+ * Acquire the clock of the timer of a trigger and release the one of the
+ * trigger before.
+ */
+static void use_trigger_clock(uint32_t id) {
+	if (id != trigger_clock) {
+		if (trigger_clock != 0) {
+			pmc_release_peripheral_clock(trigger_clock);
+		}
+		pmc_acquire_peripheral_clock(id);
+		trigger_clock = id;
+	}
+}
+
+uint32_t adc_set_sample_rate(uint32_t trigger, uint32_t hz) {
+	switch (trigger) {
+	case ADC_TRIGGER_TIOA0:
+	case ADC_TRIGGER_TIOA1:
+	case ADC_TRIGGER_TIOA2:
+		use_trigger_clock(ID_TC0 + (trigger - ADC_TRIGGER_TIOA0));
+		return tc_set_trigger_rate(TC0, trigger - ADC_TRIGGER_TIOA0,
+				SYS_CLK_FREQ, hz);
+	case ADC_TRIGGER_PWM_EVENT0:
+	case ADC_TRIGGER_PWM_EVENT1:
+		use_trigger_clock(ID_PWM);
+		return pwm_set_event_rate(trigger - ADC_TRIGGER_PWM_EVENT0, hz);
+	default:
+		return 0;
+	}
 }
 
 void adc_start(void) {
@@ -32,6 +121,7 @@ void adc_start(void) {
 
 void adc_reset(void) {
 	ADC->ADC_CR = ADC_CR_RESET;
+	sequence_count = 0;
 }
 
 void adc_set_resolution(uint32_t resolution) {
@@ -41,6 +131,74 @@ void adc_set_resolution(uint32_t resolution) {
 	}
 }
 
+uint32_t adc_get_resolution(void) {
+	return (ADC->ADC_MR & ADC_MR_LOWRES) ?
+			ADC_RESOLUTION_10_BIT : ADC_RESOLUTION_12_BIT;
+}
+
+/*
+ * ADC clocks of a time, rounded up.
+ */
+static uint32_t ns_to_clocks(uint32_t ns, uint32_t clock) {
+	return (uint32_t) (((uint64_t) ns * clock + 999999999u) / 1000000000u);
+}
+
+uint32_t adc_set_burst(const adc_burst_settings_t *settings) {
+	uint32_t mck = pmc_get_mck_freq();
+	// the fastest ADC clock, MCK / ((PRESCAL + 1) * 2)
+	uint32_t prescaler = (mck + 2 * ADC_CLOCK_MAX - 1) /
+			(2 * ADC_CLOCK_MAX) - 1;
+	uint32_t clock, tracking, rate, startup, mr;
+
+	if (settings->rate == 0 || settings->power > ADC_POWER_FAST_WAKEUP ||
+		settings->settling > ADC_SETTLING_17 || prescaler > 0xFFu) {
+		return 0;
+	}
+	clock = mck / ((prescaler + 1) * 2);
+	tracking = ns_to_clocks(settings->tracking_ns, clock);
+	if (tracking == 0) {
+		tracking = 1;
+	} else if (tracking > ADC_TRACKING_MAX) {
+		return 0;
+	}
+
+	mr = ADC->ADC_MR & (ADC_MR_TRGEN | ADC_MR_TRGSEL_MASK | ADC_MR_FREERUN |
+			ADC_MR_ANACH | ADC_MR_USEQ);
+	rate = clock / (tracking + ADC_CONVERSION_CLOCKS_12_BIT);
+	if (rate < settings->rate) {
+		rate = clock / (tracking + ADC_CONVERSION_CLOCKS_10_BIT);
+		if (rate < settings->rate) {
+			return 0;
+		}
+		mr |= ADC_MR_LOWRES;
+	}
+
+	if (settings->power == ADC_POWER_NORMAL) {
+		mr |= ADC->ADC_MR & ADC_MR_STARTUP_MASK;
+	} else {
+		uint32_t clocks = ns_to_clocks(settings->power == ADC_POWER_SLEEP ?
+				ADC_WAKEUP_SLEEP_NS : ADC_WAKEUP_FAST_NS, clock);
+
+		for (startup = 0; startup < 16 && startup_clocks[startup] < clocks;
+				startup++) {
+		}
+		// longer than the longest start-up, 960 ADC clocks
+		if (startup == 16) {
+			return 0;
+		}
+		mr |= ADC_MR_SLEEP | (startup << ADC_MR_STARTUP_POS);
+		if (settings->power == ADC_POWER_FAST_WAKEUP) {
+			mr |= ADC_MR_FWUP;
+		}
+	}
+	mr |= (prescaler << ADC_MR_PRES_POS) |
+			(settings->settling << ADC_MR_SETTLING_POS) |
+			((tracking - 1) << ADC_MR_TRACKTIM_POS) |
+			(ADC_TRANSFER << ADC_MR_TRANSFER_POS);
+	ADC->ADC_MR = mr;
+	return rate;
+}
+
 void adc_enable_channel(uint32_t channel) {
 	if (channel <= ADC_CHANNEL_MAX) {
 		ADC->ADC_CHER = (0x1u << channel);
@@ -64,3 +222,236 @@ uint32_t adc_channel_enabled(uint32_t channel) {
 uint32_t adc_read_channel(uint32_t channel) {
 	return (ADC->ADC_CDR[channel]);
 }
+
+uint8_t adc_stream_start(uint16_t *buffer, uint32_t half_samples,
+		adc_stream_callback_t callback) {
+	if (buffer == 0 || half_samples == 0 ||
+		half_samples > ADC_PDC_MAX_COUNT || scan_req) {
+		return 0;
+	}
+	adc_stream_stop();
+	stream.half[0] = buffer;
+	stream.half[1] = buffer + half_samples;
+	stream.half_samples = half_samples;
+	stream.filling = 0;
+	stream.halves = 0;
+	stream.callback = callback;
+
+	// each sample tells its channel
+	ADC->ADC_EMR |= ADC_EMR_TAG;
+	pdc_rx_start_ping_pong(PDC_OF(ADC), stream.half[0], stream.half[1],
+			half_samples);
+	ADC->ADC_IER = ADC_ISR_ENDRX;
+	NVIC_ISER1 = (0x1u << (ID_ADC - 32));
+
+	// free-run, unless the conversions are started by a hardware trigger
+	if (!(ADC->ADC_MR & ADC_MR_TRGEN)) {
+		ADC->ADC_MR |= ADC_MR_FREERUN;
+		adc_start();
+	}
+	return 1;
+}
+
+void adc_stream_stop(void) {
+	ADC->ADC_MR &= ~ADC_MR_FREERUN;
+	ADC->ADC_IDR = ADC_ISR_ENDRX;
+	pdc_rx_stop(PDC_OF(ADC));
+	if (!(ADC->ADC_IMR & ADC_ISR_COMPE)) {
+		NVIC_ICER1 = (0x1u << (ID_ADC - 32));
+	}
+}
+
+uint32_t adc_stream_halves(void) {
+	return stream.halves;
+}
+
+uint16_t *adc_stream_swap(uint16_t *buffer) {
+	// the half that is not being filled is the one queued in RNPR
+	uint32_t queued = stream.filling ^ 1u;
+	uint16_t *old = stream.half[queued];
+
+	stream.half[queued] = buffer;
+	PDC_OF(ADC)->PERIPH_RNPR = (uint32_t) buffer;
+	return old;
+}
+
+uint8_t adc_sequence_set(const uint8_t *channels, uint32_t count) {
+	uint32_t seqr[2] = { 0, 0 };
+	uint32_t slot;
+
+	if (channels == 0 || count == 0 || count > ADC_SEQUENCE_MAX) {
+		return 0;
+	}
+	for (slot = 0; slot < count; slot++) {
+		if (channels[slot] > ADC_CHANNEL_MAX) {
+			return 0;
+		}
+		seqr[slot / 8] |= ((uint32_t) channels[slot] << ((slot % 8) * 4));
+	}
+	ADC->ADC_CHDR = 0xFFFFu;
+	ADC->ADC_SEQR1 = seqr[0];
+	ADC->ADC_SEQR2 = seqr[1];
+	ADC->ADC_MR |= ADC_MR_USEQ;
+	ADC->ADC_CHER = (0xFFFFu >> (ADC_SEQUENCE_MAX - count));
+	sequence_count = count;
+	return 1;
+}
+
+void adc_sequence_disable(void) {
+	ADC->ADC_CHDR = 0xFFFFu;
+	ADC->ADC_MR &= ~ADC_MR_USEQ;
+	ADC->ADC_SEQR1 = 0;
+	ADC->ADC_SEQR2 = 0;
+	sequence_count = 0;
+}
+
+uint8_t adc_scan(uint16_t *out, uint32_t scans) {
+	uint32_t count = sequence_count;
+	uint32_t scan, slot;
+	uint16_t *row;
+
+	if (out == 0 || count == 0) {
+		return 0;
+	}
+	for (scan = 0; scan < scans; scan++) {
+		if (!(ADC->ADC_MR & ADC_MR_TRGEN)) {
+			adc_start();
+		}
+		row = out + scan;
+		for (slot = 0; slot < count; slot++) {
+			// reading LCDR clears DRDY
+			while (!(PERIPH_REG(ADC->ADC_ISR) & ADC_ISR_DRDY)) {
+			}
+			*row = ADC->ADC_LCDR & 0xFFFu;
+			row += scans;
+		}
+	}
+	return 1;
+}
+
+uint8_t adc_scan_req(uint16_t *out, uint32_t scans, io_req_t *req) {
+	uint32_t samples = sequence_count * scans;
+
+	// the stream uses the PDC channel too
+	if (out == 0 || samples == 0 || samples > ADC_PDC_MAX_COUNT ||
+		scan_req || (ADC->ADC_IMR & ADC_ISR_ENDRX) || !io_req_start(req)) {
+		return 0;
+	}
+	scan_req = req;
+	ADC->ADC_EMR |= ADC_EMR_TAG;
+	// throw away an old conversion
+	(void) PERIPH_REG(ADC->ADC_LCDR);
+	pdc_rx_start(PDC_OF(ADC), out, samples);
+	ADC->ADC_IER = ADC_ISR_ENDRX;
+	NVIC_ISER1 = (0x1u << (ID_ADC - 32));
+
+	if (!(ADC->ADC_MR & ADC_MR_TRGEN)) {
+		ADC->ADC_MR |= ADC_MR_FREERUN;
+		adc_start();
+	}
+	return 1;
+}
+
+void adc_deinterleave(const uint16_t *samples, uint32_t scans,
+		uint32_t channels, uint16_t *out, uint32_t stride) {
+	uint32_t scan, slot;
+	uint16_t *row;
+
+	for (slot = 0; slot < channels; slot++) {
+		const uint16_t *in = samples + slot;
+		row = out + slot * stride;
+		for (scan = 0; scan < scans; scan++) {
+			row[scan] = ADC_SAMPLE_VALUE(*in);
+			in += channels;
+		}
+	}
+}
+
+uint8_t adc_compare_start(uint32_t mode, uint32_t channel, uint16_t low,
+		uint16_t high) {
+	uint32_t emr;
+
+	if (mode > ADC_COMPARE_OUT || low > 0xFFFu || high > 0xFFFu ||
+		(channel > ADC_CHANNEL_MAX && channel != ADC_COMPARE_ALL_CHANNELS)) {
+		return 0;
+	}
+	emr = ADC->ADC_EMR &
+			~(ADC_EMR_CMPMODE_MASK | ADC_EMR_CMPSEL_MASK | ADC_EMR_CMPALL);
+	emr |= mode;
+	if (channel == ADC_COMPARE_ALL_CHANNELS) {
+		emr |= ADC_EMR_CMPALL;
+	} else {
+		emr |= (channel << ADC_EMR_CMPSEL_POS);
+	}
+	ADC->ADC_EMR = emr;
+	ADC->ADC_CWR = low | ((uint32_t) high << ADC_CWR_HIGHTHRES_POS);
+	compare.events = 0;
+	adc_compare_arm();
+	return 1;
+}
+
+void adc_compare_arm(void) {
+	// reading ISR clears an old COMPE
+	(void) PERIPH_REG(ADC->ADC_ISR);
+	ADC->ADC_IER = ADC_ISR_COMPE;
+	NVIC_ISER1 = (0x1u << (ID_ADC - 32));
+}
+
+void adc_compare_stop(void) {
+	ADC->ADC_IDR = ADC_ISR_COMPE;
+}
+
+uint32_t adc_compare_events(void) {
+	return compare.events;
+}
+
+#if ADC_COOS
+void adc_stream_set_flag(uint8_t flag) {
+	stream.flag = flag;
+}
+
+void adc_compare_set_flag(uint8_t flag) {
+	compare.flag = flag;
+}
+#endif
+
+void ADC_Handler(void) {
+	// reading ISR clears COMPE, so it is read once
+	uint32_t status = ADC->ADC_ISR & ADC->ADC_IMR;
+	uint32_t full;
+
+	if (status & ADC_ISR_COMPE) {
+		// one event per arm, the window may match every conversion
+		ADC->ADC_IDR = ADC_ISR_COMPE;
+		compare.events++;
+#if ADC_COOS
+		if (compare.flag != ADC_NO_FLAG) {
+			isr_SetFlag(compare.flag);
+		}
+#endif
+	}
+	if ((status & ADC_ISR_ENDRX) && scan_req) {
+		io_req_t *req = scan_req;
+
+		adc_stream_stop();
+		scan_req = 0;
+		io_req_complete(req, 1);
+	} else if (status & ADC_ISR_ENDRX) {
+		/*
+		 * The PDC has moved on to the other half. The full half is queued
+		 * as the next buffer, so it is filled again after the other half.
+		 */
+		full = stream.filling;
+		stream.filling ^= 1u;
+		pdc_rx_next(PDC_OF(ADC), stream.half[full], stream.half_samples);
+		stream.halves++;
+		if (stream.callback) {
+			stream.callback(stream.half[full], stream.half_samples);
+		}
+#if ADC_COOS
+		if (stream.flag != ADC_NO_FLAG) {
+			isr_SetFlag(stream.flag);
+		}
+#endif
+	}
+}
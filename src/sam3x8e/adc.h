@@ -17,10 +17,23 @@
 #define ADC_H_
 
 #include <inttypes.h>
+#include "periph.h"
+#include "io_req.h"
+
+/*
+ * Set to 0 to build without the CoOS event flag support, e.g. when the RTOS
+ * is not linked into the application.
+ */
+#ifndef ADC_COOS
+#define ADC_COOS	(1)
+#endif
+
+// No event flag is set when a half of the stream buffer is full
+#define ADC_NO_FLAG	(0xFFu)
 
 ///@cond
 // pointer to registers of ADC, base address: 0x400C0000
-#define ADC ((adc_reg_t *) 0x400C0000U)
+#define ADC ((adc_reg_t *) PERIPH_ADDR(0x400C0000U))
 ///@endcond
 
 // Valid DACC channels
@@ -41,10 +54,61 @@
 #define ADC_CHANNEL_14	14	///< ADC Channel 14
 #define ADC_CHANNEL_15	15	///< ADC Channel 15
 
+// Conversion triggers (see adc_settings_t)
+#define ADC_TRIGGER_SOFTWARE	0	///< Conversions are started by adc_start()
+#define ADC_TRIGGER_ADTRG		1	///< External trigger pin ADTRG
+#define ADC_TRIGGER_TIOA0		2	///< TIOA of TC0 channel 0
+#define ADC_TRIGGER_TIOA1		3	///< TIOA of TC0 channel 1
+#define ADC_TRIGGER_TIOA2		4	///< TIOA of TC0 channel 2
+#define ADC_TRIGGER_PWM_EVENT0	5	///< PWM event line 0
+#define ADC_TRIGGER_PWM_EVENT1	6	///< PWM event line 1
+
+// Comparison window modes (see adc_compare_start())
+#define ADC_COMPARE_LOW			0	///< Event when the value is below the low threshold
+#define ADC_COMPARE_HIGH		1	///< Event when the value is above the high threshold
+#define ADC_COMPARE_IN			2	///< Event when the value is inside the window
+#define ADC_COMPARE_OUT			3	///< Event when the value is outside the window
+
+// Compare all enabled channels instead of one
+#define ADC_COMPARE_ALL_CHANNELS	0xFFu
+
 // Resolution values
 #define ADC_RESOLUTION_10_BIT	1	///< ADC 10 bit resolution
 #define ADC_RESOLUTION_12_BIT	0	///< ADC 12 bit resolution
 
+// Power modes between conversions (see adc_burst_settings_t)
+#define ADC_POWER_NORMAL		0	///< Core and reference stay on
+#define ADC_POWER_SLEEP			1	///< Core and reference off, longest wake-up
+#define ADC_POWER_FAST_WAKEUP	2	///< Core off, reference on, short wake-up
+
+// Settling times, in ADC clocks (see adc_burst_settings_t)
+#define ADC_SETTLING_3			0	///< 3 ADC clocks
+#define ADC_SETTLING_5			1	///< 5 ADC clocks
+#define ADC_SETTLING_9			2	///< 9 ADC clocks
+#define ADC_SETTLING_17			3	///< 17 ADC clocks
+
+/*
+ * Timing of a conversion used by adc_set_burst(), from the electrical
+ * characteristics. A conversion takes TRACKTIM + 1 ADC clocks of tracking
+ * plus the clocks of its resolution, the wake-up from sleep and from fast
+ * wake-up the given times. Override them for another part or ADC clock.
+ */
+#ifndef ADC_CLOCK_MAX
+#define ADC_CLOCK_MAX				(22000000u)	///< Highest ADC clock in Hz
+#endif
+#ifndef ADC_CONVERSION_CLOCKS_12_BIT
+#define ADC_CONVERSION_CLOCKS_12_BIT	(20u)	///< ADC clocks after tracking, 12 bits
+#endif
+#ifndef ADC_CONVERSION_CLOCKS_10_BIT
+#define ADC_CONVERSION_CLOCKS_10_BIT	(17u)	///< ADC clocks after tracking, 10 bits
+#endif
+#ifndef ADC_WAKEUP_SLEEP_NS
+#define ADC_WAKEUP_SLEEP_NS			(40000u)	///< Wake-up from ADC_POWER_SLEEP
+#endif
+#ifndef ADC_WAKEUP_FAST_NS
+#define ADC_WAKEUP_FAST_NS			(12000u)	///< Wake-up from ADC_POWER_FAST_WAKEUP
+#endif
+
 ///@cond
 /*
  * Set specified bit levels in a register at specified position.
@@ -86,8 +150,47 @@
 #define ADC_MR_RES(resolution) \
 	((resolution) << 4)
 
+#define ADC_MR_TRGEN	(0x1u << 0)
+#define ADC_MR_TRGSEL_POS	(1)
+#define ADC_MR_TRGSEL_MASK	(0x7u << 1)
+#define ADC_MR_LOWRES	(0x1u << 4)
+#define ADC_MR_SLEEP	(0x1u << 5)
+#define ADC_MR_FWUP		(0x1u << 6)
+#define ADC_MR_FREERUN	(0x1u << 7)
+#define ADC_MR_PRES_MASK	(0xFFu << 8)
+#define ADC_MR_STARTUP_POS	(16)
+#define ADC_MR_STARTUP_MASK	(0xFu << 16)
+#define ADC_MR_SETTLING_POS	(20)
+#define ADC_MR_SETTLING_MASK	(0x3u << 20)
+#define ADC_MR_ANACH	(0x1u << 23)
+#define ADC_MR_TRACKTIM_POS	(24)
+#define ADC_MR_TRACKTIM_MASK	(0xFu << 24)
+#define ADC_MR_TRANSFER_POS	(28)
+#define ADC_MR_TRANSFER_MASK	(0x3u << 28)
+#define ADC_MR_USEQ		(0x1u << 31)
+
 // ADC_ISR: (ADC Offset: 0x0030) Interrupt Status Register
 #define ADC_ISR_DRDY	(0x01 << 24)
+#define ADC_ISR_GOVRE	(0x01 << 25)
+#define ADC_ISR_COMPE	(0x01 << 26)
+#define ADC_ISR_ENDRX	(0x01 << 27)
+#define ADC_ISR_RXBUFF	(0x01 << 28)
+
+// ADC_EMR: (ADC Offset: 0x0040) Extended Mode Register
+#define ADC_EMR_CMPMODE_MASK	(0x3u << 0)
+#define ADC_EMR_CMPSEL_POS		(4)
+#define ADC_EMR_CMPSEL_MASK		(0xFu << 4)
+#define ADC_EMR_CMPALL			(0x1u << 9)
+#define ADC_EMR_TAG				(0x1u << 24)
+
+// ADC_CWR: (ADC Offset: 0x0044) Compare Window Register
+#define ADC_CWR_LOWTHRES_MASK	(0xFFFu << 0)
+#define ADC_CWR_HIGHTHRES_POS	(16)
+#define ADC_CWR_HIGHTHRES_MASK	(0xFFFu << 16)
+
+// ADC_PTCR: (ADC Offset: 0x0120) PDC Transfer Control Register
+#define ADC_PTCR_RXTEN	(0x1u << 0)
+#define ADC_PTCR_RXTDIS	(0x1u << 1)
 
 /*
  * Mapping of ADC registers
@@ -146,6 +249,22 @@ typedef struct {
 	uint32_t ADC_WPSR;
 	// Reserved, offset 0x00EC to 0x00FC
 	uint32_t reserved5[5];
+	// Receive Pointer Register, offset 0x0100
+	uint32_t ADC_RPR;
+	// Receive Counter Register, offset 0x0104
+	uint32_t ADC_RCR;
+	// Reserved, offset 0x0108 and 0x010C
+	uint32_t reserved6[2];
+	// Receive Next Pointer Register, offset 0x0110
+	uint32_t ADC_RNPR;
+	// Receive Next Counter Register, offset 0x0114
+	uint32_t ADC_RNCR;
+	// Reserved, offset 0x0118 and 0x011C
+	uint32_t reserved7[2];
+	// Transfer Control Register, offset 0x0120
+	uint32_t ADC_PTCR;
+	// Transfer Status Register, offset 0x0124
+	uint32_t ADC_PTSR;
 
 } adc_reg_t;
 
@@ -167,14 +286,35 @@ typedef struct {
 	 */
 	uint32_t prescaler;
 
+	/**
+	 * Select what starts a conversion, use prefix: ADC_TRIGGER_
+	 * The default (0) is ADC_TRIGGER_SOFTWARE. Use adc_set_sample_rate()
+	 * to let a TC channel or the PWM trigger the conversions at a fixed rate.
+	 */
+	uint32_t trigger;
+
 } adc_settings_t;
 
 /**
  * Initializes the ADC.
- * @param adc_settings Pointer to settings for the initlization (startuptime, precaler).
+ * @param adc_settings Pointer to settings for the initlization (startuptime, precaler, trigger).
  */
 void adc_init(adc_settings_t * adc_settings);
 
+/**
+ * Configures the timer behind a hardware trigger to start a conversion at
+ * the requested rate. TC0 channel 0-2 is set up with tc_set_trigger_rate()
+ * and the event lines with pwm_set_event_rate() (which uses PWM channel 0).
+ * The peripheral clock of the timer is acquired, and the one of the trigger
+ * set before is released. The trigger must also be
+ * selected in adc_settings_t when calling adc_init().
+ * @param trigger ADC_TRIGGER_TIOA0-2 or ADC_TRIGGER_PWM_EVENT0-1.
+ * @param hz Requested sample rate in Hz.
+ * @return The actual sample rate in Hz, or 0 if the trigger has no timer or
+ * the rate cannot be reached.
+ */
+uint32_t adc_set_sample_rate(uint32_t trigger, uint32_t hz);
+
 /**
  * Starts the ADC.
  */
@@ -191,6 +331,61 @@ void adc_reset(void);
  */
 void adc_set_resolution(uint32_t resolution);
 
+/**
+ * @return The resolution, ADC_RESOLUTION_10_BIT or ADC_RESOLUTION_12_BIT.
+ */
+uint32_t adc_get_resolution(void);
+
+/**
+ * Timing and power of a burst of conversions, see adc_set_burst().
+ */
+typedef struct {
+	/**
+	 * Conversions per second the ADC must keep up with, e.g. the rate of
+	 * adc_set_sample_rate() or of the slots of a sequence in a burst.
+	 */
+	uint32_t rate;
+
+	/**
+	 * Shortest tracking time in ns the source impedance needs, 0 for the
+	 * shortest the ADC allows (one ADC clock).
+	 */
+	uint32_t tracking_ns;
+
+	/**
+	 * What the ADC does between conversions, use prefix: ADC_POWER_
+	 * With ADC_POWER_SLEEP or ADC_POWER_FAST_WAKEUP each trigger wakes the
+	 * ADC, it converts the enabled channels and goes back to sleep. They
+	 * need a hardware trigger or adc_start(), not free-run mode.
+	 */
+	uint32_t power;
+
+	/**
+	 * Settling time when the analog settings change between channels, use
+	 * prefix: ADC_SETTLING_
+	 */
+	uint32_t settling;
+
+} adc_burst_settings_t;
+
+/**
+ * Sets up the ADC clock, tracking, settling and wake-up times and the power
+ * mode for bursts of conversions, in one write of the mode register. The
+ * ADC clock is the fastest up to ADC_CLOCK_MAX at the current master clock
+ * (pmc_get_mck_freq()), so a conversion and the wake-up before it end as
+ * soon as possible and the ADC sleeps longer. Call it again after a change
+ * of the clock profile. The
+ * resolution is 12 bits if that keeps up with the rate, otherwise 10 bits
+ * (see adc_get_resolution()). The trigger, free-run and sequencer settings
+ * are kept.
+ * @param settings The settings.
+ * @return The highest conversion rate in Hz with the chosen timing (at least
+ * settings->rate), or 0 if the settings are invalid, the rate can not be
+ * reached or the wake-up needs more than the longest start-up time (960 ADC
+ * clocks); the ADC is left unchanged then.
+ */
+uint32_t adc_set_burst(const adc_burst_settings_t *settings);
+
 /**
  * Enables a specific channel.
  * Channel 15 is used for temperature-reader.
@@ -220,4 +415,168 @@ uint32_t adc_channel_enabled(uint32_t channel);
  * @return ADC value of the specific channel.
  */
 uint32_t adc_read_channel(uint32_t channel);
+
+/**
+ * The channel of a sample from a stream (see adc_stream_start()).
+ */
+#define ADC_SAMPLE_CHANNEL(sample)	(((sample) >> 12) & 0xFu)
+
+/**
+ * The converted value of a sample from a stream (see adc_stream_start()).
+ */
+#define ADC_SAMPLE_VALUE(sample)	((sample) & 0xFFFu)
+
+/**
+ * Called from the ADC interrupt when a half of the stream buffer is full.
+ * The half is filled again when the other half is full, so the samples must
+ * be used (or copied) before that.
+ * @param samples The full half of the buffer.
+ * @param count The number of samples in it.
+ */
+typedef void (*adc_stream_callback_t)(uint16_t *samples, uint32_t count);
+
+/**
+ * Starts continuous acquisition of the enabled channels into a buffer, which
+ * is filled by the PDC as two halves (ping-pong). Each sample is the Last
+ * Converted Data tagged with its channel, use ADC_SAMPLE_CHANNEL() and
+ * ADC_SAMPLE_VALUE().
+ * The ADC runs in free-run mode, unless a hardware trigger is enabled.
+ * @param buffer The buffer, with room for 2 * half_samples samples.
+ * @param half_samples The number of samples in each half (1-65535).
+ * @param callback Called when a half is full, or 0.
+ * @return 1 on success, 0 if the parameters are invalid or adc_scan_req() is
+ * running.
+ */
+uint8_t adc_stream_start(uint16_t *buffer, uint32_t half_samples,
+		adc_stream_callback_t callback);
+
+/**
+ * Stops continuous acquisition.
+ */
+void adc_stream_stop(void);
+
+/**
+ * The number of halves filled since adc_stream_start().
+ * @return The number of halves.
+ */
+uint32_t adc_stream_halves(void);
+
+/**
+ * Replaces the half of the stream buffer that the PDC fills after the
+ * current one. Called from the stream callback, this keeps the half that
+ * was just filled, e.g. to pass it on without copying. Called right after
+ * adc_stream_start(), the two halves can be separate buffers.
+ * @param buffer Room for half_samples samples.
+ * @return The half that was replaced.
+ */
+uint16_t *adc_stream_swap(uint16_t *buffer);
+
+/**
+ * The number of slots in the user sequence.
+ */
+#define ADC_SEQUENCE_MAX	(16)
+
+/**
+ * Configures the user sequencer (ADC_SEQR1/2 and USEQ) to convert the given
+ * channels in the given order, once per start or trigger. The slots are
+ * enabled instead of the channels, so channels previously enabled with
+ * adc_enable_channel() are replaced by the sequence.
+ * @param channels The channels to convert, in order. A channel may be
+ * repeated.
+ * @param count The number of channels (1-16).
+ * @return 1 on success, 0 if the parameters are invalid.
+ */
+uint8_t adc_sequence_set(const uint8_t *channels, uint32_t count);
+
+/**
+ * Turns the user sequencer off and disables all channels.
+ */
+void adc_sequence_disable(void);
+
+/**
+ * Converts the sequence given to adc_sequence_set() a number of times. Each
+ * slot gets a contiguous row of the output (struct-of-arrays):
+ * out[slot * scans + scan]. The conversions are started with adc_start()
+ * unless a hardware trigger is enabled, and the samples are read from the
+ * Last Converted Data register as they complete.
+ * @param out Room for count * scans values.
+ * @param scans The number of scans.
+ * @return 1 on success, 0 if there is no sequence or out is 0.
+ */
+uint8_t adc_scan(uint16_t *out, uint32_t scans);
+
+/**
+ * Converts the sequence given to adc_sequence_set() a number of times like
+ * adc_scan(), but the PDC stores the samples and the function returns
+ * immediately. The samples are interleaved and tagged like those of a
+ * stream: out[scan * count + slot], sort them with adc_deinterleave() when
+ * the request is done. The ADC runs in free-run mode, unless a hardware
+ * trigger is enabled, and stops when the last sample is stored.
+ * @param out Room for count * scans samples (at most 65535).
+ * @param scans The number of scans.
+ * @param req The request, set up with io_req_init(). Its result is 1.
+ * @return 1 on success, 0 if there is no sequence, out is 0, a stream or a
+ * scan is running or the request is busy.
+ */
+uint8_t adc_scan_req(uint16_t *out, uint32_t scans, io_req_t *req);
+
+/**
+ * Sorts interleaved samples of a stream (e.g. a half given to an
+ * adc_stream_callback_t while a sequence is set) into contiguous rows per
+ * slot: out[slot * stride + scan]. The channel tags are removed.
+ * @param samples The interleaved samples, scans * channels of them.
+ * @param scans The number of scans in samples.
+ * @param channels The number of slots in each scan.
+ * @param out The rows, channels * stride values.
+ * @param stride The length of each row (at least scans).
+ */
+void adc_deinterleave(const uint16_t *samples, uint32_t scans,
+		uint32_t channels, uint16_t *out, uint32_t stride);
+
+/**
+ * Starts the comparison window of the ADC. The ADC hardware compares every
+ * conversion, so nothing has to scan the samples: the first conversion that
+ * matches gives an interrupt, which disarms the comparison and sets the
+ * event flag (see adc_compare_set_flag()). Call adc_compare_arm() to wait for
+ * the next event.
+ * @param mode Use prefix: ADC_COMPARE_
+ * @param channel The channel to compare, or ADC_COMPARE_ALL_CHANNELS.
+ * @param low Low threshold (0-4095).
+ * @param high High threshold (0-4095).
+ * @return 1 on success, 0 if the parameters are invalid.
+ */
+uint8_t adc_compare_start(uint32_t mode, uint32_t channel, uint16_t low,
+		uint16_t high);
+
+/**
+ * Re-arms the comparison window after an event.
+ */
+void adc_compare_arm(void);
+
+/**
+ * Stops the comparison window.
+ */
+void adc_compare_stop(void);
+
+/**
+ * The number of comparison events since adc_compare_start().
+ * @return The number of events.
+ */
+uint32_t adc_compare_events(void);
+
+#if ADC_COOS
+/**
+ * Sets a CoOS event flag (isr_SetFlag()) when a half of the stream buffer is
+ * full.
+ * @param flag The event flag, or ADC_NO_FLAG.
+ */
+void adc_stream_set_flag(uint8_t flag);
+
+/**
+ * Sets a CoOS event flag (isr_SetFlag()) on a comparison event.
+ * @param flag The event flag, or ADC_NO_FLAG.
+ */
+void adc_compare_set_flag(uint8_t flag);
+#endif
+
 #endif
@@ -0,0 +1,272 @@
+/*
+ * adc_filter.c
+ *
+ * Date:	14 October 2026
+ */
+
+#include "adc_filter.h"
+#if ADC_FILTER_COOS
+#include "rtos/CoOS.h"
+#endif
+
+// Raw sample without its tag, centered around 0 (Q11)
+#define CENTERED(sample)	((int32_t) ADC_SAMPLE_VALUE(sample) - 2048)
+
+// Decimator fed by adc_filter_stream_callback()
+static adc_decimator_t *attached;
+
+void adc_to_q15(const uint16_t *in, uint32_t n, q15_t *out) {
+	// unrolled by four
+	while (n >= 4) {
+		out[0] = (q15_t) (CENTERED(in[0]) << 4);
+		out[1] = (q15_t) (CENTERED(in[1]) << 4);
+		out[2] = (q15_t) (CENTERED(in[2]) << 4);
+		out[3] = (q15_t) (CENTERED(in[3]) << 4);
+		in += 4;
+		out += 4;
+		n -= 4;
+	}
+	while (n--) {
+		*out++ = (q15_t) (CENTERED(*in) << 4);
+		in++;
+	}
+}
+
+uint32_t adc_boxcar_q15(const uint16_t *in, uint32_t n, uint32_t log2_factor,
+		q15_t *out) {
+	uint32_t blocks, block, k, sum;
+
+	if (log2_factor > ADC_FILTER_BOXCAR_MAX) {
+		return 0;
+	}
+	blocks = n >> log2_factor;
+	for (block = 0; block < blocks; block++) {
+		sum = 0;
+		k = 1u << log2_factor;
+		// unrolled by four, at most 4095 * 2^16 fits in the sum
+		while (k >= 4) {
+			sum += ADC_SAMPLE_VALUE(in[0]) + ADC_SAMPLE_VALUE(in[1]) +
+					ADC_SAMPLE_VALUE(in[2]) + ADC_SAMPLE_VALUE(in[3]);
+			in += 4;
+			k -= 4;
+		}
+		while (k--) {
+			sum += ADC_SAMPLE_VALUE(*in);
+			in++;
+		}
+		// the mean with 4 more fractional bits is Q15 + 0x8000
+		if (log2_factor >= 4) {
+			sum >>= (log2_factor - 4);
+		} else {
+			sum <<= (4 - log2_factor);
+		}
+		out[block] = (q15_t) ((int32_t) sum - 0x8000);
+	}
+	return blocks;
+}
+
+uint8_t adc_cic_init(adc_cic_t *cic, uint32_t stages, uint32_t log2_factor) {
+	uint32_t i;
+
+	if (cic == 0 || stages == 0 || stages > ADC_FILTER_CIC_MAX_STAGES ||
+		stages * log2_factor > ADC_FILTER_CIC_MAX_GAIN) {
+		return 0;
+	}
+	cic->stages = stages;
+	cic->log2_factor = log2_factor;
+	cic->phase = 0;
+	// the output has 11 + stages * log2_factor significant bits
+	cic->shift = ADC_FILTER_CIC_MAX_GAIN - stages * log2_factor;
+	for (i = 0; i < ADC_FILTER_CIC_MAX_STAGES; i++) {
+		cic->integrator[i] = 0;
+		cic->comb[i] = 0;
+	}
+	return 1;
+}
+
+uint32_t adc_cic_q31(adc_cic_t *cic, const uint16_t *in, uint32_t n,
+		q31_t *out) {
+	const uint32_t stages = cic->stages;
+	const uint32_t factor = 1u << cic->log2_factor;
+	uint32_t i0 = cic->integrator[0];
+	uint32_t i1 = cic->integrator[1];
+	uint32_t i2 = cic->integrator[2];
+	uint32_t i3 = cic->integrator[3];
+	uint32_t phase = cic->phase;
+	uint32_t written = 0;
+	uint32_t value, delayed, i;
+
+	while (n--) {
+		// integrators, at the input rate
+		i0 += (uint32_t) CENTERED(*in);
+		in++;
+		value = i0;
+		if (stages > 1) {
+			i1 += i0;
+			value = i1;
+			if (stages > 2) {
+				i2 += i1;
+				value = i2;
+				if (stages > 3) {
+					i3 += i2;
+					value = i3;
+				}
+			}
+		}
+		if (++phase < factor) {
+			continue;
+		}
+		// combs, at the output rate
+		phase = 0;
+		for (i = 0; i < stages; i++) {
+			delayed = cic->comb[i];
+			cic->comb[i] = value;
+			value -= delayed;
+		}
+		out[written++] = (q31_t) (value << cic->shift);
+	}
+	cic->integrator[0] = i0;
+	cic->integrator[1] = i1;
+	cic->integrator[2] = i2;
+	cic->integrator[3] = i3;
+	cic->phase = phase;
+	return written;
+}
+
+uint8_t adc_moving_average_init(adc_moving_average_t *ma, void *history,
+		uint32_t log2_length) {
+	if (ma == 0 || history == 0 || log2_length > 16) {
+		return 0;
+	}
+	ma->history = history;
+	ma->log2_length = log2_length;
+	ma->index = 0;
+	ma->sum = 0;
+	return 1;
+}
+
+void adc_moving_average_q15(adc_moving_average_t *ma, const q15_t *in,
+		uint32_t n, q15_t *out) {
+	q15_t *history = ma->history;
+	const uint32_t shift = ma->log2_length;
+	const uint32_t mask = (1u << shift) - 1;
+	uint32_t index = ma->index;
+	// at most 2^16 values of 16 bits fit in 32 bits
+	int32_t sum = (int32_t) ma->sum;
+	q15_t value;
+
+#define MA_Q15_STEP(k)								\
+	value = in[k];									\
+	sum += value - history[index];					\
+	history[index] = value;							\
+	index = (index + 1) & mask;						\
+	out[k] = (q15_t) (sum >> shift);
+
+	// unrolled by four
+	while (n >= 4) {
+		MA_Q15_STEP(0)
+		MA_Q15_STEP(1)
+		MA_Q15_STEP(2)
+		MA_Q15_STEP(3)
+		in += 4;
+		out += 4;
+		n -= 4;
+	}
+	while (n--) {
+		MA_Q15_STEP(0)
+		in++;
+		out++;
+	}
+#undef MA_Q15_STEP
+
+	ma->index = index;
+	ma->sum = sum;
+}
+
+void adc_moving_average_q31(adc_moving_average_t *ma, const q31_t *in,
+		uint32_t n, q31_t *out) {
+	q31_t *history = ma->history;
+	const uint32_t shift = ma->log2_length;
+	const uint32_t mask = (1u << shift) - 1;
+	uint32_t index = ma->index;
+	int64_t sum = ma->sum;
+	q31_t value;
+
+#define MA_Q31_STEP(k)								\
+	value = in[k];									\
+	sum += (int64_t) value - history[index];		\
+	history[index] = value;							\
+	index = (index + 1) & mask;						\
+	out[k] = (q31_t) (sum >> shift);
+
+	// unrolled by two, the 64-bit sum takes more registers
+	while (n >= 2) {
+		MA_Q31_STEP(0)
+		MA_Q31_STEP(1)
+		in += 2;
+		out += 2;
+		n -= 2;
+	}
+	if (n) {
+		MA_Q31_STEP(0)
+	}
+#undef MA_Q31_STEP
+
+	ma->index = index;
+	ma->sum = sum;
+}
+
+uint8_t adc_filter_attach(adc_decimator_t *dec, q31_t *blocks,
+		uint32_t block_len, uint32_t block_count, uint8_t queue) {
+	if (dec == 0 || blocks == 0 || block_len == 0 || block_count < 2) {
+		return 0;
+	}
+	attached = 0;
+	dec->blocks = blocks;
+	dec->block_len = block_len;
+	dec->block_count = block_count;
+	dec->block = 0;
+	dec->fill = 0;
+	dec->queue = queue;
+	dec->published = 0;
+	dec->dropped = 0;
+	attached = dec;
+	return 1;
+}
+
+void adc_filter_detach(void) {
+	attached = 0;
+}
+
+void adc_filter_stream_callback(uint16_t *samples, uint32_t count) {
+	adc_decimator_t *dec = attached;
+	q31_t *block;
+	uint32_t room, chunk;
+
+	if (dec == 0) {
+		return;
+	}
+	while (count > 0) {
+		block = dec->blocks + dec->block * dec->block_len;
+		// the number of samples that fill the block exactly
+		room = ((dec->block_len - dec->fill) << dec->cic.log2_factor) -
+				dec->cic.phase;
+		chunk = (count < room) ? count : room;
+		dec->fill += adc_cic_q31(&dec->cic, samples, chunk,
+				block + dec->fill);
+		samples += chunk;
+		count -= chunk;
+		if (dec->fill < dec->block_len) {
+			break;
+		}
+		dec->published++;
+#if ADC_FILTER_COOS
+		if (dec->queue != ADC_FILTER_NO_QUEUE &&
+			isr_PostQueueMail(dec->queue, block) != E_OK) {
+			dec->dropped++;
+		}
+#endif
+		dec->fill = 0;
+		dec->block = (dec->block + 1) % dec->block_count;
+	}
+}
@@ -0,0 +1,192 @@
+/**
+ * @file adc_filter.h
+ * @brief ADC - Fixed-point decimation and averaging
+ * @details Kernels for oversampled ADC channels in Q15 and Q31 fixed point,
+ * written for the Cortex-M3 (no FPU): boxcar decimation, a CIC decimator
+ * with up to ADC_FILTER_CIC_MAX_STAGES stages and a moving average. The raw
+ * kernels take the 12-bit samples as they come from the ADC (channel tags
+ * are removed) and center them around 0, so 0 and 4095 become about -1.0
+ * and +1.0.
+ *
+ * A decimator can be attached to a stream (see adc_stream_start()) by using
+ * adc_filter_stream_callback() as its callback. Every block of decimated
+ * samples is then posted to a CoOS queue from the ADC interrupt.
+ *
+ * @pre The decimation factors are powers of two, given as log2.
+ * @pre CoOS delivery requires CFG_MAX_SERVICE_REQUEST > 0 and a queue
+ * created with CoCreateQueue() that holds at least block_count - 1 mails.
+ * @date 14 October 2026
+ */
+
+#ifndef ADC_FILTER_H_
+#define ADC_FILTER_H_
+
+#include <inttypes.h>
+#include "adc.h"
+#include "dsp.h"
+
+/*
+ * Set to 0 to build without the CoOS queue support, e.g. when the RTOS is
+ * not linked into the application.
+ */
+#ifndef ADC_FILTER_COOS
+#define ADC_FILTER_COOS				(1)
+#endif
+
+// Highest number of CIC stages
+#define ADC_FILTER_CIC_MAX_STAGES	(4)
+
+// Highest CIC gain (stages * log2_factor) that fits in Q31
+#define ADC_FILTER_CIC_MAX_GAIN		(20)
+
+// Highest log2 of a boxcar decimation factor
+#define ADC_FILTER_BOXCAR_MAX		(16)
+
+// No queue gets the blocks of a decimator
+#define ADC_FILTER_NO_QUEUE			(0xFFu)
+
+/**
+ * State of a CIC decimator, see adc_cic_init().
+ */
+typedef struct {
+	uint32_t stages;
+	uint32_t log2_factor;
+	uint32_t phase;
+	uint32_t shift;
+	// unsigned, so the integrators wrap around as the CIC needs
+	uint32_t integrator[ADC_FILTER_CIC_MAX_STAGES];
+	uint32_t comb[ADC_FILTER_CIC_MAX_STAGES];
+} adc_cic_t;
+
+/**
+ * State of a moving average, see adc_moving_average_init().
+ */
+typedef struct {
+	void *history;
+	uint32_t log2_length;
+	uint32_t index;
+	int64_t sum;
+} adc_moving_average_t;
+
+/**
+ * A CIC decimator that is fed by a stream and publishes blocks of decimated
+ * samples, see adc_filter_attach().
+ */
+typedef struct {
+	adc_cic_t cic;
+	q31_t *blocks;
+	uint32_t block_len;
+	uint32_t block_count;
+	uint32_t block;
+	uint32_t fill;
+	uint8_t queue;
+	volatile uint32_t published;
+	volatile uint32_t dropped;
+} adc_decimator_t;
+
+/**
+ * Converts raw samples to Q15.
+ * @param in Raw (tagged or untagged) samples.
+ * @param n The number of samples.
+ * @param out The Q15 values, n of them.
+ */
+void adc_to_q15(const uint16_t *in, uint32_t n, q15_t *out);
+
+/**
+ * Boxcar decimation: the mean of every 2^log2_factor raw samples in Q15.
+ * Samples left over after the last full block are ignored.
+ * @param in Raw samples.
+ * @param n The number of samples.
+ * @param log2_factor log2 of the decimation factor (0-16).
+ * @param out The Q15 means, n >> log2_factor of them.
+ * @return The number of values written to out.
+ */
+uint32_t adc_boxcar_q15(const uint16_t *in, uint32_t n, uint32_t log2_factor,
+		q15_t *out);
+
+/**
+ * Initializes a CIC decimator with a differential delay of 1. The gain
+ * (2^log2_factor)^stages is removed from the output.
+ * @param cic The decimator.
+ * @param stages The number of integrator and comb stages (1-4). One stage
+ * is a boxcar.
+ * @param log2_factor log2 of the decimation factor.
+ * @return 1 on success, 0 if the stages are invalid or
+ * stages * log2_factor > ADC_FILTER_CIC_MAX_GAIN.
+ */
+uint8_t adc_cic_init(adc_cic_t *cic, uint32_t stages, uint32_t log2_factor);
+
+/**
+ * Runs raw samples through a CIC decimator. The state is kept between
+ * calls, so a stream can be fed in pieces of any length.
+ * @param cic The decimator.
+ * @param in Raw samples.
+ * @param n The number of samples.
+ * @param out The Q31 output, room for (n >> log2_factor) + 1 values.
+ * @return The number of values written to out.
+ */
+uint32_t adc_cic_q31(adc_cic_t *cic, const uint16_t *in, uint32_t n,
+		q31_t *out);
+
+/**
+ * Initializes a moving average over 2^log2_length values.
+ * @param ma The moving average.
+ * @param history Room for 2^log2_length values of the type that is averaged
+ * (q15_t or q31_t).
+ * @param log2_length log2 of the length (0-16).
+ * @return 1 on success, 0 if the parameters are invalid.
+ */
+uint8_t adc_moving_average_init(adc_moving_average_t *ma, void *history,
+		uint32_t log2_length);
+
+/**
+ * Moving average of Q15 values, one output per input. The history must
+ * hold q15_t values.
+ * @param ma The moving average.
+ * @param in The values.
+ * @param n The number of values.
+ * @param out The averages, n of them. May be the same as in.
+ */
+void adc_moving_average_q15(adc_moving_average_t *ma, const q15_t *in,
+		uint32_t n, q15_t *out);
+
+/**
+ * Moving average of Q31 values, one output per input. The history must
+ * hold q31_t values.
+ * @param ma The moving average.
+ * @param in The values.
+ * @param n The number of values.
+ * @param out The averages, n of them. May be the same as in.
+ */
+void adc_moving_average_q31(adc_moving_average_t *ma, const q31_t *in,
+		uint32_t n, q31_t *out);
+
+/**
+ * Attaches a CIC decimator to adc_filter_stream_callback(). The decimated
+ * samples are collected in blocks, which are used round-robin; a posted
+ * block must be consumed before the decimator comes back to it.
+ * @param dec The decimator, its cic member initialized with adc_cic_init().
+ * @param blocks Room for block_count * block_len values.
+ * @param block_len The number of decimated samples in each block.
+ * @param block_count The number of blocks (at least 2).
+ * @param queue The CoOS queue that gets a pointer to every full block, or
+ * ADC_FILTER_NO_QUEUE.
+ * @return 1 on success, 0 if the parameters are invalid.
+ */
+uint8_t adc_filter_attach(adc_decimator_t *dec, q31_t *blocks,
+		uint32_t block_len, uint32_t block_count, uint8_t queue);
+
+/**
+ * Detaches the decimator, the stream callback does nothing afterwards.
+ */
+void adc_filter_detach(void);
+
+/**
+ * Stream callback (adc_stream_callback_t) that feeds the attached
+ * decimator. The stream must contain one channel.
+ * @param samples The full half of the stream buffer.
+ * @param count The number of samples in it.
+ */
+void adc_filter_stream_callback(uint16_t *samples, uint32_t count);
+
+#endif
@@ -0,0 +1,116 @@
+/**
+ * @file
+ * @brief Bit-band - Atomic single-bit access to registers and SRAM
+ * @details The Cortex-M3 maps every bit of the first megabyte of SRAM
+ * (0x20000000, both SRAM0 and SRAM1 of the SAM3X) and of the peripherals
+ * (0x40000000) to a word of an alias region. A store of 0 or 1 to the word
+ * clears or sets the bit with one bus cycle that can not be interrupted, a
+ * load reads it. A bit shared with interrupt handlers can then be changed
+ * without a read-modify-write sequence and without masking interrupts:
+ *
+ *     bitband_clear(&taken, channel);
+ *
+ * instead of
+ *
+ *     primask = irq_save();
+ *     taken &= ~(1u << channel);
+ *     irq_restore(primask);
+ *
+ * Only a single bit is atomic. Searching for a free bit and taking it, or
+ * writing a field of several bits, still needs a critical section.
+ *
+ * On the host there is no alias region, the helpers fall back to a
+ * read-modify-write of the word.
+ *
+ * @pre The word must be in SRAM or a peripheral register (not flash or the
+ * system control space) and word-aligned.
+ *
+ * @date 14 October 2026
+ */
+
+#ifndef BITBAND_H_
+#define BITBAND_H_
+
+#include <inttypes.h>
+#include "periph.h"
+
+///@cond
+// Distance of the alias from its region, 0x22000000 for the SRAM and
+// 0x42000000 for the peripherals
+#define BITBAND_ALIAS_OFFSET	(0x02000000u)
+///@endcond
+
+#if PERIPH_HOST
+// No alias region on the host
+static inline void bitband_write(volatile void *word, uint32_t bit,
+		uint32_t value) {
+	volatile uint32_t *p = (volatile uint32_t *) word;
+
+	if (value) {
+		*p |= (0x1u << bit);
+	} else {
+		*p &= ~(0x1u << bit);
+	}
+}
+
+static inline uint32_t bitband_read(const volatile void *word, uint32_t bit) {
+	return (*(const volatile uint32_t *) word >> bit) & 0x1u;
+}
+#else
+/**
+ * The alias word of a bit.
+ * @param word The word, in SRAM or a peripheral register.
+ * @param bit The bit of the word (0-31).
+ * @return The address of the alias word.
+ */
+static inline volatile uint32_t *bitband_alias(const volatile void *word,
+		uint32_t bit) {
+	uint32_t addr = (uint32_t) word;
+	// 0x20000000 or 0x40000000
+	uint32_t region = addr & 0xF0000000u;
+
+	return (volatile uint32_t *) (region + BITBAND_ALIAS_OFFSET +
+			((addr - region) << 5) + (bit << 2));
+}
+
+/**
+ * Sets or clears a bit with one store.
+ * @param word The word, in SRAM or a peripheral register.
+ * @param bit The bit of the word (0-31).
+ * @param value Non-zero to set the bit, zero to clear it.
+ */
+static inline void bitband_write(volatile void *word, uint32_t bit,
+		uint32_t value) {
+	*bitband_alias(word, bit) = (value != 0);
+}
+
+/**
+ * Reads a bit with one load.
+ * @param word The word, in SRAM or a peripheral register.
+ * @param bit The bit of the word (0-31).
+ * @return 1 if the bit is set, otherwise 0.
+ */
+static inline uint32_t bitband_read(const volatile void *word, uint32_t bit) {
+	return *bitband_alias(word, bit);
+}
+#endif
+
+/**
+ * Sets a bit with one store.
+ * @param word The word, in SRAM or a peripheral register.
+ * @param bit The bit of the word (0-31).
+ */
+static inline void bitband_set(volatile void *word, uint32_t bit) {
+	bitband_write(word, bit, 1);
+}
+
+/**
+ * Clears a bit with one store.
+ * @param word The word, in SRAM or a peripheral register.
+ * @param bit The bit of the word (0-31).
+ */
+static inline void bitband_clear(volatile void *word, uint32_t bit) {
+	bitband_write(word, bit, 0);
+}
+
+#endif
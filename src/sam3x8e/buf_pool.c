@@ -0,0 +1,412 @@
+/*
+ * buf_pool.c
+ *
+ * Date:	14 October 2026
+ */
+
+#include "buf_pool.h"
+#include "uart.h"
+#include "adc.h"
+#include "dacc.h"
+#include "rtos/CoOS.h"
+#include "irq.h"
+
+// Buffer in flight on the UART
+static buf_t *uart_buf;
+
+// Buffers in flight on USART0-3
+static buf_t *usart_buf[4];
+
+// Buffer in flight on the SPI, only one transfer runs at a time
+static struct {
+	buf_t *buf;
+	buf_done_t done;
+} spi_job;
+
+// Buffers in flight on TWI0 and TWI1, the packets must stay valid
+static struct {
+	twi_packet_t packet;
+	buf_t *buf;
+	buf_done_t done;
+} twi_job[2];
+
+static struct {
+	const buf_pool_t *pool;
+	uint32_t half_samples;
+	buf_done_t done;
+	// The buffers of the two halves
+	buf_t *half[2];
+} adc_job;
+
+static struct {
+	buf_source_t source;
+	// The buffers of the two halves
+	buf_t *half[2];
+} dacc_job;
+
+uint8_t buf_pool_init(buf_pool_t *pool, uint32_t *memory, uint32_t size,
+		uint32_t count) {
+	// CoCreateMemPartition() counts the blocks in a byte
+	if (pool == 0 || memory == 0 || size == 0 || size > 0xFFFF || count < 2 ||
+		count > 255) {
+		return 0;
+	}
+	pool->size = (uint16_t) ((size + 3) & ~3u);
+	pool->partition = CoCreateMemPartition((U8 *) memory,
+			BUF_HEADER_SIZE + pool->size, count);
+	return pool->partition != (OS_MMID) E_CREATE_FAIL;
+}
+
+buf_t *buf_alloc(const buf_pool_t *pool) {
+	// lock-free, see CoGetMemoryBuffer()
+	buf_t *buf = CoGetMemoryBuffer(pool->partition);
+
+	if (buf) {
+		buf->pool = pool->partition;
+		buf->refs = 1;
+		buf->size = pool->size;
+		buf->offset = 0;
+		buf->length = 0;
+	}
+	return buf;
+}
+
+buf_t *buf_ref(buf_t *buf) {
+	uint32_t primask = irq_save();
+
+	buf->refs++;
+	irq_restore(primask);
+	return buf;
+}
+
+void buf_release(buf_t *buf) {
+	uint32_t primask;
+	uint8_t refs;
+
+	if (buf == 0) {
+		return;
+	}
+	primask = irq_save();
+	refs = --buf->refs;
+	irq_restore(primask);
+	if (refs == 0) {
+		CoFreeMemoryBuffer(buf->pool, buf);
+	}
+}
+
+uint8_t buf_reserve(buf_t *buf, uint32_t bytes) {
+	if (buf->length != 0 || bytes > buf->size) {
+		return 0;
+	}
+	buf->offset = (uint16_t) bytes;
+	return 1;
+}
+
+uint8_t *buf_put(buf_t *buf, uint32_t bytes) {
+	uint8_t *end;
+
+	if (bytes > (uint32_t) (buf->size - buf->offset - buf->length)) {
+		return 0;
+	}
+	end = buf_data(buf) + buf->length;
+	buf->length += (uint16_t) bytes;
+	return end;
+}
+
+uint8_t *buf_push(buf_t *buf, uint32_t bytes) {
+	if (bytes > buf->offset) {
+		return 0;
+	}
+	buf->offset -= (uint16_t) bytes;
+	buf->length += (uint16_t) bytes;
+	return buf_data(buf);
+}
+
+uint8_t *buf_pull(buf_t *buf, uint32_t bytes) {
+	if (bytes > buf->length) {
+		return 0;
+	}
+	buf->offset += (uint16_t) bytes;
+	buf->length -= (uint16_t) bytes;
+	return buf_data(buf);
+}
+
+static void uart_done(void) {
+	buf_t *buf = uart_buf;
+
+	uart_buf = 0;
+	buf_release(buf);
+}
+
+uint8_t buf_uart_write(buf_t *buf) {
+	if (uart_write_dma_busy()) {
+		return 0;
+	}
+	uart_buf = buf;
+	if (!uart_write_dma(buf_data(buf), buf->length, uart_done)) {
+		uart_buf = 0;
+		return 0;
+	}
+	return 1;
+}
+
+static buf_t **usart_slot(usart_reg_t *usart) {
+	if (usart == USART0) {
+		return &usart_buf[0];
+	} else if (usart == USART1) {
+		return &usart_buf[1];
+	} else if (usart == USART2) {
+		return &usart_buf[2];
+	} else if (usart == USART3) {
+		return &usart_buf[3];
+	}
+	return 0;
+}
+
+static void usart_done(usart_reg_t *usart) {
+	buf_t **slot = usart_slot(usart);
+	buf_t *buf = *slot;
+
+	*slot = 0;
+	buf_release(buf);
+}
+
+uint8_t buf_usart_write(usart_reg_t *usart, buf_t *buf) {
+	buf_t **slot = usart_slot(usart);
+
+	if (slot == 0 || usart_write_dma_busy(usart)) {
+		return 0;
+	}
+	*slot = buf;
+	if (!usart_write_dma(usart, buf_data(buf), buf->length, usart_done)) {
+		*slot = 0;
+		return 0;
+	}
+	return 1;
+}
+
+static void spi_done(spi_reg_t *spi) {
+	buf_t *buf = spi_job.buf;
+	buf_done_t done = spi_job.done;
+
+	(void) spi;
+	spi_job.buf = 0;
+	if (done) {
+		done(buf, 1);
+	} else {
+		buf_release(buf);
+	}
+}
+
+uint8_t buf_spi_transfer(spi_reg_t *spi, uint8_t selector, buf_t *buf,
+		buf_done_t done) {
+	const uint32_t *csr = &spi->SPI_CSR0;
+	uint32_t words;
+
+	if (spi->SPI_MR & SPI_MR_PS_MASK) {
+		return 0;
+	}
+	// the Chip Select Register of the slave, as spi_transfer() finds it
+	if (spi->SPI_MR & SPI_MR_PCSDEC_MASK) {
+		csr += selector >> 2;
+	} else {
+		csr += selector & 3u;
+	}
+	words = (*csr & SPI_CSRx_BITS_MASK) ? buf->length / 2 : buf->length;
+	if (words == 0 || spi_job.buf != 0) {
+		return 0;
+	}
+	spi_job.buf = buf;
+	spi_job.done = done;
+	if (!spi_transfer_async(spi, selector, buf_data(buf), buf_data(buf), words,
+			spi_done)) {
+		spi_job.buf = 0;
+		return 0;
+	}
+	return 1;
+}
+
+static void twi_done(twi_reg_t *twi, uint8_t result) {
+	uint32_t n = (twi == TWI0) ? 0 : 1;
+	buf_t *buf = twi_job[n].buf;
+	buf_done_t done = twi_job[n].done;
+
+	twi_job[n].buf = 0;
+	if (done) {
+		done(buf, result == TWI_RESULT_OK);
+	} else {
+		buf_release(buf);
+	}
+}
+
+// Sets up the packet of a TWI, returns 0 if a buffer is in flight
+static uint8_t twi_prepare(twi_reg_t *twi, uint8_t chip, uint32_t address,
+		uint8_t address_length, uint8_t *data, uint32_t length, buf_t *buf,
+		buf_done_t done) {
+	uint32_t n = (twi == TWI0) ? 0 : 1;
+
+	if (twi_job[n].buf != 0 || twi_master_busy(twi)) {
+		return 0;
+	}
+	twi_job[n].packet.chip = chip;
+	twi_job[n].packet.address = address;
+	twi_job[n].packet.address_length = address_length;
+	twi_job[n].packet.buffer = data;
+	twi_job[n].packet.length = length;
+	twi_job[n].buf = buf;
+	twi_job[n].done = done;
+	return 1;
+}
+
+uint8_t buf_twi_write(twi_reg_t *twi, uint8_t chip, uint32_t address,
+		uint8_t address_length, buf_t *buf, buf_done_t done) {
+	uint32_t n = (twi == TWI0) ? 0 : 1;
+
+	if (!twi_prepare(twi, chip, address, address_length, buf_data(buf),
+			buf->length, buf, done)) {
+		return 0;
+	}
+	// twi_master_write_dma() returns 0 on success
+	if (twi_master_write_dma(twi, &twi_job[n].packet, twi_done)) {
+		twi_job[n].buf = 0;
+		return 0;
+	}
+	return 1;
+}
+
+uint8_t buf_twi_read(twi_reg_t *twi, uint8_t chip, uint32_t address,
+		uint8_t address_length, buf_t *buf, uint32_t length, buf_done_t done) {
+	uint32_t n = (twi == TWI0) ? 0 : 1;
+	uint8_t *end = buf_data(buf) + buf->length;
+
+	if (done == 0 || length == 0 ||
+		length > (uint32_t) (buf->size - buf->offset - buf->length)) {
+		return 0;
+	}
+	if (!twi_prepare(twi, chip, address, address_length, end, length, buf,
+			done)) {
+		return 0;
+	}
+	// the bytes count as data once they have been read
+	buf->length += (uint16_t) length;
+	if (twi_master_read_dma(twi, &twi_job[n].packet, twi_done)) {
+		buf->length -= (uint16_t) length;
+		twi_job[n].buf = 0;
+		return 0;
+	}
+	return 1;
+}
+
+static void adc_done(uint16_t *samples, uint32_t count) {
+	uint32_t n = ((uint8_t *) samples == buf_data(adc_job.half[0])) ? 0 : 1;
+	buf_t *full = adc_job.half[n];
+	buf_t *fresh = buf_alloc(adc_job.pool);
+
+	if (fresh == 0) {
+		// no buffer to take its place, the half is filled again
+		return;
+	}
+	adc_stream_swap((uint16_t *) buf_data(fresh));
+	adc_job.half[n] = fresh;
+	full->length = (uint16_t) (count * sizeof(uint16_t));
+	adc_job.done(full, 1);
+}
+
+uint8_t buf_adc_stream_start(const buf_pool_t *pool, uint32_t half_samples,
+		buf_done_t done) {
+	uint32_t primask;
+
+	if (pool == 0 || done == 0 || half_samples == 0 ||
+		half_samples * sizeof(uint16_t) > pool->size) {
+		return 0;
+	}
+	buf_adc_stream_stop();
+	adc_job.half[0] = buf_alloc(pool);
+	adc_job.half[1] = buf_alloc(pool);
+	if (adc_job.half[0] == 0 || adc_job.half[1] == 0) {
+		buf_release(adc_job.half[0]);
+		buf_release(adc_job.half[1]);
+		adc_job.half[0] = 0;
+		adc_job.half[1] = 0;
+		return 0;
+	}
+	adc_job.pool = pool;
+	adc_job.half_samples = half_samples;
+	adc_job.done = done;
+	/*
+	 * adc_stream_start() queues the half after the first one, which is
+	 * replaced by the second buffer before the PDC gets there.
+	 */
+	primask = irq_save();
+	adc_stream_start((uint16_t *) buf_data(adc_job.half[0]), half_samples,
+			adc_done);
+	adc_stream_swap((uint16_t *) buf_data(adc_job.half[1]));
+	irq_restore(primask);
+	return 1;
+}
+
+void buf_adc_stream_stop(void) {
+	if (adc_job.half[0] == 0) {
+		return;
+	}
+	adc_stream_stop();
+	buf_release(adc_job.half[0]);
+	buf_release(adc_job.half[1]);
+	adc_job.half[0] = 0;
+	adc_job.half[1] = 0;
+}
+
+static void dacc_done(uint16_t *samples, uint32_t count) {
+	uint32_t n = ((uint8_t *) samples == buf_data(dacc_job.half[0])) ? 0 : 1;
+	buf_t *sent = dacc_job.half[n];
+	buf_t *next = dacc_job.source();
+
+	(void) count;
+	if (next == 0) {
+		// the sent half goes out again
+		return;
+	}
+	dacc_stream_swap((uint16_t *) buf_data(next));
+	dacc_job.half[n] = next;
+	buf_release(sent);
+}
+
+uint8_t buf_dacc_stream_start(buf_t *first, buf_t *second,
+		buf_source_t source) {
+	uint32_t primask;
+	uint8_t started;
+
+	if (first == 0 || second == 0 || source == 0 ||
+		first->length != second->length || first->length < 2 ||
+		((first->offset | second->offset) & 3u)) {
+		return 0;
+	}
+	buf_dacc_stream_stop();
+	dacc_job.source = source;
+	dacc_job.half[0] = first;
+	dacc_job.half[1] = second;
+	// see buf_adc_stream_start()
+	primask = irq_save();
+	started = dacc_stream_start((uint16_t *) buf_data(first),
+			first->length / sizeof(uint16_t), dacc_done);
+	if (started) {
+		dacc_stream_swap((uint16_t *) buf_data(second));
+	}
+	irq_restore(primask);
+	if (!started) {
+		dacc_job.half[0] = 0;
+		dacc_job.half[1] = 0;
+	}
+	return started;
+}
+
+void buf_dacc_stream_stop(void) {
+	if (dacc_job.half[0] == 0) {
+		return;
+	}
+	dacc_stream_stop();
+	buf_release(dacc_job.half[0]);
+	buf_release(dacc_job.half[1]);
+	dacc_job.half[0] = 0;
+	dacc_job.half[1] = 0;
+}
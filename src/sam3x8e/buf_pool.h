@@ -0,0 +1,256 @@
+/**
+ * @file buf_pool.h
+ * @brief Reference counted buffers shared by the DMA drivers
+ * @details A pool hands out fixed-size buffers taken from a CoOS memory
+ * partition (CoCreateMemPartition()). Each buffer starts with a small header
+ * that holds a reference count and the offset and length of its data, so a
+ * buffer filled by one driver can be passed by pointer through
+ * CoPostQueueMail() to the next stage and written out by another driver
+ * without copying.
+ *
+ * A buffer returned by buf_alloc() has one reference. Whoever holds a
+ * reference either passes it on or calls buf_release(); the buffer goes back
+ * to its pool when the last reference is released. buf_ref() adds a
+ * reference, e.g. to send the same data twice.
+ *
+ * The buf_*_write(), buf_spi_transfer() and buf_twi_*() functions start a
+ * DMA transfer of a buffer and take over the reference of the caller when
+ * they return 1. The buffer is released when the transfer is done, or given
+ * to the done callback. The streams keep handing full buffers of samples to
+ * a callback (ADC) or take them from one (DACC).
+ *
+ * buf_alloc(), buf_ref() and buf_release() may be called from interrupt
+ * handlers.
+ *
+ * @pre The peripherals must be initialized as their drivers require, and
+ * dmac_init() must be called before buf_spi_transfer().
+ * @date 14 October 2026
+ */
+
+#ifndef BUF_POOL_H_
+#define BUF_POOL_H_
+
+#include <inttypes.h>
+#include "usart.h"
+#include "spi.h"
+#include "twi.h"
+
+// Bytes of the header in front of the data of a buffer
+#define BUF_HEADER_SIZE		(8)
+
+// Words of memory for a pool of count buffers with size bytes of data
+#define BUF_POOL_WORDS(size, count)	\
+	((count) * ((BUF_HEADER_SIZE + (size) + 3) / 4))
+
+/**
+ * A buffer, the header is followed by the data.
+ */
+typedef struct {
+	// Memory partition of the pool
+	uint8_t pool;
+	volatile uint8_t refs;
+	// Bytes of room for data
+	uint16_t size;
+	// The data starts offset bytes into the room
+	uint16_t offset;
+	// Bytes of data
+	uint16_t length;
+	uint32_t room[];
+} buf_t;
+
+/**
+ * A pool of buffers, see buf_pool_init().
+ */
+typedef struct {
+	uint8_t partition;
+	uint16_t size;
+} buf_pool_t;
+
+/**
+ * Called from an interrupt handler with a buffer that has been filled, or
+ * whose transfer is done. The reference is passed on to the callback.
+ * @param buf The buffer.
+ * @param result 1 if the transfer succeeded, otherwise 0.
+ */
+typedef void (*buf_done_t)(buf_t *buf, uint8_t result);
+
+/**
+ * Called from the DACC interrupt for the next buffer of samples to send.
+ * @return A buffer with as many samples as the first ones (its reference is
+ * passed on to the stream), or 0 to send the last buffer again.
+ */
+typedef buf_t *(*buf_source_t)(void);
+
+/**
+ * Creates a pool of buffers in a new CoOS memory partition.
+ * @param pool The pool.
+ * @param memory BUF_POOL_WORDS(size, count) words.
+ * @param size Bytes of room in each buffer (1-65535).
+ * @param count Number of buffers (at least 2).
+ * @return 1 on success, 0 if the parameters are invalid or no memory
+ * partition is left (CFG_MAX_MM).
+ */
+uint8_t buf_pool_init(buf_pool_t *pool, uint32_t *memory, uint32_t size,
+		uint32_t count);
+
+/**
+ * Takes a buffer from a pool. It has one reference and no data.
+ * @param pool The pool.
+ * @return The buffer, or 0 if the pool is empty.
+ */
+buf_t *buf_alloc(const buf_pool_t *pool);
+
+/**
+ * Adds a reference to a buffer.
+ * @param buf The buffer.
+ * @return The buffer.
+ */
+buf_t *buf_ref(buf_t *buf);
+
+/**
+ * Releases a reference to a buffer, the last one gives the buffer back to
+ * its pool.
+ * @param buf The buffer, may be 0.
+ */
+void buf_release(buf_t *buf);
+
+/**
+ * @param buf The buffer.
+ * @return The first byte of the data.
+ */
+static inline uint8_t *buf_data(buf_t *buf) {
+	return (uint8_t *) buf->room + buf->offset;
+}
+
+/**
+ * Leaves room in front of the data of an empty buffer, e.g. for a header
+ * that is added later with buf_push().
+ * @param buf The buffer.
+ * @param bytes Bytes of room.
+ * @return 1 on success, 0 if the buffer is not empty or too small.
+ */
+uint8_t buf_reserve(buf_t *buf, uint32_t bytes);
+
+/**
+ * Adds bytes at the end of the data.
+ * @param buf The buffer.
+ * @param bytes The number of bytes.
+ * @return Where the added bytes go, or 0 if there is not enough room.
+ */
+uint8_t *buf_put(buf_t *buf, uint32_t bytes);
+
+/**
+ * Adds bytes in front of the data.
+ * @param buf The buffer.
+ * @param bytes The number of bytes.
+ * @return Where the added bytes go, or 0 if not enough room was reserved.
+ */
+uint8_t *buf_push(buf_t *buf, uint32_t bytes);
+
+/**
+ * Removes bytes from the front of the data, e.g. a header that has been
+ * handled.
+ * @param buf The buffer.
+ * @param bytes The number of bytes.
+ * @return The new first byte of the data, or 0 if there are fewer bytes.
+ */
+uint8_t *buf_pull(buf_t *buf, uint32_t bytes);
+
+/**
+ * Sends the data of a buffer with uart_write_dma(), and releases it when it
+ * has been sent.
+ * @param buf The buffer, with 1-65535 bytes of data.
+ * @return 1 if the transfer was started, 0 if the UART is busy.
+ */
+uint8_t buf_uart_write(buf_t *buf);
+
+/**
+ * Sends the data of a buffer with usart_write_dma(), and releases it when it
+ * has been sent.
+ * @param usart The USART.
+ * @param buf The buffer, with 1-65535 bytes of data.
+ * @return 1 if the transfer was started, 0 if the USART is busy.
+ */
+uint8_t buf_usart_write(usart_reg_t *usart, buf_t *buf);
+
+/**
+ * Transfers the data of a buffer with spi_transfer_async(), the received
+ * words replace the sent ones. The data is taken as bytes, or as halfwords
+ * if the selector uses more than 8 bits per transfer. Variable peripheral
+ * select is not supported.
+ * @param spi The SPI.
+ * @param selector The slave.
+ * @param buf The buffer.
+ * @param done Gets the buffer when done, or 0 to release it.
+ * @return 1 if the transfer was started, 0 if the SPI is busy.
+ */
+uint8_t buf_spi_transfer(spi_reg_t *spi, uint8_t selector, buf_t *buf,
+		buf_done_t done);
+
+/**
+ * Writes the data of a buffer to a slave with twi_master_write_dma().
+ * @param twi The TWI.
+ * @param chip The device address of the slave.
+ * @param address The internal address in the slave.
+ * @param address_length The size of the internal address (0-3 bytes).
+ * @param buf The buffer.
+ * @param done Gets the buffer when done, or 0 to release it.
+ * @return 1 if the transfer was started, 0 if the TWI is busy.
+ */
+uint8_t buf_twi_write(twi_reg_t *twi, uint8_t chip, uint32_t address,
+		uint8_t address_length, buf_t *buf, buf_done_t done);
+
+/**
+ * Reads from a slave into a buffer with twi_master_read_dma(). The bytes
+ * are added at the end of the data.
+ * @param twi The TWI.
+ * @param chip The device address of the slave.
+ * @param address The internal address in the slave.
+ * @param address_length The size of the internal address (0-3 bytes).
+ * @param buf The buffer.
+ * @param length The number of bytes to read.
+ * @param done Gets the buffer when done.
+ * @return 1 if the transfer was started, 0 if the TWI is busy or the buffer
+ * has not enough room.
+ */
+uint8_t buf_twi_read(twi_reg_t *twi, uint8_t chip, uint32_t address,
+		uint8_t address_length, buf_t *buf, uint32_t length, buf_done_t done);
+
+/**
+ * Starts an ADC stream (adc_stream_start()) into buffers of a pool. Each
+ * full half is a buffer of half_samples samples that is given to the
+ * callback, and a new buffer takes its place. When the pool is empty the
+ * half is filled again and its samples are lost.
+ * @param pool The pool, room for half_samples samples in each buffer.
+ * @param half_samples The number of samples in each buffer.
+ * @param done Gets the full buffers.
+ * @return 1 on success, 0 if the parameters are invalid or the pool has
+ * less than two buffers free.
+ */
+uint8_t buf_adc_stream_start(const buf_pool_t *pool, uint32_t half_samples,
+		buf_done_t done);
+
+/**
+ * Stops the ADC stream and releases its buffers.
+ */
+void buf_adc_stream_stop(void);
+
+/**
+ * Starts a DACC stream (dacc_stream_start()) from buffers. Each buffer
+ * that has been sent is released and replaced by the next one from the
+ * source. The stream takes over the references of both buffers.
+ * @param first The first buffer of samples, word-aligned data.
+ * @param second The second buffer, with as many samples.
+ * @param source Gives the next buffers.
+ * @return 1 on success, 0 if the parameters are invalid (the caller keeps
+ * the references).
+ */
+uint8_t buf_dacc_stream_start(buf_t *first, buf_t *second,
+		buf_source_t source);
+
+/**
+ * Stops the DACC stream and releases its buffers.
+ */
+void buf_dacc_stream_stop(void);
+
+#endif
@@ -0,0 +1,294 @@
+/*
+ * can.c
+ *
+ * Date:	14 October 2026
+ */
+
+#include "can.h"
+#include "pmc.h"
+#include "id.h"
+#include "ramfunc.h"
+#if CAN_COOS
+#include "rtos/CoOS.h"
+#endif
+
+///@cond
+// NVIC Interrupt Set-Enable Register 1 (peripheral ID 32-63)
+#define NVIC_ISER1		(*((volatile uint32_t *) PERIPH_ADDR(0xE000E104U)))
+// NVIC Interrupt Clear-Enable Register 1 (peripheral ID 32-63)
+#define NVIC_ICER1		(*((volatile uint32_t *) PERIPH_ADDR(0xE000E184U)))
+
+// Time quanta of a bit, and of its segments
+#define CAN_TQ_MIN		(8u)
+#define CAN_TQ_MAX		(25u)
+#define CAN_SEG_MAX		(8u)
+// Prescaler of a time quantum, BRP + 1
+#define CAN_BRP_MIN		(2u)
+#define CAN_BRP_MAX		(128u)
+///@endcond
+
+/*
+ * State of a controller. The ring indices are free-running and only written
+ * by one side each, so no locking is needed.
+ */
+typedef struct {
+	can_frame_t frames[CAN_RX_BUFFER_SIZE];
+	volatile uint32_t head;	// written by the interrupt handler
+	volatile uint32_t tail;	// written by can_read()
+	volatile uint32_t dropped;
+	uint8_t sem;
+} can_state_t;
+
+static can_state_t states[2] = {
+	{ .sem = CAN_NO_SEM },
+	{ .sem = CAN_NO_SEM }
+};
+
+static inline uint32_t can_index(can_reg_t *can) {
+	return (can == CAN1);
+}
+
+static inline uint32_t can_id(can_reg_t *can) {
+	return ID_CAN0 + can_index(can);
+}
+
+/*
+ * Finds the bit timing for a bit rate, the most time quanta first because
+ * they give the finest resynchronization.
+ */
+static uint32_t bit_timing(uint32_t mck, uint32_t baud) {
+	uint32_t tq, brp, phase1, phase2, propag, sjw;
+
+	if (baud == 0) {
+		return 0;
+	}
+	for (tq = CAN_TQ_MAX; tq >= CAN_TQ_MIN; tq--) {
+		if (mck % (baud * tq)) {
+			continue;
+		}
+		brp = mck / (baud * tq);
+		if (brp < CAN_BRP_MIN || brp > CAN_BRP_MAX) {
+			continue;
+		}
+		// sample point at about 80 %, phase 2 is at least the 2 quanta
+		// of the information processing time
+		phase2 = (tq + 2) / 5;
+		if (phase2 < 2) {
+			phase2 = 2;
+		}
+		// the rest after the sync quantum is split evenly
+		propag = (tq - 1 - phase2) / 2;
+		phase1 = tq - 1 - phase2 - propag;
+		if (phase1 > CAN_SEG_MAX || propag > CAN_SEG_MAX) {
+			continue;
+		}
+		sjw = (phase1 < phase2) ? phase1 : phase2;
+		if (sjw > 4) {
+			sjw = 4;
+		}
+		return CAN_BR_BRP(brp - 1) | CAN_BR_SJW(sjw - 1) |
+				CAN_BR_PROPAG(propag - 1) | CAN_BR_PHASE1(phase1 - 1) |
+				CAN_BR_PHASE2(phase2 - 1);
+	}
+	return 0;
+}
+
+uint8_t can_init(can_reg_t *can, uint32_t baud) {
+	uint32_t br = bit_timing(pmc_get_mck_freq(), baud);
+	uint32_t mb;
+	can_state_t *state = &states[can_index(can)];
+
+	if (br == 0) {
+		return 0;
+	}
+	pmc_acquire_peripheral_clock(can_id(can));
+	// the bit timing can only be changed while the controller is disabled
+	can->CAN_MR = 0;
+	can->CAN_IDR = 0xFFFFFFFFu;
+	for (mb = 0; mb < CAN_MAILBOXES; mb++) {
+		can->CAN_MB[mb].CAN_MMR = CAN_MMR_MOT_DISABLED;
+	}
+	state->head = 0;
+	state->tail = 0;
+	state->dropped = 0;
+	can->CAN_BR = br;
+	NVIC_ISER1 = (0x1u << (can_id(can) - 32));
+	can->CAN_MR = CAN_MR_CANEN;
+	return 1;
+}
+
+void can_deinit(can_reg_t *can) {
+	can->CAN_IDR = 0xFFFFFFFFu;
+	can->CAN_MR = 0;
+	NVIC_ICER1 = (0x1u << (can_id(can) - 32));
+	pmc_release_peripheral_clock(can_id(can));
+}
+
+uint8_t can_rx_mailbox(can_reg_t *can, uint32_t mb, uint32_t id,
+		uint32_t mask, uint8_t extended) {
+	can_mb_reg_t *box;
+
+	if (mb >= CAN_MAILBOXES) {
+		return 0;
+	}
+	box = &can->CAN_MB[mb];
+	can->CAN_IDR = CAN_SR_MB(mb);
+	box->CAN_MMR = CAN_MMR_MOT_DISABLED;
+	// MIDE in the mask, so only frames of the format are taken
+	if (extended) {
+		box->CAN_MAM = CAN_MID_EXT(mask) | CAN_MID_MIDE;
+		box->CAN_MID = CAN_MID_EXT(id) | CAN_MID_MIDE;
+	} else {
+		box->CAN_MAM = CAN_MID_STD(mask) | CAN_MID_MIDE;
+		box->CAN_MID = CAN_MID_STD(id);
+	}
+	box->CAN_MMR = CAN_MMR_MOT_RX;
+	// allow the first reception
+	box->CAN_MCR = CAN_MCR_MTCR;
+	can->CAN_IER = CAN_SR_MB(mb);
+	return 1;
+}
+
+uint8_t can_tx_mailbox(can_reg_t *can, uint32_t mb, uint32_t priority) {
+	if (mb >= CAN_MAILBOXES || priority > CAN_PRIORITY_MAX) {
+		return 0;
+	}
+	can->CAN_IDR = CAN_SR_MB(mb);
+	can->CAN_MB[mb].CAN_MMR = CAN_MMR_MOT_DISABLED;
+	can->CAN_MB[mb].CAN_MMR = CAN_MMR_MOT_TX | CAN_MMR_PRIOR(priority);
+	return 1;
+}
+
+void can_disable_mailbox(can_reg_t *can, uint32_t mb) {
+	if (mb >= CAN_MAILBOXES) {
+		return;
+	}
+	can->CAN_IDR = CAN_SR_MB(mb);
+	can->CAN_ACR = CAN_SR_MB(mb);
+	can->CAN_MB[mb].CAN_MMR = CAN_MMR_MOT_DISABLED;
+}
+
+uint32_t can_tx_ready(can_reg_t *can, uint32_t mb) {
+	return (can->CAN_MB[mb].CAN_MSR & CAN_MSR_MRDY) != 0;
+}
+
+uint8_t can_write(can_reg_t *can, uint32_t mb, const can_frame_t *frame) {
+	can_mb_reg_t *box;
+	uint32_t mcr;
+
+	if (mb >= CAN_MAILBOXES || frame->dlc > 8) {
+		return 0;
+	}
+	box = &can->CAN_MB[mb];
+	if ((box->CAN_MMR & CAN_MMR_MOT_MASK) != CAN_MMR_MOT_TX ||
+		!(box->CAN_MSR & CAN_MSR_MRDY)) {
+		return 0;
+	}
+	box->CAN_MID = frame->extended ?
+			(CAN_MID_EXT(frame->id) | CAN_MID_MIDE) : CAN_MID_STD(frame->id);
+	box->CAN_MDL = frame->data[0] | ((uint32_t) frame->data[1] << 8) |
+			((uint32_t) frame->data[2] << 16) |
+			((uint32_t) frame->data[3] << 24);
+	box->CAN_MDH = frame->data[4] | ((uint32_t) frame->data[5] << 8) |
+			((uint32_t) frame->data[6] << 16) |
+			((uint32_t) frame->data[7] << 24);
+	mcr = CAN_MCR_MDLC(frame->dlc) | CAN_MCR_MTCR;
+	if (frame->rtr) {
+		mcr |= CAN_MCR_MRTR;
+	}
+	box->CAN_MCR = mcr;
+	return 1;
+}
+
+uint32_t can_read(can_reg_t *can, can_frame_t *frame) {
+	can_state_t *state = &states[can_index(can)];
+	uint32_t tail = state->tail;
+
+	if (tail == state->head) {
+		return 0;
+	}
+	*frame = state->frames[tail & (CAN_RX_BUFFER_SIZE - 1)];
+	state->tail = tail + 1;
+	return 1;
+}
+
+uint32_t can_rx_available(can_reg_t *can) {
+	can_state_t *state = &states[can_index(can)];
+
+	return state->head - state->tail;
+}
+
+uint32_t can_rx_dropped(can_reg_t *can) {
+	return states[can_index(can)].dropped;
+}
+
+uint32_t can_error_counters(can_reg_t *can) {
+	return can->CAN_ECR;
+}
+
+#if CAN_COOS
+void can_set_rx_semaphore(can_reg_t *can, uint8_t sem) {
+	states[can_index(can)].sem = sem;
+}
+#endif
+
+// The data registers hold the first byte in their low byte
+static inline void unpack(uint8_t *data, uint32_t word) {
+	data[0] = (uint8_t) word;
+	data[1] = (uint8_t) (word >> 8);
+	data[2] = (uint8_t) (word >> 16);
+	data[3] = (uint8_t) (word >> 24);
+}
+
+/*
+ * Copies the frames of the receive mailboxes into the ring buffer and
+ * allows the next reception in each of them.
+ */
+static inline void can_handler(can_reg_t *can, can_state_t *state) {
+	uint32_t status = can->CAN_SR & can->CAN_IMR;
+	uint32_t mb, head, mid, msr;
+	can_mb_reg_t *box;
+	can_frame_t *frame;
+
+	for (mb = 0; mb < CAN_MAILBOXES; mb++) {
+		if (!(status & CAN_SR_MB(mb))) {
+			continue;
+		}
+		box = &can->CAN_MB[mb];
+		head = state->head;
+		// a full buffer drops the new frame
+		if (head - state->tail < CAN_RX_BUFFER_SIZE) {
+			frame = &state->frames[head & (CAN_RX_BUFFER_SIZE - 1)];
+			mid = box->CAN_MID;
+			msr = box->CAN_MSR;
+			frame->extended = (mid & CAN_MID_MIDE) != 0;
+			frame->id = frame->extended ? CAN_MID_EXT(mid) :
+					((mid >> 18) & 0x7FFu);
+			frame->rtr = (msr & CAN_MSR_MRTR) != 0;
+			frame->dlc = (uint8_t) CAN_MSR_MDLC_OF(msr);
+			if (frame->dlc > 8) {
+				frame->dlc = 8;
+			}
+			frame->mailbox = (uint8_t) mb;
+			unpack(frame->data, box->CAN_MDL);
+			unpack(frame->data + 4, box->CAN_MDH);
+			state->head = head + 1;
+#if CAN_COOS
+			if (state->sem != CAN_NO_SEM) {
+				isr_PostSem(state->sem);
+			}
+#endif
+		} else {
+			state->dropped++;
+		}
+		box->CAN_MCR = CAN_MCR_MTCR;
+	}
+}
+
+RAMFUNC_HOT void CAN0_Handler(void) {
+	can_handler(CAN0, &states[0]);
+}
+
+RAMFUNC_HOT void CAN1_Handler(void) {
+	can_handler(CAN1, &states[1]);
+}
@@ -0,0 +1,290 @@
+/**
+ * @file can.h
+ * @brief CAN - Controller Area Network
+ * @details The SAM3X8E has two CAN controllers, CAN0 and CAN1, with 8
+ * mailboxes each. A receive mailbox only takes the frames whose identifier
+ * matches its ID in the bits set in its mask, so the filtering is done by the
+ * controller and the CPU only sees the frames it has asked for. The
+ * interrupt handler copies every received frame into a ring buffer of the
+ * controller, which is read with can_read() without a lock. A CoOS semaphore
+ * can be posted for every frame, so a task sleeps on CoPendSem() instead of
+ * polling:
+ * @code
+ *	can_init(CAN0, 500000);
+ *	can_rx_mailbox(CAN0, 0, 0x100, 0x700, 0);	// 0x100-0x1FF
+ *	can_tx_mailbox(CAN0, 7, 0);
+ *	can_set_rx_semaphore(CAN0, rx_sem);
+ *	CoPendSem(rx_sem, 0);
+ *	can_read(CAN0, &frame);
+ * @endcode
+ *
+ * A transmit mailbox has a priority, when several of them are ready the
+ * controller sends the one with the lowest priority value first (then the
+ * lowest mailbox). Urgent frames get their own mailbox with a low value, so
+ * they are not queued behind the others.
+ *
+ * @pre The pins must be given to peripheral A with the PIO: CANRX0 on PA1
+ * and CANTX0 on PA0, CANRX1 on PB15 and CANTX1 on PB14, and connected to a
+ * CAN transceiver.
+ * @pre CoOS delivery requires CFG_MAX_SERVICE_REQUEST > 0 in OsConfig.h.
+ * @date 14 October 2026
+ */
+
+#ifndef CAN_H_
+#define CAN_H_
+
+#include <inttypes.h>
+#include "periph.h"
+
+/*
+ * Size of the receive ring buffer of each controller, in frames. Must be a
+ * power of 2.
+ */
+#ifndef CAN_RX_BUFFER_SIZE
+#define CAN_RX_BUFFER_SIZE		(16)
+#endif
+
+/*
+ * Set to 0 to build without the CoOS semaphore support, e.g. when the RTOS
+ * is not linked into the application.
+ */
+#ifndef CAN_COOS
+#define CAN_COOS				(1)
+#endif
+
+/// No semaphore is posted for a received frame.
+#define CAN_NO_SEM				(0xFFu)
+
+// Base addresses to CAN registers
+#define CAN0 ((can_reg_t *) PERIPH_ADDR(0x400B4000U))
+#define CAN1 ((can_reg_t *) PERIPH_ADDR(0x400B8000U))
+
+/// Number of mailboxes of a controller
+#define CAN_MAILBOXES			(8u)
+
+/// Highest priority value of a transmit mailbox, 0 is sent first
+#define CAN_PRIORITY_MAX		(15u)
+
+///@cond
+// Mode Register
+#define CAN_MR_CANEN			(0x1u << 0)
+
+// Interrupt and Status Registers, MBx is bit x
+#define CAN_SR_MB(mb)			(0x1u << (mb))
+#define CAN_SR_ERRA				(0x1u << 16)
+#define CAN_SR_ERRP				(0x1u << 18)
+#define CAN_SR_BOFF				(0x1u << 19)
+#define CAN_SR_WAKEUP			(0x1u << 21)
+
+// Baudrate Register
+#define CAN_BR_PHASE2(x)		(((x) & 0x7u) << 0)
+#define CAN_BR_PHASE1(x)		(((x) & 0x7u) << 4)
+#define CAN_BR_PROPAG(x)		(((x) & 0x7u) << 8)
+#define CAN_BR_SJW(x)			(((x) & 0x3u) << 12)
+#define CAN_BR_BRP(x)			(((x) & 0x7Fu) << 16)
+
+// Mailbox Mode Register
+#define CAN_MMR_PRIOR(x)		(((x) & 0xFu) << 16)
+#define CAN_MMR_MOT_DISABLED	(0x0u << 24)
+#define CAN_MMR_MOT_RX			(0x1u << 24)
+#define CAN_MMR_MOT_TX			(0x3u << 24)
+#define CAN_MMR_MOT_MASK		(0x7u << 24)
+
+// Mailbox ID and Acceptance Mask Registers
+#define CAN_MID_STD(id)			(((id) & 0x7FFu) << 18)
+#define CAN_MID_EXT(id)			((id) & 0x1FFFFFFFu)
+#define CAN_MID_MIDE			(0x1u << 29)
+
+// Mailbox Status and Control Registers
+#define CAN_MSR_MDLC_OF(msr)	(((msr) >> 16) & 0xFu)
+#define CAN_MSR_MRTR			(0x1u << 20)
+#define CAN_MSR_MRDY			(0x1u << 23)
+#define CAN_MCR_MDLC(x)			(((x) & 0xFu) << 16)
+#define CAN_MCR_MRTR			(0x1u << 20)
+#define CAN_MCR_MACR			(0x1u << 22)
+#define CAN_MCR_MTCR			(0x1u << 23)
+
+/*
+ * Registers of one mailbox
+ */
+typedef struct can_mb_reg {
+	// Mailbox Mode Register, offset 0x0200 + mb * 0x20
+	uint32_t CAN_MMR;
+	// Mailbox Acceptance Mask Register, offset 0x0204 + mb * 0x20
+	uint32_t CAN_MAM;
+	// Mailbox ID Register, offset 0x0208 + mb * 0x20
+	uint32_t CAN_MID;
+	// Mailbox Family ID Register, offset 0x020C + mb * 0x20
+	uint32_t CAN_MFID;
+	// Mailbox Status Register, offset 0x0210 + mb * 0x20
+	uint32_t CAN_MSR;
+	// Mailbox Data Low Register, offset 0x0214 + mb * 0x20
+	uint32_t CAN_MDL;
+	// Mailbox Data High Register, offset 0x0218 + mb * 0x20
+	uint32_t CAN_MDH;
+	// Mailbox Control Register, offset 0x021C + mb * 0x20
+	uint32_t CAN_MCR;
+} can_mb_reg_t;
+
+/*
+ * Mapping of the CAN registers
+ * Base address: 0x400B4000 (CAN0), 0x400B8000 (CAN1)
+ */
+typedef struct can_reg {
+	// Mode Register, offset 0x0000
+	uint32_t CAN_MR;
+	// Interrupt Enable Register, offset 0x0004
+	uint32_t CAN_IER;
+	// Interrupt Disable Register, offset 0x0008
+	uint32_t CAN_IDR;
+	// Interrupt Mask Register, offset 0x000C
+	uint32_t CAN_IMR;
+	// Status Register, offset 0x0010
+	uint32_t CAN_SR;
+	// Baudrate Register, offset 0x0014
+	uint32_t CAN_BR;
+	// Timer Register, offset 0x0018
+	uint32_t CAN_TIM;
+	// Timestamp Register, offset 0x001C
+	uint32_t CAN_TIMESTP;
+	// Error Counter Register, offset 0x0020
+	uint32_t CAN_ECR;
+	// Transfer Command Register, offset 0x0024
+	uint32_t CAN_TCR;
+	// Abort Command Register, offset 0x0028
+	uint32_t CAN_ACR;
+	// reserved, offset 0x002C-0x00E0
+	uint32_t reserved1[46];
+	// Write Protect Mode Register, offset 0x00E4
+	uint32_t CAN_WPMR;
+	// Write Protect Status Register, offset 0x00E8
+	uint32_t CAN_WPSR;
+	// reserved, offset 0x00EC-0x01FC
+	uint32_t reserved2[69];
+	// Mailboxes, offset 0x0200-0x02FC
+	can_mb_reg_t CAN_MB[8];
+} can_reg_t;
+///@endcond
+
+/**
+ * A CAN frame.
+ */
+typedef struct can_frame {
+	/** Identifier, 11 bits, or 29 bits if extended */
+	uint32_t id;
+	/** 1 for an extended (29-bit) identifier */
+	uint8_t extended;
+	/** 1 for a remote frame, it has no data */
+	uint8_t rtr;
+	/** Number of data bytes (0-8) */
+	uint8_t dlc;
+	/** Mailbox the frame was received in */
+	uint8_t mailbox;
+	/** Data bytes */
+	uint8_t data[8];
+} can_frame_t;
+
+/**
+ * Initializes a controller: acquires its peripheral clock, sets the bit
+ * timing, disables all mailboxes and enables the controller. The bit is
+ * split into 8-25 time quanta with the sample point at about 80 %. The
+ * controller joins the bus after 11 recessive bits.
+ * @param can The controller, CAN0 or CAN1.
+ * @param baud The bit rate (bit/s), e.g. 125000, 250000, 500000 or 1000000.
+ * @return error (1 = SUCCESS, 0 = FAIL, the bit rate cannot be reached with
+ * the master clock)
+ */
+uint8_t can_init(can_reg_t *can, uint32_t baud);
+
+/**
+ * Disables a controller and releases its peripheral clock.
+ * @param can The controller.
+ */
+void can_deinit(can_reg_t *can);
+
+/**
+ * Sets up a receive mailbox. A frame is taken if (frame id & mask) ==
+ * (id & mask) and its format matches, mask 0 takes all frames of the format.
+ * @param can The controller.
+ * @param mb The mailbox (0-7).
+ * @param id The identifier to match.
+ * @param mask The bits of the identifier that are compared.
+ * @param extended 1 for extended (29-bit) frames, 0 for standard ones.
+ * @return error (1 = SUCCESS, 0 = FAIL, invalid mailbox)
+ */
+uint8_t can_rx_mailbox(can_reg_t *can, uint32_t mb, uint32_t id,
+		uint32_t mask, uint8_t extended);
+
+/**
+ * Sets up a transmit mailbox.
+ * @param can The controller.
+ * @param mb The mailbox (0-7).
+ * @param priority 0 (sent first) to CAN_PRIORITY_MAX.
+ * @return error (1 = SUCCESS, 0 = FAIL, invalid mailbox or priority)
+ */
+uint8_t can_tx_mailbox(can_reg_t *can, uint32_t mb, uint32_t priority);
+
+/**
+ * Disables a mailbox, a pending frame is aborted.
+ * @param can The controller.
+ * @param mb The mailbox (0-7).
+ */
+void can_disable_mailbox(can_reg_t *can, uint32_t mb);
+
+/**
+ * @param can The controller.
+ * @param mb A transmit mailbox.
+ * @return 1 if the mailbox can take a frame, 0 if it is still sending.
+ */
+uint32_t can_tx_ready(can_reg_t *can, uint32_t mb);
+
+/**
+ * Sends a frame from a transmit mailbox. The function returns when the
+ * frame is handed to the controller.
+ * @param can The controller.
+ * @param mb A transmit mailbox.
+ * @param frame The frame, its mailbox field is not used.
+ * @return error (1 = SUCCESS, 0 = FAIL, not a transmit mailbox, it is still
+ * sending or the frame is invalid)
+ */
+uint8_t can_write(can_reg_t *can, uint32_t mb, const can_frame_t *frame);
+
+/**
+ * Takes the oldest received frame from the ring buffer.
+ * @param can The controller.
+ * @param frame Where to put the frame.
+ * @return 1 if a frame was taken, 0 if there is none.
+ */
+uint32_t can_read(can_reg_t *can, can_frame_t *frame);
+
+/**
+ * @param can The controller.
+ * @return The number of frames in the ring buffer.
+ */
+uint32_t can_rx_available(can_reg_t *can);
+
+/**
+ * @param can The controller.
+ * @return The number of frames dropped because the ring buffer was full.
+ */
+uint32_t can_rx_dropped(can_reg_t *can);
+
+/**
+ * @param can The controller.
+ * @return The Error Counter Register: the receive error count in bits 0-7
+ * and the transmit error count in bits 16-23.
+ */
+uint32_t can_error_counters(can_reg_t *can);
+
+#if CAN_COOS
+/**
+ * Posts a CoOS semaphore (isr_PostSem()) for every received frame, so a
+ * reader task can sleep on CoPendSem() instead of polling.
+ * @param can The controller.
+ * @param sem The semaphore, created with CoCreateSem(). Give CAN_NO_SEM to
+ * stop posting.
+ */
+void can_set_rx_semaphore(can_reg_t *can, uint8_t sem);
+#endif
+
+#endif
@@ -0,0 +1,710 @@
+/*
+ * crc.c
+ *
+ * Date:	14 October 2026
+ */
+
+#include "crc.h"
+
+///@cond
+// Bytes taken by one step of the four tables
+#define CRC_SLICE	(4u)
+///@endcond
+
+/*
+ * The register of a reflected CRC is kept in the lowest width bits, the
+ * bytes enter at bit 0. The register of a normal CRC is kept in the highest
+ * width bits, the bytes enter at bit 31, so both shift by whole bytes and
+ * need no masking for widths below 32.
+ *
+ * Table 0 is the register after eight shifts of a byte, table k the same
+ * byte followed by k zero bytes. Generated by crc_table_init().
+ */
+static const uint32_t crc32_ieee_table[4][256] = {
+	{
+		0x00000000, 0x77073096, 0xEE0E612C, 0x990951BA, 0x076DC419, 0x706AF48F,
+		0xE963A535, 0x9E6495A3, 0x0EDB8832, 0x79DCB8A4, 0xE0D5E91E, 0x97D2D988,
+		0x09B64C2B, 0x7EB17CBD, 0xE7B82D07, 0x90BF1D91, 0x1DB71064, 0x6AB020F2,
+		0xF3B97148, 0x84BE41DE, 0x1ADAD47D, 0x6DDDE4EB, 0xF4D4B551, 0x83D385C7,
+		0x136C9856, 0x646BA8C0, 0xFD62F97A, 0x8A65C9EC, 0x14015C4F, 0x63066CD9,
+		0xFA0F3D63, 0x8D080DF5, 0x3B6E20C8, 0x4C69105E, 0xD56041E4, 0xA2677172,
+		0x3C03E4D1, 0x4B04D447, 0xD20D85FD, 0xA50AB56B, 0x35B5A8FA, 0x42B2986C,
+		0xDBBBC9D6, 0xACBCF940, 0x32D86CE3, 0x45DF5C75, 0xDCD60DCF, 0xABD13D59,
+		0x26D930AC, 0x51DE003A, 0xC8D75180, 0xBFD06116, 0x21B4F4B5, 0x56B3C423,
+		0xCFBA9599, 0xB8BDA50F, 0x2802B89E, 0x5F058808, 0xC60CD9B2, 0xB10BE924,
+		0x2F6F7C87, 0x58684C11, 0xC1611DAB, 0xB6662D3D, 0x76DC4190, 0x01DB7106,
+		0x98D220BC, 0xEFD5102A, 0x71B18589, 0x06B6B51F, 0x9FBFE4A5, 0xE8B8D433,
+		0x7807C9A2, 0x0F00F934, 0x9609A88E, 0xE10E9818, 0x7F6A0DBB, 0x086D3D2D,
+		0x91646C97, 0xE6635C01, 0x6B6B51F4, 0x1C6C6162, 0x856530D8, 0xF262004E,
+		0x6C0695ED, 0x1B01A57B, 0x8208F4C1, 0xF50FC457, 0x65B0D9C6, 0x12B7E950,
+		0x8BBEB8EA, 0xFCB9887C, 0x62DD1DDF, 0x15DA2D49, 0x8CD37CF3, 0xFBD44C65,
+		0x4DB26158, 0x3AB551CE, 0xA3BC0074, 0xD4BB30E2, 0x4ADFA541, 0x3DD895D7,
+		0xA4D1C46D, 0xD3D6F4FB, 0x4369E96A, 0x346ED9FC, 0xAD678846, 0xDA60B8D0,
+		0x44042D73, 0x33031DE5, 0xAA0A4C5F, 0xDD0D7CC9, 0x5005713C, 0x270241AA,
+		0xBE0B1010, 0xC90C2086, 0x5768B525, 0x206F85B3, 0xB966D409, 0xCE61E49F,
+		0x5EDEF90E, 0x29D9C998, 0xB0D09822, 0xC7D7A8B4, 0x59B33D17, 0x2EB40D81,
+		0xB7BD5C3B, 0xC0BA6CAD, 0xEDB88320, 0x9ABFB3B6, 0x03B6E20C, 0x74B1D29A,
+		0xEAD54739, 0x9DD277AF, 0x04DB2615, 0x73DC1683, 0xE3630B12, 0x94643B84,
+		0x0D6D6A3E, 0x7A6A5AA8, 0xE40ECF0B, 0x9309FF9D, 0x0A00AE27, 0x7D079EB1,
+		0xF00F9344, 0x8708A3D2, 0x1E01F268, 0x6906C2FE, 0xF762575D, 0x806567CB,
+		0x196C3671, 0x6E6B06E7, 0xFED41B76, 0x89D32BE0, 0x10DA7A5A, 0x67DD4ACC,
+		0xF9B9DF6F, 0x8EBEEFF9, 0x17B7BE43, 0x60B08ED5, 0xD6D6A3E8, 0xA1D1937E,
+		0x38D8C2C4, 0x4FDFF252, 0xD1BB67F1, 0xA6BC5767, 0x3FB506DD, 0x48B2364B,
+		0xD80D2BDA, 0xAF0A1B4C, 0x36034AF6, 0x41047A60, 0xDF60EFC3, 0xA867DF55,
+		0x316E8EEF, 0x4669BE79, 0xCB61B38C, 0xBC66831A, 0x256FD2A0, 0x5268E236,
+		0xCC0C7795, 0xBB0B4703, 0x220216B9, 0x5505262F, 0xC5BA3BBE, 0xB2BD0B28,
+		0x2BB45A92, 0x5CB36A04, 0xC2D7FFA7, 0xB5D0CF31, 0x2CD99E8B, 0x5BDEAE1D,
+		0x9B64C2B0, 0xEC63F226, 0x756AA39C, 0x026D930A, 0x9C0906A9, 0xEB0E363F,
+		0x72076785, 0x05005713, 0x95BF4A82, 0xE2B87A14, 0x7BB12BAE, 0x0CB61B38,
+		0x92D28E9B, 0xE5D5BE0D, 0x7CDCEFB7, 0x0BDBDF21, 0x86D3D2D4, 0xF1D4E242,
+		0x68DDB3F8, 0x1FDA836E, 0x81BE16CD, 0xF6B9265B, 0x6FB077E1, 0x18B74777,
+		0x88085AE6, 0xFF0F6A70, 0x66063BCA, 0x11010B5C, 0x8F659EFF, 0xF862AE69,
+		0x616BFFD3, 0x166CCF45, 0xA00AE278, 0xD70DD2EE, 0x4E048354, 0x3903B3C2,
+		0xA7672661, 0xD06016F7, 0x4969474D, 0x3E6E77DB, 0xAED16A4A, 0xD9D65ADC,
+		0x40DF0B66, 0x37D83BF0, 0xA9BCAE53, 0xDEBB9EC5, 0x47B2CF7F, 0x30B5FFE9,
+		0xBDBDF21C, 0xCABAC28A, 0x53B39330, 0x24B4A3A6, 0xBAD03605, 0xCDD70693,
+		0x54DE5729, 0x23D967BF, 0xB3667A2E, 0xC4614AB8, 0x5D681B02, 0x2A6F2B94,
+		0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D
+	},
+	{
+		0x00000000, 0x191B3141, 0x32366282, 0x2B2D53C3, 0x646CC504, 0x7D77F445,
+		0x565AA786, 0x4F4196C7, 0xC8D98A08, 0xD1C2BB49, 0xFAEFE88A, 0xE3F4D9CB,
+		0xACB54F0C, 0xB5AE7E4D, 0x9E832D8E, 0x87981CCF, 0x4AC21251, 0x53D92310,
+		0x78F470D3, 0x61EF4192, 0x2EAED755, 0x37B5E614, 0x1C98B5D7, 0x05838496,
+		0x821B9859, 0x9B00A918, 0xB02DFADB, 0xA936CB9A, 0xE6775D5D, 0xFF6C6C1C,
+		0xD4413FDF, 0xCD5A0E9E, 0x958424A2, 0x8C9F15E3, 0xA7B24620, 0xBEA97761,
+		0xF1E8E1A6, 0xE8F3D0E7, 0xC3DE8324, 0xDAC5B265, 0x5D5DAEAA, 0x44469FEB,
+		0x6F6BCC28, 0x7670FD69, 0x39316BAE, 0x202A5AEF, 0x0B07092C, 0x121C386D,
+		0xDF4636F3, 0xC65D07B2, 0xED705471, 0xF46B6530, 0xBB2AF3F7, 0xA231C2B6,
+		0x891C9175, 0x9007A034, 0x179FBCFB, 0x0E848DBA, 0x25A9DE79, 0x3CB2EF38,
+		0x73F379FF, 0x6AE848BE, 0x41C51B7D, 0x58DE2A3C, 0xF0794F05, 0xE9627E44,
+		0xC24F2D87, 0xDB541CC6, 0x94158A01, 0x8D0EBB40, 0xA623E883, 0xBF38D9C2,
+		0x38A0C50D, 0x21BBF44C, 0x0A96A78F, 0x138D96CE, 0x5CCC0009, 0x45D73148,
+		0x6EFA628B, 0x77E153CA, 0xBABB5D54, 0xA3A06C15, 0x888D3FD6, 0x91960E97,
+		0xDED79850, 0xC7CCA911, 0xECE1FAD2, 0xF5FACB93, 0x7262D75C, 0x6B79E61D,
+		0x4054B5DE, 0x594F849F, 0x160E1258, 0x0F152319, 0x243870DA, 0x3D23419B,
+		0x65FD6BA7, 0x7CE65AE6, 0x57CB0925, 0x4ED03864, 0x0191AEA3, 0x188A9FE2,
+		0x33A7CC21, 0x2ABCFD60, 0xAD24E1AF, 0xB43FD0EE, 0x9F12832D, 0x8609B26C,
+		0xC94824AB, 0xD05315EA, 0xFB7E4629, 0xE2657768, 0x2F3F79F6, 0x362448B7,
+		0x1D091B74, 0x04122A35, 0x4B53BCF2, 0x52488DB3, 0x7965DE70, 0x607EEF31,
+		0xE7E6F3FE, 0xFEFDC2BF, 0xD5D0917C, 0xCCCBA03D, 0x838A36FA, 0x9A9107BB,
+		0xB1BC5478, 0xA8A76539, 0x3B83984B, 0x2298A90A, 0x09B5FAC9, 0x10AECB88,
+		0x5FEF5D4F, 0x46F46C0E, 0x6DD93FCD, 0x74C20E8C, 0xF35A1243, 0xEA412302,
+		0xC16C70C1, 0xD8774180, 0x9736D747, 0x8E2DE606, 0xA500B5C5, 0xBC1B8484,
+		0x71418A1A, 0x685ABB5B, 0x4377E898, 0x5A6CD9D9, 0x152D4F1E, 0x0C367E5F,
+		0x271B2D9C, 0x3E001CDD, 0xB9980012, 0xA0833153, 0x8BAE6290, 0x92B553D1,
+		0xDDF4C516, 0xC4EFF457, 0xEFC2A794, 0xF6D996D5, 0xAE07BCE9, 0xB71C8DA8,
+		0x9C31DE6B, 0x852AEF2A, 0xCA6B79ED, 0xD37048AC, 0xF85D1B6F, 0xE1462A2E,
+		0x66DE36E1, 0x7FC507A0, 0x54E85463, 0x4DF36522, 0x02B2F3E5, 0x1BA9C2A4,
+		0x30849167, 0x299FA026, 0xE4C5AEB8, 0xFDDE9FF9, 0xD6F3CC3A, 0xCFE8FD7B,
+		0x80A96BBC, 0x99B25AFD, 0xB29F093E, 0xAB84387F, 0x2C1C24B0, 0x350715F1,
+		0x1E2A4632, 0x07317773, 0x4870E1B4, 0x516BD0F5, 0x7A468336, 0x635DB277,
+		0xCBFAD74E, 0xD2E1E60F, 0xF9CCB5CC, 0xE0D7848D, 0xAF96124A, 0xB68D230B,
+		0x9DA070C8, 0x84BB4189, 0x03235D46, 0x1A386C07, 0x31153FC4, 0x280E0E85,
+		0x674F9842, 0x7E54A903, 0x5579FAC0, 0x4C62CB81, 0x8138C51F, 0x9823F45E,
+		0xB30EA79D, 0xAA1596DC, 0xE554001B, 0xFC4F315A, 0xD7626299, 0xCE7953D8,
+		0x49E14F17, 0x50FA7E56, 0x7BD72D95, 0x62CC1CD4, 0x2D8D8A13, 0x3496BB52,
+		0x1FBBE891, 0x06A0D9D0, 0x5E7EF3EC, 0x4765C2AD, 0x6C48916E, 0x7553A02F,
+		0x3A1236E8, 0x230907A9, 0x0824546A, 0x113F652B, 0x96A779E4, 0x8FBC48A5,
+		0xA4911B66, 0xBD8A2A27, 0xF2CBBCE0, 0xEBD08DA1, 0xC0FDDE62, 0xD9E6EF23,
+		0x14BCE1BD, 0x0DA7D0FC, 0x268A833F, 0x3F91B27E, 0x70D024B9, 0x69CB15F8,
+		0x42E6463B, 0x5BFD777A, 0xDC656BB5, 0xC57E5AF4, 0xEE530937, 0xF7483876,
+		0xB809AEB1, 0xA1129FF0, 0x8A3FCC33, 0x9324FD72
+	},
+	{
+		0x00000000, 0x01C26A37, 0x0384D46E, 0x0246BE59, 0x0709A8DC, 0x06CBC2EB,
+		0x048D7CB2, 0x054F1685, 0x0E1351B8, 0x0FD13B8F, 0x0D9785D6, 0x0C55EFE1,
+		0x091AF964, 0x08D89353, 0x0A9E2D0A, 0x0B5C473D, 0x1C26A370, 0x1DE4C947,
+		0x1FA2771E, 0x1E601D29, 0x1B2F0BAC, 0x1AED619B, 0x18ABDFC2, 0x1969B5F5,
+		0x1235F2C8, 0x13F798FF, 0x11B126A6, 0x10734C91, 0x153C5A14, 0x14FE3023,
+		0x16B88E7A, 0x177AE44D, 0x384D46E0, 0x398F2CD7, 0x3BC9928E, 0x3A0BF8B9,
+		0x3F44EE3C, 0x3E86840B, 0x3CC03A52, 0x3D025065, 0x365E1758, 0x379C7D6F,
+		0x35DAC336, 0x3418A901, 0x3157BF84, 0x3095D5B3, 0x32D36BEA, 0x331101DD,
+		0x246BE590, 0x25A98FA7, 0x27EF31FE, 0x262D5BC9, 0x23624D4C, 0x22A0277B,
+		0x20E69922, 0x2124F315, 0x2A78B428, 0x2BBADE1F, 0x29FC6046, 0x283E0A71,
+		0x2D711CF4, 0x2CB376C3, 0x2EF5C89A, 0x2F37A2AD, 0x709A8DC0, 0x7158E7F7,
+		0x731E59AE, 0x72DC3399, 0x7793251C, 0x76514F2B, 0x7417F172, 0x75D59B45,
+		0x7E89DC78, 0x7F4BB64F, 0x7D0D0816, 0x7CCF6221, 0x798074A4, 0x78421E93,
+		0x7A04A0CA, 0x7BC6CAFD, 0x6CBC2EB0, 0x6D7E4487, 0x6F38FADE, 0x6EFA90E9,
+		0x6BB5866C, 0x6A77EC5B, 0x68315202, 0x69F33835, 0x62AF7F08, 0x636D153F,
+		0x612BAB66, 0x60E9C151, 0x65A6D7D4, 0x6464BDE3, 0x662203BA, 0x67E0698D,
+		0x48D7CB20, 0x4915A117, 0x4B531F4E, 0x4A917579, 0x4FDE63FC, 0x4E1C09CB,
+		0x4C5AB792, 0x4D98DDA5, 0x46C49A98, 0x4706F0AF, 0x45404EF6, 0x448224C1,
+		0x41CD3244, 0x400F5873, 0x4249E62A, 0x438B8C1D, 0x54F16850, 0x55330267,
+		0x5775BC3E, 0x56B7D609, 0x53F8C08C, 0x523AAABB, 0x507C14E2, 0x51BE7ED5,
+		0x5AE239E8, 0x5B2053DF, 0x5966ED86, 0x58A487B1, 0x5DEB9134, 0x5C29FB03,
+		0x5E6F455A, 0x5FAD2F6D, 0xE1351B80, 0xE0F771B7, 0xE2B1CFEE, 0xE373A5D9,
+		0xE63CB35C, 0xE7FED96B, 0xE5B86732, 0xE47A0D05, 0xEF264A38, 0xEEE4200F,
+		0xECA29E56, 0xED60F461, 0xE82FE2E4, 0xE9ED88D3, 0xEBAB368A, 0xEA695CBD,
+		0xFD13B8F0, 0xFCD1D2C7, 0xFE976C9E, 0xFF5506A9, 0xFA1A102C, 0xFBD87A1B,
+		0xF99EC442, 0xF85CAE75, 0xF300E948, 0xF2C2837F, 0xF0843D26, 0xF1465711,
+		0xF4094194, 0xF5CB2BA3, 0xF78D95FA, 0xF64FFFCD, 0xD9785D60, 0xD8BA3757,
+		0xDAFC890E, 0xDB3EE339, 0xDE71F5BC, 0xDFB39F8B, 0xDDF521D2, 0xDC374BE5,
+		0xD76B0CD8, 0xD6A966EF, 0xD4EFD8B6, 0xD52DB281, 0xD062A404, 0xD1A0CE33,
+		0xD3E6706A, 0xD2241A5D, 0xC55EFE10, 0xC49C9427, 0xC6DA2A7E, 0xC7184049,
+		0xC25756CC, 0xC3953CFB, 0xC1D382A2, 0xC011E895, 0xCB4DAFA8, 0xCA8FC59F,
+		0xC8C97BC6, 0xC90B11F1, 0xCC440774, 0xCD866D43, 0xCFC0D31A, 0xCE02B92D,
+		0x91AF9640, 0x906DFC77, 0x922B422E, 0x93E92819, 0x96A63E9C, 0x976454AB,
+		0x9522EAF2, 0x94E080C5, 0x9FBCC7F8, 0x9E7EADCF, 0x9C381396, 0x9DFA79A1,
+		0x98B56F24, 0x99770513, 0x9B31BB4A, 0x9AF3D17D, 0x8D893530, 0x8C4B5F07,
+		0x8E0DE15E, 0x8FCF8B69, 0x8A809DEC, 0x8B42F7DB, 0x89044982, 0x88C623B5,
+		0x839A6488, 0x82580EBF, 0x801EB0E6, 0x81DCDAD1, 0x8493CC54, 0x8551A663,
+		0x8717183A, 0x86D5720D, 0xA9E2D0A0, 0xA820BA97, 0xAA6604CE, 0xABA46EF9,
+		0xAEEB787C, 0xAF29124B, 0xAD6FAC12, 0xACADC625, 0xA7F18118, 0xA633EB2F,
+		0xA4755576, 0xA5B73F41, 0xA0F829C4, 0xA13A43F3, 0xA37CFDAA, 0xA2BE979D,
+		0xB5C473D0, 0xB40619E7, 0xB640A7BE, 0xB782CD89, 0xB2CDDB0C, 0xB30FB13B,
+		0xB1490F62, 0xB08B6555, 0xBBD72268, 0xBA15485F, 0xB853F606, 0xB9919C31,
+		0xBCDE8AB4, 0xBD1CE083, 0xBF5A5EDA, 0xBE9834ED
+	},
+	{
+		0x00000000, 0xB8BC6765, 0xAA09C88B, 0x12B5AFEE, 0x8F629757, 0x37DEF032,
+		0x256B5FDC, 0x9DD738B9, 0xC5B428EF, 0x7D084F8A, 0x6FBDE064, 0xD7018701,
+		0x4AD6BFB8, 0xF26AD8DD, 0xE0DF7733, 0x58631056, 0x5019579F, 0xE8A530FA,
+		0xFA109F14, 0x42ACF871, 0xDF7BC0C8, 0x67C7A7AD, 0x75720843, 0xCDCE6F26,
+		0x95AD7F70, 0x2D111815, 0x3FA4B7FB, 0x8718D09E, 0x1ACFE827, 0xA2738F42,
+		0xB0C620AC, 0x087A47C9, 0xA032AF3E, 0x188EC85B, 0x0A3B67B5, 0xB28700D0,
+		0x2F503869, 0x97EC5F0C, 0x8559F0E2, 0x3DE59787, 0x658687D1, 0xDD3AE0B4,
+		0xCF8F4F5A, 0x7733283F, 0xEAE41086, 0x525877E3, 0x40EDD80D, 0xF851BF68,
+		0xF02BF8A1, 0x48979FC4, 0x5A22302A, 0xE29E574F, 0x7F496FF6, 0xC7F50893,
+		0xD540A77D, 0x6DFCC018, 0x359FD04E, 0x8D23B72B, 0x9F9618C5, 0x272A7FA0,
+		0xBAFD4719, 0x0241207C, 0x10F48F92, 0xA848E8F7, 0x9B14583D, 0x23A83F58,
+		0x311D90B6, 0x89A1F7D3, 0x1476CF6A, 0xACCAA80F, 0xBE7F07E1, 0x06C36084,
+		0x5EA070D2, 0xE61C17B7, 0xF4A9B859, 0x4C15DF3C, 0xD1C2E785, 0x697E80E0,
+		0x7BCB2F0E, 0xC377486B, 0xCB0D0FA2, 0x73B168C7, 0x6104C729, 0xD9B8A04C,
+		0x446F98F5, 0xFCD3FF90, 0xEE66507E, 0x56DA371B, 0x0EB9274D, 0xB6054028,
+		0xA4B0EFC6, 0x1C0C88A3, 0x81DBB01A, 0x3967D77F, 0x2BD27891, 0x936E1FF4,
+		0x3B26F703, 0x839A9066, 0x912F3F88, 0x299358ED, 0xB4446054, 0x0CF80731,
+		0x1E4DA8DF, 0xA6F1CFBA, 0xFE92DFEC, 0x462EB889, 0x549B1767, 0xEC277002,
+		0x71F048BB, 0xC94C2FDE, 0xDBF98030, 0x6345E755, 0x6B3FA09C, 0xD383C7F9,
+		0xC1366817, 0x798A0F72, 0xE45D37CB, 0x5CE150AE, 0x4E54FF40, 0xF6E89825,
+		0xAE8B8873, 0x1637EF16, 0x048240F8, 0xBC3E279D, 0x21E91F24, 0x99557841,
+		0x8BE0D7AF, 0x335CB0CA, 0xED59B63B, 0x55E5D15E, 0x47507EB0, 0xFFEC19D5,
+		0x623B216C, 0xDA874609, 0xC832E9E7, 0x708E8E82, 0x28ED9ED4, 0x9051F9B1,
+		0x82E4565F, 0x3A58313A, 0xA78F0983, 0x1F336EE6, 0x0D86C108, 0xB53AA66D,
+		0xBD40E1A4, 0x05FC86C1, 0x1749292F, 0xAFF54E4A, 0x322276F3, 0x8A9E1196,
+		0x982BBE78, 0x2097D91D, 0x78F4C94B, 0xC048AE2E, 0xD2FD01C0, 0x6A4166A5,
+		0xF7965E1C, 0x4F2A3979, 0x5D9F9697, 0xE523F1F2, 0x4D6B1905, 0xF5D77E60,
+		0xE762D18E, 0x5FDEB6EB, 0xC2098E52, 0x7AB5E937, 0x680046D9, 0xD0BC21BC,
+		0x88DF31EA, 0x3063568F, 0x22D6F961, 0x9A6A9E04, 0x07BDA6BD, 0xBF01C1D8,
+		0xADB46E36, 0x15080953, 0x1D724E9A, 0xA5CE29FF, 0xB77B8611, 0x0FC7E174,
+		0x9210D9CD, 0x2AACBEA8, 0x38191146, 0x80A57623, 0xD8C66675, 0x607A0110,
+		0x72CFAEFE, 0xCA73C99B, 0x57A4F122, 0xEF189647, 0xFDAD39A9, 0x45115ECC,
+		0x764DEE06, 0xCEF18963, 0xDC44268D, 0x64F841E8, 0xF92F7951, 0x41931E34,
+		0x5326B1DA, 0xEB9AD6BF, 0xB3F9C6E9, 0x0B45A18C, 0x19F00E62, 0xA14C6907,
+		0x3C9B51BE, 0x842736DB, 0x96929935, 0x2E2EFE50, 0x2654B999, 0x9EE8DEFC,
+		0x8C5D7112, 0x34E11677, 0xA9362ECE, 0x118A49AB, 0x033FE645, 0xBB838120,
+		0xE3E09176, 0x5B5CF613, 0x49E959FD, 0xF1553E98, 0x6C820621, 0xD43E6144,
+		0xC68BCEAA, 0x7E37A9CF, 0xD67F4138, 0x6EC3265D, 0x7C7689B3, 0xC4CAEED6,
+		0x591DD66F, 0xE1A1B10A, 0xF3141EE4, 0x4BA87981, 0x13CB69D7, 0xAB770EB2,
+		0xB9C2A15C, 0x017EC639, 0x9CA9FE80, 0x241599E5, 0x36A0360B, 0x8E1C516E,
+		0x866616A7, 0x3EDA71C2, 0x2C6FDE2C, 0x94D3B949, 0x090481F0, 0xB1B8E695,
+		0xA30D497B, 0x1BB12E1E, 0x43D23E48, 0xFB6E592D, 0xE9DBF6C3, 0x516791A6,
+		0xCCB0A91F, 0x740CCE7A, 0x66B96194, 0xDE0506F1
+	}
+};
+
+static const uint32_t crc16_ccitt_table[4][256] = {
+	{
+		0x00000000, 0x10210000, 0x20420000, 0x30630000, 0x40840000, 0x50A50000,
+		0x60C60000, 0x70E70000, 0x81080000, 0x91290000, 0xA14A0000, 0xB16B0000,
+		0xC18C0000, 0xD1AD0000, 0xE1CE0000, 0xF1EF0000, 0x12310000, 0x02100000,
+		0x32730000, 0x22520000, 0x52B50000, 0x42940000, 0x72F70000, 0x62D60000,
+		0x93390000, 0x83180000, 0xB37B0000, 0xA35A0000, 0xD3BD0000, 0xC39C0000,
+		0xF3FF0000, 0xE3DE0000, 0x24620000, 0x34430000, 0x04200000, 0x14010000,
+		0x64E60000, 0x74C70000, 0x44A40000, 0x54850000, 0xA56A0000, 0xB54B0000,
+		0x85280000, 0x95090000, 0xE5EE0000, 0xF5CF0000, 0xC5AC0000, 0xD58D0000,
+		0x36530000, 0x26720000, 0x16110000, 0x06300000, 0x76D70000, 0x66F60000,
+		0x56950000, 0x46B40000, 0xB75B0000, 0xA77A0000, 0x97190000, 0x87380000,
+		0xF7DF0000, 0xE7FE0000, 0xD79D0000, 0xC7BC0000, 0x48C40000, 0x58E50000,
+		0x68860000, 0x78A70000, 0x08400000, 0x18610000, 0x28020000, 0x38230000,
+		0xC9CC0000, 0xD9ED0000, 0xE98E0000, 0xF9AF0000, 0x89480000, 0x99690000,
+		0xA90A0000, 0xB92B0000, 0x5AF50000, 0x4AD40000, 0x7AB70000, 0x6A960000,
+		0x1A710000, 0x0A500000, 0x3A330000, 0x2A120000, 0xDBFD0000, 0xCBDC0000,
+		0xFBBF0000, 0xEB9E0000, 0x9B790000, 0x8B580000, 0xBB3B0000, 0xAB1A0000,
+		0x6CA60000, 0x7C870000, 0x4CE40000, 0x5CC50000, 0x2C220000, 0x3C030000,
+		0x0C600000, 0x1C410000, 0xEDAE0000, 0xFD8F0000, 0xCDEC0000, 0xDDCD0000,
+		0xAD2A0000, 0xBD0B0000, 0x8D680000, 0x9D490000, 0x7E970000, 0x6EB60000,
+		0x5ED50000, 0x4EF40000, 0x3E130000, 0x2E320000, 0x1E510000, 0x0E700000,
+		0xFF9F0000, 0xEFBE0000, 0xDFDD0000, 0xCFFC0000, 0xBF1B0000, 0xAF3A0000,
+		0x9F590000, 0x8F780000, 0x91880000, 0x81A90000, 0xB1CA0000, 0xA1EB0000,
+		0xD10C0000, 0xC12D0000, 0xF14E0000, 0xE16F0000, 0x10800000, 0x00A10000,
+		0x30C20000, 0x20E30000, 0x50040000, 0x40250000, 0x70460000, 0x60670000,
+		0x83B90000, 0x93980000, 0xA3FB0000, 0xB3DA0000, 0xC33D0000, 0xD31C0000,
+		0xE37F0000, 0xF35E0000, 0x02B10000, 0x12900000, 0x22F30000, 0x32D20000,
+		0x42350000, 0x52140000, 0x62770000, 0x72560000, 0xB5EA0000, 0xA5CB0000,
+		0x95A80000, 0x85890000, 0xF56E0000, 0xE54F0000, 0xD52C0000, 0xC50D0000,
+		0x34E20000, 0x24C30000, 0x14A00000, 0x04810000, 0x74660000, 0x64470000,
+		0x54240000, 0x44050000, 0xA7DB0000, 0xB7FA0000, 0x87990000, 0x97B80000,
+		0xE75F0000, 0xF77E0000, 0xC71D0000, 0xD73C0000, 0x26D30000, 0x36F20000,
+		0x06910000, 0x16B00000, 0x66570000, 0x76760000, 0x46150000, 0x56340000,
+		0xD94C0000, 0xC96D0000, 0xF90E0000, 0xE92F0000, 0x99C80000, 0x89E90000,
+		0xB98A0000, 0xA9AB0000, 0x58440000, 0x48650000, 0x78060000, 0x68270000,
+		0x18C00000, 0x08E10000, 0x38820000, 0x28A30000, 0xCB7D0000, 0xDB5C0000,
+		0xEB3F0000, 0xFB1E0000, 0x8BF90000, 0x9BD80000, 0xABBB0000, 0xBB9A0000,
+		0x4A750000, 0x5A540000, 0x6A370000, 0x7A160000, 0x0AF10000, 0x1AD00000,
+		0x2AB30000, 0x3A920000, 0xFD2E0000, 0xED0F0000, 0xDD6C0000, 0xCD4D0000,
+		0xBDAA0000, 0xAD8B0000, 0x9DE80000, 0x8DC90000, 0x7C260000, 0x6C070000,
+		0x5C640000, 0x4C450000, 0x3CA20000, 0x2C830000, 0x1CE00000, 0x0CC10000,
+		0xEF1F0000, 0xFF3E0000, 0xCF5D0000, 0xDF7C0000, 0xAF9B0000, 0xBFBA0000,
+		0x8FD90000, 0x9FF80000, 0x6E170000, 0x7E360000, 0x4E550000, 0x5E740000,
+		0x2E930000, 0x3EB20000, 0x0ED10000, 0x1EF00000
+	},
+	{
+		0x00000000, 0x33310000, 0x66620000, 0x55530000, 0xCCC40000, 0xFFF50000,
+		0xAAA60000, 0x99970000, 0x89A90000, 0xBA980000, 0xEFCB0000, 0xDCFA0000,
+		0x456D0000, 0x765C0000, 0x230F0000, 0x103E0000, 0x03730000, 0x30420000,
+		0x65110000, 0x56200000, 0xCFB70000, 0xFC860000, 0xA9D50000, 0x9AE40000,
+		0x8ADA0000, 0xB9EB0000, 0xECB80000, 0xDF890000, 0x461E0000, 0x752F0000,
+		0x207C0000, 0x134D0000, 0x06E60000, 0x35D70000, 0x60840000, 0x53B50000,
+		0xCA220000, 0xF9130000, 0xAC400000, 0x9F710000, 0x8F4F0000, 0xBC7E0000,
+		0xE92D0000, 0xDA1C0000, 0x438B0000, 0x70BA0000, 0x25E90000, 0x16D80000,
+		0x05950000, 0x36A40000, 0x63F70000, 0x50C60000, 0xC9510000, 0xFA600000,
+		0xAF330000, 0x9C020000, 0x8C3C0000, 0xBF0D0000, 0xEA5E0000, 0xD96F0000,
+		0x40F80000, 0x73C90000, 0x269A0000, 0x15AB0000, 0x0DCC0000, 0x3EFD0000,
+		0x6BAE0000, 0x589F0000, 0xC1080000, 0xF2390000, 0xA76A0000, 0x945B0000,
+		0x84650000, 0xB7540000, 0xE2070000, 0xD1360000, 0x48A10000, 0x7B900000,
+		0x2EC30000, 0x1DF20000, 0x0EBF0000, 0x3D8E0000, 0x68DD0000, 0x5BEC0000,
+		0xC27B0000, 0xF14A0000, 0xA4190000, 0x97280000, 0x87160000, 0xB4270000,
+		0xE1740000, 0xD2450000, 0x4BD20000, 0x78E30000, 0x2DB00000, 0x1E810000,
+		0x0B2A0000, 0x381B0000, 0x6D480000, 0x5E790000, 0xC7EE0000, 0xF4DF0000,
+		0xA18C0000, 0x92BD0000, 0x82830000, 0xB1B20000, 0xE4E10000, 0xD7D00000,
+		0x4E470000, 0x7D760000, 0x28250000, 0x1B140000, 0x08590000, 0x3B680000,
+		0x6E3B0000, 0x5D0A0000, 0xC49D0000, 0xF7AC0000, 0xA2FF0000, 0x91CE0000,
+		0x81F00000, 0xB2C10000, 0xE7920000, 0xD4A30000, 0x4D340000, 0x7E050000,
+		0x2B560000, 0x18670000, 0x1B980000, 0x28A90000, 0x7DFA0000, 0x4ECB0000,
+		0xD75C0000, 0xE46D0000, 0xB13E0000, 0x820F0000, 0x92310000, 0xA1000000,
+		0xF4530000, 0xC7620000, 0x5EF50000, 0x6DC40000, 0x38970000, 0x0BA60000,
+		0x18EB0000, 0x2BDA0000, 0x7E890000, 0x4DB80000, 0xD42F0000, 0xE71E0000,
+		0xB24D0000, 0x817C0000, 0x91420000, 0xA2730000, 0xF7200000, 0xC4110000,
+		0x5D860000, 0x6EB70000, 0x3BE40000, 0x08D50000, 0x1D7E0000, 0x2E4F0000,
+		0x7B1C0000, 0x482D0000, 0xD1BA0000, 0xE28B0000, 0xB7D80000, 0x84E90000,
+		0x94D70000, 0xA7E60000, 0xF2B50000, 0xC1840000, 0x58130000, 0x6B220000,
+		0x3E710000, 0x0D400000, 0x1E0D0000, 0x2D3C0000, 0x786F0000, 0x4B5E0000,
+		0xD2C90000, 0xE1F80000, 0xB4AB0000, 0x879A0000, 0x97A40000, 0xA4950000,
+		0xF1C60000, 0xC2F70000, 0x5B600000, 0x68510000, 0x3D020000, 0x0E330000,
+		0x16540000, 0x25650000, 0x70360000, 0x43070000, 0xDA900000, 0xE9A10000,
+		0xBCF20000, 0x8FC30000, 0x9FFD0000, 0xACCC0000, 0xF99F0000, 0xCAAE0000,
+		0x53390000, 0x60080000, 0x355B0000, 0x066A0000, 0x15270000, 0x26160000,
+		0x73450000, 0x40740000, 0xD9E30000, 0xEAD20000, 0xBF810000, 0x8CB00000,
+		0x9C8E0000, 0xAFBF0000, 0xFAEC0000, 0xC9DD0000, 0x504A0000, 0x637B0000,
+		0x36280000, 0x05190000, 0x10B20000, 0x23830000, 0x76D00000, 0x45E10000,
+		0xDC760000, 0xEF470000, 0xBA140000, 0x89250000, 0x991B0000, 0xAA2A0000,
+		0xFF790000, 0xCC480000, 0x55DF0000, 0x66EE0000, 0x33BD0000, 0x008C0000,
+		0x13C10000, 0x20F00000, 0x75A30000, 0x46920000, 0xDF050000, 0xEC340000,
+		0xB9670000, 0x8A560000, 0x9A680000, 0xA9590000, 0xFC0A0000, 0xCF3B0000,
+		0x56AC0000, 0x659D0000, 0x30CE0000, 0x03FF0000
+	},
+	{
+		0x00000000, 0x37300000, 0x6E600000, 0x59500000, 0xDCC00000, 0xEBF00000,
+		0xB2A00000, 0x85900000, 0xA9A10000, 0x9E910000, 0xC7C10000, 0xF0F10000,
+		0x75610000, 0x42510000, 0x1B010000, 0x2C310000, 0x43630000, 0x74530000,
+		0x2D030000, 0x1A330000, 0x9FA30000, 0xA8930000, 0xF1C30000, 0xC6F30000,
+		0xEAC20000, 0xDDF20000, 0x84A20000, 0xB3920000, 0x36020000, 0x01320000,
+		0x58620000, 0x6F520000, 0x86C60000, 0xB1F60000, 0xE8A60000, 0xDF960000,
+		0x5A060000, 0x6D360000, 0x34660000, 0x03560000, 0x2F670000, 0x18570000,
+		0x41070000, 0x76370000, 0xF3A70000, 0xC4970000, 0x9DC70000, 0xAAF70000,
+		0xC5A50000, 0xF2950000, 0xABC50000, 0x9CF50000, 0x19650000, 0x2E550000,
+		0x77050000, 0x40350000, 0x6C040000, 0x5B340000, 0x02640000, 0x35540000,
+		0xB0C40000, 0x87F40000, 0xDEA40000, 0xE9940000, 0x1DAD0000, 0x2A9D0000,
+		0x73CD0000, 0x44FD0000, 0xC16D0000, 0xF65D0000, 0xAF0D0000, 0x983D0000,
+		0xB40C0000, 0x833C0000, 0xDA6C0000, 0xED5C0000, 0x68CC0000, 0x5FFC0000,
+		0x06AC0000, 0x319C0000, 0x5ECE0000, 0x69FE0000, 0x30AE0000, 0x079E0000,
+		0x820E0000, 0xB53E0000, 0xEC6E0000, 0xDB5E0000, 0xF76F0000, 0xC05F0000,
+		0x990F0000, 0xAE3F0000, 0x2BAF0000, 0x1C9F0000, 0x45CF0000, 0x72FF0000,
+		0x9B6B0000, 0xAC5B0000, 0xF50B0000, 0xC23B0000, 0x47AB0000, 0x709B0000,
+		0x29CB0000, 0x1EFB0000, 0x32CA0000, 0x05FA0000, 0x5CAA0000, 0x6B9A0000,
+		0xEE0A0000, 0xD93A0000, 0x806A0000, 0xB75A0000, 0xD8080000, 0xEF380000,
+		0xB6680000, 0x81580000, 0x04C80000, 0x33F80000, 0x6AA80000, 0x5D980000,
+		0x71A90000, 0x46990000, 0x1FC90000, 0x28F90000, 0xAD690000, 0x9A590000,
+		0xC3090000, 0xF4390000, 0x3B5A0000, 0x0C6A0000, 0x553A0000, 0x620A0000,
+		0xE79A0000, 0xD0AA0000, 0x89FA0000, 0xBECA0000, 0x92FB0000, 0xA5CB0000,
+		0xFC9B0000, 0xCBAB0000, 0x4E3B0000, 0x790B0000, 0x205B0000, 0x176B0000,
+		0x78390000, 0x4F090000, 0x16590000, 0x21690000, 0xA4F90000, 0x93C90000,
+		0xCA990000, 0xFDA90000, 0xD1980000, 0xE6A80000, 0xBFF80000, 0x88C80000,
+		0x0D580000, 0x3A680000, 0x63380000, 0x54080000, 0xBD9C0000, 0x8AAC0000,
+		0xD3FC0000, 0xE4CC0000, 0x615C0000, 0x566C0000, 0x0F3C0000, 0x380C0000,
+		0x143D0000, 0x230D0000, 0x7A5D0000, 0x4D6D0000, 0xC8FD0000, 0xFFCD0000,
+		0xA69D0000, 0x91AD0000, 0xFEFF0000, 0xC9CF0000, 0x909F0000, 0xA7AF0000,
+		0x223F0000, 0x150F0000, 0x4C5F0000, 0x7B6F0000, 0x575E0000, 0x606E0000,
+		0x393E0000, 0x0E0E0000, 0x8B9E0000, 0xBCAE0000, 0xE5FE0000, 0xD2CE0000,
+		0x26F70000, 0x11C70000, 0x48970000, 0x7FA70000, 0xFA370000, 0xCD070000,
+		0x94570000, 0xA3670000, 0x8F560000, 0xB8660000, 0xE1360000, 0xD6060000,
+		0x53960000, 0x64A60000, 0x3DF60000, 0x0AC60000, 0x65940000, 0x52A40000,
+		0x0BF40000, 0x3CC40000, 0xB9540000, 0x8E640000, 0xD7340000, 0xE0040000,
+		0xCC350000, 0xFB050000, 0xA2550000, 0x95650000, 0x10F50000, 0x27C50000,
+		0x7E950000, 0x49A50000, 0xA0310000, 0x97010000, 0xCE510000, 0xF9610000,
+		0x7CF10000, 0x4BC10000, 0x12910000, 0x25A10000, 0x09900000, 0x3EA00000,
+		0x67F00000, 0x50C00000, 0xD5500000, 0xE2600000, 0xBB300000, 0x8C000000,
+		0xE3520000, 0xD4620000, 0x8D320000, 0xBA020000, 0x3F920000, 0x08A20000,
+		0x51F20000, 0x66C20000, 0x4AF30000, 0x7DC30000, 0x24930000, 0x13A30000,
+		0x96330000, 0xA1030000, 0xF8530000, 0xCF630000
+	},
+	{
+		0x00000000, 0x76B40000, 0xED680000, 0x9BDC0000, 0xCAF10000, 0xBC450000,
+		0x27990000, 0x512D0000, 0x85C30000, 0xF3770000, 0x68AB0000, 0x1E1F0000,
+		0x4F320000, 0x39860000, 0xA25A0000, 0xD4EE0000, 0x1BA70000, 0x6D130000,
+		0xF6CF0000, 0x807B0000, 0xD1560000, 0xA7E20000, 0x3C3E0000, 0x4A8A0000,
+		0x9E640000, 0xE8D00000, 0x730C0000, 0x05B80000, 0x54950000, 0x22210000,
+		0xB9FD0000, 0xCF490000, 0x374E0000, 0x41FA0000, 0xDA260000, 0xAC920000,
+		0xFDBF0000, 0x8B0B0000, 0x10D70000, 0x66630000, 0xB28D0000, 0xC4390000,
+		0x5FE50000, 0x29510000, 0x787C0000, 0x0EC80000, 0x95140000, 0xE3A00000,
+		0x2CE90000, 0x5A5D0000, 0xC1810000, 0xB7350000, 0xE6180000, 0x90AC0000,
+		0x0B700000, 0x7DC40000, 0xA92A0000, 0xDF9E0000, 0x44420000, 0x32F60000,
+		0x63DB0000, 0x156F0000, 0x8EB30000, 0xF8070000, 0x6E9C0000, 0x18280000,
+		0x83F40000, 0xF5400000, 0xA46D0000, 0xD2D90000, 0x49050000, 0x3FB10000,
+		0xEB5F0000, 0x9DEB0000, 0x06370000, 0x70830000, 0x21AE0000, 0x571A0000,
+		0xCCC60000, 0xBA720000, 0x753B0000, 0x038F0000, 0x98530000, 0xEEE70000,
+		0xBFCA0000, 0xC97E0000, 0x52A20000, 0x24160000, 0xF0F80000, 0x864C0000,
+		0x1D900000, 0x6B240000, 0x3A090000, 0x4CBD0000, 0xD7610000, 0xA1D50000,
+		0x59D20000, 0x2F660000, 0xB4BA0000, 0xC20E0000, 0x93230000, 0xE5970000,
+		0x7E4B0000, 0x08FF0000, 0xDC110000, 0xAAA50000, 0x31790000, 0x47CD0000,
+		0x16E00000, 0x60540000, 0xFB880000, 0x8D3C0000, 0x42750000, 0x34C10000,
+		0xAF1D0000, 0xD9A90000, 0x88840000, 0xFE300000, 0x65EC0000, 0x13580000,
+		0xC7B60000, 0xB1020000, 0x2ADE0000, 0x5C6A0000, 0x0D470000, 0x7BF30000,
+		0xE02F0000, 0x969B0000, 0xDD380000, 0xAB8C0000, 0x30500000, 0x46E40000,
+		0x17C90000, 0x617D0000, 0xFAA10000, 0x8C150000, 0x58FB0000, 0x2E4F0000,
+		0xB5930000, 0xC3270000, 0x920A0000, 0xE4BE0000, 0x7F620000, 0x09D60000,
+		0xC69F0000, 0xB02B0000, 0x2BF70000, 0x5D430000, 0x0C6E0000, 0x7ADA0000,
+		0xE1060000, 0x97B20000, 0x435C0000, 0x35E80000, 0xAE340000, 0xD8800000,
+		0x89AD0000, 0xFF190000, 0x64C50000, 0x12710000, 0xEA760000, 0x9CC20000,
+		0x071E0000, 0x71AA0000, 0x20870000, 0x56330000, 0xCDEF0000, 0xBB5B0000,
+		0x6FB50000, 0x19010000, 0x82DD0000, 0xF4690000, 0xA5440000, 0xD3F00000,
+		0x482C0000, 0x3E980000, 0xF1D10000, 0x87650000, 0x1CB90000, 0x6A0D0000,
+		0x3B200000, 0x4D940000, 0xD6480000, 0xA0FC0000, 0x74120000, 0x02A60000,
+		0x997A0000, 0xEFCE0000, 0xBEE30000, 0xC8570000, 0x538B0000, 0x253F0000,
+		0xB3A40000, 0xC5100000, 0x5ECC0000, 0x28780000, 0x79550000, 0x0FE10000,
+		0x943D0000, 0xE2890000, 0x36670000, 0x40D30000, 0xDB0F0000, 0xADBB0000,
+		0xFC960000, 0x8A220000, 0x11FE0000, 0x674A0000, 0xA8030000, 0xDEB70000,
+		0x456B0000, 0x33DF0000, 0x62F20000, 0x14460000, 0x8F9A0000, 0xF92E0000,
+		0x2DC00000, 0x5B740000, 0xC0A80000, 0xB61C0000, 0xE7310000, 0x91850000,
+		0x0A590000, 0x7CED0000, 0x84EA0000, 0xF25E0000, 0x69820000, 0x1F360000,
+		0x4E1B0000, 0x38AF0000, 0xA3730000, 0xD5C70000, 0x01290000, 0x779D0000,
+		0xEC410000, 0x9AF50000, 0xCBD80000, 0xBD6C0000, 0x26B00000, 0x50040000,
+		0x9F4D0000, 0xE9F90000, 0x72250000, 0x04910000, 0x55BC0000, 0x23080000,
+		0xB8D40000, 0xCE600000, 0x1A8E0000, 0x6C3A0000, 0xF7E60000, 0x81520000,
+		0xD07F0000, 0xA6CB0000, 0x3D170000, 0x4BA30000
+	}
+};
+
+static const uint32_t crc8_smbus_table[4][256] = {
+	{
+		0x00000000, 0x07000000, 0x0E000000, 0x09000000, 0x1C000000, 0x1B000000,
+		0x12000000, 0x15000000, 0x38000000, 0x3F000000, 0x36000000, 0x31000000,
+		0x24000000, 0x23000000, 0x2A000000, 0x2D000000, 0x70000000, 0x77000000,
+		0x7E000000, 0x79000000, 0x6C000000, 0x6B000000, 0x62000000, 0x65000000,
+		0x48000000, 0x4F000000, 0x46000000, 0x41000000, 0x54000000, 0x53000000,
+		0x5A000000, 0x5D000000, 0xE0000000, 0xE7000000, 0xEE000000, 0xE9000000,
+		0xFC000000, 0xFB000000, 0xF2000000, 0xF5000000, 0xD8000000, 0xDF000000,
+		0xD6000000, 0xD1000000, 0xC4000000, 0xC3000000, 0xCA000000, 0xCD000000,
+		0x90000000, 0x97000000, 0x9E000000, 0x99000000, 0x8C000000, 0x8B000000,
+		0x82000000, 0x85000000, 0xA8000000, 0xAF000000, 0xA6000000, 0xA1000000,
+		0xB4000000, 0xB3000000, 0xBA000000, 0xBD000000, 0xC7000000, 0xC0000000,
+		0xC9000000, 0xCE000000, 0xDB000000, 0xDC000000, 0xD5000000, 0xD2000000,
+		0xFF000000, 0xF8000000, 0xF1000000, 0xF6000000, 0xE3000000, 0xE4000000,
+		0xED000000, 0xEA000000, 0xB7000000, 0xB0000000, 0xB9000000, 0xBE000000,
+		0xAB000000, 0xAC000000, 0xA5000000, 0xA2000000, 0x8F000000, 0x88000000,
+		0x81000000, 0x86000000, 0x93000000, 0x94000000, 0x9D000000, 0x9A000000,
+		0x27000000, 0x20000000, 0x29000000, 0x2E000000, 0x3B000000, 0x3C000000,
+		0x35000000, 0x32000000, 0x1F000000, 0x18000000, 0x11000000, 0x16000000,
+		0x03000000, 0x04000000, 0x0D000000, 0x0A000000, 0x57000000, 0x50000000,
+		0x59000000, 0x5E000000, 0x4B000000, 0x4C000000, 0x45000000, 0x42000000,
+		0x6F000000, 0x68000000, 0x61000000, 0x66000000, 0x73000000, 0x74000000,
+		0x7D000000, 0x7A000000, 0x89000000, 0x8E000000, 0x87000000, 0x80000000,
+		0x95000000, 0x92000000, 0x9B000000, 0x9C000000, 0xB1000000, 0xB6000000,
+		0xBF000000, 0xB8000000, 0xAD000000, 0xAA000000, 0xA3000000, 0xA4000000,
+		0xF9000000, 0xFE000000, 0xF7000000, 0xF0000000, 0xE5000000, 0xE2000000,
+		0xEB000000, 0xEC000000, 0xC1000000, 0xC6000000, 0xCF000000, 0xC8000000,
+		0xDD000000, 0xDA000000, 0xD3000000, 0xD4000000, 0x69000000, 0x6E000000,
+		0x67000000, 0x60000000, 0x75000000, 0x72000000, 0x7B000000, 0x7C000000,
+		0x51000000, 0x56000000, 0x5F000000, 0x58000000, 0x4D000000, 0x4A000000,
+		0x43000000, 0x44000000, 0x19000000, 0x1E000000, 0x17000000, 0x10000000,
+		0x05000000, 0x02000000, 0x0B000000, 0x0C000000, 0x21000000, 0x26000000,
+		0x2F000000, 0x28000000, 0x3D000000, 0x3A000000, 0x33000000, 0x34000000,
+		0x4E000000, 0x49000000, 0x40000000, 0x47000000, 0x52000000, 0x55000000,
+		0x5C000000, 0x5B000000, 0x76000000, 0x71000000, 0x78000000, 0x7F000000,
+		0x6A000000, 0x6D000000, 0x64000000, 0x63000000, 0x3E000000, 0x39000000,
+		0x30000000, 0x37000000, 0x22000000, 0x25000000, 0x2C000000, 0x2B000000,
+		0x06000000, 0x01000000, 0x08000000, 0x0F000000, 0x1A000000, 0x1D000000,
+		0x14000000, 0x13000000, 0xAE000000, 0xA9000000, 0xA0000000, 0xA7000000,
+		0xB2000000, 0xB5000000, 0xBC000000, 0xBB000000, 0x96000000, 0x91000000,
+		0x98000000, 0x9F000000, 0x8A000000, 0x8D000000, 0x84000000, 0x83000000,
+		0xDE000000, 0xD9000000, 0xD0000000, 0xD7000000, 0xC2000000, 0xC5000000,
+		0xCC000000, 0xCB000000, 0xE6000000, 0xE1000000, 0xE8000000, 0xEF000000,
+		0xFA000000, 0xFD000000, 0xF4000000, 0xF3000000
+	},
+	{
+		0x00000000, 0x15000000, 0x2A000000, 0x3F000000, 0x54000000, 0x41000000,
+		0x7E000000, 0x6B000000, 0xA8000000, 0xBD000000, 0x82000000, 0x97000000,
+		0xFC000000, 0xE9000000, 0xD6000000, 0xC3000000, 0x57000000, 0x42000000,
+		0x7D000000, 0x68000000, 0x03000000, 0x16000000, 0x29000000, 0x3C000000,
+		0xFF000000, 0xEA000000, 0xD5000000, 0xC0000000, 0xAB000000, 0xBE000000,
+		0x81000000, 0x94000000, 0xAE000000, 0xBB000000, 0x84000000, 0x91000000,
+		0xFA000000, 0xEF000000, 0xD0000000, 0xC5000000, 0x06000000, 0x13000000,
+		0x2C000000, 0x39000000, 0x52000000, 0x47000000, 0x78000000, 0x6D000000,
+		0xF9000000, 0xEC000000, 0xD3000000, 0xC6000000, 0xAD000000, 0xB8000000,
+		0x87000000, 0x92000000, 0x51000000, 0x44000000, 0x7B000000, 0x6E000000,
+		0x05000000, 0x10000000, 0x2F000000, 0x3A000000, 0x5B000000, 0x4E000000,
+		0x71000000, 0x64000000, 0x0F000000, 0x1A000000, 0x25000000, 0x30000000,
+		0xF3000000, 0xE6000000, 0xD9000000, 0xCC000000, 0xA7000000, 0xB2000000,
+		0x8D000000, 0x98000000, 0x0C000000, 0x19000000, 0x26000000, 0x33000000,
+		0x58000000, 0x4D000000, 0x72000000, 0x67000000, 0xA4000000, 0xB1000000,
+		0x8E000000, 0x9B000000, 0xF0000000, 0xE5000000, 0xDA000000, 0xCF000000,
+		0xF5000000, 0xE0000000, 0xDF000000, 0xCA000000, 0xA1000000, 0xB4000000,
+		0x8B000000, 0x9E000000, 0x5D000000, 0x48000000, 0x77000000, 0x62000000,
+		0x09000000, 0x1C000000, 0x23000000, 0x36000000, 0xA2000000, 0xB7000000,
+		0x88000000, 0x9D000000, 0xF6000000, 0xE3000000, 0xDC000000, 0xC9000000,
+		0x0A000000, 0x1F000000, 0x20000000, 0x35000000, 0x5E000000, 0x4B000000,
+		0x74000000, 0x61000000, 0xB6000000, 0xA3000000, 0x9C000000, 0x89000000,
+		0xE2000000, 0xF7000000, 0xC8000000, 0xDD000000, 0x1E000000, 0x0B000000,
+		0x34000000, 0x21000000, 0x4A000000, 0x5F000000, 0x60000000, 0x75000000,
+		0xE1000000, 0xF4000000, 0xCB000000, 0xDE000000, 0xB5000000, 0xA0000000,
+		0x9F000000, 0x8A000000, 0x49000000, 0x5C000000, 0x63000000, 0x76000000,
+		0x1D000000, 0x08000000, 0x37000000, 0x22000000, 0x18000000, 0x0D000000,
+		0x32000000, 0x27000000, 0x4C000000, 0x59000000, 0x66000000, 0x73000000,
+		0xB0000000, 0xA5000000, 0x9A000000, 0x8F000000, 0xE4000000, 0xF1000000,
+		0xCE000000, 0xDB000000, 0x4F000000, 0x5A000000, 0x65000000, 0x70000000,
+		0x1B000000, 0x0E000000, 0x31000000, 0x24000000, 0xE7000000, 0xF2000000,
+		0xCD000000, 0xD8000000, 0xB3000000, 0xA6000000, 0x99000000, 0x8C000000,
+		0xED000000, 0xF8000000, 0xC7000000, 0xD2000000, 0xB9000000, 0xAC000000,
+		0x93000000, 0x86000000, 0x45000000, 0x50000000, 0x6F000000, 0x7A000000,
+		0x11000000, 0x04000000, 0x3B000000, 0x2E000000, 0xBA000000, 0xAF000000,
+		0x90000000, 0x85000000, 0xEE000000, 0xFB000000, 0xC4000000, 0xD1000000,
+		0x12000000, 0x07000000, 0x38000000, 0x2D000000, 0x46000000, 0x53000000,
+		0x6C000000, 0x79000000, 0x43000000, 0x56000000, 0x69000000, 0x7C000000,
+		0x17000000, 0x02000000, 0x3D000000, 0x28000000, 0xEB000000, 0xFE000000,
+		0xC1000000, 0xD4000000, 0xBF000000, 0xAA000000, 0x95000000, 0x80000000,
+		0x14000000, 0x01000000, 0x3E000000, 0x2B000000, 0x40000000, 0x55000000,
+		0x6A000000, 0x7F000000, 0xBC000000, 0xA9000000, 0x96000000, 0x83000000,
+		0xE8000000, 0xFD000000, 0xC2000000, 0xD7000000
+	},
+	{
+		0x00000000, 0x6B000000, 0xD6000000, 0xBD000000, 0xAB000000, 0xC0000000,
+		0x7D000000, 0x16000000, 0x51000000, 0x3A000000, 0x87000000, 0xEC000000,
+		0xFA000000, 0x91000000, 0x2C000000, 0x47000000, 0xA2000000, 0xC9000000,
+		0x74000000, 0x1F000000, 0x09000000, 0x62000000, 0xDF000000, 0xB4000000,
+		0xF3000000, 0x98000000, 0x25000000, 0x4E000000, 0x58000000, 0x33000000,
+		0x8E000000, 0xE5000000, 0x43000000, 0x28000000, 0x95000000, 0xFE000000,
+		0xE8000000, 0x83000000, 0x3E000000, 0x55000000, 0x12000000, 0x79000000,
+		0xC4000000, 0xAF000000, 0xB9000000, 0xD2000000, 0x6F000000, 0x04000000,
+		0xE1000000, 0x8A000000, 0x37000000, 0x5C000000, 0x4A000000, 0x21000000,
+		0x9C000000, 0xF7000000, 0xB0000000, 0xDB000000, 0x66000000, 0x0D000000,
+		0x1B000000, 0x70000000, 0xCD000000, 0xA6000000, 0x86000000, 0xED000000,
+		0x50000000, 0x3B000000, 0x2D000000, 0x46000000, 0xFB000000, 0x90000000,
+		0xD7000000, 0xBC000000, 0x01000000, 0x6A000000, 0x7C000000, 0x17000000,
+		0xAA000000, 0xC1000000, 0x24000000, 0x4F000000, 0xF2000000, 0x99000000,
+		0x8F000000, 0xE4000000, 0x59000000, 0x32000000, 0x75000000, 0x1E000000,
+		0xA3000000, 0xC8000000, 0xDE000000, 0xB5000000, 0x08000000, 0x63000000,
+		0xC5000000, 0xAE000000, 0x13000000, 0x78000000, 0x6E000000, 0x05000000,
+		0xB8000000, 0xD3000000, 0x94000000, 0xFF000000, 0x42000000, 0x29000000,
+		0x3F000000, 0x54000000, 0xE9000000, 0x82000000, 0x67000000, 0x0C000000,
+		0xB1000000, 0xDA000000, 0xCC000000, 0xA7000000, 0x1A000000, 0x71000000,
+		0x36000000, 0x5D000000, 0xE0000000, 0x8B000000, 0x9D000000, 0xF6000000,
+		0x4B000000, 0x20000000, 0x0B000000, 0x60000000, 0xDD000000, 0xB6000000,
+		0xA0000000, 0xCB000000, 0x76000000, 0x1D000000, 0x5A000000, 0x31000000,
+		0x8C000000, 0xE7000000, 0xF1000000, 0x9A000000, 0x27000000, 0x4C000000,
+		0xA9000000, 0xC2000000, 0x7F000000, 0x14000000, 0x02000000, 0x69000000,
+		0xD4000000, 0xBF000000, 0xF8000000, 0x93000000, 0x2E000000, 0x45000000,
+		0x53000000, 0x38000000, 0x85000000, 0xEE000000, 0x48000000, 0x23000000,
+		0x9E000000, 0xF5000000, 0xE3000000, 0x88000000, 0x35000000, 0x5E000000,
+		0x19000000, 0x72000000, 0xCF000000, 0xA4000000, 0xB2000000, 0xD9000000,
+		0x64000000, 0x0F000000, 0xEA000000, 0x81000000, 0x3C000000, 0x57000000,
+		0x41000000, 0x2A000000, 0x97000000, 0xFC000000, 0xBB000000, 0xD0000000,
+		0x6D000000, 0x06000000, 0x10000000, 0x7B000000, 0xC6000000, 0xAD000000,
+		0x8D000000, 0xE6000000, 0x5B000000, 0x30000000, 0x26000000, 0x4D000000,
+		0xF0000000, 0x9B000000, 0xDC000000, 0xB7000000, 0x0A000000, 0x61000000,
+		0x77000000, 0x1C000000, 0xA1000000, 0xCA000000, 0x2F000000, 0x44000000,
+		0xF9000000, 0x92000000, 0x84000000, 0xEF000000, 0x52000000, 0x39000000,
+		0x7E000000, 0x15000000, 0xA8000000, 0xC3000000, 0xD5000000, 0xBE000000,
+		0x03000000, 0x68000000, 0xCE000000, 0xA5000000, 0x18000000, 0x73000000,
+		0x65000000, 0x0E000000, 0xB3000000, 0xD8000000, 0x9F000000, 0xF4000000,
+		0x49000000, 0x22000000, 0x34000000, 0x5F000000, 0xE2000000, 0x89000000,
+		0x6C000000, 0x07000000, 0xBA000000, 0xD1000000, 0xC7000000, 0xAC000000,
+		0x11000000, 0x7A000000, 0x3D000000, 0x56000000, 0xEB000000, 0x80000000,
+		0x96000000, 0xFD000000, 0x40000000, 0x2B000000
+	},
+	{
+		0x00000000, 0x16000000, 0x2C000000, 0x3A000000, 0x58000000, 0x4E000000,
+		0x74000000, 0x62000000, 0xB0000000, 0xA6000000, 0x9C000000, 0x8A000000,
+		0xE8000000, 0xFE000000, 0xC4000000, 0xD2000000, 0x67000000, 0x71000000,
+		0x4B000000, 0x5D000000, 0x3F000000, 0x29000000, 0x13000000, 0x05000000,
+		0xD7000000, 0xC1000000, 0xFB000000, 0xED000000, 0x8F000000, 0x99000000,
+		0xA3000000, 0xB5000000, 0xCE000000, 0xD8000000, 0xE2000000, 0xF4000000,
+		0x96000000, 0x80000000, 0xBA000000, 0xAC000000, 0x7E000000, 0x68000000,
+		0x52000000, 0x44000000, 0x26000000, 0x30000000, 0x0A000000, 0x1C000000,
+		0xA9000000, 0xBF000000, 0x85000000, 0x93000000, 0xF1000000, 0xE7000000,
+		0xDD000000, 0xCB000000, 0x19000000, 0x0F000000, 0x35000000, 0x23000000,
+		0x41000000, 0x57000000, 0x6D000000, 0x7B000000, 0x9B000000, 0x8D000000,
+		0xB7000000, 0xA1000000, 0xC3000000, 0xD5000000, 0xEF000000, 0xF9000000,
+		0x2B000000, 0x3D000000, 0x07000000, 0x11000000, 0x73000000, 0x65000000,
+		0x5F000000, 0x49000000, 0xFC000000, 0xEA000000, 0xD0000000, 0xC6000000,
+		0xA4000000, 0xB2000000, 0x88000000, 0x9E000000, 0x4C000000, 0x5A000000,
+		0x60000000, 0x76000000, 0x14000000, 0x02000000, 0x38000000, 0x2E000000,
+		0x55000000, 0x43000000, 0x79000000, 0x6F000000, 0x0D000000, 0x1B000000,
+		0x21000000, 0x37000000, 0xE5000000, 0xF3000000, 0xC9000000, 0xDF000000,
+		0xBD000000, 0xAB000000, 0x91000000, 0x87000000, 0x32000000, 0x24000000,
+		0x1E000000, 0x08000000, 0x6A000000, 0x7C000000, 0x46000000, 0x50000000,
+		0x82000000, 0x94000000, 0xAE000000, 0xB8000000, 0xDA000000, 0xCC000000,
+		0xF6000000, 0xE0000000, 0x31000000, 0x27000000, 0x1D000000, 0x0B000000,
+		0x69000000, 0x7F000000, 0x45000000, 0x53000000, 0x81000000, 0x97000000,
+		0xAD000000, 0xBB000000, 0xD9000000, 0xCF000000, 0xF5000000, 0xE3000000,
+		0x56000000, 0x40000000, 0x7A000000, 0x6C000000, 0x0E000000, 0x18000000,
+		0x22000000, 0x34000000, 0xE6000000, 0xF0000000, 0xCA000000, 0xDC000000,
+		0xBE000000, 0xA8000000, 0x92000000, 0x84000000, 0xFF000000, 0xE9000000,
+		0xD3000000, 0xC5000000, 0xA7000000, 0xB1000000, 0x8B000000, 0x9D000000,
+		0x4F000000, 0x59000000, 0x63000000, 0x75000000, 0x17000000, 0x01000000,
+		0x3B000000, 0x2D000000, 0x98000000, 0x8E000000, 0xB4000000, 0xA2000000,
+		0xC0000000, 0xD6000000, 0xEC000000, 0xFA000000, 0x28000000, 0x3E000000,
+		0x04000000, 0x12000000, 0x70000000, 0x66000000, 0x5C000000, 0x4A000000,
+		0xAA000000, 0xBC000000, 0x86000000, 0x90000000, 0xF2000000, 0xE4000000,
+		0xDE000000, 0xC8000000, 0x1A000000, 0x0C000000, 0x36000000, 0x20000000,
+		0x42000000, 0x54000000, 0x6E000000, 0x78000000, 0xCD000000, 0xDB000000,
+		0xE1000000, 0xF7000000, 0x95000000, 0x83000000, 0xB9000000, 0xAF000000,
+		0x7D000000, 0x6B000000, 0x51000000, 0x47000000, 0x25000000, 0x33000000,
+		0x09000000, 0x1F000000, 0x64000000, 0x72000000, 0x48000000, 0x5E000000,
+		0x3C000000, 0x2A000000, 0x10000000, 0x06000000, 0xD4000000, 0xC2000000,
+		0xF8000000, 0xEE000000, 0x8C000000, 0x9A000000, 0xA0000000, 0xB6000000,
+		0x03000000, 0x15000000, 0x2F000000, 0x39000000, 0x5B000000, 0x4D000000,
+		0x77000000, 0x61000000, 0xB3000000, 0xA5000000, 0x9F000000, 0x89000000,
+		0xEB000000, 0xFD000000, 0xC7000000, 0xD1000000
+	}
+};
+
+
+const crc_t crc32_ieee = {
+	crc32_ieee_table, 0xFFFFFFFFu, 0xFFFFFFFFu, 32, 1
+};
+
+const crc_t crc16_ccitt = {
+	crc16_ccitt_table, 0xFFFFu, 0x0000u, 16, 0
+};
+
+const crc_t crc8_smbus = {
+	crc8_smbus_table, 0x00u, 0x00u, 8, 0
+};
+
+static inline uint32_t crc_mask(uint8_t width) {
+	return (width == 32) ? 0xFFFFFFFFu : ((0x1u << width) - 1);
+}
+
+static uint32_t crc_reflect(uint32_t value, uint8_t width) {
+	uint32_t result = 0;
+	uint8_t i;
+
+	for (i = 0; i < width; i++, value >>= 1) {
+		result = (result << 1) | (value & 0x1u);
+	}
+	return result;
+}
+
+uint8_t crc_table_init(crc_t *crc, crc_table_t table, uint8_t width,
+		uint32_t poly, uint32_t init, uint32_t xorout, uint8_t reflected) {
+	uint32_t c, i, k;
+	uint8_t bit;
+
+	if (width < 8 || width > 32) {
+		return 0;
+	}
+	poly &= crc_mask(width);
+	if (reflected) {
+		poly = crc_reflect(poly, width);
+	} else {
+		poly <<= 32 - width;
+	}
+	for (i = 0; i < 256; i++) {
+		if (reflected) {
+			for (c = i, bit = 0; bit < 8; bit++) {
+				c = (c & 0x1u) ? ((c >> 1) ^ poly) : (c >> 1);
+			}
+		} else {
+			for (c = i << 24, bit = 0; bit < 8; bit++) {
+				c = (c & 0x80000000u) ? ((c << 1) ^ poly) : (c << 1);
+			}
+		}
+		table[0][i] = c;
+	}
+	for (k = 1; k < 4; k++) {
+		for (i = 0; i < 256; i++) {
+			c = table[k - 1][i];
+			table[k][i] = reflected ? ((c >> 8) ^ table[0][c & 0xFFu]) :
+					((c << 8) ^ table[0][c >> 24]);
+		}
+	}
+	crc->table = (const uint32_t (*)[256]) table;
+	crc->init = init & crc_mask(width);
+	crc->xorout = xorout & crc_mask(width);
+	crc->width = width;
+	crc->reflected = reflected ? 1 : 0;
+	return 1;
+}
+
+uint32_t crc_start(const crc_t *crc) {
+	if (crc->reflected) {
+		return crc_reflect(crc->init, crc->width);
+	}
+	return (crc->width == 32) ? crc->init : (crc->init << (32 - crc->width));
+}
+
+/*
+ * LSB first, the word is loaded little-endian so its first byte is in the
+ * lowest bits of the register.
+ */
+static uint32_t crc_update_reflected(const uint32_t (*t)[256], uint32_t reg,
+		const uint8_t *p, uint32_t length) {
+	const uint32_t *word;
+
+	for (; length > 0 && ((uintptr_t) p & (CRC_SLICE - 1)); length--) {
+		reg = t[0][(reg ^ *p++) & 0xFFu] ^ (reg >> 8);
+	}
+	for (word = (const uint32_t *) p; length >= CRC_SLICE;
+			length -= CRC_SLICE) {
+		reg ^= *word++;
+		reg = t[3][reg & 0xFFu] ^ t[2][(reg >> 8) & 0xFFu] ^
+				t[1][(reg >> 16) & 0xFFu] ^ t[0][reg >> 24];
+	}
+	for (p = (const uint8_t *) word; length > 0; length--) {
+		reg = t[0][(reg ^ *p++) & 0xFFu] ^ (reg >> 8);
+	}
+	return reg;
+}
+
+/*
+ * MSB first, the word is byte swapped (REV) so its first byte is in the
+ * highest bits of the register.
+ */
+static uint32_t crc_update_normal(const uint32_t (*t)[256], uint32_t reg,
+		const uint8_t *p, uint32_t length) {
+	const uint32_t *word;
+
+	for (; length > 0 && ((uintptr_t) p & (CRC_SLICE - 1)); length--) {
+		reg = t[0][(reg >> 24) ^ *p++] ^ (reg << 8);
+	}
+	for (word = (const uint32_t *) p; length >= CRC_SLICE;
+			length -= CRC_SLICE) {
+		reg ^= __builtin_bswap32(*word++);
+		reg = t[3][reg >> 24] ^ t[2][(reg >> 16) & 0xFFu] ^
+				t[1][(reg >> 8) & 0xFFu] ^ t[0][reg & 0xFFu];
+	}
+	for (p = (const uint8_t *) word; length > 0; length--) {
+		reg = t[0][(reg >> 24) ^ *p++] ^ (reg << 8);
+	}
+	return reg;
+}
+
+uint32_t crc_update(const crc_t *crc, uint32_t state, const void *data,
+		uint32_t length) {
+	if (crc->reflected) {
+		return crc_update_reflected(crc->table, state, data, length);
+	}
+	return crc_update_normal(crc->table, state, data, length);
+}
+
+uint32_t crc_final(const crc_t *crc, uint32_t state) {
+	if (!crc->reflected && crc->width != 32) {
+		state >>= 32 - crc->width;
+	}
+	return (state ^ crc->xorout) & crc_mask(crc->width);
+}
+
+uint32_t crc_compute(const crc_t *crc, const void *data, uint32_t length) {
+	return crc_final(crc, crc_update(crc, crc_start(crc), data, length));
+}
@@ -0,0 +1,125 @@
+/**
+ * @file crc.h
+ * @brief CRC - Table-driven CRC-8, CRC-16 and CRC-32
+ * @details Computes cyclic redundancy checks of 8 to 32 bits with any
+ * polynomial, described by a crc_t. The data is taken four bytes at a time
+ * with four tables of 256 words (slice-by-4): a word load and four table
+ * loads that don't depend on each other per four bytes, instead of four
+ * table loads that each wait for the one before. The tables are const and
+ * stay in flash. Bytes before the first aligned word and after the last one
+ * go through the first table alone, so data of any alignment and length is
+ * accepted.
+ *
+ * Three CRCs come with their tables in flash:
+ * - crc32_ieee: CRC-32 of Ethernet and zlib, used for the records of
+ *   flash_kv.h
+ * - crc16_ccitt: CRC-16/CCITT-FALSE (polynomial 0x1021, initial 0xFFFF),
+ *   used for the lines of logger.h
+ * - crc8_smbus: CRC-8 with polynomial 0x07, the packet error code of SMBus
+ *   transfers on the TWI
+ *
+ * Other polynomials get their tables, 4 KiB, from crc_table_init().
+ *
+ * The CRC of data given in pieces, e.g. the blocks of a DMA transfer from
+ * its completion callback, is kept in a uint32_t:
+ * @code
+ *	static uint32_t state;
+ *
+ *	state = crc_start(&crc32_ieee);
+ *	// in the callback of each block
+ *	state = crc_update(&crc32_ieee, state, block, length);
+ *	// after the last
+ *	crc = crc_final(&crc32_ieee, state);
+ * @endcode
+ *
+ * The functions keep no state and can be called from tasks and interrupt
+ * handlers at the same time.
+ * @date 14 October 2026
+ */
+
+#ifndef CRC_H_
+#define CRC_H_
+
+#include <inttypes.h>
+
+/**
+ * Tables of a CRC, see crc_table_init().
+ */
+typedef uint32_t crc_table_t[4][256];
+
+/**
+ * A CRC in the parameters of the Rocksoft model: width, polynomial,
+ * initial value, final XOR and bit order.
+ */
+typedef struct crc {
+	/** The tables of the polynomial and bit order */
+	const uint32_t (*table)[256];
+	/** Initial value, not reflected */
+	uint32_t init;
+	/** XORed with the result */
+	uint32_t xorout;
+	/** Bits of the CRC (8-32) */
+	uint8_t width;
+	/** 1 if the bytes are taken LSB first and the result reflected */
+	uint8_t reflected;
+} crc_t;
+
+/// CRC-32 (IEEE 802.3): poly 0x04C11DB7, init and xorout 0xFFFFFFFF, reflected
+extern const crc_t crc32_ieee;
+
+/// CRC-16/CCITT-FALSE: poly 0x1021, init 0xFFFF, xorout 0, not reflected
+extern const crc_t crc16_ccitt;
+
+/// CRC-8/SMBUS: poly 0x07, init and xorout 0, not reflected
+extern const crc_t crc8_smbus;
+
+/**
+ * Describes a CRC of another polynomial and builds its tables.
+ * @param crc The CRC.
+ * @param table Receives the tables, they are used by crc until it is no
+ * longer needed.
+ * @param width Bits of the CRC (8-32).
+ * @param poly The polynomial without its highest term, in the lowest width
+ * bits, e.g. 0x8005 for CRC-16/ARC.
+ * @param init The initial value, not reflected.
+ * @param xorout XORed with the result.
+ * @param reflected 1 to take the bytes LSB first and reflect the result.
+ * @return 1 on success, 0 if the width is invalid.
+ */
+uint8_t crc_table_init(crc_t *crc, crc_table_t table, uint8_t width,
+		uint32_t poly, uint32_t init, uint32_t xorout, uint8_t reflected);
+
+/**
+ * @param crc The CRC.
+ * @return The state before the first byte.
+ */
+uint32_t crc_start(const crc_t *crc);
+
+/**
+ * Adds data to a CRC.
+ * @param crc The CRC.
+ * @param state The state from crc_start() or the last crc_update().
+ * @param data The data, of any alignment.
+ * @param length Bytes of data.
+ * @return The new state.
+ */
+uint32_t crc_update(const crc_t *crc, uint32_t state, const void *data,
+		uint32_t length);
+
+/**
+ * @param crc The CRC.
+ * @param state The state after the last byte.
+ * @return The CRC, in the lowest width bits.
+ */
+uint32_t crc_final(const crc_t *crc, uint32_t state);
+
+/**
+ * The CRC of data in one piece.
+ * @param crc The CRC.
+ * @param data The data, of any alignment.
+ * @param length Bytes of data.
+ * @return The CRC, in the lowest width bits.
+ */
+uint32_t crc_compute(const crc_t *crc, const void *data, uint32_t length);
+
+#endif
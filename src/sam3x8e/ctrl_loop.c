@@ -0,0 +1,167 @@
+/*
+ * ctrl_loop.c
+ *
+ * Date:	14 October 2026
+ */
+
+#include "ctrl_loop.h"
+#include "delay.h"
+#include "io_req.h"
+#include "pwm.h"
+#include "ramfunc.h"
+#include "irq.h"
+
+static struct {
+	const ctrl_loop_config_t *config;
+	io_req_t req;
+	// one buffer is filled by the PDC, the other is given to compute
+	uint16_t samples[2][ADC_SEQUENCE_MAX];
+	uint32_t filling;
+	uint32_t duty_cycles[8];
+	// period of channel 0 in ticks and in CPU cycles, 0 if unknown
+	uint32_t period;
+	uint32_t period_cycles;
+	uint32_t last_start;
+	uint8_t has_last;
+	volatile uint8_t running;
+	ctrl_loop_stats_t stats;
+} loop;
+
+/*
+ * Counts the events since the iteration before that had no iteration. The
+ * iterations start a period apart, give or take the interrupt latency.
+ */
+static void count_missed(uint32_t start) {
+	uint32_t period = loop.period_cycles;
+	uint32_t elapsed = start - loop.last_start;
+
+	if (period != 0 && loop.has_last && elapsed > period + period / 2) {
+		loop.stats.missed += (elapsed + period / 2) / period - 1;
+	}
+	loop.last_start = start;
+	loop.has_last = 1;
+}
+
+/*
+ * Called from the ADC interrupt when the scan of an event is stored.
+ */
+RAMFUNC_HOT static void loop_done(io_req_t *req, void *arg) {
+	const ctrl_loop_config_t *config = loop.config;
+	uint32_t start = DELAY_DWT_CYCCNT;
+	uint16_t *samples = loop.samples[loop.filling];
+	uint32_t counter, latency, cycles, i;
+
+	(void) req;
+	(void) arg;
+	// the next event is stored in the other buffer while this one is used
+	if (loop.running) {
+		loop.filling ^= 1u;
+		(void) adc_scan_req(loop.samples[loop.filling], 1, &loop.req);
+	}
+	count_missed(start);
+	for (i = 0; i < config->count; i++) {
+		samples[i] = ADC_SAMPLE_VALUE(samples[i]);
+	}
+	cycles = DELAY_DWT_CYCCNT;
+	config->compute(samples, config->count, loop.duty_cycles);
+	cycles = DELAY_DWT_CYCCNT - cycles;
+	(void) pwm_set_duty_cycles(config->pwm_channels, loop.duty_cycles);
+
+	// the counter restarts at 0 at the end of the period
+	counter = PWM->PWM_CCNT0 & PWM_CCNTx_CNT_MASK;
+	if (counter >= config->event_value) {
+		latency = counter - config->event_value;
+	} else {
+		latency = counter + loop.period - config->event_value;
+		loop.stats.late++;
+	}
+	loop.stats.iterations++;
+	loop.stats.latency_last = latency;
+	if (latency > loop.stats.latency_max) {
+		loop.stats.latency_max = latency;
+	}
+	if (cycles > loop.stats.compute_max) {
+		loop.stats.compute_max = cycles;
+	}
+}
+
+uint8_t ctrl_loop_start(const ctrl_loop_config_t *config) {
+	uint32_t trigger, prescaler, channel;
+
+	if (loop.running || config == 0 || config->compute == 0 ||
+		config->count == 0 || config->count > ADC_SEQUENCE_MAX ||
+		config->event_line > PWM_EVENT_LINE_1 || config->comparison > 7 ||
+		config->pwm_channels == 0 || config->pwm_channels > PWM_SCM_SYNC_MASK ||
+		!pwm_channel_enabled(PWM_CHANNEL_0) ||
+		pwm_get_channel_alignment(PWM_CHANNEL_0) != 0) {
+		return 0;
+	}
+	loop.period = pwm_get_channel_period(PWM_CHANNEL_0);
+	trigger = ADC_TRIGGER_PWM_EVENT0 + config->event_line;
+	if (config->event_value >= loop.period ||
+		(ADC->ADC_MR & (ADC_MR_TRGEN | ADC_MR_TRGSEL_MASK)) !=
+				(ADC_MR_TRGEN | ((trigger - 1) << ADC_MR_TRGSEL_POS)) ||
+		!adc_sequence_set(config->channels, config->count)) {
+		return 0;
+	}
+	// CLKA and CLKB have their own divisors, their events are not counted
+	prescaler = pwm_get_channel_prescaler(PWM_CHANNEL_0);
+	loop.period_cycles = (prescaler <= PWM_PRES_MCK_DIV_1024) ?
+			(loop.period << prescaler) : 0;
+	if (!(DELAY_DWT_CTRL & DELAY_DWT_CTRL_CYCCNTENA)) {
+		delay_init();
+	}
+	for (channel = 0; channel < 8; channel++) {
+		if (config->pwm_channels & (0x1u << channel)) {
+			loop.duty_cycles[channel] = pwm_read_channel(channel);
+		}
+	}
+	loop.config = config;
+	loop.filling = 0;
+	loop.has_last = 0;
+	ctrl_loop_reset_stats();
+	loop.stats.period = loop.period;
+	io_req_init(&loop.req, IO_REQ_NO_FLAG, loop_done, 0);
+
+	loop.running = 1;
+	if (!adc_scan_req(loop.samples[0], 1, &loop.req)) {
+		// a stream or scan holds the PDC channel of the ADC
+		loop.running = 0;
+		adc_sequence_disable();
+		return 0;
+	}
+	(void) pwm_set_event_compare(config->event_line, config->comparison,
+			config->event_value, 0);
+	return 1;
+}
+
+void ctrl_loop_stop(void) {
+	if (!loop.running) {
+		return;
+	}
+	loop.running = 0;
+	// the event keeps coming, so the scan started last is finished
+	while (loop.req.state == IO_REQ_BUSY);
+	(void) pwm_clear_event_compare(loop.config->event_line,
+			loop.config->comparison);
+	adc_sequence_disable();
+}
+
+void ctrl_loop_get_stats(ctrl_loop_stats_t *stats) {
+	uint32_t primask = irq_save();
+
+	*stats = loop.stats;
+	irq_restore(primask);
+}
+
+void ctrl_loop_reset_stats(void) {
+	uint32_t primask = irq_save();
+
+	loop.stats.iterations = 0;
+	loop.stats.late = 0;
+	loop.stats.missed = 0;
+	loop.stats.latency_last = 0;
+	loop.stats.latency_max = 0;
+	loop.stats.compute_max = 0;
+	irq_restore(primask);
+}
@@ -0,0 +1,138 @@
+/**
+ * @file ctrl_loop.h
+ * @brief Control loop - PWM event, ADC scan, compute and duty cycle update
+ * @details Runs a fixed-rate control loop entirely in hardware and one
+ * interrupt, without any task. A comparison unit of the PWM puts an event
+ * on an event line once in every period of channel 0, the event starts a
+ * scan of the ADC sequence and the PDC stores the samples. The ADC
+ * interrupt then calls the compute function with the samples and writes the
+ * duty cycles it returns to the update registers (CDTYUPD) of the PWM
+ * channels, which take them at the end of the same period:
+ * @code
+ *	static void compute(const uint16_t *samples, uint32_t count,
+ *			uint32_t duty_cycles[]) {
+ *		duty_cycles[0] = pi_step(&current, samples[0]);
+ *	}
+ *
+ *	static const uint8_t channels[] = { ADC_CHANNEL_7 };
+ *	static const ctrl_loop_config_t loop = {
+ *		.channels = channels, .count = 1,
+ *		.event_line = PWM_EVENT_LINE_0, .comparison = 2,
+ *		.event_value = 0, .pwm_channels = (1 << PWM_CHANNEL_0),
+ *		.compute = compute
+ *	};
+ *
+ *	ctrl_loop_start(&loop);
+ * @endcode
+ *
+ * The samples of the next scan are stored in a second buffer while the
+ * compute function runs, so the ADC is armed for the next event before it
+ * starts.
+ *
+ * Each iteration measures its latency: the ticks of the counter of channel
+ * 0 from the event to the end of the duty cycle update. The update is late
+ * when the counter has passed the end of the period by then, the new duty
+ * cycles only take effect one period later. An event is missed when its
+ * scan could not be stored because the iteration before was still running,
+ * which is found from the DWT cycle counter between two iterations. The
+ * margin of the loop is the period minus event_value minus the largest
+ * latency, see ctrl_loop_get_stats().
+ *
+ * @pre Set up channel 0 of the PWM (and the channels it drives, e.g. as
+ * synchronous channels) left aligned, with a prescaler of MCK (not CLKA/B)
+ * for the missed event count, and enable it. Initialize the ADC with
+ * adc_init() and the trigger ADC_TRIGGER_PWM_EVENT0 or ADC_TRIGGER_PWM_EVENT1
+ * of the event line. The ADC, its sequence and its PDC channel are used by
+ * the loop until ctrl_loop_stop().
+ * @date 14 October 2026
+ */
+
+#ifndef CTRL_LOOP_H_
+#define CTRL_LOOP_H_
+
+#include <inttypes.h>
+#include "adc.h"
+
+/**
+ * Called from the ADC interrupt with the samples of one scan.
+ * @param samples The samples, one per ADC channel of the sequence in its
+ * order, without the channel tags.
+ * @param count The number of samples.
+ * @param duty_cycles The new duty cycles, indexed by PWM channel number.
+ * Only the entries of the channels in pwm_channels are used, they hold the
+ * duty cycles of the iteration before.
+ */
+typedef void (*ctrl_loop_compute_t)(const uint16_t *samples, uint32_t count,
+		uint32_t duty_cycles[]);
+
+/**
+ * The configuration of a control loop, it must stay valid until
+ * ctrl_loop_stop().
+ */
+typedef struct ctrl_loop_config {
+	/** ADC channels of the scan, in order */
+	const uint8_t *channels;
+	/** Number of ADC channels (1-ADC_SEQUENCE_MAX) */
+	uint32_t count;
+	/** Event line of the ADC trigger, prefix: PWM_EVENT_LINE_ */
+	uint32_t event_line;
+	/** Comparison unit of the event (0-7) */
+	uint32_t comparison;
+	/** Counter value of channel 0 of the event, below its period */
+	uint32_t event_value;
+	/** PWM channels updated by the loop, one bit per channel */
+	uint32_t pwm_channels;
+	/** The compute function */
+	ctrl_loop_compute_t compute;
+} ctrl_loop_config_t;
+
+/**
+ * The timing of a control loop since ctrl_loop_start() or
+ * ctrl_loop_reset_stats().
+ */
+typedef struct ctrl_loop_stats {
+	/** Iterations run */
+	uint32_t iterations;
+	/** Iterations whose update took effect a period late */
+	uint32_t late;
+	/** Events without an iteration */
+	uint32_t missed;
+	/** Latency of the last iteration, in ticks of channel 0 */
+	uint32_t latency_last;
+	/** Largest latency, in ticks of channel 0 */
+	uint32_t latency_max;
+	/** Largest time of the compute function, in CPU cycles */
+	uint32_t compute_max;
+	/** Period of channel 0, in ticks */
+	uint32_t period;
+} ctrl_loop_stats_t;
+
+/**
+ * Starts the control loop: the comparison unit is added to the event line,
+ * the ADC sequence is set and the first scan waits for the event.
+ * @param config The configuration.
+ * @return error (1 = SUCCESS, 0 = FAIL, invalid configuration, channel 0
+ * is not enabled or center aligned, the ADC is not triggered by the event
+ * line or busy, or a loop is running)
+ */
+uint8_t ctrl_loop_start(const ctrl_loop_config_t *config);
+
+/**
+ * Stops the control loop after the iteration of the next event and
+ * removes the comparison unit from the event line. The duty cycles stay as
+ * they were last written.
+ */
+void ctrl_loop_stop(void);
+
+/**
+ * Reads the timing of the loop.
+ * @param stats The timing.
+ */
+void ctrl_loop_get_stats(ctrl_loop_stats_t *stats);
+
+/**
+ * Clears the counters and the largest latency and compute time.
+ */
+void ctrl_loop_reset_stats(void);
+
+#endif
@@ -10,6 +10,34 @@
 
 #include "pmc.h"
 #include "dacc.h"
+#include "bitband.h"
+#include "pdc.h"
+#include "pwm.h"
+#include "tc.h"
+#if DACC_COOS
+#include "rtos/CoOS.h"
+#endif
+
+// NVIC Interrupt Set/Clear-Enable Register 1 (peripheral ID 32-63)
+#define NVIC_ISER1		(*((volatile uint32_t *) PERIPH_ADDR(0xE000E104U)))
+#define NVIC_ICER1		(*((volatile uint32_t *) PERIPH_ADDR(0xE000E184U)))
+
+// Highest number of transfers in one PDC buffer
+#define DACC_PDC_MAX_COUNT	(0xFFFFu)
+
+// Peripheral clock of the timer of the trigger, 0 for none
+static uint32_t trigger_clock;
+
+// State of the streaming
+static struct {
+	uint16_t *half[2];
+	uint32_t half_samples;
+	uint32_t half_count;
+	uint32_t sending;
+	volatile uint32_t halves;
+	dacc_stream_callback_t callback;
+	uint8_t flag;
+} stream = { .flag = DACC_NO_FLAG };
 
 void dacc_init(const dacc_settings_t *settings) {
 	// Software reset
@@ -22,6 +50,16 @@ void dacc_init(const dacc_settings_t *settings) {
 	DACC->DACC_MR |= (settings->speed_mode << DACC_MR_MAXS_POS);
 	// Startup time selection
 	DACC->DACC_MR |= (settings->startup_time << DACC_MR_STARTUP_POS);
+	// Tag mode
+	if (settings->tag_mode) {
+		DACC->DACC_MR |= DACC_MR_TAG;
+	}
+	// Hardware trigger
+	if (settings->trigger != DACC_TRIGGER_SOFTWARE &&
+		settings->trigger <= DACC_TRIGGER_PWM_EVENT1) {
+		DACC->DACC_MR |= DACC_MR_TRGEN |
+				((settings->trigger - 1) << DACC_MR_TRGSEL_POS);
+	}
 }
 
 void dacc_enable_channel(uint32_t channel) {
@@ -45,8 +83,9 @@ uint32_t dacc_channel_enabled(uint32_t channel) {
 }
 
 void dacc_select_channel(uint32_t channel) {
+	// USER_SEL is 0 or 1, its upper bit stays 0
 	if (channel <= DACC_CHANNEL_MAX) {
-		DACC->DACC_MR |= (channel << DACC_MR_USER_SEL_POS);
+		bitband_write(&DACC->DACC_MR, DACC_MR_USER_SEL_POS, channel);
 	}
 }
 
@@ -59,9 +98,143 @@ uint32_t dacc_tx_ready(void) {
 * is used whereby [11:0] make up the actual output data.
 * If transfer mode is set to WORD then all bits are used whereby
 * [15:0] is converted first and afterwards the [31:16] bits.
+* In tag mode bits [13:12] (and [29:28]) select the channel.
 */
 void dacc_write(uint32_t value) {
-	if (value <= DACC_MAX_RESOLUTION) {
+	if (value <= DACC_MAX_RESOLUTION ||
+		(DACC->DACC_MR & (DACC_MR_WORD | DACC_MR_TAG))) {
 		DACC->DACC_CDR = value;
 	}
 }
+
+void dacc_interleave(const uint16_t *ch0, const uint16_t *ch1, uint16_t *out,
+		uint32_t n) {
+	// unrolled by two
+	while (n >= 2) {
+		out[0] = DACC_TAGGED(DACC_CHANNEL_0, ch0[0]);
+		out[1] = DACC_TAGGED(DACC_CHANNEL_1, ch1[0]);
+		out[2] = DACC_TAGGED(DACC_CHANNEL_0, ch0[1]);
+		out[3] = DACC_TAGGED(DACC_CHANNEL_1, ch1[1]);
+		ch0 += 2;
+		ch1 += 2;
+		out += 4;
+		n -= 2;
+	}
+	if (n) {
+		out[0] = DACC_TAGGED(DACC_CHANNEL_0, ch0[0]);
+		out[1] = DACC_TAGGED(DACC_CHANNEL_1, ch1[0]);
+	}
+}
+
+/*
+ * Acquire the clock of the timer of a trigger and release the one of the
+ * trigger before.
+ */
+static void use_trigger_clock(uint32_t id) {
+	if (id != trigger_clock) {
+		if (trigger_clock != 0) {
+			pmc_release_peripheral_clock(trigger_clock);
+		}
+		pmc_acquire_peripheral_clock(id);
+		trigger_clock = id;
+	}
+}
+
+uint32_t dacc_set_sample_rate(uint32_t trigger, uint32_t hz) {
+	switch (trigger) {
+	case DACC_TRIGGER_TIOA0:
+	case DACC_TRIGGER_TIOA1:
+	case DACC_TRIGGER_TIOA2:
+		use_trigger_clock(ID_TC0 + (trigger - DACC_TRIGGER_TIOA0));
+		return tc_set_trigger_rate(TC0, trigger - DACC_TRIGGER_TIOA0,
+				SYS_CLK_FREQ, hz);
+	case DACC_TRIGGER_PWM_EVENT0:
+	case DACC_TRIGGER_PWM_EVENT1:
+		use_trigger_clock(ID_PWM);
+		return pwm_set_event_rate(trigger - DACC_TRIGGER_PWM_EVENT0, hz);
+	default:
+		return 0;
+	}
+}
+
+uint8_t dacc_stream_start(uint16_t *buffer, uint32_t half_samples,
+		dacc_stream_callback_t callback) {
+	uint32_t half_count = half_samples;
+
+	if (buffer == 0 || half_samples == 0) {
+		return 0;
+	}
+	// two samples per transfer in word mode
+	if (DACC->DACC_MR & DACC_MR_WORD) {
+		if ((half_samples & 1u) || ((uint32_t) buffer & 3u)) {
+			return 0;
+		}
+		half_count = half_samples / 2;
+	}
+	if (half_count > DACC_PDC_MAX_COUNT) {
+		return 0;
+	}
+	dacc_stream_stop();
+	stream.half[0] = buffer;
+	stream.half[1] = buffer + half_samples;
+	stream.half_samples = half_samples;
+	stream.half_count = half_count;
+	stream.sending = 0;
+	stream.halves = 0;
+	stream.callback = callback;
+
+	DACC->DACC_IER = DACC_ISR_ENDTX;
+	NVIC_ISER1 = (0x1u << (ID_DACC - 32));
+	pdc_tx_start_ping_pong(PDC_OF(DACC), stream.half[0], stream.half[1],
+			half_count);
+	return 1;
+}
+
+void dacc_stream_stop(void) {
+	DACC->DACC_IDR = DACC_ISR_ENDTX;
+	pdc_tx_stop(PDC_OF(DACC));
+	NVIC_ICER1 = (0x1u << (ID_DACC - 32));
+}
+
+uint32_t dacc_stream_halves(void) {
+	return stream.halves;
+}
+
+uint16_t *dacc_stream_swap(uint16_t *buffer) {
+	// the half that is not being sent is the one queued in TNPR
+	uint32_t queued = stream.sending ^ 1u;
+	uint16_t *old = stream.half[queued];
+
+	stream.half[queued] = buffer;
+	PDC_OF(DACC)->PERIPH_TNPR = (uint32_t) buffer;
+	return old;
+}
+
+#if DACC_COOS
+void dacc_stream_set_flag(uint8_t flag) {
+	stream.flag = flag;
+}
+#endif
+
+void DACC_Handler(void) {
+	uint32_t sent;
+
+	if (DACC->DACC_ISR & DACC->DACC_IMR & DACC_ISR_ENDTX) {
+		/*
+		 * The PDC has moved on to the other half. The sent half is queued
+		 * as the next buffer, so it is sent again after the other half.
+		 */
+		sent = stream.sending;
+		stream.sending ^= 1u;
+		pdc_tx_next(PDC_OF(DACC), stream.half[sent], stream.half_count);
+		stream.halves++;
+		if (stream.callback) {
+			stream.callback(stream.half[sent], stream.half_samples);
+		}
+#if DACC_COOS
+		if (stream.flag != DACC_NO_FLAG) {
+			isr_SetFlag(stream.flag);
+		}
+#endif
+	}
+}
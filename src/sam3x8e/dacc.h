@@ -15,27 +15,59 @@
 #define DACC_H
 
 #include <inttypes.h>
+#include "periph.h"
+
+/*
+ * Set to 0 to build without the CoOS event flag support, e.g. when the RTOS
+ * is not linked into the application.
+ */
+#ifndef DACC_COOS
+#define DACC_COOS	(1)
+#endif
+
+// No event flag is set when a half of the stream buffer has been sent
+#define DACC_NO_FLAG	(0xFFu)
 
 ///@cond
 // Pointer to registers of the DACC peripheral.
-#define DACC ((dacc_reg_t *) 0x40094000U)
+#define DACC ((dacc_reg_t *) PERIPH_ADDR(0x400C8000U))
 ///@endcond
 
 #define DACC_CHANNEL_0		(0)			///<DACC Channel 0
 #define DACC_CHANNEL_1		(1)			///<DACC Channel 1
 #define DACC_CHANNEL_MAX	(1)
 
+// Conversion triggers (see dacc_settings_t)
+#define DACC_TRIGGER_SOFTWARE	(0)	///<Conversions start on a write to CDR
+#define DACC_TRIGGER_DATRG		(1)	///<External trigger pin DATRG
+#define DACC_TRIGGER_TIOA0		(2)	///<TIOA of TC0 channel 0
+#define DACC_TRIGGER_TIOA1		(3)	///<TIOA of TC0 channel 1
+#define DACC_TRIGGER_TIOA2		(4)	///<TIOA of TC0 channel 2
+#define DACC_TRIGGER_PWM_EVENT0	(5)	///<PWM event line 0
+#define DACC_TRIGGER_PWM_EVENT1	(6)	///<PWM event line 1
+
 ///@cond
 
 #define DACC_MAX_RESOLUTION 4095	///<The DACC has a 12 bit resolution
 
+#define DACC_MR_TRGEN			(0x1u << 0)
+#define DACC_MR_TRGSEL_POS		(1)
+#define DACC_MR_WORD			(0x1u << 4)
 #define DACC_MR_WORD_POS		(4)
 #define DACC_MR_REFRESH_POS		(8)
 #define DACC_MR_USER_SEL_POS	(16)
+#define DACC_MR_USER_SEL_MASK	(0x3u << 16)
+#define DACC_MR_TAG				(0x1u << 20)
 #define DACC_MR_MAXS_POS		(21)
 #define DACC_MR_STARTUP_POS		(24)
 
 #define DACC_ISR_TXRDY_MSK		(1u)
+#define DACC_ISR_EOC			(0x1u << 1)
+#define DACC_ISR_ENDTX			(0x1u << 2)
+#define DACC_ISR_TXBUFE			(0x1u << 3)
+
+#define DACC_PTCR_TXTEN			(0x1u << 8)
+#define DACC_PTCR_TXTDIS		(0x1u << 9)
 
 /*
  * Mapping of DACC registers
@@ -76,10 +108,33 @@ typedef struct {
 	uint32_t DACC_WPMR;
 	// Write Protect Status register, offset 0x00E8
 	uint32_t DACC_WPSR;
+	// reserved, offset 0x00EC-0x0104
+	uint32_t reserved5[7];
+	// Transmit Pointer Register, offset 0x0108
+	uint32_t DACC_TPR;
+	// Transmit Counter Register, offset 0x010C
+	uint32_t DACC_TCR;
+	// reserved, offset 0x0110-0x0114
+	uint32_t reserved6[2];
+	// Transmit Next Pointer Register, offset 0x0118
+	uint32_t DACC_TNPR;
+	// Transmit Next Counter Register, offset 0x011C
+	uint32_t DACC_TNCR;
+	// Transfer Control Register, offset 0x0120
+	uint32_t DACC_PTCR;
+	// Transfer Status Register, offset 0x0124
+	uint32_t DACC_PTSR;
 } dacc_reg_t;
 
 ///@endcond
 
+/**
+ * A sample tagged with its channel, for tag mode (see dacc_settings_t).
+ * The channel is in bits 12-13 of each half-word.
+ */
+#define DACC_TAGGED(channel, value)	\
+	((uint16_t) ((((channel) & 0x3u) << 12) | ((value) & 0xFFFu)))
+
 /**
  * Input parameters when initializing the DAC Controller.
  */
@@ -101,6 +156,18 @@ typedef struct dacc_settings {
 	 * The length for each corresponding value can be found in the datasheet.
 	 */
 	uint32_t startup_time;
+	/**
+	 * Select what starts a conversion, use prefix: DACC_TRIGGER_
+	 * The default (0) is DACC_TRIGGER_SOFTWARE. Use dacc_set_sample_rate()
+	 * to let a TC channel or the PWM trigger the conversions at a fixed rate.
+	 */
+	uint32_t trigger;
+	/**
+	 * 0: The channel is selected with dacc_select_channel()
+	 * 1: Tag mode, the channel is taken from each sample (see DACC_TAGGED()),
+	 * so one stream can interleave both channels.
+	 */
+	uint32_t tag_mode;
 } dacc_settings_t;
 
 /**
@@ -133,7 +200,7 @@ void dacc_disable_channel(uint32_t channel);
 uint32_t dacc_channel_enabled(uint32_t channel);
 
 /**
- * Select DACC channel.
+ * Select DACC channel. Not used in tag mode.
  * @param channel Channel (DACC_CHANNEL_0 or DACC_CHANNEl_1).
  * Nothing will happen if the specified channel is out of bounds.
  */
@@ -153,9 +220,88 @@ uint32_t dacc_tx_ready(void);
  * output data. If transfer mode is set to WORD, then bits 16-31 will also
  * be used.
  * The least significant bits are converted first in WORD transfer mode.
+ * In tag mode each half-word carries its channel (see DACC_TAGGED()).
  * @param value The value to convert.
  * @pre Call dacc_tx_ready() to check if a new value can be converted.
  */
 void dacc_write(uint32_t value);
 
+/**
+ * Interleaves two channels into one buffer of tagged samples for tag mode:
+ * out[2 * i] is channel 0 and out[2 * i + 1] is channel 1. With word
+ * transfer both channels are then updated by one transfer.
+ * @param ch0 The samples of channel 0.
+ * @param ch1 The samples of channel 1.
+ * @param out The tagged samples, 2 * n of them.
+ * @param n The number of samples per channel.
+ */
+void dacc_interleave(const uint16_t *ch0, const uint16_t *ch1, uint16_t *out,
+		uint32_t n);
+
+/**
+ * Configures the timer behind a hardware trigger to start a conversion at
+ * the requested rate, see adc_set_sample_rate() which works in the same way.
+ * The trigger must also be selected in dacc_settings_t when calling
+ * dacc_init().
+ * @param trigger DACC_TRIGGER_TIOA0-2 or DACC_TRIGGER_PWM_EVENT0-1.
+ * @param hz Requested sample rate in Hz (at most 1 MHz in max speed mode).
+ * @return The actual sample rate in Hz, or 0 if the trigger has no timer or
+ * the rate cannot be reached.
+ */
+uint32_t dacc_set_sample_rate(uint32_t trigger, uint32_t hz);
+
+/**
+ * Called from the DACC interrupt when a half of the stream buffer has been
+ * sent. The half is sent again after the other half, so new samples can be
+ * written to it now.
+ * @param samples The sent half of the buffer.
+ * @param count The number of samples in it.
+ */
+typedef void (*dacc_stream_callback_t)(uint16_t *samples, uint32_t count);
+
+/**
+ * Starts streaming a circular buffer of samples to the selected channel,
+ * sent by the PDC as two halves (ping-pong). In word transfer mode two
+ * samples are moved per transfer, so the buffer must be word-aligned and
+ * half_samples even. The conversions should be hardware triggered (see
+ * dacc_set_sample_rate()), otherwise the samples go out as fast as the DACC
+ * can convert them.
+ * @param buffer The buffer, 2 * half_samples samples.
+ * @param half_samples The number of samples in each half.
+ * @param callback Called when a half has been sent, or 0.
+ * @return 1 on success, 0 if the parameters are invalid.
+ */
+uint8_t dacc_stream_start(uint16_t *buffer, uint32_t half_samples,
+		dacc_stream_callback_t callback);
+
+/**
+ * Stops streaming. The last sample stays on the output.
+ */
+void dacc_stream_stop(void);
+
+/**
+ * The number of halves sent since dacc_stream_start().
+ * @return The number of halves.
+ */
+uint32_t dacc_stream_halves(void);
+
+/**
+ * Replaces the half of the stream buffer that the PDC sends after the
+ * current one. Called from the stream callback, this sends new samples
+ * instead of the half that was just sent, which can then be reused. Called
+ * right after dacc_stream_start(), the two halves can be separate buffers.
+ * @param buffer half_samples samples, word-aligned in word transfer mode.
+ * @return The half that was replaced.
+ */
+uint16_t *dacc_stream_swap(uint16_t *buffer);
+
+#if DACC_COOS
+/**
+ * Sets a CoOS event flag (isr_SetFlag()) when a half of the stream buffer
+ * has been sent.
+ * @param flag The event flag, or DACC_NO_FLAG.
+ */
+void dacc_stream_set_flag(uint8_t flag);
+#endif
+
 #endif
@@ -0,0 +1,107 @@
+/**
+ * @file dacc_dds.h
+ * @brief DACC - Wavetable synthesis with a phase accumulator (DDS)
+ * @details Generates periodic waveforms from a wavetable in flash, e.g.
+ * dacc_dds_sine or dacc_dds_triangle, by direct digital synthesis: a 32-bit
+ * phase accumulator adds a phase increment for every sample and the top
+ * bits of the phase index the table. The frequency resolution is
+ * sample_rate / 2^32.
+ *
+ * dacc_dds_start() streams the waveform with the DACC PDC (see
+ * dacc_stream_start()) and refills each half of the buffer from the DACC
+ * interrupt when it has been sent, so no task has to feed the DAC. The
+ * frequency is changed by replacing the phase increment only, so the phase
+ * is continuous and the output has no glitch.
+ *
+ * @pre The DACC must be initialized with a hardware trigger and a channel
+ * enabled and selected; dacc_set_sample_rate() sets the sample rate.
+ * @date 14 October 2026
+ */
+
+#ifndef DACC_DDS_H_
+#define DACC_DDS_H_
+
+#include <inttypes.h>
+#include "dacc.h"
+
+// Number of samples in the built-in wavetables, as log2
+#define DACC_DDS_TABLE_LOG2		(8)
+
+/**
+ * One period of a sine, 256 samples of 12 bits.
+ */
+extern const uint16_t dacc_dds_sine[1u << DACC_DDS_TABLE_LOG2];
+
+/**
+ * One period of a triangle, 256 samples of 12 bits.
+ */
+extern const uint16_t dacc_dds_triangle[1u << DACC_DDS_TABLE_LOG2];
+
+/**
+ * State of a DDS generator, see dacc_dds_init().
+ */
+typedef struct {
+	const uint16_t *table;
+	uint32_t table_log2;
+	uint32_t sample_rate;
+	uint32_t phase;
+	volatile uint32_t increment;
+} dacc_dds_t;
+
+/**
+ * Calculates the phase increment for a frequency.
+ * @param frequency The frequency of the waveform in Hz.
+ * @param sample_rate The sample rate in Hz.
+ * @return The phase increment, frequency * 2^32 / sample_rate, or 0 if the
+ * frequency is not below half the sample rate.
+ */
+uint32_t dacc_dds_increment(uint32_t frequency, uint32_t sample_rate);
+
+/**
+ * Initializes a DDS generator.
+ * @param dds The generator.
+ * @param table One period of the waveform, 2^table_log2 samples of 12 bits.
+ * @param table_log2 log2 of the number of samples in the table (1-16).
+ * @param sample_rate The sample rate of the DACC in Hz.
+ * @param frequency The frequency of the waveform in Hz.
+ * @return 1 on success, 0 if the parameters are invalid.
+ */
+uint8_t dacc_dds_init(dacc_dds_t *dds, const uint16_t *table,
+		uint32_t table_log2, uint32_t sample_rate, uint32_t frequency);
+
+/**
+ * Changes the frequency, without a phase jump. Can be called while the
+ * generator is streaming.
+ * @param dds The generator.
+ * @param frequency The frequency of the waveform in Hz.
+ * @return 1 on success, 0 if the frequency is not below half the sample
+ * rate.
+ */
+uint8_t dacc_dds_set_frequency(dacc_dds_t *dds, uint32_t frequency);
+
+/**
+ * Generates the next samples.
+ * @param dds The generator.
+ * @param out The samples.
+ * @param n The number of samples.
+ */
+void dacc_dds_fill(dacc_dds_t *dds, uint16_t *out, uint32_t n);
+
+/**
+ * Fills both halves of a buffer and starts streaming the generator.
+ * @param dds The generator.
+ * @param buffer The buffer, 2 * half_samples samples, word-aligned in word
+ * transfer mode.
+ * @param half_samples The number of samples in each half, even in word
+ * transfer mode.
+ * @return 1 on success, 0 if the parameters are invalid.
+ */
+uint8_t dacc_dds_start(dacc_dds_t *dds, uint16_t *buffer,
+		uint32_t half_samples);
+
+/**
+ * Stops streaming the generator.
+ */
+void dacc_dds_stop(void);
+
+#endif
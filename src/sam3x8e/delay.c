@@ -6,14 +6,112 @@
  */
 
 #include "delay.h"
+#if DELAY_COOS
+#include "rtos/coocox.h"
+#endif
+
+// Longest pause counted in one go, well below the 2^31 cycle limit
+#define DELAY_CHUNK_US		(10000u)
+
+static uint32_t cycles_per_us = DELAY_CPU_HZ / 1000000;
+// CPU cycles per nanosecond in 0.32 fixed point
+static uint32_t cycles_per_ns_q32 = (uint32_t)
+		(((uint64_t) DELAY_CPU_HZ << 32) / 1000000000);
+// delay_set_cpu_clock() follows the clock profile of the PMC once added
+static uint8_t clock_notifier_added;
+
+#if DELAY_COOS
+// System ticks per microsecond in 0.32 fixed point, rounded up; the error is
+// far below the tick that sleep_micros() leaves out anyway
+#define TICKS_PER_US_Q32	\
+		((((uint64_t) CFG_SYSTICK_FREQ << 32) + 999999) / 1000000)
+#endif
+
+void delay_set_cpu_clock(uint32_t cpu_hz){
+	cycles_per_us = cpu_hz / 1000000;
+	cycles_per_ns_q32 = (uint32_t)
+			(((uint64_t) cpu_hz << 32) / 1000000000);
+}
+
+void delay_init(void){
+	if (!clock_notifier_added) {
+		clock_notifier_added = pmc_add_clock_notifier(delay_set_cpu_clock);
+	}
+	DELAY_DEMCR |= DELAY_DEMCR_TRCENA;
+	DELAY_DWT_CTRL |= DELAY_DWT_CTRL_CYCCNTENA;
+}
+
+void delay_ns(uint32_t ns){
+	// one multiply instead of a division, rounded up
+	delay_cycles((uint32_t) (((uint64_t) ns * cycles_per_ns_q32 +
+			0xFFFFFFFFu) >> 32));
+}
+
+#if DELAY_COOS
+/*
+ * Whether the caller is a task that may sleep: CoOS runs, the scheduler is
+ * not locked and no exception is active (IPSR is 0).
+ */
+static uint8_t can_sleep(void){
+	uint32_t ipsr;
+#if PERIPH_HOST
+	ipsr = 0;
+#else
+	__asm volatile ("mrs %0, ipsr" : "=r" (ipsr));
+#endif
+	return TCBRunning != NULL && OSSchedLock == 0 && OSIntNesting == 0 &&
+			ipsr == 0;
+}
+
+/*
+ * Sleeps for the whole ticks of a pause and spins for the rest. The current
+ * tick may already be partly over, so one tick less is slept and the cycle
+ * counter decides when the pause is over.
+ */
+static void sleep_micros(uint32_t us){
+	uint32_t start, ticks;
+
+	delay_init();
+	while (us > 0){
+		uint32_t chunk = (us > 1000000) ? 1000000 : us;
+		start = DELAY_DWT_CYCCNT;
+		ticks = (uint32_t) (((uint64_t) chunk * TICKS_PER_US_Q32) >> 32);
+		if (ticks > 1){
+			CoTickDelay(ticks - 1);
+		}
+		while ((DELAY_DWT_CYCCNT - start) < chunk * cycles_per_us)
+			;
+		us -= chunk;
+	}
+}
+#endif
 
 void delay_micros(uint32_t us){
-	uint32_t i;
-	for(i = 0; i < us; i++){
-		wait();
+#if DELAY_COOS
+	if (us >= DELAY_YIELD_MIN_US && can_sleep()){
+		sleep_micros(us);
+		return;
+	}
+#endif
+	while (us > DELAY_CHUNK_US){
+		delay_cycles(DELAY_CHUNK_US * cycles_per_us);
+		us -= DELAY_CHUNK_US;
 	}
+	delay_cycles(us * cycles_per_us);
 }
 
 void delay_ms(uint32_t ms){
-	delay_micros(ms * 1000);
+#if DELAY_COOS
+	if (ms > (DELAY_YIELD_MIN_US - 1) / 1000 && can_sleep()){
+		while (ms > 1000){
+			sleep_micros(1000000);
+			ms -= 1000;
+		}
+		sleep_micros(ms * 1000);
+		return;
+	}
+#endif
+	while (ms--){
+		delay_cycles(1000 * cycles_per_us);
+	}
 }
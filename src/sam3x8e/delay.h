@@ -1,11 +1,21 @@
 /**
  * @file delay.h
  * @brief Delay - Software delay
- * @details The delays are not accurate enough for real time applications,
- * however the delays are accurate enough for most applications.
+ * @details The delays count CPU cycles with the DWT cycle counter (CYCCNT)
+ * of the Cortex-M3, so they do not depend on the compiler flags or the flash
+ * wait states. They are accurate to a few cycles plus the time spent in
+ * interrupts, and never shorter than requested. The counter is started by
+ * the first delay.
  *
- * The longer the delay, the more accurate. Below 10 us, the deviation
- * fluctuates from +2us to -2us. The shortest delay that is 2 us.
+ * The CPU clock is DELAY_CPU_HZ until delay_set_cpu_clock() is called with
+ * another clock. The first delay adds delay_set_cpu_clock() to the clock
+ * notifiers of the PMC, so the delays follow pmc_set_clock_profile().
+ *
+ * When they are called from a task while CoOS is running and the scheduler
+ * is not locked, delay_ms() and delay_micros() pauses of at least
+ * DELAY_YIELD_MIN_US sleep with CoTickDelay() for the whole ticks and only
+ * spin for the rest, so lower priority tasks can run. Called from an
+ * interrupt or before CoStartOS() they always spin.
  *
  * @pre Initialize the board
  *
@@ -18,8 +28,80 @@
 #define DELAY_H_
 
 #include <inttypes.h>
+#include "pmc.h"
+
+/*
+ * Set to 0 to build without the CoOS support, e.g. when the RTOS is not
+ * linked into the application.
+ */
+#ifndef DELAY_COOS
+#define DELAY_COOS		(1)
+#endif
+
+#if DELAY_COOS
+#include "rtos/OsConfig.h"
+#endif
 extern void wait(void);
 
+/**
+ * The CPU clock the delays assume by default.
+ */
+#ifndef DELAY_CPU_HZ
+#define DELAY_CPU_HZ	(SYS_CLK_FREQ)
+#endif
+
+#if DELAY_COOS
+/**
+ * The shortest pause that sleeps instead of spinning, two ticks by default.
+ */
+#ifndef DELAY_YIELD_MIN_US
+#define DELAY_YIELD_MIN_US	(2000000u / CFG_SYSTICK_FREQ)
+#endif
+#endif
+
+///@cond
+#define DELAY_DEMCR				(*((volatile uint32_t *) PERIPH_ADDR(0xE000EDFCU)))
+#define DELAY_DEMCR_TRCENA		(0x1u << 24)
+#define DELAY_DWT_CTRL			(*((volatile uint32_t *) PERIPH_ADDR(0xE0001000U)))
+#define DELAY_DWT_CTRL_CYCCNTENA	(0x1u << 0)
+#define DELAY_DWT_CYCCNT		(*((volatile uint32_t *) PERIPH_ADDR(0xE0001004U)))
+///@endcond
+
+/**
+ * Sets the CPU clock the delays are counted in, after the clock has been
+ * changed.
+ * @param cpu_hz The CPU clock in Hz.
+ */
+void delay_set_cpu_clock(uint32_t cpu_hz);
+
+/**
+ * Starts the cycle counter, if it is not running yet, and adds
+ * delay_set_cpu_clock() to the clock notifiers of the PMC.
+ */
+void delay_init(void);
+
+/**
+ * The function makes a pause of a number of CPU cycles. It is inline, so
+ * short pauses do not pay for a call.
+ * @param cycles The length of the pause in CPU cycles, up to 2^31.
+ */
+static inline void delay_cycles(uint32_t cycles) {
+	uint32_t start = DELAY_DWT_CYCCNT;
+	if (!(DELAY_DWT_CTRL & DELAY_DWT_CTRL_CYCCNTENA)) {
+		delay_init();
+		start = DELAY_DWT_CYCCNT;
+	}
+	while ((DELAY_DWT_CYCCNT - start) < cycles)
+		;
+}
+
+/**
+ * The function makes a pause in the system, e.g. for bus timing.
+ * @param ns The length of the pause in nanoseconds, rounded up to whole CPU
+ * cycles (12 ns at 84 MHz).
+ */
+void delay_ns(uint32_t ns);
+
 /**
  * The function makes a pause in the system.
  * @param us The length of the pause in microseconds. Range from 1 microsecond
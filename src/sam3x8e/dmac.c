@@ -0,0 +1,267 @@
+/*
+ * dmac.c
+ *
+ * Date:	14 October 2026
+ */
+
+#include "dmac.h"
+#include "bitband.h"
+#include "ramfunc.h"
+#include "pmc.h"
+#include "irq.h"
+
+///@cond
+// NVIC Interrupt Set-Enable Register 1 (peripheral ID 32-63)
+#define NVIC_ISER1		(*((volatile uint32_t *) PERIPH_ADDR(0xE000E104U)))
+// NVIC Interrupt Clear-Enable Register 1 (peripheral ID 32-63)
+#define NVIC_ICER1		(*((volatile uint32_t *) PERIPH_ADDR(0xE000E184U)))
+// the BTSIZE field is 16 bits, but the DMAC can only do up to 4095
+#define DMAC_MAX_COUNT	(4095u)
+// FC field of DMAC_CTRLB
+#define DMAC_CTRLB_FC_OF(ctrlb)	(((ctrlb) >> 21) & 0x3u)
+///@endcond
+
+static dmac_callback_t callbacks[DMAC_CHANNELS];
+static void *callback_args[DMAC_CHANNELS];
+// channels taken with dmac_channel_alloc() or dmac_channel_claim()
+static volatile uint32_t taken;
+// the callback of the channel is called for each buffer of its chain
+static uint8_t chain_each[DMAC_CHANNELS];
+static volatile uint32_t buffers_done[DMAC_CHANNELS];
+// data items of the transfer started last with dmac_start()
+static uint32_t counts[DMAC_CHANNELS];
+
+void dmac_init(void) {
+	if (pmc_acquire_peripheral_clock(ID_DMAC) > 1) {
+		return;
+	}
+	// round robin between the channels
+	DMAC->DMAC_GCFG = (1u << 4);
+	DMAC->DMAC_EN = 1u;
+	NVIC_ISER1 = (1u << (ID_DMAC - 32));
+}
+
+void dmac_deinit(void) {
+	if (pmc_peripheral_clock_users(ID_DMAC) == 1) {
+		NVIC_ICER1 = (1u << (ID_DMAC - 32));
+		DMAC->DMAC_EN = 0;
+	}
+	pmc_release_peripheral_clock(ID_DMAC);
+}
+
+uint8_t dmac_channel_alloc(uint32_t *channel) {
+	uint32_t primask = irq_save();
+	uint32_t ch;
+
+	for (ch = 0; ch < DMAC_CHANNELS; ch++) {
+		if (!(taken & (1u << ch))) {
+			taken |= (1u << ch);
+			irq_restore(primask);
+			*channel = ch;
+			return 1;
+		}
+	}
+	irq_restore(primask);
+	return 0;
+}
+
+uint8_t dmac_channel_claim(uint32_t channel) {
+	uint32_t primask;
+
+	if (channel >= DMAC_CHANNELS) {
+		return 0;
+	}
+	primask = irq_save();
+	if (taken & (1u << channel)) {
+		irq_restore(primask);
+		return 0;
+	}
+	taken |= (1u << channel);
+	irq_restore(primask);
+	return 1;
+}
+
+void dmac_channel_free(uint32_t channel) {
+	if (channel >= DMAC_CHANNELS) {
+		return;
+	}
+	// one store, an allocation in an interrupt can not lose its bit
+	bitband_clear(&taken, channel);
+}
+
+/*
+ * DMAC_CTRLA and DMAC_CTRLB of a transfer, with the descriptor fetches
+ * disabled. Returns 0 for an invalid transfer.
+ */
+static uint8_t transfer_ctrl(const dmac_transfer_t *transfer, uint32_t *ctrla,
+		uint32_t *ctrlb) {
+	if (transfer->count == 0 || transfer->count > DMAC_MAX_COUNT ||
+		transfer->width > DMAC_WIDTH_WORD || transfer->flow > DMAC_PER2MEM) {
+		return 0;
+	}
+	*ctrla = DMAC_CTRLA_BTSIZE(transfer->count) |
+			DMAC_CTRLA_SRC_WIDTH(transfer->width) |
+			DMAC_CTRLA_DST_WIDTH(transfer->width);
+	*ctrlb = DMAC_CTRLB_SRC_DSCR_MASK | DMAC_CTRLB_DST_DSCR_MASK |
+			DMAC_CTRLB_FC(transfer->flow);
+	if (!transfer->src_incr) {
+		*ctrlb |= DMAC_CTRLB_SRC_INCR_FIXED;
+	}
+	if (!transfer->dst_incr) {
+		*ctrlb |= DMAC_CTRLB_DST_INCR_FIXED;
+	}
+	return 1;
+}
+
+/*
+ * DMAC_CFG of a transfer, without the stop on done.
+ */
+static uint32_t transfer_cfg(uint32_t flow, uint8_t per) {
+	uint32_t cfg = DMAC_CFG_AHB_PROT(1) | DMAC_CFG_FIFOCFG_ASAP;
+
+	if (flow == DMAC_MEM2PER) {
+		cfg |= DMAC_CFG_DST_PER(per) | DMAC_CFG_DST_H2SEL_MASK;
+	} else if (flow == DMAC_PER2MEM) {
+		cfg |= DMAC_CFG_SRC_PER(per) | DMAC_CFG_SRC_H2SEL_MASK;
+	}
+	return cfg;
+}
+
+uint8_t dmac_start(uint32_t channel, const dmac_transfer_t *transfer,
+		dmac_callback_t callback, void *arg) {
+	dmac_channel_reg_t *ch;
+	uint32_t ctrla, ctrlb;
+
+	if (channel >= DMAC_CHANNELS || dmac_busy(channel) ||
+		!transfer_ctrl(transfer, &ctrla, &ctrlb)) {
+		return 0;
+	}
+	ch = &DMAC->DMAC_CH[channel];
+	callbacks[channel] = callback;
+	callback_args[channel] = arg;
+	chain_each[channel] = 0;
+	counts[channel] = transfer->count;
+
+	// clear old status of the channel
+	(void) PERIPH_REG(DMAC->DMAC_EBCISR);
+
+	ch->DMAC_SADDR = (uint32_t) transfer->src;
+	ch->DMAC_DADDR = (uint32_t) transfer->dst;
+	ch->DMAC_DSCR = 0;
+	ch->DMAC_CTRLA = ctrla;
+	ch->DMAC_CTRLB = ctrlb;
+	ch->DMAC_CFG = transfer_cfg(transfer->flow, transfer->per) |
+			DMAC_CFG_SOD_MASK;
+
+	// buffer transfer completed interrupt of the channel
+	DMAC->DMAC_EBCIDR = DMAC_EBCI_ALL(channel);
+	if (callback) {
+		DMAC->DMAC_EBCIER = DMAC_EBCI_BTC(channel);
+	}
+	DMAC->DMAC_CHER = (1u << channel);
+	return 1;
+}
+
+uint8_t dmac_desc_set(dmac_desc_t *desc, const dmac_transfer_t *transfer,
+		const dmac_desc_t *next) {
+	uint32_t ctrla, ctrlb;
+
+	if (!transfer_ctrl(transfer, &ctrla, &ctrlb)) {
+		return 0;
+	}
+	desc->saddr = (uint32_t) transfer->src;
+	desc->daddr = (uint32_t) transfer->dst;
+	desc->ctrla = ctrla;
+	// the source and destination of each buffer come from its descriptor
+	desc->ctrlb = ctrlb &
+			~(DMAC_CTRLB_SRC_DSCR_MASK | DMAC_CTRLB_DST_DSCR_MASK);
+	desc->dscr = (uint32_t) next;
+	return 1;
+}
+
+uint8_t dmac_start_chain(uint32_t channel, const dmac_desc_t *first,
+		uint8_t per, uint8_t notify, dmac_callback_t callback, void *arg) {
+	dmac_channel_reg_t *ch;
+
+	if (channel >= DMAC_CHANNELS || first == 0 || dmac_busy(channel) ||
+		((uint32_t) first & 0x3u)) {
+		return 0;
+	}
+	ch = &DMAC->DMAC_CH[channel];
+	callbacks[channel] = callback;
+	callback_args[channel] = arg;
+	chain_each[channel] = (notify == DMAC_CHAIN_EACH);
+	buffers_done[channel] = 0;
+
+	// clear old status of the channel
+	(void) PERIPH_REG(DMAC->DMAC_EBCISR);
+
+	// the first descriptor is loaded when the channel is enabled
+	ch->DMAC_DSCR = (uint32_t) first;
+	ch->DMAC_CTRLB = first->ctrlb;
+	ch->DMAC_CFG = transfer_cfg(DMAC_CTRLB_FC_OF(first->ctrlb), per);
+
+	DMAC->DMAC_EBCIDR = DMAC_EBCI_ALL(channel);
+	if (chain_each[channel]) {
+		DMAC->DMAC_EBCIER = DMAC_EBCI_ALL(channel);
+	} else if (callback) {
+		DMAC->DMAC_EBCIER = DMAC_EBCI_CBTC(channel) | DMAC_EBCI_ERR(channel);
+	}
+	DMAC->DMAC_CHER = (1u << channel);
+	return 1;
+}
+
+uint32_t dmac_buffers_done(uint32_t channel) {
+	return buffers_done[channel];
+}
+
+uint32_t dmac_busy(uint32_t channel) {
+	return (DMAC->DMAC_CHSR & (1u << channel)) != 0;
+}
+
+void dmac_abort(uint32_t channel) {
+	DMAC->DMAC_EBCIDR = DMAC_EBCI_ALL(channel);
+	DMAC->DMAC_CHDR = (1u << channel);
+	while (dmac_busy(channel));
+}
+
+uint32_t dmac_stop(uint32_t channel) {
+	uint32_t count;
+
+	DMAC->DMAC_EBCIDR = DMAC_EBCI_ALL(channel);
+	if (!dmac_busy(channel)) {
+		return counts[channel];
+	}
+	// no more source transfers, the FIFO is written out
+	DMAC->DMAC_CHER = DMAC_CHER_SUSP(channel);
+	while (!(PERIPH_REG(DMAC->DMAC_CHSR) & DMAC_CHSR_EMPT(channel)));
+	// BTSIZE reads the transfers done on the source
+	count = DMAC->DMAC_CH[channel].DMAC_CTRLA & DMAC_CTRLA_BTSIZE(0xFFFFu);
+	DMAC->DMAC_CHDR = (1u << channel);
+	while (dmac_busy(channel));
+	DMAC->DMAC_CHDR = DMAC_CHDR_RES(channel);
+	return count;
+}
+
+RAMFUNC_HOT void DMAC_Handler(void) {
+	// reading the status clears it, so it is only read once
+	uint32_t status = DMAC->DMAC_EBCISR & DMAC->DMAC_EBCIMR;
+	uint32_t channel;
+
+	for (channel = 0; channel < DMAC_CHANNELS; channel++) {
+		if (!(status & DMAC_EBCI_ALL(channel))) {
+			continue;
+		}
+		if (chain_each[channel]) {
+			buffers_done[channel]++;
+		}
+		// a single transfer, the end of a chain or an error is the last call
+		if (!chain_each[channel] || (status & (DMAC_EBCI_CBTC(channel) |
+				DMAC_EBCI_ERR(channel)))) {
+			DMAC->DMAC_EBCIDR = DMAC_EBCI_ALL(channel);
+		}
+		if (callbacks[channel]) {
+			callbacks[channel](channel, callback_args[channel]);
+		}
+	}
+}
@@ -0,0 +1,306 @@
+/**
+ * @file dmac.h
+ * @brief DMAC - DMA Controller
+ * @details A small API for single block transfers with the six channels of
+ * the DMA Controller. On the SAM3X8E the SPI, SSC and HSMCI have no PDC
+ * channels and use the DMAC instead.
+ *
+ * A transfer is started with dmac_start() on a channel and either polled
+ * with dmac_busy() or completed with a callback, which is called from
+ * DMAC_Handler. The channels are taken with dmac_channel_alloc(), or with
+ * dmac_channel_claim() by the drivers that use fixed channels (the SPI), so
+ * the drivers don't use the same channel.
+ *
+ * Scatter-gather transfers are chains of descriptors, set up with
+ * dmac_desc_set() and started with dmac_start_chain(). The DMAC loads the
+ * descriptors itself and moves on to the next buffer without the CPU. A
+ * chain whose last descriptor points back to the first runs until
+ * dmac_abort(), with DMAC_CHAIN_EACH it gives ping-pong buffering:
+ * @code
+ *	dmac_desc_set(&desc[0], &half0, &desc[1]);
+ *	dmac_desc_set(&desc[1], &half1, &desc[0]);
+ *	dmac_start_chain(channel, &desc[0], DMAC_PER_USART1_RX, DMAC_CHAIN_EACH,
+ *			half_done, 0);
+ * @endcode
+ * and the callback finds the buffer done with dmac_buffers_done().
+ *
+ * The peripherals with a PDC channel use pdc.h instead.
+ *
+ * @pre dmac_init() enables the peripheral clock and the controller.
+ * @date 14 October 2026
+ */
+
+#ifndef DMAC_H_
+#define DMAC_H_
+
+#include <inttypes.h>
+#include "periph.h"
+
+/// Number of DMAC channels.
+#define DMAC_CHANNELS			(6)
+
+///@cond
+/// Base address of the DMAC.
+#define DMAC					((dmac_reg_t *) PERIPH_ADDR(0x400C4000u))
+
+/*
+ * Registers of one channel.
+ */
+typedef struct dmac_channel_reg {
+	uint32_t DMAC_SADDR;	///< 0x00, Source Address Register
+	uint32_t DMAC_DADDR;	///< 0x04, Destination Address Register
+	uint32_t DMAC_DSCR;		///< 0x08, Descriptor Address Register
+	uint32_t DMAC_CTRLA;	///< 0x0C, Control A Register
+	uint32_t DMAC_CTRLB;	///< 0x10, Control B Register
+	uint32_t DMAC_CFG;		///< 0x14, Configuration Register
+	uint32_t reserved[4];	///< 0x18-0x24, Reserved
+} dmac_channel_reg_t;
+
+/*
+ * DMAC register mapping
+ */
+typedef struct dmac_reg {
+	uint32_t DMAC_GCFG;		///< 0x00, Global Configuration Register
+	uint32_t DMAC_EN;		///< 0x04, Enable Register
+	uint32_t DMAC_SREQ;		///< 0x08, Software Single Request Register
+	uint32_t DMAC_CREQ;		///< 0x0C, Software Chunk Transfer Request Register
+	uint32_t DMAC_LAST;		///< 0x10, Software Last Transfer Flag Register
+	uint32_t reserved0;		///< 0x14, Reserved
+	uint32_t DMAC_EBCIER;	///< 0x18, Buffer/Chained/Error Interrupt Enable
+	uint32_t DMAC_EBCIDR;	///< 0x1C, Buffer/Chained/Error Interrupt Disable
+	uint32_t DMAC_EBCIMR;	///< 0x20, Buffer/Chained/Error Interrupt Mask
+	uint32_t DMAC_EBCISR;	///< 0x24, Buffer/Chained/Error Status
+	uint32_t DMAC_CHER;		///< 0x28, Channel Handler Enable Register
+	uint32_t DMAC_CHDR;		///< 0x2C, Channel Handler Disable Register
+	uint32_t DMAC_CHSR;		///< 0x30, Channel Handler Status Register
+	uint32_t reserved1[2];	///< 0x34-0x38, Reserved
+	dmac_channel_reg_t DMAC_CH[DMAC_CHANNELS];	///< 0x3C, Channels
+	uint32_t reserved2[46];	///< 0x12C-0x1E0, Reserved
+	uint32_t DMAC_WPMR;		///< 0x1E4, Write Protect Mode Register
+	uint32_t DMAC_WPSR;		///< 0x1E8, Write Protect Status Register
+} dmac_reg_t;
+
+///@{
+/**
+ * Fields of DMAC_CTRLA, DMAC_CTRLB and DMAC_CFG
+ */
+#define DMAC_CTRLA_BTSIZE(n)		((0xFFFFu & (n)) << 0)
+#define DMAC_CTRLA_SRC_WIDTH(w)		((0x3u & (w)) << 24)
+#define DMAC_CTRLA_DST_WIDTH(w)		((0x3u & (w)) << 28)
+#define DMAC_CTRLB_SRC_DSCR_MASK	(1u << 16)
+#define DMAC_CTRLB_DST_DSCR_MASK	(1u << 20)
+#define DMAC_CTRLB_FC(fc)			((0x3u & (fc)) << 21)
+#define DMAC_CTRLB_SRC_INCR_FIXED	(2u << 24)
+#define DMAC_CTRLB_DST_INCR_FIXED	(2u << 28)
+#define DMAC_CFG_SRC_PER(p)			((0xFu & (p)) << 0)
+#define DMAC_CFG_DST_PER(p)			((0xFu & (p)) << 4)
+#define DMAC_CFG_SRC_H2SEL_MASK		(1u << 9)
+#define DMAC_CFG_DST_H2SEL_MASK		(1u << 13)
+#define DMAC_CFG_SOD_MASK			(1u << 16)
+#define DMAC_CFG_AHB_PROT(p)		((0x7u & (p)) << 24)
+#define DMAC_CFG_FIFOCFG_ASAP		(2u << 28)
+///@}
+
+///@{
+/**
+ * Bits of a channel in DMAC_EBCIER, DMAC_EBCIDR and DMAC_EBCISR
+ */
+#define DMAC_EBCI_BTC(ch)			(1u << (ch))
+#define DMAC_EBCI_CBTC(ch)			(1u << (8 + (ch)))
+#define DMAC_EBCI_ERR(ch)			(1u << (16 + (ch)))
+#define DMAC_EBCI_ALL(ch)			(DMAC_EBCI_BTC(ch) | DMAC_EBCI_CBTC(ch) | \
+									DMAC_EBCI_ERR(ch))
+///@}
+
+///@{
+/**
+ * Bits of a channel in DMAC_CHER, DMAC_CHDR and DMAC_CHSR
+ */
+#define DMAC_CHER_SUSP(ch)			(1u << (8 + (ch)))
+#define DMAC_CHDR_RES(ch)			(1u << (8 + (ch)))
+#define DMAC_CHSR_EMPT(ch)			(1u << (16 + (ch)))
+///@}
+///@endcond
+
+///@{
+/**
+ * Size of one data item.
+ */
+#define DMAC_WIDTH_BYTE			(0)
+#define DMAC_WIDTH_HALFWORD		(1)
+#define DMAC_WIDTH_WORD			(2)
+///@}
+///@{
+/**
+ * Direction (flow control) of a transfer.
+ */
+#define DMAC_MEM2MEM			(0)
+#define DMAC_MEM2PER			(1)
+#define DMAC_PER2MEM			(2)
+///@}
+///@{
+/**
+ * Hardware handshaking interfaces of the peripherals.
+ */
+#define DMAC_PER_HSMCI			(0)
+#define DMAC_PER_SPI0_TX		(1)
+#define DMAC_PER_SPI0_RX		(2)
+#define DMAC_PER_SSC_TX			(3)
+#define DMAC_PER_SSC_RX			(4)
+#define DMAC_PER_SPI1_TX		(5)
+#define DMAC_PER_SPI1_RX		(6)
+#define DMAC_PER_USART0_TX		(11)
+#define DMAC_PER_USART0_RX		(12)
+#define DMAC_PER_USART1_TX		(13)
+#define DMAC_PER_USART1_RX		(14)
+#define DMAC_PER_PWM_TX			(15)
+///@}
+
+/**
+ * Description of a single block transfer.
+ */
+typedef struct dmac_transfer {
+	/** Source address. */
+	const volatile void *src;
+	/** Destination address. */
+	volatile void *dst;
+	/** Number of data items (1-4095). */
+	uint32_t count;
+	/** DMAC_WIDTH_BYTE, DMAC_WIDTH_HALFWORD or DMAC_WIDTH_WORD. */
+	uint8_t width;
+	/** DMAC_MEM2MEM, DMAC_MEM2PER or DMAC_PER2MEM. */
+	uint8_t flow;
+	/** 1 to increment the source address, 0 to keep it fixed. */
+	uint8_t src_incr;
+	/** 1 to increment the destination address, 0 to keep it fixed. */
+	uint8_t dst_incr;
+	/** Handshaking interface of the peripheral (prefix DMAC_PER_). */
+	uint8_t per;
+} dmac_transfer_t;
+
+///@{
+/**
+ * When the callback of a chain is called.
+ */
+#define DMAC_CHAIN_END			(0)	///< When the last descriptor is done
+#define DMAC_CHAIN_EACH			(1)	///< When each descriptor is done
+///@}
+
+/**
+ * Descriptor of one buffer of a chain, in the layout the DMAC loads it.
+ * It must stay in SRAM and word aligned until the chain is done.
+ */
+typedef struct dmac_desc {
+	uint32_t saddr;		///< Source address
+	uint32_t daddr;		///< Destination address
+	uint32_t ctrla;		///< DMAC_CTRLA of the buffer
+	uint32_t ctrlb;		///< DMAC_CTRLB of the buffer
+	uint32_t dscr;		///< Next descriptor, 0 for the last one
+} dmac_desc_t;
+
+/**
+ * Called from DMAC_Handler when the transfer of a channel is done.
+ * @param channel The channel.
+ * @param arg The argument given to dmac_start().
+ */
+typedef void (*dmac_callback_t)(uint32_t channel, void *arg);
+
+/**
+ * Acquires the clock of the DMAC in the PMC and enables the controller for
+ * the first user. Each driver that uses the DMAC calls it once.
+ */
+void dmac_init(void);
+
+/**
+ * Releases the DMAC for one user of dmac_init(), the controller and its
+ * clock are disabled when the last user releases it.
+ * @pre Transfers of the user are done or aborted.
+ */
+void dmac_deinit(void);
+
+/**
+ * Takes a free channel.
+ * @param channel Set to the channel taken.
+ * @return error (1 = SUCCESS, 0 = FAIL, all channels are taken)
+ */
+uint8_t dmac_channel_alloc(uint32_t *channel);
+
+/**
+ * Takes a given channel.
+ * @param channel The channel (0-5).
+ * @return error (1 = SUCCESS, 0 = FAIL, the channel is taken or invalid)
+ */
+uint8_t dmac_channel_claim(uint32_t channel);
+
+/**
+ * Gives a channel back.
+ * @param channel The channel (0-5).
+ * @pre The transfers of the channel are done or aborted.
+ */
+void dmac_channel_free(uint32_t channel);
+
+/**
+ * Starts a single block transfer.
+ * @param channel The channel (0-5).
+ * @param transfer The transfer.
+ * @param callback Called when done, 0 to poll with dmac_busy() instead.
+ * @param arg Argument passed to the callback.
+ * @return error (1 = SUCCESS, 0 = FAIL, channel busy or invalid parameter)
+ */
+uint8_t dmac_start(uint32_t channel, const dmac_transfer_t *transfer,
+		dmac_callback_t callback, void *arg);
+
+/**
+ * Sets up one descriptor of a chain. All the descriptors of a chain move
+ * data in the same direction (flow) with the same peripheral.
+ * @param desc The descriptor.
+ * @param transfer The buffer of the descriptor.
+ * @param next The next descriptor, 0 for the last one.
+ * @return error (1 = SUCCESS, 0 = FAIL, invalid parameter)
+ */
+uint8_t dmac_desc_set(dmac_desc_t *desc, const dmac_transfer_t *transfer,
+		const dmac_desc_t *next);
+
+/**
+ * Starts a chain of descriptors.
+ * @param channel The channel (0-5).
+ * @param first The first descriptor of the chain.
+ * @param per Handshaking interface of the peripheral (prefix DMAC_PER_),
+ * not used for memory to memory.
+ * @param notify DMAC_CHAIN_END or DMAC_CHAIN_EACH.
+ * @param callback Called when done, 0 to poll with dmac_busy() instead.
+ * @param arg Argument passed to the callback.
+ * @return error (1 = SUCCESS, 0 = FAIL, channel busy or invalid parameter)
+ */
+uint8_t dmac_start_chain(uint32_t channel, const dmac_desc_t *first,
+		uint8_t per, uint8_t notify, dmac_callback_t callback, void *arg);
+
+/**
+ * @param channel The channel (0-5).
+ * @return Number of buffers done since the chain was started with
+ * DMAC_CHAIN_EACH, modulo 2^32.
+ */
+uint32_t dmac_buffers_done(uint32_t channel);
+
+/**
+ * @param channel The channel (0-5).
+ * @return 1 if a transfer is in progress on the channel, otherwise 0.
+ */
+uint32_t dmac_busy(uint32_t channel);
+
+/**
+ * Stops the transfer of a channel.
+ * @param channel The channel (0-5).
+ */
+void dmac_abort(uint32_t channel);
+
+/**
+ * Stops a single block transfer of a channel after the data in its FIFO
+ * has been written, e.g. a receive from a peripheral that ended early.
+ * @param channel The channel (0-5).
+ * @return Number of data items written to the destination of the transfer
+ * started last with dmac_start().
+ */
+uint32_t dmac_stop(uint32_t channel);
+
+#endif /* DMAC_H_ */
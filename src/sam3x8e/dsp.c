@@ -0,0 +1,572 @@
+/*
+ * dsp.c
+ *
+ * Date:	14 October 2026
+ */
+
+#include "dsp.h"
+
+/*
+ * sin(2 pi i / 1024) in Q15 for a quarter of the circle, i = 0-256. The
+ * other quarters and the cosine are read from it by symmetry.
+ */
+static const q15_t sin_table[DSP_FFT_MAX_POINTS / 4 + 1] = {
+	0, 201, 402, 603, 804, 1005, 1206, 1407,
+	1608, 1809, 2009, 2210, 2410, 2611, 2811, 3012,
+	3212, 3412, 3612, 3811, 4011, 4210, 4410, 4609,
+	4808, 5007, 5205, 5404, 5602, 5800, 5998, 6195,
+	6393, 6590, 6786, 6983, 7179, 7375, 7571, 7767,
+	7962, 8157, 8351, 8545, 8739, 8933, 9126, 9319,
+	9512, 9704, 9896, 10087, 10278, 10469, 10659, 10849,
+	11039, 11228, 11417, 11605, 11793, 11980, 12167, 12353,
+	12539, 12725, 12910, 13094, 13279, 13462, 13645, 13828,
+	14010, 14191, 14372, 14553, 14732, 14912, 15090, 15269,
+	15446, 15623, 15800, 15976, 16151, 16325, 16499, 16673,
+	16846, 17018, 17189, 17360, 17530, 17700, 17869, 18037,
+	18204, 18371, 18537, 18703, 18868, 19032, 19195, 19357,
+	19519, 19680, 19841, 20000, 20159, 20317, 20475, 20631,
+	20787, 20942, 21096, 21250, 21403, 21554, 21705, 21856,
+	22005, 22154, 22301, 22448, 22594, 22739, 22884, 23027,
+	23170, 23311, 23452, 23592, 23731, 23870, 24007, 24143,
+	24279, 24413, 24547, 24680, 24811, 24942, 25072, 25201,
+	25329, 25456, 25582, 25708, 25832, 25955, 26077, 26198,
+	26319, 26438, 26556, 26674, 26790, 26905, 27019, 27133,
+	27245, 27356, 27466, 27575, 27683, 27790, 27896, 28001,
+	28105, 28208, 28310, 28411, 28510, 28609, 28706, 28803,
+	28898, 28992, 29085, 29177, 29268, 29358, 29447, 29534,
+	29621, 29706, 29791, 29874, 29956, 30037, 30117, 30195,
+	30273, 30349, 30424, 30498, 30571, 30643, 30714, 30783,
+	30852, 30919, 30985, 31050, 31113, 31176, 31237, 31297,
+	31356, 31414, 31470, 31526, 31580, 31633, 31685, 31736,
+	31785, 31833, 31880, 31926, 31971, 32014, 32057, 32098,
+	32137, 32176, 32213, 32250, 32285, 32318, 32351, 32382,
+	32412, 32441, 32469, 32495, 32521, 32545, 32567, 32589,
+	32609, 32628, 32646, 32663, 32678, 32692, 32705, 32717,
+	32728, 32737, 32745, 32752, 32757, 32761, 32765, 32766,
+	32767
+};
+
+#if PERIPH_HOST
+// No SSAT on the host
+static inline int32_t sat_q15(int32_t x) {
+	return (x > 0x7FFF) ? 0x7FFF : (x < -0x8000) ? -0x8000 : x;
+}
+#else
+static inline int32_t sat_q15(int32_t x) {
+	int32_t r;
+	__asm ("ssat %0, #16, %1" : "=r" (r) : "r" (x));
+	return r;
+}
+#endif
+
+static inline q31_t sat_q31(int64_t x) {
+	return (x > 0x7FFFFFFFLL) ? 0x7FFFFFFF :
+			(x < -0x80000000LL) ? (q31_t) 0x80000000u : (q31_t) x;
+}
+
+/*
+ * Integer square root, rounded down.
+ */
+static uint32_t isqrt64(uint64_t x) {
+	uint64_t root = 0;
+	uint64_t bit = 1ull << 62;
+
+	while (bit > x) {
+		bit >>= 2;
+	}
+	while (bit != 0) {
+		if (x >= root + bit) {
+			x -= root + bit;
+			root = (root >> 1) + bit;
+		} else {
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+	return (uint32_t) root;
+}
+
+uint8_t dsp_fir_q15_init(dsp_fir_q15_t *fir, const q15_t *coeffs,
+		uint32_t taps, q15_t *state, uint32_t block_max) {
+	uint32_t i;
+
+	if (fir == 0 || coeffs == 0 || taps == 0 || state == 0 || block_max == 0) {
+		return 0;
+	}
+	fir->coeffs = coeffs;
+	fir->state = state;
+	fir->taps = taps;
+	fir->block_max = block_max;
+	for (i = 0; i < taps - 1; i++) {
+		state[i] = 0;
+	}
+	return 1;
+}
+
+void dsp_fir_q15(dsp_fir_q15_t *fir, const q15_t *in, q15_t *out, uint32_t n) {
+	const uint32_t taps = fir->taps;
+	q15_t *state = fir->state;
+	// the new samples follow the last taps - 1 samples of the history
+	q15_t *x = state + taps - 1;
+	const q15_t *cp, *xp;
+	int64_t acc0, acc1;
+	int32_t c, x0, x1;
+	uint32_t i, k;
+
+	for (i = 0; i < n; i++) {
+		x[i] = in[i];
+	}
+	x = state;
+	// two outputs per pass, each sample is loaded once for both
+	for (i = 0; i + 1 < n; i += 2) {
+		cp = fir->coeffs + taps - 1;
+		xp = x + i;
+		acc0 = 0;
+		acc1 = 0;
+		x0 = *xp++;
+		k = taps;
+		while (k >= 2) {
+			c = *cp--;
+			x1 = *xp++;
+			acc0 += (int64_t) c * x0;
+			acc1 += (int64_t) c * x1;
+			c = *cp--;
+			x0 = *xp++;
+			acc0 += (int64_t) c * x1;
+			acc1 += (int64_t) c * x0;
+			k -= 2;
+		}
+		if (k) {
+			c = *cp;
+			x1 = *xp;
+			acc0 += (int64_t) c * x0;
+			acc1 += (int64_t) c * x1;
+		}
+		out[i] = (q15_t) sat_q15((int32_t) (acc0 >> 15));
+		out[i + 1] = (q15_t) sat_q15((int32_t) (acc1 >> 15));
+	}
+	if (i < n) {
+		cp = fir->coeffs + taps - 1;
+		xp = x + i;
+		acc0 = 0;
+		for (k = 0; k < taps; k++) {
+			acc0 += (int64_t) *cp-- * *xp++;
+		}
+		out[i] = (q15_t) sat_q15((int32_t) (acc0 >> 15));
+	}
+	// the last taps - 1 samples are the history of the next block
+	for (i = 0; i < taps - 1; i++) {
+		state[i] = state[n + i];
+	}
+}
+
+uint8_t dsp_fir_q31_init(dsp_fir_q31_t *fir, const q31_t *coeffs,
+		uint32_t taps, q31_t *state, uint32_t block_max) {
+	uint32_t i;
+
+	if (fir == 0 || coeffs == 0 || taps == 0 || state == 0 || block_max == 0) {
+		return 0;
+	}
+	fir->coeffs = coeffs;
+	fir->state = state;
+	fir->taps = taps;
+	fir->block_max = block_max;
+	for (i = 0; i < taps - 1; i++) {
+		state[i] = 0;
+	}
+	return 1;
+}
+
+void dsp_fir_q31(dsp_fir_q31_t *fir, const q31_t *in, q31_t *out, uint32_t n) {
+	const uint32_t taps = fir->taps;
+	q31_t *state = fir->state;
+	q31_t *x = state + taps - 1;
+	const q31_t *cp, *xp;
+	int64_t acc0, acc1;
+	q31_t c, x0, x1;
+	uint32_t i, k;
+
+	for (i = 0; i < n; i++) {
+		x[i] = in[i];
+	}
+	x = state;
+	for (i = 0; i + 1 < n; i += 2) {
+		cp = fir->coeffs + taps - 1;
+		xp = x + i;
+		acc0 = 0;
+		acc1 = 0;
+		x0 = *xp++;
+		k = taps;
+		while (k >= 2) {
+			c = *cp--;
+			x1 = *xp++;
+			acc0 += (int64_t) c * x0;
+			acc1 += (int64_t) c * x1;
+			c = *cp--;
+			x0 = *xp++;
+			acc0 += (int64_t) c * x1;
+			acc1 += (int64_t) c * x0;
+			k -= 2;
+		}
+		if (k) {
+			c = *cp;
+			x1 = *xp;
+			acc0 += (int64_t) c * x0;
+			acc1 += (int64_t) c * x1;
+		}
+		out[i] = sat_q31(acc0 >> 31);
+		out[i + 1] = sat_q31(acc1 >> 31);
+	}
+	if (i < n) {
+		cp = fir->coeffs + taps - 1;
+		xp = x + i;
+		acc0 = 0;
+		for (k = 0; k < taps; k++) {
+			acc0 += (int64_t) *cp-- * *xp++;
+		}
+		out[i] = sat_q31(acc0 >> 31);
+	}
+	for (i = 0; i < taps - 1; i++) {
+		state[i] = state[n + i];
+	}
+}
+
+uint8_t dsp_biquad_q15_init(dsp_biquad_q15_t *bq, uint32_t stages,
+		const q15_t *coeffs, q15_t *state, uint32_t shift) {
+	uint32_t i;
+
+	if (bq == 0 || stages == 0 || coeffs == 0 || state == 0 ||
+		shift > DSP_BIQUAD_MAX_SHIFT) {
+		return 0;
+	}
+	bq->coeffs = coeffs;
+	bq->state = state;
+	bq->stages = stages;
+	bq->shift = shift;
+	for (i = 0; i < 4 * stages; i++) {
+		state[i] = 0;
+	}
+	return 1;
+}
+
+void dsp_biquad_q15(dsp_biquad_q15_t *bq, const q15_t *in, q15_t *out,
+		uint32_t n) {
+	const uint32_t shift = 15 - bq->shift;
+	const q15_t *coeffs = bq->coeffs;
+	q15_t *state = bq->state;
+	uint32_t stage, i;
+
+	for (stage = 0; stage < bq->stages; stage++) {
+		// the coefficients and the history stay in registers for the block
+		const int32_t b0 = coeffs[0], b1 = coeffs[1], b2 = coeffs[2];
+		const int32_t a1 = coeffs[3], a2 = coeffs[4];
+		int32_t x1 = state[0], x2 = state[1];
+		int32_t y1 = state[2], y2 = state[3];
+		int32_t x0, y0;
+		int64_t acc;
+
+		for (i = 0; i < n; i++) {
+			x0 = in[i];
+			acc = (int64_t) b0 * x0;
+			acc += (int64_t) b1 * x1;
+			acc += (int64_t) b2 * x2;
+			acc += (int64_t) a1 * y1;
+			acc += (int64_t) a2 * y2;
+			y0 = sat_q15((int32_t) (acc >> shift));
+			x2 = x1;
+			x1 = x0;
+			y2 = y1;
+			y1 = y0;
+			out[i] = (q15_t) y0;
+		}
+		state[0] = (q15_t) x1;
+		state[1] = (q15_t) x2;
+		state[2] = (q15_t) y1;
+		state[3] = (q15_t) y2;
+		// the next stage filters the output of this one
+		in = out;
+		coeffs += 5;
+		state += 4;
+	}
+}
+
+uint8_t dsp_biquad_q31_init(dsp_biquad_q31_t *bq, uint32_t stages,
+		const q31_t *coeffs, q31_t *state, uint32_t shift) {
+	uint32_t i;
+
+	if (bq == 0 || stages == 0 || coeffs == 0 || state == 0 ||
+		shift > DSP_BIQUAD_MAX_SHIFT) {
+		return 0;
+	}
+	bq->coeffs = coeffs;
+	bq->state = state;
+	bq->stages = stages;
+	bq->shift = shift;
+	for (i = 0; i < 4 * stages; i++) {
+		state[i] = 0;
+	}
+	return 1;
+}
+
+void dsp_biquad_q31(dsp_biquad_q31_t *bq, const q31_t *in, q31_t *out,
+		uint32_t n) {
+	const uint32_t shift = 31 - bq->shift;
+	const q31_t *coeffs = bq->coeffs;
+	q31_t *state = bq->state;
+	uint32_t stage, i;
+
+	for (stage = 0; stage < bq->stages; stage++) {
+		const q31_t b0 = coeffs[0], b1 = coeffs[1], b2 = coeffs[2];
+		const q31_t a1 = coeffs[3], a2 = coeffs[4];
+		q31_t x1 = state[0], x2 = state[1];
+		q31_t y1 = state[2], y2 = state[3];
+		q31_t x0, y0;
+		int64_t acc;
+
+		for (i = 0; i < n; i++) {
+			x0 = in[i];
+			acc = (int64_t) b0 * x0;
+			acc += (int64_t) b1 * x1;
+			acc += (int64_t) b2 * x2;
+			acc += (int64_t) a1 * y1;
+			acc += (int64_t) a2 * y2;
+			y0 = sat_q31(acc >> shift);
+			x2 = x1;
+			x1 = x0;
+			y2 = y1;
+			y1 = y0;
+			out[i] = y0;
+		}
+		state[0] = x1;
+		state[1] = x2;
+		state[2] = y1;
+		state[3] = y2;
+		in = out;
+		coeffs += 5;
+		state += 4;
+	}
+}
+
+/*
+ * cos and sin of 2 pi t / 1024 for t = 0-767, the angles of the twiddles of
+ * a radix-4 stage.
+ */
+static void twiddle(uint32_t t, int32_t *c, int32_t *s) {
+	uint32_t r = t & 0xFFu;
+
+	switch (t >> 8) {
+	case 0:
+		*s = sin_table[r];
+		*c = sin_table[256 - r];
+		break;
+	case 1:
+		*s = sin_table[256 - r];
+		*c = -sin_table[r];
+		break;
+	default:
+		*s = -sin_table[r];
+		*c = -sin_table[256 - r];
+		break;
+	}
+}
+
+/*
+ * Puts the output of the decimation in frequency, in base-4 digit reversed
+ * order, back in natural order.
+ */
+static void digit_reverse(q15_t *data, uint32_t n, uint32_t digits) {
+	uint32_t i, j, k, rev;
+	q15_t re, im;
+
+	for (i = 1; i < n - 1; i++) {
+		rev = 0;
+		j = i;
+		for (k = 0; k < digits; k++) {
+			rev = (rev << 2) | (j & 0x3u);
+			j >>= 2;
+		}
+		if (i < rev) {
+			re = data[2 * i];
+			im = data[2 * i + 1];
+			data[2 * i] = data[2 * rev];
+			data[2 * i + 1] = data[2 * rev + 1];
+			data[2 * rev] = re;
+			data[2 * rev + 1] = im;
+		}
+	}
+}
+
+uint8_t dsp_fft_q15(q15_t *data, uint32_t n, uint32_t inverse) {
+	uint32_t len, quarter, step, j, base, digits = 0;
+	int32_t c1, s1, c2, s2, c3, s3;
+	int32_t xr0, xi0, xr1, xi1, xr2, xi2, xr3, xi3;
+	int32_t ar, ai, br, bi, cr, ci, dr, di;
+	q15_t *p;
+
+	for (len = n; len > 1; len >>= 2) {
+		if (len & 0x3u) {
+			break;
+		}
+		digits++;
+	}
+	if (data == 0 || len != 1 || n > DSP_FFT_MAX_POINTS || n < 4) {
+		return 0;
+	}
+	for (len = n; len >= 4; len >>= 2) {
+		quarter = len >> 2;
+		step = DSP_FFT_MAX_POINTS / len;
+		// the twiddles of j are shared by all groups of the stage
+		for (j = 0; j < quarter; j++) {
+			twiddle(j * step, &c1, &s1);
+			twiddle(2 * j * step, &c2, &s2);
+			twiddle(3 * j * step, &c3, &s3);
+			if (inverse) {
+				s1 = -s1;
+				s2 = -s2;
+				s3 = -s3;
+			}
+			for (base = j; base < n; base += len) {
+				p = data + 2 * base;
+				// scaled by 1/4, the sums of four values fit
+				xr0 = p[0] >> 2;
+				xi0 = p[1] >> 2;
+				xr1 = p[2 * quarter] >> 2;
+				xi1 = p[2 * quarter + 1] >> 2;
+				xr2 = p[4 * quarter] >> 2;
+				xi2 = p[4 * quarter + 1] >> 2;
+				xr3 = p[6 * quarter] >> 2;
+				xi3 = p[6 * quarter + 1] >> 2;
+				ar = xr0 + xr2;
+				ai = xi0 + xi2;
+				br = xr0 - xr2;
+				bi = xi0 - xi2;
+				cr = xr1 + xr3;
+				ci = xi1 + xi3;
+				dr = xr1 - xr3;
+				di = xi1 - xi3;
+				if (inverse) {
+					dr = -dr;
+					di = -di;
+				}
+				p[0] = (q15_t) (ar + cr);
+				p[1] = (q15_t) (ai + ci);
+				// (b - jd), (a - c) and (b + jd) times w^j, w^2j and w^3j,
+				// w = cos - j sin, a rotation can reach sqrt(2)
+				ar -= cr;
+				ai -= ci;
+				cr = br + di;
+				ci = bi - dr;
+				br -= di;
+				bi += dr;
+				p[2 * quarter] = (q15_t) sat_q15((cr * c1 + ci * s1) >> 15);
+				p[2 * quarter + 1] = (q15_t) sat_q15((ci * c1 - cr * s1) >> 15);
+				p[4 * quarter] = (q15_t) sat_q15((ar * c2 + ai * s2) >> 15);
+				p[4 * quarter + 1] = (q15_t) sat_q15((ai * c2 - ar * s2) >> 15);
+				p[6 * quarter] = (q15_t) sat_q15((br * c3 + bi * s3) >> 15);
+				p[6 * quarter + 1] = (q15_t) sat_q15((bi * c3 - br * s3) >> 15);
+			}
+		}
+	}
+	digit_reverse(data, n, digits);
+	return 1;
+}
+
+void dsp_cmplx_mag_squared_q15(const q15_t *in, q31_t *out, uint32_t n) {
+	uint32_t sum;
+	int32_t re, im;
+
+	while (n--) {
+		re = in[0];
+		im = in[1];
+		in += 2;
+		// at most 2^31 in Q30
+		sum = (uint32_t) (re * re) + (uint32_t) (im * im);
+		*out++ = (sum >= 0x40000000u) ? 0x7FFFFFFF : (q31_t) (sum << 1);
+	}
+}
+
+q15_t dsp_rms_q15(const q15_t *in, uint32_t n) {
+	uint64_t sum = 0;
+	uint32_t k = n, root;
+	int32_t x0, x1, x2, x3;
+
+	// unrolled by four, the squares are Q30
+	while (k >= 4) {
+		x0 = in[0];
+		x1 = in[1];
+		x2 = in[2];
+		x3 = in[3];
+		sum += (int64_t) x0 * x0;
+		sum += (int64_t) x1 * x1;
+		sum += (int64_t) x2 * x2;
+		sum += (int64_t) x3 * x3;
+		in += 4;
+		k -= 4;
+	}
+	while (k--) {
+		x0 = *in++;
+		sum += (int64_t) x0 * x0;
+	}
+	root = isqrt64(sum / n);
+	return (q15_t) ((root > 0x7FFFu) ? 0x7FFFu : root);
+}
+
+q31_t dsp_rms_q31(const q31_t *in, uint32_t n) {
+	uint64_t sum = 0;
+	uint32_t k = n, root;
+	q31_t x0, x1;
+
+	// the squares are Q62, their high words Q30
+	while (k >= 2) {
+		x0 = in[0];
+		x1 = in[1];
+		sum += (uint64_t) (((int64_t) x0 * x0) >> 32);
+		sum += (uint64_t) (((int64_t) x1 * x1) >> 32);
+		in += 2;
+		k -= 2;
+	}
+	if (k) {
+		x0 = *in;
+		sum += (uint64_t) (((int64_t) x0 * x0) >> 32);
+	}
+	root = isqrt64((sum / n) << 32);
+	return (q31_t) ((root > 0x7FFFFFFFu) ? 0x7FFFFFFFu : root);
+}
+
+q15_t dsp_peak_q15(const q15_t *in, uint32_t n, uint32_t *index) {
+	int32_t peak = -1, x;
+	uint32_t i, at = 0;
+
+	for (i = 0; i < n; i++) {
+		x = in[i];
+		if (x < 0) {
+			x = -x;
+		}
+		if (x > peak) {
+			peak = x;
+			at = i;
+		}
+	}
+	if (index) {
+		*index = at;
+	}
+	return (q15_t) sat_q15(peak);
+}
+
+q31_t dsp_peak_q31(const q31_t *in, uint32_t n, uint32_t *index) {
+	uint32_t peak = 0, x;
+	uint32_t i, at = 0;
+
+	for (i = 0; i < n; i++) {
+		// the magnitude of -1.0 is 2^31 as unsigned
+		x = (in[i] < 0) ? 0u - (uint32_t) in[i] : (uint32_t) in[i];
+		if (x > peak) {
+			peak = x;
+			at = i;
+		}
+	}
+	if (index) {
+		*index = at;
+	}
+	return (q31_t) ((peak > 0x7FFFFFFFu) ? 0x7FFFFFFFu : peak);
+}
@@ -0,0 +1,240 @@
+/**
+ * @file dsp.h
+ * @brief DSP - Fixed-point signal processing kernels
+ * @details Block processing kernels in Q15 and Q31 fixed point for the
+ * Cortex-M3, which has neither an FPU nor the DSP extension: FIR filters,
+ * cascades of biquad IIR filters, a radix-4 complex FFT and the RMS and
+ * peak of a block. The products are accumulated in 64 bits, which the
+ * compiler does with SMULL and SMLAL, and the results are saturated with
+ * SSAT. The loops are unrolled, the FIR filters compute two outputs per
+ * pass so each sample is loaded once for both.
+ *
+ * The halves of an ADC stream are converted in place to Q15 with
+ * adc_to_q15() (see adc_filter.h) and then filtered where they are:
+ * @code
+ *	static void half_full(uint16_t *samples, uint32_t count) {
+ *		q15_t *q = (q15_t *) samples;
+ *
+ *		adc_to_q15(samples, count, q);
+ *		dsp_fir_q15(&fir, q, q, count);
+ *		level = dsp_rms_q15(q, count);
+ *	}
+ * @endcode
+ *
+ * @pre The filters are given a state buffer by the caller, no memory is
+ * allocated.
+ * @date 14 October 2026
+ */
+
+#ifndef DSP_H_
+#define DSP_H_
+
+#include <inttypes.h>
+
+/**
+ * Fixed point value with 15 fractional bits.
+ */
+typedef int16_t q15_t;
+
+/**
+ * Fixed point value with 31 fractional bits.
+ */
+typedef int32_t q31_t;
+
+/// Most points of dsp_fft_q15(), the resolution of its twiddle table
+#define DSP_FFT_MAX_POINTS		(1024u)
+
+/// Most stages of shift between the biquad coefficients and Q15/Q31
+#define DSP_BIQUAD_MAX_SHIFT	(7u)
+
+/**
+ * State of a Q15 FIR filter, see dsp_fir_q15_init().
+ */
+typedef struct {
+	const q15_t *coeffs;
+	q15_t *state;
+	uint32_t taps;
+	uint32_t block_max;
+} dsp_fir_q15_t;
+
+/**
+ * State of a Q31 FIR filter, see dsp_fir_q31_init().
+ */
+typedef struct {
+	const q31_t *coeffs;
+	q31_t *state;
+	uint32_t taps;
+	uint32_t block_max;
+} dsp_fir_q31_t;
+
+/**
+ * State of a cascade of Q15 biquads, see dsp_biquad_q15_init().
+ */
+typedef struct {
+	const q15_t *coeffs;
+	q15_t *state;
+	uint32_t stages;
+	uint32_t shift;
+} dsp_biquad_q15_t;
+
+/**
+ * State of a cascade of Q31 biquads, see dsp_biquad_q31_init().
+ */
+typedef struct {
+	const q31_t *coeffs;
+	q31_t *state;
+	uint32_t stages;
+	uint32_t shift;
+} dsp_biquad_q31_t;
+
+/**
+ * Initializes a Q15 FIR filter, y[n] = sum of coeffs[k] * x[n - k]. The
+ * history is cleared. The products are summed in 64 bits, the sum can not
+ * overflow.
+ * @param fir The filter.
+ * @param coeffs The coefficients, taps of them, in time order.
+ * @param taps The number of coefficients (at least 1).
+ * @param state Room for taps - 1 + block_max values.
+ * @param block_max The most samples of one dsp_fir_q15() call.
+ * @return 1 on success, 0 if the parameters are invalid.
+ */
+uint8_t dsp_fir_q15_init(dsp_fir_q15_t *fir, const q15_t *coeffs,
+		uint32_t taps, q15_t *state, uint32_t block_max);
+
+/**
+ * Filters a block of samples. The history is kept between calls.
+ * @param fir The filter.
+ * @param in The samples.
+ * @param out The filtered samples, n of them. May be the same as in.
+ * @param n The number of samples, at most block_max.
+ */
+void dsp_fir_q15(dsp_fir_q15_t *fir, const q15_t *in, q15_t *out, uint32_t n);
+
+/**
+ * Initializes a Q31 FIR filter like dsp_fir_q15_init(). The products are
+ * summed in 64 bits with 62 fractional bits, so the magnitudes of the
+ * coefficients must add up to less than 2.
+ * @param fir The filter.
+ * @param coeffs The coefficients, taps of them, in time order.
+ * @param taps The number of coefficients (at least 1).
+ * @param state Room for taps - 1 + block_max values.
+ * @param block_max The most samples of one dsp_fir_q31() call.
+ * @return 1 on success, 0 if the parameters are invalid.
+ */
+uint8_t dsp_fir_q31_init(dsp_fir_q31_t *fir, const q31_t *coeffs,
+		uint32_t taps, q31_t *state, uint32_t block_max);
+
+/**
+ * Filters a block of samples. The history is kept between calls.
+ * @param fir The filter.
+ * @param in The samples.
+ * @param out The filtered samples, n of them. May be the same as in.
+ * @param n The number of samples, at most block_max.
+ */
+void dsp_fir_q31(dsp_fir_q31_t *fir, const q31_t *in, q31_t *out, uint32_t n);
+
+/**
+ * Initializes a cascade of biquads in direct form I. Each stage computes
+ * y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] + a1 y[n-1] + a2 y[n-2], the
+ * feedback coefficients are the negated ones of the usual transfer function
+ * 1 + a1 z^-1 + a2 z^-2. The coefficients are divided by 2^shift so that
+ * a1 near -2 fits, the sum is multiplied by 2^shift again. The history is
+ * cleared.
+ * @param bq The cascade.
+ * @param stages The number of stages (at least 1).
+ * @param coeffs The coefficients, {b0, b1, b2, a1, a2} for each stage.
+ * @param state Room for 4 * stages values.
+ * @param shift The scale of the coefficients (0-DSP_BIQUAD_MAX_SHIFT).
+ * @return 1 on success, 0 if the parameters are invalid.
+ */
+uint8_t dsp_biquad_q15_init(dsp_biquad_q15_t *bq, uint32_t stages,
+		const q15_t *coeffs, q15_t *state, uint32_t shift);
+
+/**
+ * Filters a block of samples through all stages, one stage after the other
+ * over the whole block. The history is kept between calls.
+ * @param bq The cascade.
+ * @param in The samples.
+ * @param out The filtered samples, n of them. May be the same as in.
+ * @param n The number of samples.
+ */
+void dsp_biquad_q15(dsp_biquad_q15_t *bq, const q15_t *in, q15_t *out,
+		uint32_t n);
+
+/**
+ * Initializes a cascade of Q31 biquads like dsp_biquad_q15_init().
+ * @param bq The cascade.
+ * @param stages The number of stages (at least 1).
+ * @param coeffs The coefficients, {b0, b1, b2, a1, a2} for each stage.
+ * @param state Room for 4 * stages values.
+ * @param shift The scale of the coefficients (0-DSP_BIQUAD_MAX_SHIFT).
+ * @return 1 on success, 0 if the parameters are invalid.
+ */
+uint8_t dsp_biquad_q31_init(dsp_biquad_q31_t *bq, uint32_t stages,
+		const q31_t *coeffs, q31_t *state, uint32_t shift);
+
+/**
+ * Filters a block of samples through all stages.
+ * @param bq The cascade.
+ * @param in The samples.
+ * @param out The filtered samples, n of them. May be the same as in.
+ * @param n The number of samples.
+ */
+void dsp_biquad_q31(dsp_biquad_q31_t *bq, const q31_t *in, q31_t *out,
+		uint32_t n);
+
+/**
+ * Complex FFT in place with radix-4 butterflies. The data is scaled by 1/4
+ * in each of the log4(n) stages, so it can not overflow and the result is
+ * the transform divided by n, in natural order. The inverse transform is
+ * divided by n as well.
+ * @param data n complex values, real and imaginary part interleaved.
+ * @param n The number of points: 4, 16, 64, 256 or 1024.
+ * @param inverse 1 for the inverse transform, 0 for the forward one.
+ * @return 1 on success, 0 if n is not a supported power of 4.
+ */
+uint8_t dsp_fft_q15(q15_t *data, uint32_t n, uint32_t inverse);
+
+/**
+ * Squared magnitudes of complex values, e.g. the power spectrum from
+ * dsp_fft_q15(). Squares of 1.0 and more are saturated.
+ * @param in n complex values, real and imaginary part interleaved.
+ * @param out The squared magnitudes in Q31, n of them.
+ * @param n The number of complex values.
+ */
+void dsp_cmplx_mag_squared_q15(const q15_t *in, q31_t *out, uint32_t n);
+
+/**
+ * @param in The samples.
+ * @param n The number of samples (at least 1).
+ * @return The root mean square of the samples.
+ */
+q15_t dsp_rms_q15(const q15_t *in, uint32_t n);
+
+/**
+ * @param in The samples.
+ * @param n The number of samples (at least 1).
+ * @return The root mean square of the samples. The squares are summed with
+ * 30 fractional bits, a block of at most 2^34 samples.
+ */
+q31_t dsp_rms_q31(const q31_t *in, uint32_t n);
+
+/**
+ * Finds the sample of the largest magnitude.
+ * @param in The samples.
+ * @param n The number of samples (at least 1).
+ * @param index The index of the first sample of that magnitude, or 0.
+ * @return The magnitude, -1.0 is saturated to the largest positive value.
+ */
+q15_t dsp_peak_q15(const q15_t *in, uint32_t n, uint32_t *index);
+
+/**
+ * Finds the sample of the largest magnitude, see dsp_peak_q15().
+ * @param in The samples.
+ * @param n The number of samples (at least 1).
+ * @param index The index of the first sample of that magnitude, or 0.
+ * @return The magnitude, -1.0 is saturated to the largest positive value.
+ */
+q31_t dsp_peak_q31(const q31_t *in, uint32_t n, uint32_t *index);
+
+#endif
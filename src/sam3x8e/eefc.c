@@ -7,7 +7,298 @@
  */
 
 #include "eefc.h"
+#include "ramfunc.h"
+#include "id.h"
+#include "irq.h"
+
+///@cond
+// NVIC Interrupt Set/Clear-Enable Registers 0 (peripheral ID 0-31)
+#define NVIC_ISER0		(*((volatile uint32_t *) PERIPH_ADDR(0xE000E100U)))
+#define NVIC_ICER0		(*((volatile uint32_t *) PERIPH_ADDR(0xE000E180U)))
+
+// Pages of a lock region
+#define PAGES_PER_REGION		(EEFC_LOCK_REGION_SIZE / EEFC_PAGE_SIZE)
+
+// Highest master clock frequency of each Flash Wait State, the datasheet
+// (AC characteristics of the embedded flash) gives them for VDDCORE 1.8 V
+static const uint32_t fws_max_freq[] = {
+	19000000u, 50000000u, 64000000u, 80000000u, 90000000u
+};
+#define FWS_MAX_FREQS	(sizeof(fws_max_freq) / sizeof(fws_max_freq[0]))
+
+/*
+ * Disable the interrupts for a command on a bank, unless the bank holds
+ * no code (EEFC1 with EEFC_BANK1_CODE 0): the interrupt handlers then keep
+ * running from bank 0 and SRAM while bank 1 is busy.
+ */
+static inline uint32_t irq_save_bank(eefc_reg_t *eefc) {
+	uint32_t primask;
+
+	if (!EEFC_BANK1_CODE && eefc == EEFC1) {
+#if PERIPH_HOST
+		primask = 0;
+#else
+		__asm volatile ("mrs %0, primask" : "=r" (primask));
+#endif
+		return primask;
+	}
+	return irq_save();
+}
+
+///@endcond
+
+// Request of eefc_write_page_req() and the FMR to restore at its end
+static io_req_t *volatile page_req;
+static uint32_t page_req_fmr;
 
 void eefc_set_flash_wait_state(eefc_reg_t *eefc, uint32_t fsw) {
 	eefc->EEFC_FMR = EEFC_FMR_SET_FWS(eefc->EEFC_FMR, fsw);
 }
+
+uint32_t eefc_wait_states(uint32_t mck) {
+	uint32_t fws;
+
+	for (fws = 0; fws < FWS_MAX_FREQS - 1; fws++) {
+		if (mck <= fws_max_freq[fws]) {
+			break;
+		}
+	}
+	return fws;
+}
+
+void eefc_set_wait_states_for_clock(uint32_t mck) {
+	uint32_t fws = eefc_wait_states(mck);
+
+	eefc_set_flash_wait_state(EEFC0, fws);
+	eefc_set_flash_wait_state(EEFC1, fws);
+}
+
+/*
+ * Run a flash command and wait for its end, from RAM. A program command
+ * needs more wait states, the ones set before are restored afterwards.
+ *
+ * ret The Flash Status Register at the end.
+ */
+RAMFUNC static uint32_t eefc_command(volatile eefc_reg_t *eefc, uint32_t cmd,
+		uint32_t page) {
+	uint32_t fmr = eefc->EEFC_FMR;
+	uint32_t status;
+
+	if (cmd == EEFC_FCMD_EWP || cmd == EEFC_FCMD_WP) {
+		eefc->EEFC_FMR = EEFC_FMR_SET_FWS(fmr, EEFC_FWS_PROGRAM);
+	}
+	eefc->EEFC_FCR = EEFC_FCR_FKEY | EEFC_FCR_FARG(page) | cmd;
+	do {
+		status = eefc->EEFC_FSR;
+	} while (!(status & EEFC_FSR_FRDY));
+	eefc->EEFC_FMR = fmr;
+	return status;
+}
+
+/*
+ * Read the unique identifier from RAM, the bank reads it instead of the
+ * flash between STUI and SPUI.
+ */
+RAMFUNC static void eefc_unique_id(volatile eefc_reg_t *eefc, uint32_t id[4]) {
+	volatile uint32_t *flash = (volatile uint32_t *) EEFC_FLASH_START;
+	uint32_t i;
+
+	eefc->EEFC_FCR = EEFC_FCR_FKEY | EEFC_FCMD_STUI;
+	while (eefc->EEFC_FSR & EEFC_FSR_FRDY);
+	for (i = 0; i < 4; i++) {
+		id[i] = flash[i];
+	}
+	eefc->EEFC_FCR = EEFC_FCR_FKEY | EEFC_FCMD_SPUI;
+	while (!(eefc->EEFC_FSR & EEFC_FSR_FRDY));
+}
+
+/*
+ * Get the EEFC and the page number of an address.
+ *
+ * ret The EEFC, 0 if the address is not in the flash.
+ */
+static eefc_reg_t *eefc_page_of(uint32_t addr, uint32_t *page) {
+	if (addr < EEFC_FLASH_START || addr >= EEFC_FLASH_START + 2 * EEFC_BANK_SIZE) {
+		return 0;
+	}
+	addr -= EEFC_FLASH_START;
+	*page = (addr % EEFC_BANK_SIZE) / EEFC_PAGE_SIZE;
+	return (addr < EEFC_BANK_SIZE) ? EEFC0 : EEFC1;
+}
+
+/*
+ * Fill the latch buffer of a page and erase and write it. The latch buffer
+ * is written through the address of the page, a word at a time.
+ */
+static uint8_t eefc_program_page(uint32_t addr, const uint32_t *data,
+		uint32_t fill) {
+	volatile uint32_t *latch = (volatile uint32_t *) addr;
+	eefc_reg_t *eefc;
+	uint32_t page;
+	uint32_t primask;
+	uint32_t status;
+	uint32_t i;
+
+	eefc = eefc_page_of(addr, &page);
+	if (eefc == 0 || addr % EEFC_PAGE_SIZE != 0) {
+		return 0;
+	}
+	primask = irq_save_bank(eefc);
+	for (i = 0; i < EEFC_PAGE_WORDS; i++) {
+		latch[i] = data ? data[i] : fill;
+	}
+	status = eefc_command(eefc, EEFC_FCMD_EWP, page);
+	irq_restore(primask);
+	return !(status & (EEFC_FSR_FCMDE | EEFC_FSR_FLOCKE));
+}
+
+uint8_t eefc_erase_page(uint32_t addr) {
+	return eefc_program_page(addr, 0, 0xFFFFFFFFu);
+}
+
+uint8_t eefc_write_page(uint32_t addr, const uint32_t *data) {
+	if (data == 0) {
+		return 0;
+	}
+	return eefc_program_page(addr, data, 0);
+}
+
+uint8_t eefc_write_page_req(uint32_t addr, const uint32_t *data,
+		io_req_t *req) {
+	volatile uint32_t *latch = (volatile uint32_t *) addr;
+	eefc_reg_t *eefc;
+	uint32_t page;
+	uint32_t i;
+
+	eefc = eefc_page_of(addr, &page);
+	if (EEFC_BANK1_CODE || eefc != EEFC1 || addr % EEFC_PAGE_SIZE != 0 ||
+		data == 0 || page_req || !io_req_start(req)) {
+		return 0;
+	}
+	page_req = req;
+	for (i = 0; i < EEFC_PAGE_WORDS; i++) {
+		latch[i] = data[i];
+	}
+	page_req_fmr = eefc->EEFC_FMR;
+	eefc->EEFC_FMR = EEFC_FMR_SET_FWS(page_req_fmr, EEFC_FWS_PROGRAM) |
+			EEFC_FMR_FRDY;
+	NVIC_ISER0 = (1u << ID_EEFC1);
+	eefc->EEFC_FCR = EEFC_FCR_FKEY | EEFC_FCR_FARG(page) | EEFC_FCMD_EWP;
+	return 1;
+}
+
+uint8_t eefc_write_page_busy(void) {
+	return page_req != 0;
+}
+
+void EFC1_Handler(void) {
+	// reading the status clears the error flags, so it is read once
+	uint32_t status = EEFC1->EEFC_FSR;
+	io_req_t *req = page_req;
+
+	if (!(status & EEFC_FSR_FRDY) || req == 0) {
+		return;
+	}
+	// FRDY stays set, so its interrupt is turned off with the wait states
+	EEFC1->EEFC_FMR = page_req_fmr;
+	NVIC_ICER0 = (1u << ID_EEFC1);
+	page_req = 0;
+	io_req_complete(req, !(status & (EEFC_FSR_FCMDE | EEFC_FSR_FLOCKE)));
+}
+
+/*
+ * The words of the latch buffer that are not written stay 0xFFFFFFFF, so
+ * Write Page leaves the rest of the page as it is.
+ */
+uint8_t eefc_write_words(uint32_t addr, const uint32_t *data, uint32_t words) {
+	volatile uint32_t *latch;
+	eefc_reg_t *eefc;
+	uint32_t page;
+	uint32_t primask;
+	uint32_t status;
+	uint32_t n;
+	uint32_t i;
+
+	if (addr % 4 != 0 || addr < EEFC_FLASH_START ||
+		words > (EEFC_FLASH_START + 2 * EEFC_BANK_SIZE - addr) / 4) {
+		return 0;
+	}
+	while (words > 0) {
+		eefc = eefc_page_of(addr, &page);
+		if (eefc == 0) {
+			return 0;
+		}
+		// The words up to the end of the page
+		n = (EEFC_PAGE_SIZE - addr % EEFC_PAGE_SIZE) / 4;
+		if (n > words) {
+			n = words;
+		}
+		latch = (volatile uint32_t *) addr;
+		primask = irq_save_bank(eefc);
+		for (i = 0; i < n; i++) {
+			latch[i] = data[i];
+		}
+		status = eefc_command(eefc, EEFC_FCMD_WP, page);
+		irq_restore(primask);
+		if (status & (EEFC_FSR_FCMDE | EEFC_FSR_FLOCKE)) {
+			return 0;
+		}
+		addr += 4 * n;
+		data += n;
+		words -= n;
+	}
+	return 1;
+}
+
+/*
+ * Run a lock bit command on the region of an address.
+ */
+static uint8_t eefc_lock_command(uint32_t addr, uint32_t cmd) {
+	eefc_reg_t *eefc;
+	uint32_t page;
+	uint32_t primask;
+	uint32_t status;
+
+	eefc = eefc_page_of(addr, &page);
+	if (eefc == 0) {
+		return 0;
+	}
+	primask = irq_save_bank(eefc);
+	status = eefc_command(eefc, cmd, page);
+	irq_restore(primask);
+	return !(status & EEFC_FSR_FCMDE);
+}
+
+uint8_t eefc_lock(uint32_t addr) {
+	return eefc_lock_command(addr, EEFC_FCMD_SLB);
+}
+
+uint8_t eefc_unlock(uint32_t addr) {
+	return eefc_lock_command(addr, EEFC_FCMD_CLB);
+}
+
+uint8_t eefc_is_locked(uint32_t addr) {
+	eefc_reg_t *eefc;
+	uint32_t page;
+	uint32_t primask;
+	uint32_t bits;
+
+	eefc = eefc_page_of(addr, &page);
+	if (eefc == 0) {
+		return 0;
+	}
+	primask = irq_save_bank(eefc);
+	eefc_command(eefc, EEFC_FCMD_GLB, 0);
+	// The 16 lock bits of the bank, one per region
+	bits = ((volatile eefc_reg_t *) eefc)->EEFC_FRR;
+	irq_restore(primask);
+	return (bits >> (page / PAGES_PER_REGION)) & 1u;
+}
+
+void eefc_read_unique_id(uint32_t id[4]) {
+	uint32_t primask;
+
+	primask = irq_save();
+	eefc_unique_id(EEFC0, id);
+	irq_restore(primask);
+}
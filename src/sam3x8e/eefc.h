@@ -1,9 +1,17 @@
 /**
  * @file eefc.h
  * @brief EEFC - Enhanced Embedded Flash Controller
- * @details This API is used to set the EEFC.
- * @details The API is very limited by the moment. Only functionality to
- * make a standard system initialization is implemented.
+ * @details This API is used to set the EEFC and to program the flash from
+ * the application (IAP). The flash is 512 KB in two banks, EEFC0 holds
+ * 0x80000-0xBFFFF and EEFC1 0xC0000-0xFFFFF, each of 1024 pages of 256 bytes.
+ * The lock bits cover regions of 16 KB.
+ * @details The flash commands run from RAM (section .ramfunc, copied at
+ * startup, see ramfunc.h) with interrupts disabled, as the bank being
+ * programmed can't be read meanwhile. A page write blocks for a few
+ * milliseconds, see eefc_buf.h to coalesce small writes into whole pages.
+ * @details When the application is linked to bank 0 only, define
+ * EEFC_BANK1_CODE to 0: the interrupts then stay enabled while bank 1 is
+ * programmed, and bank 1 can hold data or the next firmware image.
  * @post Initialize system clock
  *
  * @author Mathias Beckius
@@ -14,11 +22,32 @@
 #define EEFC_H_
 
 #include <inttypes.h>
+#include "periph.h"
+#include "io_req.h"
 
 /// @brief Pointer to registers EEFC0
-#define EEFC0 ((eefc_reg_t *) 0x400E0A00U)
+#define EEFC0 ((eefc_reg_t *) PERIPH_ADDR(0x400E0A00U))
 /// @brief Pointer to registers EEFC1
-#define EEFC1 ((eefc_reg_t *) 0x400E0C00U)
+#define EEFC1 ((eefc_reg_t *) PERIPH_ADDR(0x400E0C00U))
+
+/// @brief Start address of the flash
+#define EEFC_FLASH_START		(0x00080000u)
+/// @brief Size of a flash bank
+#define EEFC_BANK_SIZE			(0x00040000u)
+/// @brief Size of a page, the unit of programming
+#define EEFC_PAGE_SIZE			(256u)
+/// @brief Words of a page
+#define EEFC_PAGE_WORDS			(EEFC_PAGE_SIZE / 4u)
+/// @brief Size of a lock region
+#define EEFC_LOCK_REGION_SIZE	(0x4000u)
+
+/*
+ * Set to 0 when no code or constant data an interrupt handler reads is
+ * linked to bank 1.
+ */
+#ifndef EEFC_BANK1_CODE
+#define EEFC_BANK1_CODE			(1)
+#endif
 
 ///@cond
 
@@ -33,6 +62,32 @@
 #define EEFC_FMR_SET_FWS(reg, bits)	\
 	__SET_BIT_LEVELS(reg, bits, 0xFu, 8)
 
+// Flash Writing Protection Key
+#define EEFC_FCR_FKEY				(0x5Au << 24)
+// Flash Command Argument, a page number
+#define EEFC_FCR_FARG(page)			((page) << 8)
+// Flash Commands
+#define EEFC_FCMD_WP				(0x01u)	// Write Page
+#define EEFC_FCMD_EWP				(0x03u)	// Erase Page and Write Page
+#define EEFC_FCMD_SLB				(0x08u)	// Set Lock Bit
+#define EEFC_FCMD_CLB				(0x09u)	// Clear Lock Bit
+#define EEFC_FCMD_GLB				(0x0Au)	// Get Lock Bit
+#define EEFC_FCMD_STUI				(0x0Eu)	// Start Read Unique Identifier
+#define EEFC_FCMD_SPUI				(0x0Fu)	// Stop Read Unique Identifier
+
+// Flash Ready Status
+#define EEFC_FSR_FRDY				(1u)
+// Flash Command Error Status
+#define EEFC_FSR_FCMDE				(1u << 1)
+// Flash Lock Error Status
+#define EEFC_FSR_FLOCKE				(1u << 2)
+
+// Flash Ready Interrupt Enable of the Flash Mode Register
+#define EEFC_FMR_FRDY				(1u)
+
+// Flash Wait State required when programming
+#define EEFC_FWS_PROGRAM			(6u)
+
 /*
  * Mapping of EEFC registers
  */
@@ -58,4 +113,98 @@ typedef struct eefc_reg {
  */
 void eefc_set_flash_wait_state(eefc_reg_t *eefc, uint32_t fsw);
 
+/**
+ * Get the fewest Flash Wait States that can read the flash at a master
+ * clock frequency (SAM3X, VDDCORE 1.8 V).
+ * @param mck Master clock frequency in Hz
+ * @return Flash Wait State (FSW), 0 up to 19 MHz and 4 at 84 MHz.
+ */
+uint32_t eefc_wait_states(uint32_t mck);
+
+/**
+ * Set the fewest Flash Wait States of both banks for a master clock
+ * frequency. The PMC calls it when it changes the master clock, before
+ * speeding up and after slowing down.
+ * @param mck Master clock frequency in Hz
+ */
+void eefc_set_wait_states_for_clock(uint32_t mck);
+
+/**
+ * Erase a page, it reads 0xFF afterwards.
+ * @param addr Address of the page, a multiple of EEFC_PAGE_SIZE
+ * @return 1 on success, 0 if addr is not a page of the flash, the page is
+ * locked or the command failed.
+ */
+uint8_t eefc_erase_page(uint32_t addr);
+
+/**
+ * Erase a page and program it with new data.
+ * @param addr Address of the page, a multiple of EEFC_PAGE_SIZE
+ * @param data The EEFC_PAGE_WORDS words of the page, they may be in flash
+ * but not in the page itself.
+ * @return 1 on success, 0 if addr is not a page of the flash, the page is
+ * locked or the command failed.
+ */
+uint8_t eefc_write_page(uint32_t addr, const uint32_t *data);
+
+/**
+ * Start to erase a page of bank 1 and program it with new data, and return
+ * without waiting. The end of the command is the interrupt of EEFC1, which
+ * completes the request: its result is 1 on success, 0 if the page is
+ * locked or the command failed. Meanwhile the application runs from bank 0
+ * and SRAM, so it needs EEFC_BANK1_CODE 0, and the other functions must not
+ * be used on bank 1.
+ * @param addr Address of the page in bank 1, a multiple of EEFC_PAGE_SIZE
+ * @param data The EEFC_PAGE_WORDS words of the page, not in bank 1.
+ * @param req The request, set up with io_req_init().
+ * @return 1 if the command was started, 0 if EEFC_BANK1_CODE is 1, addr is
+ * not a page of bank 1, a page write is running or the request is busy.
+ */
+uint8_t eefc_write_page_req(uint32_t addr, const uint32_t *data,
+		io_req_t *req);
+
+/**
+ * @return 1 while a page write of eefc_write_page_req() is running.
+ */
+uint8_t eefc_write_page_busy(void);
+
+/**
+ * Program words of the flash without erasing, the bits can only go from 1
+ * to 0. Used to append to erased flash, the words may span pages.
+ * @param addr Address of the first word, a multiple of 4
+ * @param data The words
+ * @param words Number of words
+ * @return 1 on success, 0 if the words are not all in the flash, a page is
+ * locked or a command failed.
+ */
+uint8_t eefc_write_words(uint32_t addr, const uint32_t *data, uint32_t words);
+
+/**
+ * Lock the region of 16 KB holding an address against erase and write.
+ * The lock bits are kept in flash, they last over resets.
+ * @param addr Address in the region
+ * @return 1 on success, 0 if addr is not in the flash.
+ */
+uint8_t eefc_lock(uint32_t addr);
+
+/**
+ * Unlock the region of 16 KB holding an address.
+ * @param addr Address in the region
+ * @return 1 on success, 0 if addr is not in the flash.
+ */
+uint8_t eefc_unlock(uint32_t addr);
+
+/**
+ * Is the region holding an address locked?
+ * @param addr Address in the region
+ * @return 1 if it is locked, 0 if not, or if addr is not in the flash.
+ */
+uint8_t eefc_is_locked(uint32_t addr);
+
+/**
+ * Read the 128-bit unique identifier of the chip.
+ * @param id Receives the 4 words of the identifier
+ */
+void eefc_read_unique_id(uint32_t id[4]);
+
 #endif
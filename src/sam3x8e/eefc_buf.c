@@ -0,0 +1,99 @@
+/*
+ * eefc_buf.c
+ *
+ * Date:	14 October 2026
+ */
+
+#include "eefc_buf.h"
+
+///@cond
+
+// Address of the page holding an address
+#define PAGE_OF(addr)		((addr) & ~(EEFC_PAGE_SIZE - 1u))
+
+///@endcond
+
+void eefc_buf_init(eefc_buf_t *buf) {
+	buf->page = 0;
+	buf->dirty = 0;
+	buf->programs = 0;
+}
+
+uint8_t eefc_buf_flush(eefc_buf_t *buf) {
+	if (buf->page == 0 || !buf->dirty) {
+		return 1;
+	}
+	if (!eefc_write_page(buf->page, buf->data)) {
+		return 0;
+	}
+	buf->dirty = 0;
+	buf->programs++;
+	return 1;
+}
+
+/*
+ * Make a page the buffered one, the previous one is programmed first.
+ */
+static uint8_t eefc_buf_load(eefc_buf_t *buf, uint32_t page) {
+	const uint32_t *flash = (const uint32_t *) page;
+	uint32_t i;
+
+	if (buf->page == page) {
+		return 1;
+	}
+	if (!eefc_buf_flush(buf)) {
+		return 0;
+	}
+	for (i = 0; i < EEFC_PAGE_WORDS; i++) {
+		buf->data[i] = flash[i];
+	}
+	buf->page = page;
+	return 1;
+}
+
+uint8_t eefc_buf_write(eefc_buf_t *buf, uint32_t addr, const void *data,
+		uint32_t length) {
+	const uint8_t *src = data;
+	uint8_t *dst;
+	uint32_t offset;
+	uint32_t n;
+
+	if (addr < EEFC_FLASH_START ||
+		length > EEFC_FLASH_START + 2 * EEFC_BANK_SIZE - addr) {
+		return 0;
+	}
+	while (length > 0) {
+		if (!eefc_buf_load(buf, PAGE_OF(addr))) {
+			return 0;
+		}
+		offset = addr - buf->page;
+		n = EEFC_PAGE_SIZE - offset;
+		if (n > length) {
+			n = length;
+		}
+		dst = (uint8_t *) buf->data + offset;
+		addr += n;
+		length -= n;
+		// Mark the page dirty only if a byte changes
+		for (; n > 0; n--, dst++, src++) {
+			if (*dst != *src) {
+				*dst = *src;
+				buf->dirty = 1;
+			}
+		}
+	}
+	return 1;
+}
+
+void eefc_buf_read(const eefc_buf_t *buf, uint32_t addr, void *data,
+		uint32_t length) {
+	uint8_t *dst = data;
+
+	for (; length > 0; length--, addr++, dst++) {
+		if (buf->page != 0 && PAGE_OF(addr) == buf->page) {
+			*dst = ((const uint8_t *) buf->data)[addr - buf->page];
+		} else {
+			*dst = *(const uint8_t *) addr;
+		}
+	}
+}
@@ -0,0 +1,74 @@
+/**
+ * @file eefc_buf.h
+ * @brief EEFC - Buffered flash writes
+ * @details Collects writes of any size in a RAM copy of one flash page and
+ * programs the page once, when a write moves on to another page or on
+ * eefc_buf_flush(). Many small writes to a page, such as settings or log
+ * records, then cost one page program (a few milliseconds with interrupts
+ * disabled) instead of one each, and wear the page less.
+ *
+ * The page is read into the buffer when a write first touches it, so the
+ * bytes that are not written keep their value. A page whose content didn't
+ * change is not programmed. Until the flush the flash still holds the old
+ * data, read it with eefc_buf_read() to see the buffered writes.
+ *
+ * A buffer is not shared between tasks without a lock.
+ * @date 14 October 2026
+ */
+
+#ifndef EEFC_BUF_H_
+#define EEFC_BUF_H_
+
+#include <inttypes.h>
+#include "eefc.h"
+
+/**
+ * A page buffer, see eefc_buf_init().
+ */
+typedef struct {
+	uint32_t page;		///< Address of the buffered page, 0 if none
+	uint32_t dirty;		///< Does the buffer differ from the flash?
+	uint32_t programs;	///< Pages programmed so far
+	uint32_t data[EEFC_PAGE_WORDS];	///< Content of the page
+} eefc_buf_t;
+
+/**
+ * Initialize an empty page buffer.
+ * @param buf The buffer
+ */
+void eefc_buf_init(eefc_buf_t *buf);
+
+/**
+ * Write bytes to the flash through the buffer. A write that leaves the
+ * buffered page programs it first, a long write programs each whole page it
+ * covers at once.
+ * @param buf The buffer
+ * @param addr Flash address of the first byte
+ * @param data The bytes
+ * @param length Number of bytes
+ * @return 1 on success, 0 if the bytes are not all in the flash or a page
+ * could not be programmed.
+ */
+uint8_t eefc_buf_write(eefc_buf_t *buf, uint32_t addr, const void *data,
+		uint32_t length);
+
+/**
+ * Read bytes of the flash, as they are after the buffered writes.
+ * @param buf The buffer
+ * @param addr Flash address of the first byte
+ * @param data Receives the bytes
+ * @param length Number of bytes
+ */
+void eefc_buf_read(const eefc_buf_t *buf, uint32_t addr, void *data,
+		uint32_t length);
+
+/**
+ * Program the buffered page if it was changed. Call it before a reset or
+ * before the data is read from the flash directly.
+ * @param buf The buffer
+ * @return 1 on success or if nothing was to be programmed, 0 if the page
+ * could not be programmed.
+ */
+uint8_t eefc_buf_flush(eefc_buf_t *buf);
+
+#endif
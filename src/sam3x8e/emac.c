@@ -0,0 +1,491 @@
+/*
+ * emac.c
+ *
+ * Date:	14 October 2026
+ */
+
+#include "emac.h"
+#include "pmc.h"
+#include "id.h"
+#include "ramfunc.h"
+#include "irq.h"
+#if EMAC_COOS
+#include "rtos/CoOS.h"
+#endif
+
+///@cond
+// NVIC Interrupt Set-Enable Register 1 (peripheral ID 32-63)
+#define NVIC_ISER1		(*((volatile uint32_t *) PERIPH_ADDR(0xE000E104U)))
+// NVIC Interrupt Clear-Enable Register 1 (peripheral ID 32-63)
+#define NVIC_ICER1		(*((volatile uint32_t *) PERIPH_ADDR(0xE000E184U)))
+
+// Receive descriptor: address word and status word
+#define RX_OWNERSHIP	(0x1u << 0)
+#define RX_WRAP			(0x1u << 1)
+#define RX_ADDR_MASK	(~0x3u)
+#define RX_LENGTH(st)	((st) & 0xFFFu)
+#define RX_SOF			(0x1u << 14)
+#define RX_EOF			(0x1u << 15)
+
+// Transmit descriptor: status word
+#define TX_LENGTH(x)	((x) & 0x7FFu)
+#define TX_LAST			(0x1u << 15)
+#define TX_WRAP			(0x1u << 30)
+#define TX_USED			(0x1u << 31)
+
+// MDC must stay below 2.5 MHz, the divider of MCK is 8, 16, 32 or 64
+#define MDC_MAX_FREQ	(2500000u)
+
+// Loops to wait for an MDIO operation, one takes 32 MDC cycles
+#define MDIO_TIMEOUT	(100000u)
+
+// Transmit errors, the EMAC starts again at the first descriptor after one
+#define TX_ERRORS		(EMAC_INT_TUND | EMAC_INT_RLEX | EMAC_INT_TXERR)
+
+// Standard registers of a PHY (IEEE 802.3 clause 22)
+#define PHY_BMCR			(0u)
+#define PHY_BMSR			(1u)
+#define PHY_ANAR			(4u)
+#define PHY_ANLPAR			(5u)
+#define PHY_BMCR_DUPLEX		(0x1u << 8)
+#define PHY_BMCR_ANENABLE	(0x1u << 12)
+#define PHY_BMCR_SPEED100	(0x1u << 13)
+#define PHY_BMSR_LINK		(0x1u << 2)
+#define PHY_BMSR_ANCOMPLETE	(0x1u << 5)
+#define PHY_AN_10HD			(0x1u << 5)
+#define PHY_AN_10FD			(0x1u << 6)
+#define PHY_AN_100HD		(0x1u << 7)
+#define PHY_AN_100FD		(0x1u << 8)
+///@endcond
+
+/*
+ * A buffer descriptor, the EMAC reads and writes them in memory
+ */
+typedef struct {
+	volatile uint32_t addr;
+	volatile uint32_t status;
+} emac_desc_t;
+
+// The rings, word-aligned as the EMAC takes the low bits of the address
+static emac_desc_t rx_descs[EMAC_RX_DESCS] __attribute__((aligned(8)));
+static emac_desc_t tx_descs[EMAC_TX_DESCS] __attribute__((aligned(8)));
+
+// The buffers behind the descriptors
+static buf_t *rx_bufs[EMAC_RX_DESCS];
+static buf_t *tx_bufs[EMAC_TX_DESCS];
+
+static const buf_pool_t *rx_pool;
+// Next receive descriptor to look at, only used by emac_receive()
+static uint32_t rx_next;
+static uint32_t rx_dropped;
+static uint8_t rx_sem = EMAC_NO_SEM;
+
+/*
+ * The transmit ring indices are free-running. tx_head is written by
+ * emac_send(), tx_tail by the interrupt handler, both with the interrupts
+ * disabled as a transmit error resets the ring.
+ */
+static volatile uint32_t tx_head;
+static volatile uint32_t tx_tail;
+static volatile uint32_t tx_errors;
+
+static inline uint32_t rx_index(uint32_t i) {
+	return (i < EMAC_RX_DESCS) ? i : i - EMAC_RX_DESCS;
+}
+
+static inline uint32_t rx_wrap(uint32_t i) {
+	return (i == EMAC_RX_DESCS - 1) ? RX_WRAP : 0;
+}
+
+static inline uint32_t tx_wrap(uint32_t i) {
+	return (i == EMAC_TX_DESCS - 1) ? TX_WRAP : 0;
+}
+
+/*
+ * Gives the buffer of a receive descriptor to the EMAC, clearing the
+ * ownership bit is the last write.
+ */
+static inline void rx_give(uint32_t i, buf_t *buf) {
+	rx_bufs[i] = buf;
+	rx_descs[i].status = 0;
+	rx_descs[i].addr = ((uint32_t) buf_data(buf) & RX_ADDR_MASK) |
+			rx_wrap(i);
+}
+
+// Gives the descriptors of a frame back to the EMAC with their buffers
+static void rx_recycle(uint32_t first, uint32_t units) {
+	uint32_t i;
+
+	for (i = 0; i < units; i++) {
+		rx_give(rx_index(first + i), rx_bufs[rx_index(first + i)]);
+	}
+	rx_next = rx_index(first + units);
+}
+
+/*
+ * Releases the buffers of the frames that have been sent. The EMAC sets
+ * the used bit of a descriptor when its frame is done.
+ */
+static void tx_reclaim(void) {
+	uint32_t tail = tx_tail;
+	uint32_t i;
+
+	while (tail != tx_head) {
+		i = tail & (EMAC_TX_DESCS - 1);
+		if (!(tx_descs[i].status & TX_USED)) {
+			break;
+		}
+		buf_release(tx_bufs[i]);
+		tx_bufs[i] = 0;
+		tail++;
+	}
+	tx_tail = tail;
+}
+
+/*
+ * Empties the transmit ring, the EMAC takes the first descriptor next.
+ */
+static void tx_reset(void) {
+	uint32_t i;
+
+	for (i = 0; i < EMAC_TX_DESCS; i++) {
+		buf_release(tx_bufs[i]);
+		tx_bufs[i] = 0;
+		tx_descs[i].addr = 0;
+		tx_descs[i].status = TX_USED | tx_wrap(i);
+	}
+	tx_head = 0;
+	tx_tail = 0;
+}
+
+uint8_t emac_init(const uint8_t *mac, const buf_pool_t *pool) {
+	uint32_t mck = pmc_get_mck_freq();
+	uint32_t clk = 0, i;
+
+	if (pool == 0 || pool->size < EMAC_RX_UNIT) {
+		return 0;
+	}
+	pmc_acquire_peripheral_clock(ID_EMAC);
+	EMAC->EMAC_NCR = 0;
+	EMAC->EMAC_IDR = 0xFFFFFFFFu;
+	(void) PERIPH_REG(EMAC->EMAC_ISR);
+	EMAC->EMAC_RSR = EMAC_RSR_MASK;
+	EMAC->EMAC_TSR = EMAC_TSR_MASK;
+
+	rx_pool = pool;
+	rx_next = 0;
+	rx_dropped = 0;
+	for (i = 0; i < EMAC_RX_DESCS; i++) {
+		buf_t *buf = buf_alloc(pool);
+
+		if (buf == 0) {
+			emac_deinit();
+			return 0;
+		}
+		rx_give(i, buf);
+	}
+	tx_reset();
+	tx_errors = 0;
+	EMAC->EMAC_RBQP = (uint32_t) rx_descs;
+	EMAC->EMAC_TBQP = (uint32_t) tx_descs;
+
+	while (clk < 3 && mck / (8u << clk) > MDC_MAX_FREQ) {
+		clk++;
+	}
+	// the FCS is not written to the buffers
+	EMAC->EMAC_NCFGR = EMAC_NCFGR_CLK(clk) | EMAC_NCFGR_SPD | EMAC_NCFGR_FD |
+			EMAC_NCFGR_BIG | EMAC_NCFGR_DRFCS;
+	EMAC->EMAC_USRIO = EMAC_USRIO_RMII | EMAC_USRIO_CLKEN;
+	EMAC->EMAC_SA[0].EMAC_SAB = mac[0] | ((uint32_t) mac[1] << 8) |
+			((uint32_t) mac[2] << 16) | ((uint32_t) mac[3] << 24);
+	EMAC->EMAC_SA[0].EMAC_SAT = mac[4] | ((uint32_t) mac[5] << 8);
+
+	EMAC->EMAC_IER = EMAC_INT_TCOMP | TX_ERRORS |
+			((rx_sem != EMAC_NO_SEM) ? EMAC_INT_RCOMP : 0);
+	NVIC_ISER1 = (0x1u << (ID_EMAC - 32));
+	EMAC->EMAC_NCR = EMAC_NCR_RE | EMAC_NCR_TE | EMAC_NCR_MPE |
+			EMAC_NCR_CLRSTAT;
+	return 1;
+}
+
+void emac_deinit(void) {
+	uint32_t i;
+
+	EMAC->EMAC_IDR = 0xFFFFFFFFu;
+	EMAC->EMAC_NCR = 0;
+	NVIC_ICER1 = (0x1u << (ID_EMAC - 32));
+	for (i = 0; i < EMAC_RX_DESCS; i++) {
+		buf_release(rx_bufs[i]);
+		rx_bufs[i] = 0;
+		rx_descs[i].addr = RX_OWNERSHIP | rx_wrap(i);
+	}
+	tx_reset();
+	pmc_release_peripheral_clock(ID_EMAC);
+}
+
+static uint8_t mdio(uint32_t man, uint16_t *value) {
+	uint32_t timeout = MDIO_TIMEOUT;
+
+	while (!(PERIPH_REG(EMAC->EMAC_NSR) & EMAC_NSR_IDLE)) {
+		if (--timeout == 0) {
+			return 0;
+		}
+	}
+	EMAC->EMAC_MAN = man;
+	timeout = MDIO_TIMEOUT;
+	while (!(PERIPH_REG(EMAC->EMAC_NSR) & EMAC_NSR_IDLE)) {
+		if (--timeout == 0) {
+			return 0;
+		}
+	}
+	if (value) {
+		*value = (uint16_t) EMAC_MAN_DATA(EMAC->EMAC_MAN);
+	}
+	return 1;
+}
+
+uint8_t emac_phy_read(uint8_t phy, uint8_t reg, uint16_t *value) {
+	return mdio(EMAC_MAN_SOF | EMAC_MAN_READ | EMAC_MAN_PHYA(phy) |
+			EMAC_MAN_REGA(reg) | EMAC_MAN_CODE, value);
+}
+
+uint8_t emac_phy_write(uint8_t phy, uint8_t reg, uint16_t value) {
+	return mdio(EMAC_MAN_SOF | EMAC_MAN_WRITE | EMAC_MAN_PHYA(phy) |
+			EMAC_MAN_REGA(reg) | EMAC_MAN_CODE | value, 0);
+}
+
+uint8_t emac_link_update(uint8_t phy) {
+	uint16_t bmsr, bmcr, anar, anlpar;
+	uint32_t ncfgr, common;
+
+	// the link bit latches low, the second read is the state now
+	if (!emac_phy_read(phy, PHY_BMSR, &bmsr) ||
+		!emac_phy_read(phy, PHY_BMSR, &bmsr) || !(bmsr & PHY_BMSR_LINK) ||
+		!emac_phy_read(phy, PHY_BMCR, &bmcr)) {
+		return 0;
+	}
+	ncfgr = EMAC->EMAC_NCFGR & ~(EMAC_NCFGR_SPD | EMAC_NCFGR_FD);
+	if ((bmcr & PHY_BMCR_ANENABLE) && (bmsr & PHY_BMSR_ANCOMPLETE)) {
+		if (!emac_phy_read(phy, PHY_ANAR, &anar) ||
+			!emac_phy_read(phy, PHY_ANLPAR, &anlpar)) {
+			return 0;
+		}
+		// the best mode both sides offer
+		common = anar & anlpar;
+		if (common & (PHY_AN_100FD | PHY_AN_100HD)) {
+			ncfgr |= EMAC_NCFGR_SPD;
+		}
+		if ((common & PHY_AN_100FD) ||
+			(!(common & PHY_AN_100HD) && (common & PHY_AN_10FD))) {
+			ncfgr |= EMAC_NCFGR_FD;
+		}
+	} else {
+		if (bmcr & PHY_BMCR_SPEED100) {
+			ncfgr |= EMAC_NCFGR_SPD;
+		}
+		if (bmcr & PHY_BMCR_DUPLEX) {
+			ncfgr |= EMAC_NCFGR_FD;
+		}
+	}
+	EMAC->EMAC_NCFGR = ncfgr;
+	return 1;
+}
+
+uint8_t emac_send(buf_t *buf) {
+	uint32_t primask, i;
+
+	if (buf->length < 14 || buf->length > EMAC_TX_MAX_LENGTH) {
+		return 0;
+	}
+	primask = irq_save();
+	tx_reclaim();
+	if (tx_head - tx_tail >= EMAC_TX_DESCS) {
+		irq_restore(primask);
+		return 0;
+	}
+	i = tx_head & (EMAC_TX_DESCS - 1);
+	tx_bufs[i] = buf;
+	tx_descs[i].addr = (uint32_t) buf_data(buf);
+	// clearing the used bit hands the descriptor to the EMAC
+	tx_descs[i].status = TX_LENGTH(buf->length) | TX_LAST | tx_wrap(i);
+	tx_head++;
+	EMAC->EMAC_NCR |= EMAC_NCR_TSTART;
+	irq_restore(primask);
+	return 1;
+}
+
+/*
+ * Finds the end of the frame at rx_next.
+ * @return The number of units of a whole frame, 0 if it is not complete
+ * yet. units is set to the descriptors to throw away if it is broken.
+ */
+static uint32_t rx_frame_end(uint32_t *units) {
+	uint32_t n, status;
+
+	*units = 0;
+	for (n = 0; n < EMAC_RX_DESCS; n++) {
+		emac_desc_t *desc = &rx_descs[rx_index(rx_next + n)];
+
+		// the EMAC has not written the descriptor yet
+		if (!(desc->addr & RX_OWNERSHIP)) {
+			return 0;
+		}
+		status = desc->status;
+		// a fragment the EMAC gave up on, or a frame started over
+		if ((n == 0 && !(status & RX_SOF)) || (n > 0 && (status & RX_SOF)) ||
+			n == EMAC_FRAME_UNITS) {
+			*units = (n == 0) ? 1 : n;
+			return 0;
+		}
+		if (status & RX_EOF) {
+			return n + 1;
+		}
+	}
+	return 0;
+}
+
+static uint8_t rx_take(emac_frame_t *frame) {
+	buf_t *fresh[EMAC_FRAME_UNITS];
+	uint32_t used, bad, length, units, i, n;
+
+	for (;;) {
+		used = rx_frame_end(&bad);
+		if (used == 0) {
+			if (bad == 0) {
+				return 0;
+			}
+			rx_recycle(rx_next, bad);
+			continue;
+		}
+		length = RX_LENGTH(rx_descs[rx_index(rx_next + used - 1)].status);
+		// the last unit may be empty, it only held the FCS
+		units = (length + EMAC_RX_UNIT - 1) / EMAC_RX_UNIT;
+		for (n = 0; n < units && units <= used; n++) {
+			fresh[n] = buf_alloc(rx_pool);
+			if (fresh[n] == 0) {
+				break;
+			}
+		}
+		if (units == 0 || units > used || n < units) {
+			// the frame is dropped, its buffers stay in the ring
+			while (n > 0) {
+				buf_release(fresh[--n]);
+			}
+			rx_recycle(rx_next, used);
+			rx_dropped++;
+			continue;
+		}
+		frame->units = (uint8_t) units;
+		frame->length = (uint16_t) length;
+		for (n = 0; n < units; n++) {
+			i = rx_index(rx_next + n);
+			frame->bufs[n] = rx_bufs[i];
+			frame->bufs[n]->length = (uint16_t) ((n < units - 1) ?
+					EMAC_RX_UNIT : length - n * EMAC_RX_UNIT);
+			rx_give(i, fresh[n]);
+		}
+		rx_recycle(rx_index(rx_next + units), used - units);
+		return 1;
+	}
+}
+
+uint8_t emac_receive(emac_frame_t *frame) {
+	if (rx_take(frame)) {
+		return 1;
+	}
+	if (rx_sem == EMAC_NO_SEM) {
+		return 0;
+	}
+	/*
+	 * The next frame interrupts again. One that came in before is looked
+	 * for again, the interrupt handler may have cleared its status.
+	 */
+	EMAC->EMAC_IER = EMAC_INT_RCOMP;
+	return rx_take(frame);
+}
+
+void emac_frame_release(emac_frame_t *frame) {
+	uint32_t n;
+
+	for (n = 0; n < frame->units; n++) {
+		buf_release(frame->bufs[n]);
+		frame->bufs[n] = 0;
+	}
+	frame->units = 0;
+	frame->length = 0;
+}
+
+uint32_t emac_frame_copy(const emac_frame_t *frame, uint8_t *dst,
+		uint32_t size) {
+	uint32_t copied = 0, n, i, length;
+	const uint8_t *src;
+
+	for (n = 0; n < frame->units && copied < size; n++) {
+		src = buf_data(frame->bufs[n]);
+		length = frame->bufs[n]->length;
+		if (length > size - copied) {
+			length = size - copied;
+		}
+		for (i = 0; i < length; i++) {
+			dst[copied + i] = src[i];
+		}
+		copied += length;
+	}
+	return copied;
+}
+
+uint32_t emac_tx_free(void) {
+	uint32_t primask = irq_save();
+	uint32_t free;
+
+	tx_reclaim();
+	free = EMAC_TX_DESCS - (tx_head - tx_tail);
+	irq_restore(primask);
+	return free;
+}
+
+uint32_t emac_rx_dropped(void) {
+	return rx_dropped;
+}
+
+uint32_t emac_tx_errors(void) {
+	return tx_errors;
+}
+
+#if EMAC_COOS
+void emac_set_rx_semaphore(uint8_t sem) {
+	rx_sem = sem;
+	if (sem == EMAC_NO_SEM) {
+		EMAC->EMAC_IDR = EMAC_INT_RCOMP;
+	} else {
+		EMAC->EMAC_IER = EMAC_INT_RCOMP;
+	}
+}
+#endif
+
+RAMFUNC_HOT void EMAC_Handler(void) {
+	uint32_t status = EMAC->EMAC_ISR & EMAC->EMAC_IMR;
+
+	if (status & TX_ERRORS) {
+		// the frames done before the error are not lost
+		tx_reclaim();
+		tx_errors += tx_head - tx_tail;
+		EMAC->EMAC_NCR &= ~EMAC_NCR_TE;
+		tx_reset();
+		EMAC->EMAC_TSR = EMAC_TSR_MASK;
+		EMAC->EMAC_NCR |= EMAC_NCR_TE;
+	} else if (status & EMAC_INT_TCOMP) {
+		EMAC->EMAC_TSR = EMAC_TSR_MASK;
+		tx_reclaim();
+	}
+	if (status & EMAC_INT_RCOMP) {
+		// masked until emac_receive() has taken all frames
+		EMAC->EMAC_IDR = EMAC_INT_RCOMP;
+		EMAC->EMAC_RSR = EMAC_RSR_MASK;
+#if EMAC_COOS
+		if (rx_sem != EMAC_NO_SEM) {
+			isr_PostSem(rx_sem);
+		}
+#endif
+	}
+}
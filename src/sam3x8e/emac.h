@@ -0,0 +1,345 @@
+/**
+ * @file emac.h
+ * @brief EMAC - Ethernet MAC 10/100
+ * @details The EMAC moves frames between the RMII of the PHY and memory with
+ * its own DMA, through two rings of buffer descriptors. The descriptors of
+ * both rings point straight into buffers of a buf_pool, so a frame is never
+ * copied by the driver:
+ * - emac_send() puts the data of a buffer into the transmit ring and takes
+ *   over its reference, the buffer is released when the frame has gone out.
+ *   An IP stack builds its frame in a pool buffer, e.g. with buf_reserve()
+ *   and buf_push() for the headers.
+ * - The EMAC always receives into units of 128 bytes, each receive
+ *   descriptor has a pool buffer of its own. emac_receive() takes the buffers
+ *   of a frame out of the ring as a chain (emac_frame_t) and puts fresh ones
+ *   in their place. A stack that takes chained buffers (like the pbufs of
+ *   lwIP) uses the data where it is, emac_frame_copy() is for one that needs
+ *   the frame in one piece.
+ *
+ * The EMAC has no interrupt moderation, so the receive interrupt is
+ * coalesced by the driver: the first frame masks the interrupt and posts
+ * the CoOS semaphore once, the task then takes all frames in the ring and
+ * the interrupt is unmasked when emac_receive() finds the ring empty. A
+ * burst of frames costs one interrupt and one task switch:
+ * @code
+ *	emac_set_rx_semaphore(rx_sem);
+ *	for (;;) {
+ *		CoPendSem(rx_sem, 0);
+ *		while (emac_receive(&frame)) {
+ *			handle(&frame);		// owns the buffers
+ *		}
+ *	}
+ * @endcode
+ * Transmitted buffers are released by the interrupt handler, all frames
+ * that are done at once.
+ *
+ * @pre The pins must be given to peripheral A with the PIO: ETXCK/EREFCK
+ * (PB0), ETXEN (PB1), ETX0-1 (PB2-3), ECRSDV (PB4), ERX0-1 (PB5-6), ERXER
+ * (PB7), EMDC (PB8) and EMDIO (PB9), and connected to an RMII PHY that gives
+ * the 50 MHz reference clock.
+ * @pre The receive pool needs a buffer of at least EMAC_RX_UNIT bytes for
+ * every receive descriptor, and one more for every unit that the
+ * application may hold.
+ * @pre CoOS delivery requires CFG_MAX_SERVICE_REQUEST > 0 in OsConfig.h.
+ * @date 14 October 2026
+ */
+
+#ifndef EMAC_H_
+#define EMAC_H_
+
+#include <inttypes.h>
+#include "periph.h"
+#include "buf_pool.h"
+
+/*
+ * Number of receive descriptors, 128 bytes each.
+ */
+#ifndef EMAC_RX_DESCS
+#define EMAC_RX_DESCS			(32)
+#endif
+
+/*
+ * Number of transmit descriptors, one frame each. Must be a power of 2.
+ */
+#ifndef EMAC_TX_DESCS
+#define EMAC_TX_DESCS			(8)
+#endif
+
+/*
+ * Set to 0 to build without the CoOS semaphore support, e.g. when the RTOS
+ * is not linked into the application.
+ */
+#ifndef EMAC_COOS
+#define EMAC_COOS				(1)
+#endif
+
+/// No semaphore is posted for received frames.
+#define EMAC_NO_SEM				(0xFFu)
+
+/// Bytes of a receive unit, fixed by the EMAC
+#define EMAC_RX_UNIT			(128u)
+
+/// Most units of a received frame, 1536 bytes (a frame with a VLAN tag)
+#define EMAC_FRAME_UNITS		(12u)
+
+/// Most bytes of a frame to send, without the FCS that the EMAC adds
+#define EMAC_TX_MAX_LENGTH		(1518u)
+
+///@cond
+// Pointer to registers of the EMAC, base address 0x400B0000
+#define EMAC ((emac_reg_t *) PERIPH_ADDR(0x400B0000U))
+
+// Network Control Register
+#define EMAC_NCR_LLB			(0x1u << 1)
+#define EMAC_NCR_RE				(0x1u << 2)
+#define EMAC_NCR_TE				(0x1u << 3)
+#define EMAC_NCR_MPE			(0x1u << 4)
+#define EMAC_NCR_CLRSTAT		(0x1u << 5)
+#define EMAC_NCR_TSTART			(0x1u << 9)
+
+// Network Configuration Register
+#define EMAC_NCFGR_SPD			(0x1u << 0)
+#define EMAC_NCFGR_FD			(0x1u << 1)
+#define EMAC_NCFGR_BIG			(0x1u << 8)
+#define EMAC_NCFGR_CLK(x)		(((x) & 0x3u) << 10)
+#define EMAC_NCFGR_CLK_MASK		(0x3u << 10)
+#define EMAC_NCFGR_DRFCS		(0x1u << 17)
+
+// Network Status Register
+#define EMAC_NSR_IDLE			(0x1u << 2)
+
+// Transmit Status Register, write 1 to clear
+#define EMAC_TSR_MASK			(0x7Fu)
+
+// Receive Status Register, write 1 to clear
+#define EMAC_RSR_MASK			(0x7u)
+
+// Interrupt Registers
+#define EMAC_INT_RCOMP			(0x1u << 1)
+#define EMAC_INT_RXUBR			(0x1u << 2)
+#define EMAC_INT_TUND			(0x1u << 4)
+#define EMAC_INT_RLEX			(0x1u << 5)
+#define EMAC_INT_TXERR			(0x1u << 6)
+#define EMAC_INT_TCOMP			(0x1u << 7)
+#define EMAC_INT_ROVR			(0x1u << 10)
+
+// PHY Maintenance Register
+#define EMAC_MAN_DATA(man)		((man) & 0xFFFFu)
+#define EMAC_MAN_CODE			(0x2u << 16)
+#define EMAC_MAN_REGA(x)		(((x) & 0x1Fu) << 18)
+#define EMAC_MAN_PHYA(x)		(((x) & 0x1Fu) << 23)
+#define EMAC_MAN_WRITE			(0x1u << 28)
+#define EMAC_MAN_READ			(0x2u << 28)
+#define EMAC_MAN_SOF			(0x1u << 30)
+
+// User Input/Output Register
+#define EMAC_USRIO_RMII			(0x1u << 0)
+#define EMAC_USRIO_CLKEN		(0x1u << 1)
+
+/*
+ * Specific Address Registers, the bottom one holds the first 4 bytes of the
+ * address, writing the top one enables the match
+ */
+typedef struct emac_sa_reg {
+	// Specific Address Bottom Register, offset 0x0098 + n * 0x8
+	uint32_t EMAC_SAB;
+	// Specific Address Top Register, offset 0x009C + n * 0x8
+	uint32_t EMAC_SAT;
+} emac_sa_reg_t;
+
+/*
+ * Mapping of the EMAC registers
+ * Base address: 0x400B0000
+ */
+typedef struct emac_reg {
+	// Network Control Register, offset 0x0000
+	uint32_t EMAC_NCR;
+	// Network Configuration Register, offset 0x0004
+	uint32_t EMAC_NCFGR;
+	// Network Status Register, offset 0x0008
+	uint32_t EMAC_NSR;
+	// reserved, offset 0x000C-0x0010
+	uint32_t reserved1[2];
+	// Transmit Status Register, offset 0x0014
+	uint32_t EMAC_TSR;
+	// Receive Buffer Queue Pointer Register, offset 0x0018
+	uint32_t EMAC_RBQP;
+	// Transmit Buffer Queue Pointer Register, offset 0x001C
+	uint32_t EMAC_TBQP;
+	// Receive Status Register, offset 0x0020
+	uint32_t EMAC_RSR;
+	// Interrupt Status Register, offset 0x0024
+	uint32_t EMAC_ISR;
+	// Interrupt Enable Register, offset 0x0028
+	uint32_t EMAC_IER;
+	// Interrupt Disable Register, offset 0x002C
+	uint32_t EMAC_IDR;
+	// Interrupt Mask Register, offset 0x0030
+	uint32_t EMAC_IMR;
+	// PHY Maintenance Register, offset 0x0034
+	uint32_t EMAC_MAN;
+	// Pause Time Register, offset 0x0038
+	uint32_t EMAC_PTR;
+	// Pause Frames Received Register, offset 0x003C
+	uint32_t EMAC_PFR;
+	// Frames Transmitted Ok Register, offset 0x0040
+	uint32_t EMAC_FTO;
+	// Single Collision Frames Register, offset 0x0044
+	uint32_t EMAC_SCF;
+	// Multiple Collision Frames Register, offset 0x0048
+	uint32_t EMAC_MCF;
+	// Frames Received Ok Register, offset 0x004C
+	uint32_t EMAC_FRO;
+	// Frame Check Sequence Errors Register, offset 0x0050
+	uint32_t EMAC_FCSE;
+	// statistics, offset 0x0054-0x006C
+	uint32_t reserved2[7];
+	// Receive Overrun Errors Register, offset 0x0070
+	uint32_t EMAC_ROV;
+	// statistics, offset 0x0074-0x0088
+	uint32_t reserved3[6];
+	// reserved, offset 0x008C
+	uint32_t reserved4;
+	// Hash Register Bottom, offset 0x0090
+	uint32_t EMAC_HRB;
+	// Hash Register Top, offset 0x0094
+	uint32_t EMAC_HRT;
+	// Specific Address 1-4 Registers, offset 0x0098-0x00B4
+	emac_sa_reg_t EMAC_SA[4];
+	// Type ID Checking Register, offset 0x00B8
+	uint32_t EMAC_TID;
+	// reserved, offset 0x00BC
+	uint32_t reserved5;
+	// User Input/Output Register, offset 0x00C0
+	uint32_t EMAC_USRIO;
+} emac_reg_t;
+///@endcond
+
+/**
+ * A received frame, a chain of pool buffers. The data of each buffer
+ * follows that of the one before it, all but the last one hold
+ * EMAC_RX_UNIT bytes. The FCS is not part of the frame.
+ */
+typedef struct emac_frame {
+	/** The buffers, one reference each */
+	buf_t *bufs[EMAC_FRAME_UNITS];
+	/** Number of buffers */
+	uint8_t units;
+	/** Bytes of the frame */
+	uint16_t length;
+} emac_frame_t;
+
+/**
+ * Initializes the EMAC for an RMII PHY at 100 Mbit/s full duplex and
+ * starts it: acquires its peripheral clock, fills the receive ring with
+ * buffers of the pool and sets the MAC address. Frames to this address and
+ * broadcasts are received. emac_link_update() sets the speed and duplex
+ * of the PHY.
+ * @param mac The MAC address, 6 bytes.
+ * @param rx_pool The pool of the receive buffers, EMAC_RX_UNIT bytes or
+ * more each.
+ * @return error (1 = SUCCESS, 0 = FAIL, the pool has too small or too few
+ * buffers)
+ */
+uint8_t emac_init(const uint8_t *mac, const buf_pool_t *rx_pool);
+
+/**
+ * Stops the EMAC and releases its peripheral clock. The buffers of the
+ * rings are released, frames not sent yet are lost.
+ */
+void emac_deinit(void);
+
+/**
+ * Reads a register of the PHY through the MDIO.
+ * @param phy The address of the PHY (0-31).
+ * @param reg The register (0-31).
+ * @param value Where to put the value.
+ * @return error (1 = SUCCESS, 0 = FAIL, time-out)
+ */
+uint8_t emac_phy_read(uint8_t phy, uint8_t reg, uint16_t *value);
+
+/**
+ * Writes a register of the PHY through the MDIO.
+ * @param phy The address of the PHY (0-31).
+ * @param reg The register (0-31).
+ * @param value The value.
+ * @return error (1 = SUCCESS, 0 = FAIL, time-out)
+ */
+uint8_t emac_phy_write(uint8_t phy, uint8_t reg, uint16_t value);
+
+/**
+ * Reads the link of the PHY from its standard registers and sets the
+ * speed and duplex of the EMAC to match, the result of the
+ * auto-negotiation or the fixed mode of the PHY. Call it when the link
+ * has changed, e.g. polled every second.
+ * @param phy The address of the PHY (0-31).
+ * @return 1 if the link is up, otherwise 0.
+ */
+uint8_t emac_link_update(uint8_t phy);
+
+/**
+ * Puts a frame into the transmit ring and starts sending it. The frame is
+ * the data of the buffer: destination and source address, type and
+ * payload, frames shorter than 60 bytes are padded. The reference of the
+ * buffer is taken over on success.
+ * @param buf The buffer, with 14 to EMAC_TX_MAX_LENGTH bytes of data.
+ * @return 1 if the frame was queued, 0 if the transmit ring is full or the
+ * frame is invalid (the caller keeps the reference).
+ */
+uint8_t emac_send(buf_t *buf);
+
+/**
+ * Takes the oldest received frame out of the receive ring, its buffers are
+ * replaced by fresh ones of the pool. A frame is dropped (see
+ * emac_rx_dropped()) if the pool runs out. When the ring is empty, the
+ * receive interrupt is unmasked again.
+ * @param frame Where to put the frame, the caller owns its buffers.
+ * @return 1 if a frame was taken, 0 if there is none.
+ */
+uint8_t emac_receive(emac_frame_t *frame);
+
+/**
+ * Releases the buffers of a received frame.
+ * @param frame The frame.
+ */
+void emac_frame_release(emac_frame_t *frame);
+
+/**
+ * Copies a received frame into one piece of memory.
+ * @param frame The frame.
+ * @param dst Where to put the data.
+ * @param size Room in dst.
+ * @return The number of bytes copied, the frame is cut at size.
+ */
+uint32_t emac_frame_copy(const emac_frame_t *frame, uint8_t *dst,
+		uint32_t size);
+
+/**
+ * @return The number of frames that can be queued with emac_send().
+ */
+uint32_t emac_tx_free(void);
+
+/**
+ * @return The number of frames dropped because the pool had no buffers.
+ */
+uint32_t emac_rx_dropped(void);
+
+/**
+ * @return The number of frames lost to a transmit error (underrun, too
+ * many collisions).
+ */
+uint32_t emac_tx_errors(void);
+
+#if EMAC_COOS
+/**
+ * Posts a CoOS semaphore (isr_PostSem()) when frames are received, once
+ * for all frames that come in until emac_receive() has found the ring
+ * empty. Without a semaphore the receive interrupt is off and
+ * emac_receive() is polled.
+ * @param sem The semaphore, created with CoCreateSem(). Give EMAC_NO_SEM to
+ * stop posting.
+ */
+void emac_set_rx_semaphore(uint8_t sem);
+#endif
+
+#endif
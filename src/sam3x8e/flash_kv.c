@@ -0,0 +1,338 @@
+/*
+ * flash_kv.c
+ *
+ * Date:	14 October 2026
+ */
+
+#include "flash_kv.h"
+#include "crc.h"
+
+///@cond
+
+// First word of the header of a sector in use, the second is the sequence
+#define SECTOR_MAGIC		(0x4B565332u)
+// Bytes of the header of a sector
+#define SECTOR_HEADER		(8u)
+// Bytes of the header of a record: key and length, then the checksum
+#define RECORD_HEADER		(8u)
+// Words of a value of length bytes
+#define WORDS(length)		(((length) + 3u) / 4u)
+// First word of a record
+#define RECORD_WORD(key, length)	(((length) << 16) | (key))
+#define RECORD_KEY(word)	((word) & 0xFFFFu)
+#define RECORD_LENGTH(word)	((word) >> 16)
+// Erased flash
+#define ERASED				(0xFFFFFFFFu)
+// Words of the values buffered on the stack while writing
+#define CHUNK_WORDS			(16u)
+
+///@endcond
+
+/*
+ * CRC-32 over words, the checksum of the records. sum is the state of
+ * crc_update(), the record holds crc_final() of it.
+ */
+static uint32_t kv_checksum(uint32_t sum, const uint32_t *words, uint32_t n) {
+	return crc_update(&crc32_ieee, sum, words, 4 * n);
+}
+
+static uint32_t kv_sector(const flash_kv_t *kv, uint32_t sector) {
+	return kv->start + sector * kv->sector_size;
+}
+
+/*
+ * Get the sequence number of a sector with a valid header.
+ *
+ * ret 1 if the sector is in use, 0 if not.
+ */
+static uint8_t kv_sector_seq(const flash_kv_t *kv, uint32_t sector,
+		uint32_t *seq) {
+	const uint32_t *header = (const uint32_t *) kv_sector(kv, sector);
+
+	if (header[0] != SECTOR_MAGIC) {
+		return 0;
+	}
+	*seq = header[1];
+	return 1;
+}
+
+/*
+ * Checksum of a record of length bytes at an address.
+ */
+static uint32_t kv_record_checksum(uint32_t addr, uint32_t length) {
+	const uint32_t *record = (const uint32_t *) addr;
+	uint32_t sum = kv_checksum(crc_start(&crc32_ieee), record, 1);
+
+	sum = kv_checksum(sum, record + 2, WORDS(length));
+	return crc_final(&crc32_ieee, sum);
+}
+
+/*
+ * Walk the records of the active sector and index the latest one of each
+ * key. A header that can't be a record ends the log, the rest of the sector
+ * is left unused.
+ */
+static void kv_scan(flash_kv_t *kv) {
+	uint32_t end = kv_sector(kv, kv->active) + kv->sector_size;
+	uint32_t addr = kv_sector(kv, kv->active) + SECTOR_HEADER;
+	const uint32_t *record;
+	uint32_t key;
+	uint32_t length;
+	uint32_t i;
+
+	for (i = 0; i < kv->keys; i++) {
+		kv->index[i] = 0;
+	}
+	while (addr + RECORD_HEADER <= end) {
+		record = (const uint32_t *) addr;
+		if (record[0] == ERASED) {
+			break;
+		}
+		key = RECORD_KEY(record[0]);
+		length = RECORD_LENGTH(record[0]);
+		if (4 * WORDS(length) > end - addr - RECORD_HEADER) {
+			addr = end;
+			break;
+		}
+		// A torn record is skipped
+		if (key < kv->keys && record[1] == kv_record_checksum(addr, length)) {
+			kv->index[key] = (length != 0) ? addr : 0;
+		}
+		addr += RECORD_HEADER + 4 * WORDS(length);
+	}
+	kv->tail = addr;
+}
+
+/*
+ * Erase the pages of a sector, pages that read erased already are skipped.
+ */
+static uint8_t kv_erase(const flash_kv_t *kv, uint32_t sector) {
+	uint32_t addr = kv_sector(kv, sector);
+	uint32_t end = addr + kv->sector_size;
+	const uint32_t *word;
+	uint32_t i;
+
+	for (; addr < end; addr += EEFC_PAGE_SIZE) {
+		word = (const uint32_t *) addr;
+		for (i = 0; i < EEFC_PAGE_WORDS && word[i] == ERASED; i++);
+		if (i < EEFC_PAGE_WORDS && !eefc_erase_page(addr)) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/*
+ * Program the header of a sector, which puts it in use.
+ */
+static uint8_t kv_put_header(const flash_kv_t *kv, uint32_t sector,
+		uint32_t seq) {
+	uint32_t header[2] = { SECTOR_MAGIC, seq };
+
+	return eefc_write_words(kv_sector(kv, sector), header, 2);
+}
+
+/*
+ * Append a record at the tail, the value is padded with 0xFF to words.
+ */
+static uint8_t kv_append(flash_kv_t *kv, uint32_t key, const uint8_t *data,
+		uint32_t length) {
+	uint32_t chunk[CHUNK_WORDS];
+	uint32_t header[2];
+	uint32_t addr = kv->tail;
+	uint32_t left;
+	uint32_t pass;
+	uint32_t n;
+	uint32_t i;
+
+	header[0] = RECORD_WORD(key, length);
+	header[1] = kv_checksum(crc_start(&crc32_ieee), header, 1);
+	// Pass 0 computes the checksum, pass 1 programs the value
+	for (pass = 0; pass < 2; pass++) {
+		if (pass == 1) {
+			header[1] = crc_final(&crc32_ieee, header[1]);
+			if (!eefc_write_words(addr, header, 2)) {
+				return 0;
+			}
+		}
+		for (left = length; left > 0; left -= n) {
+			n = (left < 4 * CHUNK_WORDS) ? left : 4 * CHUNK_WORDS;
+			chunk[WORDS(n) - 1] = ERASED;
+			for (i = 0; i < n; i++) {
+				((uint8_t *) chunk)[i] = *data++;
+			}
+			if (pass == 0) {
+				header[1] = kv_checksum(header[1], chunk, WORDS(n));
+			} else if (!eefc_write_words(addr + RECORD_HEADER +
+					(length - left), chunk, WORDS(n))) {
+				return 0;
+			}
+		}
+		data -= length;
+	}
+	kv->index[key] = (length != 0) ? addr : 0;
+	kv->tail = addr + RECORD_HEADER + 4 * WORDS(length);
+	return 1;
+}
+
+/*
+ * Copy the latest record of each key to the next sector and make it the
+ * active one. The key to be written next is left out if skip is below
+ * kv->keys. The header is programmed last, until then the old sector stays
+ * the one a mount finds.
+ */
+static uint8_t kv_compact(flash_kv_t *kv, uint32_t skip) {
+	uint32_t next = (kv->active + 1) % kv->sectors;
+	uint32_t addr = kv_sector(kv, next) + SECTOR_HEADER;
+	const uint32_t *record;
+	uint32_t words;
+	uint32_t key;
+
+	if (!kv_erase(kv, next)) {
+		return 0;
+	}
+	for (key = 0; key < kv->keys; key++) {
+		if (kv->index[key] == 0 || key == skip) {
+			continue;
+		}
+		record = (const uint32_t *) kv->index[key];
+		words = 2 + WORDS(RECORD_LENGTH(record[0]));
+		if (!eefc_write_words(addr, record, words)) {
+			return 0;
+		}
+		kv->index[key] = addr;
+		addr += 4 * words;
+	}
+	if (skip < kv->keys) {
+		kv->index[skip] = 0;
+	}
+	if (!kv_put_header(kv, next, kv->seq + 1)) {
+		return 0;
+	}
+	kv->active = next;
+	kv->seq++;
+	kv->tail = addr;
+	kv->compactions++;
+	return 1;
+}
+
+uint8_t flash_kv_mount(flash_kv_t *kv, uint32_t start, uint32_t sector_size,
+		uint32_t sectors, uint32_t *index, uint32_t keys) {
+	uint32_t sector;
+	uint32_t seq;
+	uint8_t found = 0;
+
+	if (start % EEFC_PAGE_SIZE != 0 || sector_size == 0 ||
+		sector_size % EEFC_PAGE_SIZE != 0 || sectors < 2 ||
+		index == 0 || keys == 0 || keys > 0xFFFF) {
+		return 0;
+	}
+	kv->start = start;
+	kv->sector_size = sector_size;
+	kv->sectors = sectors;
+	kv->index = index;
+	kv->keys = keys;
+	kv->compactions = 0;
+
+	// The active sector is the one with the highest sequence number
+	for (sector = 0; sector < sectors; sector++) {
+		if (kv_sector_seq(kv, sector, &seq) &&
+			(!found || (int32_t) (seq - kv->seq) > 0)) {
+			kv->active = sector;
+			kv->seq = seq;
+			found = 1;
+		}
+	}
+	if (!found) {
+		// A new store
+		kv->active = 0;
+		kv->seq = 1;
+		if (!kv_erase(kv, 0) || !kv_put_header(kv, 0, 1)) {
+			return 0;
+		}
+	}
+	kv_scan(kv);
+	return 1;
+}
+
+uint8_t flash_kv_read(const flash_kv_t *kv, uint32_t key, void *data,
+		uint32_t size, uint32_t *length) {
+	const uint8_t *value;
+	uint8_t *dst = data;
+	uint32_t n;
+	uint32_t i;
+
+	if (key >= kv->keys || kv->index[key] == 0) {
+		return 0;
+	}
+	n = RECORD_LENGTH(*(const uint32_t *) kv->index[key]);
+	if (length) {
+		*length = n;
+	}
+	value = (const uint8_t *) (kv->index[key] + RECORD_HEADER);
+	for (i = 0; i < n && i < size; i++) {
+		dst[i] = value[i];
+	}
+	return 1;
+}
+
+/*
+ * Bytes a compaction leaving out a key keeps.
+ */
+static uint32_t kv_live_size(const flash_kv_t *kv, uint32_t skip) {
+	uint32_t size = SECTOR_HEADER;
+	uint32_t length;
+	uint32_t key;
+
+	for (key = 0; key < kv->keys; key++) {
+		if (kv->index[key] != 0 && key != skip) {
+			length = RECORD_LENGTH(*(const uint32_t *) kv->index[key]);
+			size += RECORD_HEADER + 4 * WORDS(length);
+		}
+	}
+	return size;
+}
+
+/*
+ * Append a record, compacting first if it doesn't fit. The old value of the
+ * key is not copied by the compaction, so it is checked beforehand that the
+ * new one fits afterwards.
+ */
+static uint8_t kv_put(flash_kv_t *kv, uint32_t key, const uint8_t *data,
+		uint32_t length) {
+	uint32_t size = RECORD_HEADER + 4 * WORDS(length);
+	uint32_t end = kv_sector(kv, kv->active) + kv->sector_size;
+
+	if (size > end - kv->tail) {
+		if (size > kv->sector_size - kv_live_size(kv, key)) {
+			return 0;
+		}
+		if (!kv_compact(kv, key)) {
+			return 0;
+		}
+		// A deleted key needs no record in the new sector
+		if (length == 0) {
+			return 1;
+		}
+	}
+	return kv_append(kv, key, data, length);
+}
+
+uint8_t flash_kv_write(flash_kv_t *kv, uint32_t key, const void *data,
+		uint32_t length) {
+	if (key >= kv->keys || data == 0 || length == 0 || length >= 0xFFFF) {
+		return 0;
+	}
+	return kv_put(kv, key, data, length);
+}
+
+uint8_t flash_kv_delete(flash_kv_t *kv, uint32_t key) {
+	if (key >= kv->keys) {
+		return 0;
+	}
+	if (kv->index[key] == 0) {
+		return 1;
+	}
+	// A record without a value
+	return kv_put(kv, key, 0, 0);
+}
@@ -0,0 +1,96 @@
+/**
+ * @file flash_kv.h
+ * @brief Key-value store in the internal flash
+ * @details Keeps small values under 16-bit keys in two or more sectors of
+ * flash, written as a log. A write appends a record with the new value to
+ * the active sector, nothing is erased. When the active sector is full the
+ * latest record of each key is copied to the next sector, which is erased
+ * first, and that one becomes active. The sectors take turns, so each is
+ * erased once every n compactions, and an update costs a record instead of
+ * the erase and rewrite of a sector.
+ *
+ * An index in RAM holds the address of the latest record of each key, it is
+ * built by flash_kv_mount() by walking the active sector. Reads look up the
+ * index and copy from the flash.
+ *
+ * Records carry a CRC-32 (see crc.h), a record torn by a reset is skipped at
+ * the next mount. A compacted sector gets its header only after all the
+ * records are copied, so a reset in between keeps the old sector.
+ *
+ * Each record takes 8 bytes and the value rounded up to words. The store is
+ * not shared between tasks without a lock, and a write may block for the
+ * erase of a sector when it compacts.
+ * @pre The sectors must be in flash that holds no code and is not locked.
+ * @date 14 October 2026
+ */
+
+#ifndef FLASH_KV_H_
+#define FLASH_KV_H_
+
+#include <inttypes.h>
+#include "eefc.h"
+
+/**
+ * A key-value store, see flash_kv_mount().
+ */
+typedef struct {
+	uint32_t start;			///< Address of the first sector
+	uint32_t sector_size;	///< Bytes of a sector
+	uint32_t sectors;		///< Number of sectors
+	uint32_t *index;		///< Address of the latest record of each key
+	uint32_t keys;			///< Number of keys, the keys are 0 to keys - 1
+	uint32_t active;		///< Number of the active sector
+	uint32_t seq;			///< Sequence number of the active sector
+	uint32_t tail;			///< Address of the next record
+	uint32_t compactions;	///< Compactions since the mount
+} flash_kv_t;
+
+/**
+ * Mount a store, an empty flash region becomes an empty store.
+ * @param kv The store
+ * @param start Address of the first sector, a multiple of EEFC_PAGE_SIZE
+ * @param sector_size Bytes of a sector, a multiple of EEFC_PAGE_SIZE
+ * @param sectors Number of sectors, at least 2
+ * @param index Array of keys entries for the index, owned by the store
+ * @param keys Number of keys, at most 0xFFFF
+ * @return 1 on success, 0 if the parameters are invalid or the flash could
+ * not be programmed.
+ */
+uint8_t flash_kv_mount(flash_kv_t *kv, uint32_t start, uint32_t sector_size,
+		uint32_t sectors, uint32_t *index, uint32_t keys);
+
+/**
+ * Read the value of a key.
+ * @param kv The store
+ * @param key The key
+ * @param data Receives at most size bytes of the value
+ * @param size Size of data
+ * @param length Receives the length of the value, may be 0 (null pointer)
+ * @return 1 if the key has a value, otherwise 0.
+ */
+uint8_t flash_kv_read(const flash_kv_t *kv, uint32_t key, void *data,
+		uint32_t size, uint32_t *length);
+
+/**
+ * Set the value of a key. It is appended, the sectors are compacted first if
+ * the active one is full.
+ * @param kv The store
+ * @param key The key
+ * @param data The bytes of the value
+ * @param length Length of the value, at least 1
+ * @return 1 on success, 0 if the key is invalid, the latest values don't
+ * fit into a sector or the flash could not be programmed.
+ */
+uint8_t flash_kv_write(flash_kv_t *kv, uint32_t key, const void *data,
+		uint32_t length);
+
+/**
+ * Remove the value of a key.
+ * @param kv The store
+ * @param key The key
+ * @return 1 on success or if the key has no value, 0 if the key is invalid
+ * or the flash could not be programmed.
+ */
+uint8_t flash_kv_delete(flash_kv_t *kv, uint32_t key);
+
+#endif
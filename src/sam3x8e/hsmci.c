@@ -0,0 +1,510 @@
+/*
+ * hsmci.c
+ *
+ * Date:	14 October 2026
+ */
+
+#include "hsmci.h"
+#include "dmac.h"
+#include "pmc.h"
+#include "id.h"
+#include "irq.h"
+
+///@cond
+// Clock of the identification and of the data transfer
+#define CLOCK_INIT_FREQ		(400000u)
+#define CLOCK_DATA_FREQ		(25000000u)
+
+// SD commands, ACMD are sent after CMD55
+#define CMD_GO_IDLE				(0u)
+#define CMD_ALL_SEND_CID		(2u)
+#define CMD_SEND_RCA			(3u)
+#define ACMD_SET_BUS_WIDTH		(6u)
+#define CMD_SELECT_CARD			(7u)
+#define CMD_SEND_IF_COND		(8u)
+#define CMD_SEND_CSD			(9u)
+#define CMD_STOP_TRANSMISSION	(12u)
+#define CMD_SET_BLOCKLEN		(16u)
+#define CMD_READ_SINGLE			(17u)
+#define CMD_READ_MULTIPLE		(18u)
+#define ACMD_SET_WR_BLK_ERASE	(23u)
+#define CMD_WRITE_SINGLE		(24u)
+#define CMD_WRITE_MULTIPLE		(25u)
+#define CMD_ERASE_START			(32u)
+#define CMD_ERASE_END			(33u)
+#define CMD_ERASE				(38u)
+#define ACMD_SD_SEND_OP_COND	(41u)
+#define CMD_APP					(55u)
+
+// Check pattern and 2.7-3.6 V of CMD8
+#define IF_COND_ARG				(0x1AAu)
+// ACMD41: 3.2-3.4 V, host supports high capacity, card busy and capacity
+#define OCR_VOLTAGE				(0x00300000u)
+#define OCR_HCS					(0x1u << 30)
+#define OCR_READY				(0x1u << 31)
+
+// Error bits of the card status in an R1 response
+#define R1_ERRORS				(0xFDF80000u)
+
+// Flag of send_cmd(), R2 and R3 have no CRC of the command
+#define CMD_NO_CRC				(0x1u << 31)
+
+// Command errors
+#define CMD_ERRORS		(HSMCI_SR_RINDE | HSMCI_SR_RDIRE | HSMCI_SR_RCRCE | \
+						HSMCI_SR_RENDE | HSMCI_SR_RTOE)
+#define DATA_ERRORS		(HSMCI_SR_DCRCE | HSMCI_SR_DTOE | HSMCI_SR_CSTOE | \
+						HSMCI_SR_OVRE | HSMCI_SR_UNRE)
+
+// Tries of ACMD41 until the card is ready, about 0.5 s at 400 kHz
+#define OP_COND_TRIES			(1000u)
+// Loops to wait for the busy line or the end of a transfer
+#define BUSY_TIMEOUT			(50000000u)
+// Loops to wait for the response of a command, the response time-out of the
+// HSMCI normally ends the wait first
+#define CMD_TIMEOUT				(1000000u)
+// Loops to wait for the last block of the stream
+#define BLOCK_TIMEOUT			(100000u)
+
+// Blocks of one DMAC transfer of words
+#define DMA_BLOCKS				(HSMCI_STREAM_MAX_LENGTH / HSMCI_BLOCK_SIZE)
+#define BLOCK_WORDS				(HSMCI_BLOCK_SIZE / 4u)
+///@endcond
+
+static struct {
+	uint32_t rca;
+	uint32_t blocks;
+	// block addressing (SDHC, SDXC), SDSC takes byte addresses
+	uint8_t high_capacity;
+	uint32_t channel;
+} card;
+
+/*
+ * The queue indices are free-running, head is written by
+ * hsmci_stream_write() and tail by the DMAC callback, both with the
+ * interrupts disabled.
+ */
+static struct {
+	buf_t *queue[HSMCI_STREAM_QUEUE];
+	volatile uint32_t head;
+	volatile uint32_t tail;
+	volatile uint8_t dma_busy;
+	uint8_t open;
+	// the next block to queue and the end of the region
+	uint32_t next;
+	uint32_t end;
+	volatile uint32_t written;
+} stream;
+
+static void set_clock(uint32_t freq) {
+	uint32_t mck = pmc_get_mck_freq();
+	// MCCK = MCK / (2 * (CLKDIV + 1)), not above freq
+	uint32_t div = (mck + 2 * freq - 1) / (2 * freq);
+
+	if (div > 0) {
+		div--;
+	}
+	if (div > HSMCI_MR_CLKDIV_MASK) {
+		div = HSMCI_MR_CLKDIV_MASK;
+	}
+	HSMCI->HSMCI_MR = (HSMCI->HSMCI_MR & ~HSMCI_MR_CLKDIV_MASK) |
+			HSMCI_MR_CLKDIV(div);
+}
+
+static uint8_t wait_not_busy(void) {
+	uint32_t timeout = BUSY_TIMEOUT;
+
+	while ((PERIPH_REG(HSMCI->HSMCI_SR) &
+			(HSMCI_SR_NOTBUSY | HSMCI_SR_DTIP)) != HSMCI_SR_NOTBUSY) {
+		if (--timeout == 0) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/*
+ * Sends a command and waits for its response, and for the end of the busy
+ * signal of an R1b response.
+ * @return 1 on success, 0 on an error of the response or when it never
+ * comes.
+ */
+static uint8_t send_cmd(uint32_t cmdr, uint32_t arg) {
+	uint32_t rsp = cmdr & HSMCI_CMDR_RSP_MASK;
+	uint32_t errors = CMD_ERRORS;
+	uint32_t timeout = CMD_TIMEOUT;
+	uint32_t sr;
+
+	if (cmdr & CMD_NO_CRC) {
+		errors &= ~HSMCI_SR_RCRCE;
+	}
+	HSMCI->HSMCI_ARGR = arg;
+	HSMCI->HSMCI_CMDR = cmdr & ~CMD_NO_CRC;
+	// a missing response ends with a time-out
+	do {
+		sr = PERIPH_REG(HSMCI->HSMCI_SR);
+		if (--timeout == 0) {
+			return 0;
+		}
+	} while (!(sr & HSMCI_SR_CMDRDY));
+	if (sr & errors) {
+		return 0;
+	}
+	if (rsp == HSMCI_CMDR_RSP_R1B) {
+		return wait_not_busy();
+	}
+	return 1;
+}
+
+// A command with an R1 response, the card status is checked too
+static uint8_t send_r1(uint32_t cmdr, uint32_t arg) {
+	return send_cmd(cmdr, arg) && !(HSMCI->HSMCI_RSPR[0] & R1_ERRORS);
+}
+
+static uint8_t send_app(uint32_t cmdr, uint32_t arg) {
+	return send_r1(HSMCI_CMDR_CMDNB(CMD_APP) | HSMCI_CMDR_RSP_48 |
+			HSMCI_CMDR_MAXLAT, card.rca << 16) && send_cmd(cmdr, arg);
+}
+
+/*
+ * Reads bits of the 128 bits of a CID or CSD, the first word read holds
+ * bits 127-96.
+ */
+static uint32_t bits(const uint32_t *rsp, uint32_t first, uint32_t count) {
+	uint32_t word = 3 - first / 32;
+	uint32_t shift = first % 32;
+	uint32_t value = rsp[word] >> shift;
+
+	if (shift + count > 32) {
+		value |= rsp[word - 1] << (32 - shift);
+	}
+	return (count < 32) ? value & ((0x1u << count) - 1) : value;
+}
+
+static uint32_t csd_blocks(const uint32_t *csd) {
+	uint32_t c_size, mult, read_bl_len;
+
+	if (bits(csd, 126, 2) == 1) {
+		// CSD 2.0: 512 KB per C_SIZE
+		return (bits(csd, 48, 22) + 1) << 10;
+	}
+	c_size = bits(csd, 62, 12);
+	mult = bits(csd, 47, 3);
+	read_bl_len = bits(csd, 80, 4);
+	// the block length is 512 to 2048 bytes
+	return (c_size + 1) << (mult + 2 + read_bl_len - 9);
+}
+
+static uint8_t identify(void) {
+	uint32_t csd[4], ocr, arg, i;
+	uint8_t v2;
+
+	// 74 clocks before the first command
+	if (!send_cmd(HSMCI_CMDR_SPCMD_INIT | HSMCI_CMDR_RSP_NONE, 0)) {
+		return 0;
+	}
+	(void) send_cmd(HSMCI_CMDR_CMDNB(CMD_GO_IDLE) | HSMCI_CMDR_RSP_NONE, 0);
+	// only a card of version 2.00 or later answers CMD8
+	v2 = send_cmd(HSMCI_CMDR_CMDNB(CMD_SEND_IF_COND) | HSMCI_CMDR_RSP_48 |
+			HSMCI_CMDR_MAXLAT, IF_COND_ARG) &&
+			(HSMCI->HSMCI_RSPR[0] & 0xFFFu) == IF_COND_ARG;
+	arg = OCR_VOLTAGE | (v2 ? OCR_HCS : 0);
+	card.rca = 0;
+	for (i = 0; i < OP_COND_TRIES; i++) {
+		if (!send_app(HSMCI_CMDR_CMDNB(ACMD_SD_SEND_OP_COND) |
+				HSMCI_CMDR_RSP_48 | CMD_NO_CRC, arg)) {
+			return 0;
+		}
+		ocr = HSMCI->HSMCI_RSPR[0];
+		if (ocr & OCR_READY) {
+			break;
+		}
+	}
+	if (i == OP_COND_TRIES) {
+		return 0;
+	}
+	card.high_capacity = (ocr & OCR_HCS) != 0;
+
+	if (!send_cmd(HSMCI_CMDR_CMDNB(CMD_ALL_SEND_CID) | HSMCI_CMDR_RSP_136 |
+			CMD_NO_CRC, 0) ||
+		!send_cmd(HSMCI_CMDR_CMDNB(CMD_SEND_RCA) | HSMCI_CMDR_RSP_48 |
+			HSMCI_CMDR_MAXLAT, 0)) {
+		return 0;
+	}
+	card.rca = HSMCI->HSMCI_RSPR[0] >> 16;
+	if (!send_cmd(HSMCI_CMDR_CMDNB(CMD_SEND_CSD) | HSMCI_CMDR_RSP_136 |
+			CMD_NO_CRC, card.rca << 16)) {
+		return 0;
+	}
+	for (i = 0; i < 4; i++) {
+		csd[i] = HSMCI->HSMCI_RSPR[0];
+	}
+	card.blocks = csd_blocks(csd);
+	return 1;
+}
+
+uint8_t hsmci_init(void) {
+	card.blocks = 0;
+	dmac_init();
+	if (!dmac_channel_alloc(&card.channel)) {
+		dmac_deinit();
+		return 0;
+	}
+	pmc_acquire_peripheral_clock(ID_HSMCI);
+	HSMCI->HSMCI_CR = HSMCI_CR_SWRST;
+	HSMCI->HSMCI_CR = HSMCI_CR_MCIDIS | HSMCI_CR_PWSDIS;
+	HSMCI->HSMCI_IDR = 0xFFFFFFFFu;
+	HSMCI->HSMCI_DTOR = HSMCI_TIMEOUT_MAX;
+	HSMCI->HSMCI_CSTOR = HSMCI_TIMEOUT_MAX;
+	// the clock stops instead of the FIFO running over or under
+	HSMCI->HSMCI_MR = HSMCI_MR_RDPROOF | HSMCI_MR_WRPROOF;
+	HSMCI->HSMCI_CFG = HSMCI_CFG_FIFOMODE | HSMCI_CFG_FERRCTRL;
+	HSMCI->HSMCI_SDCR = HSMCI_SDCR_SLOT_A | HSMCI_SDCR_BUS_1BIT;
+	set_clock(CLOCK_INIT_FREQ);
+	HSMCI->HSMCI_CR = HSMCI_CR_MCIEN;
+
+	if (!identify() ||
+		!send_cmd(HSMCI_CMDR_CMDNB(CMD_SELECT_CARD) | HSMCI_CMDR_RSP_R1B |
+			HSMCI_CMDR_MAXLAT, card.rca << 16) ||
+		!send_app(HSMCI_CMDR_CMDNB(ACMD_SET_BUS_WIDTH) | HSMCI_CMDR_RSP_48 |
+			HSMCI_CMDR_MAXLAT, 2) ||
+		(!card.high_capacity &&
+			!send_r1(HSMCI_CMDR_CMDNB(CMD_SET_BLOCKLEN) | HSMCI_CMDR_RSP_48 |
+			HSMCI_CMDR_MAXLAT, HSMCI_BLOCK_SIZE))) {
+		card.blocks = 0;
+		hsmci_deinit();
+		return 0;
+	}
+	HSMCI->HSMCI_SDCR = HSMCI_SDCR_SLOT_A | HSMCI_SDCR_BUS_4BIT;
+	set_clock(CLOCK_DATA_FREQ);
+	return 1;
+}
+
+void hsmci_deinit(void) {
+	HSMCI->HSMCI_CR = HSMCI_CR_MCIDIS;
+	HSMCI->HSMCI_DMA = 0;
+	pmc_release_peripheral_clock(ID_HSMCI);
+	dmac_abort(card.channel);
+	dmac_channel_free(card.channel);
+	dmac_deinit();
+	card.blocks = 0;
+}
+
+uint32_t hsmci_blocks(void) {
+	return card.blocks;
+}
+
+static inline uint32_t block_addr(uint32_t block) {
+	return card.high_capacity ? block : block * HSMCI_BLOCK_SIZE;
+}
+
+static inline uint8_t region_valid(uint32_t block, uint32_t count) {
+	return count > 0 && block < card.blocks && count <= card.blocks - block;
+}
+
+/*
+ * Moves the data of a transfer with the DMAC, DMA_BLOCKS at a time, and
+ * waits for its end.
+ */
+static uint8_t transfer(uint8_t *data, uint32_t count, uint8_t read) {
+	dmac_transfer_t dma = {
+		.width = DMAC_WIDTH_WORD,
+		.flow = read ? DMAC_PER2MEM : DMAC_MEM2PER,
+		.src_incr = !read,
+		.dst_incr = read,
+		.per = DMAC_PER_HSMCI
+	};
+	uint32_t timeout = BUSY_TIMEOUT;
+	uint32_t blocks, sr;
+
+	while (count > 0) {
+		blocks = (count < DMA_BLOCKS) ? count : DMA_BLOCKS;
+		dma.src = read ? (const volatile void *) &HSMCI->HSMCI_RDR : data;
+		dma.dst = read ? (volatile void *) data : &HSMCI->HSMCI_TDR;
+		dma.count = blocks * BLOCK_WORDS;
+		if (!dmac_start(card.channel, &dma, 0, 0)) {
+			return 0;
+		}
+		while (dmac_busy(card.channel)) {
+			if (PERIPH_REG(HSMCI->HSMCI_SR) & DATA_ERRORS) {
+				dmac_abort(card.channel);
+				return 0;
+			}
+		}
+		data += blocks * HSMCI_BLOCK_SIZE;
+		count -= blocks;
+	}
+	do {
+		sr = PERIPH_REG(HSMCI->HSMCI_SR);
+		if (--timeout == 0) {
+			return 0;
+		}
+	} while (!(sr & HSMCI_SR_XFRDONE));
+	return !(sr & DATA_ERRORS);
+}
+
+static uint8_t data_cmd(uint32_t cmd, uint32_t block, uint8_t *data,
+		uint32_t count, uint8_t read) {
+	uint32_t cmdr = HSMCI_CMDR_CMDNB(cmd) | HSMCI_CMDR_RSP_48 |
+			HSMCI_CMDR_MAXLAT | HSMCI_CMDR_TRCMD_START |
+			(read ? HSMCI_CMDR_TRDIR_READ : 0) |
+			((count > 1) ? HSMCI_CMDR_TRTYP_MULTI : HSMCI_CMDR_TRTYP_SINGLE);
+	uint8_t result;
+
+	if (stream.open || !region_valid(block, count) ||
+		((uint32_t) data & 3u)) {
+		return 0;
+	}
+	HSMCI->HSMCI_BLKR = HSMCI_BLKR_BCNT(count) |
+			HSMCI_BLKR_BLKLEN(HSMCI_BLOCK_SIZE);
+	HSMCI->HSMCI_DMA = HSMCI_DMA_DMAEN;
+	result = send_r1(cmdr, block_addr(block)) && transfer(data, count, read);
+	if (count > 1) {
+		result &= send_cmd(HSMCI_CMDR_CMDNB(CMD_STOP_TRANSMISSION) |
+				HSMCI_CMDR_RSP_R1B | HSMCI_CMDR_MAXLAT | HSMCI_CMDR_TRCMD_STOP,
+				0);
+	} else if (!read) {
+		result &= wait_not_busy();
+	}
+	HSMCI->HSMCI_DMA = 0;
+	return result;
+}
+
+uint8_t hsmci_read_blocks(uint32_t block, void *data, uint32_t count) {
+	return data_cmd((count > 1) ? CMD_READ_MULTIPLE : CMD_READ_SINGLE, block,
+			(uint8_t *) data, count, 1);
+}
+
+uint8_t hsmci_write_blocks(uint32_t block, const void *data, uint32_t count) {
+	return data_cmd((count > 1) ? CMD_WRITE_MULTIPLE : CMD_WRITE_SINGLE, block,
+			(uint8_t *) data, count, 0);
+}
+
+uint8_t hsmci_erase(uint32_t block, uint32_t count) {
+	uint32_t cmdr = HSMCI_CMDR_RSP_48 | HSMCI_CMDR_MAXLAT;
+
+	if (stream.open || !region_valid(block, count)) {
+		return 0;
+	}
+	return send_r1(cmdr | HSMCI_CMDR_CMDNB(CMD_ERASE_START),
+			block_addr(block)) &&
+			send_r1(cmdr | HSMCI_CMDR_CMDNB(CMD_ERASE_END),
+			block_addr(block + count - 1)) &&
+			send_cmd(HSMCI_CMDR_CMDNB(CMD_ERASE) | HSMCI_CMDR_RSP_R1B |
+			HSMCI_CMDR_MAXLAT, 0);
+}
+
+/*
+ * Starts the DMAC on the oldest buffer of the stream.
+ * Called with the interrupts disabled.
+ */
+static void stream_start_dma(void);
+
+static void stream_dma_done(uint32_t channel, void *arg) {
+	buf_t *buf = stream.queue[stream.tail & (HSMCI_STREAM_QUEUE - 1)];
+
+	(void) channel;
+	(void) arg;
+	stream.written += buf->length / HSMCI_BLOCK_SIZE;
+	stream.tail++;
+	stream.dma_busy = 0;
+	buf_release(buf);
+	if (stream.tail != stream.head) {
+		stream_start_dma();
+	}
+}
+
+static void stream_start_dma(void) {
+	buf_t *buf = stream.queue[stream.tail & (HSMCI_STREAM_QUEUE - 1)];
+	dmac_transfer_t dma = {
+		.src = buf_data(buf),
+		.dst = &HSMCI->HSMCI_TDR,
+		.count = buf->length / 4u,
+		.width = DMAC_WIDTH_WORD,
+		.flow = DMAC_MEM2PER,
+		.src_incr = 1,
+		.dst_incr = 0,
+		.per = DMAC_PER_HSMCI
+	};
+
+	stream.dma_busy = dmac_start(card.channel, &dma, stream_dma_done, 0);
+}
+
+uint8_t hsmci_stream_open(uint32_t block, uint32_t count) {
+	if (stream.open || !region_valid(block, count)) {
+		return 0;
+	}
+	// the card may erase the region ahead of the data
+	if (!send_app(HSMCI_CMDR_CMDNB(ACMD_SET_WR_BLK_ERASE) | HSMCI_CMDR_RSP_48 |
+			HSMCI_CMDR_MAXLAT, (count < 0x7FFFFFu) ? count : 0x7FFFFFu)) {
+		return 0;
+	}
+	// a block count of 0 runs until the stop command
+	HSMCI->HSMCI_BLKR = HSMCI_BLKR_BCNT(0) |
+			HSMCI_BLKR_BLKLEN(HSMCI_BLOCK_SIZE);
+	HSMCI->HSMCI_DMA = HSMCI_DMA_DMAEN;
+	if (!send_r1(HSMCI_CMDR_CMDNB(CMD_WRITE_MULTIPLE) | HSMCI_CMDR_RSP_48 |
+			HSMCI_CMDR_MAXLAT | HSMCI_CMDR_TRCMD_START |
+			HSMCI_CMDR_TRTYP_MULTI, block_addr(block))) {
+		HSMCI->HSMCI_DMA = 0;
+		return 0;
+	}
+	stream.head = 0;
+	stream.tail = 0;
+	stream.dma_busy = 0;
+	stream.next = block;
+	stream.end = block + count;
+	stream.written = 0;
+	stream.open = 1;
+	return 1;
+}
+
+uint8_t hsmci_stream_write(buf_t *buf) {
+	uint32_t blocks = buf->length / HSMCI_BLOCK_SIZE;
+	uint32_t primask;
+
+	if (buf->length == 0 || buf->length % HSMCI_BLOCK_SIZE ||
+		buf->length > HSMCI_STREAM_MAX_LENGTH || (buf->offset & 3u)) {
+		return 0;
+	}
+	primask = irq_save();
+	if (!stream.open || stream.head - stream.tail >= HSMCI_STREAM_QUEUE ||
+		blocks > stream.end - stream.next) {
+		irq_restore(primask);
+		return 0;
+	}
+	stream.queue[stream.head & (HSMCI_STREAM_QUEUE - 1)] = buf;
+	stream.head++;
+	stream.next += blocks;
+	if (!stream.dma_busy) {
+		stream_start_dma();
+	}
+	irq_restore(primask);
+	return 1;
+}
+
+uint32_t hsmci_stream_written(void) {
+	return stream.written;
+}
+
+uint8_t hsmci_stream_close(void) {
+	uint32_t timeout = BLOCK_TIMEOUT;
+	uint32_t sr = 0;
+	uint8_t result;
+
+	if (!stream.open) {
+		return 0;
+	}
+	// no more buffers are taken
+	stream.end = stream.next;
+	while (stream.tail != stream.head);
+	// the last block has left the FIFO, wait for its CRC status
+	while (!(PERIPH_REG(HSMCI->HSMCI_SR) & HSMCI_SR_FIFOEMPTY));
+	sr |= HSMCI->HSMCI_SR;
+	while (!(PERIPH_REG(HSMCI->HSMCI_SR) & HSMCI_SR_BLKE) && --timeout);
+	sr |= HSMCI->HSMCI_SR;
+	result = send_cmd(HSMCI_CMDR_CMDNB(CMD_STOP_TRANSMISSION) |
+			HSMCI_CMDR_RSP_R1B | HSMCI_CMDR_MAXLAT | HSMCI_CMDR_TRCMD_STOP, 0);
+	HSMCI->HSMCI_DMA = 0;
+	stream.open = 0;
+	return result && !(sr & DATA_ERRORS);
+}
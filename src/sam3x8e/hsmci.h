@@ -0,0 +1,264 @@
+/**
+ * @file hsmci.h
+ * @brief HSMCI - High Speed MultiMedia Card Interface, SD card driver
+ * @details Drives an SD card (SDSC, SDHC or SDXC) on slot A with the 4-bit
+ * bus at up to 25 MHz. The blocks of 512 bytes are moved by a channel of the
+ * DMAC, the HSMCI stops its clock when its FIFO runs empty or full, so the
+ * DMA never under- or overruns and a transfer can wait for the next buffer.
+ *
+ * hsmci_read_blocks() and hsmci_write_blocks() move any number of blocks
+ * with one multi-block command and wait for the end.
+ *
+ * The stream is for continuous logging: it writes to a contiguous region of
+ * blocks with one open-ended multi-block command, which the card handles
+ * far faster than single writes. The card is told the size of the region
+ * (ACMD23), so it can erase ahead, and the region can be erased before with
+ * hsmci_erase(). hsmci_stream_write() takes a buffer of the buf_pool, the
+ * DMAC sends it to the card and the buffer is released when it is done.
+ * There is one interrupt for each buffer, none for each block. It may be
+ * called from an interrupt handler, so the buffers of an ADC stream go to
+ * the card as they are filled:
+ * @code
+ *	static void adc_full(buf_t *buf, uint8_t result) {
+ *		if (!hsmci_stream_write(buf)) {
+ *			buf_release(buf);	// the card is behind, the block is lost
+ *		}
+ *	}
+ *
+ *	hsmci_stream_open(first_block, blocks);
+ *	buf_adc_stream_start(&pool, 2048, adc_full);	// 8 blocks a buffer
+ * @endcode
+ * A file system allocates a contiguous file and streams to its blocks.
+ *
+ * @pre The pins must be given to peripheral A with the PIO: MCCK (PA19),
+ * MCCDA (PA20) and MCDA0-3 (PA21-PA24), the data and command lines need
+ * pull-ups.
+ * @pre dmac_init() is called by hsmci_init().
+ * @date 14 October 2026
+ */
+
+#ifndef HSMCI_H_
+#define HSMCI_H_
+
+#include <inttypes.h>
+#include "periph.h"
+#include "buf_pool.h"
+
+/*
+ * Number of buffers the stream can hold, waiting to be written. Must be a
+ * power of 2.
+ */
+#ifndef HSMCI_STREAM_QUEUE
+#define HSMCI_STREAM_QUEUE		(8)
+#endif
+
+/// Bytes of a block
+#define HSMCI_BLOCK_SIZE		(512u)
+
+/// Most bytes of a stream buffer, one DMAC transfer of words
+#define HSMCI_STREAM_MAX_LENGTH	(31u * HSMCI_BLOCK_SIZE)
+
+///@cond
+// Pointer to registers of the HSMCI, base address 0x40000000
+#define HSMCI ((hsmci_reg_t *) PERIPH_ADDR(0x40000000U))
+
+// Control Register
+#define HSMCI_CR_MCIEN			(0x1u << 0)
+#define HSMCI_CR_MCIDIS			(0x1u << 1)
+#define HSMCI_CR_PWSDIS			(0x1u << 3)
+#define HSMCI_CR_SWRST			(0x1u << 7)
+
+// Mode Register
+#define HSMCI_MR_CLKDIV(x)		((x) & 0xFFu)
+#define HSMCI_MR_CLKDIV_MASK	(0xFFu)
+#define HSMCI_MR_RDPROOF		(0x1u << 11)
+#define HSMCI_MR_WRPROOF		(0x1u << 12)
+
+// Data and Completion Signal Timeout Registers, the longest time-out
+#define HSMCI_TIMEOUT_MAX		(0x7Fu)
+
+// SD/SDIO Card Register
+#define HSMCI_SDCR_SLOT_A		(0x0u << 0)
+#define HSMCI_SDCR_BUS_1BIT		(0x0u << 6)
+#define HSMCI_SDCR_BUS_4BIT		(0x2u << 6)
+
+// Command Register
+#define HSMCI_CMDR_CMDNB(x)		((x) & 0x3Fu)
+#define HSMCI_CMDR_RSP_NONE		(0x0u << 6)
+#define HSMCI_CMDR_RSP_48		(0x1u << 6)
+#define HSMCI_CMDR_RSP_136		(0x2u << 6)
+#define HSMCI_CMDR_RSP_R1B		(0x3u << 6)
+#define HSMCI_CMDR_RSP_MASK		(0x3u << 6)
+#define HSMCI_CMDR_SPCMD_INIT	(0x1u << 8)
+#define HSMCI_CMDR_MAXLAT		(0x1u << 12)
+#define HSMCI_CMDR_TRCMD_START	(0x1u << 16)
+#define HSMCI_CMDR_TRCMD_STOP	(0x2u << 16)
+#define HSMCI_CMDR_TRDIR_READ	(0x1u << 18)
+#define HSMCI_CMDR_TRTYP_SINGLE	(0x0u << 19)
+#define HSMCI_CMDR_TRTYP_MULTI	(0x1u << 19)
+
+// Block Register, a block count of 0 is an open-ended transfer
+#define HSMCI_BLKR_BCNT(x)		((x) & 0xFFFFu)
+#define HSMCI_BLKR_BLKLEN(x)	(((x) & 0xFFFFu) << 16)
+
+// Status Register
+#define HSMCI_SR_CMDRDY			(0x1u << 0)
+#define HSMCI_SR_BLKE			(0x1u << 3)
+#define HSMCI_SR_DTIP			(0x1u << 4)
+#define HSMCI_SR_NOTBUSY		(0x1u << 5)
+#define HSMCI_SR_RINDE			(0x1u << 16)
+#define HSMCI_SR_RDIRE			(0x1u << 17)
+#define HSMCI_SR_RCRCE			(0x1u << 18)
+#define HSMCI_SR_RENDE			(0x1u << 19)
+#define HSMCI_SR_RTOE			(0x1u << 20)
+#define HSMCI_SR_DCRCE			(0x1u << 21)
+#define HSMCI_SR_DTOE			(0x1u << 22)
+#define HSMCI_SR_CSTOE			(0x1u << 23)
+#define HSMCI_SR_FIFOEMPTY		(0x1u << 26)
+#define HSMCI_SR_XFRDONE		(0x1u << 27)
+#define HSMCI_SR_OVRE			(0x1u << 30)
+#define HSMCI_SR_UNRE			(0x1u << 31)
+
+// DMA Configuration Register
+#define HSMCI_DMA_DMAEN			(0x1u << 8)
+
+// Configuration Register
+#define HSMCI_CFG_FIFOMODE		(0x1u << 0)
+#define HSMCI_CFG_FERRCTRL		(0x1u << 4)
+
+/*
+ * Mapping of the HSMCI registers
+ * Base address: 0x40000000
+ */
+typedef struct hsmci_reg {
+	// Control Register, offset 0x0000
+	uint32_t HSMCI_CR;
+	// Mode Register, offset 0x0004
+	uint32_t HSMCI_MR;
+	// Data Timeout Register, offset 0x0008
+	uint32_t HSMCI_DTOR;
+	// SD/SDIO Card Register, offset 0x000C
+	uint32_t HSMCI_SDCR;
+	// Argument Register, offset 0x0010
+	uint32_t HSMCI_ARGR;
+	// Command Register, offset 0x0014
+	uint32_t HSMCI_CMDR;
+	// Block Register, offset 0x0018
+	uint32_t HSMCI_BLKR;
+	// Completion Signal Timeout Register, offset 0x001C
+	uint32_t HSMCI_CSTOR;
+	// Response Register, offset 0x0020, read 4 times for 136 bits
+	uint32_t HSMCI_RSPR[4];
+	// Receive Data Register, offset 0x0030
+	uint32_t HSMCI_RDR;
+	// Transmit Data Register, offset 0x0034
+	uint32_t HSMCI_TDR;
+	// reserved, offset 0x0038-0x003C
+	uint32_t reserved1[2];
+	// Status Register, offset 0x0040
+	uint32_t HSMCI_SR;
+	// Interrupt Enable Register, offset 0x0044
+	uint32_t HSMCI_IER;
+	// Interrupt Disable Register, offset 0x0048
+	uint32_t HSMCI_IDR;
+	// Interrupt Mask Register, offset 0x004C
+	uint32_t HSMCI_IMR;
+	// DMA Configuration Register, offset 0x0050
+	uint32_t HSMCI_DMA;
+	// Configuration Register, offset 0x0054
+	uint32_t HSMCI_CFG;
+	// reserved, offset 0x0058-0x00E0
+	uint32_t reserved2[35];
+	// Write Protection Mode Register, offset 0x00E4
+	uint32_t HSMCI_WPMR;
+	// Write Protection Status Register, offset 0x00E8
+	uint32_t HSMCI_WPSR;
+} hsmci_reg_t;
+///@endcond
+
+/**
+ * Starts the HSMCI and initializes the card in the slot: identifies it at
+ * 400 kHz, selects it, switches to the 4-bit bus and raises the clock to
+ * 25 MHz (or the fastest MCK allows).
+ * @return error (1 = SUCCESS, 0 = FAIL, no card, the card does not answer
+ * or no DMAC channel is free)
+ */
+uint8_t hsmci_init(void);
+
+/**
+ * Stops the HSMCI and releases its clock and DMAC channel. A stream that is
+ * open should be closed before.
+ */
+void hsmci_deinit(void);
+
+/**
+ * @return The number of blocks of the card, 0 if none is initialized.
+ */
+uint32_t hsmci_blocks(void);
+
+/**
+ * Reads blocks from the card.
+ * @param block The first block.
+ * @param data Where to put the data, word-aligned, count * 512 bytes.
+ * @param count The number of blocks (at least 1).
+ * @return error (1 = SUCCESS, 0 = FAIL, invalid parameters, the stream is
+ * open or a transfer error)
+ */
+uint8_t hsmci_read_blocks(uint32_t block, void *data, uint32_t count);
+
+/**
+ * Writes blocks to the card and waits until the card has taken them.
+ * @param block The first block.
+ * @param data The data, word-aligned, count * 512 bytes.
+ * @param count The number of blocks (at least 1).
+ * @return error (1 = SUCCESS, 0 = FAIL, invalid parameters, the stream is
+ * open or a transfer error)
+ */
+uint8_t hsmci_write_blocks(uint32_t block, const void *data, uint32_t count);
+
+/**
+ * Erases blocks, they read back as all 0 or all 1 depending on the card.
+ * Waits until the card is done, which can take seconds for a large region.
+ * @param block The first block.
+ * @param count The number of blocks (at least 1).
+ * @return error (1 = SUCCESS, 0 = FAIL)
+ */
+uint8_t hsmci_erase(uint32_t block, uint32_t count);
+
+/**
+ * Opens the stream on a region of blocks, it is written from its first
+ * block on.
+ * @param block The first block of the region.
+ * @param count The number of blocks in the region.
+ * @return error (1 = SUCCESS, 0 = FAIL, invalid region, a stream is
+ * already open or the card refused)
+ */
+uint8_t hsmci_stream_open(uint32_t block, uint32_t count);
+
+/**
+ * Appends the data of a buffer to the stream. The reference of the buffer
+ * is taken over on success, it is released when the data is handed to the
+ * card. May be called from an interrupt handler.
+ * @param buf The buffer, a multiple of 512 bytes of word-aligned data, up
+ * to HSMCI_STREAM_MAX_LENGTH.
+ * @return 1 if the buffer was queued, 0 if the stream is not open, its
+ * queue or region is full or the buffer is invalid (the caller keeps the
+ * reference).
+ */
+uint8_t hsmci_stream_write(buf_t *buf);
+
+/**
+ * @return The number of blocks handed to the card by the stream since it
+ * was opened.
+ */
+uint32_t hsmci_stream_written(void);
+
+/**
+ * Writes the buffers still queued and ends the write command of the
+ * stream.
+ * @return error (1 = SUCCESS, 0 = FAIL, a transfer error happened while
+ * the stream was open)
+ */
+uint8_t hsmci_stream_close(void);
+
+#endif
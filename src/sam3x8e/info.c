@@ -12,3 +12,83 @@ void info_send_kernel_version(void){
 	uart_write_str(KERNEL_INFO);
 	uart_write_str("\n\r");
 }
+
+#if (CFG_TASK_STATS_EN > 0) || (CFG_STK_PAINT_EN > 0)
+
+// Sends a number in decimal
+static void info_send_number(uint64_t value) {
+	char str[21];
+	uint8_t i = sizeof(str) - 1;
+
+	str[i] = '\0';
+	do {
+		str[--i] = '0' + (value % 10);
+		value /= 10;
+	} while (value > 0);
+	uart_write_str(&str[i]);
+}
+
+#endif
+
+#if CFG_STK_PAINT_EN > 0
+
+void info_send_stack_usage(void){
+	uint16_t used, size;
+	uint8_t i;
+
+	uart_write_str("\n\rtask used size\n\r");
+	// The user tasks and the idle task
+	for (i = 0; i < CFG_MAX_USER_TASKS + 1; i++) {
+		used = CoGetStackHighWater(i, &size);
+		if (used == 0) {
+			continue;
+		}
+		info_send_number(i);
+		uart_write_str(" ");
+		info_send_number(used);
+		uart_write_str(" ");
+		info_send_number(size);
+		uart_write_str("\n\r");
+	}
+}
+
+#endif
+
+#if CFG_TASK_STATS_EN > 0
+
+void info_send_task_stats(void){
+	U64 cycles[CFG_MAX_USER_TASKS + 1];
+	U32 switches[CFG_MAX_USER_TASKS + 1];
+	U32 preempts[CFG_MAX_USER_TASKS + 1];
+	uint8_t valid[CFG_MAX_USER_TASKS + 1];
+	U64 total = 0;
+	uint8_t i;
+
+	// The user tasks and the idle task, read first so the output itself
+	// is not counted
+	for (i = 0; i < CFG_MAX_USER_TASKS + 1; i++) {
+		valid[i] = (CoGetTaskStats(i, &cycles[i], &switches[i],
+				&preempts[i]) == E_OK);
+		if (valid[i]) {
+			total += cycles[i];
+		}
+	}
+	uart_write_str("\n\rtask cycles % switches preempts\n\r");
+	for (i = 0; i < CFG_MAX_USER_TASKS + 1; i++) {
+		if (!valid[i]) {
+			continue;
+		}
+		info_send_number(i);
+		uart_write_str(" ");
+		info_send_number(cycles[i]);
+		uart_write_str(" ");
+		info_send_number(total > 0 ? cycles[i] * 100 / total : 0);
+		uart_write_str(" ");
+		info_send_number(switches[i]);
+		uart_write_str(" ");
+		info_send_number(preempts[i]);
+		uart_write_str("\n\r");
+	}
+}
+
+#endif
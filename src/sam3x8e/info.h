@@ -13,6 +13,7 @@
 #define INFO_H_
 
 #include "sam3x8e/uart.h"
+#include "sam3x8e/rtos.h"
 
 /// The version output can be changed here
 #define KERNEL_INFO		"Kernel name: mahm3lib\n\rKernel version: release4"
@@ -22,4 +23,23 @@
  */
 void info_send_kernel_version(void);
 
+#if CFG_STK_PAINT_EN > 0
+/**
+ * This function will send a line for each task by means of the uart, with
+ * the most words of its stack it has used and the words of the stack
+ * (CoGetStackHighWater()). Task 0 is the idle task.
+ */
+void info_send_stack_usage(void);
+#endif
+
+#if CFG_TASK_STATS_EN > 0
+/**
+ * This function will send a line for each task by means of the uart, with
+ * the CPU cycles it has run and their share of all cycles, how often it has
+ * been switched in and how often it has been preempted (CoGetTaskStats()).
+ * Task 0 is the idle task.
+ */
+void info_send_task_stats(void);
+#endif
+
 #endif
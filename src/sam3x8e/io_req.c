@@ -0,0 +1,110 @@
+/*
+ * io_req.c
+ *
+ * Date:	14 October 2026
+ */
+
+#include "io_req.h"
+#include "periph.h"
+#include "irq.h"
+#if IO_REQ_COOS
+#include "rtos/CoOS.h"
+#endif
+
+void io_req_init(io_req_t *req, uint8_t flag, io_req_callback_t callback,
+		void *arg) {
+	req->state = IO_REQ_IDLE;
+	req->result = 0;
+	req->flag = flag;
+	req->callback = callback;
+	req->arg = arg;
+}
+
+uint8_t io_req_start(io_req_t *req) {
+	uint32_t primask = irq_save();
+
+	if (req->state == IO_REQ_BUSY) {
+		irq_restore(primask);
+		return 0;
+	}
+	req->state = IO_REQ_BUSY;
+	req->result = 0;
+	irq_restore(primask);
+#if IO_REQ_COOS
+	// a flag left set by the last completion must not end the next wait
+	if (req->flag != IO_REQ_NO_FLAG) {
+		CoClearFlag(req->flag);
+	}
+#endif
+	return 1;
+}
+
+void io_req_cancel(io_req_t *req) {
+	req->state = IO_REQ_IDLE;
+}
+
+void io_req_complete(io_req_t *req, uint8_t result) {
+	req->result = result;
+	req->state = IO_REQ_DONE;
+#if IO_REQ_COOS
+	if (req->flag != IO_REQ_NO_FLAG) {
+		isr_SetFlag(req->flag);
+	}
+#endif
+	if (req->callback) {
+		req->callback(req, req->arg);
+	}
+}
+
+uint8_t io_req_wait(io_req_t *req, uint32_t timeout) {
+	if (req->state == IO_REQ_IDLE) {
+		return 0;
+	}
+#if IO_REQ_COOS
+	if (req->state != IO_REQ_DONE && req->flag != IO_REQ_NO_FLAG) {
+		if (CoWaitForSingleFlag(req->flag, timeout) == E_TIMEOUT) {
+			return 0;
+		}
+	}
+#else
+	(void) timeout;
+#endif
+	// the state is set before the flag, so this only spins without a flag
+	while (req->state != IO_REQ_DONE);
+	return 1;
+}
+
+uint8_t io_req_wait_all(io_req_t *const *reqs, uint32_t count,
+		uint32_t timeout) {
+	uint32_t i;
+#if IO_REQ_COOS
+	uint32_t flags = 0;
+	StatusType err;
+#endif
+
+	for (i = 0; i < count; i++) {
+		if (reqs[i]->state == IO_REQ_IDLE) {
+			return 0;
+		}
+#if IO_REQ_COOS
+		if (reqs[i]->state != IO_REQ_DONE &&
+			reqs[i]->flag != IO_REQ_NO_FLAG) {
+			flags |= (1u << reqs[i]->flag);
+		}
+#endif
+	}
+#if IO_REQ_COOS
+	if (flags) {
+		(void) CoWaitForMultipleFlags(flags, OPT_WAIT_ALL, timeout, &err);
+		if (err == E_TIMEOUT) {
+			return 0;
+		}
+	}
+#else
+	(void) timeout;
+#endif
+	for (i = 0; i < count; i++) {
+		while (reqs[i]->state != IO_REQ_DONE);
+	}
+	return 1;
+}
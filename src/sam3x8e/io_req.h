@@ -0,0 +1,145 @@
+/**
+ * @file io_req.h
+ * @brief Completion of asynchronous driver operations
+ * @details An io_req_t is the completion of one operation started with a
+ * *_req() function of a driver: spi_transfer_req(), twi_master_read_req(),
+ * twi_master_write_req(), uart_write_dma_req(), adc_scan_req() and
+ * eefc_write_page_req(). The function returns as soon as the operation is
+ * started, the driver completes the request from its interrupt handler.
+ * The caller then either polls it with io_req_poll(), has its callback
+ * called, or waits with io_req_wait().
+ *
+ * A request with a CoOS event flag sets it when it completes, so a task
+ * waiting in io_req_wait() sleeps instead of spinning. A task can start
+ * several operations and sleep until all of them are done with
+ * io_req_wait_all(), which waits for their flags with
+ * CoWaitForMultipleFlags():
+ * @code
+ *	io_req_init(&spi_req, spi_flag, 0, 0);
+ *	io_req_init(&twi_req, twi_flag, 0, 0);
+ *	spi_transfer_req(SPI0, SPI_SELECTOR_0, tx, rx, len, &spi_req);
+ *	twi_master_read_req(TWI1, &packet, &twi_req);
+ *	io_req_wait_all(reqs, 2, 100);
+ * @endcode
+ *
+ * @pre CoOS delivery requires CFG_MAX_SERVICE_REQUEST > 0 and an event flag
+ * created with CoCreateFlag(1, 0) (auto reset) for each request. A request
+ * must not be started again before it is done.
+ * @date 14 October 2026
+ */
+
+#ifndef IO_REQ_H_
+#define IO_REQ_H_
+
+#include <inttypes.h>
+
+/*
+ * Set to 0 to build without the CoOS event flags, e.g. when the RTOS is not
+ * linked into the application.
+ */
+#ifndef IO_REQ_COOS
+#define IO_REQ_COOS			(1)
+#endif
+
+/// No event flag is set when the request is done.
+#define IO_REQ_NO_FLAG		(0xFFu)
+
+///@{
+/**
+ * State of a request.
+ */
+#define IO_REQ_IDLE			(0)	///< Not started
+#define IO_REQ_BUSY			(1)	///< Started, not done
+#define IO_REQ_DONE			(2)	///< Done, result is valid
+///@}
+
+typedef struct io_req io_req_t;
+
+/**
+ * Called from the interrupt handler of the driver when a request is done.
+ * @param req The request.
+ * @param arg The argument given to io_req_init().
+ */
+typedef void (*io_req_callback_t)(io_req_t *req, void *arg);
+
+/**
+ * A request, set up with io_req_init(). It must stay valid until it is
+ * done.
+ */
+struct io_req {
+	/** IO_REQ_IDLE, IO_REQ_BUSY or IO_REQ_DONE. */
+	volatile uint8_t state;
+	/** Result of the driver, 1 for success unless the driver tells more. */
+	volatile uint8_t result;
+	/** CoOS event flag set when done, or IO_REQ_NO_FLAG. */
+	uint8_t flag;
+	/** Called when done, or 0. */
+	io_req_callback_t callback;
+	/** Argument of the callback. */
+	void *arg;
+};
+
+/**
+ * Sets up a request.
+ * @param req The request.
+ * @param flag CoOS event flag set when it is done, or IO_REQ_NO_FLAG.
+ * @param callback Called when it is done, or 0.
+ * @param arg Argument of the callback.
+ */
+void io_req_init(io_req_t *req, uint8_t flag, io_req_callback_t callback,
+		void *arg);
+
+/**
+ * Marks a request busy, called by a driver before it starts the operation.
+ * The event flag of the request is cleared.
+ * @param req The request.
+ * @return error (1 = SUCCESS, 0 = FAIL, the request is busy)
+ */
+uint8_t io_req_start(io_req_t *req);
+
+/**
+ * Marks a request idle again, called by a driver when the operation could
+ * not be started after io_req_start().
+ * @param req The request.
+ */
+void io_req_cancel(io_req_t *req);
+
+/**
+ * Completes a request, called from the interrupt handler of a driver. The
+ * event flag is set and the callback called.
+ * @param req The request.
+ * @param result Result of the operation.
+ */
+void io_req_complete(io_req_t *req, uint8_t result);
+
+/**
+ * @param req The request.
+ * @return 1 if the request is done, otherwise 0.
+ */
+static inline uint8_t io_req_poll(const io_req_t *req) {
+	return req->state == IO_REQ_DONE;
+}
+
+/**
+ * Waits until a request is done. A task blocks on the event flag of the
+ * request, without a flag or before CoStartOS() it spins.
+ * @param req The request.
+ * @param timeout Ticks to wait for the flag, 0 to wait forever. Spinning
+ * does not time out.
+ * @return 1 if the request is done, 0 on timeout or if it was not started.
+ */
+uint8_t io_req_wait(io_req_t *req, uint32_t timeout);
+
+/**
+ * Waits until all the requests are done, see io_req_wait(). All of them
+ * must have an event flag for the task to block.
+ * @param reqs The requests.
+ * @param count Number of requests.
+ * @param timeout Ticks to wait for the flags, 0 to wait forever.
+ * @return 1 if all the requests are done, 0 on timeout or if one of them
+ * was not started.
+ */
+uint8_t io_req_wait_all(io_req_t *const *reqs, uint32_t count,
+		uint32_t timeout);
+
+#endif
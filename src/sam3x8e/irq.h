@@ -0,0 +1,62 @@
+/**
+ * @file irq.h
+ * @brief Critical sections of the drivers
+ * @details The state a driver shares with its interrupt handler is changed
+ * between irq_save() and irq_restore():
+ * @code
+ *	uint32_t primask = irq_save();
+ *	...
+ *	irq_restore(primask);
+ * @endcode
+ * irq_save() masks all the interrupts with PRIMASK and returns the mask it
+ * found, so the sections nest, also inside a critical section of CoOS.
+ *
+ * The drivers mask with PRIMASK even when CoOS masks with BASEPRI
+ * (CFG_MAX_SYSCALL_PRIO above 0). Their handlers do not need to call CoOS,
+ * e.g. the handlers of tc_timer and ctrl_loop, so they may run at a more
+ * urgent priority than CFG_MAX_SYSCALL_PRIO, which a BASEPRI section would
+ * not hold off. irq_restore() only writes PRIMASK and leaves the BASEPRI of
+ * the kernel as it was. Keep the sections to a few instructions, they delay
+ * the interrupts above CFG_MAX_SYSCALL_PRIO too.
+ *
+ * On the host there are no interrupts and both do nothing.
+ *
+ * @date 14 October 2026
+ */
+
+#ifndef IRQ_H_
+#define IRQ_H_
+
+#include <inttypes.h>
+#include "periph.h"
+
+#if PERIPH_HOST
+// No interrupts on the host
+static inline uint32_t irq_save(void) {
+	return 0;
+}
+
+static inline void irq_restore(uint32_t primask) {
+	(void) primask;
+}
+#else
+/**
+ * @brief Masks all the interrupts
+ * @return The PRIMASK to give to irq_restore()
+ */
+static inline uint32_t irq_save(void) {
+	uint32_t primask;
+	__asm volatile ("mrs %0, primask\n\tcpsid i" : "=r" (primask) :: "memory");
+	return primask;
+}
+
+/**
+ * @brief Restores the mask saved by irq_save()
+ * @param primask The return value of irq_save()
+ */
+static inline void irq_restore(uint32_t primask) {
+	__asm volatile ("msr primask, %0" :: "r" (primask) : "memory");
+}
+#endif
+
+#endif
@@ -0,0 +1,215 @@
+/*
+ * logger.c
+ *
+ * Date:	14 October 2026
+ */
+
+#include <stdarg.h>
+#include "logger.h"
+#include "crc.h"
+#include "uart.h"
+#include "rtos/CoOS.h"
+#include "irq.h"
+
+// Length of the longest formatted record
+#define LOGGER_LINE_LENGTH	(96)
+
+typedef struct {
+	const char *fmt;
+	uint32_t args[LOGGER_MAX_ARGS];
+} logger_record_t;
+
+static logger_record_t records[LOGGER_RECORDS];
+static volatile uint32_t head;		// next record to write
+static volatile uint32_t tail;		// next record to format
+static volatile uint32_t dropped;
+
+/*
+ * Producers can be both tasks and interrupt handlers, so the slot is taken
+ * with interrupts disabled. Only a few instructions are done in between.
+ */
+uint8_t logger_record(const char *fmt, uint32_t nargs, ...) {
+	logger_record_t *rec;
+	uint32_t primask, i;
+	va_list ap;
+
+	if (nargs > LOGGER_MAX_ARGS) {
+		nargs = LOGGER_MAX_ARGS;
+	}
+	primask = irq_save();
+	if (head - tail >= LOGGER_RECORDS) {
+		dropped++;
+		irq_restore(primask);
+		return 0;
+	}
+	rec = &records[head & (LOGGER_RECORDS - 1)];
+	rec->fmt = fmt;
+	va_start(ap, nargs);
+	for (i = 0; i < nargs; i++) {
+		rec->args[i] = va_arg(ap, uint32_t);
+	}
+	va_end(ap);
+	head++;
+	irq_restore(primask);
+	return 1;
+}
+
+/*
+ * Writes value in the given base into buf, backwards from the end.
+ * Returns a pointer to the first digit.
+ */
+static char *format_number(char *end, uint32_t value, uint32_t base,
+		uint8_t upper) {
+	const char *digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+
+	*--end = '\0';
+	do {
+		*--end = digits[value % base];
+		value /= base;
+	} while (value);
+	return end;
+}
+
+uint32_t logger_format(char *out, uint32_t size, const char *fmt,
+		const uint32_t *args) {
+	char number[12];
+	const char *str;
+	uint32_t len = 0, arg = 0, width, n;
+	char pad, negative;
+
+	if (size == 0) {
+		return 0;
+	}
+	while (*fmt && len < size - 1) {
+		if (*fmt != '%') {
+			out[len++] = *fmt++;
+			continue;
+		}
+		fmt++;
+		pad = ' ';
+		if (*fmt == '0') {
+			pad = '0';
+			fmt++;
+		}
+		width = 0;
+		while (*fmt >= '0' && *fmt <= '9') {
+			width = width * 10 + (uint32_t) (*fmt++ - '0');
+		}
+		negative = 0;
+		switch (*fmt) {
+		case 'd':
+		case 'i':
+			if ((int32_t) args[arg] < 0) {
+				negative = 1;
+				str = format_number(number + sizeof(number),
+						(uint32_t) -(int32_t) args[arg], 10, 0);
+			} else {
+				str = format_number(number + sizeof(number), args[arg], 10, 0);
+			}
+			break;
+		case 'u':
+			str = format_number(number + sizeof(number), args[arg], 10, 0);
+			break;
+		case 'x':
+		case 'p':
+			str = format_number(number + sizeof(number), args[arg], 16, 0);
+			break;
+		case 'X':
+			str = format_number(number + sizeof(number), args[arg], 16, 1);
+			break;
+		case 'c':
+			number[0] = (char) args[arg];
+			number[1] = '\0';
+			str = number;
+			break;
+		case 's':
+			str = args[arg] ? (const char *) args[arg] : "(null)";
+			break;
+		case '%':
+			out[len++] = '%';
+			fmt++;
+			continue;
+		default:
+			// unknown conversion, stop here
+			out[len] = '\0';
+			return len;
+		}
+		fmt++;
+		if (arg < LOGGER_MAX_ARGS - 1) {
+			arg++;
+		}
+
+		// padding, a '-' goes before zeros but after spaces
+		for (n = 0; str[n]; n++);
+		n += negative;
+		if (negative && pad == '0' && len < size - 1) {
+			out[len++] = '-';
+			negative = 0;
+		}
+		while (n < width && len < size - 1) {
+			out[len++] = pad;
+			n++;
+		}
+		if (negative && len < size - 1) {
+			out[len++] = '-';
+		}
+		while (*str && len < size - 1) {
+			out[len++] = *str++;
+		}
+	}
+	out[len] = '\0';
+	return len;
+}
+
+uint32_t logger_append_crc(char *line, uint32_t size) {
+	static const char hex[] = "0123456789ABCDEF";
+	uint32_t len, end, crc, i;
+
+	for (len = 0; line[len]; len++);
+	if (len + LOGGER_CRC_LENGTH >= size) {
+		return len;
+	}
+	for (end = len; end > 0 && (line[end - 1] == '\r' ||
+			line[end - 1] == '\n'); end--);
+	crc = crc_compute(&crc16_ccitt, line, end);
+	// move the line end behind the CRC, terminator included
+	for (i = len + 1; i > end; i--) {
+		line[i - 1 + LOGGER_CRC_LENGTH] = line[i - 1];
+	}
+	line[end] = '*';
+	for (i = 0; i < 4; i++) {
+		line[end + 4 - i] = hex[(crc >> (4 * i)) & 0xFu];
+	}
+	return len + LOGGER_CRC_LENGTH;
+}
+
+uint32_t logger_flush(void) {
+	char line[LOGGER_LINE_LENGTH + LOGGER_CRC_LENGTH];
+	logger_record_t rec;
+	uint32_t count = 0;
+
+	while (tail != head) {
+		// copy first, the slot is free again when tail moves
+		rec = records[tail & (LOGGER_RECORDS - 1)];
+		tail++;
+		logger_format(line, LOGGER_LINE_LENGTH, rec.fmt, rec.args);
+#if LOGGER_CRC
+		(void) logger_append_crc(line, sizeof(line));
+#endif
+		LOGGER_WRITE(line);
+		count++;
+	}
+	return count;
+}
+
+uint32_t logger_dropped(void) {
+	return dropped;
+}
+
+void logger_task(void *pdata) {
+	(void) pdata;
+	for (;;) {
+		logger_flush();
+		CoTickDelay(LOGGER_TASK_PERIOD);
+	}
+}
@@ -0,0 +1,117 @@
+/**
+ * @file logger.h
+ * @brief Deferred formatted logging to the UART
+ * @details The caller of LOG() only stores the pointer to the format string
+ * and the raw arguments in a ring buffer, which takes a few microseconds
+ * and no stack for a string buffer. The formatting and the output to the
+ * UART is done later by logger_flush(), normally from a low priority CoOS
+ * task (logger_task()).
+ *
+ * Since only pointers are stored, the format string and all strings given
+ * as %s arguments must still exist when the record is formatted, e.g.
+ * string literals. Every argument is stored as 32 bits.
+ *
+ * Supported conversions: %d %i %u %x %X %c %s %p and %%, with an optional
+ * '0' flag and a field width, e.g. %08x.
+ *
+ * LOG() can be called from tasks and interrupt handlers. When the buffer
+ * is full new records are dropped and counted, see logger_dropped().
+ *
+ * @pre The user must initialize and configure the UART.
+ * @date 14 October 2026
+ */
+
+#ifndef LOGGER_H_
+#define LOGGER_H_
+
+#include <inttypes.h>
+
+/// Number of records in the ring buffer, must be a power of 2.
+#ifndef LOGGER_RECORDS
+#define LOGGER_RECORDS		(32)
+#endif
+
+/// Maximum number of arguments of a record.
+#define LOGGER_MAX_ARGS		(4)
+
+/// Ticks between two flushes in logger_task().
+#ifndef LOGGER_TASK_PERIOD
+#define LOGGER_TASK_PERIOD	(10)
+#endif
+
+/// Function used to output the formatted strings.
+#ifndef LOGGER_WRITE
+#define LOGGER_WRITE(str)	uart_write_str(str)
+#endif
+
+/// 1 to end each written line with its CRC-16, see logger_append_crc().
+#ifndef LOGGER_CRC
+#define LOGGER_CRC			(0)
+#endif
+
+/// Characters added by logger_append_crc().
+#define LOGGER_CRC_LENGTH	(5)
+
+///@cond
+#define LOGGER_NARGS_(_0, _1, _2, _3, _4, n, ...)	n
+#define LOGGER_NARGS(...) \
+	LOGGER_NARGS_(0, ##__VA_ARGS__, 4, 3, 2, 1, 0)
+///@endcond
+
+/**
+ * Logs a message with up to four arguments, e.g.
+ * LOG("adc %u: %d\n\r", channel, value);
+ */
+#define LOG(fmt, ...) \
+	logger_record((fmt), LOGGER_NARGS(__VA_ARGS__), ##__VA_ARGS__)
+
+/**
+ * Stores a record, use LOG() instead.
+ * @param fmt The format string.
+ * @param nargs Number of arguments (0-4).
+ * @return 1 if the record was stored, 0 if the buffer was full.
+ */
+uint8_t logger_record(const char *fmt, uint32_t nargs, ...);
+
+/**
+ * Formats and writes all stored records.
+ * @return Number of records written.
+ */
+uint32_t logger_flush(void);
+
+/**
+ * Formats a string into a buffer, with the same conversions as LOG().
+ * @param out Where to put the string, always terminated.
+ * @param size Size of out.
+ * @param fmt The format string.
+ * @param args The arguments.
+ * @return Length of the string.
+ */
+uint32_t logger_format(char *out, uint32_t size, const char *fmt,
+		const uint32_t *args);
+
+/**
+ * Adds the CRC-16/CCITT-FALSE (crc16_ccitt of crc.h) of a line as '*' and
+ * four upper-case hex digits, before the carriage returns and line feeds it
+ * ends with. The receiver drops the lines whose CRC doesn't match, e.g.
+ * "adc 3: 127*C12E\n\r" (the CRC covers "adc 3: 127").
+ * @param line The line, terminated.
+ * @param size Size of line, the CRC is not added if it doesn't fit.
+ * @return Length of the line.
+ */
+uint32_t logger_append_crc(char *line, uint32_t size);
+
+/**
+ * @return Number of records dropped because the buffer was full.
+ */
+uint32_t logger_dropped(void);
+
+/**
+ * CoOS task that flushes the log every LOGGER_TASK_PERIOD ticks. Create it
+ * with a low priority, e.g.
+ * CoCreateTask(logger_task, 0, 60, &stack[SIZE - 1], SIZE);
+ * @param pdata Not used.
+ */
+void logger_task(void *pdata);
+
+#endif /* LOGGER_H_ */
@@ -10,6 +10,33 @@
 */
 
 #include <sam3x8e/mux_shield.h>
+#include <sam3x8e/delay.h>
+
+// ADC channels of the three multiplexes
+#define MUX_ADC_MASK	((0x1u << MUX_ADC_0) | (0x1u << MUX_ADC_1) | \
+		(0x1u << MUX_ADC_2))
+
+/*
+ * Select pin levels on both ports for a channel, so only one masked write
+ * per port is needed to select it.
+ */
+#define MUX_S_LEVELS_0(channel)	((((channel) >> 3) & 1u) << MUX_S3 | \
+		(((channel) >> 2) & 1u) << MUX_S2 | (((channel) >> 1) & 1u) << MUX_S1)
+#define MUX_S_LEVELS_1(channel)	(((channel) & 1u) << MUX_S0)
+
+// The clock of the ADC is acquired by the first ADC_INPUT mode
+static uint8_t adc_clock_acquired;
+
+static void select_channel(uint32_t channel) {
+	/*
+	 * Only pins enabled in OWER are written through ODSR, the other enabled
+	 * pins (e.g. a TFT bus on the same port) keep their levels.
+	 */
+	MUX_S_PORT_0->PIO_ODSR = (MUX_S_PORT_0->PIO_ODSR & ~MUX_S_MASK_0) |
+			MUX_S_LEVELS_0(channel);
+	MUX_S_PORT_1->PIO_ODSR = (MUX_S_PORT_1->PIO_ODSR & ~MUX_S_MASK_1) |
+			MUX_S_LEVELS_1(channel);
+}
 
 void mux_shield_init(void) {
 	// Configure bit/channel select pins
@@ -23,26 +50,30 @@ void mux_shield_init(void) {
 	pio_set_pin(MUX_S_PORT_0, MUX_S2, 0); // S2, Digital pin 4
 	pio_set_pin(MUX_S_PORT_0, MUX_S1, 0); // S1, Digital pin 3
 	pio_set_pin(MUX_S_PORT_1, MUX_S0, 0); // S0, Digital pin 2
+
+	// Let the select pins be written through ODSR
+	MUX_S_PORT_0->PIO_OWER = MUX_S_MASK_0;
+	MUX_S_PORT_1->PIO_OWER = MUX_S_MASK_1;
 }
 
 void mux_shield_set_channel(uint32_t channel) {
-	if (channel > 0 && channel < 15) {
-		pio_set_pin(MUX_S_PORT_0, MUX_S3, (channel & 8)); // S3, Digital pin 5
-		pio_set_pin(MUX_S_PORT_0, MUX_S2, (channel & 4)); // S2, Digital pin 4
-		pio_set_pin(MUX_S_PORT_0, MUX_S1, (channel & 2)); // S1, Digital pin 3
-		pio_set_pin(MUX_S_PORT_1, MUX_S0, (channel & 1)); // S0, Digital pin 2
+	if (channel < MUX_CHANNELS) {
+		select_channel(channel);
 	}
 }
 
 void mux_shield_set_mode(uint32_t mux, uint32_t mode) {
-	if (mode == 1) {
+	if (mode == DIGITAL_OUTPUT) {
 		pio_conf_pin(MUX_PORT, mux, 0, 0); // Set multiplex chosen as output
 		pio_set_pin(MUX_PORT, mux, 1); // Set multiplex data pin as HIGH, for default behavior
-	} else if (mode == 2) {
+	} else if (mode == DIGITAL_INPUT) {
 		pio_conf_pin(MUX_PORT, mux, 1, 1); // Set multiplex chosen as input, pullup on
-	} else if (mode == 3) {
-		// Enable Peripheral clock for ADC
-		pmc_enable_peripheral_clock(37);
+	} else if (mode == ADC_INPUT) {
+		// Acquire the Peripheral clock for ADC, once for all channels
+		if (!adc_clock_acquired) {
+			pmc_acquire_peripheral_clock(ID_ADC);
+			adc_clock_acquired = 1;
+		}
 
 		// Initialize the ADC
 		adc_settings_t adc_settings = { .startup_time = 0, .prescaler = 0 };
@@ -89,3 +120,19 @@ uint32_t mux_shield_read_analog_datapin(uint32_t mux) {
 	}
 }
 
+void mux_shield_scan(uint16_t out[MUX_COUNT][MUX_CHANNELS]) {
+	uint32_t channel;
+
+	ADC->ADC_CHER = MUX_ADC_MASK;
+	for (channel = 0; channel < MUX_CHANNELS; channel++) {
+		select_channel(channel);
+		delay_micros(MUX_SHIELD_SETTLE_MICROS);
+		// one start converts all three, EOC is cleared by reading CDR
+		adc_start();
+		while ((PERIPH_REG(ADC->ADC_ISR) & MUX_ADC_MASK) != MUX_ADC_MASK) {
+		}
+		out[0][channel] = ADC->ADC_CDR[MUX_ADC_0];
+		out[1][channel] = ADC->ADC_CDR[MUX_ADC_1];
+		out[2][channel] = ADC->ADC_CDR[MUX_ADC_2];
+	}
+}
@@ -60,8 +60,28 @@
 #define MUX_S1 				(28)
 #define MUX_S2 				(26)
 #define MUX_S3 				(25)
+#define MUX_S_MASK_0		((0x1u << MUX_S3) | (0x1u << MUX_S2) | (0x1u << MUX_S1))
+#define MUX_S_MASK_1		(0x1u << MUX_S0)
 ///@endcond
 
+/**
+ * Number of channels of each multiplex.
+ */
+#define MUX_CHANNELS		(16)
+
+/**
+ * Number of multiplexes on the shield.
+ */
+#define MUX_COUNT			(3)
+
+/**
+ * Time in microseconds for the multiplexes and the ADC inputs to settle
+ * after a new channel has been selected.
+ */
+#ifndef MUX_SHIELD_SETTLE_MICROS
+#define MUX_SHIELD_SETTLE_MICROS	(2)
+#endif
+
 /**
  * Initializes the multiplex shield
  */
@@ -109,4 +129,16 @@ uint32_t mux_shield_read_datapin(uint32_t mux);
  */
 uint32_t mux_shield_read_analog_datapin(uint32_t mux);
 
+/**
+ * Reads all 48 analog inputs of the shield. For each of the 16 channels the
+ * select pins are written with one masked write per port, the inputs are
+ * given MUX_SHIELD_SETTLE_MICROS to settle and the three multiplexes are
+ * converted with one ADC start.
+ *
+ * @pre The ADC must be initialized (e.g. with mux_shield_set_mode() and
+ * ADC_INPUT) without a hardware trigger or a user sequence.
+ * @param out The values, out[multiplex][channel].
+ */
+void mux_shield_scan(uint16_t out[MUX_COUNT][MUX_CHANNELS]);
+
 #endif /* SAM3X8E_MUX_SHIELD_H_ */
@@ -0,0 +1,182 @@
+/**
+ * @file pdc.h
+ * @brief PDC - Peripheral DMA Controller
+ * @details The UART, the USARTs, the TWIs, the ADC, the DACC, the PWM and the
+ * SSC have a PDC channel each, its registers are at offset 0x100 of the
+ * registers of the peripheral. The functions here are the common handling
+ * of these channels, the drivers take the pdc_reg_t of their peripheral with
+ * PDC_OF():
+ * @code
+ *	pdc_rx_start_ping_pong(PDC_OF(ADC), half0, half1, count);
+ * @endcode
+ *
+ * Each direction has a current and a next buffer. When the current buffer
+ * is done the PDC moves on to the next buffer, the peripheral flags ENDRX or
+ * ENDTX and the driver queues another next buffer with pdc_rx_next() or
+ * pdc_tx_next(), which gives ping-pong buffering without a gap. RXBUFF and
+ * TXBUFE are flagged when both are done.
+ *
+ * The SPI has no PDC channel, it uses the DMA Controller of dmac.h.
+ *
+ * @date 14 October 2026
+ */
+
+#ifndef PDC_H_
+#define PDC_H_
+
+#include <inttypes.h>
+
+///@cond
+// Offset of the PDC registers in the registers of a peripheral
+#define PDC_OFFSET				(0x100u)
+///@endcond
+
+/**
+ * The PDC channel of a peripheral.
+ * @param periph Pointer to the registers of the peripheral, e.g. UART.
+ */
+#define PDC_OF(periph)		((pdc_reg_t *) ((uintptr_t) (periph) + PDC_OFFSET))
+
+///@{
+/**
+ * Masks for PERIPH_PTCR and PERIPH_PTSR
+ */
+#define PDC_PTCR_RXTEN			(1u << 0)
+#define PDC_PTCR_RXTDIS			(1u << 1)
+#define PDC_PTCR_TXTEN			(1u << 8)
+#define PDC_PTCR_TXTDIS			(1u << 9)
+///@}
+
+/// Largest count of one buffer
+#define PDC_MAX_COUNT			(0xFFFFu)
+
+/**
+ * Mapping of the PDC registers of a peripheral.
+ */
+typedef struct pdc_reg {
+	uint32_t PERIPH_RPR;	///< 0x100, Receive Pointer Register
+	uint32_t PERIPH_RCR;	///< 0x104, Receive Counter Register
+	uint32_t PERIPH_TPR;	///< 0x108, Transmit Pointer Register
+	uint32_t PERIPH_TCR;	///< 0x10C, Transmit Counter Register
+	uint32_t PERIPH_RNPR;	///< 0x110, Receive Next Pointer Register
+	uint32_t PERIPH_RNCR;	///< 0x114, Receive Next Counter Register
+	uint32_t PERIPH_TNPR;	///< 0x118, Transmit Next Pointer Register
+	uint32_t PERIPH_TNCR;	///< 0x11C, Transmit Next Counter Register
+	uint32_t PERIPH_PTCR;	///< 0x120, Transfer Control Register
+	uint32_t PERIPH_PTSR;	///< 0x124, Transfer Status Register
+} pdc_reg_t;
+
+/**
+ * Starts receiving into one buffer.
+ * @param pdc The PDC channel.
+ * @param buf The buffer.
+ * @param count Number of data items of the peripheral (1-65535).
+ */
+static inline void pdc_rx_start(pdc_reg_t *pdc, void *buf, uint32_t count) {
+	pdc->PERIPH_RPR = (uint32_t) buf;
+	pdc->PERIPH_RCR = count;
+	pdc->PERIPH_PTCR = PDC_PTCR_RXTEN;
+}
+
+/**
+ * Starts receiving into buf0, then into buf1. Both are set before the
+ * channel is enabled, so no data item is lost between the two.
+ * @param pdc The PDC channel.
+ * @param buf0 The first buffer.
+ * @param buf1 The second buffer.
+ * @param count Number of data items of each buffer (1-65535).
+ */
+static inline void pdc_rx_start_ping_pong(pdc_reg_t *pdc, void *buf0,
+		void *buf1, uint32_t count) {
+	pdc->PERIPH_RPR = (uint32_t) buf0;
+	pdc->PERIPH_RCR = count;
+	pdc->PERIPH_RNPR = (uint32_t) buf1;
+	pdc->PERIPH_RNCR = count;
+	pdc->PERIPH_PTCR = PDC_PTCR_RXTEN;
+}
+
+/**
+ * Queues the next buffer to receive into.
+ * @param pdc The PDC channel.
+ * @param buf The buffer.
+ * @param count Number of data items (1-65535).
+ */
+static inline void pdc_rx_next(pdc_reg_t *pdc, void *buf, uint32_t count) {
+	pdc->PERIPH_RNPR = (uint32_t) buf;
+	pdc->PERIPH_RNCR = count;
+}
+
+/**
+ * Stops receiving.
+ * @param pdc The PDC channel.
+ */
+static inline void pdc_rx_stop(pdc_reg_t *pdc) {
+	pdc->PERIPH_PTCR = PDC_PTCR_RXTDIS;
+}
+
+/**
+ * @param pdc The PDC channel.
+ * @return The address the next data item is received at.
+ */
+static inline uint32_t pdc_rx_position(pdc_reg_t *pdc) {
+	return pdc->PERIPH_RPR;
+}
+
+/**
+ * Stops receiving and sending.
+ * @param pdc The PDC channel.
+ */
+static inline void pdc_stop(pdc_reg_t *pdc) {
+	pdc->PERIPH_PTCR = PDC_PTCR_RXTDIS | PDC_PTCR_TXTDIS;
+}
+
+/**
+ * Starts sending one buffer.
+ * @param pdc The PDC channel.
+ * @param buf The buffer.
+ * @param count Number of data items of the peripheral (1-65535).
+ */
+static inline void pdc_tx_start(pdc_reg_t *pdc, const void *buf,
+		uint32_t count) {
+	pdc->PERIPH_TPR = (uint32_t) buf;
+	pdc->PERIPH_TCR = count;
+	pdc->PERIPH_PTCR = PDC_PTCR_TXTEN;
+}
+
+/**
+ * Starts sending buf0, then buf1, see pdc_rx_start_ping_pong().
+ * @param pdc The PDC channel.
+ * @param buf0 The first buffer.
+ * @param buf1 The second buffer.
+ * @param count Number of data items of each buffer (1-65535).
+ */
+static inline void pdc_tx_start_ping_pong(pdc_reg_t *pdc, const void *buf0,
+		const void *buf1, uint32_t count) {
+	pdc->PERIPH_TPR = (uint32_t) buf0;
+	pdc->PERIPH_TCR = count;
+	pdc->PERIPH_TNPR = (uint32_t) buf1;
+	pdc->PERIPH_TNCR = count;
+	pdc->PERIPH_PTCR = PDC_PTCR_TXTEN;
+}
+
+/**
+ * Queues the next buffer to send.
+ * @param pdc The PDC channel.
+ * @param buf The buffer.
+ * @param count Number of data items (1-65535).
+ */
+static inline void pdc_tx_next(pdc_reg_t *pdc, const void *buf,
+		uint32_t count) {
+	pdc->PERIPH_TNPR = (uint32_t) buf;
+	pdc->PERIPH_TNCR = count;
+}
+
+/**
+ * Stops sending.
+ * @param pdc The PDC channel.
+ */
+static inline void pdc_tx_stop(pdc_reg_t *pdc) {
+	pdc->PERIPH_PTCR = PDC_PTCR_TXTDIS;
+}
+
+#endif
@@ -0,0 +1,26 @@
+/*
+ * periph.c
+ *
+ * Date:	14 October 2026
+ */
+
+#include "periph.h"
+
+#if PERIPH_HOST
+
+#include <string.h>
+#include "pmc.h"
+
+volatile uint32_t periph_host_regs[PERIPH_SIZE / 4];
+volatile uint32_t periph_host_scs[PERIPH_SCS_SIZE / 4];
+
+void periph_host_reset(void) {
+	memset((void *) periph_host_regs, 0, sizeof(periph_host_regs));
+	memset((void *) periph_host_scs, 0, sizeof(periph_host_scs));
+
+	// The oscillators, the PLL and the master clock are always ready
+	PMC->PMC_SR = PMC_SR_MOSCXTS | PMC_SR_LOCKA | PMC_SR_MCKRDY |
+			PMC_SR_MOSCSELS | PMC_SR_MOSCRCS;
+}
+
+#endif
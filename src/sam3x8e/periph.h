@@ -0,0 +1,102 @@
+/**
+ * @file periph.h
+ * @brief Peripheral addresses, on target or on a host
+ * @details All the base addresses of the peripherals and of the system
+ * control space (NVIC, SysTick, SCB, DWT) are given with PERIPH_ADDR(). On
+ * target it is the address itself. With PERIPH_HOST defined to 1 it is the
+ * address of the same offset in a RAM image of the registers instead, so the
+ * drivers, the data structures of CoOS and the tests can be compiled, run and
+ * profiled on a Linux host:
+ * @code
+ *	gcc -m32 -std=gnu99 -O2 -DPERIPH_HOST=1 -I src -I src/sam3x8e ...
+ * @endcode
+ * With PERIPH_HOST, periph.c holds the RAM images and rtos/port_host.c takes
+ * the place of rtos/port.c. Leave the .s files and the startup code out. The
+ * drivers and CoOS keep pointers in 32 bits (e.g. the PDC registers and the
+ * kernel heap), so the host build must be 32 bit.
+ *
+ * The RAM images only hold what was written to them, nothing in them changes
+ * by itself. periph_host_reset() sets the status bits the clock setup waits
+ * for, a test sets the other flags with PERIPH_HOST_REG() before a driver
+ * polls them. The cycle counter of the DWT does not count either, so on
+ * the host the delays spin until a test advances it and the cycle counts of
+ * the benchmarks are meaningless.
+ *
+ * @date 14 October 2026
+ */
+
+#ifndef PERIPH_H_
+#define PERIPH_H_
+
+#include <inttypes.h>
+
+/*
+ * Set to 1 to run the drivers on a host, against the RAM images of the
+ * registers.
+ */
+#ifndef PERIPH_HOST
+#define PERIPH_HOST		(0)
+#endif
+
+///@cond
+// The peripherals, 0x40000000 to 0x400FFFFF
+#define PERIPH_BASE				(0x40000000u)
+#define PERIPH_SIZE				(0x00100000u)
+// The system control space and the DWT, 0xE0000000 to 0xE000FFFF
+#define PERIPH_SCS_BASE			(0xE0000000u)
+#define PERIPH_SCS_SIZE			(0x00010000u)
+///@endcond
+
+#if PERIPH_HOST
+
+/// RAM image of the peripheral registers
+extern volatile uint32_t periph_host_regs[PERIPH_SIZE / 4];
+
+/// RAM image of the system control space
+extern volatile uint32_t periph_host_scs[PERIPH_SCS_SIZE / 4];
+
+/**
+ * Address of a register, in the RAM images.
+ * @param addr The address of the register on target.
+ */
+#define PERIPH_ADDR(addr)	((uintptr_t) ((addr) >= PERIPH_SCS_BASE ?		\
+		&periph_host_scs[((addr) - PERIPH_SCS_BASE) >> 2] :					\
+		&periph_host_regs[((addr) - PERIPH_BASE) >> 2]))
+
+/**
+ * The RAM image of a register, to set or check it from a test.
+ * @param addr The address of the register on target.
+ */
+#define PERIPH_HOST_REG(addr)	(*((volatile uint32_t *) PERIPH_ADDR(addr)))
+
+/**
+ * Clear the RAM images, then set the status bits the clock setup of the PMC
+ * waits for.
+ */
+void periph_host_reset(void);
+
+#else
+
+/**
+ * Address of a register.
+ * @param addr The address of the register.
+ */
+#define PERIPH_ADDR(addr)	(addr)
+
+#endif
+
+/**
+ * A field of a register struct, accessed as volatile. The fields of the
+ * register structs are not volatile, so a read whose value is not used (to
+ * clear a status register), a poll of a flag or stores in a row must go
+ * through this, or the compiler may drop or merge them:
+ * @code
+ *	(void) PERIPH_REG(port->PIO_ISR);
+ *	while (!(PERIPH_REG(UART->UART_SR) & UART_SR_TXEMPTY)) {
+ *	}
+ * @endcode
+ * @param reg The field, e.g. port->PIO_ISR.
+ */
+#define PERIPH_REG(reg)		(*((volatile uint32_t *) &(reg)))
+
+#endif
@@ -11,6 +11,7 @@
 */
 
 #include "pio.h"
+#include "bitband.h"
 
 /*
  * This register can only be written if the WPEN bit is cleared in
@@ -93,18 +94,108 @@ uint32_t pio_read_port(pio_reg_t *port) {
 
 uint8_t pio_conf_pin_to_peripheral(pio_reg_t *port, uint32_t periph,
 		uint8_t pin_number) {
-	// Disable interrupts on the pin
-	port->PIO_IDR |= (0x1U << pin_number);
-
-	// The pin will be set to peripheral B
-	if (periph == PIO_PERIPH_B) { // 0 is peripheral A and 1 is B
-		// Set to peripheral B
-		port->PIO_ABSR |= (0x1U << pin_number);
-	} else if (periph == PIO_PERIPH_A) {
-		// Clear for peripheral A
-		port->PIO_ABSR &= ~(0x1U << pin_number);
+	// Disable interrupts on the pin, IDR and PDR are write-only
+	port->PIO_IDR = (0x1U << pin_number);
+
+	// Select the peripheral with one store, the other pins keep theirs
+	if (periph == PIO_PERIPH_B || periph == PIO_PERIPH_A) {
+		// 0 is peripheral A and 1 is B
+		bitband_write(&port->PIO_ABSR, pin_number, periph == PIO_PERIPH_B);
 	}
 	// The pin will be set in peripheral mode (not controllable by PIO)
-	port->PIO_PDR |= (0x1U << pin_number);
+	port->PIO_PDR = (0x1U << pin_number);
+	return 1;
+}
+
+/*
+ * Masks of one port, collected from a pio_pin_cfg_t table.
+ */
+typedef struct {
+	uint32_t all;		// every listed pin
+	uint32_t output;
+	uint32_t periph;
+	uint32_t periph_b;
+	uint32_t pullup;
+	uint32_t high;
+	uint32_t open_drain;
+	uint32_t filter;
+} pio_cfg_masks_t;
+
+uint8_t pio_apply_config(const pio_pin_cfg_t *table, size_t n) {
+	pio_cfg_masks_t masks[6] = {{0}};
+	pio_cfg_masks_t *m;
+	pio_reg_t *port;
+	uint32_t bit, index;
+	size_t i;
+
+	// collect the masks of every port
+	for (i = 0; i < n; i++) {
+		index = ((uint32_t) table[i].port - (uint32_t) PIOA) / 0x200u;
+		if ((uint32_t) table[i].port < (uint32_t) PIOA || index > 5 ||
+			table[i].pin > 31 || table[i].mode > PIO_CFG_PERIPH_B) {
+			return 0;
+		}
+		m = &masks[index];
+		bit = (0x1u << table[i].pin);
+
+		// forget an earlier entry of the same pin
+		m->output &= ~bit;
+		m->periph &= ~bit;
+		m->periph_b &= ~bit;
+		m->pullup &= ~bit;
+		m->high &= ~bit;
+		m->open_drain &= ~bit;
+		m->filter &= ~bit;
+
+		m->all |= bit;
+		if (table[i].mode == PIO_CFG_OUTPUT) {
+			m->output |= bit;
+		} else if (table[i].mode == PIO_CFG_PERIPH_A) {
+			m->periph |= bit;
+		} else if (table[i].mode == PIO_CFG_PERIPH_B) {
+			m->periph |= bit;
+			m->periph_b |= bit;
+		}
+		if (table[i].flags & PIO_CFG_PULLUP) {
+			m->pullup |= bit;
+		}
+		if (table[i].flags & PIO_CFG_HIGH) {
+			m->high |= bit;
+		}
+		if (table[i].flags & PIO_CFG_OPEN_DRAIN) {
+			m->open_drain |= bit;
+		}
+		if (table[i].flags & PIO_CFG_FILTER) {
+			m->filter |= bit;
+		}
+	}
+
+	// write every register once per port
+	for (index = 0; index < 6; index++) {
+		m = &masks[index];
+		if (m->all == 0) {
+			continue;
+		}
+		port = (pio_reg_t *) ((uint32_t) PIOA + index * 0x200u);
+
+		port->PIO_IDR = m->all;
+		port->PIO_PUER = m->pullup;
+		port->PIO_PUDR = m->all & ~m->pullup;
+		port->PIO_MDER = m->open_drain;
+		port->PIO_MDDR = m->all & ~m->open_drain;
+		port->PIO_IFER = m->filter;
+		port->PIO_IFDR = m->all & ~m->filter;
+		port->PIO_SODR = m->high;
+		port->PIO_CODR = m->output & ~m->high;
+		port->PIO_OER = m->output;
+		port->PIO_ODR = m->all & ~m->output;
+		if (m->periph) {
+			port->PIO_ABSR = (port->PIO_ABSR & ~m->periph) | m->periph_b;
+			port->PIO_PDR = m->periph;
+		}
+		if (m->all & ~m->periph) {
+			port->PIO_PER = m->all & ~m->periph;
+		}
+	}
 	return 1;
 }
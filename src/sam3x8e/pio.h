@@ -21,19 +21,21 @@
 #define PIO_H_
 
 #include <inttypes.h>
+#include "periph.h"
+#include <stddef.h>
 
 // \brief Pointer to registers of the PIOA peripheral.
-#define PIOA ((pio_reg_t *) 0x400E0E00)
+#define PIOA ((pio_reg_t *) PERIPH_ADDR(0x400E0E00))
 // \brief Pointer to registers of the PIOB peripheral.
-#define PIOB ((pio_reg_t *) 0x400E1000)
+#define PIOB ((pio_reg_t *) PERIPH_ADDR(0x400E1000))
 // \brief Pointer to registers of the PIOC peripheral.
-#define PIOC ((pio_reg_t *) 0x400E1200)
+#define PIOC ((pio_reg_t *) PERIPH_ADDR(0x400E1200))
 // \brief Pointer to registers of the PIOD peripheral.
-#define PIOD ((pio_reg_t *) 0x400E1400)
+#define PIOD ((pio_reg_t *) PERIPH_ADDR(0x400E1400))
 // \brief Pointer to registers of the PIOE peripheral.
-#define PIOE ((pio_reg_t *) 0x400E1600)
+#define PIOE ((pio_reg_t *) PERIPH_ADDR(0x400E1600))
 // \brief Pointer to registers of the PIOF peripheral.
-#define PIOF ((pio_reg_t *) 0x400E1800)
+#define PIOF ((pio_reg_t *) PERIPH_ADDR(0x400E1800))
 
 ///@{
 /**
@@ -72,6 +74,25 @@
 
 #define PIO_SLOW_CLOCK_FREQ			(32768)
 
+///@{
+/**
+ * Modes of a pin in a pio_pin_cfg_t table.
+ */
+#define PIO_CFG_OUTPUT			(0)
+#define PIO_CFG_INPUT			(1)
+#define PIO_CFG_PERIPH_A		(2)
+#define PIO_CFG_PERIPH_B		(3)
+///@}
+///@{
+/**
+ * Flags of a pin in a pio_pin_cfg_t table, can be combined with |.
+ */
+#define PIO_CFG_PULLUP			(0x1u)	///< enable the pull-up
+#define PIO_CFG_HIGH			(0x2u)	///< initial level of an output
+#define PIO_CFG_OPEN_DRAIN		(0x4u)	///< enable the multi-driver
+#define PIO_CFG_FILTER			(0x8u)	///< enable the glitch filter
+///@}
+
 ///@cond
 /*
  * Mapping of PIO registers
@@ -337,6 +358,33 @@ void pio_disable_input_filter(pio_reg_t *port, uint32_t pin_number);
  */
 uint32_t pio_input_filter_enabled(pio_reg_t *port, uint32_t pin_number);
 
+/**
+ * Configuration of one pin, an entry in the table given to
+ * pio_apply_config().
+ */
+typedef struct {
+	pio_reg_t *port;	///< PIOA - PIOF
+	uint8_t pin;		///< pin number on the port (0-31)
+	uint8_t mode;		///< PIO_CFG_OUTPUT, _INPUT, _PERIPH_A or _PERIPH_B
+	uint8_t flags;		///< PIO_CFG_* flags
+} pio_pin_cfg_t;
+
+/**
+ * Configures all pins in a table. The entries are grouped by port and every
+ * register is written once per port with the combined mask, instead of
+ * once per pin. Outputs get their initial level before the output driver
+ * is enabled, so they don't glitch.
+ *
+ * Pins and ports not in the table are left untouched. If a pin is listed
+ * more than once the last entry wins.
+ *
+ * @param table The pin configurations.
+ * @param n Number of entries in the table.
+ * @return error (1  = SUCCESS, 0 = FAIL, an entry had an invalid port,
+ * pin or mode and nothing was configured)
+ */
+uint8_t pio_apply_config(const pio_pin_cfg_t *table, size_t n);
+
 
 
 #endif
@@ -0,0 +1,114 @@
+/*
+* pio_capture.c
+*
+* Date:		14 October 2026
+*/
+
+#include "pio_capture.h"
+
+///@cond
+#define PIO_CAPTURE_DEFAULT_TIMEOUT		(0x100000u)
+
+#define PDSR(port)		(((volatile pio_reg_t *) (port))->PIO_PDSR)
+///@endcond
+
+uint8_t pio_capture_init(pio_capture_t *cap, pio_reg_t *data_port,
+		uint32_t data_shift, uint32_t size, uint32_t sampling,
+		pio_reg_t *clk_port, uint32_t clk_pin, uint32_t clk_edge) {
+	if (size != PIO_CAPTURE_BYTE && size != PIO_CAPTURE_HALFWORD
+			&& size != PIO_CAPTURE_WORD) {
+		return 0;
+	}
+	if (data_shift + size * 8 > 32 || clk_pin > 31
+			|| sampling > PIO_CAPTURE_HALF || clk_edge > PIO_CAPTURE_FALLING) {
+		return 0;
+	}
+	cap->data_port = data_port;
+	cap->data_shift = data_shift;
+	cap->data_mask = (size == PIO_CAPTURE_WORD) ? ~0u : ((0x1u << (size * 8)) - 1);
+	cap->size = size;
+	cap->sampling = sampling;
+	cap->clk_port = clk_port;
+	cap->clk_mask = (0x1u << clk_pin);
+	cap->clk_edge = clk_edge;
+	cap->en_port = 0;
+	cap->en_mask = 0;
+	cap->timeout = PIO_CAPTURE_DEFAULT_TIMEOUT;
+	return 1;
+}
+
+void pio_capture_set_enable(pio_capture_t *cap, pio_reg_t *en_port,
+		uint32_t en_pin) {
+	cap->en_port = en_port;
+	cap->en_mask = (0x1u << en_pin);
+}
+
+void pio_capture_set_timeout(pio_capture_t *cap, uint32_t timeout) {
+	cap->timeout = timeout;
+}
+
+/*
+ * Waits for the next sampling edge of the clock and returns PDSR of the data
+ * port right after it. Returns 0 in *ok if the clock did not toggle in time.
+ */
+static inline uint32_t wait_sample(const pio_capture_t *cap, uint8_t *ok) {
+	// level of the clock before and after the sampling edge
+	uint32_t before = (cap->clk_edge == PIO_CAPTURE_RISING) ? 0 : cap->clk_mask;
+	uint32_t n;
+
+	for (;;) {
+		n = cap->timeout;
+		while ((PDSR(cap->clk_port) & cap->clk_mask) != before) {
+			if (n && --n == 0) {
+				*ok = 0;
+				return 0;
+			}
+		}
+		n = cap->timeout;
+		while ((PDSR(cap->clk_port) & cap->clk_mask) == before) {
+			if (n && --n == 0) {
+				*ok = 0;
+				return 0;
+			}
+		}
+		if (cap->en_port == 0 || (PDSR(cap->en_port) & cap->en_mask)) {
+			return PDSR(cap->data_port);
+		}
+	}
+}
+
+uint8_t pio_capture_start(const pio_capture_t *cap, void *buffer,
+		uint32_t half_samples, pio_capture_callback_t callback) {
+	uint8_t *half[2];
+	uint32_t index = 0, i, value;
+	uint8_t ok = 1;
+
+	if (buffer == 0 || half_samples == 0 || callback == 0) {
+		return 0;
+	}
+	half[0] = (uint8_t *) buffer;
+	half[1] = half[0] + half_samples * cap->size;
+
+	for (;;) {
+		for (i = 0; i < half_samples; i++) {
+			if (cap->sampling == PIO_CAPTURE_HALF) {
+				(void) wait_sample(cap, &ok);
+			}
+			value = (wait_sample(cap, &ok) >> cap->data_shift) & cap->data_mask;
+			if (!ok) {
+				return 0;
+			}
+			if (cap->size == PIO_CAPTURE_BYTE) {
+				half[index][i] = (uint8_t) value;
+			} else if (cap->size == PIO_CAPTURE_HALFWORD) {
+				((uint16_t *) half[index])[i] = (uint16_t) value;
+			} else {
+				((uint32_t *) half[index])[i] = value;
+			}
+		}
+		if (!callback(half[index], index)) {
+			return 1;
+		}
+		index ^= 1;
+	}
+}
@@ -0,0 +1,125 @@
+/**
+ * @file
+ * @brief PIO - Clocked parallel capture
+ * @details Captures samples from a parallel bus, e.g. a camera or a
+ * parallel-output ADC, clocked by a pixel/data clock on another pin. Each
+ * sample is taken from PIO_PDSR on the selected clock edge, optionally only
+ * while a data-valid pin is high, and is stored in a double buffer. When
+ * one half is full the callback is called with it while the next half is
+ * being filled.
+ *
+ * The SAM3X8E PIO has no parallel capture mode and no PDC channel for the
+ * PIO (that mode only exists in the SAM3S/SAM4 families), so the capture is
+ * done by the CPU in a tight loop. With the CPU running at 84 MHz clocks up
+ * to a few MHz can be followed. Interrupts should be disabled during the
+ * capture if no samples may be lost, and the callback must return quickly.
+ *
+ * @pre Enable the peripheral clock of the ports used, the PIO only samples
+ * its inputs when the clock is running. Configure the pins as inputs.
+ *
+ * @date 14 October 2026
+ */
+
+#ifndef PIO_CAPTURE_H_
+#define PIO_CAPTURE_H_
+
+#include <inttypes.h>
+#include "pio.h"
+
+///@{
+/**
+ * Size of a sample in the buffer.
+ */
+#define PIO_CAPTURE_BYTE		(1)
+#define PIO_CAPTURE_HALFWORD	(2)
+#define PIO_CAPTURE_WORD		(4)
+///@}
+
+///@{
+/**
+ * Which samples to keep.
+ */
+#define PIO_CAPTURE_ALWAYS		(0)	///< keep every sample
+#define PIO_CAPTURE_HALF		(1)	///< keep every second sample
+///@}
+
+///@{
+/**
+ * Clock edge on which the data is sampled.
+ */
+#define PIO_CAPTURE_RISING		(0)
+#define PIO_CAPTURE_FALLING		(1)
+///@}
+
+/**
+ * Called when a half of the buffer has been filled.
+ * @param half Pointer to the first sample of the half.
+ * @param index 0 for the first half, 1 for the second.
+ * @return 1 to continue capturing, 0 to stop.
+ */
+typedef uint8_t (*pio_capture_callback_t)(void *half, uint32_t index);
+
+/**
+ * Configuration of a capture, set by pio_capture_init().
+ */
+typedef struct {
+	pio_reg_t *data_port;
+	uint32_t data_shift;
+	uint32_t data_mask;
+	uint32_t size;
+	uint32_t sampling;
+	pio_reg_t *clk_port;
+	uint32_t clk_mask;
+	uint32_t clk_edge;
+	pio_reg_t *en_port;
+	uint32_t en_mask;
+	uint32_t timeout;
+} pio_capture_t;
+
+/**
+ * Set up a capture.
+ * @param cap The capture to set up.
+ * @param data_port The port of the data pins.
+ * @param data_shift The pin number of the lowest data bit. The data pins
+ * must be consecutive.
+ * @param size Size of a sample, PIO_CAPTURE_BYTE, _HALFWORD or _WORD.
+ * @param sampling PIO_CAPTURE_ALWAYS or PIO_CAPTURE_HALF.
+ * @param clk_port The port of the clock pin.
+ * @param clk_pin The clock pin (0-31).
+ * @param clk_edge PIO_CAPTURE_RISING or PIO_CAPTURE_FALLING.
+ * @return 1 if the configuration is valid, otherwise 0.
+ */
+uint8_t pio_capture_init(pio_capture_t *cap, pio_reg_t *data_port,
+		uint32_t data_shift, uint32_t size, uint32_t sampling,
+		pio_reg_t *clk_port, uint32_t clk_pin, uint32_t clk_edge);
+
+/**
+ * Only sample while a data-valid pin is high. Call after pio_capture_init().
+ * @param cap The capture.
+ * @param en_port The port of the data-valid pin.
+ * @param en_pin The data-valid pin (0-31).
+ */
+void pio_capture_set_enable(pio_capture_t *cap, pio_reg_t *en_port,
+		uint32_t en_pin);
+
+/**
+ * Set how many loop iterations to wait for a clock edge before giving up.
+ * The default is 0x100000. Call after pio_capture_init().
+ * @param cap The capture.
+ * @param timeout Number of iterations, 0 waits forever.
+ */
+void pio_capture_set_timeout(pio_capture_t *cap, uint32_t timeout);
+
+/**
+ * Capture into a double buffer until the callback returns 0.
+ * @param cap The capture.
+ * @param buffer The buffer, with room for 2 * half_samples samples.
+ * @param half_samples Number of samples in each half.
+ * @param callback Called for every filled half.
+ * @return 1 if the callback stopped the capture, 0 on a clock timeout or
+ * an invalid parameter.
+ */
+uint8_t pio_capture_start(const pio_capture_t *cap, void *buffer,
+		uint32_t half_samples, pio_capture_callback_t callback);
+
+#endif /* PIO_CAPTURE_H_ */
@@ -0,0 +1,136 @@
+/**
+ * @file
+ * @brief PIO - Inline register access for hot paths
+ * @details This header contains static inline versions of the most used
+ * functions in pio.c. When the port and pin are known at compile time each
+ * call compiles down to a single store to SODR, CODR or ODSR (or a single
+ * load for reads), without the call overhead and the argument checks of the
+ * functions in pio.c.
+ *
+ * A pin is described with a pio_fast_pin_t, which normally is created with
+ * PIO_FAST_PIN() as a constant:
+ *
+ *     static const pio_fast_pin_t led = PIO_FAST_PIN(PIOB, 27);
+ *     pio_fast_set(led);
+ *
+ * The functions in pio.c are still used for configuration, this header only
+ * covers reading and writing pins that are already configured.
+ *
+ * @pre The pins must be enabled and configured with pio.h first.
+ *
+ * @date 14 October 2026
+ */
+
+#ifndef PIO_FAST_H_
+#define PIO_FAST_H_
+
+#include <inttypes.h>
+#include "pio.h"
+
+/**
+ * @brief Compile-time description of a pin, a port and a bit mask.
+ */
+typedef struct {
+	pio_reg_t *port;
+	uint32_t mask;
+} pio_fast_pin_t;
+
+/**
+ * Initializer for a pio_fast_pin_t.
+ * @param port The port of the pin, e.g. PIOB.
+ * @param pin The bit number of the pin in the port (0-31).
+ */
+#define PIO_FAST_PIN(port, pin)		{ (port), (0x1u << (pin)) }
+
+///@cond
+#define PIO_FAST_REG(port, reg)		(((volatile pio_reg_t *) (port))->reg)
+///@endcond
+
+/**
+ * Set the pin high.
+ * @param p The pin.
+ */
+static inline void pio_fast_set(const pio_fast_pin_t p) {
+	PIO_FAST_REG(p.port, PIO_SODR) = p.mask;
+}
+
+/**
+ * Set the pin low.
+ * @param p The pin.
+ */
+static inline void pio_fast_clear(const pio_fast_pin_t p) {
+	PIO_FAST_REG(p.port, PIO_CODR) = p.mask;
+}
+
+/**
+ * Set the output level of the pin.
+ * @param p The pin.
+ * @param level Non-zero for high, zero for low.
+ */
+static inline void pio_fast_write(const pio_fast_pin_t p, uint32_t level) {
+	if (level) {
+		PIO_FAST_REG(p.port, PIO_SODR) = p.mask;
+	} else {
+		PIO_FAST_REG(p.port, PIO_CODR) = p.mask;
+	}
+}
+
+/**
+ * Invert the output level of the pin.
+ * @param p The pin.
+ */
+static inline void pio_fast_toggle(const pio_fast_pin_t p) {
+	if (PIO_FAST_REG(p.port, PIO_ODSR) & p.mask) {
+		PIO_FAST_REG(p.port, PIO_CODR) = p.mask;
+	} else {
+		PIO_FAST_REG(p.port, PIO_SODR) = p.mask;
+	}
+}
+
+/**
+ * Read the level on the pin.
+ * @param p The pin.
+ * @return 1 if the pin is high, 0 if it is low.
+ */
+static inline uint32_t pio_fast_read(const pio_fast_pin_t p) {
+	return (PIO_FAST_REG(p.port, PIO_PDSR) & p.mask) != 0;
+}
+
+/**
+ * Set several pins of a port high.
+ * @param port The port.
+ * @param mask The pins, one bit per pin.
+ */
+static inline void pio_fast_set_mask(pio_reg_t *port, uint32_t mask) {
+	PIO_FAST_REG(port, PIO_SODR) = mask;
+}
+
+/**
+ * Set several pins of a port low.
+ * @param port The port.
+ * @param mask The pins, one bit per pin.
+ */
+static inline void pio_fast_clear_mask(pio_reg_t *port, uint32_t mask) {
+	PIO_FAST_REG(port, PIO_CODR) = mask;
+}
+
+/**
+ * Write the levels of the whole port in one store. Only the pins enabled in
+ * the Output Write Status Register (PIO_OWER) are changed.
+ * @param port The port.
+ * @param levels The levels, one bit per pin.
+ */
+static inline void pio_fast_write_port(pio_reg_t *port, uint32_t levels) {
+	PIO_FAST_REG(port, PIO_ODSR) = levels;
+}
+
+/**
+ * Read the levels of the whole port.
+ * @param port The port.
+ * @return The levels, one bit per pin.
+ */
+static inline uint32_t pio_fast_read_port(pio_reg_t *port) {
+	return PIO_FAST_REG(port, PIO_PDSR);
+}
+
+#endif /* PIO_FAST_H_ */
@@ -0,0 +1,170 @@
+/*
+* pio_irq.c
+*
+* Date:		14 October 2026
+*/
+
+#include "pio_irq.h"
+#include "id.h"
+#if PIO_IRQ_COOS
+#include "rtos/CoOS.h"
+#endif
+
+///@cond
+// NVIC Interrupt Set-Enable Register 0 (peripheral ID 0-31)
+#define NVIC_ISER0		(*((volatile uint32_t *) PERIPH_ADDR(0xE000E100U)))
+
+#define PIO_IRQ_NONE	(0)
+#define PIO_IRQ_CALL	(1)
+#define PIO_IRQ_FLAG	(2)
+#define PIO_IRQ_QUEUE	(3)
+
+// The ports are placed 0x200 apart, starting with PIOA.
+#define PIO_IRQ_PORT_INDEX(port) \
+	((((uint32_t) (port)) - ((uint32_t) PIOA)) / 0x200u)
+///@endcond
+
+/*
+ * One handler per pin. "kind" tells which of the members that is valid.
+ */
+typedef struct {
+	pio_irq_callback_t callback;
+	void *arg;
+	uint8_t kind;
+	uint8_t id;
+} pio_irq_handler_t;
+
+static pio_irq_handler_t handlers[PIO_IRQ_PORTS][32];
+
+static const uint32_t port_ids[PIO_IRQ_PORTS] = {
+	ID_PIOA, ID_PIOB, ID_PIOC, ID_PIOD
+};
+
+static uint8_t valid_port(pio_reg_t *port) {
+	return (port == PIOA || port == PIOB || port == PIOC || port == PIOD);
+}
+
+static void set_trigger(pio_reg_t *port, uint32_t mask, uint32_t edge) {
+	switch (edge) {
+	case PIO_IRQ_RISING_EDGE:
+		port->PIO_ESR = mask;
+		port->PIO_REHLSR = mask;
+		port->PIO_AIMER = mask;
+		break;
+	case PIO_IRQ_FALLING_EDGE:
+		port->PIO_ESR = mask;
+		port->PIO_FELLSR = mask;
+		port->PIO_AIMER = mask;
+		break;
+	case PIO_IRQ_HIGH_LEVEL:
+		port->PIO_LSR = mask;
+		port->PIO_REHLSR = mask;
+		port->PIO_AIMER = mask;
+		break;
+	case PIO_IRQ_LOW_LEVEL:
+		port->PIO_LSR = mask;
+		port->PIO_FELLSR = mask;
+		port->PIO_AIMER = mask;
+		break;
+	default:
+		// any input change
+		port->PIO_AIMDR = mask;
+		break;
+	}
+}
+
+static uint8_t attach(pio_reg_t *port, uint32_t pin, uint32_t edge,
+		const pio_irq_handler_t *handler) {
+	uint32_t index, mask;
+
+	if (!valid_port(port) || pin > 31 || edge > PIO_IRQ_LOW_LEVEL) {
+		return 0;
+	}
+	index = PIO_IRQ_PORT_INDEX(port);
+	mask = (0x1u << pin);
+
+	port->PIO_IDR = mask;
+	handlers[index][pin] = *handler;
+	set_trigger(port, mask, edge);
+	// clear changes that happened before the interrupt was enabled
+	(void) PERIPH_REG(port->PIO_ISR);
+	port->PIO_IER = mask;
+	NVIC_ISER0 = (0x1u << port_ids[index]);
+	return 1;
+}
+
+uint8_t pio_attach_interrupt(pio_reg_t *port, uint32_t pin, uint32_t edge,
+		pio_irq_callback_t callback, void *arg) {
+	pio_irq_handler_t handler = {callback, arg, PIO_IRQ_CALL, 0};
+
+	if (callback == 0) {
+		return 0;
+	}
+	return attach(port, pin, edge, &handler);
+}
+
+#if PIO_IRQ_COOS
+uint8_t pio_attach_flag(pio_reg_t *port, uint32_t pin, uint32_t edge,
+		uint8_t flag) {
+	pio_irq_handler_t handler = {0, 0, PIO_IRQ_FLAG, flag};
+	return attach(port, pin, edge, &handler);
+}
+
+uint8_t pio_attach_queue(pio_reg_t *port, uint32_t pin, uint32_t edge,
+		uint8_t queue, void *mail) {
+	pio_irq_handler_t handler = {0, mail, PIO_IRQ_QUEUE, queue};
+	return attach(port, pin, edge, &handler);
+}
+#endif
+
+void pio_detach_interrupt(pio_reg_t *port, uint32_t pin) {
+	if (!valid_port(port) || pin > 31) {
+		return;
+	}
+	port->PIO_IDR = (0x1u << pin);
+	handlers[PIO_IRQ_PORT_INDEX(port)][pin].kind = PIO_IRQ_NONE;
+}
+
+void pio_irq_dispatch(pio_reg_t *port) {
+	pio_irq_handler_t *table = handlers[PIO_IRQ_PORT_INDEX(port)];
+	// reading ISR clears it, so it is only read once
+	uint32_t pending = port->PIO_ISR & port->PIO_IMR;
+	uint32_t pin;
+
+	while (pending) {
+		pin = 31 - __builtin_clz(pending);
+		pending &= ~(0x1u << pin);
+
+		switch (table[pin].kind) {
+		case PIO_IRQ_CALL:
+			table[pin].callback(port, pin, table[pin].arg);
+			break;
+#if PIO_IRQ_COOS
+		case PIO_IRQ_FLAG:
+			isr_SetFlag(table[pin].id);
+			break;
+		case PIO_IRQ_QUEUE:
+			isr_PostQueueMail(table[pin].id, table[pin].arg);
+			break;
+#endif
+		default:
+			break;
+		}
+	}
+}
+
+void PIOA_Handler(void) {
+	pio_irq_dispatch(PIOA);
+}
+
+void PIOB_Handler(void) {
+	pio_irq_dispatch(PIOB);
+}
+
+void PIOC_Handler(void) {
+	pio_irq_dispatch(PIOC);
+}
+
+void PIOD_Handler(void) {
+	pio_irq_dispatch(PIOD);
+}
@@ -0,0 +1,115 @@
+/**
+ * @file
+ * @brief PIO - Input change interrupts
+ * @details Attaches a handler to a single pin of PIOA-PIOD. The handler is
+ * called from the port interrupt (PIOx_Handler) when the selected edge or
+ * level is detected. The dispatcher reads PIO_ISR once and only visits the
+ * pins that are flagged, so a port with one active pin costs the same as a
+ * port with one attached pin.
+ *
+ * Instead of a callback, an event can be delivered to a CoOS task, either
+ * by setting an event flag (isr_SetFlag()) or by posting a mail to a queue
+ * (isr_PostQueueMail()). The waiting task is then woken up by the kernel
+ * instead of polling pio_read_port().
+ *
+ * @pre Enable the peripheral clock of the port, otherwise no input changes
+ * are detected. Configure the pin as an input (or output) with pio.h.
+ * @pre CoOS delivery requires CFG_MAX_SERVICE_REQUEST > 0 and that the flag
+ * or queue has been created before the first interrupt.
+ *
+ * @date 14 October 2026
+ */
+
+#ifndef PIO_IRQ_H_
+#define PIO_IRQ_H_
+
+#include <inttypes.h>
+#include "pio.h"
+
+/*
+ * Set to 0 to build without the CoOS delivery, e.g. when the RTOS is not
+ * linked into the application.
+ */
+#ifndef PIO_IRQ_COOS
+#define PIO_IRQ_COOS			(1)
+#endif
+
+/// Number of ports that can have attached interrupts (PIOA-PIOD).
+#define PIO_IRQ_PORTS			(4)
+
+///@{
+/**
+ * Trigger condition of a pin interrupt.
+ */
+#define PIO_IRQ_BOTH_EDGES		(0)
+#define PIO_IRQ_RISING_EDGE		(1)
+#define PIO_IRQ_FALLING_EDGE	(2)
+#define PIO_IRQ_HIGH_LEVEL		(3)
+#define PIO_IRQ_LOW_LEVEL		(4)
+///@}
+
+/**
+ * Interrupt handler, called in interrupt context.
+ * @param port The port of the pin that triggered the interrupt.
+ * @param pin The pin number (0-31).
+ * @param arg The argument given to pio_attach_interrupt().
+ */
+typedef void (*pio_irq_callback_t)(pio_reg_t *port, uint32_t pin, void *arg);
+
+/**
+ * Attach a callback to a pin and enable its interrupt. The NVIC interrupt of
+ * the port is enabled as well.
+ * @param port The port (PIOA-PIOD).
+ * @param pin The pin number (0-31).
+ * @param edge The trigger condition, one of PIO_IRQ_*.
+ * @param callback The function to call when the pin triggers.
+ * @param arg Argument passed to the callback.
+ * @return 1 if the interrupt was attached, 0 if a parameter was invalid.
+ */
+uint8_t pio_attach_interrupt(pio_reg_t *port, uint32_t pin, uint32_t edge,
+		pio_irq_callback_t callback, void *arg);
+
+#if PIO_IRQ_COOS
+/**
+ * Attach a pin to a CoOS event flag. The flag is set with isr_SetFlag()
+ * every time the pin triggers.
+ * @param port The port (PIOA-PIOD).
+ * @param pin The pin number (0-31).
+ * @param edge The trigger condition, one of PIO_IRQ_*.
+ * @param flag The flag, created with CoCreateFlag().
+ * @return 1 if the interrupt was attached, 0 if a parameter was invalid.
+ */
+uint8_t pio_attach_flag(pio_reg_t *port, uint32_t pin, uint32_t edge,
+		uint8_t flag);
+
+/**
+ * Attach a pin to a CoOS queue. The mail is posted with isr_PostQueueMail()
+ * every time the pin triggers.
+ * @param port The port (PIOA-PIOD).
+ * @param pin The pin number (0-31).
+ * @param edge The trigger condition, one of PIO_IRQ_*.
+ * @param queue The queue, created with CoCreateQueue().
+ * @param mail The mail to post, e.g. an identifier of the pin.
+ * @return 1 if the interrupt was attached, 0 if a parameter was invalid.
+ */
+uint8_t pio_attach_queue(pio_reg_t *port, uint32_t pin, uint32_t edge,
+		uint8_t queue, void *mail);
+#endif
+
+/**
+ * Disable the interrupt of a pin and remove its handler. The NVIC interrupt
+ * is left enabled.
+ * @param port The port (PIOA-PIOD).
+ * @param pin The pin number (0-31).
+ */
+void pio_detach_interrupt(pio_reg_t *port, uint32_t pin);
+
+/**
+ * Dispatch the pending interrupts of a port. This is called by the
+ * PIOx_Handler functions, but can also be called when polling with the NVIC
+ * interrupt disabled.
+ * @param port The port (PIOA-PIOD).
+ */
+void pio_irq_dispatch(pio_reg_t *port);
+
+#endif /* PIO_IRQ_H_ */
@@ -11,6 +11,8 @@
  */
 
 #include "pmc.h"
+#include "eefc.h"
+#include "irq.h"
 
 ///@cond
 
@@ -21,38 +23,236 @@
 // Bit mask for Peripheral Identifier, to be used with register 1.
 #define REG_1_BIT_MASK(id)		(0x1u << ((id) - 32))
 
+// Processor clock prescaler, selected clock divided by 2
+#define MCKR_PRES_CLK_2			(1u << 4)
+
+// Users of a peripheral clock are counted up to this
+#define CLOCK_USERS_MAX			(0xFFu)
+
 static uint32_t pmc_switch_mclk_to_pllack(uint32_t);
+static uint32_t pmc_switch_mclk_to_main(uint32_t);
 
 ///@endcond
 
-void pmc_init_system_clock(void) {
-	// Enable Main XTAL oscillator
-	PMC->CKGR_MOR = (PMC->CKGR_MOR & ~2u) | PMC_CKGR_MOR_KEY |
-					PMC_CKGR_MOR_MOSCXTEN |	PMC_CKGR_MOR_MOSCXTST;
+/*
+ * Settings of a clock profile.
+ */
+typedef struct {
+	uint32_t mck;		// master clock frequency
+	uint32_t pll_mul;	// multiplier of PLLA, 0 if PLLA is stopped
+	uint32_t pres;		// processor clock prescaler
+	uint32_t xtal;		// 1 if the main clock is the crystal oscillator
+} pmc_profile_t;
+
+static const pmc_profile_t profiles[PMC_PROFILES] = {
+	{SYS_CLK_FREQ, PMC_PLLA_MUL, MCKR_PRES_CLK_2, 1},
+	{PMC_MAIN_XTAL_FREQ * 8u / 2u, 8u, MCKR_PRES_CLK_2, 1},
+	{PMC_MAIN_XTAL_FREQ, 0, 0, 1},
+	{PMC_FAST_RC_FREQ, 0, 0, 0}
+};
+
+// The master clock runs from the fast RC oscillator after reset
+static uint32_t clock_profile = PMC_PROFILE_RC_4MHZ;
+static uint32_t mck_freq = PMC_FAST_RC_FREQ;
+
+static pmc_clock_notifier_t clock_notifiers[PMC_MAX_NOTIFIERS];
+
+static uint8_t clock_users[ID_MAX + 1];
+
+/*
+ * Enable the crystal oscillator, unless it runs already. It is stable when
+ * MOSCXTS is set.
+ */
+static void pmc_start_xtal(void) {
+	if (!(PMC->CKGR_MOR & PMC_CKGR_MOR_MOSCXTEN)) {
+		PMC->CKGR_MOR = (PMC->CKGR_MOR & ~2u) | PMC_CKGR_MOR_KEY |
+						PMC_CKGR_MOR_MOSCXTEN |	PMC_CKGR_MOR_MOSCXTST;
+	}
+}
+
+/*
+ * Set the frequency of the fast RC oscillator and wait until it is stable.
+ */
+static void pmc_set_fast_rc(uint32_t moscrcf) {
+	if ((PMC->CKGR_MOR & PMC_CKGR_MOR_MOSCRCF_MASK) != moscrcf) {
+		PMC->CKGR_MOR = (PMC->CKGR_MOR & ~PMC_CKGR_MOR_MOSCRCF_MASK) |
+						PMC_CKGR_MOR_KEY | moscrcf;
+		while (!(PERIPH_REG(PMC->PMC_SR) & PMC_SR_MOSCRCS));
+	}
+}
+
+/*
+ * Set the oscillators, PLLA and the master clock of a profile. The master
+ * clock runs from the main clock meanwhile, at 12 MHz at most.
+ *
+ * ret 1 Success.
+ * ret 0 The master clock did not become ready.
+ */
+static uint8_t pmc_apply_profile(uint32_t profile) {
+	const pmc_profile_t *p = &profiles[profile];
+	uint32_t error;
+
+	// Raise the Flash Wait States before the master clock speeds up
+	if (p->mck > mck_freq) {
+		eefc_set_wait_states_for_clock(p->mck);
+	}
+	error = pmc_switch_mclk_to_main(0);
+
+	if (p->xtal) {
+		// Enable Main XTAL oscillator, pmc_start_system_clock() may have
+		pmc_start_xtal();
+
+		// Wait to the Main XTAL oscillator is stabilized
+		while (!(PERIPH_REG(PMC->PMC_SR) & PMC_SR_MOSCXTS));
+
+		// select the Main Crystal Oscillator
+		PMC->CKGR_MOR |= PMC_CKGR_MOR_KEY | PMC_CKGR_MOR_MOSCSEL;
+
+		// check Main Oscillator Selection Status - Selection is in progress
+		while (!(PERIPH_REG(PMC->PMC_SR) & PMC_SR_MOSCSELS));
 
-	// Wait to the Main XTAL oscillator is stabilized
-	while (!(PMC->PMC_SR & PMC_SR_MOSCXTS));
+		// The fast RC oscillator runs at 4 MHz when it is selected again
+		pmc_set_fast_rc(PMC_CKGR_MOR_MOSCRCF_4MHZ);
+	} else {
+		pmc_set_fast_rc(PMC_CKGR_MOR_MOSCRCF_4MHZ);
 
-	// select the Main Crystal Oscillator
-	PMC->CKGR_MOR |= PMC_CKGR_MOR_KEY | PMC_CKGR_MOR_MOSCSEL;
+		// select the fast RC oscillator
+		PMC->CKGR_MOR = (PMC->CKGR_MOR & ~PMC_CKGR_MOR_MOSCSEL) |
+						PMC_CKGR_MOR_KEY;
 
-	// check Main Oscillator Selection Status - Selection is in progress
-	while (!(PMC->PMC_SR & PMC_SR_MOSCSELS));
+		// check Main Oscillator Selection Status - Selection is in progress
+		while (!(PERIPH_REG(PMC->PMC_SR) & PMC_SR_MOSCSELS));
+	}
 
 	// Disable PLLA clock - Always stop PLL first!
 	PMC->CKGR_PLLAR = CKGR_PLLAR_ONE;
-	// set PMC clock generator
-	PMC->CKGR_PLLAR = 	CKGR_PLLAR_ONE | CKGR_PLLAR_MULA |
-						CKGR_PLLAR_DIVA_BYPASS | CKGR_PLLAR_PLLACOUNT;
 
-	// wait for PLL to be locked
-	while (!(PMC->PMC_SR & PMC_SR_LOCKA));
+	if (p->pll_mul != 0) {
+		// set PMC clock generator
+		PMC->CKGR_PLLAR = 	CKGR_PLLAR_ONE | CKGR_PLLAR_MUL(p->pll_mul) |
+							CKGR_PLLAR_DIVA_BYPASS | CKGR_PLLAR_PLLACOUNT;
+
+		// wait for PLL to be locked
+		while (!(PERIPH_REG(PMC->PMC_SR) & PMC_SR_LOCKA));
+
+		// Switch master clock source selection to PLLA clock
+		error |= pmc_switch_mclk_to_pllack(p->pres);
+	} else {
+		error |= pmc_switch_mclk_to_main(p->pres);
+		if (!p->xtal) {
+			// Stop the Main XTAL oscillator
+			PMC->CKGR_MOR = (PMC->CKGR_MOR & ~PMC_CKGR_MOR_MOSCXTEN) |
+							PMC_CKGR_MOR_KEY;
+		}
+	}
+
+	// Lower the Flash Wait States after the master clock slowed down
+	if (p->mck < mck_freq) {
+		eefc_set_wait_states_for_clock(p->mck);
+	}
+	mck_freq = p->mck;
+	clock_profile = profile;
+	return !error;
+}
+
+void pmc_init_system_clock(void) {
+	pmc_start_system_clock();
+	pmc_finish_system_clock();
+}
+
+void pmc_start_system_clock(void) {
+	pmc_start_xtal();
+	// Run three times faster than after reset until the crystal is stable,
+	// 12 MHz needs no Flash Wait States
+	if (clock_profile == PMC_PROFILE_RC_4MHZ &&
+		!(PMC->CKGR_MOR & PMC_CKGR_MOR_MOSCSEL)) {
+		pmc_switch_mclk_to_main(0);
+		pmc_set_fast_rc(PMC_CKGR_MOR_MOSCRCF_12MHZ);
+		mck_freq = PMC_BOOT_RC_FREQ;
+	}
+}
+
+void pmc_finish_system_clock(void) {
+	pmc_apply_profile(PMC_PROFILE_84MHZ);
+}
+
+uint8_t pmc_set_clock_profile(uint32_t profile) {
+	uint8_t ok;
+	uint32_t i;
+
+	if (profile >= PMC_PROFILES) {
+		return 0;
+	}
+	if (profile == clock_profile) {
+		return 1;
+	}
+	ok = pmc_apply_profile(profile);
+	for (i = 0; i < PMC_MAX_NOTIFIERS && clock_notifiers[i] != 0; i++) {
+		clock_notifiers[i](mck_freq);
+	}
+	return ok;
+}
+
+uint32_t pmc_get_clock_profile(void) {
+	return clock_profile;
+}
+
+uint32_t pmc_get_mck_freq(void) {
+	return mck_freq;
+}
+
+uint8_t pmc_add_clock_notifier(pmc_clock_notifier_t notifier) {
+	uint32_t i;
+
+	for (i = 0; i < PMC_MAX_NOTIFIERS; i++) {
+		if (clock_notifiers[i] == notifier) {
+			return 1;
+		}
+		if (clock_notifiers[i] == 0) {
+			clock_notifiers[i] = notifier;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+uint8_t pmc_enter_wait_mode(void) {
+	uint32_t i;
+
+	// Nothing could wake the chip up
+	if (!(PMC->PMC_FSMR & PMC_FSMR_FSTT_MASK)) {
+		return 0;
+	}
+
+	// Run the master clock from the main clock, then the main clock from
+	// the fast RC oscillator
+	PMC->PMC_MCKR = PMC_MCKR_CSS(PMC_MCKR_CSS_MAIN_CLK);
+	while (!(PERIPH_REG(PMC->PMC_SR) & PMC_SR_MCKRDY));
+	PMC->CKGR_MOR = (PMC->CKGR_MOR & ~PMC_CKGR_MOR_MOSCSEL) |
+					PMC_CKGR_MOR_KEY;
+	while (!(PERIPH_REG(PMC->PMC_SR) & PMC_SR_MOSCSELS));
+
+	// Lower the Flash Wait States now that the master clock is slow
+	eefc_set_wait_states_for_clock(PMC_FAST_RC_FREQ);
+	mck_freq = PMC_FAST_RC_FREQ;
+
+	// Stop PLLA and the Main XTAL oscillator
+	PMC->CKGR_PLLAR = CKGR_PLLAR_ONE;
+	PMC->CKGR_MOR = (PMC->CKGR_MOR & ~PMC_CKGR_MOR_MOSCXTEN) |
+					PMC_CKGR_MOR_KEY;
+
+	// Enter wait mode, the master clock is ready again after wakeup
+	PMC->CKGR_MOR |= PMC_CKGR_MOR_KEY | PMC_CKGR_MOR_WAITMODE;
+	while (!(PERIPH_REG(PMC->PMC_SR) & PMC_SR_MCKRDY));
 
-	/*
-	 * Switch master clock source selection to PLLA clock,
-	 * selected clock divided by 2.
-	 */
-	pmc_switch_mclk_to_pllack(1u << 4);
+	// Let the fast RC oscillator settle before running on
+	for (i = 0; i < 500; i++) {
+		__asm volatile ("nop");
+	}
+	while (!(PERIPH_REG(PMC->CKGR_MOR) & PMC_CKGR_MOR_MOSCRCEN));
+
+	pmc_apply_profile(clock_profile);
+	return 1;
 }
 
 /*
@@ -80,6 +280,32 @@ static uint32_t pmc_switch_mclk_to_pllack(uint32_t ul_pres) {
 	return 0;
 }
 
+/*
+ * Switch master clock source selection to the main clock, the clock source
+ * is selected before the prescaler.
+ *
+ * param: ul_pres Processor clock prescaler.
+ *
+ * ret 0 Success.
+ * ret 1 Timeout error.
+ */
+static uint32_t pmc_switch_mclk_to_main(uint32_t ul_pres) {
+	uint32_t ul_timeout;
+	PMC->PMC_MCKR = PMC_MCKR_CSS(PMC_MCKR_CSS_MAIN_CLK);
+	for (ul_timeout = 2048; !(PMC->PMC_SR & PMC_SR_MCKRDY); --ul_timeout) {
+		if (ul_timeout == 0) {
+			return 1;
+		}
+	}
+	PMC->PMC_MCKR = PMC_MCKR_PRES(ul_pres);
+	for (ul_timeout = 2048; !(PMC->PMC_SR & PMC_SR_MCKRDY); --ul_timeout) {
+		if (ul_timeout == 0) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
 /*
  * These registers can only be written if the WPEN bit is cleared in
  * “PMC Write Protect Mode Register”.
@@ -113,3 +339,45 @@ uint32_t pmc_peripheral_clock_enabled(uint32_t id) {
 		return 0;
 	}
 }
+
+uint32_t pmc_acquire_peripheral_clock(uint32_t id) {
+	uint32_t primask;
+	uint32_t users;
+
+	if (id > ID_MAX) {
+		return 0;
+	}
+	primask = irq_save();
+	if (clock_users[id] == 0) {
+		pmc_enable_peripheral_clock(id);
+	}
+	if (clock_users[id] < CLOCK_USERS_MAX) {
+		clock_users[id]++;
+	}
+	users = clock_users[id];
+	irq_restore(primask);
+	return users;
+}
+
+uint32_t pmc_release_peripheral_clock(uint32_t id) {
+	uint32_t primask;
+	uint32_t users;
+
+	if (id > ID_MAX) {
+		return 0;
+	}
+	primask = irq_save();
+	if (clock_users[id] > 0) {
+		clock_users[id]--;
+		if (clock_users[id] == 0) {
+			pmc_disable_peripheral_clock(id);
+		}
+	}
+	users = clock_users[id];
+	irq_restore(primask);
+	return users;
+}
+
+uint32_t pmc_peripheral_clock_users(uint32_t id) {
+	return (id <= ID_MAX) ? clock_users[id] : 0;
+}
@@ -15,20 +15,98 @@
 #define PMC_H_
 
 #include <inttypes.h>
+#include "periph.h"
 #include "id.h"				// Definitions of Peripheral Identifiers
 
+/**
+ * The frequency of the main crystal oscillator of the Arduino Due.
+ */
+#define PMC_MAIN_XTAL_FREQ		(12000000u)
+
+/**
+ * The multiplier of PLLA set by pmc_init_system_clock().
+ */
+#define PMC_PLLA_MUL			(14u)
+
+/**
+ * The master clock set by pmc_init_system_clock(), PLLA divided by 2. The
+ * drivers and the CoOS system tick (CFG_CPU_FREQ) take their timing from it,
+ * those in the list of pmc_add_clock_notifier() follow pmc_get_mck_freq()
+ * after a change of the clock profile.
+ */
+#define SYS_CLK_FREQ			(PMC_MAIN_XTAL_FREQ * PMC_PLLA_MUL / 2u)
+
+/**
+ * The frequency of the fast RC oscillator, the master clock in wait mode.
+ */
+#define PMC_FAST_RC_FREQ		(4000000u)
+
+/**
+ * @name Clock profiles
+ * The master clock settings of pmc_set_clock_profile().
+ * @{
+ */
+/** 84 MHz, PLLA at 168 MHz divided by 2, the default (SYS_CLK_FREQ). */
+#define PMC_PROFILE_84MHZ		(0u)
+/** 48 MHz, PLLA at 96 MHz divided by 2. */
+#define PMC_PROFILE_48MHZ		(1u)
+/** 12 MHz, the crystal oscillator, PLLA is stopped. */
+#define PMC_PROFILE_12MHZ		(2u)
+/** 4 MHz, the fast RC oscillator, PLLA and the crystal are stopped. */
+#define PMC_PROFILE_RC_4MHZ		(3u)
+/** Number of clock profiles. */
+#define PMC_PROFILES			(4u)
+///@}
+
+/*
+ * The clock notifiers that can be added with pmc_add_clock_notifier().
+ */
+#ifndef PMC_MAX_NOTIFIERS
+#define PMC_MAX_NOTIFIERS		(8)
+#endif
+
+/*
+ * Start-up time of the crystal oscillator in units of 8 slow clock cycles
+ * (244 us), 8 is 2 ms. The crystal of the Arduino Due starts in about 1 ms.
+ */
+#ifndef PMC_XTAL_STARTUP
+#define PMC_XTAL_STARTUP		(8u)
+#endif
+
+/*
+ * Lock time of PLLA in slow clock cycles (30.5 us), 16 is 0.5 ms. PLLA
+ * locks in at most 150 us.
+ */
+#ifndef PMC_PLLA_COUNT
+#define PMC_PLLA_COUNT			(16u)
+#endif
+
+/**
+ * The fast RC oscillator frequency while the crystal starts, see
+ * pmc_start_system_clock().
+ */
+#define PMC_BOOT_RC_FREQ		(12000000u)
+
 ///@cond
 // Pointer to registers of the PMC peripheral.
-#define PMC ((pmc_reg_t *) 0x400E0600U)
+#define PMC ((pmc_reg_t *) PERIPH_ADDR(0x400E0600U))
 
 // Main Crystal Oscillator Enable
 #define PMC_CKGR_MOR_MOSCXTEN 		(1u)
 // Main Crystal Oscillator Start-up Time
-#define PMC_CKGR_MOR_MOSCXTST 		(62u << 8)
+#define PMC_CKGR_MOR_MOSCXTST 		(PMC_XTAL_STARTUP << 8)
 // Password
 #define PMC_CKGR_MOR_KEY 			(0x37u << 16)
 // Main Oscillator Selection
 #define PMC_CKGR_MOR_MOSCSEL		(1u << 24)
+// Waiting Mode Command
+#define PMC_CKGR_MOR_WAITMODE		(1u << 2)
+// Main On-Chip RC Oscillator Enable
+#define PMC_CKGR_MOR_MOSCRCEN		(1u << 3)
+// Main On-Chip RC Oscillator Frequency Selection, 4, 8 or 12 MHz
+#define PMC_CKGR_MOR_MOSCRCF_MASK	(0x7u << 4)
+#define PMC_CKGR_MOR_MOSCRCF_4MHZ	(0x0u << 4)
+#define PMC_CKGR_MOR_MOSCRCF_12MHZ	(0x2u << 4)
 
 // Main XTAL Oscillator Status
 #define PMC_SR_MOSCXTS				(1u)
@@ -38,16 +116,21 @@
 #define PMC_SR_MCKRDY				(1 << 3)
 // Main Oscillator Selection Status
 #define PMC_SR_MOSCSELS				(1u << 16)
+// Main On-Chip RC Oscillator Status
+#define PMC_SR_MOSCRCS				(1u << 17)
 
 // Divider is bypassed
 #define CKGR_PLLAR_DIVA_BYPASS		(1u)
 // PLLA Counter
-#define CKGR_PLLAR_PLLACOUNT		(0x3fU << 8)
+#define CKGR_PLLAR_PLLACOUNT		(PMC_PLLA_COUNT << 8)
 // PLLA Multiplier
-#define CKGR_PLLAR_MULA				(13u << 16)
+#define CKGR_PLLAR_MUL(mul)			(((mul) - 1u) << 16)
+#define CKGR_PLLAR_MULA				CKGR_PLLAR_MUL(PMC_PLLA_MUL)
 // ONE: Must Be Set to 1 (when programming the CKGR_PLLAR register)
 #define CKGR_PLLAR_ONE				(1u << 29)
 
+// Master Clock Source Selection: Main Clock is selected
+#define PMC_MCKR_CSS_MAIN_CLK		(1)
 // Master Clock Source Selection: PLLA Clock is selected
 #define PMC_MCKR_CSS_PLLA_CLK		(2)
 // Master Clock Source Selection
@@ -57,6 +140,9 @@
 #define PMC_MCKR_PRES(prescaler) \
 	((PMC->PMC_MCKR & (~(0x7u << 4))) | prescaler)
 
+// Fast Startup Inputs: WKUP0-15 pins, RTT, RTC and USB alarms
+#define PMC_FSMR_FSTT_MASK			(0x7ffffu)
+
 /*
  * Mapping of PMC registers
  * Base address: 0x400E0600
@@ -131,12 +217,83 @@ typedef struct {
 } pmc_reg_t;
 ///@endcond
 
+/**
+ * Called after the master clock changed, to set up the dividers again.
+ * @param mck The new master clock frequency in Hz
+ */
+typedef void (*pmc_clock_notifier_t)(uint32_t mck);
+
 /**
  * Initializes the system clock, must be performed during system initialization.
- * @pre Set Flash Wait State.
+ * It sets the clock profile PMC_PROFILE_84MHZ without calling the notifiers.
+ * The Flash Wait States are raised for SYS_CLK_FREQ before the master clock
+ * is switched to PLLA.
+ * It is pmc_start_system_clock() followed by pmc_finish_system_clock().
  */
 void pmc_init_system_clock(void);
 
+/**
+ * First half of pmc_init_system_clock(), it returns without waiting for the
+ * crystal. The crystal oscillator is started and the master clock runs from
+ * the fast RC oscillator at PMC_BOOT_RC_FREQ meanwhile.
+ * The early initialization that needs no exact clock (pin tables, clearing
+ * of RAM, kernel objects) goes between it and pmc_finish_system_clock(), so
+ * it overlaps with the start-up of the crystal.
+ */
+void pmc_start_system_clock(void);
+
+/**
+ * Second half of pmc_init_system_clock(), it waits for the crystal, locks
+ * PLLA and sets the clock profile PMC_PROFILE_84MHZ.
+ * @pre pmc_start_system_clock()
+ */
+void pmc_finish_system_clock(void);
+
+/**
+ * Switches the master clock to a clock profile and calls the clock
+ * notifiers with the new frequency. The Flash Wait States are raised before
+ * the clock speeds up and lowered after it slowed down.
+ * The peripherals that are not in the list of notifiers keep their dividers,
+ * so their rates scale with the master clock.
+ * @param profile Use the values with prefix: PMC_PROFILE_
+ * @return 1 on success, 0 if the profile is invalid or a clock did not
+ * become ready.
+ */
+uint8_t pmc_set_clock_profile(uint32_t profile);
+
+/**
+ * Get the current clock profile.
+ * @return The value with prefix PMC_PROFILE_ of the profile.
+ */
+uint32_t pmc_get_clock_profile(void);
+
+/**
+ * Get the frequency of the master clock.
+ * @return The master clock frequency in Hz, SYS_CLK_FREQ after
+ * pmc_init_system_clock().
+ */
+uint32_t pmc_get_mck_freq(void);
+
+/**
+ * Add a function to the list that is called after the clock profile changed.
+ * A function is only added once.
+ * @param notifier The function, called with interrupts enabled
+ * @return 1 on success, 0 if the list (PMC_MAX_NOTIFIERS) is full.
+ */
+uint8_t pmc_add_clock_notifier(pmc_clock_notifier_t notifier);
+
+/**
+ * Enters wait mode and returns when a fast startup input wakes the chip.
+ * The master clock is switched to the fast RC oscillator and the crystal and
+ * PLLA are stopped, on wakeup the system clock is set up again with
+ * the current clock profile. The Flash Wait States follow the master clock
+ * down and up again. The fast startup inputs must be enabled in PMC_FSMR
+ * beforehand.
+ * @return 1 after waking up, 0 if no fast startup input is enabled and wait
+ * mode was not entered.
+ */
+uint8_t pmc_enter_wait_mode(void);
+
 /**
  * Enable peripheral clock.
  * @param id Peripheral Identifier
@@ -160,4 +317,33 @@ void pmc_disable_peripheral_clock(uint32_t id);
  */
 uint32_t pmc_peripheral_clock_enabled(uint32_t id);
 
+/**
+ * Acquire a peripheral clock for one user, the clock is enabled for the
+ * first. The drivers acquire the clocks they need in their init and release
+ * them in their deinit, so a clock is off when no driver uses it.
+ * May be called from interrupts.
+ * @param id Peripheral Identifier
+ * @return The number of users afterwards, 0 if the Peripheral Identifier is
+ * out of bounds.
+ */
+uint32_t pmc_acquire_peripheral_clock(uint32_t id);
+
+/**
+ * Release a peripheral clock acquired with pmc_acquire_peripheral_clock(),
+ * the clock is disabled when the last user releases it. A clock without
+ * users is left as it is.
+ * May be called from interrupts.
+ * @param id Peripheral Identifier
+ * @return The number of users afterwards.
+ */
+uint32_t pmc_release_peripheral_clock(uint32_t id);
+
+/**
+ * Get the number of users of a peripheral clock.
+ * @param id Peripheral Identifier
+ * @return The number of users, 0 if the Peripheral Identifier is out of
+ * bounds.
+ */
+uint32_t pmc_peripheral_clock_users(uint32_t id);
+
 #endif
@@ -11,6 +11,15 @@
  */
 
 #include "pwm.h"
+#include "pdc.h"
+#include "id.h"
+#if PWM_COOS
+#include "rtos/CoOS.h"
+#endif
+
+// NVIC Interrupt Set/Clear-Enable Register 1 (peripheral ID 32-63)
+#define NVIC_ISER1		(*((volatile uint32_t *) PERIPH_ADDR(0xE000E104U)))
+#define NVIC_ICER1		(*((volatile uint32_t *) PERIPH_ADDR(0xE000E184U)))
 
 ///\cond
 /*
@@ -18,8 +27,27 @@
  * See datasheet page 1019
  */
 #define ch_dis		8
+/*
+ * Register comparison unit distance
+ * PWM_CMPV0 - PWM_CMPMUPD7, offset 0x130 - 0x19C
+ */
+#define cmp_dis		4
 ///\endcond
 
+// Highest number of transfers in one PDC buffer
+#define PWM_PDC_MAX_COUNT	(0xFFFFu)
+
+// State of the duty cycle updates from the PDC
+static struct {
+	uint16_t *half[2];
+	uint32_t half_updates;
+	uint32_t half_count;
+	uint32_t sending;
+	volatile uint32_t halves;
+	pwm_sync_callback_t callback;
+	uint8_t flag;
+} sync_dma = { .flag = PWM_NO_FLAG };
+
 /*
  * This initialization function also takes in parameters for the two clocks
  * called CLK_A and CLK_B.
@@ -43,6 +71,7 @@ uint8_t pwm_init_peripheral(pwm_clk_setting_t clk_settings) {
  * This function initializes a channel of the PWM peripheral.
  */
 uint8_t pwm_init_channel(pwm_channel_setting_t settings) {
+	uint32_t *p_cmr;
 	uint8_t reenable = 0;
 	// Disable the channel and remember the initial state of it
 	if (pwm_channel_enabled(settings.channel) == 1) {
@@ -58,9 +87,13 @@ uint8_t pwm_init_channel(pwm_channel_setting_t settings) {
 	} else if (settings.use_CLKx == 0) {
 		pwm_set_channel_frequency(settings.channel, settings.frequency);
 	}
-	pwm_set_channel_alignment(settings.channel, settings.alignment);
-	pwm_set_channel_polarity(settings.channel, settings.polarity);
+	// Alignment and polarity with one write, the prescaler is kept
+	p_cmr = (&PWM->PWM_CMR0) + (ch_dis * settings.channel);
+	*p_cmr = (*p_cmr & ~(PWM_CMRx_CALG_MASK | PWM_CMRx_CPOL_MASK)) |
+			pwm_cmr_value(0, settings.alignment, settings.polarity);
 	pwm_set_channel_duty_cycle(settings.channel, settings.duty_cycle);
+	pwm_set_channel_dead_time(settings.channel, settings.dead_time_high,
+			settings.dead_time_low);
 	if (reenable == 1) {
 		pwm_enable_channel(settings.channel);
 	}
@@ -107,7 +140,7 @@ uint8_t pwm_channel_enabled(uint32_t channel) {
 uint8_t pwm_set_channel_polarity(uint32_t channel, uint32_t pwm_polarity) {
 	uint32_t *p_reg;
 	p_reg = (&PWM->PWM_CMR0) + (ch_dis * channel);
-	*p_reg = ((~PWM_CDTYUPDx_CDTYUPD_MASK) & *p_reg) |
+	*p_reg = ((~PWM_CMRx_CPOL_MASK) & *p_reg) |
 						(pwm_polarity << 9);
 	return 1;
 
@@ -261,13 +294,13 @@ uint8_t pwm_set_clkx(uint32_t clock_id, uint32_t prescaler, uint32_t divisor) {
 	uint32_t *p_reg;
 	if (clock_id == PWM_CLK_ID_CLKA) {
 		p_reg = (&PWM->PWM_CLK);
-		*p_reg = ((~PWM_CLK_PREA_MASK) & *p_reg) | (prescaler << 8);
-		*p_reg = ((~PWM_CLK_DIVA_MASK) & *p_reg) | (divisor << 0);
+		*p_reg = (~(PWM_CLK_PREA_MASK | PWM_CLK_DIVA_MASK) & *p_reg) |
+				(prescaler << 8) | (divisor << 0);
 		return 1;
 	} else if (clock_id == PWM_CLK_ID_CLKB) {
 		p_reg = (&PWM->PWM_CLK);
-		*p_reg = ((~PWM_CLK_PREB_MASK) & *p_reg) | (prescaler << 24);
-		*p_reg = ((~PWM_CLK_DIVB_MASK) & *p_reg) | (divisor << 16);
+		*p_reg = (~(PWM_CLK_PREB_MASK | PWM_CLK_DIVB_MASK) & *p_reg) |
+				(prescaler << 24) | (divisor << 16);
 		return 1;
 	}
 	return 0;
@@ -372,5 +405,371 @@ uint8_t pwm_reset_peripheral() {
 	for (uint32_t channel = 0; channel < 8; channel++) {
 		pwm_reset_channel(channel);
 	}
+	PWM->PWM_ELMR0 = 0;
+	PWM->PWM_ELMR1 = 0;
+	for (uint32_t comparison = 0; comparison < 8; comparison++) {
+		p_reg = (&PWM->PWM_CMPM0) + (cmp_dis * comparison);
+		*p_reg = 0;
+	}
+	PWM->PWM_FPE1 = 0;
+	PWM->PWM_FPE2 = 0;
+	PWM->PWM_FMR = 0;
+	PWM->PWM_FPV = 0;
+	PWM->PWM_FCR = PWM_FSR_FIV_MASK;
+	pwm_sync_dma_stop();
+	PWM->PWM_SCM = 0;
+	PWM->PWM_SCUP = 0;
+	return 1;
+}
+/*
+ * This function will make a comparison unit match once in every period of
+ * channel 0 and route it to an event line.
+ */
+uint32_t pwm_set_event_rate(uint32_t event_line, uint32_t frequency) {
+	uint32_t *p_reg;
+	uint32_t period;
+	if (event_line > PWM_EVENT_LINE_1 || frequency == 0) {
+		return 0; // parameter error
+	}
+	if (pwm_set_channel_frequency(PWM_CHANNEL_0, frequency) == 0) {
+		return 0;
+	}
+	// Comparison unit x signals event line x at counter value 1
+	p_reg = (&PWM->PWM_CMPV0) + (cmp_dis * event_line);
+	*p_reg = 1;
+	p_reg = (&PWM->PWM_CMPM0) + (cmp_dis * event_line);
+	*p_reg = PWM_CMPMx_CEN_MASK;
+	p_reg = (&PWM->PWM_ELMR0) + event_line;
+	*p_reg = (0x1u << event_line);
+	pwm_enable_channel(PWM_CHANNEL_0);
+
+	// Actual rate
+	period = pwm_get_channel_period(PWM_CHANNEL_0) <<
+			pwm_get_channel_prescaler(PWM_CHANNEL_0);
+	// the alignment is read as the CALG bit
+	if (pwm_get_channel_alignment(PWM_CHANNEL_0) != 0) {
+		period *= 2;
+	}
+	return SYS_CLK_FREQ / period;
+}
+/*
+ * This function will add a comparison unit to an event line.
+ */
+uint8_t pwm_set_event_compare(uint32_t event_line, uint32_t comparison,
+		uint32_t value, uint32_t down) {
+	uint32_t *p_reg;
+	uint32_t cmpv;
+	if (event_line > PWM_EVENT_LINE_1 || comparison > 7 ||
+			value > PWM_CPRDx_CPRD_MASK || down > 1) {
+		return 0; // parameter error
+	}
+	cmpv = value | (down ? PWM_CMPVx_CVM_MASK : 0);
+	// The update registers are taken at the next period of channel 0
+	if (pwm_channel_enabled(PWM_CHANNEL_0)) {
+		p_reg = (&PWM->PWM_CMPVUPD0) + (cmp_dis * comparison);
+		*p_reg = cmpv;
+		p_reg = (&PWM->PWM_CMPMUPD0) + (cmp_dis * comparison);
+		*p_reg = PWM_CMPMx_CEN_MASK;
+	} else {
+		p_reg = (&PWM->PWM_CMPV0) + (cmp_dis * comparison);
+		*p_reg = cmpv;
+		p_reg = (&PWM->PWM_CMPM0) + (cmp_dis * comparison);
+		*p_reg = PWM_CMPMx_CEN_MASK;
+	}
+	p_reg = (&PWM->PWM_ELMR0) + event_line;
+	*p_reg |= (0x1u << comparison);
+	return 1;
+}
+/*
+ * This function will remove a comparison unit from an event line.
+ */
+uint8_t pwm_clear_event_compare(uint32_t event_line, uint32_t comparison) {
+	uint32_t *p_reg;
+	if (event_line > PWM_EVENT_LINE_1 || comparison > 7) {
+		return 0; // parameter error
+	}
+	p_reg = (&PWM->PWM_ELMR0) + event_line;
+	*p_reg &= ~(0x1u << comparison);
+	// CMPM is taken at once, an update could be pending from before
+	p_reg = (&PWM->PWM_CMPMUPD0) + (cmp_dis * comparison);
+	*p_reg = 0;
+	p_reg = (&PWM->PWM_CMPM0) + (cmp_dis * comparison);
+	*p_reg = 0;
+	return 1;
+}
+/*
+ * This function will set the dead-time of a channel.
+ */
+uint8_t pwm_set_channel_dead_time(uint32_t channel, uint32_t dead_time_high,
+		uint32_t dead_time_low) {
+	uint32_t *p_reg;
+	uint32_t period, duty_cycle;
+	if (channel > 7) {
+		return 0; // parameter error
+	}
+	p_reg = (&PWM->PWM_CMR0) + (ch_dis * channel);
+	if (dead_time_high == 0 && dead_time_low == 0) {
+		*p_reg &= ~PWM_CMRx_DTE_MASK;
+		return 1;
+	}
+	// The dead-times must fit in the low and the high part of the period
+	period = pwm_get_channel_period(channel);
+	duty_cycle = pwm_read_channel(channel);
+	if (duty_cycle > period || dead_time_high > period - duty_cycle ||
+			dead_time_low > duty_cycle) {
+		return 0;
+	}
+	if (pwm_channel_enabled(channel) && (*p_reg & PWM_CMRx_DTE_MASK)) {
+		p_reg = (&PWM->PWM_DTUPD0) + (ch_dis * channel);
+		*p_reg = dead_time_high | (dead_time_low << 16);
+	} else {
+		// DTE can only be changed while the channel is disabled
+		uint8_t reenable = pwm_channel_enabled(channel);
+		pwm_disable_channel(channel);
+		*p_reg |= PWM_CMRx_DTE_MASK;
+		p_reg = (&PWM->PWM_DT0) + (ch_dis * channel);
+		*p_reg = dead_time_high | (dead_time_low << 16);
+		if (reenable) {
+			pwm_enable_channel(channel);
+		}
+	}
+	return 1;
+}
+/*
+ * This function will set the fault inputs.
+ */
+uint8_t pwm_set_fault_mode(uint32_t active_high, uint32_t latched,
+		uint32_t filtered) {
+	if ((active_high | latched | filtered) > PWM_FAULT_INPUT_ALL) {
+		return 0; // parameter error
+	}
+	PWM->PWM_FMR = active_high | (latched << 8) | (filtered << 16);
+	return 1;
+}
+/*
+ * This function will set the fault protection of a channel.
+ */
+uint8_t pwm_set_channel_fault(uint32_t channel, uint32_t inputs,
+		uint32_t high_level, uint32_t low_level) {
+	uint32_t *p_reg;
+	uint32_t shift;
+	if (channel > 7 || inputs > PWM_FAULT_INPUT_ALL || high_level > 1 ||
+			low_level > 1) {
+		return 0; // parameter error
+	}
+	// The levels are set before the protection is enabled
+	PWM->PWM_FPV = (PWM->PWM_FPV & ~((0x10001u) << channel)) |
+			(high_level << channel) | (low_level << (channel + 16));
+	// FPE1 holds channels 0-3 and FPE2 channels 4-7, a byte each
+	p_reg = (channel < 4) ? &PWM->PWM_FPE1 : &PWM->PWM_FPE2;
+	shift = (channel & 0x3u) * 8;
+	*p_reg = (*p_reg & ~(0xFFu << shift)) | (inputs << shift);
+	return 1;
+}
+/*
+ * This function reads the active faults.
+ */
+uint32_t pwm_get_faults(void) {
+	return (PWM->PWM_FSR & PWM_FSR_FS_MASK) >> 8;
+}
+/*
+ * This function clears latched faults.
+ */
+uint8_t pwm_clear_fault(uint32_t inputs) {
+	PWM->PWM_FCR = inputs & PWM_FAULT_INPUT_ALL;
+	return 1;
+}
+/*
+ * This function will find the lowest prescaler that fits the period in 16
+ * bits, with shifts instead of a division per prescaler.
+ */
+uint8_t pwm_solve_timing(uint32_t frequency, uint32_t duty,
+		uint32_t alignment, pwm_timing_t *timing) {
+	uint32_t ratio;
+	uint32_t prescaler = 0;
+	uint32_t period;
+	if (frequency == 0 || duty > (1u << 16) ||
+			alignment > PWM_CHANNEL_ALIGN_CENTER) {
+		return 0; // parameter error
+	}
+	// MCK cycles per period (per half period when center aligned)
+	ratio = SYS_CLK_FREQ / (frequency * (alignment + 1));
+	while ((ratio >> prescaler) > 0xFFFFu && prescaler < PWM_PRES_MCK_DIV_1024) {
+		prescaler++;
+	}
+	period = ratio >> prescaler;
+	if (period > 0xFFFFu || period == 0) {
+		return 0; // out of bounds
+	}
+	timing->period = period;
+	timing->duty_cycle = ((uint64_t) period * duty) >> 16;
+	timing->prescaler = prescaler;
+	timing->alignment = alignment;
 	return 1;
 }
+/*
+ * This function will write a solved timing to the update registers, when the
+ * channel runs with the same prescaler and alignment.
+ */
+uint8_t pwm_apply_timing(uint32_t channel, const pwm_timing_t *timing) {
+	uint32_t *p_cmr;
+	uint32_t mode;
+	uint8_t reenable = 0;
+	if (channel > PWM_CHANNEL_7) {
+		return 0; // parameter error
+	}
+	p_cmr = (&PWM->PWM_CMR0) + (ch_dis * channel);
+	mode = pwm_cmr_value(timing->prescaler, timing->alignment, 0);
+	if (pwm_channel_enabled(channel) &&
+			(*p_cmr & (PWM_CMRx_CPRE_MASK | PWM_CMRx_CALG_MASK)) == mode) {
+		*((&PWM->PWM_CPRDUPD0) + (ch_dis * channel)) = timing->period;
+		*((&PWM->PWM_CDTYUPD0) + (ch_dis * channel)) = timing->duty_cycle;
+		return 1;
+	}
+	// The prescaler or alignment changes, restart the channel
+	if (pwm_channel_enabled(channel) == 1) {
+		reenable = 1;
+		pwm_disable_channel(channel);
+	}
+	*p_cmr = (*p_cmr & ~(PWM_CMRx_CPRE_MASK | PWM_CMRx_CALG_MASK)) | mode;
+	*((&PWM->PWM_CPRD0) + (ch_dis * channel)) = timing->period;
+	*((&PWM->PWM_CDTY0) + (ch_dis * channel)) = timing->duty_cycle;
+	if (reenable == 1) {
+		pwm_enable_channel(channel);
+	}
+	return 1;
+}
+/*
+ * This function will make channel 0 and the given channels synchronous.
+ */
+uint8_t pwm_sync_channels(uint32_t channels, uint32_t update_mode,
+		uint32_t update_period) {
+	if (channels > PWM_SCM_SYNC_MASK || update_mode > PWM_SYNC_UPDATE_PDC ||
+			update_period > PWM_SCUP_UPR_MASK) {
+		return 0; // parameter error
+	}
+	PWM->PWM_SCM = (PWM->PWM_SCM & ~(PWM_SCM_SYNC_MASK | PWM_SCM_UPDM_MASK)) |
+			channels | 0x1u | (update_mode << 16);
+	PWM->PWM_SCUP = update_period;
+	return 1;
+}
+/*
+ * This function will unlock the update of the synchronous channels.
+ */
+uint8_t pwm_sync_update(void) {
+	PWM->PWM_SCUC = PWM_SCUC_UPDULOCK_MASK;
+	return 1;
+}
+/*
+ * This function will write the duty cycles of several channels and commit
+ * the synchronous ones together.
+ */
+uint8_t pwm_set_duty_cycles(uint32_t channels, const uint32_t duty_cycles[]) {
+	uint32_t *p_reg;
+	// PWM_SR is read once instead of once per channel
+	uint32_t enabled = PWM->PWM_SR;
+	uint32_t channel;
+	if (channels > PWM_SCM_SYNC_MASK || duty_cycles == 0) {
+		return 0; // parameter error
+	}
+	for (channel = 0; channel < 8; channel++) {
+		if (!(channels & (0x1u << channel))) {
+			continue;
+		}
+		if (enabled & (0x1u << channel)) {
+			p_reg = (&PWM->PWM_CDTYUPD0) + (ch_dis * channel);
+		} else {
+			p_reg = (&PWM->PWM_CDTY0) + (ch_dis * channel);
+		}
+		*p_reg = duty_cycles[channel] & PWM_CDTYx_CDTY_MASK;
+	}
+	if (channels & PWM->PWM_SCM & PWM_SCM_SYNC_MASK) {
+		PWM->PWM_SCUC = PWM_SCUC_UPDULOCK_MASK;
+	}
+	return 1;
+}
+/*
+ * This function counts the synchronous channels.
+ */
+static uint32_t sync_channel_count(void) {
+	uint32_t sync = PWM->PWM_SCM & PWM_SCM_SYNC_MASK;
+	uint32_t count = 0;
+	while (sync) {
+		count += sync & 0x1u;
+		sync >>= 1;
+	}
+	return count;
+}
+/*
+ * This function will send the duty cycles with the PDC, as two halves.
+ */
+uint8_t pwm_sync_dma_start(uint16_t *buffer, uint32_t half_updates,
+		pwm_sync_callback_t callback) {
+	uint32_t channels = sync_channel_count();
+	uint32_t half_count = half_updates * channels;
+	if (buffer == 0 || half_updates == 0 || half_count > PWM_PDC_MAX_COUNT ||
+			(PWM->PWM_SCM & PWM_SCM_UPDM_MASK) !=
+					(PWM_SYNC_UPDATE_PDC << 16)) {
+		return 0; // parameter error
+	}
+	pwm_sync_dma_stop();
+	sync_dma.half[0] = buffer;
+	sync_dma.half[1] = buffer + half_count;
+	sync_dma.half_updates = half_updates;
+	sync_dma.half_count = half_count;
+	sync_dma.sending = 0;
+	sync_dma.halves = 0;
+	sync_dma.callback = callback;
+
+	PWM->PWM_IER2 = PWM_ISR2_ENDTX_MASK;
+	NVIC_ISER1 = (0x1u << (ID_PWM - 32));
+	pdc_tx_start_ping_pong(PDC_OF(PWM), sync_dma.half[0], sync_dma.half[1],
+			half_count);
+	return 1;
+}
+/*
+ * This function will stop the PDC.
+ */
+void pwm_sync_dma_stop(void) {
+	PWM->PWM_IDR2 = PWM_ISR2_ENDTX_MASK;
+	pdc_tx_stop(PDC_OF(PWM));
+	NVIC_ICER1 = (0x1u << (ID_PWM - 32));
+}
+/*
+ * This function returns the number of halves sent.
+ */
+uint32_t pwm_sync_dma_halves(void) {
+	return sync_dma.halves;
+}
+#if PWM_COOS
+/*
+ * This function sets the event flag of the PDC halves.
+ */
+void pwm_sync_set_flag(uint8_t flag) {
+	sync_dma.flag = flag;
+}
+#endif
+/*
+ * The PWM interrupt, the PDC has sent a half of the duty cycle buffer.
+ */
+void PWM_Handler(void) {
+	uint32_t sent;
+	// reading ISR2 clears its flags, so it is read once
+	uint32_t status = PWM->PWM_ISR2 & PWM->PWM_IMR2;
+
+	if (status & PWM_ISR2_ENDTX_MASK) {
+		// The sent half is queued as the next buffer
+		sent = sync_dma.sending;
+		sync_dma.sending ^= 1u;
+		pdc_tx_next(PDC_OF(PWM), sync_dma.half[sent], sync_dma.half_count);
+		sync_dma.halves++;
+		if (sync_dma.callback) {
+			sync_dma.callback(sync_dma.half[sent], sync_dma.half_updates);
+		}
+#if PWM_COOS
+		if (sync_dma.flag != PWM_NO_FLAG) {
+			isr_SetFlag(sync_dma.flag);
+		}
+#endif
+	}
+}
@@ -27,11 +27,19 @@
 #define PWM_H_
 
 #include <inttypes.h>
+#include "periph.h"
+#include "pmc.h"
 
-/**
- * The Master clock speed of the SAM3X8E microprocessor.
+/*
+ * Set to 0 to build without the CoOS event flag support, e.g. when the RTOS
+ * is not linked into the application.
  */
-#define SYS_CLK_FREQ		84000000
+#ifndef PWM_COOS
+#define PWM_COOS	(1)
+#endif
+
+// No event flag is set when a half of the duty cycle buffer has been sent
+#define PWM_NO_FLAG	(0xFFu)
 
 ///@{
 /**
@@ -124,7 +132,7 @@
 #define PWM_CMRx_CPRE_MASK				(0x0000000Fu)
 #define PWM_CMRx_CALG_MASK				(0x0100u)//(1 << 8)
 #define PWM_CMRx_CPOL_MASK				(0x0200u)//(1 << 9)
-#define PWM_CMRx_CES_MASK				(0x040u)//(1 << 10)
+#define PWM_CMRx_CES_MASK				(0x0400u)//(1 << 10)
 #define PWM_CMRx_DTE_MASK				(0x010000u)//(1 << 16)
 #define PWM_CMRx_DTHI_MASK				(0x020000u)//(1 << 17)
 #define PWM_CMRx_DTLI_MASK				(0x040000u)//(1 << 18)
@@ -151,6 +159,104 @@
 #define PWM_CPRDx_CPRD_MASK				(0x0000FFFFu)
 #define PWM_CPRDUPDx_CPRDUPD_MASK		(0x0000FFFFu)
 ///@}
+///@{
+/**
+ * This is the mask for the PWM_CCNTx, the counter of the channel.
+ *
+ * MASKs are being defined like this:
+ * [PERIPHERAL]_[REGISTER]_[SECTION]_MASK
+ */
+#define PWM_CCNTx_CNT_MASK				(0x00FFFFFFu)
+///@}
+///@{
+/**
+ * These are masks for the comparison units (PWM_CMPVx and PWM_CMPMx) and the
+ * event line mode registers (PWM_ELMRx). The comparison units compare with
+ * the counter of channel 0.
+ *
+ * MASKs are being defined like this:
+ * [PERIPHERAL]_[REGISTER]_[SECTION]_MASK
+ */
+#define PWM_CMPVx_CV_MASK				(0x00FFFFFFu)
+#define PWM_CMPVx_CVM_MASK				(0x01000000u)//(1 << 24)
+#define PWM_CMPMx_CEN_MASK				(0x00000001u)//(1 << 0)
+#define PWM_ELMRx_CSEL_MASK				(0x000000FFu)
+///@}
+///@{
+/**
+ * These are masks for the dead-time registers (PWM_DTx, PWM_DTUPDx) and the
+ * fault protection registers (PWM_FMR, PWM_FSR, PWM_FPV, PWM_FPEx).
+ *
+ * MASKs are being defined like this:
+ * [PERIPHERAL]_[REGISTER]_[SECTION]_MASK
+ */
+#define PWM_DTx_DTH_MASK				(0x0000FFFFu)
+#define PWM_DTx_DTL_MASK				(0xFFFF0000u)
+#define PWM_FMR_FPOL_MASK				(0x000000FFu)
+#define PWM_FMR_FMOD_MASK				(0x0000FF00u)
+#define PWM_FMR_FFIL_MASK				(0x00FF0000u)
+#define PWM_FSR_FIV_MASK				(0x000000FFu)
+#define PWM_FSR_FS_MASK					(0x0000FF00u)
+#define PWM_FPV_FPVH_MASK				(0x000000FFu)
+#define PWM_FPV_FPVL_MASK				(0x00FF0000u)
+///@}
+///@{
+/**
+ * These are masks for the synchronous channel registers (PWM_SCM, PWM_SCUC,
+ * PWM_SCUP), the interrupt register 2 and the PDC (PWM_PTCR).
+ *
+ * MASKs are being defined like this:
+ * [PERIPHERAL]_[REGISTER]_[SECTION]_MASK
+ */
+#define PWM_SCM_SYNC_MASK				(0x000000FFu)
+#define PWM_SCM_UPDM_MASK				(0x00030000u)//(3 << 16)
+#define PWM_SCUC_UPDULOCK_MASK			(0x00000001u)
+#define PWM_SCUP_UPR_MASK				(0x0000000Fu)
+#define PWM_ISR2_ENDTX_MASK				(0x00000002u)//(1 << 1)
+#define PWM_PTCR_TXTEN_MASK				(0x00000100u)//(1 << 8)
+#define PWM_PTCR_TXTDIS_MASK			(0x00000200u)//(1 << 9)
+///@}
+///@{
+/**
+ * Update modes of the synchronous channels, see pwm_sync_channels().
+ *
+ * Parameters are being defined like this:
+ * [PERIPHERAL]_SYNC_[PARAMETER]_VALUE
+ */
+#define PWM_SYNC_UPDATE_MANUAL			(0)	///<Period and duty cycle on pwm_sync_update()
+#define PWM_SYNC_UPDATE_AUTO			(1)	///<Duty cycle every update period
+#define PWM_SYNC_UPDATE_PDC				(2)	///<Duty cycle from the PDC every update period
+///@}
+///@{
+/**
+ * The two event lines that can trigger the ADC.
+ */
+#define PWM_EVENT_LINE_0				(0)
+#define PWM_EVENT_LINE_1				(1)
+///@}
+///@{
+/**
+ * The fault inputs, one bit each in the fault masks. Inputs 0-2 are the
+ * PWMFI0-2 pins (set them to their peripheral function with the PIO), the
+ * others are internal fault sources.
+ */
+#define PWM_FAULT_INPUT_0				(0x01u)
+#define PWM_FAULT_INPUT_1				(0x02u)
+#define PWM_FAULT_INPUT_2				(0x04u)
+#define PWM_FAULT_INPUT_3				(0x08u)
+#define PWM_FAULT_INPUT_4				(0x10u)
+#define PWM_FAULT_INPUT_5				(0x20u)
+#define PWM_FAULT_INPUT_6				(0x40u)
+#define PWM_FAULT_INPUT_7				(0x80u)
+#define PWM_FAULT_INPUT_ALL				(0xFFu)
+///@}
+///@{
+/**
+ * Levels the outputs of a channel are forced to during a fault.
+ */
+#define PWM_FAULT_OUTPUT_LOW			(0)
+#define PWM_FAULT_OUTPUT_HIGH			(1)
+///@}
 
 //PESCALLERS FOR CHANNEL MODE AND CLOCK REGISTER
 ///@{
@@ -197,6 +303,22 @@
 #define PWM_CHANNEL_ALIGN_LEFT			0
 #define PWM_CHANNEL_ALIGN_CENTER		1
 ///@}
+
+/**
+ * Composes the prescaler, alignment and polarity fields of PWM_CMRx, so they
+ * are written with one store. With constant arguments the value is folded
+ * at compile time.
+ * @param prescaler The channel prescaler. Prefix: PWM_PRES_
+ * @param alignment The alignment. Prefix: PWM_CHANNEL_ALIGN_
+ * @param polarity The polarity. Prefix: PWM_CHANNEL_POLARITY_
+ * @return The fields of the PWM_CMRx value.
+ */
+static inline uint32_t pwm_cmr_value(uint32_t prescaler, uint32_t alignment,
+		uint32_t polarity) {
+	return (prescaler & PWM_CMRx_CPRE_MASK) |
+			((alignment << 8) & PWM_CMRx_CALG_MASK) |
+			((polarity << 9) & PWM_CMRx_CPOL_MASK);
+}
 ///@{
 /**
  * CLKx_IDs
@@ -208,7 +330,7 @@
 
 ///@cond
 // Pointer to registers of the PWM peripheral.
-#define PWM ((pwm_reg_t *) 0x40094000U)
+#define PWM ((pwm_reg_t *) PERIPH_ADDR(0x40094000U))
 ///@endcond
 
 ///@{
@@ -226,37 +348,45 @@ typedef struct pwm_reg {
 	uint32_t PWM_IDR1; ///< Not used
 	uint32_t PWM_IMR1; ///< Not used
 	uint32_t PWM_ISR1; ///< Not used
-	uint32_t PWM_SCM; ///< Not used
-	uint32_t reserved0; ///< Not used
-	uint32_t PWM_SCUC; ///< Not used
-	uint32_t PWM_SCUP; ///< Not used
-	uint32_t PWM_SCUPUPD; ///< Not used
-	uint32_t PWM_IER2; ///< Not used
-	uint32_t PWM_IDR2; ///< Not used
-	uint32_t PWM_IMR2; ///< Not used
-	uint32_t PWM_ISR2; ///< Not used
+	uint32_t PWM_SCM; ///< PWM Sync Channels Mode Register, offset 0x020
+	uint32_t PWM_DMAR; ///< PWM DMA Register, offset 0x024
+	uint32_t PWM_SCUC; ///< PWM Sync Channels Update Control Register, offset 0x028
+	uint32_t PWM_SCUP; ///< PWM Sync Channels Update Period Register, offset 0x02C
+	uint32_t PWM_SCUPUPD; ///< PWM Sync Channels Update Period Update Register, offset 0x030
+	uint32_t PWM_IER2; ///< PWM Interrupt Enable Register 2, offset 0x034
+	uint32_t PWM_IDR2; ///< PWM Interrupt Disable Register 2, offset 0x038
+	uint32_t PWM_IMR2; ///< PWM Interrupt Mask Register 2, offset 0x03C
+	uint32_t PWM_ISR2; ///< PWM Interrupt Status Register 2, offset 0x040
 	uint32_t PWM_OOV; ///< Not used
 	uint32_t PWM_OS; ///< Not used
 	uint32_t PWM_OSS; ///< Not used
 	uint32_t PWM_OSC; ///< Not used
 	uint32_t PWM_OSSUPD; ///< Not used
 	uint32_t PWM_OSCUPD; ///< Not used
-	uint32_t PWM_FMR; ///< Not used
-	uint32_t PWM_FSR; ///< Not used
-	uint32_t PWM_FCR; ///< Not used
-	uint32_t PWM_FPV; ///< Not used
-	uint32_t PWM_FPE1; ///< Not used
-	uint32_t PWM_FPE2; ///< Not used
+	uint32_t PWM_FMR; ///< PWM Fault Mode Register, offset 0x05C
+	uint32_t PWM_FSR; ///< PWM Fault Status Register, offset 0x060
+	uint32_t PWM_FCR; ///< PWM Fault Clear Register, offset 0x064
+	uint32_t PWM_FPV; ///< PWM Fault Protection Value Register, offset 0x068
+	uint32_t PWM_FPE1; ///< PWM Fault Protection Enable Register 1, offset 0x06C
+	uint32_t PWM_FPE2; ///< PWM Fault Protection Enable Register 2, offset 0x070
 	uint32_t reserved1[2]; ///< Not used
-	uint32_t PWM_ELMR0; ///< Not used
-	uint32_t PWM_ELMR1; ///< Not used
+	uint32_t PWM_ELMR0; ///< PWM Event Line 0 Mode Register, offset 0x07C
+	uint32_t PWM_ELMR1; ///< PWM Event Line 1 Mode Register, offset 0x080
 	uint32_t reserved2[11]; ///< Not used
 	uint32_t PWM_SMMR; ///< Not used
 	uint32_t reserved3[12]; ///< Not used
 	uint32_t PWM_WPCR; ///< Not used
 	uint32_t PWM_WPSR; ///< Not used
 	uint32_t reserved4[5]; ///< Not used
-	uint32_t Reserved_for_PDC_registers5[11]; ///< Not used
+	uint32_t reserved5[2]; ///< Not used (no receive PDC)
+	uint32_t PWM_TPR; ///< Transmit Pointer Register, offset 0x108
+	uint32_t PWM_TCR; ///< Transmit Counter Register, offset 0x10C
+	uint32_t reserved8[2]; ///< Not used (no receive PDC)
+	uint32_t PWM_TNPR; ///< Transmit Next Pointer Register, offset 0x118
+	uint32_t PWM_TNCR; ///< Transmit Next Counter Register, offset 0x11C
+	uint32_t PWM_PTCR; ///< Transfer Control Register, offset 0x120
+	uint32_t PWM_PTSR; ///< Transfer Status Register, offset 0x124
+	uint32_t reserved9; ///< Not used
 	uint32_t reserved6; ///< Not used
 	uint32_t PWM_CMPV0; ///< Not used
 	uint32_t PWM_CMPVUPD0; ///< Not used
@@ -388,10 +518,66 @@ typedef struct pwm_channel_setting {
 	uint32_t use_CLKx; ///<Must be 1 or 0 to indicate whether to use one of the CLKx clocks to set the frequency or just the channel prescalers and period must be used.
 	uint32_t frequency; ///<The frequency of the PWM waveform for this channel.
 	uint32_t clock_ID; ///<In case that use_CLKx is set to 1, then clock_ID must specify which CLKx can be used for this purpose. Prefix: PWM_CLK_ID_
+	uint32_t dead_time_high; ///<Dead-time of PWMHx, in channel clock periods. 0 and a dead_time_low of 0 disable the dead-time generator. (Optional)
+	uint32_t dead_time_low; ///<Dead-time of PWMLx, in channel clock periods. (Optional)
 } pwm_channel_setting_t;
 ///@}
 
 
+///@{
+/**
+ * @typedef pwm_timing_t
+ * A solved channel timing, see pwm_solve_timing() and PWM_TIMING(). It can
+ * be applied many times with pwm_apply_timing() without any division.
+ */
+typedef struct pwm_timing {
+	uint16_t period; ///<Channel period (CPRD)
+	uint16_t duty_cycle; ///<Channel duty cycle (CDTY)
+	uint8_t prescaler; ///<Channel prescaler (CPRE). Prefix: PWM_PRES_MCK_DIV_
+	uint8_t alignment; ///<Alignment it is solved for. Prefix: PWM_CHANNEL_ALIGN_
+} pwm_timing_t;
+
+/**
+ * A duty cycle for pwm_solve_timing() and PWM_TIMING(), as a fraction
+ * num/den of the period with 16 fractional bits.
+ */
+#define PWM_DUTY(num, den)	((uint32_t) (((uint64_t) (num) << 16) / (den)))
+
+///@cond
+// MCK cycles per period at the lowest prescaler
+#define _PWM_RATIO(frequency, alignment) \
+	(SYS_CLK_FREQ / ((frequency) * ((alignment) + 1u)))
+// Lowest prescaler that gives a period of at most 0xFFFF
+#define _PWM_PRES(r) \
+	((r) <= 0xFFFFu ? 0u : (r) <= 0x1FFFFu ? 1u : (r) <= 0x3FFFFu ? 2u : \
+	 (r) <= 0x7FFFFu ? 3u : (r) <= 0xFFFFFu ? 4u : (r) <= 0x1FFFFFu ? 5u : \
+	 (r) <= 0x3FFFFFu ? 6u : (r) <= 0x7FFFFFu ? 7u : (r) <= 0xFFFFFFu ? 8u : \
+	 (r) <= 0x1FFFFFFu ? 9u : 10u)
+#define _PWM_PERIOD(r) \
+	((r) >> _PWM_PRES(r))
+///@endcond
+
+/**
+ * A constant pwm_timing_t, solved by the compiler in the same way as
+ * pwm_solve_timing(), e.g. for a table of timings in flash:
+ *
+ *     static const pwm_timing_t steps[] = {
+ *         PWM_TIMING(20000, PWM_DUTY(1, 2), PWM_CHANNEL_ALIGN_LEFT),
+ *         PWM_TIMING(25000, PWM_DUTY(1, 2), PWM_CHANNEL_ALIGN_LEFT)
+ *     };
+ *
+ * @param freq The frequency in Hz (at least 2 Hz, 1 Hz centered).
+ * @param duty The duty cycle, see PWM_DUTY().
+ * @param align Prefix: PWM_CHANNEL_ALIGN_
+ */
+#define PWM_TIMING(freq, duty, align) { \
+	.period = _PWM_PERIOD(_PWM_RATIO(freq, align)), \
+	.duty_cycle = (_PWM_PERIOD(_PWM_RATIO(freq, align)) * \
+			(uint64_t) (duty)) >> 16, \
+	.prescaler = _PWM_PRES(_PWM_RATIO(freq, align)), \
+	.alignment = (align) }
+///@}
+
 ///@{
 // Function Prototypes
 /**
@@ -609,5 +795,204 @@ uint8_t pwm_reset_channel(uint32_t channel);
  */
 uint8_t pwm_reset_peripheral(void);
 ///@}
+///@{
+/**
+ * Generates a pulse on an event line at the requested rate, e.g. to trigger
+ * ADC conversions (see adc_set_sample_rate()) without any interrupt.
+ * The period of channel 0 is set with pwm_set_channel_frequency() and
+ * comparison unit 0 or 1 (the same number as the line) matches once in every
+ * period. Channel 0 is enabled, its duty cycle and output are left as they
+ * are.
+ *
+ * @param event_line The event line, use prefix: PWM_EVENT_LINE_
+ * @param frequency The rate of the events in Hz.
+ * @return The actual rate in Hz, or 0 = FAIL
+ */
+uint32_t pwm_set_event_rate(uint32_t event_line, uint32_t frequency);
+/**
+ * Adds a comparison unit to an event line. The unit matches when the counter
+ * of channel 0 reaches value, so the event can be placed anywhere in the
+ * period, e.g. at value = period of a center aligned channel 0 to start ADC
+ * conversions in the middle of the pulses of a motor drive. Units already on
+ * the line stay on it.
+ *
+ * @param event_line The event line, use prefix: PWM_EVENT_LINE_
+ * @param comparison The comparison unit (0-7).
+ * @param value The counter value of the match (up to the period of channel 0).
+ * @param down Center aligned only: 1 to match while the counter decrements,
+ * 0 while it increments.
+ * @return error, 1 = SUCCESS and 0 = FAIL
+ */
+uint8_t pwm_set_event_compare(uint32_t event_line, uint32_t comparison,
+		uint32_t value, uint32_t down);
+/**
+ * Removes a comparison unit from an event line and disables it. The other
+ * units on the line stay on it.
+ *
+ * @param event_line The event line, use prefix: PWM_EVENT_LINE_
+ * @param comparison The comparison unit (0-7).
+ * @return error, 1 = SUCCESS and 0 = FAIL
+ */
+uint8_t pwm_clear_event_compare(uint32_t event_line, uint32_t comparison);
+///@}
+///@{
+/**
+ * Sets the dead-time of a channel and enables its dead-time generator, which
+ * makes PWMHx and PWMLx complementary outputs with a delayed rising edge
+ * each. Both values 0 disable the generator. The update is taken at the next
+ * period if the channel is enabled.
+ *
+ * @param channel The channel, use prefix: PWM_CHANNEL_
+ * @param dead_time_high Delay of the PWMHx rising edge, at most period minus
+ * duty cycle.
+ * @param dead_time_low Delay of the PWMLx rising edge, at most the duty cycle.
+ * @return error, 1 = SUCCESS and 0 = FAIL
+ */
+uint8_t pwm_set_channel_dead_time(uint32_t channel, uint32_t dead_time_high,
+		uint32_t dead_time_low);
+/**
+ * Sets the fault inputs. The fault protection forces the outputs of the
+ * channels that use an input (see pwm_set_channel_fault()) in hardware,
+ * without any interrupt, as soon as the input is active.
+ *
+ * @param active_high The inputs that are active at level 1, one bit each
+ * (prefix: PWM_FAULT_INPUT_). The others are active at level 0.
+ * @param latched The inputs whose faults stay until pwm_clear_fault(), the
+ * others end when the input is inactive.
+ * @param filtered The inputs that go through the glitch filter.
+ * @return error, 1 = SUCCESS and 0 = FAIL
+ */
+uint8_t pwm_set_fault_mode(uint32_t active_high, uint32_t latched,
+		uint32_t filtered);
+/**
+ * Sets the fault inputs that shut down a channel and the levels its outputs
+ * are forced to.
+ *
+ * @param channel The channel, use prefix: PWM_CHANNEL_
+ * @param inputs The fault inputs, one bit each (prefix: PWM_FAULT_INPUT_),
+ * or 0 to disable the protection of the channel.
+ * @param high_level Level of PWMHx during a fault, prefix: PWM_FAULT_OUTPUT_
+ * @param low_level Level of PWMLx during a fault, prefix: PWM_FAULT_OUTPUT_
+ * @return error, 1 = SUCCESS and 0 = FAIL
+ */
+uint8_t pwm_set_channel_fault(uint32_t channel, uint32_t inputs,
+		uint32_t high_level, uint32_t low_level);
+/**
+ * Reads the faults that are active, one bit per fault input.
+ * @return The active faults, prefix: PWM_FAULT_INPUT_
+ */
+uint32_t pwm_get_faults(void);
+/**
+ * Clears latched faults. A fault stays if its input is still active.
+ * @param inputs The fault inputs to clear, prefix: PWM_FAULT_INPUT_
+ * @return error Will always return 1 = SUCCESS
+ */
+uint8_t pwm_clear_fault(uint32_t inputs);
+///@}
+///@{
+/**
+ * Solves the prescaler, period and duty cycle for a frequency with one
+ * division. The lowest prescaler that fits the period in 16 bits is used, for
+ * the highest resolution.
+ *
+ * @param frequency The frequency in Hz.
+ * @param duty The duty cycle, see PWM_DUTY() (0 - 65536).
+ * @param alignment Prefix: PWM_CHANNEL_ALIGN_
+ * @param timing The solved timing.
+ * @return error, 1 = SUCCESS and 0 = FAIL (the frequency cannot be reached)
+ */
+uint8_t pwm_solve_timing(uint32_t frequency, uint32_t duty,
+		uint32_t alignment, pwm_timing_t *timing);
+/**
+ * Applies a solved timing to a channel. When the channel is enabled with the
+ * same prescaler and alignment, the period and duty cycle are written to the
+ * update registers (CPRDUPD, CDTYUPD) and take effect at the end of the
+ * period, without disabling the channel. Otherwise the channel is
+ * configured (and re-enabled if it was enabled) as pwm_init_channel() does.
+ *
+ * @param channel The channel, use prefix: PWM_CHANNEL_
+ * @param timing The timing from pwm_solve_timing() or PWM_TIMING().
+ * @return error, 1 = SUCCESS and 0 = FAIL
+ */
+uint8_t pwm_apply_timing(uint32_t channel, const pwm_timing_t *timing);
+///@}
+///@{
+/**
+ * Groups channels as synchronous. They share the period and counter of
+ * channel 0, which is always part of the group, and are enabled and
+ * disabled together with it. Their period and duty cycle updates take
+ * effect together, at the end of the update period.
+ *
+ * @param channels The channels, one bit per channel (bit 0 is set anyway).
+ * @param update_mode Use prefix: PWM_SYNC_UPDATE_
+ * @param update_period The number of periods between updates, minus one
+ * (0-15).
+ * @return error, 1 = SUCCESS and 0 = FAIL
+ */
+uint8_t pwm_sync_channels(uint32_t channels, uint32_t update_mode,
+		uint32_t update_period);
+/**
+ * Commits the period and duty cycles written to the update registers of the
+ * synchronous channels (the period in every update mode, the duty cycles in
+ * PWM_SYNC_UPDATE_MANUAL) at the end of the next update period.
+ *
+ * @return error Will always return 1 = SUCCESS
+ */
+uint8_t pwm_sync_update(void);
+/**
+ * Sets the duty cycles of several channels with one call. The update
+ * registers of the enabled channels are written first, then the update of
+ * the synchronous channels is unlocked (see pwm_sync_update()). The channels
+ * grouped with pwm_sync_channels() in PWM_SYNC_UPDATE_MANUAL mode therefore
+ * take their new duty cycles together at the end of the next update period,
+ * without tearing between them. The other channels take theirs at the end
+ * of their own period, disabled channels at once.
+ *
+ * @param channels The channels, one bit per channel.
+ * @param duty_cycles The duty cycles, indexed by channel number. Only the
+ * entries of the channels in the mask are read.
+ * @return error, 1 = SUCCESS and 0 = FAIL
+ */
+uint8_t pwm_set_duty_cycles(uint32_t channels, const uint32_t duty_cycles[]);
+/**
+ * Called from the PWM interrupt when a half of the duty cycle buffer has been
+ * sent. The half is sent again after the other half, so new duty cycles can
+ * be written to it now.
+ * @param duty_cycles The sent half, updates * channels values.
+ * @param updates The number of updates in it.
+ */
+typedef void (*pwm_sync_callback_t)(uint16_t *duty_cycles, uint32_t updates);
+/**
+ * Starts updating the duty cycles of the synchronous channels from a
+ * circular buffer with the PDC (PWM_SYNC_UPDATE_PDC). Each update period the
+ * PDC writes one duty cycle per synchronous channel, in channel order, so
+ * the buffer is a sequence of updates, each with one value per channel.
+ * It is sent as two halves (ping-pong).
+ *
+ * @param buffer The buffer, 2 * half_updates updates.
+ * @param half_updates The number of updates in each half.
+ * @param callback Called when a half has been sent, or 0.
+ * @return error, 1 = SUCCESS and 0 = FAIL
+ */
+uint8_t pwm_sync_dma_start(uint16_t *buffer, uint32_t half_updates,
+		pwm_sync_callback_t callback);
+/**
+ * Stops the duty cycle updates from the PDC.
+ */
+void pwm_sync_dma_stop(void);
+/**
+ * The number of halves sent since pwm_sync_dma_start().
+ * @return The number of halves.
+ */
+uint32_t pwm_sync_dma_halves(void);
+#if PWM_COOS
+/**
+ * Sets a CoOS event flag (isr_SetFlag()) when a half of the duty cycle
+ * buffer has been sent.
+ * @param flag The event flag, or PWM_NO_FLAG.
+ */
+void pwm_sync_set_flag(uint8_t flag);
+#endif
+///@}
 
 #endif /* PWM_H_ */
@@ -0,0 +1,52 @@
+/**
+ * @file ramfunc.h
+ * @brief Placement of code in SRAM or in the second flash bank
+ * @details The flash runs with wait states at 84 MHz and stalls while one
+ * of its banks is erased or programmed. Functions marked RAMFUNC go to the
+ * .ramfunc section, which the startup code copies to SRAM with .data (the
+ * Atmel linker scripts of the SAM3X put it in .relocate), and run without
+ * wait states and while the flash is busy.
+ *
+ * Functions marked BANK1FUNC go to the .bank1 section, for code that must
+ * keep running while bank 0 is programmed, or the other way round. The
+ * linker script needs an output section for it in bank 1, e.g.
+ * @code
+ *	MEMORY { ... rom1 (rx) : ORIGIN = 0x000C0000, LENGTH = 0x00040000 }
+ *	.bank1 : { . = ALIGN(4); *(.bank1 .bank1.*) } > rom1
+ * @endcode
+ * and bank 0 the code that is not marked.
+ *
+ * Both are called with long calls, SRAM and bank 1 are beyond the reach of
+ * a branch from bank 0. A RAMFUNC must only call functions that are RAMFUNC
+ * too or inline while the flash is busy.
+ *
+ * The hot paths of the drivers and of CoOS (PendSV_Handler(), DMAC_Handler()
+ * and the TFT bus writers) are marked RAMFUNC_HOT. They are put in SRAM when
+ * RAMFUNC_HOT_EN is defined to 1, which costs about 1 KB of SRAM.
+ * @date 14 October 2026
+ */
+
+#ifndef RAMFUNC_H_
+#define RAMFUNC_H_
+
+/// Run the function from SRAM
+#define RAMFUNC		__attribute__((section(".ramfunc"), noinline, long_call))
+
+/// Run the function from flash bank 1
+#define BANK1FUNC	__attribute__((section(".bank1"), noinline, long_call))
+
+/*
+ * Set to 1 to put the hot paths of the drivers and CoOS in SRAM.
+ */
+#ifndef RAMFUNC_HOT_EN
+#define RAMFUNC_HOT_EN	(0)
+#endif
+
+#if RAMFUNC_HOT_EN
+/// Run the function from SRAM with RAMFUNC_HOT_EN
+#define RAMFUNC_HOT	RAMFUNC
+#else
+#define RAMFUNC_HOT
+#endif
+
+#endif
@@ -0,0 +1,427 @@
+/**
+ * @file ring.h
+ * @brief Ring - Lock-free FIFOs shared between tasks and interrupt handlers
+ * @details Two FIFOs that work without masking interrupts, both sized in a
+ * power of 2 with free-running indices:
+ *
+ * ring_t is a single producer, single consumer ring of bytes, e.g. an
+ * interrupt handler filling it and a task emptying it. Each index is only
+ * written by its own side with a plain store, a memory barrier orders the
+ * data before the index. Bytes are pushed and popped one at a time or in
+ * bulk, and the contiguous free or used part can be handed to a DMA or PDC
+ * transfer without a copy:
+ * @code
+ *	static uint8_t data[256];
+ *	static ring_t rx = RING_INIT(data, sizeof(data));
+ *
+ *	// producer, e.g. the end of a PDC block
+ *	uint8_t *span;
+ *	uint32_t n = ring_write_span(&rx, &span);
+ *	// ... transfer at most n bytes to span, then
+ *	ring_write_commit(&rx, n);
+ *
+ *	// consumer
+ *	n = ring_read(&rx, line, sizeof(line));
+ * @endcode
+ *
+ * ring_mpsc_t is a bounded queue of words with any number of producers and
+ * one consumer, e.g. the interrupt handlers and tasks that post work to one
+ * task. A producer claims a cell with LDREX/STREX on the head and marks it
+ * full with a sequence number once the word is stored, the same scheme as
+ * the service request queue of CoOS. A producer interrupted between the
+ * claim and the mark only holds up the consumer at that cell.
+ *
+ * The producer functions of a ring_t must only be called from one context at
+ * a time, and so must its consumer functions and those of a ring_mpsc_t.
+ * @date 14 October 2026
+ */
+
+#ifndef RING_H_
+#define RING_H_
+
+#include <inttypes.h>
+#include <string.h>
+#include "periph.h"
+
+/**
+ * A single producer, single consumer ring of bytes, see RING_INIT() and
+ * ring_init().
+ */
+typedef struct ring {
+	uint8_t *data;				///< The buffer
+	uint32_t mask;				///< Size of the buffer - 1
+	volatile uint32_t head;		///< Written by the producer
+	volatile uint32_t tail;		///< Written by the consumer
+} ring_t;
+
+/**
+ * A cell of a ring_mpsc_t.
+ */
+typedef struct ring_cell {
+	volatile uint32_t seq;		///< Index the cell is free or full for
+	uint32_t value;				///< The word
+} ring_cell_t;
+
+/**
+ * A bounded multiple producer, single consumer queue of words, see
+ * ring_mpsc_init().
+ */
+typedef struct ring_mpsc {
+	ring_cell_t *cells;			///< The cells
+	uint32_t mask;				///< Number of cells - 1
+	volatile uint32_t head;		///< Next cell to claim, by the producers
+	uint32_t tail;				///< Next cell to take, by the consumer
+	volatile uint32_t dropped;	///< Pushes that found the queue full
+} ring_mpsc_t;
+
+/**
+ * Static initializer of an empty ring_t.
+ * @param data The buffer.
+ * @param size Size of the buffer, a power of 2.
+ */
+#define RING_INIT(data, size)	{ (data), (size) - 1, 0, 0 }
+
+///@cond
+#if PERIPH_HOST
+// Host tests are single threaded
+#define RING_BARRIER()		__asm volatile ("" ::: "memory")
+
+static inline uint8_t ring_cas(volatile uint32_t *word, uint32_t old,
+		uint32_t value) {
+	if (*word != old) {
+		return 0;
+	}
+	*word = value;
+	return 1;
+}
+#else
+// Orders the data before the index for the other side and for DMA
+#define RING_BARRIER()		__asm volatile ("dmb" ::: "memory")
+
+static inline uint8_t ring_cas(volatile uint32_t *word, uint32_t old,
+		uint32_t value) {
+	uint32_t cur, fail;
+
+	__asm volatile ("ldrex %0, [%1]" : "=r" (cur) : "r" (word) : "memory");
+	if (cur != old) {
+		__asm volatile ("clrex" ::: "memory");
+		return 0;
+	}
+	__asm volatile ("strex %0, %2, [%1]" : "=&r" (fail)
+			: "r" (word), "r" (value) : "memory");
+	return (fail == 0);
+}
+#endif
+///@endcond
+
+/**
+ * Initializes an empty ring.
+ * @param ring The ring.
+ * @param data The buffer.
+ * @param size Size of the buffer, a power of 2.
+ * @return 1 on success, 0 if the size is not a power of 2.
+ */
+static inline uint8_t ring_init(ring_t *ring, uint8_t *data, uint32_t size) {
+	if (size == 0 || (size & (size - 1)) != 0) {
+		return 0;
+	}
+	ring->data = data;
+	ring->mask = size - 1;
+	ring->head = 0;
+	ring->tail = 0;
+	return 1;
+}
+
+/**
+ * Empties the ring, neither side may use it meanwhile.
+ * @param ring The ring.
+ */
+static inline void ring_reset(ring_t *ring) {
+	ring->head = 0;
+	ring->tail = 0;
+}
+
+/**
+ * @param ring The ring.
+ * @return Number of bytes in the ring.
+ */
+static inline uint32_t ring_count(const ring_t *ring) {
+	return ring->head - ring->tail;
+}
+
+/**
+ * @param ring The ring.
+ * @return Number of bytes that can be pushed.
+ */
+static inline uint32_t ring_space(const ring_t *ring) {
+	return ring->mask + 1 - (ring->head - ring->tail);
+}
+
+/**
+ * Pushes a byte, called by the producer.
+ * @param ring The ring.
+ * @param byte The byte.
+ * @return 1 on success, 0 if the ring is full.
+ */
+static inline uint8_t ring_push(ring_t *ring, uint8_t byte) {
+	uint32_t head = ring->head;
+
+	if (head - ring->tail > ring->mask) {
+		return 0;
+	}
+	ring->data[head & ring->mask] = byte;
+	RING_BARRIER();
+	ring->head = head + 1;
+	return 1;
+}
+
+/**
+ * Reads the oldest byte without popping it, called by the consumer.
+ * @param ring The ring.
+ * @param byte Receives the byte.
+ * @return 1 on success, 0 if the ring is empty.
+ */
+static inline uint8_t ring_peek(const ring_t *ring, uint8_t *byte) {
+	uint32_t tail = ring->tail;
+
+	if (tail == ring->head) {
+		return 0;
+	}
+	RING_BARRIER();
+	*byte = ring->data[tail & ring->mask];
+	return 1;
+}
+
+/**
+ * Pops the oldest byte, called by the consumer.
+ * @param ring The ring.
+ * @param byte Receives the byte.
+ * @return 1 on success, 0 if the ring is empty.
+ */
+static inline uint8_t ring_pop(ring_t *ring, uint8_t *byte) {
+	if (!ring_peek(ring, byte)) {
+		return 0;
+	}
+	RING_BARRIER();
+	ring->tail++;
+	return 1;
+}
+
+/**
+ * Gets the contiguous free part of the ring after the head, called by the
+ * producer. The bytes stored there are pushed by ring_write_commit().
+ * @param ring The ring.
+ * @param span Receives the first free byte.
+ * @return Number of contiguous free bytes, up to the end of the buffer.
+ */
+static inline uint32_t ring_write_span(const ring_t *ring, uint8_t **span) {
+	uint32_t head = ring->head;
+	uint32_t index = head & ring->mask;
+	uint32_t space = ring->mask + 1 - (head - ring->tail);
+	uint32_t contiguous = ring->mask + 1 - index;
+
+	*span = ring->data + index;
+	return (space < contiguous) ? space : contiguous;
+}
+
+/**
+ * Pushes the bytes stored in the span of ring_write_span().
+ * @param ring The ring.
+ * @param len Number of bytes, at most the length of the span.
+ */
+static inline void ring_write_commit(ring_t *ring, uint32_t len) {
+	RING_BARRIER();
+	ring->head += len;
+}
+
+/**
+ * Gets the contiguous used part of the ring from the tail, called by the
+ * consumer. The bytes taken from there are popped by ring_read_release().
+ * @param ring The ring.
+ * @param span Receives the oldest byte.
+ * @return Number of contiguous bytes, up to the end of the buffer.
+ */
+static inline uint32_t ring_read_span(const ring_t *ring,
+		const uint8_t **span) {
+	uint32_t tail = ring->tail;
+	uint32_t index = tail & ring->mask;
+	uint32_t count = ring->head - tail;
+	uint32_t contiguous = ring->mask + 1 - index;
+
+	RING_BARRIER();
+	*span = ring->data + index;
+	return (count < contiguous) ? count : contiguous;
+}
+
+/**
+ * Pops the bytes taken from the span of ring_read_span().
+ * @param ring The ring.
+ * @param len Number of bytes, at most the length of the span.
+ */
+static inline void ring_read_release(ring_t *ring, uint32_t len) {
+	RING_BARRIER();
+	ring->tail += len;
+}
+
+/**
+ * Pushes as many bytes as fit, called by the producer.
+ * @param ring The ring.
+ * @param src The bytes.
+ * @param len Number of bytes.
+ * @return Number of bytes pushed.
+ */
+static inline uint32_t ring_write(ring_t *ring, const void *src,
+		uint32_t len) {
+	uint32_t head = ring->head;
+	uint32_t index = head & ring->mask;
+	uint32_t space = ring->mask + 1 - (head - ring->tail);
+	uint32_t first = ring->mask + 1 - index;
+
+	if (len > space) {
+		len = space;
+	}
+	if (first > len) {
+		first = len;
+	}
+	// up to the end of the buffer, then from its start
+	memcpy(ring->data + index, src, first);
+	memcpy(ring->data, (const uint8_t *) src + first, len - first);
+	RING_BARRIER();
+	ring->head = head + len;
+	return len;
+}
+
+/**
+ * Pops as many bytes as there are, up to len, called by the consumer.
+ * @param ring The ring.
+ * @param dst Receives the bytes.
+ * @param len Size of dst.
+ * @return Number of bytes popped.
+ */
+static inline uint32_t ring_read(ring_t *ring, void *dst, uint32_t len) {
+	uint32_t tail = ring->tail;
+	uint32_t index = tail & ring->mask;
+	uint32_t count = ring->head - tail;
+	uint32_t first = ring->mask + 1 - index;
+
+	if (len > count) {
+		len = count;
+	}
+	if (first > len) {
+		first = len;
+	}
+	RING_BARRIER();
+	memcpy(dst, ring->data + index, first);
+	memcpy((uint8_t *) dst + first, ring->data, len - first);
+	RING_BARRIER();
+	ring->tail = tail + len;
+	return len;
+}
+
+/**
+ * Initializes an empty queue.
+ * @param queue The queue.
+ * @param cells The cells.
+ * @param count Number of cells, a power of 2.
+ * @return 1 on success, 0 if the number is not a power of 2.
+ */
+static inline uint8_t ring_mpsc_init(ring_mpsc_t *queue, ring_cell_t *cells,
+		uint32_t count) {
+	uint32_t i;
+
+	if (count == 0 || (count & (count - 1)) != 0) {
+		return 0;
+	}
+	// cell i is free for index i
+	for (i = 0; i < count; i++) {
+		cells[i].seq = i;
+	}
+	queue->cells = cells;
+	queue->mask = count - 1;
+	queue->head = 0;
+	queue->tail = 0;
+	queue->dropped = 0;
+	return 1;
+}
+
+/**
+ * Pushes a word, called by any producer.
+ * @param queue The queue.
+ * @param value The word.
+ * @return 1 on success, 0 if the queue is full (counted in dropped).
+ */
+static inline uint8_t ring_mpsc_push(ring_mpsc_t *queue, uint32_t value) {
+	ring_cell_t *cell;
+	uint32_t pos;
+	int32_t diff;
+
+	for (;;) {
+		pos = queue->head;
+		cell = &queue->cells[pos & queue->mask];
+		diff = (int32_t) (cell->seq - pos);
+		if (diff == 0) {
+			if (ring_cas(&queue->head, pos, pos + 1)) {
+				break;
+			}
+		} else if (diff < 0) {
+			// the cell still holds the word of the lap before
+			do {
+				pos = queue->dropped;
+			} while (!ring_cas(&queue->dropped, pos, pos + 1));
+			return 0;
+		}
+		// claimed by another producer in between, try the next
+	}
+	cell->value = value;
+	RING_BARRIER();
+	cell->seq = pos + 1;
+	return 1;
+}
+
+/**
+ * Pops the oldest word, called by the consumer.
+ * @param queue The queue.
+ * @param value Receives the word.
+ * @return 1 on success, 0 if the queue is empty or its oldest cell is still
+ * being written.
+ */
+static inline uint8_t ring_mpsc_pop(ring_mpsc_t *queue, uint32_t *value) {
+	uint32_t pos = queue->tail;
+	ring_cell_t *cell = &queue->cells[pos & queue->mask];
+
+	if (cell->seq != pos + 1) {
+		return 0;
+	}
+	RING_BARRIER();
+	*value = cell->value;
+	RING_BARRIER();
+	// free for the index one lap later
+	cell->seq = pos + queue->mask + 1;
+	queue->tail = pos + 1;
+	return 1;
+}
+
+/**
+ * Pops up to len words, called by the consumer.
+ * @param queue The queue.
+ * @param values Receives the words.
+ * @param len Size of values.
+ * @return Number of words popped.
+ */
+static inline uint32_t ring_mpsc_pop_n(ring_mpsc_t *queue, uint32_t *values,
+		uint32_t len) {
+	uint32_t n;
+
+	for (n = 0; n < len && ring_mpsc_pop(queue, &values[n]); n++);
+	return n;
+}
+
+/**
+ * @param queue The queue.
+ * @return Number of cells claimed by the producers and not yet popped.
+ */
+static inline uint32_t ring_mpsc_count(const ring_mpsc_t *queue) {
+	return queue->head - queue->tail;
+}
+
+#endif
@@ -34,7 +34,10 @@ typedef U8                 OS_TCID;
 typedef U8                 OS_MutexID;
 typedef U8                 OS_EventID;
 typedef U8                 OS_FlagID;
+typedef U8                 OS_FlagGrpID;
 typedef U8                 OS_MMID;
+typedef U8                 OS_SBufID;
+typedef U8                 OS_WorkerID;
 typedef U8                 StatusType;
 typedef U16                OS_VER;
 typedef void               (*FUNCPtr)(void*);
@@ -99,6 +102,22 @@ typedef void               (*vFUNCPtr)(void);
 #endif
 
 
+/*---------------------------- Notify Actions  -------------------------------*/
+#if CFG_TASK_NOTIFY_EN >0
+#define NOTIFY_SET_BITS       0         /*!< Set bits in the value            */
+#define NOTIFY_INCREMENT      1         /*!< Increment the value              */
+#define NOTIFY_OVERWRITE      2         /*!< Overwrite the value              */
+#endif
+
+
+/*---------------------------- Idle Modes  -----------------------------------*/
+#if CFG_IDLE_SLEEP_EN >0
+#define IDLE_MODE_SLEEP       0         /*!< WFI,the system tick runs         */
+#define IDLE_MODE_TICKLESS    1         /*!< WFI,the system tick stopped      */
+#define IDLE_MODE_WAIT        2         /*!< Wait mode,all clocks stopped     */
+#endif
+
+
 /*---------------------------- Event Control ---------------------------------*/
 #if CFG_EVENT_EN >0
 #define EVENT_SORT_TYPE_FIFO  (U8)0x01  /*!< Insert a event by FIFO           */
@@ -106,6 +125,29 @@ typedef void               (*vFUNCPtr)(void);
 #endif
 
 
+/*---------------------------- Static Objects --------------------------------*/
+#ifndef CFG_STATIC_SEMS
+#define CFG_STATIC_SEMS(X)
+#endif
+#ifndef CFG_STATIC_QUEUES
+#define CFG_STATIC_QUEUES(X)
+#endif
+#ifndef CFG_STATIC_TMRS
+#define CFG_STATIC_TMRS(X)
+#endif
+#define OS_STATIC_ID(name,...)  name,   /*!< ID of a static object            */
+
+/*!< Task IDs of CFG_STATIC_TASKS,after the IDLE task.                        */
+enum { OS_STATIC_IDLE_ID, CFG_STATIC_TASKS(OS_STATIC_ID) OS_STATIC_TASK_END };
+#define OS_STATIC_TASKS       (OS_STATIC_TASK_END - 1)
+
+/*!< Event IDs of CFG_STATIC_SEMS and CFG_STATIC_QUEUES.                      */
+enum { CFG_STATIC_SEMS(OS_STATIC_ID) CFG_STATIC_QUEUES(OS_STATIC_ID) OS_STATIC_EVENTS };
+
+/*!< Timer IDs of CFG_STATIC_TMRS.                                            */
+enum { CFG_STATIC_TMRS(OS_STATIC_ID) OS_STATIC_TMRS };
+
+
 /*---------------------------- Function declare-------------------------------*/
 
 /* Implement in file "core.c"      */
@@ -118,6 +160,12 @@ extern void    CoSchedUnlock(void);
 extern OS_VER  CoGetOSVersion(void);    /*!< Get OS version value             */
 
 
+/* Implement in file "arch.c"      */
+extern void        CoSetCpuFreq(U32 freq);
+#if CFG_IDLE_SLEEP_EN >0
+extern StatusType  CoGetIdleStats(U8 mode,U64* cycles,U32* entries);
+#endif
+
 /* Implement in file "task.c"      */
 #define CoCreateTask(task,argv,prio,stk,stkSz)              \
             CreateTask(task,argv,(prio)|((stkSz)<<8),stk)
@@ -128,6 +176,7 @@ extern OS_VER  CoGetOSVersion(void);    /*!< Get OS version value             */
 
 extern void        CoExitTask(void);
 extern OS_TID      CoGetCurTaskID(void);
+extern U16         CoGetStackHighWater(OS_TID taskID,U16* size);
 extern StatusType  CoDelTask(OS_TID taskID);
 extern StatusType  CoActivateTask(OS_TID taskID,void *argv);
 extern StatusType  CoAwakeTask(OS_TID taskID);
@@ -135,6 +184,25 @@ extern StatusType  CoSuspendTask(OS_TID taskID);
 extern StatusType  CoSetPriority(OS_TID taskID,U8 priority);
 extern OS_TID      CreateTask(FUNCPtr task,void *argv,U32 parameter,OS_STK *stk);
 
+/* Implement in file "edf.c"       */
+extern StatusType  CoSetTaskEdf(OS_TID taskID,U32 period,U32 deadline);
+extern StatusType  CoWaitNextPeriod(void);
+extern StatusType  CoGetEdfStats(OS_TID taskID,U32* jobs,U32* misses);
+
+/* Implement in file "notify.c"    */
+extern StatusType  CoNotifyTask(OS_TID taskID,U32 value,U8 action);
+extern StatusType  isr_NotifyTask(OS_TID taskID,U32 value,U8 action);
+extern U32         CoWaitNotify(U32 timeout,StatusType* perr);
+
+/* Implement in file "stats.c"     */
+extern StatusType  CoGetTaskStats(OS_TID taskID,U64* cycles,U32* switches,U32* preempts);
+extern void        CoResetTaskStats(void);
+
+/* Implement in file "trace.c"     */
+extern StatusType  CoTraceEvent(U8 event,U8 id,U16 arg);
+extern U32         CoTracePeek(void** rec);
+extern void        CoTraceFree(U32 count);
+
 /* Implement in file "time.c"      */
 extern U64         CoGetOSTime(void);
 extern StatusType  CoTickDelay(U32 ticks);
@@ -167,6 +235,7 @@ extern OS_MMID     CoCreateMemPartition(U8* memBuf,U32 blockSize,U32 blockNum);
 extern OS_MutexID  CoCreateMutex(void);
 extern StatusType  CoEnterMutexSection(OS_MutexID mutexID);
 extern StatusType  CoLeaveMutexSection(OS_MutexID mutexID);
+extern OS_MutexID  CoCreateCeilingMutex(U8 ceiling);
 
 
 /* Implement in file "sem.c"       */
@@ -194,6 +263,17 @@ extern StatusType  isr_PostQueueMail(OS_EventID id,void* pmail);
 extern void*       CoAcceptQueueMail(OS_EventID id,StatusType* perr);
 extern OS_EventID  CoCreateQueue(void **qStart, U16 size ,U8 sortType);
 extern void*       CoPendQueueMail(OS_EventID id,U32 timeout,StatusType* perr);
+extern StatusType  CoPostQueueMailBatch(OS_EventID id,void **msgs,U16 n);
+extern U16         CoPendQueueMailBatch(OS_EventID id,void **out,U16 max,U32 timeout,StatusType* perr);
+
+
+/* Implement in file "rwlock.c"    */
+extern OS_EventID  CoCreateRwLock(U8 sortType);
+extern StatusType  CoDelRwLock(OS_EventID id,U8 opt);
+extern StatusType  CoReadLock(OS_EventID id,U32 timeout);
+extern StatusType  CoReadUnlock(OS_EventID id);
+extern StatusType  CoWriteLock(OS_EventID id,U32 timeout);
+extern StatusType  CoWriteUnlock(OS_EventID id);
 
 
 
@@ -207,6 +287,40 @@ extern StatusType  CoWaitForSingleFlag (OS_FlagID id,U32 timeout);
 extern OS_FlagID   CoCreateFlag (BOOL bAutoReset,BOOL bInitialState);
 extern U32         CoAcceptMultipleFlags (U32 flags,U8 waitType,StatusType *perr);
 extern U32         CoWaitForMultipleFlags (U32 flags,U8 waitType,U32 timeout,StatusType *perr);
+extern OS_FlagGrpID CoCreateFlagGroup (U32 autoReset,U32 initFlags);
+extern StatusType  CoDelFlagGroup (OS_FlagGrpID id,U8 opt);
+extern StatusType  CoSetGroupFlags (OS_FlagGrpID id,U32 flags);
+extern StatusType  isr_SetGroupFlags (OS_FlagGrpID id,U32 flags);
+extern StatusType  CoClearGroupFlags (OS_FlagGrpID id,U32 flags);
+extern U32         CoGetGroupFlags (OS_FlagGrpID id);
+extern U32         CoAcceptGroupFlags (OS_FlagGrpID id,U32 flags,U8 waitType,StatusType *perr);
+extern U32         CoWaitForGroupFlags (OS_FlagGrpID id,U32 flags,U8 waitType,U32 timeout,StatusType *perr);
+
+
+/* Implement in file "streamBuf.c" */
+extern OS_SBufID   CoCreateStreamBuf(U8* buf,U32 size,U32 trigger);
+extern OS_SBufID   CoCreateMsgBuf(U8* buf,U32 size);
+extern StatusType  CoDelStreamBuf(OS_SBufID id,U8 opt);
+extern StatusType  CoSetStreamBufTrigger(OS_SBufID id,U32 trigger);
+extern U32         CoGetStreamBufBytes(OS_SBufID id);
+extern U32         isr_SendStreamBuf(OS_SBufID id,const void* data,U32 len);
+extern U32         CoSendStreamBuf(OS_SBufID id,const void* data,U32 len,U32 timeout,StatusType* perr);
+extern U32         CoAcceptStreamBuf(OS_SBufID id,void* data,U32 max);
+extern U32         CoRecvStreamBuf(OS_SBufID id,void* data,U32 max,U32 timeout,StatusType* perr);
+extern StatusType  isr_SendMsgBuf(OS_SBufID id,const void* data,U16 len);
+extern StatusType  CoSendMsgBuf(OS_SBufID id,const void* data,U16 len,U32 timeout);
+extern U16         CoAcceptMsgBuf(OS_SBufID id,void* data,U16 max,StatusType* perr);
+extern U16         CoRecvMsgBuf(OS_SBufID id,void* data,U16 max,U32 timeout,StatusType* perr);
+
+
+/* Implement in file "workQueue.c" */
+extern OS_WorkerID CoCreateWorker(U8 prio,OS_STK* stk,U16 stkSize);
+extern StatusType  CoQueueWork(OS_WorkerID id,FUNCPtr func,void* arg);
+extern StatusType  isr_QueueWork(OS_WorkerID id,FUNCPtr func,void* arg);
+
+
+/* Implement in file "serviceReq.c"*/
+extern StatusType  CoGetServiceReqStats(U32* highWater,U32* drops);
 
 
 /* Implement in file "utility.c"   */
@@ -219,4 +333,9 @@ extern void        CoIdleTask(void* pdata);
 extern void        CoStkOverflowHook(OS_TID taskID);
 
 
+/* Implement in file "coroutine.c" */
+#if CFG_COROUTINE_EN >0
+#include "OsCoroutine.h"
+#endif
+
 #endif
@@ -19,17 +19,43 @@
 #ifndef  _CPU_H
 #define  _CPU_H
 
+#include "../periph.h"
 
-#define NVIC_ST_CTRL    (*((volatile U32 *)0xE000E010))
-#define NVIC_ST_RELOAD  (*((volatile U32 *)0xE000E014))
-#define RELOAD_VAL      ((U32)(( (U32)CFG_CPU_FREQ) / (U32)CFG_SYSTICK_FREQ) -1)
+
+#define NVIC_ST_CTRL    (*((volatile U32 *)PERIPH_ADDR(0xE000E010)))
+#define NVIC_ST_RELOAD  (*((volatile U32 *)PERIPH_ADDR(0xE000E014)))
+#define NVIC_ST_CURRENT (*((volatile U32 *)PERIPH_ADDR(0xE000E018)))
+#define NVIC_ST_CTRL_ENABLE     (0x00000001)
+#define NVIC_ICSR       (*((volatile U32 *)PERIPH_ADDR(0xE000ED04)))
+#define NVIC_PENDSTSET  (0x04000000)
+#define NVIC_PRIO_BITS  (4)             /*!< Priority bits of the SAM3X NVIC  */
+
+#if CFG_MAX_SYSCALL_PRIO > 0
+#if CFG_CHIP_TYPE != 1
+#error "CFG_MAX_SYSCALL_PRIO needs the BASEPRI register of a Cortex-M3"
+#endif
+#if CFG_MAX_SYSCALL_PRIO >= (1 << NVIC_PRIO_BITS)
+#error "CFG_MAX_SYSCALL_PRIO must be below the number of NVIC priorities"
+#endif
+/*!< BASEPRI value that masks the interrupts the kernel may be called from.   */
+#define OS_BASEPRI      ((U32)CFG_MAX_SYSCALL_PRIO << (8 - NVIC_PRIO_BITS))
+#endif
+
+#define NVIC_DEMCR      (*((volatile U32 *)PERIPH_ADDR(0xE000EDFC)))
+#define NVIC_DEMCR_TRCENA       (0x01000000)
+#define DWT_CTRL        (*((volatile U32 *)PERIPH_ADDR(0xE0001000)))
+#define DWT_CTRL_CYCCNTENA      (0x00000001)
+#define DWT_CYCCNT      (*((volatile U32 *)PERIPH_ADDR(0xE0001004)))
+#define SYSTICK_RELOAD(freq) ((U32)(((U32)(freq) + (U32)CFG_SYSTICK_FREQ/2) \
+                              / (U32)CFG_SYSTICK_FREQ) -1)
+#define RELOAD_VAL      (SysTickReload) /*!< Follows the clock profile        */
 
 /*!< Initial System tick.	*/
 #define InitSysTick()   NVIC_ST_RELOAD =  RELOAD_VAL; \
                         NVIC_ST_CTRL   =  0x0007    
 
-#define NVIC_SYS_PRI2   (*((volatile U32 *)0xE000ED1C))
-#define NVIC_SYS_PRI3   (*((volatile U32 *)0xE000ED20))
+#define NVIC_SYS_PRI2   (*((volatile U32 *)PERIPH_ADDR(0xE000ED1C)))
+#define NVIC_SYS_PRI3   (*((volatile U32 *)PERIPH_ADDR(0xE000ED20)))
 
 /*!< Initialize PendSV,SVC and SysTick interrupt priority to lowest.          */
 #define InitInt()       NVIC_SYS_PRI2 |=  0xFF000000;\
@@ -37,15 +63,28 @@
 
 
 /*---------------------------- Variable declare ------------------------------*/
-extern U64      OSTickCnt;          /*!< Counter for current system ticks.    */									
+extern U64      OSTickCnt;          /*!< Counter for current system ticks.    */
+extern U32      SysTickReload;      /*!< SysTick reload of one tick.          */									
 
 /*!< Initial context of task being created	*/
 extern OS_STK  *InitTaskContext(FUNCPtr task,void *param,OS_STK *pstk);
 extern void SysTick_Handler(void);
+extern void    SysTickClockChanged(uint32_t mck);/*!< Clock notifier of PMC   */
+#if CFG_TICKLESS_EN >0
+extern BOOL    TicklessIdle(void);      /*!< Sleep until the next expiry      */
+#endif
+#if CFG_IDLE_SLEEP_EN >0
+extern void    IdleSleep(void);         /*!< Sleep in the IDLE task           */
+#endif
 extern void    SwitchContext(void);         /*!< Switch context                   */
 extern void    SetEnvironment(OS_STK *pstk);/*!< Set environment for run          */
 extern U8      Inc8 (volatile U8 *data);
 extern U8      Dec8 (volatile U8 *data);
+extern void*   PopNode (void* volatile *head);
+extern void    PushNode(void* volatile *head,void *node);
+extern BOOL    CasWord (volatile U32 *data,U32 old,U32 value);
+extern BOOL    CasByte (volatile U8 *data,U8 old,U8 value);
+extern U32     SwapWord(volatile U32 *data,U32 value);
 extern void    IRQ_ENABLE_RESTORE(void);
 extern void    IRQ_DISABLE_SAVE(void);
 #endif
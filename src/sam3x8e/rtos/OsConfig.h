@@ -40,25 +40,91 @@ Idle task stack size(word).
 #define CFG_IDLE_STACK_SIZE     (25)	
 
 /*!< 
-System frequency (Hz).	                 	         
+System frequency (Hz),the master clock set by pmc_init_system_clock().	         
 */    
-#define CFG_CPU_FREQ            (72000000)  
+#include "../pmc.h"
+#define CFG_CPU_FREQ            (SYS_CLK_FREQ)  
 
 /*!< 
-systick frequency (Hz).	                         
+systick frequency (Hz),up to 10000. CFG_CPU_FREQ/CFG_SYSTICK_FREQ must fit the
+24-bit SysTick,so at 84 MHz it must be at least 6. Ticks that are not whole
+milliseconds are converted exactly by the time functions.
 */
 #define CFG_SYSTICK_FREQ        (100) 		
 
+/*!< 
+Enable(1) or disable(0) tickless idle.
+If enable(1),the IDLE task stops the system tick until the next DELAY or
+timer expiry,sleeps with WFI and adds the skipped ticks on wakeup. The sleep
+is limited by the 24-bit SysTick to 0xFFFFFF/(CFG_CPU_FREQ/CFG_SYSTICK_FREQ)
+ticks,longer waits take several sleeps. The IDLE task needs about 8 more
+words of stack.
+*/
+#define CFG_TICKLESS_EN         (0)
+
+/*!< 
+Fewest ticks to the next expiry worth stopping the system tick for.
+*/
+#if CFG_TICKLESS_EN >0
+#define CFG_TICKLESS_MIN_TICKS  (2)
+#endif
+
+/*!< 
+Enable(1) or disable(0) sleeping in the IDLE task.
+If enable(1),the IDLE task sleeps with WFI until the next interrupt instead of
+spinning,or with tickless idle until the next expiry,and counts the entries
+and the cycles of each sleep mode for CoGetIdleStats(). The DWT cycle counter
+of CFG_TASK_STATS_EN stops while the core sleeps.
+*/
+#define CFG_IDLE_SLEEP_EN       (0)
+
+/*!< 
+Peripheral clocks the IDLE task stops while it sleeps and restarts on wakeup,
+bit n of MASK0 is the peripheral with ID n of id.h,bit n of MASK1 the one with
+ID 32+n. Only list peripherals with nothing to do while no task runs,a clock
+that is off on entry is left off.
+*/
+#if CFG_IDLE_SLEEP_EN >0
+#define CFG_IDLE_GATE_MASK0     (0x00000000)
+#define CFG_IDLE_GATE_MASK1     (0x00000000)
+#endif
+
+/*!< 
+Enable(1) or disable(0) the wait mode of the SAM3X8E in the IDLE task.
+If enable(1),the IDLE task enters wait mode instead of tickless idle when no
+DELAY or timer is pending,no peripheral clock is on after gating and a fast
+startup input (WKUP pin,RTT or RTC alarm) is enabled in PMC_FSMR. The clocks
+and the system tick stop until that input wakes the chip,so the system time
+doesn't advance meanwhile.
+*/
+#if (CFG_IDLE_SLEEP_EN >0) && (CFG_TICKLESS_EN >0)
+#define CFG_IDLE_WAIT_EN        (0)
+#endif
+
 /*!< 
 max systerm api call num in ISR.	                         
+The size of the service request queue,a power of two. The queue holds the
+mailbox and queue posts made while the scheduler is locked. Flag and
+semaphore requests are merged per ID and do not take room in it.
 */
-#define CFG_MAX_SERVICE_REQUEST (3)
+#define CFG_MAX_SERVICE_REQUEST (8)
+
+/*!< 
+Enable(1) or disable(0) bitmap schedule.
+If enable(1),CoOS keeps a READY list per priority and finds the highest ready
+priority in a bitmap with CLZ,so insert,remove and pick next take a constant
+time whatever the number of tasks. It replaces the order list and the
+Binary-Scheduling Algorithm.
+*/
+#define CFG_BITMAP_SCHEDULE_EN  (1)
 
 /*!< 
 Enable(1) or disable(0) order list schedule.
 If disable(0),CoOS use Binary-Scheduling Algorithm. 
 */
-#if (CFG_MAX_USER_TASKS) <15
+#if CFG_BITMAP_SCHEDULE_EN >0
+#define CFG_ORDER_LIST_SCHEDULE_EN  (1)
+#elif (CFG_MAX_USER_TASKS) <15
 #define CFG_ORDER_LIST_SCHEDULE_EN  (1)
 #else 
 #define CFG_ORDER_LIST_SCHEDULE_EN  (0)
@@ -77,6 +143,23 @@ Default slice of task.
 #define CFG_TIME_SLICE          (10)	  		
 #endif
 
+/*!< 
+Enable(1) or disable(0) earliest deadline first scheduling.
+If enable(1),the periodic tasks set with CoSetTaskEdf() all run at
+CFG_EDF_PRIO and the READY one with the earliest deadline runs first,it
+preempts one of a later deadline. Tasks of higher PRI still preempt them and
+they preempt the tasks of lower PRI,time slices are not used at CFG_EDF_PRIO.
+Needs CFG_BITMAP_SCHEDULE_EN,CFG_PRIORITY_SET_EN and CFG_TIME_DELAY_EN.
+*/
+#define CFG_EDF_EN              (0)
+
+/*!< 
+Priority of the EDF tasks,no other task should use it.
+*/
+#if CFG_EDF_EN >0
+#define CFG_EDF_PRIO            (8)
+#endif
+
 
 /*----------------------- Schedule model Config -----------------------------*/
 /*!< 
@@ -124,6 +207,48 @@ Enable(1) or disable(0) stack overflow checkout .
 */		
 #define CFG_STK_CHECKOUT_EN     (1)		
 
+/*!< 
+Enable(1) or disable(0) stack painting.
+If enable(1),CreateTask() fills the whole stack with MAGIC_WORD and
+CoGetStackHighWater() tells how many words of it a task has used at most.
+Needs the stack size,so works with CFG_STK_CHECKOUT_EN only.
+*/
+#if CFG_STK_CHECKOUT_EN > 0
+#define CFG_STK_PAINT_EN        (1)
+#endif
+
+/*!< 
+Highest NVIC priority (1-15,lower numbers are more urgent) of the interrupts
+that call the kernel. With 0 the kernel masks all interrupts with PRIMASK in
+its critical sections. Otherwise it masks the interrupts at this priority and
+below with BASEPRI. Interrupts with a more urgent priority are never delayed
+by the kernel,but must not call any CoOS function,not even CoEnterISR() or
+isr_xxx().
+The critical sections of the drivers always mask with PRIMASK,see irq.h.
+*/
+#define CFG_MAX_SYSCALL_PRIO    (0)
+
+/*!< 
+Enable(1) or disable(0) task statistics.
+If enable(1),each task counts the CPU cycles it has run (with the DWT cycle
+counter),how often it has been switched in and how often it has been
+preempted,see CoGetTaskStats(). The TCB grows by 16 bytes.
+*/
+#define CFG_TASK_STATS_EN       (0)
+
+/*!< 
+Enable(1) or disable(0) the kernel event trace.
+If enable(1),context switches,CoEnterISR()/CoExitISR(),semaphore,mutex and
+queue calls and timer expirations are logged with a DWT time stamp into a RAM
+ring buffer,see OsTrace.h for the format and CoTracePeek().
+*/
+#define CFG_TRACE_EN            (0)
+
+/*!< 
+Records of the trace ring buffer,8 bytes each,must be a power of two.
+*/
+#define CFG_TRACE_SIZE          (256)
+
 
 
 /*---------------------- Memory Management Config ----------------------------*/
@@ -154,6 +279,31 @@ Kernel heap size(word).
 #define KHEAP_SIZE              (50)			
 #endif   
 
+/*!< 
+Enable(1) or disable(0) the TLSF kernel heap.
+If enable(1),CoKmalloc() and CoKfree() use two-level segregated fit: free
+blocks are kept in lists per size class,found through two bitmaps,so both
+take a bounded time whatever the state of the heap. The class tables take
+32 bytes per power of two up to the heap size.
+*/
+#if CFG_KHEAP_EN >0
+#define CFG_KHEAP_TLSF_EN       (0)
+#endif
+
+/*!< 
+Slab caches in front of the kernel heap,one X(blockSize,blockNum) each in
+increasing blockSize,in bytes,e.g.
+  #define CFG_KHEAP_SLABS(X)  X(16,8) X(32,4)
+CoKmalloc() takes a request of up to blockSize bytes from the first of them
+with a free block,in constant time and without a block header. CoKfree()
+finds the slab from the address. Larger requests,and all when the slabs are
+full,go to the heap. Each slab is a memory partition of its own buffer and
+takes one of CFG_MAX_MM,created before any partition of the application.
+*/
+#if CFG_KHEAP_EN >0
+#define CFG_KHEAP_SLABS(X)
+#endif
+
 
 		
 /*---------------------- Time Management Config -----------------------------*/
@@ -164,6 +314,17 @@ Enable(1) or disable(0) TimeDelay() API.
 #define CFG_TIME_DELAY_EN       (1)	
 #endif
 
+/*!< 
+Enable(1) or disable(0) the timer wheel.
+If enable(1),the DELAY list and the timer list are kept in a hierarchical
+timer wheel,insert and remove take a constant time and a tick an amortized
+constant time,whatever the number of delayed tasks and running timers.
+It takes 1KB of RAM for the slots.
+*/
+#if CFG_TASK_WAITTING_EN >0
+#define CFG_TMR_WHEEL_EN        (0)
+#endif
+
 
 /*---------------------- Timer Management Config ----------------------------*/
 /*!< 
@@ -178,6 +339,27 @@ Specify max number timer.(must be less than 32)
 #define CFG_MAX_TMR             (2)			
 #endif
 
+/*!< 
+Enable(1) or disable(0) the timer daemon.
+If enable(1),an expired timer only notifies the daemon task,which runs the
+callback at CFG_TMR_DAEMON_PRIO. SysTick_Handler() stays short and the
+callbacks may block,e.g. take a mutex. A timer that expires again before its
+callback ran gets one call for both. The daemon is created by CoInitOS()
+after the static tasks,counts in CFG_MAX_USER_TASKS and needs
+CFG_TASK_NOTIFY_EN.
+*/
+#if CFG_TMR_EN >0
+#define CFG_TMR_DAEMON_EN       (0)
+#endif
+
+/*!< 
+Priority and stack size(word) of the timer daemon.
+*/
+#if CFG_TMR_DAEMON_EN >0
+#define CFG_TMR_DAEMON_PRIO     (1)
+#define CFG_TMR_DAEMON_STK_SIZE (128)
+#endif
+
 
 /*---------------------- Event Management Config ----------------------------*/
 /*!< 
@@ -194,6 +376,19 @@ Event sort type.(1)FIFO (2)PRI (3)FIFO+PRI
 */
 #define CFG_EVENT_SORT          (3)		
 
+/*!< 
+Enable(1) or disable(0) the PRI map of the event waiting lists.
+If enable(1),each event keeps a bitmap of the PRI waiting on it and the last
+task of each of them,so a task is put in a PRI sorted waiting list in a
+constant time whatever the number of waiting tasks.It costs
+(CFG_LOWEST_PRIO+1)*4+16 bytes of RAM per event.
+*/
+#if (CFG_EVENT_SORT == 2) || (CFG_EVENT_SORT == 3)
+#define CFG_EVENT_PRIO_MAP_EN   (1)
+#else
+#define CFG_EVENT_PRIO_MAP_EN   (0)
+#endif
+
 /*!< 
 Max number of event.(must be less than 255) 	      
 Event = semaphore + mailbox + queue;			      
@@ -221,6 +416,20 @@ Max number of queue.(less than CFG_MAX_EVENT).
 #if	CFG_QUEUE_EN >0	
 #define CFG_MAX_QUEUE           (2)		
 #endif   // CFG_QUEUE_EN
+
+/*!< 
+Enable(1) or disable(0) reader-writer lock management.
+Readers share the lock,a writer holds it alone and is promoted like a mutex
+owner. Needs CoSetPriority().
+*/
+#define CFG_RWLOCK_EN           (1)
+
+/*!< 
+Max number of reader-writer locks.(less than CFG_MAX_EVENT and 33).
+*/
+#if CFG_RWLOCK_EN >0
+#define CFG_MAX_RWLOCK          (2)
+#endif
 	
 #endif   // CFG_EVENT_EN
 	
@@ -235,6 +444,87 @@ Max number of flag is 32.
 #define  CFG_FLAG_EN           (1) 
 #endif		
 
+/*!< 
+Max number of flag groups.Each group has 32 flags of its own and its own
+waiting list,setting flags of a group only checks the tasks waiting on it.
+0 disables the groups.
+*/
+#if CFG_FLAG_EN > 0
+#define CFG_MAX_FLAG_GROUP     (4)
+#endif
+
+/*!< 
+Enable(1) or disable(0) stream and message buffers.
+They copy bytes into a ring buffer for one writer and one reader without a
+lock,and wake the reader with a flag when a trigger level is reached. Each
+buffer uses two flags.
+*/
+#if CFG_FLAG_EN > 0
+#define  CFG_STREAM_BUF_EN     (0)
+#endif
+
+/*!< 
+Max number of stream and message buffers.
+*/
+#if CFG_STREAM_BUF_EN >0
+#define CFG_MAX_STREAM_BUF     (2)
+#endif
+
+/*!< 
+Enable(1) or disable(0) coroutines.
+Stackless coroutines all run in the task of a runner,each one costs a CORO
+struct instead of a stack. Each runner uses a flag.
+*/
+#if CFG_FLAG_EN > 0
+#define  CFG_COROUTINE_EN      (0)
+#endif
+
+/*!< 
+Ticks between two checks of the coroutines waiting for a flag,a semaphore
+or a queue.0 checks them only when the runner is kicked or a delay ends.
+*/
+#if CFG_COROUTINE_EN >0
+#define CFG_CORO_POLL_TICKS    (1)
+#endif
+
+
+/*---------------------- Task Notification Config ---------------------------*/
+/*!< 
+Enable(1) or disable(0) task notifications.
+Each task gets a notification value that a task or an ISR can update with
+CoNotifyTask() or isr_NotifyTask(),without an event control block. A
+notification from an ISR does not use the service request queue.
+*/
+#if CFG_TASK_WAITTING_EN > 0
+#define  CFG_TASK_NOTIFY_EN     (1) 
+#endif
+
+
+/*---------------------- Work Queue Config ----------------------------------*/
+/*!< 
+Enable(1) or disable(0) work queues.
+A worker is a task that runs the {function,argument} items queued to it by
+tasks with CoQueueWork() or by ISRs with isr_QueueWork(),so drivers share a
+few worker stacks instead of one task each. Each worker uses a semaphore.
+*/
+#if CFG_SEM_EN > 0
+#define  CFG_WORK_QUEUE_EN      (0) 
+#endif
+
+/*!< 
+Max number of workers.
+*/
+#if CFG_WORK_QUEUE_EN >0
+#define CFG_MAX_WORKER          (2)
+#endif
+
+/*!< 
+Items queued to one worker at most,a power of two.
+*/
+#if CFG_WORK_QUEUE_EN >0
+#define CFG_WORK_QUEUE_SIZE     (8)
+#endif
+
 
 /*---------------------- Mutex Management Config ----------------------------*/
 /*!< 
@@ -254,6 +544,65 @@ Max number of mutex.(must be less than 255).
 #define CFG_MAX_MUTEX           (10)			
 #endif
 
+/*!< 
+Enable(1) or disable(0) the fast path of mutexes.
+If enable(1),CoEnterMutexSection() claims a free mutex with an exclusive store
+and CoLeaveMutexSection() frees a mutex without waiters,both without locking
+the scheduler. Contended mutexes take the priority inheritance path.
+*/
+#if CFG_MUTEX_EN >0
+#define CFG_MUTEX_FAST_EN       (1)
+#endif
+
+/*!< 
+Enable(1) or disable(0) priority ceiling mutexes.
+If enable(1),CoCreateCeilingMutex() creates a mutex whose owner runs at the
+ceiling priority from CoEnterMutexSection() on,instead of being promoted
+when a higher priority task contends. 
+*/
+#if CFG_MUTEX_EN >0
+#define CFG_MUTEX_CEILING_EN    (0)
+#endif
+
+/*---------------------- Static Object Config -------------------------------*/
+/*!< 
+Tasks created by CoInitOS(),one X(name,task,prio,stkSize) each,e.g.
+  #define CFG_STATIC_TASKS(X)  X(TASK_LED,LedTask,10,64)
+name becomes the task ID,the IDs follow the IDLE task from 1 on in list order.
+task is the task function,the kernel defines its stack of stkSize words and
+passes NULL as argument. The tasks count in CFG_MAX_USER_TASKS.
+*/
+#define CFG_STATIC_TASKS(X)
+
+/*!< 
+Semaphores in initialized data,one X(name,initCnt,maxCnt,sortType) each.
+name becomes the semaphore ID,no CoCreateSem() is needed. They take the first
+events of CFG_MAX_EVENT.
+*/
+#if CFG_SEM_EN >0
+#define CFG_STATIC_SEMS(X)
+#endif
+
+/*!< 
+Queues in initialized data,one X(name,size,sortType) each. name becomes the
+queue ID,the kernel defines the buffer of size mails,no CoCreateQueue() is
+needed. They take the events after the static semaphores and the first queues
+of CFG_MAX_QUEUE.
+*/
+#if CFG_QUEUE_EN >0
+#define CFG_STATIC_QUEUES(X)
+#endif
+
+/*!< 
+Timers in initialized data,one X(name,tmrType,tmrCnt,tmrReload,func) each.
+name becomes the timer ID,the timer is stopped until CoStartTmr(). They take
+the first timers of CFG_MAX_TMR.
+*/
+#if CFG_TMR_EN >0
+#define CFG_STATIC_TMRS(X)
+#endif
+
+
 /*---------------------- Utility Management Config --------------------------*/
 /*!< 
 Enable(1) or disable(0) utility management.    	  
@@ -0,0 +1,116 @@
+/**
+ *******************************************************************************
+ * @file       OsCoroutine.h
+ * @version    V1.13
+ * @date       2026.10.14
+ * @brief      Coroutine header file
+ * @details    Coroutines are stackless state machines that all run in the
+ *             task of one runner. A coroutine is a function that starts with
+ *             CORO_BEGIN() and ends with CORO_END(). Its waits save the line
+ *             to resume at and return to the runner,so a coroutine costs its
+ *             CORO struct instead of a stack.
+ *
+ *             The local variables of a coroutine don't survive a wait,keep
+ *             the state in static variables or behind arg. A switch statement
+ *             can't hold a wait,the waits are case labels of CORO_BEGIN().
+ *
+ *             The waits on flags,semaphores and queues are polled every
+ *             CFG_CORO_POLL_TICKS ticks,or at once when the runner is kicked
+ *             with CoKickCoroutines() or isr_KickCoroutines().
+ *******************************************************************************
+ * @copy
+ *
+ * INTERNAL FILE,DON'T PUBLIC.
+ *
+ * <h2><center>&copy; COPYRIGHT 2009 CooCox </center></h2>
+ *******************************************************************************
+ */
+
+
+#ifndef _COROUTINE_H
+#define _COROUTINE_H
+
+/*---------------------------- Coroutine status ------------------------------*/
+#define  CORO_WAITING       (U8)0x00    /*!< Waits for a condition            */
+#define  CORO_YIELDED       (U8)0x01    /*!< Runs again in the next pass      */
+#define  CORO_DELAYED       (U8)0x02    /*!< Waits until the tick of wake     */
+#define  CORO_ENDED         (U8)0x03    /*!< Left the runner                  */
+
+typedef struct Coroutine  CORO,*P_CORO;
+typedef U8                (*CORO_FUNC)(P_CORO co);
+
+/**
+ * @struct   Coroutine  OsCoroutine.h
+ * @brief    Coroutine struct
+ * @details  This struct use to manage a coroutine.
+ *
+ */
+struct Coroutine
+{
+    P_CORO     next;                    /*!< Next coroutine of the runner     */
+    CORO_FUNC  func;                    /*!< Function of the coroutine        */
+    void*      arg;                     /*!< Argument of the coroutine        */
+    U32        wake;                    /*!< Tick a delay ends at             */
+    U16        line;                    /*!< Line to resume at,0 at start     */
+    U8         _padding[2];
+};
+
+/**
+ * @struct   CoroRunner  OsCoroutine.h
+ * @brief    Coroutine runner struct
+ * @details  This struct use to manage the coroutines of one task.
+ *
+ */
+typedef struct CoroRunner
+{
+    P_CORO     list;                    /*!< Coroutines of the runner         */
+    OS_FlagID  kick;                    /*!< Flag that wakes the runner       */
+    U8         _padding[3];
+}CORO_RUNNER,*P_CORO_RUNNER;
+
+
+/*---------------------------- Coroutine body --------------------------------*/
+/*!< Start of a coroutine,resumes it where it waited.                         */
+#define CORO_BEGIN(co)          switch((co)->line) { case 0:
+
+/*!< End of a coroutine,it leaves the runner.                                 */
+#define CORO_END(co)            } (co)->line = 0; return CORO_ENDED
+
+/*!< Let the other coroutines of the runner run.                              */
+#define CORO_YIELD(co)                                                         \
+    do { (co)->line = __LINE__; return CORO_YIELDED; case __LINE__:; } while(0)
+
+/*!< Wait until cond is true,it is checked each time the runner passes.       */
+#define CORO_WAIT_UNTIL(co,cond)                                               \
+    do { (co)->line = __LINE__; case __LINE__:                                 \
+         if(!(cond)) { return CORO_WAITING; } } while(0)
+
+/*!< Wait for ticks.                                                          */
+#define CORO_DELAY(co,ticks)                                                   \
+    do { (co)->wake = (U32)CoGetOSTime() + (ticks);                            \
+         (co)->line = __LINE__; case __LINE__:                                 \
+         if((S32)((U32)CoGetOSTime() - (co)->wake) < 0)                        \
+         { return CORO_DELAYED; } } while(0)
+
+/*!< Wait for a flag,an auto reset flag is reset.                             */
+#define CORO_WAIT_FLAG(co,id)                                                  \
+    CORO_WAIT_UNTIL(co,CoAcceptSingleFlag(id) != E_FLAG_NOT_READY)
+
+/*!< Wait for a semaphore.                                                    */
+#define CORO_WAIT_SEM(co,id)                                                   \
+    CORO_WAIT_UNTIL(co,CoAcceptSem(id) != E_SEM_EMPTY)
+
+/*!< Wait for a mail of a queue,*perr is E_OK when pmail is set.              */
+#define CORO_WAIT_QUEUE(co,id,pmail,perr)                                      \
+    CORO_WAIT_UNTIL(co,((pmail) = CoAcceptQueueMail((id),(perr)),              \
+                        *(perr) != E_QUEUE_EMPTY))
+
+
+/*---------------------------- Function declare ------------------------------*/
+extern StatusType  CoCreateCoroRunner(P_CORO_RUNNER runner);
+extern void        CoAddCoroutine(P_CORO_RUNNER runner,P_CORO co,CORO_FUNC func,void* arg);
+extern void        CoRunCoroutines(void* pdata);
+extern StatusType  CoKickCoroutines(P_CORO_RUNNER runner);
+extern StatusType  isr_KickCoroutines(P_CORO_RUNNER runner);
+
+#endif
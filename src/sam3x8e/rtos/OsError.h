@@ -18,8 +18,22 @@
 #ifndef _ERROR_H
 #define _ERROR_H
 
-#if (CFG_SYSTICK_FREQ > 1000) ||(CFG_SYSTICK_FREQ < 1) 
-    #error " OsConfig.h System Tick time must between 1ms and 1s!"
+#if (CFG_SYSTICK_FREQ > 10000) ||(CFG_SYSTICK_FREQ < 1) 
+    #error " OsConfig.h System Tick time must between 0.1ms and 1s!"
+#endif
+
+#if (CFG_CPU_FREQ / CFG_SYSTICK_FREQ) > 0x1000000
+    #error " OsConfig.h, CFG_SYSTICK_FREQ is too low for the 24-bit SysTick! "
+#endif
+
+#if CFG_EDF_EN > 0
+    #if (CFG_BITMAP_SCHEDULE_EN == 0) || (CFG_PRIORITY_SET_EN == 0) || \
+        (CFG_TIME_DELAY_EN == 0)
+    #error " OsConfig.h, CFG_EDF_EN needs CFG_BITMAP_SCHEDULE_EN,CFG_PRIORITY_SET_EN and CFG_TIME_DELAY_EN! "
+    #endif
+    #if CFG_EDF_PRIO >= CFG_LOWEST_PRIO
+    #error " OsConfig.h, CFG_EDF_PRIO must be < CFG_LOWEST_PRIO! "
+    #endif
 #endif
 
 #if CFG_MAX_USER_TASKS > 253
@@ -45,6 +59,9 @@
     #if CFG_MAX_TMR > 32
     #error " OsConfig.h, CFG_MAX_TMR must be <= 32! "
     #endif
+    #if (CFG_TMR_DAEMON_EN > 0) && (CFG_TASK_NOTIFY_EN == 0)
+    #error " OsConfig.h, CFG_TMR_DAEMON_EN needs CFG_TASK_NOTIFY_EN! "
+    #endif
 #endif
 
 
@@ -61,6 +78,22 @@
     #endif
 #endif
 
+#if CFG_WORK_QUEUE_EN > 0
+    #if (CFG_WORK_QUEUE_SIZE < 2) || (CFG_WORK_QUEUE_SIZE > 0x8000) || \
+        ((CFG_WORK_QUEUE_SIZE & (CFG_WORK_QUEUE_SIZE - 1)) != 0)
+    #error " config.h, CFG_WORK_QUEUE_SIZE must be a power of two <= 0x8000! "
+    #endif
+    #if CFG_MAX_WORKER > CFG_MAX_EVENT
+    #error " config.h, CFG_MAX_WORKER must be <= CFG_MAX_EVENT! "
+    #endif
+#endif
+
+#if CFG_FLAG_EN > 0
+    #if CFG_MAX_FLAG_GROUP > 32
+    #error " config.h, CFG_MAX_FLAG_GROUP must be <= 32! "
+    #endif
+#endif
+
 #if CFG_MUTEX_EN > 0
     #if CFG_MAX_MUTEX > 254
     #error " config.h, CFG_MAX_MUTEX must be <= 254! "
@@ -79,6 +112,15 @@
         #error " config.h, CFG_MAX_QUEUE must be <= CFG_MAX_EVENT! "	
         #endif
     #endif	
+
+    #if CFG_RWLOCK_EN > 0 
+        #if (CFG_MAX_RWLOCK > CFG_MAX_EVENT) || (CFG_MAX_RWLOCK > 32)
+        #error " config.h, CFG_MAX_RWLOCK must be <= CFG_MAX_EVENT and <= 32! "	
+        #endif
+        #if CFG_PRIORITY_SET_EN == 0
+        #error " config.h, CFG_RWLOCK_EN needs CFG_PRIORITY_SET_EN! "	
+        #endif
+    #endif	
 #endif      /* CFG_EVENT_EN  */
 
 #endif      /* _ERROR_H      */
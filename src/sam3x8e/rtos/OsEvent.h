@@ -23,6 +23,11 @@
 #define EVENT_TYPE_MBOX       (U8)0x02      /*!< Event type:Mailbox.          */
 #define EVENT_TYPE_QUEUE      (U8)0x03      /*!< Event type:Queue.            */
 #define EVENT_TYPE_INVALID    (U8)0x04      /*!< Invalid event type.          */
+#define EVENT_TYPE_RWLOCK     (U8)0x05      /*!< Event type:Reader-writer lock*/
+
+#if CFG_EVENT_PRIO_MAP_EN >0
+#define EVENT_PRIO_WORDS      ((CFG_LOWEST_PRIO+32)/32) /*!< Words of PRI map.*/
+#endif
 
 
 /**
@@ -41,6 +46,11 @@ typedef struct EventCtrBlk
     U16     eventCounter;               /*!< Counter of semaphore.            */
     U16     initialEventCounter;        /*!< Initial counter of semaphore.    */
     P_OSTCB eventTCBList;               /*!< Task waitting list.              */
+#if CFG_EVENT_PRIO_MAP_EN >0
+    U32     waitPrioGroup;              /*!< Words of the map in use.         */
+    U32     waitPrioMap[EVENT_PRIO_WORDS];  /*!< PRI with a waiting task.     */
+    P_OSTCB waitPrioTail[CFG_LOWEST_PRIO+1];/*!< Last waiting task of PRI.    */
+#endif
 }ECB,*P_ECB;
 
 /*---------------------------- Variable declare ------------------------------*/
@@ -29,6 +29,7 @@ typedef struct FlagNode
     struct FlagNode*  prevNode;         /*!< A pointer to prev flag node      */
     U32               waitFlags;        /*!< Flag value                       */
     P_OSTCB           waitTask;         /*!< A pointer to task waitting flag  */
+    struct Flag*      pfcb;             /*!< Flags of the waiting list        */
     U8                waitType;         /*!< Wait type                        */
     U8					_padding[3];
 }FLAG_NODE,*P_FLAG_NODE;
@@ -44,6 +45,7 @@ typedef struct Flag
     U32           flagRdy;              /*!< Ready flag                       */
     U32           resetOpt;             /*!< Reset option                     */
     U32           flagActive;           /*!< Active flag                      */
+    U32           waitMask;             /*!< Flags any node may wait for      */
     P_FLAG_NODE   headNode;             /*!< Head node                        */
     P_FLAG_NODE   tailNode;             /*!< Tail node                        */
 }FCB,*P_FCB;
@@ -51,8 +53,15 @@ typedef struct Flag
 
 /*---------------------------- Variable declare ------------------------------*/
 extern FCB FlagCrl;					
+#if CFG_MAX_FLAG_GROUP > 0
+extern FCB  FlagGrpTbl[CFG_MAX_FLAG_GROUP];   /*!< Flag group table           */
+extern BOOL FlagGrpReq;         /*!< Group flags set in ISR,deferred          */
+#endif
 
 /*---------------------------- Function declare ------------------------------*/
 extern void        RemoveLinkNode(P_FLAG_NODE pnode);
+#if CFG_MAX_FLAG_GROUP > 0
+extern void        FlagGrpDispose(void);
+#endif
 #endif
 
@@ -41,6 +41,54 @@ typedef struct FreeMemBlk
   struct UsedMemBlk* preUMB;
 }FMB,*P_FMB;
 
+#if CFG_KHEAP_TLSF_EN >0
+#define TLSF_SL_LOG2    (3)             /*!< log2 of classes per power of two */
+#define TLSF_SL_COUNT   (1 << TLSF_SL_LOG2)
+#define TLSF_SMALL      (1 << (TLSF_SL_LOG2 + 2)) /*!< Below,classes of 4 bytes*/
+#define TLSF_FREE       (0x1)           /*!< Flag of a free block in size     */
+#define TLSF_HEAD       (8)             /*!< Size of the block header         */
+#define TLSF_MIN        (8)             /*!< Smallest block size              */
+
+/*!< First level classes,block sizes are below 2^(TLSF_FL_COUNT+4) bytes.    */
+#if (KHEAP_SIZE*4) < (1 << 12)
+#define TLSF_FL_COUNT   (8)
+#elif (KHEAP_SIZE*4) < (1 << 16)
+#define TLSF_FL_COUNT   (12)
+#else
+#define TLSF_FL_COUNT   (13)
+#endif
+
+typedef struct TlsfBlk
+{
+  struct TlsfBlk* prePhys;              /*!< Block just before in the heap    */
+  U32             size;                 /*!< Bytes after header,TLSF_FREE flag*/
+  struct TlsfBlk* nextFree;             /*!< Next block of the class,if free  */
+  struct TlsfBlk* preFree;              /*!< Prev block of the class,if free  */
+}TLSFB,*P_TLSFB;
+#endif
+
+#ifndef CFG_KHEAP_SLABS
+#define CFG_KHEAP_SLABS(X)
+#endif
+#define OS_KHEAP_SLAB_ONE(size,num)   +1
+#define OS_KHEAP_SLABS  (0 CFG_KHEAP_SLABS(OS_KHEAP_SLAB_ONE)) /*!< Slab count */
+
+#if OS_KHEAP_SLABS >0
+#if CFG_MM_EN == 0
+#error " config.h, CFG_KHEAP_SLABS needs CFG_MM_EN! "
+#elif OS_KHEAP_SLABS > CFG_MAX_MM
+#error " config.h, CFG_KHEAP_SLABS must be <= CFG_MAX_MM! "
+#endif
+
+typedef struct KennelHeapSlab
+{
+  U32*    buf;                          /*!< Blocks of the slab               */
+  U32     blockSize;                    /*!< Block size in bytes              */
+  U32     blockNum;                     /*!< Number of blocks                 */
+  OS_MMID mmID;                         /*!< Memory partition of the blocks   */
+}KSlab,*P_KSlab;
+#endif
+
 /*---------------------------- Function Declare ------------------------------*/
 extern void   CoCreateKheap(void);
 
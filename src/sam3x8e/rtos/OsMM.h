@@ -23,7 +23,7 @@
 typedef struct Memory
 {
     U8*   memAddr;
-    U8*   freeBlock;
+    U8* volatile freeBlock;
     U32   blockSize;
     U32   blockNum;			
 }MM,*P_MM;
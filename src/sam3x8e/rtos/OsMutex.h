@@ -27,6 +27,7 @@
 #define   MUTEX_FREE        0           /*!< Mutex is free                    */
 #define   MUTEX_OCCUPY      1           /*!< Mutex is occupy                  */
 #define   WAITING_MUTEX     0x80
+#define   MUTEX_NO_CEILING  0xff        /*!< Mutex uses priority inheritance  */
 
 /**
  * @struct   Mutex  mutex.h 	
@@ -37,12 +38,22 @@ typedef struct Mutex
 {
     U8       originalPrio;              /*!< Mutex priority.                  */
     U8       mutexFlag;                 /*!< Mutex flag.                      */
-    OS_TID   taskID;                    /*!< Task ID.                         */	
-    OS_TID   hipriTaskID;               /*!< Mutex ID.                        */
+#if CFG_MUTEX_CEILING_EN >0
+    U8       ceiling;                   /*!< Ceiling priority of the owner.   */
+#endif
+    volatile OS_TID taskID;             /*!< Task ID of owner,claims mutex.   */	
+    volatile OS_TID hipriTaskID;        /*!< Highest task about the mutex.    */
     P_OSTCB  waittingList;              /*!< waitting the Mutex.              */
 }MUTEX,*P_MUTEX;
 
 
+#if CFG_MUTEX_CEILING_EN >0
+#define MUTEX_HAS_CEILING(pMutex)   ((pMutex)->ceiling != MUTEX_NO_CEILING)
+#else
+#define MUTEX_HAS_CEILING(pMutex)   (0)
+#endif
+
+
 /*---------------------------- Variable declare ------------------------------*/
 /*!< Table use to save mutex control block.                                   */
 extern MUTEX      MutexTbl[CFG_MAX_MUTEX];
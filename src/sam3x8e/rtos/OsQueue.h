@@ -36,5 +36,13 @@ typedef struct Queue
     U16     qSize;                      /*!< Current size of queue            */
 }QCB,*P_QCB;
 
+/*!< Queue control block of a static queue.                                   */
+#define OS_STATIC_QCB(name,...) OS_QCB_##name,
+enum { CFG_STATIC_QUEUES(OS_STATIC_QCB) OS_STATIC_QUEUES };
+
+
+/*---------------------------- Variable declare ------------------------------*/
+extern QCB   QueueTbl[CFG_MAX_QUEUE];   /*!< Queue control block table        */
+
 
 #endif
@@ -0,0 +1,54 @@
+/**
+ *******************************************************************************
+ * @file       OsRwLock.h
+ * @version    V1.13
+ * @date       2026.10.14
+ * @brief      Reader-writer lock management header file
+ * @details    A reader-writer lock is held by any number of readers or by one
+ *             writer. Readers and writers wait in the waiting list of an
+ *             event,a waiting writer keeps new readers out. In a PRI sorted
+ *             list a reader of higher PRI still goes before the writer. The
+ *             writer is promoted to the PRI of the tasks it blocks,like a
+ *             mutex owner.
+ *******************************************************************************
+ * @copy
+ *
+ * INTERNAL FILE,DON'T PUBLIC.
+ *
+ * <h2><center>&copy; COPYRIGHT 2009 CooCox </center></h2>
+ *******************************************************************************
+ */
+
+
+#ifndef _RWLOCK_H
+#define _RWLOCK_H
+
+/*!< Value of pmail of a task waiting on a reader-writer lock.                */
+#define  RWLOCK_WAIT_READ   ((void*)0x1)        /*!< Waits to read            */
+#define  RWLOCK_WAIT_WRITE  ((void*)0x2)        /*!< Waits to write           */
+#define  RWLOCK_GRANTED     ((void*)0xffffffff) /*!< Got the lock             */
+
+/**
+ * @struct   RwLock  OsRwLock.h
+ * @brief    Reader-writer lock struct
+ * @details  This struct use to manage reader-writer locks.
+ *
+ */
+typedef struct RwLock
+{
+    U8       id;                        /*!< Reader-writer lock ID            */
+    OS_TID   writerID;                  /*!< Task ID of the writer            */
+    U8       originalPrio;              /*!< PRI of the writer when it locked */
+    OS_EventID eventID;                 /*!< Event of the waiting list        */
+    U16      readers;                   /*!< Number of readers holding it     */
+}RWLOCK,*P_RWLOCK;
+
+
+/*---------------------------- Variable declare ------------------------------*/
+extern RWLOCK RwLockTbl[CFG_MAX_RWLOCK];/*!< Reader-writer lock table        */
+
+
+/*---------------------------- Function declare ------------------------------*/
+extern void   RemoveRwLockWriter(P_OSTCB ptcb);
+
+#endif
@@ -21,14 +21,29 @@
 #define _SERVICEREQ_H
 
 #if CFG_MAX_SERVICE_REQUEST > 0
+#if (CFG_MAX_SERVICE_REQUEST < 2) || \
+    ((CFG_MAX_SERVICE_REQUEST & (CFG_MAX_SERVICE_REQUEST - 1)) != 0)
+#error "CFG_MAX_SERVICE_REQUEST must be a power of two"
+#endif
+
 #define   SEM_REQ       (U8)0x1
 #define   MBOX_REQ      (U8)0x2
 #define   FLAG_REQ      (U8)0x3
 #define   QUEUE_REQ     (U8)0x4
 
+#define   SRQ_MASK      ((U32)CFG_MAX_SERVICE_REQUEST - 1)
+#define   SRQ_LAP(pos)  ((pos) & ~SRQ_MASK) /*!< First position of the lap   */
+
 
+/**
+ * @struct   ServiceReqCell  OsServiceReq.h
+ * @brief    Service request cell
+ * @details  seq is SRQ_LAP(pos) while the cell is free for position pos and
+ *           SRQ_LAP(pos)+1 once the request at pos has been written.
+ */
 typedef struct ServiceReqCell
 {
+    volatile U32 seq;
     U8      type;
     U8      id;
     U8		_padding[2];
@@ -37,9 +52,8 @@ typedef struct ServiceReqCell
 
 typedef struct ServiceReqQueue
 {
-    U8    cnt;
-    U8    head;
-    U8		_padding[2];
+    volatile U32 head;                  /*!< Next position to respond         */
+    volatile U32 tail;                  /*!< Next position to insert          */
     SQC   cell[CFG_MAX_SERVICE_REQUEST];
 }SRQ,*P_SRQ;
 
@@ -0,0 +1,55 @@
+/**
+ *******************************************************************************
+ * @file       OsStreamBuf.h
+ * @version    V1.13
+ * @date       2026.10.14
+ * @brief      Stream and message buffer management header file
+ * @details    A stream buffer copies bytes into a ring buffer for one writer
+ *             and one reader. The writer only moves the head and the reader
+ *             only moves the tail,so neither needs a lock. A flag wakes the
+ *             reader when the trigger level is reached and another one wakes
+ *             the writer when there is room again. A message buffer is a
+ *             stream buffer that holds messages with a 2-byte length each.
+ *******************************************************************************
+ * @copy
+ *
+ * INTERNAL FILE,DON'T PUBLIC.
+ *
+ * <h2><center>&copy; COPYRIGHT 2009 CooCox </center></h2>
+ *******************************************************************************
+ */
+
+
+#ifndef _STREAMBUF_H
+#define _STREAMBUF_H
+
+#define  SBUF_TYPE_STREAM   (U8)0x01    /*!< Bytes with a trigger level       */
+#define  SBUF_TYPE_MESSAGE  (U8)0x02    /*!< Messages with a length          */
+#define  SBUF_MSG_HEAD      (2)         /*!< Bytes of the length of a message */
+
+/**
+ * @struct   StreamBuf  OsStreamBuf.h
+ * @brief    Stream buffer struct
+ * @details  This struct use to manage stream and message buffers.
+ *
+ */
+typedef struct StreamBuf
+{
+    U8*          buf;                   /*!< Ring buffer                      */
+    U32          mask;                  /*!< Size of the ring buffer - 1      */
+    volatile U32 head;                  /*!< Bytes written,moved by the writer*/
+    volatile U32 tail;                  /*!< Bytes read,moved by the reader   */
+    U32          trigger;               /*!< Bytes that wake the reader       */
+    volatile U32 rxLevel;               /*!< Bytes the waiting reader needs   */
+    volatile U32 txLevel;               /*!< Room the waiting writer needs    */
+    volatile U8  rxWait;                /*!< Reader is waiting for bytes      */
+    volatile U8  txWait;                /*!< Writer is waiting for room       */
+    OS_FlagID    rxFlag;                /*!< Flag the reader waits for        */
+    OS_FlagID    txFlag;                /*!< Flag the writer waits for        */
+    U8           type;                  /*!< SBUF_TYPE_STREAM or _MESSAGE     */
+}SBUF,*P_SBUF;
+
+
+extern U32  SBufIDVessel;
+
+#endif
@@ -26,6 +26,12 @@
 #define  TASK_DORMANT   3               /*!< Dormant status of task.          */ 
 
 
+/*---------------------------- Notify Status ---------------------------------*/
+#define  NOTIFY_NONE    0               /*!< No notification.                 */
+#define  NOTIFY_WAITING 1               /*!< Task waits for a notification.   */
+#define  NOTIFY_PENDING 2               /*!< Notification not taken yet.      */
+
+
 #define  INVALID_ID     (U8)0xff
 #define  INVALID_VALUE  (U32)0xffffffff
 #define  MAGIC_WORD     (U32)0x5a5aa5a5
@@ -41,6 +47,9 @@ typedef  struct TCB
     OS_STK      *stkPtr;                /*!< The current point of task.       */
     U8          prio;                   /*!< Task priority.                   */
     U8          state;                  /*!< TaSk status.                     */
+#if CFG_BITMAP_SCHEDULE_EN >0
+    U8          rdyPrio;                /*!< PRI of the READY list it is in.  */
+#endif
     OS_TID      taskID;                 /*!< Task ID.                         */
 
 #if CFG_MUTEX_EN > 0
@@ -49,6 +58,9 @@ typedef  struct TCB
    
 #if CFG_EVENT_EN > 0
     OS_EventID  eventID;                /*!< Event ID.                        */
+#if CFG_EVENT_PRIO_MAP_EN >0
+    U8          waitPrio;               /*!< PRI it waits with in the map.    */
+#endif
 #endif
     
 #if CFG_ROBIN_EN >0
@@ -58,6 +70,9 @@ typedef  struct TCB
 #if CFG_STK_CHECKOUT_EN >0
     OS_STK      *stack;                 /*!< The top point of task.           */
 #endif
+#if CFG_STK_PAINT_EN >0
+    U16         stkSize;                /*!< Words of the stack.              */
+#endif
     
 #if CFG_EVENT_EN > 0
     void*       pmail;                  /*!< Mail to task.                    */
@@ -78,6 +93,26 @@ typedef  struct TCB
 #if CFG_TASK_WAITTING_EN >0
     U32         delayTick;              /*!< The number of ticks which delay. */
 #endif    
+#if CFG_TASK_NOTIFY_EN >0
+    volatile U32 notifyValue;           /*!< Notification value.              */
+    volatile U8  notifyState;           /*!< NOTIFY_NONE,_WAITING or _PENDING */
+#endif
+#if CFG_TASK_STATS_EN >0
+    U64         cycles;                 /*!< CPU cycles the task has run.     */
+    U32         switches;               /*!< Times the task was switched in.  */
+    U32         preempts;               /*!< Times it was switched out ready. */
+#endif
+#if CFG_TMR_WHEEL_EN >0
+    WHEEL_NODE  dlyNode;                /*!< Node in the timer wheel.         */
+#endif
+#if CFG_EDF_EN >0
+    U64         edfRelease;             /*!< Release tick of the current job. */
+    U64         edfDeadline;            /*!< Deadline tick of the current job.*/
+    U32         edfPeriod;              /*!< Period in ticks,0 if not EDF.    */
+    U32         edfRelDeadline;         /*!< Deadline after the release.      */
+    U32         edfJobs;                /*!< Jobs finished.                   */
+    U32         edfMisses;              /*!< Jobs that missed the deadline.   */
+#endif
     struct TCB  *TCBnext;               /*!< The pointer to next TCB.         */
     struct TCB  *TCBprev;               /*!< The pointer to prev TCB.         */
 
@@ -104,9 +139,22 @@ void  IdleTask(void* pdata);  /*!< IDLE task code                             */
 void  InsertToTCBRdyList  (P_OSTCB tcbInser);	
 void  RemoveFromTCBRdyList(P_OSTCB ptcb);
 void  CreateTCBList(void);
+void  CreateStaticTasks(void);
 #if CFG_ORDER_LIST_SCHEDULE_EN ==0
 void  ActiveTaskPri(U8 pri);
 void  DeleteTaskPri(U8 pri);
 #endif
+#if CFG_TASK_NOTIFY_EN >0
+#if CFG_EDF_EN >0
+/*!< Whether task a goes before task b at CFG_EDF_PRIO.                       */
+#define  EDF_BEFORE(a,b)    ((a)->edfDeadline < (b)->edfDeadline)
+#endif
+extern BOOL NotifyReq;        /*!< Deferred notification request              */
+void  NotifyDispose(void);
+#endif
+#if CFG_TASK_STATS_EN >0
+void  StatsStart(void);
+void  StatsUpdate(void);
+#endif
 
 #endif
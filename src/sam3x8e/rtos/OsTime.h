@@ -20,9 +20,19 @@
 /*---------------------------- Variable declare ------------------------------*/
 extern P_OSTCB  DlyList;            /*!< A pointer to ther delay list.        */
 
+/*!< Ticks of a time,the milliseconds rounded to the nearest tick. The U64
+     keeps hours at 10 kHz ticks from overflowing,the divisions are by
+     constants,which the compiler turns into multiply-shift sequences.        */
+#define TIME_TO_TICKS(hour,minute,sec,millsec)                                \
+    ((U64)((U32)(hour)*3600 + (U32)(minute)*60 + (sec)) * CFG_SYSTICK_FREQ    \
+     + ((U32)(millsec)*CFG_SYSTICK_FREQ + 500) / 1000)
+
 /*---------------------------- Function declare ------------------------------*/
 extern void  TimeDispose(void);     /*!< Time dispose function.               */
 extern void  isr_TimeDispose(void);
 extern void  RemoveDelayList(P_OSTCB ptcb);
 extern void  InsertDelayList(P_OSTCB ptcb,U32 ticks);
+#if CFG_TMR_WHEEL_EN >0
+extern void  DelayExpire(P_OSTCB ptcb); /*!< Delay expiry from the wheel.    */
+#endif
 #endif
@@ -38,6 +38,9 @@ typedef struct tmrCtrl                  /* Timer Control Block Define.        */
     vFUNCPtr         tmrCallBack; /*!< Call-back Function When Timer overrun. */	
     struct tmrCtrl*  tmrNext;       /*!< Point to Next Timer Control Block.   */
     struct tmrCtrl*  tmrPrev;       /*!< Point to Previous Timer Control Block*/
+#if CFG_TMR_WHEEL_EN >0
+    WHEEL_NODE       tmrNode;           /*!< Node in the timer wheel.         */
+#endif
 
 }TmrCtrl,*P_TmrCtrl;
 
@@ -47,4 +50,11 @@ extern U32        TmrIDVessel;
 /*---------------------------- Function declare ------------------------------*/
 extern void  TmrDispose(void);          /*!< Timer counter function.          */
 extern void  isr_TmrDispose(void);
+#if CFG_TMR_DAEMON_EN >0
+extern OS_TID TmrDaemonID;              /*!< Task ID of the timer daemon.     */
+extern void  CreateTmrDaemon(void);
+#endif
+#if CFG_TMR_WHEEL_EN >0
+extern void  TmrExpire(P_TmrCtrl pTmr); /*!< Timer expiry from the wheel.    */
+#endif
 #endif
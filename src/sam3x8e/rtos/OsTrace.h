@@ -0,0 +1,96 @@
+/**
+ *******************************************************************************
+ * @file       OsTrace.h
+ * @version    V1.13
+ * @date       2026.10.14
+ * @brief      Kernel event trace header file
+ * @details    With CFG_TRACE_EN the kernel logs its events into a ring buffer
+ *             of CFG_TRACE_SIZE records. A record costs a read of the DWT
+ *             cycle counter and two stores with interrupts disabled.
+ *
+ *             The records are read out in the order they were logged,as a
+ *             stream of 8-byte records,all fields little-endian:
+ *
+ *             @verbatim
+ *             offset  size  field
+ *             0       4     time   DWT_CYCCNT when the event was logged
+ *             4       1     event  TRACE_xxx
+ *             5       1     id     task,ISR,event,mutex or timer ID
+ *             6       2     arg    depends on the event,see below
+ *             @endverbatim
+ *
+ *             A full buffer drops new records. The next record that fits is
+ *             preceded by a TRACE_LOST record with the number of records
+ *             dropped (at most 0xFFFF) in arg.
+ *******************************************************************************
+ * @copy
+ *
+ * INTERNAL FILE,DON'T PUBLIC.
+ *
+ * <h2><center>&copy; COPYRIGHT 2009 CooCox </center></h2>
+ *******************************************************************************
+ */
+
+
+#ifndef _TRACE_H
+#define _TRACE_H
+
+/*---------------------------- Trace Events ----------------------------------*/
+#define  TRACE_LOST         (U8)0x00    /*!< arg: records dropped             */
+#define  TRACE_SWITCH       (U8)0x01    /*!< id: task out,arg: task in        */
+#define  TRACE_ISR_ENTER    (U8)0x02    /*!< id: exception number,arg: nesting*/
+#define  TRACE_ISR_EXIT     (U8)0x03    /*!< id: exception number,arg: nesting*/
+#define  TRACE_SEM_PEND     (U8)0x10    /*!< id: event ID,arg: running task   */
+#define  TRACE_SEM_POST     (U8)0x11    /*!< id: event ID,arg: running task   */
+#define  TRACE_MUTEX_ENTER  (U8)0x20    /*!< id: mutex ID,arg: running task   */
+#define  TRACE_MUTEX_LEAVE  (U8)0x21    /*!< id: mutex ID,arg: running task   */
+#define  TRACE_QUEUE_PEND   (U8)0x30    /*!< id: event ID,arg: running task   */
+#define  TRACE_QUEUE_POST   (U8)0x31    /*!< id: event ID,arg: running task   */
+#define  TRACE_TMR_EXPIRE   (U8)0x40    /*!< id: timer ID,arg: 0              */
+#define  TRACE_RWLOCK_READ  (U8)0x50    /*!< id: event ID,arg: running task   */
+#define  TRACE_RWLOCK_WRITE (U8)0x51    /*!< id: event ID,arg: running task   */
+#define  TRACE_RWLOCK_UNLOCK (U8)0x52   /*!< id: event ID,arg: running task   */
+#define  TRACE_USER         (U8)0x80    /*!< 0x80-0xFF for CoTraceEvent()     */
+
+#define  TRACE_RECORD_SIZE  (8)         /*!< Bytes of a record                */
+
+
+#if CFG_TRACE_EN > 0
+
+/**
+ * @struct   TraceRecord  OsTrace.h
+ * @brief    Trace record struct
+ * @details  This struct is one record of the trace,see the format above.
+ *
+ */
+typedef struct TraceRecord
+{
+    U32  time;                          /*!< DWT_CYCCNT                       */
+    U8   event;                         /*!< TRACE_xxx                        */
+    U8   id;                            /*!< Object the event is about        */
+    U16  arg;                           /*!< Argument of the event            */
+}TRACE_REC,*P_TRACE_REC;
+
+extern void TraceStart(void);
+extern void TraceEvent(U8 event,U8 id,U16 arg);
+
+/*!< Exception number of the running ISR.                                      */
+static inline U8 TraceIpsr(void)
+{
+    U32 ipsr;
+    __asm volatile (" MRS %0, IPSR \n" : "=r" (ipsr));
+    return (U8)ipsr;
+}
+
+/*!< Log an event with the ID of the running task in arg.                     */
+#define TRACE(event,id)         TraceEvent((event),(U8)(id),TCBRunning->taskID)
+#define TRACE_ARG(event,id,arg) TraceEvent((event),(U8)(id),(U16)(arg))
+
+#else
+
+#define TRACE(event,id)         ((void)0)
+#define TRACE_ARG(event,id,arg) ((void)0)
+
+#endif
+
+#endif
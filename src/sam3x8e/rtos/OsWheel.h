@@ -0,0 +1,57 @@
+/**
+ *******************************************************************************
+ * @file       OsWheel.h
+ * @version    V1.13    
+ * @date       2026.10.14
+ * @brief      Header file related to the timer wheel
+ * @details    The timer wheel keeps the DELAY list and the timer list when
+ *             CFG_TMR_WHEEL_EN is enabled. Each of its WHEEL_LEVELS levels has
+ *             WHEEL_SIZE slots,a node goes to the lowest level whose range
+ *             covers its expiry and moves down a level when the slot of its
+ *             level comes around,so insert and remove take a constant time.
+ *******************************************************************************
+ * @copy
+ *
+ * INTERNAL FILE,DON'T PUBLIC.
+ * 
+ * <h2><center>&copy; COPYRIGHT 2009 CooCox </center></h2>
+ *******************************************************************************
+ */ 
+
+#ifndef _WHEEL_H
+#define _WHEEL_H
+
+#if CFG_TMR_WHEEL_EN >0
+
+#define  WHEEL_BITS       (6)           /*!< log2 of slots per level          */
+#define  WHEEL_SIZE       (1u << WHEEL_BITS)
+#define  WHEEL_MASK       (WHEEL_SIZE - 1)
+#define  WHEEL_LEVELS     (4)           /*!< Levels,2^24 ticks in range       */
+
+#define  WHEEL_TYPE_TASK  (U8)0x0       /*!< Node of a task in DELAY list     */
+#define  WHEEL_TYPE_TMR   (U8)0x1       /*!< Node of a running timer          */
+
+/**
+ * @struct  WheelNode  OsWheel.h  	
+ * @brief   Node of the timer wheel.
+ * @details A TCB and a timer control block each hold one.	 	
+ */
+typedef struct WheelNode
+{
+    struct WheelNode  *next;            /*!< Next node in the slot.           */
+    struct WheelNode  *prev;            /*!< Prev node in the slot.           */
+    struct WheelNode  **slot;           /*!< Slot it is in,NULL if none.      */
+    void              *owner;           /*!< The TCB or the timer.            */
+    U32               expire;           /*!< Tick of the expiry.              */
+    U8                type;             /*!< WHEEL_TYPE_TASK or _TMR.         */
+}WHEEL_NODE,*P_WHEEL_NODE;
+
+/*---------------------------- Function declare ------------------------------*/
+extern void  WheelInsert(P_WHEEL_NODE node,U32 ticks);
+extern void  WheelRemove(P_WHEEL_NODE node);
+extern U32   WheelGetTicks(P_WHEEL_NODE node);
+extern U32   WheelNextTicks(void);
+extern void  WheelDispose(void);
+
+#endif
+#endif
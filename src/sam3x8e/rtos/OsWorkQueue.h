@@ -0,0 +1,60 @@
+/**
+ *******************************************************************************
+ * @file       OsWorkQueue.h
+ * @version    V1.13
+ * @date       2026.10.14
+ * @brief      Work queue management header file
+ * @details    A worker is a task that runs the {function,argument} items
+ *             queued to it,one after the other in queue order. Items are
+ *             queued with interrupts disabled for a few instructions,so
+ *             tasks and ISRs can queue to the same worker. A semaphore counts
+ *             the items;an ISR posts it through the service request queue.
+ *******************************************************************************
+ * @copy
+ *
+ * INTERNAL FILE,DON'T PUBLIC.
+ *
+ * <h2><center>&copy; COPYRIGHT 2009 CooCox </center></h2>
+ *******************************************************************************
+ */
+
+
+#ifndef _WORKQUEUE_H
+#define _WORKQUEUE_H
+
+#define  WORK_MASK          ((U32)CFG_WORK_QUEUE_SIZE - 1)
+
+/**
+ * @struct   WorkItem  OsWorkQueue.h
+ * @brief    Work item struct
+ * @details  This struct is one function call queued to a worker.
+ *
+ */
+typedef struct WorkItem
+{
+    FUNCPtr  func;                      /*!< Function to call                 */
+    void*    arg;                       /*!< Its argument                     */
+}WORK_ITEM,*P_WORK_ITEM;
+
+/**
+ * @struct   Worker  OsWorkQueue.h
+ * @brief    Worker struct
+ * @details  This struct use to manage a worker and its queue. head and tail
+ *           count the items taken and queued since the worker was created.
+ *
+ */
+typedef struct Worker
+{
+    U32        head;                    /*!< Items taken by the worker        */
+    U32        tail;                    /*!< Items queued                     */
+    OS_TID     taskID;                  /*!< Task of the worker               */
+    OS_EventID semID;                   /*!< Semaphore counting the items     */
+    U8         _padding[2];
+    WORK_ITEM  item[CFG_WORK_QUEUE_SIZE];
+}WORKER,*P_WORKER;
+
+
+/*---------------------------- Variable declare ------------------------------*/
+extern WORKER  WorkerTbl[CFG_MAX_WORKER];   /*!< Worker table                 */
+
+#endif
@@ -62,7 +62,12 @@ void SysTick_Handler(void)
 {
     OSSchedLock++;                  /* Lock scheduler.                        */
     OSTickCnt++;                    /* Increment systerm time.                */
-#if CFG_TASK_WAITTING_EN >0    
+#if CFG_TASK_STATS_EN >0
+    StatsUpdate();                  /* Charge the running task,before CYCCNT  */
+#endif                              /* wraps                                  */
+#if CFG_TMR_WHEEL_EN >0
+    isr_TimeDispose();              /* Bring the timer wheel up to date       */
+#elif CFG_TASK_WAITTING_EN >0    
     if(DlyList != NULL)             /* Have task in delay list?               */
     {
         if(DlyList->delayTick > 1)  /* Delay time > 1?                        */
@@ -77,7 +82,7 @@ void SysTick_Handler(void)
     }
 #endif
     
-#if CFG_TMR_EN > 0	
+#if (CFG_TMR_EN > 0) && (CFG_TMR_WHEEL_EN == 0)
     if(TmrList != NULL)             /* Have timer in working?                 */
     {
         if(TmrList->tmrCnt > 1)     /* Timer time > 1?                        */
@@ -94,3 +99,413 @@ void SysTick_Handler(void)
 	TaskSchedReq = TRUE;
     OsSchedUnlock();
 }
+
+
+U32 SysTickReload = SYSTICK_RELOAD(CFG_CPU_FREQ);   /*!< Reload of one tick   */
+
+/**
+ *******************************************************************************
+ * @brief      Set the CPU frequency the system tick is counted in.
+ * @param[in]  freq     CPU frequency (Hz),CFG_CPU_FREQ at start.
+ * @param[out] None
+ * @retval     None
+ *
+ * @par Description
+ * @details    This function is called after the CPU clock changed,so the
+ *             system tick keeps CFG_SYSTICK_FREQ. The current tick ends at
+ *             the old time,the new reload is used from the next tick on.
+ *******************************************************************************
+ */
+void CoSetCpuFreq(U32 freq)
+{
+    IRQ_DISABLE_SAVE();
+    SysTickReload  = SYSTICK_RELOAD(freq);
+    NVIC_ST_RELOAD = SysTickReload;
+    IRQ_ENABLE_RESTORE();
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Clock notifier of the PMC.
+ * @param[in]  mck      New master clock (Hz).
+ * @param[out] None
+ * @retval     None
+ *
+ * @par Description
+ * @details    This function is added to the clock notifiers by CoInitOS(),
+ *             pmc_set_clock_profile() calls it.
+ *******************************************************************************
+ */
+void SysTickClockChanged(uint32_t mck)
+{
+    CoSetCpuFreq((U32)mck);
+}
+
+
+
+#if CFG_IDLE_SLEEP_EN >0
+#define IDLE_MODES  3                   /*!< Sleep,tickless and wait modes    */
+U64     IdleCycles[IDLE_MODES]  = {0};  /*!< SysTick cycles slept per mode    */
+U32     IdleEntries[IDLE_MODES] = {0};  /*!< Sleeps per mode                  */
+#endif
+
+#if (CFG_IDLE_SLEEP_EN >0) || (CFG_TICKLESS_EN >0)
+/**
+ *******************************************************************************
+ * @brief      Wait for an interrupt with interrupts disabled.
+ * @param[in]  None	 
+ * @param[out] None  	 
+ * @retval     None
+ *		 
+ * @par Description
+ * @details    The interrupt that wakes the core runs once interrupts are
+ *             enabled again.
+ *******************************************************************************
+ */ 
+static void IdleWfi(void)
+{
+#if CFG_MAX_SYSCALL_PRIO > 0
+    /* WFI is not woken by interrupts masked with BASEPRI,mask with PRIMASK  */
+    __asm volatile (" CPSID I \n MSR BASEPRI,%0 \n DSB \n WFI \n ISB \n"
+                    : : "r"(0) : "memory");
+    IRQ_DISABLE_SAVE();
+    __asm volatile (" CPSIE I \n" ::: "memory");
+#else
+    __asm volatile (" DSB \n WFI \n ISB \n");
+#endif
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Is there work for the scheduler?
+ * @param[in]  None	 
+ * @param[out] None  	 
+ * @retval     TRUE     A task is ready or a request is pending.
+ * @retval     FALSE    The IDLE task may sleep.
+ *
+ * @par Description
+ * @details    This function is called with interrupts disabled.
+ *******************************************************************************
+ */ 
+static BOOL IdleBusy(void)
+{
+    if((TCBRdy != NULL) || (IsrReq == TRUE))
+    {
+        return TRUE;
+    }
+#if CFG_TASK_WAITTING_EN >0
+    if(TimeReq == TRUE)
+    {
+        return TRUE;
+    }
+#endif
+#if CFG_TMR_EN > 0
+    if(TimerReq == TRUE)
+    {
+        return TRUE;
+    }
+#endif
+    return FALSE;
+}
+#endif
+
+
+#if CFG_IDLE_WAIT_EN >0
+/**
+ *******************************************************************************
+ * @brief      Are all peripheral clocks off?
+ * @param[in]  None	 
+ * @param[out] None  	 
+ * @retval     TRUE     No peripheral needs the master clock.
+ * @retval     FALSE    A peripheral clock is on.
+ *******************************************************************************
+ */ 
+static BOOL IdleClocksOff(void)
+{
+    U32 id;
+    
+    for(id = ID_UART; id <= ID_MAX; id++) /* The system peripherals below the */
+    {                                   /* UART have no clock to stop         */
+        if(pmc_peripheral_clock_enabled(id) != 0)
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+#endif
+
+
+#if CFG_TICKLESS_EN >0
+/**
+ *******************************************************************************
+ * @brief      Sleep without system tick until the next expiry.
+ * @param[in]  None	 
+ * @param[out] None  	 
+ * @retval     TRUE     It slept.
+ * @retval     FALSE    It returned at once.
+ *		 
+ * @par Description
+ * @details    This function is called by the IDLE task. It reloads SysTick
+ *             with the time to the next DELAY or timer expiry,sleeps with WFI
+ *             and,on wakeup,adds the ticks that went by to OSTickCnt and to
+ *             the heads of the DELAY and timer lists. The tick that ends the
+ *             sleep is left to SysTick_Handler(). With CFG_IDLE_WAIT_EN and
+ *             no expiry pending it enters wait mode instead.
+ * @note       Returns at once if less than CFG_TICKLESS_MIN_TICKS are left.
+ *******************************************************************************
+ */ 
+BOOL TicklessIdle(void)
+{
+    U32 ticks,period,start,load,elapsed,skipped;
+    
+    period = RELOAD_VAL + 1;
+    ticks  = 0xFFFFFFFF;                /* No expiry,sleep as long as we can  */
+    IRQ_DISABLE_SAVE();
+    
+    /* Is a task ready or a request pending? Then don't sleep.                */
+    if(IdleBusy() == TRUE)
+    {
+        IRQ_ENABLE_RESTORE();
+        return FALSE;
+    }
+#if CFG_TASK_WAITTING_EN >0
+#if CFG_TMR_WHEEL_EN >0
+    ticks = WheelNextTicks();           /* Get ticks to the next wheel work   */
+#else
+    if(DlyList != NULL)                 /* Get ticks to the next DELAY expiry */
+    {
+        ticks = DlyList->delayTick;
+    }
+#endif
+#endif
+#if CFG_TMR_EN > 0
+    if((TmrList != NULL) && (TmrList->tmrCnt < ticks))
+    {
+        ticks = TmrList->tmrCnt;        /* Get ticks to the next timer expiry */
+    }
+#endif
+    if(ticks < CFG_TICKLESS_MIN_TICKS)  /* Is the next tick soon enough?      */
+    {
+        IRQ_ENABLE_RESTORE();
+        return FALSE;
+    }
+    
+    /* Stop at the last tick before the expiry,SysTick_Handler() does it.     */
+    NVIC_ST_CTRL &= ~NVIC_ST_CTRL_ENABLE;
+    if(NVIC_ICSR & NVIC_PENDSTSET)  /* Is a tick pending already?         */
+    {
+        NVIC_ST_CTRL |= NVIC_ST_CTRL_ENABLE;
+        IRQ_ENABLE_RESTORE();
+        return FALSE;
+    }
+#if CFG_IDLE_WAIT_EN >0
+    /* Nothing to wait for and no peripheral running? Then stop all clocks.   */
+    if((ticks == 0xFFFFFFFF) && (IdleClocksOff() == TRUE) &&
+       (pmc_enter_wait_mode() == 1))
+    {
+        IdleEntries[IDLE_MODE_WAIT]++;
+        NVIC_ST_CTRL |= NVIC_ST_CTRL_ENABLE;/* Go on from the stopped count   */
+        IRQ_ENABLE_RESTORE();           /* Run the interrupt that woke us up  */
+        return TRUE;
+    }
+#endif
+    start   = NVIC_ST_CURRENT;          /* Cycles to the next tick            */
+    skipped = ticks - 1;
+    if(skipped > (0x00FFFFFF - start) / period)
+    {
+        skipped = (0x00FFFFFF - start) / period;
+    }
+    load = start + skipped * period;
+    NVIC_ST_RELOAD  = load;
+    NVIC_ST_CURRENT = 0;
+    NVIC_ST_CTRL   |= NVIC_ST_CTRL_ENABLE;
+    
+    IdleWfi();
+    
+    NVIC_ST_CTRL &= ~NVIC_ST_CTRL_ENABLE;
+    if(NVIC_ICSR & NVIC_PENDSTSET)  /* Has the whole sleep gone by?       */
+    {                                   /* Yes,the tick is pending            */
+        NVIC_ST_RELOAD  = RELOAD_VAL;
+        NVIC_ST_CURRENT = 0;
+#if CFG_IDLE_SLEEP_EN >0
+        IdleCycles[IDLE_MODE_TICKLESS] += load + 1;
+#endif
+    }
+    else                                /* No,woken up by another interrupt   */
+    {
+        elapsed = load - NVIC_ST_CURRENT;
+#if CFG_IDLE_SLEEP_EN >0
+        IdleCycles[IDLE_MODE_TICKLESS] += elapsed;
+#endif
+        skipped = 0;
+        if(elapsed >= start)            /* Count the ticks that went by       */
+        {
+            skipped = 1 + (elapsed - start) / period;
+            elapsed = (elapsed - start) % period;
+            start   = period;
+        }
+        load = start - elapsed - 1;     /* Cycles left to the next tick       */
+        NVIC_ST_RELOAD  = (load != 0) ? load : 1;
+        NVIC_ST_CURRENT = 0;
+    }
+    NVIC_ST_CTRL  |= NVIC_ST_CTRL_ENABLE;
+    NVIC_ST_RELOAD = RELOAD_VAL;        /* Used from the next tick on         */
+#if CFG_IDLE_SLEEP_EN >0
+    IdleEntries[IDLE_MODE_TICKLESS]++;
+#endif
+    
+    /* Correct the system time,no list head can expire here.                  */
+    OSTickCnt += skipped;
+#if CFG_TASK_WAITTING_EN >0
+    if(DlyList != NULL)
+    {
+        DlyList->delayTick -= skipped;
+    }
+#endif
+#if CFG_TMR_EN > 0
+    if(TmrList != NULL)
+    {
+        TmrList->tmrCnt -= skipped;
+    }
+#endif
+    IRQ_ENABLE_RESTORE();               /* Run the interrupt that woke us up  */
+    return TRUE;
+}
+#endif
+
+
+#if CFG_IDLE_SLEEP_EN >0
+/**
+ *******************************************************************************
+ * @brief      Stop the idle peripheral clocks of a mask.
+ * @param[in]  mask     Clocks to stop,bit n is peripheral base+n.
+ * @param[in]  base     ID of bit 0.
+ * @param[out] None  	 
+ * @retval     The clocks that were on and are stopped now.
+ *******************************************************************************
+ */ 
+static U32 IdleGateClocks(U32 mask,U32 base)
+{
+    U32 gated,bit;
+    
+    gated = 0;
+    while(mask != 0)
+    {
+        bit   = __builtin_ctz(mask);
+        mask &= mask - 1;
+        if(pmc_peripheral_clock_enabled(base + bit) != 0)
+        {
+            pmc_disable_peripheral_clock(base + bit);
+            gated |= 1u << bit;
+        }
+    }
+    return gated;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Restart the peripheral clocks stopped by IdleGateClocks().
+ * @param[in]  gated    Clocks to start,bit n is peripheral base+n.
+ * @param[in]  base     ID of bit 0.
+ * @param[out] None  	 
+ * @retval     None
+ *******************************************************************************
+ */ 
+static void IdleUngateClocks(U32 gated,U32 base)
+{
+    while(gated != 0)
+    {
+        pmc_enable_peripheral_clock(base + __builtin_ctz(gated));
+        gated &= gated - 1;
+    }
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Sleep in the IDLE task.
+ * @param[in]  None	 
+ * @param[out] None  	 
+ * @retval     None
+ *		 
+ * @par Description
+ * @details    This function is called by the IDLE task in its loop. It stops
+ *             the clocks of CFG_IDLE_GATE_MASK0/1,sleeps with tickless idle
+ *             or wait mode if they may be used,else with WFI until the next
+ *             interrupt,and restarts the clocks. The sleep time is counted in
+ *             SysTick cycles for CoGetIdleStats().
+ *******************************************************************************
+ */ 
+void IdleSleep(void)
+{
+    U32 gated0,gated1,start,end,cycles;
+    
+    gated0 = IdleGateClocks(CFG_IDLE_GATE_MASK0,0);
+    gated1 = IdleGateClocks(CFG_IDLE_GATE_MASK1,32);
+    
+#if CFG_TICKLESS_EN >0
+    if(TicklessIdle() == FALSE)         /* Is the next expiry too near?       */
+#endif
+    {                                   /* Yes,sleep with the tick running    */
+        IRQ_DISABLE_SAVE();
+        if((IdleBusy() == FALSE) && !(NVIC_ICSR & NVIC_PENDSTSET))
+        {
+            start  = NVIC_ST_CURRENT;
+            IdleWfi();
+            end    = NVIC_ST_CURRENT;
+            cycles = start - end;       /* SysTick counts down                */
+            if(NVIC_ICSR & NVIC_PENDSTSET)
+            {                           /* It reloaded while asleep           */
+                cycles += RELOAD_VAL + 1;
+            }
+            IdleCycles[IDLE_MODE_SLEEP] += cycles;
+            IdleEntries[IDLE_MODE_SLEEP]++;
+        }
+        IRQ_ENABLE_RESTORE();           /* Run the interrupt that woke us up  */
+    }
+    
+    IdleUngateClocks(gated0,0);
+    IdleUngateClocks(gated1,32);
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Get the sleep statistics of the IDLE task.
+ * @param[in]  mode     IDLE_MODE_SLEEP,IDLE_MODE_TICKLESS or IDLE_MODE_WAIT.
+ * @param[out] cycles   SysTick cycles slept in the mode,CFG_CPU_FREQ per
+ *                      second at the default clock profile. The stopped clocks of wait mode count 0.
+ * @param[out] entries  Times the mode was entered.
+ * @retval     E_INVALID_PARAMETER  Invalid mode.
+ * @retval     E_OK                 The statistics are read.
+ *
+ * @par Description
+ * @details    This function is called to check how long the system sleeps
+ *             in which mode. cycles or entries may be NULL.
+ *******************************************************************************
+ */ 
+StatusType CoGetIdleStats(U8 mode,U64* cycles,U32* entries)
+{
+#if CFG_PAR_CHECKOUT_EN >0
+    if(mode >= IDLE_MODES)
+    {
+        return E_INVALID_PARAMETER;
+    }
+#endif
+    IRQ_DISABLE_SAVE();                 /* Read the 64-bit count in one piece */
+    if(cycles != NULL)
+    {
+        *cycles = IdleCycles[mode];
+    }
+    if(entries != NULL)
+    {
+        *entries = IdleEntries[mode];
+    }
+    IRQ_ENABLE_RESTORE();
+    return E_OK;
+}
+#endif
@@ -23,10 +23,12 @@
 #include "CoOS.h"
 #include "OsArch.h"
 #include "OsCore.h"
+#include "OsWheel.h"
 #include "OsTask.h"
 #include "OsServiceReq.h"
 #include "OsError.h"
 #include "OsTime.h"
+#include "OsTrace.h"
 
 #ifndef NULL
 #define NULL          ((void *)0)
@@ -58,8 +60,20 @@
 	#include "OsQueue.h"
 #endif
 
+#if CFG_RWLOCK_EN > 0
+	#include "OsRwLock.h"
+#endif
+
 #if CFG_FLAG_EN	 > 0
 	#include "OsFlag.h"
 #endif
 
+#if CFG_STREAM_BUF_EN > 0
+	#include "OsStreamBuf.h"
+#endif
+
+#if CFG_WORK_QUEUE_EN > 0
+	#include "OsWorkQueue.h"
+#endif
+
 #endif    /* _COOCOX_H    */  
@@ -40,6 +40,7 @@ volatile BOOL   TaskSchedReq  = FALSE;
 void CoEnterISR(void)
 {
     Inc8(&OSIntNesting);                /* OSIntNesting increment             */
+    TRACE_ARG(TRACE_ISR_ENTER,TraceIpsr(),OSIntNesting);
 }
 
 
@@ -58,6 +59,7 @@ void CoEnterISR(void)
  */
 void CoExitISR(void)
 {
+    TRACE_ARG(TRACE_ISR_EXIT,TraceIpsr(),OSIntNesting);
     Dec8(&OSIntNesting);                /* OSIntNesting decrease              */
     if( OSIntNesting == 0)              /* Is OSIntNesting == 0?              */
     {
@@ -173,6 +175,10 @@ void CoSchedUnlock(void)
 void CoInitOS(void)
 {
     InitSysTick();                /* Initialize system tick.                  */
+    pmc_add_clock_notifier(SysTickClockChanged);/* Follow the clock profile  */
+#if CFG_TRACE_EN > 0
+    TraceStart();                 /* Start the trace time stamps.             */
+#endif
     InitInt();                    /* Initialize PendSV,SVC,SysTick interrupt  */	
     CreateTCBList();              /* Create TCB list.                         */   
 #if CFG_EVENT_EN > 0				    
@@ -189,6 +195,10 @@ void CoInitOS(void)
                  &idle_stk[CFG_IDLE_STACK_SIZE-1],
                               CFG_IDLE_STACK_SIZE
                  );
+    CreateStaticTasks();          /* Create the tasks of CFG_STATIC_TASKS     */
+#if CFG_TMR_DAEMON_EN > 0
+    CreateTmrDaemon();            /* Create the task of the timer callbacks   */
+#endif
 				                  /* Set PSP for CoIdleTask coming in */ 
 	SetEnvironment(&idle_stk[CFG_IDLE_STACK_SIZE-1]);
 }
@@ -214,6 +224,9 @@ void CoStartOS(void)
     TCBNext     = TCBRunning;           /* Set next scheduled task as running task */
     TCBRunning->state = TASK_RUNNING;   /* Set running task status to RUNNING   */
     RemoveFromTCBRdyList(TCBRunning);   /* Remove running task from READY list  */
+#if CFG_TASK_STATS_EN > 0
+    StatsStart();                       /* Start the cycle counter              */
+#endif
     OsSchedUnlock();					/* Enable Schedule,call task schedule   */
 }
 
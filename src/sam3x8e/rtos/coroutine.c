@@ -0,0 +1,186 @@
+/**
+ *******************************************************************************
+ * @file       coroutine.c
+ * @version    V1.13
+ * @date       2026.10.14
+ * @brief      Coroutine runner implementation code of CooCox CoOS kernel.
+ *******************************************************************************
+ * @copy
+ *
+ * INTERNAL FILE,DON'T PUBLIC.
+ *
+ * <h2><center>&copy; COPYRIGHT 2009 CooCox </center></h2>
+ *******************************************************************************
+ */
+
+
+/*---------------------------- Include ---------------------------------------*/
+#include "coocox.h"
+
+
+#if CFG_COROUTINE_EN > 0
+
+/**
+ *******************************************************************************
+ * @brief      Create a coroutine runner
+ * @param[in]  runner   Runner to initialize.
+ * @param[out] None
+ * @retval     E_CREATE_FAIL  No free flag to kick the runner.
+ * @retval     E_OK           Create runner successful.
+ *
+ * @par Description
+ * @details    This function is called before the task of the runner is
+ *             created with CoRunCoroutines() and the runner as argument.
+ *******************************************************************************
+ */
+StatusType CoCreateCoroRunner(P_CORO_RUNNER runner)
+{
+    OS_FlagID kick;
+
+    kick = CoCreateFlag(TRUE,FALSE);    /* Auto reset,not ready               */
+    if(kick == E_CREATE_FAIL)
+    {
+        return E_CREATE_FAIL;
+    }
+    runner->list = NULL;
+    runner->kick = kick;
+    return E_OK;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Add a coroutine to a runner
+ * @param[in]  runner   Runner of the coroutine.
+ * @param[in]  co       Coroutine struct,it must live until the coroutine ends.
+ * @param[in]  func     Function of the coroutine.
+ * @param[in]  arg      Argument of the coroutine.
+ * @param[out] None
+ * @retval     None
+ *
+ * @par Description
+ * @details    This function is called by a task or a coroutine to start a
+ *             coroutine. It runs in the next pass of the runner.
+ *******************************************************************************
+ */
+void CoAddCoroutine(P_CORO_RUNNER runner,P_CORO co,CORO_FUNC func,void* arg)
+{
+    co->func = func;
+    co->arg  = arg;
+    co->line = 0;                       /* Start at CORO_BEGIN()              */
+    OsSchedLock();
+    co->next     = runner->list;        /* Insert at head of the runner       */
+    runner->list = co;
+    OsSchedUnlock();
+    CoSetFlag(runner->kick);
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Task of a coroutine runner
+ * @param[in]  pdata    Runner,created with CoCreateCoroRunner().
+ * @param[out] None
+ * @retval     None
+ *
+ * @par Description
+ * @details    This function runs all the coroutines of the runner,each one
+ *             until it waits,then sleeps until the first delay ends,the
+ *             runner is kicked or CFG_CORO_POLL_TICKS passed. A coroutine
+ *             that yielded makes the runner pass again at once.
+ *******************************************************************************
+ */
+void CoRunCoroutines(void* pdata)
+{
+    P_CORO_RUNNER runner;
+    P_CORO        co,next;
+    P_CORO*       link;
+    U32           now,left,sleep;
+    BOOL          yielded;
+    U8            status;
+
+    runner = (P_CORO_RUNNER)pdata;
+    for(;;)
+    {
+        yielded = FALSE;
+        sleep   = CFG_CORO_POLL_TICKS;  /* 0 waits for a kick or a delay      */
+        now     = (U32)CoGetOSTime();
+        for(co = runner->list; co != NULL; co = next)
+        {
+            next   = co->next;
+            status = co->func(co);      /* Run the coroutine until it waits   */
+            if(status == CORO_ENDED)    /* Did the coroutine end?             */
+            {                           /* Yes,remove it from the runner      */
+                OsSchedLock();
+                for(link = &runner->list; *link != co; link = &(*link)->next)
+                {
+                    ;
+                }
+                *link = co->next;
+                OsSchedUnlock();
+            }
+            else if(status == CORO_YIELDED)
+            {
+                yielded = TRUE;
+            }
+            else if(status == CORO_DELAYED)
+            {
+                left = co->wake - now;
+                if((S32)left <= 0)      /* Does the delay end already?        */
+                {
+                    yielded = TRUE;
+                }
+                else if((sleep == 0) || (left < sleep))
+                {
+                    sleep = left;       /* Sleep until the first delay ends   */
+                }
+            }
+        }
+        if(yielded == FALSE)
+        {
+            CoWaitForSingleFlag(runner->kick,sleep);
+        }
+    }
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Kick a coroutine runner
+ * @param[in]  runner   Runner to wake.
+ * @param[out] None
+ * @retval     E_INVALID_ID   Invalid flag of the runner.
+ * @retval     E_OK           Kick successful.
+ *
+ * @par Description
+ * @details    This function is called after setting a flag,posting a
+ *             semaphore or a queue a coroutine may wait for,so the runner
+ *             checks the waits at once instead of at the next poll.
+ *******************************************************************************
+ */
+StatusType CoKickCoroutines(P_CORO_RUNNER runner)
+{
+    return CoSetFlag(runner->kick);
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Kick a coroutine runner in ISR
+ * @param[in]  runner   Runner to wake.
+ * @param[out] None
+ * @retval     E_INVALID_ID   Invalid flag of the runner.
+ * @retval     E_OK           Kick successful.
+ *
+ * @par Description
+ * @details    This function is called in ISR,see CoKickCoroutines().
+ *******************************************************************************
+ */
+#if CFG_MAX_SERVICE_REQUEST > 0
+StatusType isr_KickCoroutines(P_CORO_RUNNER runner)
+{
+    return isr_SetFlag(runner->kick);
+}
+#endif
+
+#endif
@@ -0,0 +1,201 @@
+/**
+ *******************************************************************************
+ * @file       edf.c
+ * @version    V1.13
+ * @date       2026.10.14
+ * @brief      EDF scheduling implementation code of CooCox CoOS kernel.
+ * @details    A periodic task gets a job every period,the job must end
+ *             within the deadline after its release. The EDF tasks share
+ *             CFG_EDF_PRIO,whose READY list is kept in deadline order by
+ *             InsertToTCBRdyList(),and Schedule() lets an earlier deadline
+ *             preempt a later one.
+ *******************************************************************************
+ * @copy
+ *
+ * INTERNAL FILE,DON'T PUBLIC.
+ *
+ * <h2><center>&copy; COPYRIGHT 2009 CooCox </center></h2>
+ *******************************************************************************
+ */
+
+
+/*---------------------------- Include ---------------------------------------*/
+#include "coocox.h"
+
+
+#if CFG_EDF_EN > 0
+/**
+ *******************************************************************************
+ * @brief      Make a task periodic with EDF scheduling
+ * @param[in]  taskID   ID of the task.
+ * @param[in]  period   Ticks between two releases of the task.
+ * @param[in]  deadline Ticks after a release the job must end in,0 for the
+ *                      period.
+ * @param[out] None
+ * @retval     E_INVALID_ID         Invalid task ID.
+ * @retval     E_PROTECTED_TASK     Can't make the IDLE task periodic.
+ * @retval     E_INVALID_PARAMETER  Invalid period or deadline.
+ * @retval     E_OK                 The task is periodic.
+ *
+ * @par Description
+ * @details    This function is called to release the first job of a task
+ *             now and move the task to CFG_EDF_PRIO. The task ends each job
+ *             with CoWaitNextPeriod().
+ *******************************************************************************
+ */
+StatusType CoSetTaskEdf(OS_TID taskID,U32 period,U32 deadline)
+{
+    P_OSTCB ptcb;
+    
+    if(taskID == 0)                     /* Is idle task?                      */
+    {
+        return E_PROTECTED_TASK;        /* Yes,error return                   */
+    }
+#if CFG_PAR_CHECKOUT_EN >0              /* Check validity of parameter        */
+    if(taskID >= CFG_MAX_USER_TASKS + SYS_TASK_NUM)
+    {
+        return E_INVALID_ID;
+    }
+    if(TCBTbl[taskID].state == TASK_DORMANT)
+    {
+        return E_INVALID_ID;
+    }
+#endif
+    if(deadline == 0)
+    {
+        deadline = period;
+    }
+    if((period == 0) || (period == INVALID_VALUE) || (deadline > period))
+    {
+        return E_INVALID_PARAMETER;
+    }
+    
+    ptcb = &TCBTbl[taskID];
+    OsSchedLock();
+    ptcb->edfPeriod      = period;
+    ptcb->edfRelDeadline = deadline;
+    ptcb->edfJobs        = 0;
+    ptcb->edfMisses      = 0;
+    ptcb->edfRelease     = OSTickCnt;   /* Release the first job now          */
+    ptcb->edfDeadline    = ptcb->edfRelease + deadline;
+    if(ptcb->prio != CFG_EDF_PRIO)
+    {
+        CoSetPriority(taskID,CFG_EDF_PRIO); /* Sorted in by the new deadline  */
+    }
+    else if(ptcb->state == TASK_READY)  /* Reorder task in READY list         */
+    {
+        RemoveFromTCBRdyList(ptcb);
+        InsertToTCBRdyList(ptcb);
+    }
+    else if(ptcb->state == TASK_RUNNING)
+    {
+        TaskSchedReq = TRUE;            /* Compare with the READY tasks       */
+    }
+    OsSchedUnlock();
+    return E_OK;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      End the job of the current task
+ * @param[in]  None
+ * @param[out] None
+ * @retval     E_CALL         Error call in ISR.
+ * @retval     E_OS_IN_LOCK   The scheduler is locked.
+ * @retval     E_INVALID_ID   The current task is not periodic.
+ * @retval     E_OK           The next job has been released.
+ *
+ * @par Description
+ * @details    This function is called by an EDF task when its job is done.
+ *             A job that ends after its deadline counts as a miss. The task
+ *             waits for the release of the next job,if that has passed
+ *             already it goes on at once. Releases that passed during a
+ *             whole period are skipped and count as misses too,so the
+ *             task keeps its phase.
+ *******************************************************************************
+ */
+StatusType CoWaitNextPeriod(void)
+{
+    P_OSTCB ptcb;
+    U64     now;
+    U32     late;
+    
+    if(OSIntNesting > 0)                /* If the caller is ISR               */
+    {
+        return E_CALL;
+    }
+    if(OSSchedLock != 0)                /* Is OS lock?                        */
+    {
+        return E_OS_IN_LOCK;
+    }
+    ptcb = TCBRunning;
+    if(ptcb->edfPeriod == 0)            /* Is it an EDF task?                 */
+    {
+        return E_INVALID_ID;
+    }
+    
+    OsSchedLock();
+    now = OSTickCnt;
+    ptcb->edfJobs++;
+    if(now > ptcb->edfDeadline)         /* Did the job miss its deadline?     */
+    {
+        ptcb->edfMisses++;
+    }
+    ptcb->edfRelease += ptcb->edfPeriod;/* Release of the next job            */
+    if(now >= ptcb->edfRelease + ptcb->edfPeriod)
+    {                                   /* Skip the releases of whole periods */
+        late = (U32)((now - ptcb->edfRelease) / ptcb->edfPeriod);
+        ptcb->edfRelease += (U64)late * ptcb->edfPeriod;
+        ptcb->edfMisses  += late;
+    }
+    ptcb->edfDeadline = ptcb->edfRelease + ptcb->edfRelDeadline;
+    if(ptcb->edfRelease > now)          /* Wait for the release               */
+    {
+        InsertDelayList(ptcb,(U32)(ptcb->edfRelease - now));
+    }
+    OsSchedUnlock();                /* Unlock schedule,and call task schedule */
+    return E_OK;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Get the job statistics of an EDF task
+ * @param[in]  taskID   ID of the task.
+ * @param[out] jobs     Jobs finished,or NULL.
+ * @param[out] misses   Jobs that missed their deadline or were skipped,or
+ *                      NULL.
+ * @retval     E_INVALID_ID   Invalid task ID,or the task is not periodic.
+ * @retval     E_OK           The statistics have been read.
+ *******************************************************************************
+ */
+StatusType CoGetEdfStats(OS_TID taskID,U32* jobs,U32* misses)
+{
+    P_OSTCB ptcb;
+    
+#if CFG_PAR_CHECKOUT_EN >0              /* Check validity of parameter        */
+    if(taskID >= CFG_MAX_USER_TASKS + SYS_TASK_NUM)
+    {
+        return E_INVALID_ID;
+    }
+#endif
+    ptcb = &TCBTbl[taskID];
+    if(ptcb->edfPeriod == 0)
+    {
+        return E_INVALID_ID;
+    }
+    OsSchedLock();
+    if(jobs != NULL)
+    {
+        *jobs = ptcb->edfJobs;
+    }
+    if(misses != NULL)
+    {
+        *misses = ptcb->edfMisses;
+    }
+    OsSchedUnlock();
+    return E_OK;
+}
+
+#endif
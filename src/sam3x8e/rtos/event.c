@@ -21,9 +21,102 @@
 /*---------------------------- Variable Define -------------------------------*/
 #if CFG_EVENT_EN > 0
 
-ECB    EventTbl[CFG_MAX_EVENT]= {{0}};/*!< Table which save event control block.*/
+/*!< Event control blocks of the static semaphores and queues.               */
+#define OS_STATIC_SEM_ECB(name,initCnt,maxCnt,sortType)                        \
+    [name] = { NULL,name,EVENT_TYPE_SEM,sortType,0,initCnt,maxCnt,NULL },
+#define OS_STATIC_QUEUE_ECB(name,size,sortType)                                \
+    [name] = { &QueueTbl[OS_QCB_##name],name,EVENT_TYPE_QUEUE,sortType,0,0,0,NULL },
+
+ECB    EventTbl[CFG_MAX_EVENT]= {    /*!< Table which save event control block.*/
+    CFG_STATIC_SEMS(OS_STATIC_SEM_ECB)
+    CFG_STATIC_QUEUES(OS_STATIC_QUEUE_ECB)
+};
 P_ECB  FreeEventList = NULL;        /*!< Pointer to free event control block. */
 
+#if CFG_EVENT_PRIO_MAP_EN >0
+#if CFG_EVENT_SORT == 3
+#define IS_PRIO_SORT(pecb)  ((pecb)->eventSortType == EVENT_SORT_TYPE_PRIO)
+#else
+#define IS_PRIO_SORT(pecb)  (1)
+#endif
+
+/**
+ *******************************************************************************
+ * @brief      Get the last task waiting with a PRI higher than or equal to prio
+ * @param[in]  pecb    Pointer to event control block.
+ * @param[in]  prio    PRI of the task that will be inserted.
+ * @param[out] None
+ * @retval     The TCB or NULL if no task waits with such a PRI.
+ *
+ * @par Description
+ * @details    Bit (31-(prio&31)) of word (prio>>5) is set when a task waits
+ *             with prio,bit (31-word) of the group when the word isn't 0.
+ *             The lowest bit set at or above the bit of prio is the closest
+ *             PRI,so the place to insert is found with CTZ instead of walking
+ *             the list.
+ *******************************************************************************
+ */
+static P_OSTCB GetWaitPrioTail(P_ECB pecb,U8 prio)
+{
+    U32 word;
+    U32 bits;
+
+    word = prio >> 5;
+    bits = pecb->waitPrioMap[word] & (0xFFFFFFFFU << (31 - (prio&31)));
+    if(bits == 0)                       /* No PRI in the word of prio?        */
+    {
+        if(word == 0)
+        {
+            return NULL;
+        }
+        /* Yes,get the closest word of higher PRI in use                      */
+        bits = pecb->waitPrioGroup & (0xFFFFFFFFU << (32 - word));
+        if(bits == 0)
+        {
+            return NULL;
+        }
+        word = 31 - __builtin_ctz(bits);
+        bits = pecb->waitPrioMap[word];
+    }
+    return pecb->waitPrioTail[(word<<5) + 31 - __builtin_ctz(bits)];
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Remove a task from the PRI map of an event
+ * @param[in]  pecb    Pointer to event control block.
+ * @param[in]  ptcb    Task that leaves the waiting list,still linked in it.
+ * @param[out] None
+ * @retval     None
+ *
+ * @par Description
+ * @details    This function is called before a task is unlinked from a PRI
+ *             sorted waiting list.
+ *******************************************************************************
+ */
+static void RemoveWaitPrio(P_ECB pecb,P_OSTCB ptcb)
+{
+    U8 prio = ptcb->waitPrio;
+
+    if(pecb->waitPrioTail[prio] != ptcb)/* Is the last task of the PRI?       */
+    {
+        return;                         /* No,the map is unchanged            */
+    }
+    if((ptcb->waitPrev != NULL) && (ptcb->waitPrev->waitPrio == prio))
+    {
+        pecb->waitPrioTail[prio] = ptcb->waitPrev;
+        return;
+    }
+    pecb->waitPrioTail[prio] = NULL;    /* No more task waits with the PRI    */
+    pecb->waitPrioMap[prio>>5] &= ~(0x80000000U >> (prio&31));
+    if(pecb->waitPrioMap[prio>>5] == 0)
+    {
+        pecb->waitPrioGroup &= ~(0x80000000U >> (prio>>5));
+    }
+}
+#endif
+
 
 /**
  *******************************************************************************
@@ -34,40 +127,24 @@ P_ECB  FreeEventList = NULL;        /*!< Pointer to free event control block. */
  *
  * @par Description
  * @details    This function is called by OSInit() API to create a ECB list,supply
- *             a  pointer to next event control block that not used.	 				
+ *             a  pointer to next event control block that not used. The
+ *             static events of the table are in use already and left out.
  *******************************************************************************
  */
 void CreateEventList(void)
 {	
     U8  i;
-    P_ECB pecb1;
-#if CFG_MAX_EVENT > 1
-    P_ECB pecb2;
-#endif
-    i=0;
-    pecb1 = &EventTbl[0];               /* Get first item                     */
-#if CFG_MAX_EVENT == 1                  /* Build event list for only one item */									   
-    pecb1->eventPtr  = NULL;
-    pecb1->id        = i;               /* Assign ID.                         */
-    pecb1->eventType = EVENT_TYPE_INVALID;  /* Sign that not to use.          */
-#endif
+    P_ECB pecb;
     
-#if CFG_MAX_EVENT > 1             /* Build event list for more than one item  */								   
-    pecb2 = &EventTbl[1];
-    for(;i< (CFG_MAX_EVENT-1);i++ )
+    FreeEventList = NULL;
+    for(i = CFG_MAX_EVENT; i > OS_STATIC_EVENTS; i--)  /* Link from the end    */
     {
-        pecb1->eventPtr  = (void*)pecb2;      /* Set link for list            */
-        pecb1->id        = i;                 /* Assign ID.                   */
-        pecb1->eventType = EVENT_TYPE_INVALID;/* Sign that not to use.        */
-        pecb1++;                              /* Get next item                */
-        pecb2++;	
+        pecb            = &EventTbl[i-1];
+        pecb->eventPtr  = FreeEventList;      /* Set link for list            */
+        pecb->id        = i-1;                /* Assign ID.                   */
+        pecb->eventType = EVENT_TYPE_INVALID; /* Sign that not to use.        */
+        FreeEventList   = pecb;               /* Set free event item          */
     }
-	pecb1->eventType = EVENT_TYPE_INVALID;    /* Sign that not to use.        */
-    pecb1->eventPtr  = NULL;                  /* Set link for last item       */
-    pecb1->id        = i;	
-#endif
-    
-    FreeEventList    = &EventTbl[0];          /* Set free event item          */	
 }
 
 
@@ -117,6 +194,9 @@ static void ReleaseECB(P_ECB pecb)
 P_ECB CreatEvent(U8 eventType,U8 eventSortType,void* eventPtr)
 {
     P_ECB pecb;
+#if CFG_EVENT_PRIO_MAP_EN >0
+    U8    i;
+#endif
     
     OsSchedLock();                      /* Lock schedule                      */
     if(FreeEventList == NULL)           /* Is there no free evnet item        */
@@ -132,6 +212,13 @@ P_ECB CreatEvent(U8 eventType,U8 eventSortType,void* eventPtr)
     pecb->eventSortType = eventSortType;
     pecb->eventPtr      = eventPtr;
     pecb->eventTCBList  = NULL;
+#if CFG_EVENT_PRIO_MAP_EN >0
+    pecb->waitPrioGroup = 0;            /* No task waits with any PRI         */
+    for(i = 0; i < EVENT_PRIO_WORDS; i++)
+    {
+        pecb->waitPrioMap[i] = 0;
+    }
+#endif
     return pecb;                        /* Return event item pointer          */
 }
 
@@ -182,6 +269,10 @@ StatusType DeleteEvent(P_ECB pecb,U8 opt)
 
             /* Set next item as event waiting list head */
             pecb->eventTCBList = ptcb->waitNext; 
+            if(ptcb->waitNext != NULL)
+            {
+                ptcb->waitNext->waitPrev = NULL;
+            }
             ptcb->waitNext     = NULL;  /* Clear link for event waiting list  */
             ptcb->eventID      = INVALID_ID;  /* Sign that not to use.        */
 
@@ -247,7 +338,33 @@ void EventTaskToWait(P_ECB pecb,P_OSTCB ptcb)
 #if CFG_EVENT_SORT ==3 /* Does event waiting list sort as preemptive priority?*/                           
     else if(pecb->eventSortType == EVENT_SORT_TYPE_PRIO)
 #endif  
-#if (CFG_EVENT_SORT == 2) || (CFG_EVENT_SORT == 3)
+#if CFG_EVENT_PRIO_MAP_EN >0
+    {
+        /* Insert after the last task of the closest PRI higher or equal      */
+        ptcb1 = GetWaitPrioTail(pecb,ptcb->prio);
+        if(ptcb1 == NULL)               /* Is there no such task?             */
+        {
+            ptcb2 = pecb->eventTCBList; /* Yes,set task as first item         */
+            pecb->eventTCBList = ptcb;
+        }
+        else
+        {
+            ptcb2 = ptcb1->waitNext;
+            ptcb1->waitNext = ptcb;     /* Set link for list                  */
+        }
+        ptcb->waitPrev = ptcb1;
+        ptcb->waitNext = ptcb2;
+        if(ptcb2 != NULL)
+        {
+            ptcb2->waitPrev = ptcb;	
+        }
+        
+        ptcb->waitPrio = ptcb->prio;    /* Mark the PRI in the map            */
+        pecb->waitPrioTail[ptcb->prio]      = ptcb;
+        pecb->waitPrioMap[ptcb->prio>>5] |= 0x80000000U >> (ptcb->prio&31);
+        pecb->waitPrioGroup |= 0x80000000U >> (ptcb->prio>>5);
+    }
+#elif (CFG_EVENT_SORT == 2) || (CFG_EVENT_SORT == 3)
     {
         if(ptcb1 == NULL)               /* Is no item in event waiting list?  */
         {
@@ -310,6 +427,12 @@ void EventTaskToRdy(P_ECB pecb)
     if(ptcb == NULL)
         return;
     
+#if CFG_EVENT_PRIO_MAP_EN >0
+    if(IS_PRIO_SORT(pecb))
+    {
+        RemoveWaitPrio(pecb,ptcb);      /* Update PRI map of the event        */
+    }
+#endif
     pecb->eventTCBList = ptcb->waitNext;/* Get first task in event waiting list*/
     if(pecb->eventTCBList != NULL)      /* Is no item in event waiting list?  */
     {
@@ -379,6 +502,12 @@ void RemoveEventWaittingList(P_OSTCB ptcb)
     P_ECB pecb;
     pecb = &EventTbl[ptcb->eventID];    /* Get event control block            */
     
+#if CFG_EVENT_PRIO_MAP_EN >0
+    if(IS_PRIO_SORT(pecb))
+    {
+        RemoveWaitPrio(pecb,ptcb);      /* Update PRI map of the event        */
+    }
+#endif
     /* Is there only one item in event waiting list?                          */
     if((ptcb->waitNext == NULL) && (ptcb->waitPrev == NULL))
     {
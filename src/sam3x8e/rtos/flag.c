@@ -22,10 +22,15 @@
 /*---------------------------- Variable Define -------------------------------*/
 #define FLAG_MAX_NUM  32                /*!< Define max flag number.          */
 FCB     FlagCrl = {0};                  /*!< Flags list struct                */
+#if CFG_MAX_FLAG_GROUP > 0
+FCB     FlagGrpTbl[CFG_MAX_FLAG_GROUP] = {{0}};/*!< Flag group table        */
+BOOL    FlagGrpReq = FALSE;             /*!< Group flags set in ISR,deferred  */
+U32     FlagGrpPend[CFG_MAX_FLAG_GROUP] = {0};/*!< Flags set in ISR per group */
+#endif
 
 
 /*---------------------------- Function Declare ------------------------------*/
-static  void FlagBlock(P_FLAG_NODE pnode,U32 flags,U8 waitType);
+static  void FlagBlock(P_FCB pfcb,P_FLAG_NODE pnode,U32 flags,U8 waitType);
 static  P_FLAG_NODE RemoveFromLink(P_FLAG_NODE pnode);
 
 /**
@@ -303,7 +308,7 @@ StatusType CoWaitForSingleFlag(OS_FlagID id,U32 timeout)
         if(timeout == 0)                /* If time-out is not configured      */
         {
             /* Block task until the required flag is set                      */
-            FlagBlock (&flagNode, (1u << id), OPT_WAIT_ONE);
+            FlagBlock (pfcb, &flagNode, (1u << id), OPT_WAIT_ONE);
             curTCB->state  = TASK_WAITING;	
 			TaskSchedReq   = TRUE;
             OsSchedUnlock();
@@ -319,7 +324,7 @@ StatusType CoWaitForSingleFlag(OS_FlagID id,U32 timeout)
         else                            /* If time-out is configured          */
         {
             /* Block task until the required flag is set or time-out occurs   */
-            FlagBlock(&flagNode,(1u<<id),OPT_WAIT_ONE);
+            FlagBlock(pfcb,&flagNode,(1u<<id),OPT_WAIT_ONE);
             InsertDelayList(curTCB,timeout);
             
             OsSchedUnlock();
@@ -408,7 +413,7 @@ U32 CoWaitForMultipleFlags(U32 flags,U8 waitType,U32 timeout,StatusType *perr)
     if(timeout == 0)                    /* If time-out is not configured      */
     {
         /* Block task until the required flag are set                         */
-        FlagBlock(&flagNode,flags,waitType);
+        FlagBlock(pfcb,&flagNode,flags,waitType);
         curTCB->state  = TASK_WAITING;	
 		TaskSchedReq   = TRUE;
 		OsSchedUnlock();
@@ -424,7 +429,7 @@ U32 CoWaitForMultipleFlags(U32 flags,U8 waitType,U32 timeout,StatusType *perr)
     else                                /* If time-out is configured          */
     {
         /* Block task until the required flag are set or time-out occurred    */
-        FlagBlock(&flagNode,flags,waitType);
+        FlagBlock(pfcb,&flagNode,flags,waitType);
         InsertDelayList(curTCB,timeout);
         
         OsSchedUnlock();
@@ -593,9 +598,482 @@ StatusType isr_SetFlag(OS_FlagID id)
 }
 #endif
 
+#if CFG_MAX_FLAG_GROUP > 0
+/**
+ *******************************************************************************
+ * @brief      Check a flag group ID
+ * @param[in]  id      Flag group ID.
+ * @param[out] None
+ * @retval     NULL    Invalid or deleted group.
+ * @retval     others  Pointer to the flags of the group.
+ *******************************************************************************
+ */
+static P_FCB GroupCheck(OS_FlagGrpID id)
+{
+#if CFG_PAR_CHECKOUT_EN >0
+    if(id >= CFG_MAX_FLAG_GROUP)
+    {
+        return NULL;
+    }
+    if(FlagGrpTbl[id].flagActive == 0)
+    {
+        return NULL;
+    }
+#endif
+    return &FlagGrpTbl[id];
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Check whether ready flags satisfy a wait
+ * @param[in]  springFlag  Required flags that are set.
+ * @param[in]  flags       Required flags.
+ * @param[in]  waitType    OPT_WAIT_ANY or OPT_WAIT_ALL.
+ * @param[out] None
+ * @retval     TRUE        The wait is satisfied.
+ * @retval     FALSE       The wait goes on.
+ *******************************************************************************
+ */
+static BOOL GroupFlagsMet(U32 springFlag,U32 flags,U8 waitType)
+{
+    if(waitType == OPT_WAIT_ANY)
+    {
+        return (springFlag != 0);
+    }
+    return (springFlag == flags);
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Make the tasks waiting for ready flags of a group ready
+ * @param[in]  pfcb    Flags of the group.
+ * @param[out] None
+ * @retval     None
+ *
+ * @par Description
+ * @details    This function is called with the scheduler locked. Only the
+ *             waiting list of the group is walked,in FIFO order. A task
+ *             that is satisfied gets its flags in its node at once and its
+ *             auto-reset flags are cleared,so the tasks after it only see
+ *             what is left. The waitMask is rebuilt from the tasks that go
+ *             on waiting.
+ *******************************************************************************
+ */
+static void GroupFlagsToRdy(P_FCB pfcb)
+{
+    P_FLAG_NODE pnode;
+    U32         springFlag;
+    U32         waitMask = 0;
+    
+    pnode = pfcb->headNode;
+    while(pnode != NULL)
+    {
+        springFlag = pnode->waitFlags & pfcb->flagRdy;
+        if(GroupFlagsMet(springFlag,pnode->waitFlags,pnode->waitType) == TRUE)
+        {
+            pnode->waitFlags = springFlag;  /* Hand the flags over to the task*/
+            pfcb->flagRdy   &= ~(springFlag & pfcb->resetOpt);
+            pnode = RemoveFromLink(pnode);
+            continue;
+        }
+        waitMask |= pnode->waitFlags;
+        pnode = pnode->nextNode;
+    }
+    pfcb->waitMask = waitMask;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Create a flag group	 
+ * @param[in]  autoReset   Flags that are reset when they wake a task or are
+ *                         accepted,one bit per flag.
+ * @param[in]  initFlags   Initial state of the flags.	 
+ * @param[out] None  
+ * @retval     E_CREATE_FAIL   Create flag group fail.
+ * @retval     others          ID of the flag group.			 
+ *
+ * @par Description
+ * @details    This function use to create a group of 32 event flags with a
+ *             waiting list of its own.	 
+ *******************************************************************************
+ */
+OS_FlagGrpID CoCreateFlagGroup(U32 autoReset,U32 initFlags)
+{
+    P_FCB pfcb;
+    U8    i;
+    OsSchedLock();
+    
+    for(i = 0; i < CFG_MAX_FLAG_GROUP; i++)
+    {
+        pfcb = &FlagGrpTbl[i];
+        if(pfcb->flagActive == 0)       /* Assign a free group                */
+        {
+            pfcb->flagActive = 0xffffffff;  /* All 32 flags are valid         */
+            pfcb->flagRdy    = initFlags;
+            pfcb->resetOpt   = autoReset;
+            pfcb->waitMask   = 0;
+            pfcb->headNode   = NULL;
+            pfcb->tailNode   = NULL;
+            OsSchedUnlock();
+            return i;                   /* Return flag group ID               */
+        }
+    }
+    OsSchedUnlock();
+    
+    return E_CREATE_FAIL;               /* There is no free flag group        */
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Delete a flag group
+ * @param[in]  id      Flag group ID. 	
+ * @param[in]  opt     Delete option. 
+ * @param[out] None          
+ * @retval     E_CALL            Error call in ISR.
+ * @retval     E_INVALID_ID      Invalid flag group ID.
+ * @retval     E_TASK_WAITTING   Tasks waitting for the group,delete fail.
+ * @retval     E_OK              Flag group deleted successful.   
+ *
+ * @par Description
+ * @details    This function is called to delete a flag group. With
+ *             OPT_DEL_ANYWAY the waiting tasks are made ready and
+ *             CoWaitForGroupFlags() returns E_INVALID_ID to them.
+ *******************************************************************************
+ */
+StatusType CoDelFlagGroup(OS_FlagGrpID id,U8 opt)
+{
+    P_FCB pfcb;
+    if(OSIntNesting > 0)                /* If be called from ISR              */
+    {
+        return E_CALL;
+    }
+    pfcb = GroupCheck(id);
+    if(pfcb == NULL)
+    {
+        return E_INVALID_ID;
+    }
+    OsSchedLock();
+    if(pfcb->headNode != NULL)          /* Any task waiting?                  */
+    {
+        if(opt == OPT_DEL_NO_PEND)      /* Delete only if no task waiting     */
+        {
+            OsSchedUnlock();
+            return E_TASK_WAITING;
+        }
+        while(pfcb->headNode != NULL)   /* Ready all tasks,without flags      */
+        {
+            pfcb->headNode->waitFlags = 0;
+            RemoveFromLink(pfcb->headNode);
+        }
+    }
+    IRQ_DISABLE_SAVE();
+    FlagGrpPend[id] = 0;                /* Drop the flags set in ISR          */
+    IRQ_ENABLE_RESTORE();
+    pfcb->flagActive = 0;
+    pfcb->flagRdy    = 0;
+    pfcb->resetOpt   = 0;
+    pfcb->waitMask   = 0;
+    OsSchedUnlock();
+    return E_OK;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Set flags of a group	   
+ * @param[in]  id      Flag group ID.
+ * @param[in]  flags   Flags to set.
+ * @param[out] None
+ * @retval     E_INVALID_ID   Invalid flag group ID.
+ * @retval     E_OK           Flags set. 	 
+ *
+ * @par Description
+ * @details    This function is called to set flags of a group. The waiting
+ *             list of the group is only walked if a waiting task may want
+ *             one of the flags,which the waitMask of the group tells with
+ *             one AND. Other groups are never touched.
+ *******************************************************************************
+ */
+StatusType CoSetGroupFlags(OS_FlagGrpID id,U32 flags)
+{
+    P_FCB pfcb;
+    
+    pfcb = GroupCheck(id);
+    if(pfcb == NULL)
+    {
+        return E_INVALID_ID;
+    }
+    OsSchedLock();
+    pfcb->flagRdy |= flags;             /* Update the ready flags             */
+    if((flags & pfcb->waitMask) != 0)   /* May a waiting task want them?      */
+    {
+        GroupFlagsToRdy(pfcb);
+    }
+    OsSchedUnlock();
+    return E_OK;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Set flags of a group in ISR 
+ * @param[in]  id      Flag group ID.
+ * @param[in]  flags   Flags to set.
+ * @param[out] None 
+ * @retval     E_INVALID_ID   Invalid flag group ID.
+ * @retval     E_OK           Flags set. 	 
+ *
+ * @par Description
+ * @details    This function is called in ISR to set flags of a group. If the
+ *             scheduler is locked the flags are collected in a word per
+ *             group and set on unlock,so it cannot fail like a full service
+ *             request queue.
+ *******************************************************************************
+ */
+StatusType isr_SetGroupFlags(OS_FlagGrpID id,U32 flags)
+{
+    if(OSSchedLock > 0)         /* If scheduler is locked,(the caller is ISR) */
+    {
+        if(GroupCheck(id) == NULL)
+        {
+            return E_INVALID_ID;
+        }
+        IRQ_DISABLE_SAVE();
+        FlagGrpPend[id] |= flags;
+        FlagGrpReq = TRUE;
+        IsrReq     = TRUE;
+        IRQ_ENABLE_RESTORE();
+        return E_OK;
+    }
+    return CoSetGroupFlags(id,flags);   /* The caller is not ISR,set them     */
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Clear flags of a group	 
+ * @param[in]   id      Flag group ID.
+ * @param[in]   flags   Flags to clear.
+ * @param[out]  None
+ * @retval      E_INVALID_ID   Invalid flag group ID. 	 
+ * @retval      E_OK           Flags cleared. 	 
+ *******************************************************************************
+ */
+StatusType CoClearGroupFlags(OS_FlagGrpID id,U32 flags)
+{
+    P_FCB pfcb;
+    
+    pfcb = GroupCheck(id);
+    if(pfcb == NULL)
+    {
+        return E_INVALID_ID;
+    }
+    OsSchedLock();
+    pfcb->flagRdy &= ~flags;            /* Clear the flags                    */
+    OsSchedUnlock();
+    return E_OK;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Get the flags of a group	 
+ * @param[in]   id      Flag group ID.
+ * @param[out]  None
+ * @retval      The ready flags of the group,0 for an invalid ID.
+ *******************************************************************************
+ */
+U32 CoGetGroupFlags(OS_FlagGrpID id)
+{
+    P_FCB pfcb;
+    
+    pfcb = GroupCheck(id);
+    if(pfcb == NULL)
+    {
+        return 0;
+    }
+    return pfcb->flagRdy;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Accept flags of a group 
+ * @param[in]  id         Flag group ID.
+ * @param[in]  flags      Flags that are required.
+ * @param[in]  waitType   OPT_WAIT_ANY or OPT_WAIT_ALL.
+ * @param[out] perr       A pointer to error code.
+ * @retval     0
+ * @retval     springFlag The required flags that are set.
+ *
+ * @par Description
+ * @details    This fucntion is called to take flags of a group without
+ *             waiting. The auto-reset ones of them are cleared.
+ *******************************************************************************
+ */
+U32 CoAcceptGroupFlags(OS_FlagGrpID id,U32 flags,U8 waitType,StatusType *perr)
+{
+    U32   springFlag;
+    P_FCB pfcb;
+    
+    pfcb = GroupCheck(id);
+    if(pfcb == NULL)
+    {
+        *perr = E_INVALID_ID;
+        return 0;
+    }
+#if CFG_PAR_CHECKOUT_EN >0	
+    if((flags == 0) || (waitType > OPT_WAIT_ANY))
+    {
+        *perr = E_INVALID_PARAMETER;
+        return 0;
+    }
+#endif
+    OsSchedLock();
+    springFlag = flags & pfcb->flagRdy;
+    if(GroupFlagsMet(springFlag,flags,waitType) == TRUE)
+    {
+        pfcb->flagRdy &= ~(springFlag & pfcb->resetOpt);  /* Clear the flags  */
+        OsSchedUnlock();
+        *perr = E_OK;
+        return springFlag;
+    }
+    OsSchedUnlock();
+    *perr = E_FLAG_NOT_READY;
+    return 0;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Wait for flags of a group 
+ * @param[in]  id         Flag group ID.
+ * @param[in]  flags      Flags that are required.
+ * @param[in]  waitType   OPT_WAIT_ANY or OPT_WAIT_ALL.
+ * @param[in]  timeout    The longest time for waitting,0 to wait forever.
+ * @param[out] perr       A pointer to error code.
+ * @retval     0
+ * @retval     springFlag The required flags that are set.
+ *
+ * @par Description
+ * @details    This function is called to pend a task for flags of a group.
+ *             The task waits in the list of the group only. The flags that
+ *             make it ready are handed over to it in its node,the auto-reset
+ *             ones are cleared before any other task sees them.
+ *******************************************************************************
+ */
+U32 CoWaitForGroupFlags(OS_FlagGrpID id,U32 flags,U8 waitType,U32 timeout,
+                        StatusType *perr)
+{
+    U32       springFlag;
+    P_FCB     pfcb;
+    FLAG_NODE flagNode;
+    P_OSTCB   curTCB;
+    
+    if(OSIntNesting > 0)                /* If the caller is ISR               */
+    {
+        *perr = E_CALL;
+        return 0;
+    }
+    if(OSSchedLock != 0)                /* Schedule is lock?                  */
+    {	
+        *perr = E_OS_IN_LOCK;							 
+        return 0;                       /* Yes,error return                   */
+    }
+    pfcb = GroupCheck(id);
+    if(pfcb == NULL)
+    {
+        *perr = E_INVALID_ID;
+        return 0;
+    }
+#if CFG_PAR_CHECKOUT_EN >0	
+    if((flags == 0) || (waitType > OPT_WAIT_ANY))
+    {
+        *perr = E_INVALID_PARAMETER;
+        return 0;
+    }
+#endif
+    OsSchedLock();
+    springFlag = flags & pfcb->flagRdy;
+    if(GroupFlagsMet(springFlag,flags,waitType) == TRUE)
+    {
+        pfcb->flagRdy &= ~(springFlag & pfcb->resetOpt);  /* Clear the flags  */
+        OsSchedUnlock();
+        *perr = E_OK;
+        return springFlag;
+    }
+    
+    /* Block task until the required flags are set or time-out occurred       */
+    curTCB = TCBRunning;
+    FlagBlock(pfcb,&flagNode,flags,waitType);
+    if(timeout == 0)                    /* If time-out is not configured      */
+    {
+        curTCB->state = TASK_WAITING;	
+        TaskSchedReq  = TRUE;
+    }
+    else
+    {
+        InsertDelayList(curTCB,timeout);
+    }
+    OsSchedUnlock();
+    
+    if(curTCB->pnode == NULL)           /* If time-out occurred               */
+    {
+        *perr = E_TIMEOUT;
+        return 0;
+    }
+    curTCB->pnode = NULL;
+    if(flagNode.waitFlags == 0)         /* The group has been deleted         */
+    {
+        *perr = E_INVALID_ID;
+        return 0;
+    }
+    *perr = E_OK;
+    return flagNode.waitFlags;          /* The flags handed over              */
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Dispose the group flags set in ISR
+ * @param[in]  None
+ * @param[out] None
+ * @retval     None
+ *
+ * @par Description
+ * @details    This function is called from RespondSRQ() to set the flags
+ *             collected by isr_SetGroupFlags() while the scheduler was locked.
+ *******************************************************************************
+ */
+void FlagGrpDispose(void)
+{
+    U32 pend;
+    U8  i;
+    
+    FlagGrpReq = FALSE;
+    for(i = 0; i < CFG_MAX_FLAG_GROUP; i++)
+    {
+        IRQ_DISABLE_SAVE();
+        pend = FlagGrpPend[i];
+        FlagGrpPend[i] = 0;
+        IRQ_ENABLE_RESTORE();
+        if(pend != 0)
+        {
+            CoSetGroupFlags(i,pend);
+        }
+    }
+}
+#endif
+
+
 /**
  *******************************************************************************
  * @brief      Block a task to wait a flag event  
+ * @param[in]  pfcb        Flags of the waiting list,FlagCrl or a group.
  * @param[in]  pnode       A node that will link into flag waiting list.
  * @param[in]  flags       Flag(s) that the node waiting for.
  * @param[in]  waitType    Waiting type of the node.
@@ -607,15 +1085,14 @@ StatusType isr_SetFlag(OS_FlagID id)
  * @note 
  *******************************************************************************
  */
-static void FlagBlock(P_FLAG_NODE pnode,U32 flags,U8 waitType)
+static void FlagBlock(P_FCB pfcb,P_FLAG_NODE pnode,U32 flags,U8 waitType)
 {
-    P_FCB     pfcb;
-    pfcb  = &FlagCrl;
-    
     TCBRunning->pnode = pnode;	
     pnode->waitTask   = TCBRunning;
+    pnode->pfcb       = pfcb;
     pnode->waitFlags  = flags;      /* Save the flags that we need to wait for*/
     pnode->waitType   = waitType;   /* Save the type of wait                  */
+    pfcb->waitMask   |= flags;
         
     if(pfcb->tailNode == NULL)      /* If this is the first NODE to insert?   */
     {
@@ -679,26 +1156,32 @@ static P_FLAG_NODE RemoveFromLink(P_FLAG_NODE pnode)
  * @retval     None		
  *
  * @par Description
- * @details    This function is called to remove a flag node from the wait list.			 
+ * @details    This function is called to remove a flag node from the wait list.
+ *             The waitMask of the list is only cleared with the last node,
+ *             otherwise it may keep the flags of the node until the next
+ *             CoSetGroupFlags() walks the list.
  * @note 
  *******************************************************************************
  */
 void RemoveLinkNode(P_FLAG_NODE pnode)
 {
+    P_FCB pfcb = pnode->pfcb;
+    
     /* If only one NODE in the list*/
     if((pnode->nextNode == NULL) && (pnode->prevNode == NULL)) 
     {
-        FlagCrl.headNode = NULL;
-        FlagCrl.tailNode = NULL;
+        pfcb->headNode = NULL;
+        pfcb->tailNode = NULL;
+        pfcb->waitMask = 0;               /* Nobody waits any more            */
     }
     else if(pnode->nextNode == NULL)      /* If the NODE is tail              */
     {
-        FlagCrl.tailNode          = pnode->prevNode;
+        pfcb->tailNode            = pnode->prevNode;
         pnode->prevNode->nextNode = NULL;
     }
     else if(pnode->prevNode == NULL)      /* If the NODE is head              */
     {
-        FlagCrl.headNode          = pnode->nextNode;
+        pfcb->headNode            = pnode->nextNode;
         pnode->nextNode->prevNode = NULL;	
     }
     else                                  /* The NODE is in the middle        */
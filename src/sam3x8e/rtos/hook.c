@@ -35,6 +35,11 @@ void CoIdleTask(void* pdata)
     for(; ;) 
     {
         /* Add your codes here */
+#if CFG_IDLE_SLEEP_EN >0
+        IdleSleep();
+#elif CFG_TICKLESS_EN >0
+        TicklessIdle();
+#endif
     }
 }
 
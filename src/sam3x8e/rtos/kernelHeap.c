@@ -21,6 +21,402 @@
 #if CFG_KHEAP_EN >0
 /*---------------------------- Variable Define -------------------------------*/
 U32     KernelHeap[KHEAP_SIZE] = {0};   /*!< Kernel heap                      */
+
+#if OS_KHEAP_SLABS >0
+/*!< Blocks of the slab caches,and their table in CFG_KHEAP_SLABS order.      */
+#define OS_KHEAP_SLAB_BUF(size,num)                                            \
+    static U32 KslabBuf_##size[(((size)+3)>>2)*(num)];
+#define OS_KHEAP_SLAB_ENTRY(size,num)                                          \
+    {KslabBuf_##size,(((size)+3)>>2)<<2,num,0},
+
+CFG_KHEAP_SLABS(OS_KHEAP_SLAB_BUF)
+KSlab   KslabTbl[OS_KHEAP_SLABS] = { CFG_KHEAP_SLABS(OS_KHEAP_SLAB_ENTRY) };
+
+
+/**
+ *******************************************************************************
+ * @brief      Create the slab caches	 
+ * @param[in]  None
+ * @param[out] None
+ * @retval     None			 
+ *
+ * @par Description
+ * @details    This function is called by CoCreateKheap() to make each slab a
+ *             memory partition. A slab whose partition can't be created
+ *             stays unused.
+ *******************************************************************************
+ */
+static void KslabCreate(void)
+{
+    P_KSlab slab;
+    U32     i;
+    for(i = 0; i < OS_KHEAP_SLABS; i++)
+    {
+        slab       = &KslabTbl[i];
+        slab->mmID = CoCreateMemPartition((U8*)slab->buf,slab->blockSize,
+                                          slab->blockNum);
+    }
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Allocation a block of a slab cache	 
+ * @param[in]  size     Length of menory block.
+ * @param[out] None
+ * @retval     NULL     No slab of that size has a free block.
+ * @retval     others   Pointer to memory block.			 
+ *
+ * @par Description
+ * @details    The slabs are in increasing block size,the first one that fits
+ *             and has a free block is taken. The block is popped from the
+ *             partition without locking the scheduler.
+ *******************************************************************************
+ */
+static void* KslabMalloc(U32 size)
+{
+    P_KSlab slab;
+    void*   mem;
+    U32     i;
+    for(i = 0; i < OS_KHEAP_SLABS; i++)
+    {
+        slab = &KslabTbl[i];
+        if((size <= slab->blockSize) && (slab->mmID != (OS_MMID)E_CREATE_FAIL))
+        {
+            mem = CoGetMemoryBuffer(slab->mmID);
+            if(mem != NULL)
+            {
+                return mem;
+            }
+        }
+    }
+    return NULL;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Release a block to its slab cache	 
+ * @param[in]  memBuf   Pointer to memory block.
+ * @param[out] None
+ * @retval     TRUE     The block was of a slab and has been released.
+ * @retval     FALSE    The block is not of a slab.			 
+ *******************************************************************************
+ */
+static BOOL KslabFree(void* memBuf)
+{
+    P_KSlab slab;
+    U32     i;
+    for(i = 0; i < OS_KHEAP_SLABS; i++)
+    {
+        slab = &KslabTbl[i];
+        if(((U32)memBuf >= (U32)slab->buf) &&
+           ((U32)memBuf < (U32)slab->buf + slab->blockSize*slab->blockNum))
+        {
+            if(slab->mmID != (OS_MMID)E_CREATE_FAIL)
+            {
+                CoFreeMemoryBuffer(slab->mmID,memBuf);
+            }
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+#endif
+#if CFG_KHEAP_TLSF_EN >0
+KHeap   Kheap   = {0};                  /*!< Kernel heap control              */
+U32     TlsfFLMap = 0;                  /*!< First level classes in use       */
+U32     TlsfSLMap[TLSF_FL_COUNT];       /*!< Second level classes in use      */
+P_TLSFB TlsfList[TLSF_FL_COUNT][TLSF_SL_COUNT]; /*!< Free blocks per class    */
+
+
+/**
+ *******************************************************************************
+ * @brief      Get the class of a block size	 
+ * @param[in]  size     Block size in bytes.
+ * @param[out] fl       First level class.
+ * @param[out] sl       Second level class.
+ * @retval     None			 
+ *******************************************************************************
+ */
+static void TlsfMapping(U32 size,U32 *fl,U32 *sl)
+{
+    U32 log2;
+    if(size < TLSF_SMALL)               /* Is a small block?                  */
+    {
+        *fl = 0;                        /* Yes,classes of 4 bytes             */
+        *sl = size >> 2;
+    }
+    else
+    {
+        log2 = 31 - __builtin_clz(size);
+        *sl  = (size >> (log2 - TLSF_SL_LOG2)) ^ TLSF_SL_COUNT;
+        *fl  = log2 - (TLSF_SL_LOG2 + 1);
+    }
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Insert a free block into the list of its class	 
+ * @param[in]  blk      Free block.
+ * @param[out] None
+ * @retval     None			 
+ *******************************************************************************
+ */
+static void TlsfInsert(P_TLSFB blk)
+{
+    U32 fl,sl;
+    TlsfMapping(blk->size & ~TLSF_FREE,&fl,&sl);
+    blk->preFree  = NULL;               /* Insert at head of the class list   */
+    blk->nextFree = TlsfList[fl][sl];
+    if(blk->nextFree != NULL)
+    {
+        blk->nextFree->preFree = blk;
+    }
+    TlsfList[fl][sl] = blk;
+    TlsfFLMap       |= 1u << fl;
+    TlsfSLMap[fl]   |= 1u << sl;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Remove a free block from the list of its class	 
+ * @param[in]  blk      Free block.
+ * @param[out] None
+ * @retval     None			 
+ *******************************************************************************
+ */
+static void TlsfRemove(P_TLSFB blk)
+{
+    U32 fl,sl;
+    TlsfMapping(blk->size & ~TLSF_FREE,&fl,&sl);
+    if(blk->preFree == NULL)            /* Is the first item of the list?     */
+    {
+        TlsfList[fl][sl] = blk->nextFree;
+        if(blk->nextFree == NULL)       /* Yes,is the class empty now?        */
+        {
+            TlsfSLMap[fl] &= ~(1u << sl);
+            if(TlsfSLMap[fl] == 0)
+            {
+                TlsfFLMap &= ~(1u << fl);
+            }
+        }
+    }
+    else
+    {
+        blk->preFree->nextFree = blk->nextFree;
+    }
+    if(blk->nextFree != NULL)
+    {
+        blk->nextFree->preFree = blk->preFree;
+    }
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Create kernel heap	 
+ * @param[in]  None
+ * @param[out] None
+ * @retval     None			 
+ *
+ * @par Description
+ * @details    This function is called to create kernel heap. The heap holds
+ *             one free block and a used block of size 0 that marks its end.
+ *******************************************************************************
+ */
+void CoCreateKheap(void)
+{
+    P_TLSFB blk,end;
+    U32 fl,sl;
+    
+    Kheap.startAddr  = (U32)(KernelHeap); /* Initialize kernel heap control   */
+    Kheap.endAddr    = (U32)(KernelHeap) + KHEAP_SIZE*4;
+    TlsfFLMap        = 0;
+    for(fl = 0; fl < TLSF_FL_COUNT; fl++)
+    {
+        TlsfSLMap[fl] = 0;
+        for(sl = 0; sl < TLSF_SL_COUNT; sl++)
+        {
+            TlsfList[fl][sl] = NULL;
+        }
+    }
+    
+    blk          = (P_TLSFB)KernelHeap;
+    blk->prePhys = NULL;
+    blk->size    = (KHEAP_SIZE*4 - 2*TLSF_HEAD) | TLSF_FREE;
+    end          = (P_TLSFB)(Kheap.endAddr - TLSF_HEAD);
+    end->prePhys = blk;
+    end->size    = 0;
+    TlsfInsert(blk);
+#if OS_KHEAP_SLABS >0
+    KslabCreate();
+#endif
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Allocation size bytes of memory block from kernel heap.
+ * @param[in]  size     Length of menory block.	
+ * @param[out] None
+ * @retval     NULL     Allocate fail.
+ * @retval     others   Pointer to memory block.		 
+ *
+ * @par Description
+ * @details    This function is called to allocation size bytes of memory block.
+ *             The size is rounded up to the next class,so the first block of
+ *             any non empty class from there fits.
+ *******************************************************************************
+ */
+void* CoKmalloc(U32 size)
+{
+    P_TLSFB blk,rest;
+    U32 search,fl,sl,map,blkSize;
+#if OS_KHEAP_SLABS >0
+    void* memAddr;
+#endif
+    
+#if CFG_PAR_CHECKOUT_EN >0              /* Check validity of parameter        */
+    if( size == 0 )
+    {
+        return NULL;
+    }
+#endif
+#if OS_KHEAP_SLABS >0
+    memAddr = KslabMalloc(size);        /* Small request,try the slabs first  */
+    if(memAddr != NULL)
+    {
+        return memAddr;
+    }
+#endif
+    if(size > KHEAP_SIZE*4)             /* Is it larger than the heap?        */
+    {
+        return NULL;
+    }
+
+    size   = ((size+3)>>2)<<2;          /* Word alignment                     */
+    if(size < TLSF_MIN)
+    {
+        size = TLSF_MIN;
+    }
+    search = size;
+    if(search >= TLSF_SMALL)            /* Round up to the next class         */
+    {
+        search += (1u << (31 - __builtin_clz(search) - TLSF_SL_LOG2)) - 1;
+    }
+    TlsfMapping(search,&fl,&sl);
+    if(fl >= TLSF_FL_COUNT)
+    {
+        return NULL;
+    }
+    
+    OsSchedLock();                      /* Lock schedule                      */
+    map = TlsfSLMap[fl] & (~0u << sl);  /* Is a class of this level free?     */
+    if(map == 0)
+    {                                   /* No,take the next level in use      */
+        map = TlsfFLMap & (~0u << (fl + 1));
+        if(map == 0)
+        {
+            OsSchedUnlock();            /* Unlock schedule                    */
+            return NULL;                /* Error return                       */
+        }
+        fl  = __builtin_ctz(map);
+        map = TlsfSLMap[fl];
+    }
+    sl  = __builtin_ctz(map);
+    blk = TlsfList[fl][sl];
+    TlsfRemove(blk);
+    
+    blkSize = blk->size & ~TLSF_FREE;
+    if(blkSize - size >= TLSF_HEAD + TLSF_MIN)  /* Is the rest large enough?  */
+    {                                   /* Yes,split it off as a free block   */
+        rest          = (P_TLSFB)((U32)blk + TLSF_HEAD + size);
+        rest->prePhys = blk;
+        rest->size    = (blkSize - size - TLSF_HEAD) | TLSF_FREE;
+        ((P_TLSFB)((U32)blk + TLSF_HEAD + blkSize))->prePhys = rest;
+        TlsfInsert(rest);
+        blkSize       = size;
+    }
+    blk->size = blkSize;                /* Mark block as used                 */
+    OsSchedUnlock();                    /* Unlock schedule                    */
+    return (void*)((U32)blk + TLSF_HEAD);
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Release memory block to kernel heap.  
+ * @param[in]  memBuf    Pointer to memory block.
+ * @param[out] None
+ * @retval     None  		 
+ *
+ * @par Description
+ * @details    This function is called to release memory block. It is merged
+ *             with the free blocks just before and after it.
+ *******************************************************************************
+ */
+void CoKfree(void* memBuf)
+{
+    P_TLSFB blk,next;
+
+#if CFG_PAR_CHECKOUT_EN >0              /* Check validity of parameter        */
+    if(memBuf == NULL)
+    {
+        return;
+    }
+#endif
+#if OS_KHEAP_SLABS >0
+    if(KslabFree(memBuf) == TRUE)       /* Is it a block of a slab?           */
+    {
+        return;
+    }
+#endif
+#if CFG_PAR_CHECKOUT_EN >0              /* Check validity of parameter        */
+    if(((U32)(memBuf) < Kheap.startAddr + TLSF_HEAD) ||
+       ((U32)(memBuf) >= Kheap.endAddr) || (((U32)(memBuf) & 0x3) != 0))
+    {
+        return;
+    }
+#endif
+    blk = (P_TLSFB)((U32)(memBuf) - TLSF_HEAD);
+    
+    OsSchedLock();                      /* Lock schedule                      */
+    next = (P_TLSFB)((U32)blk + TLSF_HEAD + (blk->size & ~TLSF_FREE));
+#if CFG_PAR_CHECKOUT_EN >0              /* Check it is a used block           */
+    if(((blk->size & TLSF_FREE) != 0) || ((U32)next >= Kheap.endAddr) ||
+       (next->prePhys != blk))
+    {
+        OsSchedUnlock();
+        return;
+    }
+#endif
+    
+    if((next->size & TLSF_FREE) != 0)   /* Is the next block free?            */
+    {                                   /* Yes,merge it                       */
+        TlsfRemove(next);
+        blk->size += TLSF_HEAD + (next->size & ~TLSF_FREE);
+        next = (P_TLSFB)((U32)blk + TLSF_HEAD + blk->size);
+        next->prePhys = blk;
+    }
+    if((blk->prePhys != NULL) && ((blk->prePhys->size & TLSF_FREE) != 0))
+    {                                   /* Is the previous block free?        */
+        TlsfRemove(blk->prePhys);       /* Yes,merge into it                  */
+        blk->prePhys->size += TLSF_HEAD + blk->size;
+        blk = blk->prePhys;
+        next->prePhys = blk;
+    }
+    else
+    {
+        blk->size |= TLSF_FREE;
+    }
+    TlsfInsert(blk);
+    OsSchedUnlock();                    /* Unlock schedule                    */
+}
+
+#else
 P_FMB   FMBlist = NULL;                 /*!< Free memory block list           */
 KHeap   Kheap   = {0};                  /*!< Kernel heap control              */
 
@@ -46,6 +442,9 @@ void CoCreateKheap(void)
     FMBlist->nextFMB = NULL;	
     FMBlist->nextUMB = NULL;
     FMBlist->preUMB  = NULL;
+#if OS_KHEAP_SLABS >0
+    KslabCreate();
+#endif
 }
 
 
@@ -75,6 +474,13 @@ void* CoKmalloc(U32 size)
         return NULL;
     }
 #endif
+#if OS_KHEAP_SLABS >0
+    memAddr = KslabMalloc(size);        /* Small request,try the slabs first  */
+    if(memAddr != NULL)
+    {
+        return memAddr;
+    }
+#endif
 
     /* Word alignment,and add used memory head size */
     size      = (((size+3)>>2)<<2) + 8;
@@ -190,6 +596,12 @@ void CoKfree(void* memBuf)
         return;
     }
 #endif
+#if OS_KHEAP_SLABS >0
+    if(KslabFree(memBuf) == TRUE)       /* Is it a block of a slab?           */
+    {
+        return;
+    }
+#endif
     
     usedMB = (P_UMB)((U32)(memBuf)-8);
     
@@ -407,3 +819,4 @@ static P_FMB GetPreFMB(P_UMB usedMB)
 }
 
 #endif
+#endif
@@ -16,6 +16,7 @@
 
 /*---------------------------- Include ---------------------------------------*/
 #include "coocox.h"
+#include "../bitband.h"
 
 
 #if  CFG_MM_EN > 0
@@ -115,15 +116,14 @@ StatusType CoDelMemoryPartition(OS_MMID mmID)
         return E_INVALID_ID;
     }
 #endif	
-    OsSchedLock();                      /* Lock schedule                      */
     memCtl = &MemoryTbl[mmID];          /* Release memory control block       */
-    MemoryIDVessel &= ~(1u<<mmID);
-    OsSchedUnlock();                    /* Unlock schedule                    */
-    
     memCtl->memAddr   = NULL;
     memCtl->freeBlock = NULL;	
     memCtl->blockSize = 0;
     memCtl->blockNum  = 0;	
+    
+    /* One store frees the ID, no lock: a creation sees it free or taken  */
+    bitband_clear(&MemoryIDVessel, mmID);
     return E_OK;                        /* Return OK                          */
 }
 
@@ -160,7 +160,7 @@ U32 CoGetFreeBlockNum(OS_MMID mmID,StatusType* perr)
     }
 #endif	
     memCtl = &MemoryTbl[mmID];
-    OsSchedLock();                      /* Lock schedule                      */
+    IRQ_DISABLE_SAVE();                 /* ISRs get and free buffers too      */
     memBlk = (P_MemBlk)(memCtl->freeBlock);/* Get the free item in memory list*/
     fbNum  = 0;
     while(memBlk != NULL)               /* Get counter of free item           */
@@ -168,7 +168,7 @@ U32 CoGetFreeBlockNum(OS_MMID mmID,StatusType* perr)
         fbNum++;
         memBlk = memBlk->nextBlock;     /* Get next free iterm                */
     }
-    OsSchedUnlock();                    /* Unlock schedul                     */
+    IRQ_ENABLE_RESTORE();
     *perr = E_OK;							   
     return fbNum;                       /* Return the counter of free item    */
 }
@@ -184,6 +184,7 @@ U32 CoGetFreeBlockNum(OS_MMID mmID,StatusType* perr)
  *		 
  * @par Description
  * @details    This function is called to Delete a memory partition.
+ * @note       It doesn't lock the scheduler and may be called from an ISR.
  *******************************************************************************
  */
 void* CoGetMemoryBuffer(OS_MMID mmID)
@@ -201,15 +202,9 @@ void* CoGetMemoryBuffer(OS_MMID mmID)
     }
 #endif
     memCtl = &MemoryTbl[mmID];	
-    OsSchedLock();                      /* Lock schedule                      */	        
-    if(memCtl->freeBlock == NULL )    /* Is there no free item in memory list */
-    {
-        OsSchedUnlock();                /* Unlock schedule                    */
-        return NULL;                    /* Yes,error return                   */
-    }
-    memBlk = (P_MemBlk)memCtl->freeBlock;       /* Get free memory block      */
-    memCtl->freeBlock = (U8*)memBlk->nextBlock; /* Reset the first free item  */
-    OsSchedUnlock();                    /* Unlock schedule                    */
+    
+    /* Pop the first free item,NULL if there is none                          */
+    memBlk = (P_MemBlk)PopNode((void* volatile *)&memCtl->freeBlock);
     return memBlk;                      /* Return free memory block address   */
 }
 
@@ -227,12 +222,12 @@ void* CoGetMemoryBuffer(OS_MMID mmID)
  *
  * @par Description
  * @details    This function is called to Delete a memory partition.
+ * @note       It doesn't lock the scheduler and may be called from an ISR.
  *******************************************************************************
  */
 StatusType CoFreeMemoryBuffer(OS_MMID mmID,void* buf)
 {
     P_MM      memCtl;
-    P_MemBlk  memBlk;
 #if CFG_PAR_CHECKOUT_EN >0              /* Check validity of parameter        */
     if(mmID >= CFG_MAX_MM)
     {
@@ -263,11 +258,7 @@ StatusType CoFreeMemoryBuffer(OS_MMID mmID,void* buf)
         return E_INVALID_PARAMETER;	
     }
 #endif
-    memBlk = (P_MemBlk)buf;             /* Reset the first free item          */
-    OsSchedLock();
-    memBlk->nextBlock = (P_MemBlk)memCtl->freeBlock;
-    memCtl->freeBlock = buf;
-    OsSchedUnlock();
+    PushNode((void* volatile *)&memCtl->freeBlock,buf);/* Reset the first free item*/
     return E_OK;                        /* Return OK                          */
 }
 
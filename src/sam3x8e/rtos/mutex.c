@@ -57,6 +57,9 @@ OS_MutexID CoCreateMutex(void)
         pMutex->mutexFlag    = MUTEX_FREE;  /* Mutex is free,not was occupied */
         pMutex->taskID       = INVALID_ID;
         pMutex->waittingList = NULL;
+#if CFG_MUTEX_CEILING_EN >0
+        pMutex->ceiling      = MUTEX_NO_CEILING;
+#endif
         return id;                      /* Return mutex ID                    */			
     }	
     
@@ -65,6 +68,47 @@ OS_MutexID CoCreateMutex(void)
 }
 
 
+#if CFG_MUTEX_CEILING_EN >0
+/**
+ *******************************************************************************
+ * @brief      Create a priority ceiling mutex	 
+ * @param[in]  ceiling    Priority of the owner,at least the highest priority
+ *                        of the tasks that enter the mutex.
+ * @param[out] None  
+ * @retval     E_CREATE_FAIL  Create mutex fail.
+ * @retval     others         Create mutex successful.		 
+ *
+ * @par Description					  
+ * @details    This function is called to create a mutex with the immediate
+ *             priority ceiling protocol. CoEnterMutexSection() raises the
+ *             owner to the ceiling while it is running,so no task that
+ *             enters the mutex can preempt it. The owner is not promoted on
+ *             contention,the ready list is not reordered and there is no
+ *             chain of promotions to undo. CoLeaveMutexSection() drops the
+ *             owner back to its own priority.
+ * @note  		
+ *******************************************************************************
+ */
+OS_MutexID CoCreateCeilingMutex(U8 ceiling)
+{
+    OS_MutexID id;
+    
+#if CFG_PAR_CHECKOUT_EN >0
+    if(ceiling > CFG_LOWEST_PRIO)
+    {
+        return E_CREATE_FAIL;
+    }
+#endif
+    id = CoCreateMutex();
+    if(id != (OS_MutexID)E_CREATE_FAIL)
+    {
+        MutexTbl[id].ceiling = ceiling; /* Not used by any task yet           */
+    }
+    return id;
+}
+#endif
+
+
 
 /**	
  *******************************************************************************		 	
@@ -77,6 +121,10 @@ OS_MutexID CoCreateMutex(void)
  *
  * @par Description
  * @details    This function is called when entering a critical area.	 
+ *             With CFG_MUTEX_FAST_EN a free mutex is claimed with one
+ *             LDREXB/STREXB of its owner,without locking the scheduler. The
+ *             other fields are filled in after,a task that preempts in
+ *             between sees the mutex occupied and takes the slow path.
  * @note 
  *******************************************************************************
  */
@@ -84,6 +132,9 @@ StatusType CoEnterMutexSection(OS_MutexID mutexID)
 {
     P_OSTCB ptcb,pCurTcb;
     P_MUTEX pMutex;
+#if CFG_MUTEX_FAST_EN >0
+    U8      prio;
+#endif
 
 #if CFG_EVENT_EN >0
     P_ECB pecb;
@@ -103,24 +154,59 @@ StatusType CoEnterMutexSection(OS_MutexID mutexID)
     {
         return E_INVALID_ID;	
     }
+#if CFG_MUTEX_CEILING_EN >0
+    if(MUTEX_HAS_CEILING(&MutexTbl[mutexID]) &&
+       (TCBRunning->prio < MutexTbl[mutexID].ceiling))
+    {
+        return E_INVALID_PARAMETER;     /* Task is above the ceiling          */
+    }
+#endif
 #endif
 
-    OsSchedLock();
+    TRACE(TRACE_MUTEX_ENTER,mutexID);
     pCurTcb = TCBRunning;
     pMutex  = &MutexTbl[mutexID];
+#if CFG_MUTEX_FAST_EN >0
+    pCurTcb->mutexID = mutexID;
+    prio = pCurTcb->prio;               /* Priority before anyone promotes it */
+    
+    /* A ceiling mutex raises its owner with the scheduler locked             */
+    if(!MUTEX_HAS_CEILING(pMutex) &&
+       (CasByte(&pMutex->taskID,INVALID_ID,pCurTcb->taskID) == TRUE))
+    {
+        pMutex->originalPrio = prio;    /* Save priority of owning task       */
+        
+        /* Keep the waiter set by a task that preempted after the claim       */
+        CasByte(&pMutex->hipriTaskID,INVALID_ID,pCurTcb->taskID);
+        pMutex->mutexFlag    = MUTEX_OCCUPY;
+        return E_OK;
+    }
+#endif
+    OsSchedLock();
     
     pCurTcb->mutexID = mutexID;
-    if(pMutex->mutexFlag == MUTEX_FREE)       /* If mutex is available        */	 
+    if(pMutex->taskID == INVALID_ID)          /* If mutex is available        */	 
     {
         pMutex->originalPrio = pCurTcb->prio; /* Save priority of owning task */   
         pMutex->taskID       = pCurTcb->taskID;   /* Acquire the resource     */
         pMutex->hipriTaskID  = pCurTcb->taskID;
         pMutex->mutexFlag    = MUTEX_OCCUPY;      /* Occupy the mutex resource*/
+#if CFG_MUTEX_CEILING_EN >0
+        if(pCurTcb->prio > pMutex->ceiling)   /* Raise owner to the ceiling   */
+        {
+#if CFG_ORDER_LIST_SCHEDULE_EN ==0
+			DeleteTaskPri(pCurTcb->prio);
+			ActiveTaskPri(pMutex->ceiling);
+#endif	
+            pCurTcb->prio = pMutex->ceiling;  /* Running,not in READY list    */
+        }
+#endif
     }
-    /* If the mutex resource had been occupied                                */
-    else if(pMutex->mutexFlag == MUTEX_OCCUPY)	 	
+    else              /* If the mutex resource had been occupied              */
     {	
 		ptcb = &TCBTbl[pMutex->taskID];
+        
+        /* The owner of a ceiling mutex is already above all its waiters      */
         if(ptcb->prio > pCurTcb->prio)  /* Need to promote priority of owner? */
         {
 #if CFG_ORDER_LIST_SCHEDULE_EN ==0
@@ -192,6 +278,8 @@ StatusType CoEnterMutexSection(OS_MutexID mutexID)
  *
  * @par Description		 
  * @details    This function must be called when exiting from a critical area.	
+ *             A mutex nobody waits for is freed with interrupts disabled for
+ *             a few instructions,without locking the scheduler.
  * @note 
  *******************************************************************************
  */
@@ -213,20 +301,50 @@ StatusType CoLeaveMutexSection(OS_MutexID mutexID)
         return E_INVALID_ID;            /* Invalid mutex id, return error     */
     }
 #endif	
-    OsSchedLock();
+    TRACE(TRACE_MUTEX_LEAVE,mutexID);
     pMutex = &MutexTbl[mutexID];        /* Obtain point of mutex control block*/   
+#if CFG_MUTEX_FAST_EN >0
+    IRQ_DISABLE_SAVE();
+    
+    /* If the mutex waiting list is empty and no ceiling to drop              */
+    if((pMutex->waittingList == NULL) && !MUTEX_HAS_CEILING(pMutex))
+    {
+        TCBTbl[pMutex->taskID].mutexID = INVALID_ID;
+        pMutex->mutexFlag   = MUTEX_FREE;   /* The mutex resource is available*/
+        pMutex->hipriTaskID = INVALID_ID;
+        pMutex->taskID      = INVALID_ID;   /* Last,it frees the mutex        */
+        IRQ_ENABLE_RESTORE();
+        return E_OK;
+    }
+    IRQ_ENABLE_RESTORE();
+#endif
+    OsSchedLock();
     ptcb = &TCBTbl[pMutex->taskID];
 	ptcb->mutexID = INVALID_ID;
 	if(pMutex->waittingList == NULL)    /* If the mutex waiting list is empty */
     {
-        pMutex->mutexFlag = MUTEX_FREE; /* The mutex resource is available    */
-        pMutex->taskID    = INVALID_ID;
+        pMutex->mutexFlag   = MUTEX_FREE;   /* The mutex resource is available*/
+        pMutex->hipriTaskID = INVALID_ID;
+        pMutex->taskID      = INVALID_ID;
+#if CFG_MUTEX_CEILING_EN >0
+        if(MUTEX_HAS_CEILING(pMutex))   /* Drop the owner from the ceiling    */
+        {
+            CoSetPriority(ptcb->taskID,pMutex->originalPrio);
+        }
+#endif
         OsSchedUnlock();
     }	
     else              /* If there is at least one task waitting for the mutex */
     { 
         taskID = pMutex->taskID;        /* Get task ID of mutex owner         */
         
+#if CFG_MUTEX_CEILING_EN >0
+        if(MUTEX_HAS_CEILING(pMutex))   /* Next owner runs at the ceiling     */
+        {
+            prio = pMutex->ceiling;
+        }
+        else
+#endif
                                 /* we havn't promoted current task's priority */
         if(pMutex->hipriTaskID == taskID)   
         {
@@ -256,6 +374,12 @@ StatusType CoLeaveMutexSection(OS_MutexID mutexID)
         pMutex->waittingList = ptcb->TCBnext;	
         pMutex->originalPrio = ptcb->prio;
         pMutex->taskID       = ptcb->taskID;
+#if CFG_MUTEX_CEILING_EN >0
+        if(MUTEX_HAS_CEILING(pMutex))   /* No waiter has promoted the owner   */
+        {
+            pMutex->hipriTaskID = ptcb->taskID;
+        }
+#endif
 
 #if CFG_ORDER_LIST_SCHEDULE_EN ==0
 		if(prio != ptcb->prio)
@@ -0,0 +1,310 @@
+/**
+ *******************************************************************************
+ * @file       notify.c
+ * @version    V1.13
+ * @date       2026.10.14
+ * @brief      task notification implementation code of CooCox CoOS kernel.
+ *******************************************************************************
+ * @copy
+ *
+ * INTERNAL FILE,DON'T PUBLIC.
+ *
+ * <h2><center>&copy; COPYRIGHT 2009 CooCox </center></h2>
+ *******************************************************************************
+ */
+
+
+/*---------------------------- Include ---------------------------------------*/
+#include "coocox.h"
+
+
+#if CFG_TASK_NOTIFY_EN > 0
+/*---------------------------- Variable Define -------------------------------*/
+BOOL  NotifyReq = FALSE;                /*!< Deferred notification request    */
+U32   NotifyPend[(CFG_MAX_USER_TASKS+SYS_TASK_NUM+31)/32] = {0};/*!< Task IDs */
+
+
+/**
+ *******************************************************************************
+ * @brief      Make a task waiting for a notification ready
+ * @param[in]  ptcb     Task that has been notified.
+ * @param[out] None
+ * @retval     None
+ *
+ * @par Description
+ * @details    This function is called with the scheduler locked. The task is
+ *             only made ready if it still waits for the notification,its
+ *             timeout may have made it ready already.
+ *******************************************************************************
+ */
+static void NotifyTaskToRdy(P_OSTCB ptcb)
+{
+    if((ptcb->notifyState != NOTIFY_PENDING) || (ptcb->state != TASK_WAITING))
+    {
+        return;
+    }
+    if(ptcb->delayTick != INVALID_VALUE)/* Is task in delay list?             */
+    {
+        RemoveDelayList(ptcb);          /* Yes,remove task from DELAY list    */
+    }
+    if(ptcb == TCBRunning)              /* Woken before it switched out       */
+    {
+        ptcb->state = TASK_RUNNING;
+    }
+    else
+    {
+        InsertToTCBRdyList(ptcb);       /* Insert task into ready list        */
+    }
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Update the notification value of a task
+ * @param[in]  ptcb     Task to notify.
+ * @param[in]  value    Bits to set,or the new value.
+ * @param[in]  action   NOTIFY_SET_BITS,NOTIFY_INCREMENT or NOTIFY_OVERWRITE.
+ * @param[out] None
+ * @retval     TRUE     The task waits for the notification.
+ * @retval     FALSE    The task does not wait.
+ *
+ * @par Description
+ * @details    This function is called by a task or an ISR. Interrupts are
+ *             disabled for the few instructions that change the value.
+ *******************************************************************************
+ */
+static BOOL NotifyUpdate(P_OSTCB ptcb,U32 value,U8 action)
+{
+    U8 old;
+    IRQ_DISABLE_SAVE();
+    if(action == NOTIFY_SET_BITS)
+    {
+        ptcb->notifyValue |= value;
+    }
+    else if(action == NOTIFY_INCREMENT)
+    {
+        ptcb->notifyValue++;
+    }
+    else
+    {
+        ptcb->notifyValue = value;
+    }
+    old = ptcb->notifyState;
+    ptcb->notifyState = NOTIFY_PENDING;
+    IRQ_ENABLE_RESTORE();
+    return (old == NOTIFY_WAITING);
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Check a notification
+ * @param[in]  taskID   ID of task to notify.
+ * @param[in]  action   Notify action.
+ * @param[out] None
+ * @retval     NULL     Invalid task ID or action.
+ * @retval     others   Pointer to the TCB of the task.
+ *******************************************************************************
+ */
+static P_OSTCB NotifyCheck(OS_TID taskID,U8 action)
+{
+#if CFG_PAR_CHECKOUT_EN >0              /* Check validity of parameter        */
+    if(taskID >= CFG_MAX_USER_TASKS + SYS_TASK_NUM)
+    {
+        return NULL;
+    }
+    if(TCBTbl[taskID].state == TASK_DORMANT)
+    {
+        return NULL;
+    }
+    if(action > NOTIFY_OVERWRITE)
+    {
+        return NULL;
+    }
+#endif
+    return &TCBTbl[taskID];
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Notify a task
+ * @param[in]  taskID   ID of task to notify.
+ * @param[in]  value    Bits to set,or the new value.
+ * @param[in]  action   NOTIFY_SET_BITS,NOTIFY_INCREMENT or NOTIFY_OVERWRITE.
+ * @param[out] None
+ * @retval     E_INVALID_ID         Invalid task ID.
+ * @retval     E_OK                 Task notified.
+ *
+ * @par Description
+ * @details    This function is called to update the notification value of a
+ *             task and wake it if it waits in CoWaitNotify(). NOTIFY_INCREMENT
+ *             ignores the value.
+ *******************************************************************************
+ */
+StatusType CoNotifyTask(OS_TID taskID,U32 value,U8 action)
+{
+    P_OSTCB ptcb;
+
+    ptcb = NotifyCheck(taskID,action);
+    if(ptcb == NULL)
+    {
+        return E_INVALID_ID;
+    }
+    if(NotifyUpdate(ptcb,value,action) == TRUE)
+    {
+        OsSchedLock();
+        NotifyTaskToRdy(ptcb);
+        OsSchedUnlock();                /* Call task schedule                 */
+    }
+    return E_OK;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Notify a task in ISR
+ * @param[in]  taskID   ID of task to notify.
+ * @param[in]  value    Bits to set,or the new value.
+ * @param[in]  action   NOTIFY_SET_BITS,NOTIFY_INCREMENT or NOTIFY_OVERWRITE.
+ * @param[out] None
+ * @retval     E_INVALID_ID         Invalid task ID.
+ * @retval     E_OK                 Task notified.
+ *
+ * @par Description
+ * @details    This function is called in ISR to notify a task. If the
+ *             scheduler is locked the wakeup is left to the unlock,in a bit
+ *             per task,so it cannot fail like a full service request queue.
+ *******************************************************************************
+ */
+StatusType isr_NotifyTask(OS_TID taskID,U32 value,U8 action)
+{
+    P_OSTCB ptcb;
+
+    ptcb = NotifyCheck(taskID,action);
+    if(ptcb == NULL)
+    {
+        return E_INVALID_ID;
+    }
+    if(NotifyUpdate(ptcb,value,action) == TRUE)
+    {
+        if(OSSchedLock > 0)     /* If scheduler is locked,(the caller is ISR) */
+        {
+            IRQ_DISABLE_SAVE();
+            NotifyPend[taskID >> 5] |= (1u << (taskID & 31));
+            NotifyReq = TRUE;
+            IsrReq    = TRUE;
+            IRQ_ENABLE_RESTORE();
+        }
+        else
+        {
+            OsSchedLock();
+            NotifyTaskToRdy(ptcb);
+            OsSchedUnlock();
+        }
+    }
+    return E_OK;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Wait for a notification
+ * @param[in]  timeout  The longest time for waitting,0 to wait forever.
+ * @param[out] perr     A pointer to error code.
+ * @retval     The notification value,which is cleared.
+ *
+ * @par Description
+ * @details    This function is called to wait until the current task is
+ *             notified. It returns at once if a notification came before.
+ *             With NOTIFY_INCREMENT the value is the number of
+ *             notifications,with NOTIFY_SET_BITS the bits set.
+ *******************************************************************************
+ */
+U32 CoWaitNotify(U32 timeout,StatusType* perr)
+{
+    P_OSTCB curTCB;
+    U32     value;
+    if(OSIntNesting > 0)                /* If the caller is ISR               */
+    {
+        *perr = E_CALL;
+        return 0;
+    }
+    if(OSSchedLock != 0)                /* Judge schedule is locked or not?   */
+    {
+        *perr = E_OS_IN_LOCK;
+        return 0;
+    }
+    curTCB = TCBRunning;
+    OsSchedLock();
+    IRQ_DISABLE_SAVE();
+    if(curTCB->notifyState != NOTIFY_PENDING)
+    {
+        /* Block current task until notified or timeout occurs                */
+        curTCB->notifyState = NOTIFY_WAITING;
+        IRQ_ENABLE_RESTORE();
+        if(timeout == 0)
+        {
+            curTCB->state = TASK_WAITING;
+            TaskSchedReq  = TRUE;
+        }
+        else
+        {
+            InsertDelayList(curTCB,timeout);
+        }
+        OsSchedUnlock();                /* Switch out until woken             */
+        OsSchedLock();
+        IRQ_DISABLE_SAVE();
+    }
+    if(curTCB->notifyState == NOTIFY_PENDING)
+    {
+        value  = curTCB->notifyValue;
+        *perr  = E_OK;
+    }
+    else                                /* If time-out occurred               */
+    {
+        value  = 0;
+        *perr  = E_TIMEOUT;
+    }
+    curTCB->notifyValue = 0;
+    curTCB->notifyState = NOTIFY_NONE;
+    IRQ_ENABLE_RESTORE();
+    OsSchedUnlock();
+    return value;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Dispose the notifications deferred in ISR
+ * @param[in]  None
+ * @param[out] None
+ * @retval     None
+ *
+ * @par Description
+ * @details    This function is called from RespondSRQ() to wake the tasks
+ *             notified while the scheduler was locked.
+ *******************************************************************************
+ */
+void NotifyDispose(void)
+{
+    U32 i,pend;
+    U8  bit;
+
+    NotifyReq = FALSE;
+    for(i = 0; i < (CFG_MAX_USER_TASKS+SYS_TASK_NUM+31)/32; i++)
+    {
+        IRQ_DISABLE_SAVE();
+        pend = NotifyPend[i];
+        NotifyPend[i] = 0;
+        IRQ_ENABLE_RESTORE();
+        while(pend != 0)
+        {
+            bit   = (U8)__builtin_ctz(pend);
+            pend &= pend - 1;
+            NotifyTaskToRdy(&TCBTbl[(i << 5) + bit]);
+        }
+    }
+}
+
+#endif
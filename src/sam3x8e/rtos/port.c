@@ -15,8 +15,11 @@
 
 /*---------------------------- Include ---------------------------------------*/
 #include "coocox.h"
+#include "../ramfunc.h"
 
 
+#if PERIPH_HOST == 0                        // port_host.c on a host
+
 //******************************************************************************
 //                              EQUATES
 //******************************************************************************	
@@ -29,11 +32,16 @@ U32 INT_EXIT       = 0xFFFFFFFC;
 //******************************************************************************
 extern U8     Inc8(volatile U8 *data) ;
 extern U8     Dec8(volatile U8 *data) ; 
+extern void*  PopNode(void* volatile *head);
+extern void   PushNode(void* volatile *head,void *node);
+extern BOOL   CasWord(volatile U32 *data,U32 old,U32 value);
+extern BOOL   CasByte(volatile U8 *data,U8 old,U8 value);
+extern U32    SwapWord(volatile U32 *data,U32 value);
 extern void   IRQ_ENABLE_RESTORE(void);
 extern void   IRQ_DISABLE_SAVE(void);
 extern void   SetEnvironment(OS_STK *pstk) __attribute__ ((naked)); 	
 extern void   SwitchContext(void)          __attribute__ ((naked));
-extern void   PendSV_Handler(void)         __attribute__ ((naked));
+extern void   PendSV_Handler(void)         __attribute__ ((naked)) RAMFUNC_HOT;
 
 
 /**
@@ -45,29 +53,32 @@ extern void   PendSV_Handler(void)         __attribute__ ((naked));
  *
  * @par Description
  * @details    This function is called to Plus a byte integers 
- *             and Saved into memory cell.
+ *             and Saved into memory cell. It uses LDREXB/STREXB like
+ *             PopNode(),so no interrupt is masked.
  ******************************************************************************
  */
 U8 Inc8 (volatile U8 *data)
 {
-  register U8  result = 0;
-  
-  __asm volatile 
-  (
-      " PUSH    {R1}     \n"
-      " CPSID   I        \n"
-      " LDRB    R1,[%1]  \n"
-      " ADD     R1,#1    \n"
-      " STRB    R1,[%1]  \n"
-      " CPSIE   I        \n"
-      " SUB     R1,#0x1  \n"
-      " MOVS    %0,R1    \n"
-      " POP     {R1}     \n"
-      :"=r"(result)
-      :"r"(data)
-  );
-  return (result);
-  
+  register U32 result;
+  register U32 fail;
+  do
+  {
+    __asm volatile 
+    (
+        " LDREXB  %0,[%1]  \n"
+        :"=r"(result)
+        :"r"(data)
+        :"memory"
+    );
+    __asm volatile 
+    (
+        " STREXB  %0,%2,[%1] \n"
+        :"=&r"(fail)
+        :"r"(data),"r"(result + 1)
+        :"memory"
+    );
+  }while(fail != 0);                /* Retried if an exception came between   */
+  return (U8)result;
 }
  
 
@@ -76,30 +87,244 @@ U8 Inc8 (volatile U8 *data)
  * @brief      Decrease a byte integers and Saved into memory cell
  * @param[in]  data    byte integers.	 
  * @param[out] None  
- * @retval     Returns Original value.		 
+ * @retval     Returns the new value.		 
  *
  * @par Description
  * @details    This function is called to Decrease a byte integers 
- *             and Saved into memory cell.
+ *             and Saved into memory cell,see Inc8().
  ******************************************************************************
  */
 U8 Dec8 (volatile U8 *data)
 {
-  register U8  result = 0;
+  register U32 result;
+  register U32 fail;
+  do
+  {
+    __asm volatile 
+    (
+        " LDREXB  %0,[%1]  \n"
+        :"=r"(result)
+        :"r"(data)
+        :"memory"
+    );
+    result = (U8)(result - 1);
+    __asm volatile 
+    (
+        " STREXB  %0,%2,[%1] \n"
+        :"=&r"(fail)
+        :"r"(data),"r"(result)
+        :"memory"
+    );
+  }while(fail != 0);                /* Retried if an exception came between   */
+  return (U8)result;
+}
+
+
+/**
+ ******************************************************************************
+ * @brief      Pop the first node of a singly linked list
+ * @param[in]  head    Head of the list,the first word of a node points to
+ *                     the next node.	 
+ * @param[out] None  
+ * @retval     Returns the node,NULL if the list is empty.		 
+ *
+ * @par Description
+ * @details    This function is called to pop a node without locking,from
+ *             tasks and ISRs alike. The head is read and written back with
+ *             LDREX/STREX; an exception in between clears the exclusive
+ *             monitor and the STREX fails,so the pop is retried with the new
+ *             head. No other context can run in between on a single core,
+ *             which rules out ABA without a tag.
+ ******************************************************************************
+ */
+void* PopNode(void* volatile *head)
+{
+  register void* node;
+  register U32   fail;
+  do
+  {
+    __asm volatile 
+    (
+        " LDREX   %0,[%1]  \n"
+        :"=r"(node)
+        :"r"(head)
+        :"memory"
+    );
+    if(node == NULL)
+    {
+      __asm volatile (" CLREX            \n" ::: "memory");
+      return NULL;
+    }
+    __asm volatile 
+    (
+        " STREX   %0,%2,[%1] \n"
+        :"=&r"(fail)
+        :"r"(head),"r"(*(void**)node)
+        :"memory"
+    );
+  }while(fail != 0);
+  return node;
+}
+
+
+/**
+ ******************************************************************************
+ * @brief      Push a node at the head of a singly linked list
+ * @param[in]  head    Head of the list.	 
+ * @param[in]  node    Node,its first word gets the next node.	 
+ * @param[out] None  
+ * @retval     None		 
+ *
+ * @par Description
+ * @details    This function is called to push a node without locking,from
+ *             tasks and ISRs alike,see PopNode().
+ ******************************************************************************
+ */
+void PushNode(void* volatile *head,void *node)
+{
+  register void* first;
+  register U32   fail;
+  do
+  {
+    __asm volatile 
+    (
+        " LDREX   %0,[%1]  \n"
+        :"=r"(first)
+        :"r"(head)
+        :"memory"
+    );
+    *(void**)node = first;
+    __asm volatile 
+    (
+        " STREX   %0,%2,[%1] \n"
+        :"=&r"(fail)
+        :"r"(head),"r"(node)
+        :"memory"
+    );
+  }while(fail != 0);
+}
+
+
+/**
+ ******************************************************************************
+ * @brief      Compare and swap a word
+ * @param[in]  data    The word.	 
+ * @param[in]  old     Value the word must have.	 
+ * @param[in]  value   New value.	 
+ * @param[out] None  
+ * @retval     TRUE    The word had the old value and has been replaced.		 
+ * @retval     FALSE   The word had another value,or the STREX failed.		 
+ *
+ * @par Description
+ * @details    This function is called to change a word without locking,
+ *             from tasks and ISRs alike,see PopNode(). The caller reads the
+ *             word again and retries when it returns FALSE.
+ ******************************************************************************
+ */
+BOOL CasWord(volatile U32 *data,U32 old,U32 value)
+{
+  register U32 cur;
+  register U32 fail;
   __asm volatile 
   (
-      " PUSH    {R1}     \n"
-      " CPSID   I        \n"
-      " LDRB    R1,[%1]  \n"
-      " SUB     R1,#1    \n"
-      " STRB    R1,[%1]  \n"
-      " CPSIE   I        \n"
-      " MOVS    %0,R1    \n"
-      " POP     {R1}     \n"
-      :"=r"(result)
+      " LDREX   %0,[%1]  \n"
+      :"=r"(cur)
       :"r"(data)
-  ); 
-  return (result); 
+      :"memory"
+  );
+  if(cur != old)
+  {
+    __asm volatile (" CLREX            \n" ::: "memory");
+    return FALSE;
+  }
+  __asm volatile 
+  (
+      " STREX   %0,%2,[%1] \n"
+      :"=&r"(fail)
+      :"r"(data),"r"(value)
+      :"memory"
+  );
+  return (fail == 0);
+}
+
+
+/**
+ ******************************************************************************
+ * @brief      Compare and swap a byte
+ * @param[in]  data    The byte.	 
+ * @param[in]  old     Value the byte must have.	 
+ * @param[in]  value   New value.	 
+ * @param[out] None  
+ * @retval     TRUE    The byte had the old value and has been replaced.		 
+ * @retval     FALSE   The byte had another value,or the STREXB failed.		 
+ *
+ * @par Description
+ * @details    This function is called to change a byte without locking,see
+ *             CasWord().
+ ******************************************************************************
+ */
+BOOL CasByte(volatile U8 *data,U8 old,U8 value)
+{
+  register U32 cur;
+  register U32 fail;
+  __asm volatile 
+  (
+      " LDREXB  %0,[%1]  \n"
+      :"=r"(cur)
+      :"r"(data)
+      :"memory"
+  );
+  if(cur != old)
+  {
+    __asm volatile (" CLREX            \n" ::: "memory");
+    return FALSE;
+  }
+  __asm volatile 
+  (
+      " STREXB  %0,%2,[%1] \n"
+      :"=&r"(fail)
+      :"r"(data),"r"((U32)value)
+      :"memory"
+  );
+  return (fail == 0);
+}
+
+
+/**
+ ******************************************************************************
+ * @brief      Swap a word
+ * @param[in]  data    The word.	 
+ * @param[in]  value   New value.	 
+ * @param[out] None  
+ * @retval     Returns the old value.		 
+ *
+ * @par Description
+ * @details    This function is called to take and replace a word without
+ *             locking,see PopNode().
+ ******************************************************************************
+ */
+U32 SwapWord(volatile U32 *data,U32 value)
+{
+  register U32 old;
+  register U32 fail;
+  do
+  {
+    __asm volatile 
+    (
+        " LDREX   %0,[%1]  \n"
+        :"=r"(old)
+        :"r"(data)
+        :"memory"
+    );
+    __asm volatile 
+    (
+        " STREX   %0,%2,[%1] \n"
+        :"=&r"(fail)
+        :"r"(data),"r"(value)
+        :"memory"
+    );
+  }while(fail != 0);
+  return old;
 }
 
 /**
@@ -110,15 +335,27 @@ U8 Dec8 (volatile U8 *data)
  * @retval     None		 
  *
  * @par Description
- * @details    This function is called to ENABLE Interrupt.
+ * @details    This function is called to ENABLE Interrupt. With
+ *             CFG_MAX_SYSCALL_PRIO it clears BASEPRI instead of PRIMASK.
  ******************************************************************************
  */
 void IRQ_ENABLE_RESTORE(void)
 { 
+#if CFG_MAX_SYSCALL_PRIO > 0
+  __asm volatile 
+  (
+      " MSR     BASEPRI,%0 \n"
+      :
+      :"r"(0)
+      :"memory"
+  );
+#else
   __asm volatile 
   (
       " CPSIE   I        \n"
+      :::"memory"
   );	
+#endif
   return;
 }
 
@@ -130,15 +367,29 @@ void IRQ_ENABLE_RESTORE(void)
  * @retval     None		 
  *
  * @par Description
- * @details    This function is called to close Interrupt.
+ * @details    This function is called to close Interrupt. With
+ *             CFG_MAX_SYSCALL_PRIO only the interrupts at that NVIC priority
+ *             and below are masked with BASEPRI,the ones above keep running.
  ******************************************************************************
  */
 void IRQ_DISABLE_SAVE(void)
 {  
+#if CFG_MAX_SYSCALL_PRIO > 0
+  __asm volatile 
+  (
+      " MSR     BASEPRI,%0 \n"
+      " ISB              \n"
+      :
+      :"r"(OS_BASEPRI)
+      :"memory"
+  );
+#else
   __asm volatile 
   (
       " CPSID   I        \n"
+      :::"memory"
   );	
+#endif
   return;
 }
 
@@ -294,3 +545,4 @@ void PendSV_Handler(void)
 }
 #endif
 
+#endif
@@ -0,0 +1,220 @@
+/**
+ *******************************************************************************
+ * @file       port_host.c
+ * @version    V1.13
+ * @date       2026.10.14
+ * @brief      Host adapter for CooCox CoOS kernel.
+ * @details    This file replaces port.c when PERIPH_HOST is 1,to run the
+ *             kernel lists,the heaps and the timers on a host. There is only
+ *             one context and no exception on the host,so the atomic
+ *             operations are plain C and the interrupts are never masked.
+ *             SwitchContext() only makes TCBNext the running task,what
+ *             PendSV_Handler() does on target besides switching the stacks;
+ *             the caller keeps running on its stack.
+ *******************************************************************************
+ * @copy
+ *
+ * INTERNAL FILE,DON'T PUBLIC.
+ *
+ * <h2><center>&copy; COPYRIGHT 2010 CooCox </center></h2>
+ *******************************************************************************
+ */
+
+/*---------------------------- Include ---------------------------------------*/
+#include "coocox.h"
+
+
+#if PERIPH_HOST
+
+/**
+ ******************************************************************************
+ * @brief      Plus a byte integers and Saved into memory cell
+ * @param[in]  data    byte integers.
+ * @param[out] None
+ * @retval     Returns Original value.
+ ******************************************************************************
+ */
+U8 Inc8 (volatile U8 *data)
+{
+  return (*data)++;
+}
+
+
+/**
+ ******************************************************************************
+ * @brief      Decrease a byte integers and Saved into memory cell
+ * @param[in]  data    byte integers.
+ * @param[out] None
+ * @retval     Returns the new value.
+ ******************************************************************************
+ */
+U8 Dec8 (volatile U8 *data)
+{
+  return --(*data);
+}
+
+
+/**
+ ******************************************************************************
+ * @brief      Pop the first node of a singly linked list
+ * @param[in]  head    Head of the list.
+ * @param[out] None
+ * @retval     Returns the node,NULL if the list is empty.
+ ******************************************************************************
+ */
+void* PopNode(void* volatile *head)
+{
+  void* node;
+
+  node = *head;
+  if(node != NULL)
+  {
+    *head = *(void**)node;
+  }
+  return node;
+}
+
+
+/**
+ ******************************************************************************
+ * @brief      Push a node at the head of a singly linked list
+ * @param[in]  head    Head of the list.
+ * @param[in]  node    Node,its first word gets the next node.
+ * @param[out] None
+ * @retval     None
+ ******************************************************************************
+ */
+void PushNode(void* volatile *head,void *node)
+{
+  *(void**)node = *head;
+  *head         = node;
+}
+
+
+/**
+ ******************************************************************************
+ * @brief      Compare and swap a word
+ * @param[in]  data    The word.
+ * @param[in]  old     Value the word must have.
+ * @param[in]  value   New value.
+ * @param[out] None
+ * @retval     TRUE    The word had the old value and has been replaced.
+ * @retval     FALSE   The word had another value.
+ ******************************************************************************
+ */
+BOOL CasWord(volatile U32 *data,U32 old,U32 value)
+{
+  if(*data != old)
+  {
+    return FALSE;
+  }
+  *data = value;
+  return TRUE;
+}
+
+
+/**
+ ******************************************************************************
+ * @brief      Compare and swap a byte
+ * @param[in]  data    The byte.
+ * @param[in]  old     Value the byte must have.
+ * @param[in]  value   New value.
+ * @param[out] None
+ * @retval     TRUE    The byte had the old value and has been replaced.
+ * @retval     FALSE   The byte had another value.
+ ******************************************************************************
+ */
+BOOL CasByte(volatile U8 *data,U8 old,U8 value)
+{
+  if(*data != old)
+  {
+    return FALSE;
+  }
+  *data = value;
+  return TRUE;
+}
+
+
+/**
+ ******************************************************************************
+ * @brief      Swap a word
+ * @param[in]  data    The word.
+ * @param[in]  value   New value.
+ * @param[out] None
+ * @retval     Returns the old value.
+ ******************************************************************************
+ */
+U32 SwapWord(volatile U32 *data,U32 value)
+{
+  U32 old;
+
+  old   = *data;
+  *data = value;
+  return old;
+}
+
+
+/**
+ ******************************************************************************
+ * @brief      ENABLE Interrupt
+ * @param[in]  None
+ * @param[out] None
+ * @retval     None
+ ******************************************************************************
+ */
+void IRQ_ENABLE_RESTORE(void)
+{
+  return;
+}
+
+
+/**
+ ******************************************************************************
+ * @brief      Close Interrupt
+ * @param[in]  None
+ * @param[out] None
+ * @retval     None
+ ******************************************************************************
+ */
+void IRQ_DISABLE_SAVE(void)
+{
+  return;
+}
+
+
+/**
+ ******************************************************************************
+ * @brief      Set environment	for Coocox OS running
+ * @param[in]  pstk    stack pointer
+ * @param[out] None
+ * @retval     None.
+ *
+ * @par Description
+ * @details    There is no process stack on the host.
+ ******************************************************************************
+ */
+void SetEnvironment (OS_STK *pstk)
+{
+  (void)pstk;
+}
+
+
+/**
+ ******************************************************************************
+ * @brief      Do ready work to Switch Context for task change
+ * @param[in]  None
+ * @param[out] None
+ * @retval     None.
+ *
+ * @par Description
+ * @details    This function makes TCBNext the running task and unlocks the
+ *             scheduler,like PendSV_Handler() without the stacks.
+ ******************************************************************************
+ */
+void SwitchContext(void)
+{
+  TCBRunning  = TCBNext;
+  OSSchedLock = 0;
+}
+
+#endif
@@ -19,8 +19,50 @@
 
 #if CFG_QUEUE_EN > 0										 
 /*---------------------------- Variable Define -------------------------------*/
-QCB   QueueTbl[CFG_MAX_QUEUE] = {{0}};    /*!< Queue control block table        */
-U32   QueueIDVessel = 0;                /*!< Queue list mask                  */
+/*!< Buffers and control blocks of the static queues.                        */
+#define OS_STATIC_QUEUE_BUF(name,size,sortType)                                \
+    static void* QueueBuf_##name[size];
+#define OS_STATIC_QUEUE_QCB(name,size,sortType)                                \
+    [OS_QCB_##name] = { QueueBuf_##name,OS_QCB_##name,{0},0,0,size,0 },
+
+CFG_STATIC_QUEUES(OS_STATIC_QUEUE_BUF)
+QCB   QueueTbl[CFG_MAX_QUEUE] = {       /*!< Queue control block table        */
+    CFG_STATIC_QUEUES(OS_STATIC_QUEUE_QCB)
+};
+U32   QueueIDVessel = (U32)((1ull << OS_STATIC_QUEUES) - 1);/*!< Queue list mask*/
+
+
+/**
+ *******************************************************************************
+ * @brief      Take mails out of a queue	  
+ * @param[in]  pqcb   Pointer to queue control block.
+ * @param[in]  max    The most mails to take.
+ * @param[out] out    Buffer for the mails taken.
+ * @retval     The number of mails taken.
+ *
+ * @par Description
+ * @details    This function is called with the scheduler locked to copy the
+ *             oldest mails of a queue to a buffer.
+ *******************************************************************************
+ */
+static U16 QueueTakeMails(P_QCB pqcb,void **out,U16 max)
+{
+    U16 n;
+    U16 i;
+    
+    n = (pqcb->qSize < max) ? pqcb->qSize : max;
+    for(i = 0; i < n; i++)
+    {
+        out[i] = *(pqcb->qStart + pqcb->head);
+        pqcb->head++;                   /* Update the queue head              */
+        if(pqcb->head == pqcb->qMaxSize)
+        {
+            pqcb->head = 0;	
+        }
+    }
+    pqcb->qSize -= n;           /* Update the number of messages in the queue */
+    return n;
+}
 
 
  
@@ -169,6 +211,7 @@ void* CoAcceptQueueMail(OS_EventID id,StatusType* perr)
         return NULL;	
     }
 #endif	
+    TRACE(TRACE_QUEUE_PEND,id);
     pqcb = (P_QCB)pecb->eventPtr;       /* Point at queue control block       */
 	OsSchedLock();
     if(pqcb->qSize != 0)            /* If there are any messages in the queue */
@@ -241,6 +284,7 @@ void* CoPendQueueMail(OS_EventID id,U32 timeout,StatusType* perr)
         *perr = E_OS_IN_LOCK;           /* Schedule is locked,return error    */								 
         return NULL;          
     }	
+    TRACE(TRACE_QUEUE_PEND,id);
     pqcb = (P_QCB)pecb->eventPtr;       /* Point at queue control block       */
 	 
     if(pqcb->qSize != 0)            /* If there are any messages in the queue */
@@ -295,6 +339,108 @@ void* CoPendQueueMail(OS_EventID id,U32 timeout,StatusType* perr)
 }
 
 
+/**
+ *******************************************************************************
+ * @brief      Pend for several mails	 
+ * @param[in]  id       Event ID.	 
+ * @param[in]  max      The most mails to receive.
+ * @param[in]  timeout  The longest time for waitting the first mail.	
+ * @param[out] out      Buffer for the mails, room for max pointers.
+ * @param[out] perr     A pointer to error code.   
+ * @retval     The number of mails received.	 
+ *
+ * @par Description
+ * @details    This function is called to receive up to max mails under one
+ *             scheduler lock. If the queue is empty the task waits like in
+ *             CoPendQueueMail() for the first mail, then takes the mails
+ *             that have arrived meanwhile without waiting for more.
+ * @note       0 mails with E_OK means the queue has been deleted.
+ *******************************************************************************
+ */
+U16 CoPendQueueMailBatch(OS_EventID id,void **out,U16 max,U32 timeout,
+                         StatusType* perr)
+{
+    P_ECB   pecb;
+    P_QCB   pqcb;
+    P_OSTCB curTCB;
+    U16     n;
+    if(OSIntNesting > 0)                /* If the caller is ISR               */
+    {
+        *perr = E_CALL;
+        return 0;
+    }
+#if CFG_PAR_CHECKOUT_EN >0
+    if(id >= CFG_MAX_EVENT)	         
+    {
+        *perr = E_INVALID_ID;           /* Invalid event id,return error      */
+        return 0;
+    }
+    if((out == NULL) || (max == 0))
+    {
+        *perr = E_INVALID_PARAMETER;
+        return 0;
+    }
+#endif
+
+    pecb = &EventTbl[id];
+#if CFG_PAR_CHECKOUT_EN >0
+    if(pecb->eventType != EVENT_TYPE_QUEUE) /* The event type is not queue    */
+    {
+        *perr = E_INVALID_ID;
+        return 0;	
+    }
+#endif	
+    if(OSSchedLock != 0)                /* Judge schedule is locked or not?   */
+    {	
+        *perr = E_OS_IN_LOCK;           /* Schedule is locked,return error    */								 
+        return 0;          
+    }	
+    TRACE(TRACE_QUEUE_PEND,id);
+    pqcb = (P_QCB)pecb->eventPtr;       /* Point at queue control block       */
+	
+    OsSchedLock();
+    n = QueueTakeMails(pqcb,out,max);   /* Take the mails already queued      */
+    OsSchedUnlock();
+    if(n != 0)
+    {
+        *perr = E_OK;
+        return n;
+    }
+    
+    curTCB = TCBRunning;
+    if(timeout == 0)                    /* If time-out is not configured      */
+    {
+        /* Block current task until the event occur                           */
+        EventTaskToWait(pecb,curTCB); 
+    }
+    else                                /* If time-out is configured          */
+    {
+        OsSchedLock(); 
+        
+        /* Block current task until event or timeout occurs                   */           
+        EventTaskToWait(pecb,curTCB);       
+        InsertDelayList(curTCB,timeout);
+        OsSchedUnlock();
+    }
+    if(curTCB->pmail == NULL)     /* If time-out occurred or queue deleted    */
+    {
+        *perr = (timeout == 0) ? E_OK : E_TIMEOUT;
+        return 0;
+    }
+    out[0] = curTCB->pmail;             /* The mail that woke the task        */
+    curTCB->pmail = NULL;
+    n = 1;
+    OsSchedLock();
+    if(pecb->eventType == EVENT_TYPE_QUEUE)
+    {
+        n += QueueTakeMails(pqcb,out + 1,max - 1);  /* And the ones after it  */
+    }
+    OsSchedUnlock();
+    *perr = E_OK;
+    return n;
+}
+
+
  
 /**
  *******************************************************************************
@@ -329,6 +475,7 @@ StatusType CoPostQueueMail(OS_EventID id,void* pmail)
         return E_INVALID_ID;            /* The event type isn't queue,return  */	
     }	
 #endif
+    TRACE(TRACE_QUEUE_POST,id);
     pqcb = (P_QCB)pecb->eventPtr;	
     if(pqcb->qSize == pqcb->qMaxSize)   /* If queue is full                   */
     {
@@ -351,6 +498,78 @@ StatusType CoPostQueueMail(OS_EventID id,void* pmail)
 }
 
 
+/**
+ *******************************************************************************
+ * @brief      Post several mails to queue	   
+ * @param[in]  id      Event ID.
+ * @param[in]  msgs    Pointers to the mails that want to send.
+ * @param[in]  n       The number of mails.	 	 
+ * @param[out] None   
+ * @retval     E_OK
+ * @retval     E_INVALID_ID
+ * @retval     E_INVALID_PARAMETER
+ * @retval     E_QUEUE_FULL		 
+ *
+ * @par Description
+ * @details    This function is called to post n mails to queue under one
+ *             scheduler lock. Either all mails are posted or, if there is
+ *             not enough room, none. A waiting task gets one mail each, the
+ *             reschedule happens once at the end.
+ * @note 
+ *******************************************************************************
+ */
+StatusType CoPostQueueMailBatch(OS_EventID id,void **msgs,U16 n)
+{	
+    P_ECB pecb;
+    P_QCB pqcb;
+    U16   i;
+#if CFG_PAR_CHECKOUT_EN >0                     
+    if(id >= CFG_MAX_EVENT)	
+    {
+        return E_INVALID_ID;          
+    }
+    if(msgs == NULL)
+    {
+        return E_INVALID_PARAMETER;
+    }
+#endif
+
+    pecb = &EventTbl[id];
+#if CFG_PAR_CHECKOUT_EN >0
+    if(pecb->eventType != EVENT_TYPE_QUEUE)   
+    {
+        return E_INVALID_ID;            /* The event type isn't queue,return  */	
+    }	
+#endif
+    TRACE(TRACE_QUEUE_POST,id);
+    pqcb = (P_QCB)pecb->eventPtr;	
+    OsSchedLock();
+    if(n > (U16)(pqcb->qMaxSize - pqcb->qSize))   /* If not all mails fit     */
+    {
+        OsSchedUnlock();
+        return E_QUEUE_FULL;
+    }
+    for(i = 0; i < n; i++)
+    {
+        *(pqcb->qStart + pqcb->tail) = msgs[i];   /* Insert message into queue*/
+        pqcb->tail++;                           /* Update queue tail          */
+        if(pqcb->tail == pqcb->qMaxSize)        /* Check queue tail           */   
+        {
+            pqcb->tail = 0;	
+        }
+    }
+    pqcb->qSize += n;           /* Update the number of messages in the queue */
+    
+    /* Hand one mail to each waiting task while there are mails              */
+    while((pecb->eventTCBList != NULL) && (pqcb->qSize != 0))
+    {
+        EventTaskToRdy(pecb);
+    }
+    OsSchedUnlock();
+    return E_OK;
+}
+
+
 /**
  *******************************************************************************
  * @brief      Post a mail to queue in ISR	 
@@ -0,0 +1,559 @@
+/**
+ *******************************************************************************
+ * @file       rwlock.c
+ * @version    V1.13
+ * @date       2026.10.14
+ * @brief      Reader-writer lock implementation code of CooCox CoOS kernel.
+ *******************************************************************************
+ * @copy
+ *
+ * INTERNAL FILE,DON'T PUBLIC.
+ *
+ * <h2><center>&copy; COPYRIGHT 2009 CooCox </center></h2>
+ *******************************************************************************
+ */
+
+
+/*---------------------------- Include ---------------------------------------*/
+#include "coocox.h"
+
+
+#if CFG_RWLOCK_EN > 0
+/*---------------------------- Variable Define -------------------------------*/
+RWLOCK RwLockTbl[CFG_MAX_RWLOCK] = {{0}};/*!< Reader-writer lock table       */
+U32    RwLockIDVessel = 0;              /*!< Reader-writer lock list mask     */
+
+
+/**
+ *******************************************************************************
+ * @brief      Get the event of a reader-writer lock from its ID
+ * @param[in]  id     Event ID.
+ * @param[out] None
+ * @retval     NULL   Invalid ID.
+ * @retval     others Pointer to event control block.
+ *******************************************************************************
+ */
+static P_ECB GetRwLockEvent(OS_EventID id)
+{
+#if CFG_PAR_CHECKOUT_EN >0
+    if(id >= CFG_MAX_EVENT)
+    {
+        return NULL;
+    }
+    if(EventTbl[id].eventType != EVENT_TYPE_RWLOCK)
+    {
+        return NULL;                    /* The event isn't a rw lock          */
+    }
+#endif
+    return &EventTbl[id];
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Promote the writer of a reader-writer lock
+ * @param[in]  ptcb   The writer.
+ * @param[in]  prio   PRI of the task it blocks.
+ * @param[out] None
+ * @retval     None
+ *
+ * @par Description
+ * @details    This function is called with the scheduler locked when a task
+ *             of higher PRI has to wait for the writer,the same way a mutex
+ *             owner is promoted. Readers are not,there may be many of them.
+ *******************************************************************************
+ */
+static void RwLockPromote(P_OSTCB ptcb,U8 prio)
+{
+    P_ECB pecb;
+
+    if(ptcb->prio <= prio)              /* Is the writer PRI high enough?     */
+    {
+        return;                         /* Yes,nothing to do                  */
+    }
+#if CFG_ORDER_LIST_SCHEDULE_EN ==0
+    DeleteTaskPri(ptcb->prio);
+    ActiveTaskPri(prio);
+#endif
+    ptcb->prio = prio;                  /* Promote prio of writer             */
+    if(ptcb->state == TASK_READY)       /* If the task is ready to run        */
+    {
+        RemoveFromTCBRdyList(ptcb);     /* Remove the task from READY list    */
+        InsertToTCBRdyList(ptcb);       /* Insert the task into READY list    */
+    }
+    else if(ptcb->eventID != INVALID_ID)/* If the task is waiting on a event  */
+    {
+        pecb = &EventTbl[ptcb->eventID];
+        if(pecb->eventSortType == EVENT_SORT_TYPE_PRIO)
+        {
+            RemoveEventWaittingList(ptcb);  /* Reorder the waiting list       */
+            EventTaskToWait(pecb,ptcb);
+        }
+    }
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Hand a reader-writer lock to the tasks waiting for it
+ * @param[in]  pecb   Event of the lock.
+ * @param[in]  prw    The lock.
+ * @param[out] None
+ * @retval     None
+ *
+ * @par Description
+ * @details    This function is called with the scheduler locked when the
+ *             lock may have become free. Readers at the head of the waiting
+ *             list get it until a writer,which gets it alone once the last
+ *             reader left. Readers behind a waiting writer keep waiting.
+ *******************************************************************************
+ */
+static void RwLockGrant(P_ECB pecb,P_RWLOCK prw)
+{
+    P_OSTCB ptcb;
+
+    while(prw->writerID == INVALID_ID)  /* Is no writer holding the lock?     */
+    {
+        ptcb = pecb->eventTCBList;      /* Yes,get first waiting task         */
+        if(ptcb == NULL)
+        {
+            break;
+        }
+        if(ptcb->pmail == RWLOCK_WAIT_WRITE)
+        {
+            if(prw->readers != 0)       /* Are there readers still?           */
+            {
+                break;                  /* Yes,the writer waits for them      */
+            }
+            prw->writerID     = ptcb->taskID;
+            prw->originalPrio = ptcb->prio;
+        }
+        else
+        {
+            prw->readers++;
+        }
+        ptcb->pmail = RWLOCK_GRANTED;   /* Indicate task got the lock         */
+        EventTaskToRdy(pecb);           /* Insert task into ready list        */
+    }
+
+    /* Promote the new writer to the PRI of the first task still waiting      */
+    if((prw->writerID != INVALID_ID) && (pecb->eventTCBList != NULL))
+    {
+        RwLockPromote(&TCBTbl[prw->writerID],pecb->eventTCBList->prio);
+    }
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Release a reader-writer lock held by a writer
+ * @param[in]  pecb   Event of the lock.
+ * @param[in]  prw    The lock.
+ * @param[out] None
+ * @retval     None
+ *
+ * @par Description
+ * @details    This function is called with the scheduler locked to restore
+ *             the PRI of the writer and hand the lock to the waiting tasks.
+ *******************************************************************************
+ */
+static void RwLockWriteRelease(P_ECB pecb,P_RWLOCK prw)
+{
+    OS_TID taskID;
+
+    taskID        = prw->writerID;
+    prw->writerID = INVALID_ID;
+    if(TCBTbl[taskID].prio != prw->originalPrio)  /* Was the writer promoted? */
+    {
+        CoSetPriority(taskID,prw->originalPrio);  /* Yes,restore its PRI      */
+    }
+    RwLockGrant(pecb,prw);
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Block the running task on a reader-writer lock
+ * @param[in]  pecb     Event of the lock.
+ * @param[in]  prw      The lock.
+ * @param[in]  timeout  The longest time to wait,0 for ever.
+ * @param[in]  mode     RWLOCK_WAIT_READ or RWLOCK_WAIT_WRITE.
+ * @param[out] None
+ * @retval     E_INVALID_ID   The lock was deleted.
+ * @retval     E_TIMEOUT      The lock was not got within 'timeout'.
+ * @retval     E_OK           The running task holds the lock.
+ *
+ * @par Description
+ * @details    This function is called with the scheduler locked and unlocks
+ *             it. The mode is kept in pmail while the task waits.
+ *******************************************************************************
+ */
+static StatusType RwLockWait(P_ECB pecb,P_RWLOCK prw,U32 timeout,void* mode)
+{
+    P_OSTCB curTCB;
+
+    curTCB        = TCBRunning;
+    curTCB->pmail = mode;
+    if(prw->writerID != INVALID_ID)     /* Is a writer holding the lock?      */
+    {
+        RwLockPromote(&TCBTbl[prw->writerID],curTCB->prio);
+    }
+    EventTaskToWait(pecb,curTCB);       /* Block task until it gets the lock  */
+    if(timeout != 0)
+    {
+        InsertDelayList(curTCB,timeout);
+    }
+    OsSchedUnlock();
+
+    if(curTCB->pmail == RWLOCK_GRANTED) /* Did the task get the lock?         */
+    {
+        curTCB->pmail = NULL;
+        return E_OK;
+    }
+    curTCB->pmail = NULL;
+    if(timeout == 0)                    /* No,the lock was deleted            */
+    {
+        return E_INVALID_ID;
+    }
+
+    /* A writer that gave up may leave the lock to the readers behind it      */
+    OsSchedLock();
+    if(pecb->eventType == EVENT_TYPE_RWLOCK)
+    {
+        RwLockGrant(pecb,prw);
+    }
+    OsSchedUnlock();
+    return E_TIMEOUT;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Create a reader-writer lock
+ * @param[in]  sortType  Waiting list sort type.
+ * @param[out] None
+ * @retval     E_CREATE_FAIL  Create reader-writer lock fail.
+ * @retval     others         Create reader-writer lock successful.
+ *
+ * @par Description
+ * @details    This function is called to create a reader-writer lock.
+ *******************************************************************************
+ */
+OS_EventID CoCreateRwLock(U8 sortType)
+{
+    U8    i;
+    P_ECB pecb;
+
+#if CFG_PAR_CHECKOUT_EN >0
+    if ((sortType != EVENT_SORT_TYPE_FIFO) && (sortType != EVENT_SORT_TYPE_PRIO))
+    {
+        return E_CREATE_FAIL;           /* Illegal sort type,return error     */
+    }
+#endif
+
+    OsSchedLock();
+    for(i = 0; i < CFG_MAX_RWLOCK; i++)
+    {
+        /* Assign a free reader-writer lock control block                     */
+        if((RwLockIDVessel & (1u << i)) == 0)
+        {
+            pecb = CreatEvent(EVENT_TYPE_RWLOCK,sortType,&RwLockTbl[i]);
+            if(pecb == NULL)        /* If there is no free EVENT control block*/
+            {
+                OsSchedUnlock();
+                return E_CREATE_FAIL;
+            }
+            RwLockIDVessel |= (1u << i);
+            RwLockTbl[i].id       = i;  /* Initialize the lock as free        */
+            RwLockTbl[i].writerID = INVALID_ID;
+            RwLockTbl[i].readers  = 0;
+            RwLockTbl[i].eventID  = pecb->id;
+            OsSchedUnlock();
+            return (pecb->id);
+        }
+    }
+
+    OsSchedUnlock();
+    return E_CREATE_FAIL;           /* There is no free rw lock control block */
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Delete a reader-writer lock
+ * @param[in]  id     Event ID of the lock.
+ * @param[in]  opt    Delete option.
+ * @arg        == OPT_DEL_ANYWAY    Delete the lock always
+ * @arg        == OPT_DEL_NO_PEND   Delete the lock only when nobody holds it
+ *                                  or waits for it.
+ * @param[out] None
+ * @retval     E_INVALID_ID         Invalid event ID.
+ * @retval     E_TASK_WAITTING      The lock is held or waited for.
+ * @retval     E_OK                 Lock deleted successful.
+ *
+ * @par Description
+ * @details    This function is called to delete a reader-writer lock. The
+ *             waiting tasks get E_INVALID_ID,or E_TIMEOUT if they wait with a
+ *             timeout.
+ *******************************************************************************
+ */
+StatusType CoDelRwLock(OS_EventID id,U8 opt)
+{
+    P_ECB      pecb;
+    P_RWLOCK   prw;
+    StatusType err;
+
+    pecb = GetRwLockEvent(id);
+    if(pecb == NULL)
+    {
+        return E_INVALID_ID;
+    }
+    prw = (P_RWLOCK)pecb->eventPtr;
+
+    OsSchedLock();
+    if((prw->writerID != INVALID_ID) || (prw->readers != 0))
+    {
+        if(opt == OPT_DEL_NO_PEND)      /* Is the lock held?                  */
+        {
+            OsSchedUnlock();
+            return E_TASK_WAITING;      /* Yes,error return                   */
+        }
+        if((prw->writerID != INVALID_ID) &&
+           (TCBTbl[prw->writerID].prio != prw->originalPrio))
+        {
+            CoSetPriority(prw->writerID,prw->originalPrio);
+        }
+        prw->writerID = INVALID_ID;
+        prw->readers  = 0;
+    }
+    err = DeleteEvent(pecb,opt);
+    if(err == E_OK)
+    {
+        RwLockIDVessel &= ~(1u << prw->id);
+    }
+    OsSchedUnlock();
+    return err;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Lock a reader-writer lock to read
+ * @param[in]  id       Event ID of the lock.
+ * @param[in]  timeout  The longest time to wait,0 for ever.
+ * @param[out] None
+ * @retval     E_CALL         Error call in ISR.
+ * @retval     E_INVALID_ID   Invalid event ID or lock deleted.
+ * @retval     E_OS_IN_LOCK   The OS is locked.
+ * @retval     E_TIMEOUT      The lock was not got within 'timeout'.
+ * @retval     E_OK           The task reads under the lock.
+ *
+ * @par Description
+ * @details    This function is called to share a reader-writer lock with the
+ *             other readers. It waits while a writer holds the lock or any
+ *             task waits for it,so readers can't starve a writer.
+ *******************************************************************************
+ */
+StatusType CoReadLock(OS_EventID id,U32 timeout)
+{
+    P_ECB    pecb;
+    P_RWLOCK prw;
+
+    if(OSIntNesting > 0)                /* If the caller is ISR               */
+    {
+        return E_CALL;
+    }
+    pecb = GetRwLockEvent(id);
+    if(pecb == NULL)
+    {
+        return E_INVALID_ID;
+    }
+    if(OSSchedLock != 0)                /* Is OS lock?                        */
+    {
+        return E_OS_IN_LOCK;            /* Yes,error return                   */
+    }
+    prw = (P_RWLOCK)pecb->eventPtr;
+    TRACE(TRACE_RWLOCK_READ,id);
+
+    OsSchedLock();
+    if((prw->writerID == INVALID_ID) && (pecb->eventTCBList == NULL))
+    {
+        prw->readers++;                 /* Lock free,share it                 */
+        OsSchedUnlock();
+        return E_OK;
+    }
+    return RwLockWait(pecb,prw,timeout,RWLOCK_WAIT_READ);
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Unlock a reader-writer lock locked to read
+ * @param[in]  id     Event ID of the lock.
+ * @param[out] None
+ * @retval     E_CALL         Error call in ISR.
+ * @retval     E_INVALID_ID   Invalid event ID or no reader holds the lock.
+ * @retval     E_OK           Unlock successful.
+ *
+ * @par Description
+ * @details    This function is called when a reader leaves. The last one
+ *             hands the lock to the tasks waiting for it.
+ *******************************************************************************
+ */
+StatusType CoReadUnlock(OS_EventID id)
+{
+    P_ECB    pecb;
+    P_RWLOCK prw;
+
+    if(OSIntNesting > 0)                /* If the caller is ISR               */
+    {
+        return E_CALL;
+    }
+    pecb = GetRwLockEvent(id);
+    if(pecb == NULL)
+    {
+        return E_INVALID_ID;
+    }
+    prw = (P_RWLOCK)pecb->eventPtr;
+    TRACE(TRACE_RWLOCK_UNLOCK,id);
+
+    OsSchedLock();
+    if(prw->readers == 0)               /* Is the lock held by readers?       */
+    {
+        OsSchedUnlock();
+        return E_INVALID_ID;            /* No,error return                    */
+    }
+    prw->readers--;
+    if(prw->readers == 0)               /* Is it the last reader?             */
+    {
+        RwLockGrant(pecb,prw);          /* Yes,let the waiting tasks in       */
+    }
+    OsSchedUnlock();
+    return E_OK;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Lock a reader-writer lock to write
+ * @param[in]  id       Event ID of the lock.
+ * @param[in]  timeout  The longest time to wait,0 for ever.
+ * @param[out] None
+ * @retval     E_CALL         Error call in ISR.
+ * @retval     E_INVALID_ID   Invalid event ID or lock deleted.
+ * @retval     E_OS_IN_LOCK   The OS is locked.
+ * @retval     E_TIMEOUT      The lock was not got within 'timeout'.
+ * @retval     E_OK           The task holds the lock alone.
+ *
+ * @par Description
+ * @details    This function is called to hold a reader-writer lock alone.
+ *             From the time it waits,new readers wait too.
+ *******************************************************************************
+ */
+StatusType CoWriteLock(OS_EventID id,U32 timeout)
+{
+    P_ECB    pecb;
+    P_RWLOCK prw;
+
+    if(OSIntNesting > 0)                /* If the caller is ISR               */
+    {
+        return E_CALL;
+    }
+    pecb = GetRwLockEvent(id);
+    if(pecb == NULL)
+    {
+        return E_INVALID_ID;
+    }
+    if(OSSchedLock != 0)                /* Is OS lock?                        */
+    {
+        return E_OS_IN_LOCK;            /* Yes,error return                   */
+    }
+    prw = (P_RWLOCK)pecb->eventPtr;
+    TRACE(TRACE_RWLOCK_WRITE,id);
+
+    OsSchedLock();
+    if((prw->writerID == INVALID_ID) && (prw->readers == 0) &&
+       (pecb->eventTCBList == NULL))
+    {
+        prw->writerID     = TCBRunning->taskID; /* Lock free,hold it          */
+        prw->originalPrio = TCBRunning->prio;
+        OsSchedUnlock();
+        return E_OK;
+    }
+    return RwLockWait(pecb,prw,timeout,RWLOCK_WAIT_WRITE);
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Unlock a reader-writer lock locked to write
+ * @param[in]  id     Event ID of the lock.
+ * @param[out] None
+ * @retval     E_CALL         Error call in ISR.
+ * @retval     E_INVALID_ID   Invalid event ID or the task isn't the writer.
+ * @retval     E_OK           Unlock successful.
+ *
+ * @par Description
+ * @details    This function is called when the writer leaves. It gets its
+ *             PRI back and the lock goes to the tasks waiting for it.
+ *******************************************************************************
+ */
+StatusType CoWriteUnlock(OS_EventID id)
+{
+    P_ECB    pecb;
+    P_RWLOCK prw;
+
+    if(OSIntNesting > 0)                /* If the caller is ISR               */
+    {
+        return E_CALL;
+    }
+    pecb = GetRwLockEvent(id);
+    if(pecb == NULL)
+    {
+        return E_INVALID_ID;
+    }
+    prw = (P_RWLOCK)pecb->eventPtr;
+    TRACE(TRACE_RWLOCK_UNLOCK,id);
+
+    OsSchedLock();
+    if(prw->writerID != TCBRunning->taskID) /* Is the task the writer?        */
+    {
+        OsSchedUnlock();
+        return E_INVALID_ID;            /* No,error return                    */
+    }
+    RwLockWriteRelease(pecb,prw);
+    OsSchedUnlock();
+    return E_OK;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Release the reader-writer locks a task writes under
+ * @param[in]  ptcb   Task which will be deleted.
+ * @param[out] None
+ * @retval     None
+ *
+ * @par Description
+ * @details    This function is called when a task is deleted,so the tasks
+ *             waiting for its locks don't wait for ever. Locks held to read
+ *             are not tracked per task and must be unlocked before.
+ *******************************************************************************
+ */
+void RemoveRwLockWriter(P_OSTCB ptcb)
+{
+    U8 i;
+
+    OsSchedLock();
+    for(i = 0; i < CFG_MAX_RWLOCK; i++)
+    {
+        if(((RwLockIDVessel & (1u << i)) != 0) &&
+           (RwLockTbl[i].writerID == ptcb->taskID))
+        {
+            RwLockWriteRelease(&EventTbl[RwLockTbl[i].eventID],&RwLockTbl[i]);
+        }
+    }
+    OsSchedUnlock();
+}
+
+#endif
@@ -133,6 +133,7 @@ StatusType CoAcceptSem(OS_EventID id)
         return E_INVALID_ID;	
     }
 #endif
+    TRACE(TRACE_SEM_PEND,id);
 	OsSchedLock();
     if(pecb->eventCounter > 0) /* If semaphore is positive,resource available */
     {	
@@ -194,6 +195,7 @@ StatusType CoPendSem(OS_EventID id,U32 timeout)
     {
         return E_OS_IN_LOCK;            /* Yes,error return                   */
     }	
+    TRACE(TRACE_SEM_PEND,id);
     if(pecb->eventCounter > 0) /* If semaphore is positive,resource available */       
     {	
         pecb->eventCounter--;         /* Decrement semaphore only if positive */
@@ -269,6 +271,7 @@ StatusType CoPostSem(OS_EventID id)
     {
         return E_SEM_FULL;    /* The counter of Semaphore reach the max number*/
     }
+    TRACE(TRACE_SEM_POST,id);
     OsSchedLock();
     pecb->eventCounter++;     /* Increment semaphore count to register event  */
     EventTaskToRdy(pecb);     /* Check semaphore event waiting list           */
@@ -23,6 +23,18 @@
 #if CFG_MAX_SERVICE_REQUEST > 0
 /*---------------------------- Variable Define -------------------------------*/
 SRQ   ServiceReq = {0};             /*!< ISR server request queue         */
+U32   SRQHighWater = 0;             /*!< Most requests queued at once     */
+volatile U32 SRQDrops = 0;          /*!< Requests lost,queue was full     */
+#if CFG_FLAG_EN > 0
+volatile U32 FlagReqPend = 0;       /*!< Flags set in ISR,one bit per ID  */
+#endif
+#if CFG_SEM_EN > 0
+volatile U32 SemReqCnt[CFG_MAX_EVENT] = {0};/*!< Semaphore posts in ISR   */
+volatile U32 SemReq = FALSE;        /*!< Any semaphore post in ISR        */
+#endif
+
+/* Keeps the compiler from moving the cell accesses past its sequence.        */
+#define SRQBarrier()    __asm volatile ("" ::: "memory")
 #endif       
 BOOL  IsrReq   = FALSE;
 #if (CFG_TASK_WAITTING_EN > 0)
@@ -41,12 +53,16 @@ BOOL  TimerReq = FALSE;                 /*!< Timer dispose request            */
  * @param[in]  arg      Service request argument. 
  * @param[out] None 
  * 	 
- * @retval     FALSE    Successfully insert into service request queue. 
- * @retval     TRUE     Failure to insert into service request queue.  
+ * @retval     TRUE     Successfully insert into service request queue. 
+ * @retval     FALSE    Failure to insert into service request queue.  
  *
  * @par Description		 
  * @details    This function be called to insert a requst into service request	
- *             queue.
+ *             queue. It does not disable interrupts: an ISR that preempts
+ *             another one in here makes its CasWord() fail,and it tries
+ *             again with the new tail. A flag request only sets the bit of
+ *             the flag and a semaphore request adds to the count of the
+ *             semaphore,so repeated requests of one ID take no room.
  * @note 
  *******************************************************************************
  */
@@ -54,26 +70,126 @@ BOOL  TimerReq = FALSE;                 /*!< Timer dispose request            */
 BOOL InsertInSRQ(U8 type,U8 id,void* arg)
 {
     P_SQC   pcell;
-	U8 cnt;
-	U8 heed;
-    IRQ_DISABLE_SAVE();
-    if (ServiceReq.cnt >= CFG_MAX_SERVICE_REQUEST)
+    U32     pos,seq,used,old;
+    
+#if CFG_FLAG_EN > 0
+    if(type == FLAG_REQ)                /* Merge with a pending flag request  */
     {
-        IRQ_ENABLE_RESTORE ();
+        do
+        {
+            old = FlagReqPend;
+        }while(CasWord(&FlagReqPend,old,old | (1u << id)) == FALSE);
+        IsrReq = TRUE;
+        return TRUE;
+    }
+#endif
+#if CFG_SEM_EN > 0
+    if(type == SEM_REQ)                 /* Count the semaphore posts          */
+    {
+        do
+        {
+            old = SemReqCnt[id];
+        }while(CasWord(&SemReqCnt[id],old,old + 1) == FALSE);
+        SemReq = TRUE;
+        IsrReq = TRUE;
+        return TRUE;
+    }
+#endif
 
-        return FALSE;                   /* Error return                       */
+    for(;;)                             /* Reserve the cell at the tail       */
+    {
+        pos   = ServiceReq.tail;
+        pcell = &ServiceReq.cell[pos & SRQ_MASK];
+        seq   = pcell->seq;
+        if(seq == SRQ_LAP(pos))         /* Is the cell free?                  */
+        {
+            if(CasWord(&ServiceReq.tail,pos,pos + 1) == TRUE)
+            {
+                break;
+            }
+        }
+        else if((S32)(seq - SRQ_LAP(pos)) < 0)  /* Not responded yet,full     */
+        {
+            do
+            {
+                old = SRQDrops;
+            }while(CasWord(&SRQDrops,old,old + 1) == FALSE);
+            return FALSE;               /* Error return                       */
+        }
     }
-	cnt = Inc8(&ServiceReq.cnt);
-	heed = ServiceReq.head;
-    IsrReq = TRUE;
-    pcell = &ServiceReq.cell[((cnt+heed)%CFG_MAX_SERVICE_REQUEST)];/*the tail */
     pcell->type = type;                 /* Save service request type,         */
     pcell->id   = id;                   /* event id                           */
     pcell->arg  = arg;                  /* and parameter                      */
-    IRQ_ENABLE_RESTORE ();
-
+    SRQBarrier();
+    pcell->seq  = SRQ_LAP(pos) + 1;     /* Publish the request                */
+    IsrReq = TRUE;
+    
+    used = pos + 1 - ServiceReq.head;
+    if(used > SRQHighWater)             /* Only a statistic,a race is harmless*/
+    {
+        SRQHighWater = used;
+    }
     return TRUE;                        /* Return OK                          */
 }
+
+
+/**
+ *******************************************************************************
+ * @brief      Get statistics of the service request queue	 
+ * @param[out] highWater  Most requests that have been queued at once,or NULL.
+ * @param[out] drops      Requests lost because the queue was full,or NULL.
+ * @retval     E_OK
+ *
+ * @par Description		 
+ * @details    This function be called to check whether CFG_MAX_SERVICE_REQUEST
+ *             is large enough.
+ * @note 
+ *******************************************************************************
+ */
+StatusType CoGetServiceReqStats(U32* highWater,U32* drops)
+{
+    if(highWater != NULL)
+    {
+        *highWater = SRQHighWater;
+    }
+    if(drops != NULL)
+    {
+        *drops = SRQDrops;
+    }
+    return E_OK;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Check for requests not responded yet	 
+ * @param[in]  None
+ * @param[out] None 
+ * @retval     TRUE     There are requests.
+ * @retval     FALSE    No request.
+ *******************************************************************************
+ */
+static BOOL SRQPending(void)
+{
+    U32 pos = ServiceReq.head;
+    if(ServiceReq.cell[pos & SRQ_MASK].seq == SRQ_LAP(pos) + 1)
+    {
+        return TRUE;
+    }
+#if CFG_FLAG_EN > 0
+    if(FlagReqPend != 0)
+    {
+        return TRUE;
+    }
+#endif
+#if CFG_SEM_EN > 0
+    if(SemReq != FALSE)
+    {
+        return TRUE;
+    }
+#endif
+    return FALSE;
+}
 #endif
 
 
@@ -95,8 +211,11 @@ void RespondSRQ(void)
 {
 
 #if CFG_MAX_SERVICE_REQUEST > 0
-    SQC cell;
-
+    SQC     cell;
+    P_SQC   pcell;
+    U32     pos;
+    U32     pend;
+    U8      i;
 #endif
 
 #if (CFG_TASK_WAITTING_EN > 0)
@@ -106,7 +225,13 @@ void RespondSRQ(void)
         TimeReq = FALSE;                /* Reset time delay request false     */
     }
 #endif
-#if CFG_TMR_EN  > 0
+#if CFG_TASK_NOTIFY_EN > 0
+    if(NotifyReq == TRUE)               /* Notification request?              */
+    {
+        NotifyDispose();                /* Yes,call handler                   */
+    }
+#endif
+#if (CFG_TMR_EN  > 0) && (CFG_TMR_WHEEL_EN == 0)
     if(TimerReq == TRUE)                /* Timer request?                     */
     {
         TmrDispose();                   /* Yes,call handler                   */
@@ -114,34 +239,62 @@ void RespondSRQ(void)
     }
 #endif
 
+#if (CFG_FLAG_EN > 0) && (CFG_MAX_FLAG_GROUP > 0)
+    if(FlagGrpReq == TRUE)              /* Group flags set in ISR?            */
+    {
+        FlagGrpDispose();               /* Yes,call handler                   */
+    }
+#endif
+
 #if CFG_MAX_SERVICE_REQUEST > 0
+#if CFG_FLAG_EN > 0
+    pend = SwapWord(&FlagReqPend,0);    /* Take the flags set in ISR          */
+    while(pend != 0)
+    {
+        i     = (U8)__builtin_ctz(pend);
+        pend &= pend - 1;
+        CoSetFlag(i);
+    }
+#endif
+#if CFG_SEM_EN > 0
+    if(SemReq != FALSE)
+    {
+        SemReq = FALSE;                 /* Cleared before the counts are taken*/
+        for(i = 0; i < CFG_MAX_EVENT; i++)
+        {
+            if(SemReqCnt[i] != 0)
+            {
+                pend = SwapWord(&SemReqCnt[i],0);
+                while(pend-- != 0)
+                {
+                    CoPostSem(i);
+                }
+            }
+        }
+    }
+#endif
 
-    while (ServiceReq.cnt != 0)
+    for(;;)
     {
-        IRQ_DISABLE_SAVE ();            /* need to protect the following      */
-        cell = ServiceReq.cell[ServiceReq.head];  /* extract one cell         */
-        /* move head (pop)          */
-        ServiceReq.head = ((U8)(ServiceReq.head + 1)) % ((U8)CFG_MAX_SERVICE_REQUEST);
-        ServiceReq.cnt--;
-        IRQ_ENABLE_RESTORE ();          /* now use the cell copy              */
+        pos   = ServiceReq.head;
+        pcell = &ServiceReq.cell[pos & SRQ_MASK];
+        if(pcell->seq != SRQ_LAP(pos) + 1)  /* Is the request written?        */
+        {
+            break;
+        }
+        SRQBarrier();
+        cell = *pcell;                  /* extract one cell                   */
+        SRQBarrier();
+        pcell->seq = SRQ_LAP(pos) + CFG_MAX_SERVICE_REQUEST;/* Free for next lap*/
+        ServiceReq.head = pos + 1;      /* move head (pop)                    */
 
         switch(cell.type)               /* Judge service request type         */
         {
-#if CFG_SEM_EN > 0
-        case SEM_REQ:                   /* Semaphore post request,call handler*/
-            CoPostSem(cell.id);
-            break;
-#endif
 #if CFG_MAILBOX_EN > 0
         case MBOX_REQ:                  /* Mailbox post request,call handler  */
             CoPostMail(cell.id, cell.arg);
             break;
 #endif
-#if CFG_FLAG_EN > 0
-        case FLAG_REQ:                  /* Flag set request,call handler      */
-            CoSetFlag(cell.id);
-            break;
-#endif
 #if CFG_QUEUE_EN > 0
         case QUEUE_REQ:                 /* Queue post request,call handler    */
             CoPostQueueMail(cell.id, cell.arg);
@@ -154,12 +307,21 @@ void RespondSRQ(void)
 #endif
     IRQ_DISABLE_SAVE ();                /* need to protect the following      */
 
-    if (ServiceReq.cnt == 0)            /* another item in the queue already? */
+#if CFG_MAX_SERVICE_REQUEST > 0
+    if (SRQPending() == FALSE)          /* another item in the queue already? */
+#endif
     {
-        IsrReq = FALSE;                 /* queue still empty here             */
+#if CFG_TASK_NOTIFY_EN > 0
+        if (NotifyReq == FALSE)         /* Notified meanwhile?                */
+#endif
+#if (CFG_FLAG_EN > 0) && (CFG_MAX_FLAG_GROUP > 0)
+        if (FlagGrpReq == FALSE)        /* Group flags set meanwhile?         */
+#endif
+        {
+            IsrReq = FALSE;             /* queue still empty here             */
+        }
     }
     IRQ_ENABLE_RESTORE ();              /* now it is done and return          */
 }
 
 #endif
-
@@ -0,0 +1,144 @@
+/**
+ *******************************************************************************
+ * @file       stats.c
+ * @version    V1.13
+ * @date       2026.10.14
+ * @brief      task statistics implementation code of CooCox CoOS kernel.
+ *******************************************************************************
+ * @copy
+ *
+ * INTERNAL FILE,DON'T PUBLIC.
+ *
+ * <h2><center>&copy; COPYRIGHT 2009 CooCox </center></h2>
+ *******************************************************************************
+ */
+
+
+/*---------------------------- Include ---------------------------------------*/
+#include "coocox.h"
+
+
+#if CFG_TASK_STATS_EN > 0
+/*---------------------------- Variable Define -------------------------------*/
+U32   StatsLastTime = 0;                /*!< DWT_CYCCNT at the last update    */
+
+
+/**
+ *******************************************************************************
+ * @brief      Start the statistics
+ * @param[in]  None
+ * @param[out] None
+ * @retval     None
+ *
+ * @par Description
+ * @details    This function is called by CoStartOS() to start the DWT cycle
+ *             counter.
+ *******************************************************************************
+ */
+void StatsStart(void)
+{
+    NVIC_DEMCR    |= NVIC_DEMCR_TRCENA; /* Enable the DWT                     */
+    DWT_CTRL      |= DWT_CTRL_CYCCNTENA;/* Start the cycle counter            */
+    StatsLastTime  = DWT_CYCCNT;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Charge the running task with the cycles since the last update
+ * @param[in]  None
+ * @param[out] None
+ * @retval     None
+ *
+ * @par Description
+ * @details    This function is called with interrupts disabled,or from the
+ *             SysTick handler. It is called on every tick,so the 32-bit
+ *             counter cannot wrap between two updates.
+ *******************************************************************************
+ */
+void StatsUpdate(void)
+{
+    U32 now;
+    now                 = DWT_CYCCNT;
+    TCBRunning->cycles += now - StatsLastTime;
+    StatsLastTime       = now;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Get the statistics of a task
+ * @param[in]  taskID     Task ID.
+ * @param[out] cycles     CPU cycles the task has run,or NULL.
+ * @param[out] switches   Times the task has been switched in,or NULL.
+ * @param[out] preempts   Times the task has been switched out while ready,
+ *                        or NULL.
+ * @retval     E_INVALID_ID   Invalid task ID.
+ * @retval     E_OK           Statistics returned.
+ *
+ * @par Description
+ * @details    This function is called to find out which task uses the CPU.
+ *             ISRs count for the task they interrupt. Task 0 is the IDLE
+ *             task.
+ *******************************************************************************
+ */
+StatusType CoGetTaskStats(OS_TID taskID,U64* cycles,U32* switches,
+                          U32* preempts)
+{
+    P_OSTCB ptcb;
+#if CFG_PAR_CHECKOUT_EN >0              /* Check validity of parameter        */
+    if(taskID >= CFG_MAX_USER_TASKS + SYS_TASK_NUM)
+    {
+        return E_INVALID_ID;
+    }
+#endif
+    ptcb = &TCBTbl[taskID];
+    if(ptcb->state == TASK_DORMANT)
+    {
+        return E_INVALID_ID;
+    }
+    IRQ_DISABLE_SAVE();
+    StatsUpdate();                      /* Count the cycles of running task   */
+    if(cycles != NULL)
+    {
+        *cycles = ptcb->cycles;
+    }
+    if(switches != NULL)
+    {
+        *switches = ptcb->switches;
+    }
+    if(preempts != NULL)
+    {
+        *preempts = ptcb->preempts;
+    }
+    IRQ_ENABLE_RESTORE();
+    return E_OK;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Reset the statistics of all tasks
+ * @param[in]  None
+ * @param[out] None
+ * @retval     None
+ *
+ * @par Description
+ * @details    This function is called to start a new measurement.
+ *******************************************************************************
+ */
+void CoResetTaskStats(void)
+{
+    U8 i;
+    IRQ_DISABLE_SAVE();
+    for(i = 0; i < CFG_MAX_USER_TASKS + SYS_TASK_NUM; i++)
+    {
+        TCBTbl[i].cycles   = 0;
+        TCBTbl[i].switches = 0;
+        TCBTbl[i].preempts = 0;
+    }
+    StatsLastTime = DWT_CYCCNT;
+    IRQ_ENABLE_RESTORE();
+}
+
+#endif
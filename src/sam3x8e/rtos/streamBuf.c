@@ -0,0 +1,830 @@
+/**
+ *******************************************************************************
+ * @file       streamBuf.c
+ * @version    V1.13
+ * @date       2026.10.14
+ * @brief      Stream and message buffer implementation code of CooCox CoOS kernel.
+ *******************************************************************************
+ * @copy
+ *
+ * INTERNAL FILE,DON'T PUBLIC.
+ *
+ * <h2><center>&copy; COPYRIGHT 2009 CooCox </center></h2>
+ *******************************************************************************
+ */
+
+
+/*---------------------------- Include ---------------------------------------*/
+#include "coocox.h"
+
+
+#if CFG_STREAM_BUF_EN > 0
+/*---------------------------- Variable Define -------------------------------*/
+SBUF  SBufTbl[CFG_MAX_STREAM_BUF] = {{0}};/*!< Stream buffer control blocks  */
+U32   SBufIDVessel = 0;                 /*!< Stream buffer list mask          */
+
+/* Keeps the compiler from moving the copy of the bytes past the index.      */
+#define SBufBarrier()   __asm volatile ("" ::: "memory")
+
+
+/**
+ *******************************************************************************
+ * @brief      Get a stream buffer from its ID
+ * @param[in]  id     Stream buffer ID.
+ * @param[in]  type   SBUF_TYPE_STREAM or SBUF_TYPE_MESSAGE.
+ * @param[out] None
+ * @retval     NULL   Invalid ID.
+ * @retval     others Pointer to stream buffer control block.
+ *
+ * @par Description
+ * @details    This function is called to check an ID and get its buffer.
+ *******************************************************************************
+ */
+static P_SBUF SBufGet(OS_SBufID id,U8 type)
+{
+#if CFG_PAR_CHECKOUT_EN >0
+    if(id >= CFG_MAX_STREAM_BUF)
+    {
+        return NULL;
+    }
+    if((SBufIDVessel & (1u << id)) == 0)
+    {
+        return NULL;
+    }
+    if(SBufTbl[id].type != type)
+    {
+        return NULL;
+    }
+#endif
+    return &SBufTbl[id];
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Set the flag of a waiting task
+ * @param[in]  wait   Waiting sign of the task.
+ * @param[in]  flag   Flag the task waits for.
+ * @param[out] None
+ * @retval     None
+ *
+ * @par Description
+ * @details    This function is called to wake a task from a task or an ISR.
+ *             The waiting sign is only cleared when the flag has been set,
+ *             so a full service request queue does not lose the wakeup.
+ *******************************************************************************
+ */
+static void SBufWake(volatile U8* wait,OS_FlagID flag)
+{
+    StatusType err;
+#if CFG_MAX_SERVICE_REQUEST > 0
+    if(OSIntNesting > 0)                /* If the caller is ISR               */
+    {
+        err = isr_SetFlag(flag);
+    }
+    else
+#endif
+    {
+        err = CoSetFlag(flag);
+    }
+    if(err == E_OK)
+    {
+        *wait = 0;
+    }
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Wake the reader if its level is reached
+ * @param[in]  psb    Pointer to stream buffer control block.
+ * @param[out] None
+ * @retval     None
+ *
+ * @par Description
+ * @details    This function is called by the writer after moving the head.
+ *******************************************************************************
+ */
+static void SBufWakeReader(P_SBUF psb)
+{
+    SBufBarrier();
+    if((psb->rxWait != 0) && ((psb->head - psb->tail) >= psb->rxLevel))
+    {
+        SBufWake(&psb->rxWait,psb->rxFlag);
+    }
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Wake the writer if there is enough room
+ * @param[in]  psb    Pointer to stream buffer control block.
+ * @param[out] None
+ * @retval     None
+ *
+ * @par Description
+ * @details    This function is called by the reader after moving the tail.
+ *******************************************************************************
+ */
+static void SBufWakeWriter(P_SBUF psb)
+{
+    SBufBarrier();
+    if((psb->txWait != 0) &&
+       ((psb->mask + 1 - (psb->head - psb->tail)) >= psb->txLevel))
+    {
+        SBufWake(&psb->txWait,psb->txFlag);
+    }
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Wait for a flag until a level is reached
+ * @param[in]  psb      Pointer to stream buffer control block.
+ * @param[in]  reader   TRUE to wait for bytes,FALSE to wait for room.
+ * @param[in]  level    Bytes or room needed.
+ * @param[in]  timeout  The longest time for waitting.
+ * @param[out] None
+ * @retval     E_OK     The level has been reached.
+ * @retval     E_TIMEOUT
+ *
+ * @par Description
+ * @details    This function is called to block the reader or the writer.
+ *             The level is checked again after the waiting sign is set, so
+ *             a wakeup from the other side cannot be missed. A flag that was
+ *             set for an earlier wait only makes the loop run once more.
+ *******************************************************************************
+ */
+static StatusType SBufWait(P_SBUF psb,BOOL reader,U32 level,U32 timeout)
+{
+    volatile U8 *wait;
+    OS_FlagID   flag;
+    StatusType  err;
+    U32         have;
+
+    wait = reader ? &psb->rxWait : &psb->txWait;
+    flag = reader ? psb->rxFlag : psb->txFlag;
+    for(;;)
+    {
+        if(reader)
+        {
+            psb->rxLevel = level;
+        }
+        else
+        {
+            psb->txLevel = level;
+        }
+        *wait = 1;
+        SBufBarrier();
+        have = psb->head - psb->tail;   /* Bytes in the buffer                */
+        if(!reader)
+        {
+            have = psb->mask + 1 - have;/* Room in the buffer                 */
+        }
+        if(have >= level)
+        {
+            *wait = 0;
+            return E_OK;
+        }
+        err = CoWaitForSingleFlag(flag,timeout);
+        *wait = 0;
+        if(err != E_OK)
+        {
+            return err;
+        }
+    }
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Copy bytes in at the head
+ * @param[in]  psb    Pointer to stream buffer control block.
+ * @param[in]  offset Offset from the head.
+ * @param[in]  data   Bytes to copy.
+ * @param[in]  len    Number of bytes.
+ * @param[out] None
+ * @retval     None
+ *******************************************************************************
+ */
+static void SBufCopyIn(P_SBUF psb,U32 offset,const U8* data,U32 len)
+{
+    U32 pos = psb->head + offset;
+    while(len-- != 0)
+    {
+        psb->buf[pos & psb->mask] = *data++;
+        pos++;
+    }
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Copy bytes out from the tail
+ * @param[in]  psb    Pointer to stream buffer control block.
+ * @param[in]  offset Offset from the tail.
+ * @param[in]  len    Number of bytes.
+ * @param[out] data   The bytes.
+ * @retval     None
+ *******************************************************************************
+ */
+static void SBufCopyOut(P_SBUF psb,U32 offset,U8* data,U32 len)
+{
+    U32 pos = psb->tail + offset;
+    while(len-- != 0)
+    {
+        *data++ = psb->buf[pos & psb->mask];
+        pos++;
+    }
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Create a stream or message buffer
+ * @param[in]  buf      Ring buffer.
+ * @param[in]  size     Size of the ring buffer,a power of two.
+ * @param[in]  trigger  Bytes that wake the reader.
+ * @param[in]  type     SBUF_TYPE_STREAM or SBUF_TYPE_MESSAGE.
+ * @param[out] None
+ * @retval     E_CREATE_FAIL  Create stream buffer fail.
+ * @retval     others         Create stream buffer successful.
+ *******************************************************************************
+ */
+static OS_SBufID SBufCreate(U8* buf,U32 size,U32 trigger,U8 type)
+{
+    U8        i;
+    OS_FlagID rxFlag,txFlag;
+#if CFG_PAR_CHECKOUT_EN >0
+    if((buf == NULL) || (size < 2) || ((size & (size - 1)) != 0))
+    {
+        return E_CREATE_FAIL;
+    }
+    if((trigger == 0) || (trigger > size))
+    {
+        return E_CREATE_FAIL;
+    }
+#endif
+
+    OsSchedLock();
+    for(i = 0; i < CFG_MAX_STREAM_BUF; i++)
+    {
+        /* Assign a free stream buffer control block                         */
+        if((SBufIDVessel & (1u << i)) == 0)
+        {
+            SBufIDVessel |= (1u<<i);
+            OsSchedUnlock();
+
+            rxFlag = CoCreateFlag(TRUE,0);      /* Auto-reset,not ready       */
+            if(rxFlag == (OS_FlagID)E_CREATE_FAIL)
+            {
+                SBufIDVessel &= ~(1u<<i);
+                return E_CREATE_FAIL;
+            }
+            txFlag = CoCreateFlag(TRUE,0);
+            if(txFlag == (OS_FlagID)E_CREATE_FAIL)
+            {
+                CoDelFlag(rxFlag,OPT_DEL_ANYWAY);
+                SBufIDVessel &= ~(1u<<i);
+                return E_CREATE_FAIL;
+            }
+            SBufTbl[i].buf     = buf;   /* Initialize the stream buffer       */
+            SBufTbl[i].mask    = size - 1;
+            SBufTbl[i].head    = 0;
+            SBufTbl[i].tail    = 0;
+            SBufTbl[i].trigger = trigger;
+            SBufTbl[i].rxLevel = trigger;
+            SBufTbl[i].txLevel = 1;
+            SBufTbl[i].rxWait  = 0;
+            SBufTbl[i].txWait  = 0;
+            SBufTbl[i].rxFlag  = rxFlag;
+            SBufTbl[i].txFlag  = txFlag;
+            SBufTbl[i].type    = type;
+            return i;
+        }
+    }
+
+    OsSchedUnlock();
+    return E_CREATE_FAIL;       /* There is no free stream buffer control block*/
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Create a stream buffer
+ * @param[in]  buf      Ring buffer.
+ * @param[in]  size     Size of the ring buffer,a power of two.
+ * @param[in]  trigger  Bytes that wake the reader (1 to size).
+ * @param[out] None
+ * @retval     E_CREATE_FAIL  Create stream buffer fail.
+ * @retval     others         Create stream buffer successful.
+ *
+ * @par Description
+ * @details    This function is called to create a stream buffer for one
+ *             writer and one reader. It uses two flags.
+ *******************************************************************************
+ */
+OS_SBufID CoCreateStreamBuf(U8* buf,U32 size,U32 trigger)
+{
+    return SBufCreate(buf,size,trigger,SBUF_TYPE_STREAM);
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Create a message buffer
+ * @param[in]  buf      Ring buffer.
+ * @param[in]  size     Size of the ring buffer,a power of two.
+ * @param[out] None
+ * @retval     E_CREATE_FAIL  Create message buffer fail.
+ * @retval     others         Create message buffer successful.
+ *
+ * @par Description
+ * @details    This function is called to create a message buffer for one
+ *             writer and one reader. Each message takes SBUF_MSG_HEAD more
+ *             bytes for its length. The reader wakes for every message. It
+ *             uses two flags.
+ *******************************************************************************
+ */
+OS_SBufID CoCreateMsgBuf(U8* buf,U32 size)
+{
+    if(size <= SBUF_MSG_HEAD)
+    {
+        return E_CREATE_FAIL;
+    }
+    return SBufCreate(buf,size,1,SBUF_TYPE_MESSAGE);
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Delete a stream or message buffer
+ * @param[in]  id     Stream buffer ID.
+ * @param[in]  opt    Delete option.
+ * @param[out] None
+ * @retval     E_INVALID_ID         Invalid ID.
+ * @retval     E_INVALID_PARAMETER  Invalid parameter.
+ * @retval     E_TASK_WAITTING      Tasks waitting for the buffer,delete fail.
+ * @retval     E_OK                 Buffer deleted successful.
+ *
+ * @par Description
+ * @details    This function is called to delete a stream or message buffer.
+ *******************************************************************************
+ */
+StatusType CoDelStreamBuf(OS_SBufID id,U8 opt)
+{
+    P_SBUF     psb;
+    StatusType err;
+#if CFG_PAR_CHECKOUT_EN >0
+    if((id >= CFG_MAX_STREAM_BUF) || ((SBufIDVessel & (1u << id)) == 0))
+    {
+        return E_INVALID_ID;
+    }
+#endif
+    psb = &SBufTbl[id];
+    if(opt == OPT_DEL_NO_PEND)
+    {
+        if((psb->rxWait != 0) || (psb->txWait != 0))
+        {
+            return E_TASK_WAITING;
+        }
+    }
+    err = CoDelFlag(psb->rxFlag,opt);
+    if(err != E_OK)
+    {
+        return err;
+    }
+    CoDelFlag(psb->txFlag,OPT_DEL_ANYWAY);
+    psb->buf  = NULL;
+    psb->type = 0;
+    SBufIDVessel &= ~(1u<<id);      /* Update free stream buffer list     */
+    return E_OK;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Set the trigger level of a stream buffer
+ * @param[in]  id       Stream buffer ID.
+ * @param[in]  trigger  Bytes that wake the reader (1 to size).
+ * @param[out] None
+ * @retval     E_INVALID_ID
+ * @retval     E_INVALID_PARAMETER
+ * @retval     E_OK
+ *
+ * @par Description
+ * @details    This function is called to change the trigger level. It takes
+ *             effect at the next wait of the reader.
+ *******************************************************************************
+ */
+StatusType CoSetStreamBufTrigger(OS_SBufID id,U32 trigger)
+{
+    P_SBUF psb = SBufGet(id,SBUF_TYPE_STREAM);
+    if(psb == NULL)
+    {
+        return E_INVALID_ID;
+    }
+    if((trigger == 0) || (trigger > psb->mask + 1))
+    {
+        return E_INVALID_PARAMETER;
+    }
+    psb->trigger = trigger;
+    return E_OK;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Get the number of bytes in a stream or message buffer
+ * @param[in]  id     Stream buffer ID.
+ * @param[out] None
+ * @retval     The number of bytes,0 for an invalid ID.
+ *
+ * @par Description
+ * @details    This function is called to get the bytes that can be read,
+ *             with the lengths of the messages in a message buffer.
+ *******************************************************************************
+ */
+U32 CoGetStreamBufBytes(OS_SBufID id)
+{
+#if CFG_PAR_CHECKOUT_EN >0
+    if((id >= CFG_MAX_STREAM_BUF) || ((SBufIDVessel & (1u << id)) == 0))
+    {
+        return 0;
+    }
+#endif
+    return SBufTbl[id].head - SBufTbl[id].tail;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Write bytes to a stream buffer without waiting
+ * @param[in]  id     Stream buffer ID.
+ * @param[in]  data   Bytes to write.
+ * @param[in]  len    Number of bytes.
+ * @param[out] None
+ * @retval     The number of bytes written.
+ *
+ * @par Description
+ * @details    This function is called from the writer,a task or an ISR, to
+ *             write as many bytes as there is room for.
+ * @note       Waking the reader from an ISR needs CFG_MAX_SERVICE_REQUEST>0.
+ *******************************************************************************
+ */
+U32 isr_SendStreamBuf(OS_SBufID id,const void* data,U32 len)
+{
+    P_SBUF psb;
+    U32    room;
+
+    psb = SBufGet(id,SBUF_TYPE_STREAM);
+    if((psb == NULL) || (data == NULL))
+    {
+        return 0;
+    }
+    room = psb->mask + 1 - (psb->head - psb->tail);
+    if(len > room)
+    {
+        len = room;
+    }
+    SBufCopyIn(psb,0,(const U8*)data,len);
+    SBufBarrier();
+    psb->head += len;                   /* Publish the bytes                  */
+    SBufWakeReader(psb);
+    return len;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Write bytes to a stream buffer
+ * @param[in]  id       Stream buffer ID.
+ * @param[in]  data     Bytes to write.
+ * @param[in]  len      Number of bytes.
+ * @param[in]  timeout  The longest time for waitting room.
+ * @param[out] perr     A pointer to error code.
+ * @retval     The number of bytes written.
+ *
+ * @par Description
+ * @details    This function is called from the writer task to write all
+ *             bytes,waiting for room when the buffer is full.
+ *******************************************************************************
+ */
+U32 CoSendStreamBuf(OS_SBufID id,const void* data,U32 len,U32 timeout,
+                    StatusType* perr)
+{
+    P_SBUF psb;
+    U32    done,half;
+    if(OSIntNesting > 0)                /* If the caller is ISR               */
+    {
+        *perr = E_CALL;
+        return 0;
+    }
+    psb = SBufGet(id,SBUF_TYPE_STREAM);
+    if(psb == NULL)
+    {
+        *perr = E_INVALID_ID;
+        return 0;
+    }
+    if(data == NULL)
+    {
+        *perr = E_INVALID_PARAMETER;
+        return 0;
+    }
+    if(OSSchedLock != 0)                /* Judge schedule is locked or not?   */
+    {
+        *perr = E_OS_IN_LOCK;
+        return 0;
+    }
+    half = (psb->mask + 1) / 2;
+    done = isr_SendStreamBuf(id,data,len);
+    *perr = E_OK;
+    while(done < len)
+    {
+        /* The buffer is full now,so the reader has been woken                */
+        *perr = SBufWait(psb,FALSE,(len - done < half) ? len - done : half,
+                         timeout);
+        if(*perr != E_OK)
+        {
+            break;
+        }
+        done += isr_SendStreamBuf(id,(const U8*)data + done,len - done);
+    }
+    return done;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Read bytes from a stream buffer without waiting
+ * @param[in]  id     Stream buffer ID.
+ * @param[in]  max    The most bytes to read.
+ * @param[out] data   Buffer for the bytes.
+ * @retval     The number of bytes read.
+ *
+ * @par Description
+ * @details    This function is called from the reader,a task or an ISR, to
+ *             read the bytes that are there.
+ *******************************************************************************
+ */
+U32 CoAcceptStreamBuf(OS_SBufID id,void* data,U32 max)
+{
+    P_SBUF psb;
+    U32    have;
+
+    psb = SBufGet(id,SBUF_TYPE_STREAM);
+    if((psb == NULL) || (data == NULL))
+    {
+        return 0;
+    }
+    have = psb->head - psb->tail;
+    SBufBarrier();
+    if(max > have)
+    {
+        max = have;
+    }
+    SBufCopyOut(psb,0,(U8*)data,max);
+    SBufBarrier();
+    psb->tail += max;                   /* Give back the room                 */
+    SBufWakeWriter(psb);
+    return max;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Read bytes from a stream buffer
+ * @param[in]  id       Stream buffer ID.
+ * @param[in]  max      The most bytes to read.
+ * @param[in]  timeout  The longest time for waitting the bytes.
+ * @param[out] data     Buffer for the bytes.
+ * @param[out] perr     A pointer to error code.
+ * @retval     The number of bytes read.
+ *
+ * @par Description
+ * @details    This function is called from the reader task. It waits until
+ *             the trigger level (or max,if less) is reached and then reads
+ *             up to max bytes. After a timeout it reads the bytes that are
+ *             there and *perr is E_TIMEOUT.
+ *******************************************************************************
+ */
+U32 CoRecvStreamBuf(OS_SBufID id,void* data,U32 max,U32 timeout,
+                    StatusType* perr)
+{
+    P_SBUF psb;
+    if(OSIntNesting > 0)                /* If the caller is ISR               */
+    {
+        *perr = E_CALL;
+        return 0;
+    }
+    psb = SBufGet(id,SBUF_TYPE_STREAM);
+    if(psb == NULL)
+    {
+        *perr = E_INVALID_ID;
+        return 0;
+    }
+    if((data == NULL) || (max == 0))
+    {
+        *perr = E_INVALID_PARAMETER;
+        return 0;
+    }
+    if(OSSchedLock != 0)                /* Judge schedule is locked or not?   */
+    {
+        *perr = E_OS_IN_LOCK;
+        return 0;
+    }
+    *perr = SBufWait(psb,TRUE,(max < psb->trigger) ? max : psb->trigger,
+                     timeout);
+    return CoAcceptStreamBuf(id,data,max);
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Write a message to a message buffer without waiting
+ * @param[in]  id     Message buffer ID.
+ * @param[in]  data   The message.
+ * @param[in]  len    Length of the message.
+ * @param[out] None
+ * @retval     E_OK
+ * @retval     E_INVALID_ID
+ * @retval     E_INVALID_PARAMETER  The message can never fit.
+ * @retval     E_QUEUE_FULL         Not enough room now.
+ *
+ * @par Description
+ * @details    This function is called from the writer,a task or an ISR, to
+ *             write a whole message or nothing.
+ *******************************************************************************
+ */
+StatusType isr_SendMsgBuf(OS_SBufID id,const void* data,U16 len)
+{
+    P_SBUF psb;
+    U8     head[SBUF_MSG_HEAD];
+
+    psb = SBufGet(id,SBUF_TYPE_MESSAGE);
+    if((psb == NULL) || ((data == NULL) && (len != 0)))
+    {
+        return E_INVALID_ID;
+    }
+    if((U32)len + SBUF_MSG_HEAD > psb->mask + 1)
+    {
+        return E_INVALID_PARAMETER;
+    }
+    if((U32)len + SBUF_MSG_HEAD > psb->mask + 1 - (psb->head - psb->tail))
+    {
+        return E_QUEUE_FULL;
+    }
+    head[0] = (U8)len;
+    head[1] = (U8)(len >> 8);
+    SBufCopyIn(psb,0,head,SBUF_MSG_HEAD);
+    SBufCopyIn(psb,SBUF_MSG_HEAD,(const U8*)data,len);
+    SBufBarrier();
+    psb->head += SBUF_MSG_HEAD + len;   /* Publish the whole message          */
+    SBufWakeReader(psb);
+    return E_OK;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Write a message to a message buffer
+ * @param[in]  id       Message buffer ID.
+ * @param[in]  data     The message.
+ * @param[in]  len      Length of the message.
+ * @param[in]  timeout  The longest time for waitting room.
+ * @param[out] None
+ * @retval     E_OK
+ * @retval     E_INVALID_ID
+ * @retval     E_INVALID_PARAMETER
+ * @retval     E_CALL
+ * @retval     E_OS_IN_LOCK
+ * @retval     E_TIMEOUT
+ *
+ * @par Description
+ * @details    This function is called from the writer task to write a
+ *             message,waiting for room when the buffer is full.
+ *******************************************************************************
+ */
+StatusType CoSendMsgBuf(OS_SBufID id,const void* data,U16 len,U32 timeout)
+{
+    P_SBUF     psb;
+    StatusType err;
+    if(OSIntNesting > 0)                /* If the caller is ISR               */
+    {
+        return E_CALL;
+    }
+    psb = SBufGet(id,SBUF_TYPE_MESSAGE);
+    if(psb == NULL)
+    {
+        return E_INVALID_ID;
+    }
+    if(OSSchedLock != 0)                /* Judge schedule is locked or not?   */
+    {
+        return E_OS_IN_LOCK;
+    }
+    err = isr_SendMsgBuf(id,data,len);
+    if(err == E_QUEUE_FULL)
+    {
+        err = SBufWait(psb,FALSE,(U32)len + SBUF_MSG_HEAD,timeout);
+        if(err == E_OK)
+        {
+            err = isr_SendMsgBuf(id,data,len);
+        }
+    }
+    return err;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Read a message from a message buffer without waiting
+ * @param[in]  id     Message buffer ID.
+ * @param[in]  max    Size of the buffer for the message.
+ * @param[out] data   Buffer for the message.
+ * @param[out] perr   A pointer to error code.
+ * @retval     Length of the message.
+ *
+ * @par Description
+ * @details    This function is called from the reader,a task or an ISR, to
+ *             read the oldest message. A message longer than max stays in
+ *             the buffer and *perr is E_INVALID_PARAMETER.
+ *******************************************************************************
+ */
+U16 CoAcceptMsgBuf(OS_SBufID id,void* data,U16 max,StatusType* perr)
+{
+    P_SBUF psb;
+    U8     head[SBUF_MSG_HEAD];
+    U16    len;
+
+    psb = SBufGet(id,SBUF_TYPE_MESSAGE);
+    if(psb == NULL)
+    {
+        *perr = E_INVALID_ID;
+        return 0;
+    }
+    if(psb->head == psb->tail)
+    {
+        *perr = E_QUEUE_EMPTY;
+        return 0;
+    }
+    SBufBarrier();
+    SBufCopyOut(psb,0,head,SBUF_MSG_HEAD);
+    len = (U16)(head[0] | (head[1] << 8));
+    if((len > max) || ((data == NULL) && (len != 0)))
+    {
+        *perr = E_INVALID_PARAMETER;
+        return len;
+    }
+    SBufCopyOut(psb,SBUF_MSG_HEAD,(U8*)data,len);
+    SBufBarrier();
+    psb->tail += SBUF_MSG_HEAD + len;   /* Give back the room                 */
+    SBufWakeWriter(psb);
+    *perr = E_OK;
+    return len;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Read a message from a message buffer
+ * @param[in]  id       Message buffer ID.
+ * @param[in]  max      Size of the buffer for the message.
+ * @param[in]  timeout  The longest time for waitting a message.
+ * @param[out] data     Buffer for the message.
+ * @param[out] perr     A pointer to error code.
+ * @retval     Length of the message.
+ *
+ * @par Description
+ * @details    This function is called from the reader task to wait for a
+ *             message and read it, see CoAcceptMsgBuf().
+ *******************************************************************************
+ */
+U16 CoRecvMsgBuf(OS_SBufID id,void* data,U16 max,U32 timeout,
+                 StatusType* perr)
+{
+    P_SBUF psb;
+    if(OSIntNesting > 0)                /* If the caller is ISR               */
+    {
+        *perr = E_CALL;
+        return 0;
+    }
+    psb = SBufGet(id,SBUF_TYPE_MESSAGE);
+    if(psb == NULL)
+    {
+        *perr = E_INVALID_ID;
+        return 0;
+    }
+    if(OSSchedLock != 0)                /* Judge schedule is locked or not?   */
+    {
+        *perr = E_OS_IN_LOCK;
+        return 0;
+    }
+    *perr = SBufWait(psb,TRUE,SBUF_MSG_HEAD,timeout);
+    if(*perr != E_OK)
+    {
+        return 0;
+    }
+    return CoAcceptMsgBuf(id,data,max,perr);
+}
+
+#endif
@@ -16,6 +16,7 @@
 
 /*---------------------------- Include ---------------------------------------*/
 #include "coocox.h"
+#include "../bitband.h"
 
 /*---------------------------- Variable Define -------------------------------*/
 
@@ -25,6 +26,18 @@ OSTCB    TCBTbl[CFG_MAX_USER_TASKS+SYS_TASK_NUM] = {{0}};
 /*!< The stack of IDLE task.                     */
 OS_STK   idle_stk[CFG_IDLE_STACK_SIZE] = {0};
 
+/*!< Functions and stacks of the static tasks.   */
+#define OS_STATIC_TASK_STK(name,task,prio,stkSize)                             \
+    extern void task(void* pdata);                                             \
+    static OS_STK TaskStk_##name[stkSize];
+#define OS_STATIC_TASK_CREATE(name,task,prio,stkSize)                          \
+    CoCreateTask(task,NULL,prio,&TaskStk_##name[(stkSize)-1],stkSize);
+
+CFG_STATIC_TASKS(OS_STATIC_TASK_STK)
+
+/*!< Fails to compile if CFG_MAX_USER_TASKS can't hold the static tasks.      */
+typedef char StaticTaskCheck[(OS_STATIC_TASKS <= CFG_MAX_USER_TASKS) ? 1 : -1];
+
 P_OSTCB  FreeTCB     = NULL;  /*!< pointer to free TCB                        */	
 P_OSTCB  TCBRdy      = NULL;  /*!< Pointer to the READY list.                 */
 P_OSTCB  TCBNext     = NULL;  /*!< Poniter to task that next scheduled by OS  */
@@ -36,7 +49,39 @@ OS_TID   PriNum;
 U8       ActivePri[CFG_MAX_USER_TASKS+SYS_TASK_NUM];
 U8       TaskNumPerPri[CFG_MAX_USER_TASKS+SYS_TASK_NUM];
 OS_TID   RdyTaskPri[CFG_MAX_USER_TASKS+SYS_TASK_NUM] = {0};	
-U32      RdyTaskPriInfo[(CFG_MAX_USER_TASKS+SYS_TASK_NUM+31)/32];
+volatile U32 RdyTaskPriInfo[(CFG_MAX_USER_TASKS+SYS_TASK_NUM+31)/32];
+#endif
+
+#if CFG_BITMAP_SCHEDULE_EN >0
+#define  RDY_PRIO_WORDS   ((CFG_LOWEST_PRIO+32)/32)
+
+/* Bit (31-(prio&31)) of word (prio>>5) is set when the list of prio isn't
+   empty, bit (31-word) of the group when the word isn't 0, so two CLZ give
+   the highest ready PRI. The bits are set and cleared with one bit-band
+   store each,the words are volatile so they are read again after it.         */
+P_OSTCB  RdyPrioHead[CFG_LOWEST_PRIO+1];  /*!< Heads of the READY lists.      */
+P_OSTCB  RdyPrioTail[CFG_LOWEST_PRIO+1];  /*!< Tails of the READY lists.      */
+volatile U32 RdyPrioGroup;                /*!< Words of the map in use.       */
+volatile U32 RdyPrioMap[RDY_PRIO_WORDS];  /*!< PRI with a ready task.         */
+
+/**
+ *******************************************************************************
+ * @brief      Get the first task of the highest ready PRI
+ * @param[in]  None
+ * @param[out] None
+ * @retval     The TCB or NULL if no task is ready.
+ *******************************************************************************
+ */
+static P_OSTCB GetHighestRdyTask(void)
+{
+    U32 word;
+    if(RdyPrioGroup == 0)
+    {
+        return NULL;
+    }
+    word = __builtin_clz(RdyPrioGroup);
+    return RdyPrioHead[(word<<5) + __builtin_clz(RdyPrioMap[word])];
+}
 #endif
 
 
@@ -85,6 +130,25 @@ void CreateTCBList(void)
 }
 
 
+/**
+ *******************************************************************************
+ * @brief      Create the static tasks
+ * @param[in]  None 	 
+ * @param[out] None  	 
+ * @retval     None	 
+ *
+ * @par Description
+ * @details    This function is called by CoInitOS() right after the IDLE task
+ *             is created,so the tasks of CFG_STATIC_TASKS get the IDs from 1
+ *             on in list order.
+ *******************************************************************************
+ */
+void CreateStaticTasks(void)
+{
+    CFG_STATIC_TASKS(OS_STATIC_TASK_CREATE)
+}
+
+
 
 #if CFG_ORDER_LIST_SCHEDULE_EN ==0
 
@@ -271,11 +335,8 @@ static BOOL GetPrioSeqNumStatus(U8 seqNum)
  */
 static void SetPrioSeqNumStatus(U8 seqNum, BOOL isRdy)
 {
-	U32 tmp;
-	tmp = RdyTaskPriInfo[seqNum/32];
-	tmp	&= ~(1<<(seqNum%32));
-	tmp |= isRdy<<(seqNum%32);
-	RdyTaskPriInfo[seqNum/32] = tmp;
+	/* One store to the bit-band alias instead of a read-modify-write     */
+	bitband_write(&RdyTaskPriInfo[seqNum/32], seqNum%32, isRdy);
 }
 
 
@@ -367,7 +428,10 @@ void DeleteTaskPri(U8 pri)
  */
 void InsertToTCBRdyList(P_OSTCB tcbInsert)
 {
-    P_OSTCB ptcbNext,ptcb;
+    P_OSTCB ptcb;
+#if CFG_BITMAP_SCHEDULE_EN ==0
+    P_OSTCB ptcbNext;
+#endif
     U8  prio;
 #if CFG_ORDER_LIST_SCHEDULE_EN ==0
 	U8  seqNum;
@@ -380,16 +444,13 @@ void InsertToTCBRdyList(P_OSTCB tcbInsert)
 #if CFG_ROBIN_EN >0
 	ptcb = TCBRunning;
     /* Set schedule time for the same PRI task as TCBRunning.                 */
-    if(prio == ptcb->prio)  /* Is PRI of inserted task equal to running task? */
-    {
-        if(ptcb != tcbInsert) /* Yes,is inserted task equal to running task?  */
-        {
-            if(ptcb != NULL)            /* No,TCBRunning == NULL?             */
-            {                           /* N0,OSCheckTime < OSTickCnt?        */
-                if(OSCheckTime < OSTickCnt)	 
-                {                       /* Yes,set OSCheckTime for task robin */
-                    OSCheckTime = OSTickCnt + ptcb->timeSlice;	
-                }			
+    if(ptcb != NULL)                    /* TCBRunning == NULL?                */
+    {                   /* No,is PRI of inserted task equal to running task?  */
+        if((prio == ptcb->prio) && (ptcb != tcbInsert))
+        {               /* Yes,and not the running task,OSCheckTime < OSTickCnt?*/
+            if(OSCheckTime < OSTickCnt)	 
+            {                           /* Yes,set OSCheckTime for task robin */
+                OSCheckTime = OSTickCnt + ptcb->timeSlice;	
             }			
         }
     }
@@ -440,6 +501,46 @@ void InsertToTCBRdyList(P_OSTCB tcbInsert)
 	}
 
 
+#elif CFG_BITMAP_SCHEDULE_EN >0
+    ptcb = RdyPrioTail[prio];           /* Insert at tail of the PRI list     */
+#if CFG_EDF_EN >0
+    if(prio == CFG_EDF_PRIO)            /* EDF tasks go after the ones of an  */
+    {                                   /* earlier or the same deadline       */
+        while((ptcb != NULL) && EDF_BEFORE(tcbInsert,ptcb))
+        {
+            ptcb = ptcb->TCBprev;
+        }
+    }
+#endif
+    tcbInsert->rdyPrio = prio;
+    tcbInsert->TCBprev = ptcb;
+    if(ptcb == NULL)                    /* Is it the head of the PRI list?    */
+    {
+        tcbInsert->TCBnext = RdyPrioHead[prio];
+        RdyPrioHead[prio]  = tcbInsert;
+        bitband_set(&RdyPrioMap[prio>>5],31-(prio&31));
+        bitband_set(&RdyPrioGroup,31-(prio>>5));
+    }
+    else
+    {
+        tcbInsert->TCBnext = ptcb->TCBnext;
+        ptcb->TCBnext      = tcbInsert;
+    }
+    if(tcbInsert->TCBnext == NULL)      /* Is it the tail of the PRI list?    */
+    {
+        RdyPrioTail[prio] = tcbInsert;
+    }
+    else
+    {
+        tcbInsert->TCBnext->TCBprev = tcbInsert;
+    }
+    
+    /* Is PRI of inserted task higher than TCBRdy,or is it in front of it?    */
+    if((TCBRdy == NULL) || (prio < TCBRdy->prio) || (TCBRdy->TCBprev == tcbInsert))
+    {
+        TaskSchedReq = TRUE;
+        TCBRdy       = tcbInsert;
+    }
 #else
     ptcb = TCBRdy;
     if (ptcb == NULL)                   /* Is ready list NULL?                */
@@ -490,6 +591,39 @@ void InsertToTCBRdyList(P_OSTCB tcbInsert)
  */
 void RemoveFromTCBRdyList(P_OSTCB ptcb)
 {
+#if CFG_BITMAP_SCHEDULE_EN >0
+    /* The PRI may have been changed already, use the one of the list.        */
+    U8 prio = ptcb->rdyPrio;
+
+    if(ptcb->TCBprev == NULL)           /* Is the first item of the PRI list? */
+    {
+        RdyPrioHead[prio] = ptcb->TCBnext;
+    }
+    else
+    {
+        ptcb->TCBprev->TCBnext = ptcb->TCBnext;
+    }
+    if(ptcb->TCBnext == NULL)           /* Is the last item of the PRI list?  */
+    {
+        RdyPrioTail[prio] = ptcb->TCBprev;
+    }
+    else
+    {
+        ptcb->TCBnext->TCBprev = ptcb->TCBprev;
+    }
+    ptcb->TCBnext = NULL;
+    ptcb->TCBprev = NULL;
+    
+    if(RdyPrioHead[prio] == NULL)       /* Is the list of the PRI empty now?  */
+    {                                   /* Yes,mark the PRI as not ready      */
+        bitband_clear(&RdyPrioMap[prio>>5],31-(prio&31));
+        if(RdyPrioMap[prio>>5] == 0)
+        {
+            bitband_clear(&RdyPrioGroup,31-(prio>>5));
+        }
+    }
+    TCBRdy = GetHighestRdyTask();       /* Reset the head of READY list       */
+#else
 
 #if CFG_ORDER_LIST_SCHEDULE_EN ==0
 	U8 prio;
@@ -551,6 +685,7 @@ void RemoveFromTCBRdyList(P_OSTCB ptcb)
 			SetPrioSeqNumStatus(seqNum, 0);
 		}
 #endif
+#endif
 }
 
 
@@ -741,6 +876,19 @@ void Schedule(void)
         pRdyTcb->state = TASK_RUNNING;
     }
     
+#if CFG_EDF_EN >0                   /* Is an earlier deadline coming in?      */
+    else if((RunPrio == CFG_EDF_PRIO) && (RdyPrio == CFG_EDF_PRIO))
+    {
+        if(!EDF_BEFORE(pRdyTcb,pCurTcb))
+        {
+            return;                 /* No,EDF tasks don't take turns          */
+        }
+        TCBNext        = pRdyTcb;   /* Yes,set TCBNext and reorder READY list */
+        InsertToTCBRdyList(pCurTcb);
+		RemoveFromTCBRdyList(pRdyTcb);
+        pRdyTcb->state = TASK_RUNNING;
+    }
+#endif
 #if CFG_ROBIN_EN >0                 /* Is time for robinning                  */                            
     else if((RunPrio == RdyPrio) && (OSCheckTime == OSTickCnt))
     {
@@ -767,6 +915,18 @@ void Schedule(void)
         CoStkOverflowHook(pCurTcb->taskID);       /* Yes,call handler         */		
     }   
 #endif
+
+#if CFG_TASK_STATS_EN > 0
+    IRQ_DISABLE_SAVE();
+    StatsUpdate();                                /* Charge the running task  */
+    IRQ_ENABLE_RESTORE();
+    TCBNext->switches++;
+    if(pCurTcb->state == TASK_READY)              /* Switched out while ready?*/
+    {
+        pCurTcb->preempts++;
+    }
+#endif
+    TRACE_ARG(TRACE_SWITCH,pCurTcb->taskID,TCBNext->taskID);
  	
     SwitchContext();                              /* Call task context switch */
 }
@@ -860,6 +1020,12 @@ OS_TID CreateTask(FUNCPtr task,void *argv,U32 parameter,OS_STK *stk)
 		 return E_CREATE_FAIL;	
 #endif   
 
+#if CFG_STK_PAINT_EN >0
+    for(stkTopPtr = stk+1 - sktSz; stkTopPtr <= stk; stkTopPtr++)
+    {
+        *(U32*)stkTopPtr = MAGIC_WORD;  /* Paint stack for high water mark    */
+    }
+#endif
     stkTopPtr = InitTaskContext(task,argv,stk);   /* Initialize task context. */
     
     ptcb = AssignTCB();                 /* Get free TCB to use                */
@@ -875,6 +1041,9 @@ OS_TID CreateTask(FUNCPtr task,void *argv,U32 parameter,OS_STK *stk)
     ptcb->stack = stk+1 - sktSz; /* Set bottom stack for stack overflow check */
     *(U32*)(ptcb->stack) = MAGIC_WORD;
 #endif	
+#if CFG_STK_PAINT_EN >0
+    ptcb->stkSize = sktSz;
+#endif
 
 #if CFG_TASK_WAITTING_EN >0
     ptcb->delayTick	= INVALID_VALUE;	
@@ -900,6 +1069,20 @@ OS_TID CreateTask(FUNCPtr task,void *argv,U32 parameter,OS_STK *stk)
     ptcb->pnode = NULL;                 /* Initialize task as no flag waiting */
 #endif
 
+#if CFG_TASK_NOTIFY_EN > 0
+    ptcb->notifyValue = 0;              /* Initialize task as not notified    */
+    ptcb->notifyState = NOTIFY_NONE;
+#endif
+#if CFG_TASK_STATS_EN >0
+    ptcb->cycles      = 0;              /* Initialize task statistics         */
+    ptcb->switches    = 0;
+    ptcb->preempts    = 0;
+#endif
+#if CFG_EDF_EN >0
+    ptcb->edfDeadline = 0;              /* Initialize task as not EDF         */
+    ptcb->edfPeriod   = 0;
+#endif
+
 #if CFG_EVENT_EN > 0
     ptcb->eventID  = INVALID_ID;      	/* Initialize task as no event waiting*/
     ptcb->pmail    = NULL;
@@ -984,6 +1167,10 @@ StatusType CoDelTask(OS_TID taskID)
 	
 #endif	
 
+#if CFG_RWLOCK_EN >0                    /* Does task write under a rw lock?   */
+    RemoveRwLockWriter(ptcb);
+#endif	
+
     OsSchedLock();                      /* Lock schedule                      */
     
     if(ptcb->state == TASK_READY)       /* Is task in READY list?             */
@@ -1118,6 +1305,54 @@ OS_TID CoGetCurTaskID(void)
     return (TCBRunning->taskID);        /* Return running task ID             */
 }
 
+
+#if CFG_STK_PAINT_EN >0
+/**
+ *******************************************************************************
+ * @brief      Get stack high water mark of a task	  
+ * @param[in]  taskID    ID of task.
+ * @param[out] size      Words of the stack,or NULL.
+ * @retval     0         Invalid task ID.
+ * @retval     others    Most words of the stack the task has used.
+ *
+ * @par Description
+ * @details    This function is called to find out how large a stack must be.
+ *             It counts the words from the bottom of the stack that still
+ *             hold the paint of CreateTask(),the time taken grows with the
+ *             unused part of the stack. A function that reserved stack
+ *             without writing to it is not seen.
+ *******************************************************************************
+ */
+U16 CoGetStackHighWater(OS_TID taskID,U16* size)
+{
+    P_OSTCB ptcb;
+    U32*    pstk;
+    U16     unused;
+#if CFG_PAR_CHECKOUT_EN >0
+    if(taskID >= CFG_MAX_USER_TASKS + SYS_TASK_NUM)
+    {
+        return 0;
+    }
+#endif
+    ptcb = &TCBTbl[taskID];
+    if(ptcb->state == TASK_DORMANT)
+    {
+        return 0;
+    }
+    if(size != NULL)
+    {
+        *size = ptcb->stkSize;
+    }
+    pstk   = (U32*)ptcb->stack;
+    unused = 0;
+    while((unused < ptcb->stkSize) && (pstk[unused] == MAGIC_WORD))
+    {
+        unused++;
+    }
+    return (ptcb->stkSize - unused);
+}
+#endif
+
 #if CFG_TASK_SUSPEND_EN >0
 /**
  *******************************************************************************
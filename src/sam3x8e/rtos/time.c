@@ -39,6 +39,14 @@ P_OSTCB DlyList   = NULL;               /*!< Header pointer to the DELAY list.*/
  */
 void InsertDelayList(P_OSTCB ptcb,U32 ticks)
 {
+#if CFG_TMR_WHEEL_EN >0
+    if(ticks == 0)                      /* Is delay tick == 0?                */
+        return;                         /* Yes,do nothing,return              */
+    ptcb->dlyNode.type  = WHEEL_TYPE_TASK;
+    ptcb->dlyNode.owner = ptcb;
+    WheelInsert(&ptcb->dlyNode,ticks);  /* Insert into the timer wheel        */
+    ptcb->delayTick     = ticks;        /* Mark task as in DELAY list         */
+#else
     S32 deltaTicks;
     P_OSTCB dlyNext;
     
@@ -91,6 +99,7 @@ void InsertDelayList(P_OSTCB ptcb,U32 ticks)
             dlyNext = dlyNext->TCBnext; /* Get the next item in DELAY list    */
         }
     }
+#endif
 
     ptcb->state  = TASK_WAITING;        /* Set task status as TASK_WAITING    */
     TaskSchedReq = TRUE;
@@ -110,6 +119,9 @@ void InsertDelayList(P_OSTCB ptcb,U32 ticks)
  */
 void RemoveDelayList(P_OSTCB ptcb)
 {
+#if CFG_TMR_WHEEL_EN >0
+    WheelRemove(&ptcb->dlyNode);        /* Remove task from the timer wheel   */
+#else
     
     /* Is there only one item in the DELAY list?   */
     if((ptcb->TCBprev == NULL) && ( ptcb->TCBnext == NULL))
@@ -138,6 +150,7 @@ void RemoveDelayList(P_OSTCB ptcb)
         ptcb->TCBnext     	      = NULL;
         ptcb->TCBprev             = NULL;
     }
+#endif
     ptcb->delayTick = INVALID_VALUE;  /* Set task delay tick value as invalid */		
 }
 
@@ -289,8 +302,11 @@ StatusType  CoTimeDelay(U8 hour,U8 minute,U8 sec,U16 millsec)
     }	
     
     /* Get tick counter from time */
-    ticks = (U32)(((hour*3600) + (minute*60) + (sec)) * (CFG_SYSTICK_FREQ) \
-            + (millsec*CFG_SYSTICK_FREQ + 500) / 1000);
+    if(TIME_TO_TICKS(hour,minute,sec,millsec) > 0xFFFFFFFF)
+    {
+        return E_INVALID_PARAMETER;     /* Longer than the tick counter     */
+    }
+    ticks = (U32)TIME_TO_TICKS(hour,minute,sec,millsec);
     
     CoTickDelay(ticks);                 /* Call tick delay                    */
     return E_OK;                        /* Return OK                          */
@@ -311,6 +327,44 @@ StatusType  CoTimeDelay(U8 hour,U8 minute,U8 sec,U16 millsec)
  * @details    This function is called to dispose time delay of all task.  
  *******************************************************************************
  */
+#if CFG_TMR_WHEEL_EN >0
+void TimeDispose(void)
+{  
+    WheelDispose();                     /* Expire delays and timers of wheel  */
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Dispose the expiry of a task delay	 
+ * @param[in]  ptcb     Task whose delay expired.	 
+ * @param[out] None 
+ * @retval     None 
+ *
+ * @par Description
+ * @details    This function is called by the timer wheel when the delay of a
+ *             task expires.  
+ *******************************************************************************
+ */
+void DelayExpire(P_OSTCB ptcb)
+{
+#if CFG_EVENT_EN > 0
+    if(ptcb->eventID != INVALID_ID)     /* Is task in event waiting list?     */
+    {								   
+        RemoveEventWaittingList(ptcb);  /* Yes,remove task from list          */	
+    }
+#endif
+
+#if CFG_FLAG_EN  > 0
+    if(ptcb->pnode != NULL)             /* Is task in flag waiting list?      */
+    {
+        RemoveLinkNode(ptcb->pnode);    /* Yes,remove task from list          */	
+    }
+#endif
+    ptcb->delayTick = INVALID_VALUE;    /* Set delay tick value as invalid    */
+    InsertToTCBRdyList(ptcb);           /* Insert task into READY list        */
+}
+#else
 void TimeDispose(void)
 {  
     P_OSTCB	dlyList;
@@ -345,6 +399,7 @@ void TimeDispose(void)
         }
     }
 }
+#endif
 
 
 /**
@@ -21,9 +21,22 @@
 /*---------------------------- Variable Define -------------------------------*/
 #if CFG_TMR_EN > 0
 
-TmrCtrl    TmrTbl[CFG_MAX_TMR]= {{0}};/*!< Table which save timer control block.*/
+/*!< Callbacks and control blocks of the static timers.                      */
+#define OS_STATIC_TMR_FUNC(name,tmrType,tmrCnt,tmrReload,func)                 \
+    extern void func(void);
+#define OS_STATIC_TMR_TCB(name,tmrType,tmrCnt,tmrReload,func)                  \
+    [name] = { name,tmrType,TMR_STATE_STOPPED,0,tmrCnt,tmrReload,func },
+
+CFG_STATIC_TMRS(OS_STATIC_TMR_FUNC)
+TmrCtrl    TmrTbl[CFG_MAX_TMR]= {   /*!< Table which save timer control block.*/
+    CFG_STATIC_TMRS(OS_STATIC_TMR_TCB)
+};
 P_TmrCtrl  TmrList     = NULL;      /*!< The header of the TmrCtrl list.      */
-U32        TmrIDVessel = 0;         /*!< Timer ID container.                  */
+U32        TmrIDVessel = (U32)((1ull << OS_STATIC_TMRS) - 1);/*!< Timer ID container*/
+#if CFG_TMR_DAEMON_EN >0
+OS_TID     TmrDaemonID = 0;         /*!< Task ID of the timer daemon.         */
+static OS_STK TmrDaemonStk[CFG_TMR_DAEMON_STK_SIZE];/*!< Stack of the daemon  */
+#endif
 
 
 /**
@@ -40,8 +53,10 @@ U32        TmrIDVessel = 0;         /*!< Timer ID container.                  */
  */
 static void InsertTmrList(OS_TCID tmrID)
 {
+#if CFG_TMR_WHEEL_EN ==0
     P_TmrCtrl pTmr;
     S32 deltaTicks;
+#endif
     U32 tmrCnt;
     tmrCnt = TmrTbl[tmrID].tmrCnt;      /* Get timer time                     */
     
@@ -51,6 +66,11 @@ static void InsertTmrList(OS_TCID tmrID)
     }
     
     OsSchedLock();                      /* Lock schedule                      */
+#if CFG_TMR_WHEEL_EN >0
+    TmrTbl[tmrID].tmrNode.type  = WHEEL_TYPE_TMR;
+    TmrTbl[tmrID].tmrNode.owner = &TmrTbl[tmrID];
+    WheelInsert(&TmrTbl[tmrID].tmrNode,tmrCnt); /* Insert into timer wheel   */
+#else
     if(TmrList == NULL)                 /* Is no item in timer list?          */
     {
         TmrList = &TmrTbl[tmrID];       /* Yes,set this as first item         */
@@ -97,6 +117,7 @@ static void InsertTmrList(OS_TCID tmrID)
             pTmr = pTmr->tmrNext;       /* Get the next item in timer list    */	
       	}
     }
+#endif
     OsSchedUnlock();                    /* Unlock schedule                    */
 }
 
@@ -119,6 +140,9 @@ static void RemoveTmrList(OS_TCID tmrID)
     pTmr = &TmrTbl[tmrID];
     
     OsSchedLock();                      /* Lock schedule                      */
+#if CFG_TMR_WHEEL_EN >0
+    WheelRemove(&pTmr->tmrNode);        /* Remove timer from the timer wheel  */
+#else
     
     /* Is there only one item in timer list?                                  */
     if((pTmr->tmrPrev == NULL) && (pTmr->tmrNext == NULL))
@@ -146,6 +170,7 @@ static void RemoveTmrList(OS_TCID tmrID)
         pTmr->tmrNext = NULL;
         pTmr->tmrPrev = NULL;
     }
+#endif
     OsSchedUnlock();                    /* Unlock schedule                    */
 }
 
@@ -338,6 +363,12 @@ U32 CoGetCurTmrCnt(OS_TCID tmrID,StatusType* perr)
     }
 #endif
     *perr = E_OK;
+#if CFG_TMR_WHEEL_EN >0
+    if(TmrTbl[tmrID].tmrState == TMR_STATE_RUNNING)   /* Is timer running?    */
+    {
+        return WheelGetTicks(&TmrTbl[tmrID].tmrNode); /* Yes,get ticks left   */
+    }
+#endif
     return TmrTbl[tmrID].tmrCnt;        /* Return timer counter               */
 }
 
@@ -380,6 +411,87 @@ StatusType CoSetTmrCnt(OS_TCID tmrID,U32 tmrCnt,U32 tmrReload)
 }
 
 
+/**
+ *******************************************************************************
+ * @brief      Call the callback of an expired timer	   
+ * @param[in]  pTmr     Timer that expired. 	 
+ * @param[out] None	 
+ * @retval     None	 
+ *
+ * @par Description
+ * @details    This function is called with the scheduler locked,in
+ *             SysTick_Handler() or RespondSRQ(). With the timer daemon it
+ *             only sets the bit of the timer in the notification value of
+ *             the daemon,which calls the callback.
+ *******************************************************************************
+ */
+static void TmrCallBack(P_TmrCtrl pTmr)
+{
+    TRACE_ARG(TRACE_TMR_EXPIRE,pTmr->tmrID,0);
+#if CFG_TMR_DAEMON_EN >0
+    CoNotifyTask(TmrDaemonID,1u << pTmr->tmrID,NOTIFY_SET_BITS);
+#else
+    (pTmr->tmrCallBack)();
+#endif
+}
+
+
+#if CFG_TMR_DAEMON_EN >0
+/**
+ *******************************************************************************
+ * @brief      Timer daemon task	   
+ * @param[in]  pdata    Not used. 	 
+ * @param[out] None	 
+ * @retval     None	 
+ *
+ * @par Description
+ * @details    The daemon waits for its notification and calls the callbacks
+ *             of the timers whose bits are set,lowest ID first. A timer
+ *             deleted since it expired is skipped.
+ *******************************************************************************
+ */
+static void TmrDaemon(void* pdata)
+{
+    StatusType err;
+    U32        pend;
+    U8         id;
+    
+    for(;;)
+    {
+        pend = CoWaitNotify(0,&err);    /* Wait for expired timers            */
+        while(pend != 0)
+        {
+            id    = (U8)__builtin_ctz(pend);
+            pend &= pend - 1;
+            if((TmrIDVessel & (1u << id)) != 0)   /* Still created?           */
+            {
+                (TmrTbl[id].tmrCallBack)();  /* Call timer callback function  */
+            }
+        }
+    }
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Create the timer daemon	   
+ * @param[in]  None 	 
+ * @param[out] None	 
+ * @retval     None	 
+ *
+ * @par Description
+ * @details    This function is called by CoInitOS() after the static tasks.
+ *******************************************************************************
+ */
+void CreateTmrDaemon(void)
+{
+    TmrDaemonID = CoCreateTask(TmrDaemon,NULL,CFG_TMR_DAEMON_PRIO,
+                               &TmrDaemonStk[CFG_TMR_DAEMON_STK_SIZE-1],
+                               CFG_TMR_DAEMON_STK_SIZE);
+}
+#endif
+
+
 /**
  *******************************************************************************
  * @brief      Timer counter dispose	   
@@ -391,6 +503,38 @@ StatusType CoSetTmrCnt(OS_TCID tmrID,U32 tmrCnt,U32 tmrReload)
  * @details    This function is called to dispose timer counter.
  *******************************************************************************
  */
+#if CFG_TMR_WHEEL_EN >0
+void TmrDispose(void)
+{
+    WheelDispose();                     /* Expire delays and timers of wheel  */
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Dispose the expiry of a timer	   
+ * @param[in]  pTmr     Timer that expired. 	 
+ * @param[out] None	 
+ * @retval     None	 
+ *
+ * @par Description
+ * @details    This function is called by the timer wheel when a timer expires.
+ *******************************************************************************
+ */
+void TmrExpire(P_TmrCtrl pTmr)
+{
+    if(pTmr->tmrType == TMR_TYPE_ONE_SHOT)    /* Is a One-shot timer?         */
+    {
+        pTmr->tmrState = TMR_STATE_STOPPED;   /* Yes,set it as stopped        */
+    }
+    else if(pTmr->tmrType == TMR_TYPE_PERIODIC)   /* Is a periodic timer?     */
+    {
+        pTmr->tmrCnt = pTmr->tmrReload;   /* Yes,reset timer tick             */
+        InsertTmrList(pTmr->tmrID);       /* Insert timer into timer wheel    */
+    }
+    TmrCallBack(pTmr);                    /* Call timer callback function     */
+}
+#else
 void TmrDispose(void)
 {
     P_TmrCtrl	pTmr;
@@ -405,7 +549,7 @@ void TmrDispose(void)
             
             /* Set timer status as TMR_STATE_STOPPED                          */
             pTmr->tmrState = TMR_STATE_STOPPED;
-            (pTmr->tmrCallBack)();          /* Call timer callback function   */
+            TmrCallBack(pTmr);              /* Call timer callback function   */
         }
         else if(pTmr->tmrType == TMR_TYPE_PERIODIC)   /* Is a periodic timer? */
         {
@@ -413,11 +557,12 @@ void TmrDispose(void)
             RemoveTmrList(pTmr->tmrID); 
             pTmr->tmrCnt = pTmr->tmrReload;   /* Reset timer tick             */
             InsertTmrList(pTmr->tmrID);       /* Insert timer into timer list */
-            (pTmr->tmrCallBack)();            /* Call timer callback function */
+            TmrCallBack(pTmr);                /* Call timer callback function */
         }
         pTmr = TmrList;	                      /* Get first item of timer list */
     }
 }
+#endif
 
 
 /**
@@ -0,0 +1,201 @@
+/**
+ *******************************************************************************
+ * @file       trace.c
+ * @version    V1.13
+ * @date       2026.10.14
+ * @brief      kernel event trace implementation code of CooCox CoOS kernel.
+ *******************************************************************************
+ * @copy
+ *
+ * INTERNAL FILE,DON'T PUBLIC.
+ *
+ * <h2><center>&copy; COPYRIGHT 2009 CooCox </center></h2>
+ *******************************************************************************
+ */
+
+
+/*---------------------------- Include ---------------------------------------*/
+#include "coocox.h"
+
+
+#if CFG_TRACE_EN > 0
+
+#if (CFG_TRACE_SIZE & (CFG_TRACE_SIZE - 1)) != 0
+#error "CFG_TRACE_SIZE must be a power of two"
+#endif
+
+#define TRACE_MASK  (CFG_TRACE_SIZE - 1)
+
+/*---------------------------- Variable Define -------------------------------*/
+TRACE_REC     TraceBuf[CFG_TRACE_SIZE]; /*!< Ring buffer of records           */
+volatile U32  TraceHead = 0;            /*!< Records logged                   */
+volatile U32  TraceTail = 0;            /*!< Records read out                 */
+U32           TraceLost = 0;            /*!< Records dropped since the last   */
+
+
+/*!< Save the interrupt mask and mask the interrupts of the kernel,the trace
+     may be logged with them masked already.                                  */
+static inline U32 TraceLock(void)
+{
+    U32 mask;
+#if CFG_MAX_SYSCALL_PRIO > 0
+    __asm volatile (" MRS %0, BASEPRI \n MSR BASEPRI_MAX, %1 \n"
+                    : "=&r" (mask) : "r" (OS_BASEPRI) : "memory");
+#else
+    __asm volatile (" MRS %0, PRIMASK \n CPSID I \n" : "=r" (mask) :: "memory");
+#endif
+    return mask;
+}
+
+static inline void TraceUnlock(U32 mask)
+{
+#if CFG_MAX_SYSCALL_PRIO > 0
+    __asm volatile (" MSR BASEPRI, %0 \n" :: "r" (mask) : "memory");
+#else
+    __asm volatile (" MSR PRIMASK, %0 \n" :: "r" (mask) : "memory");
+#endif
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Start the trace
+ * @param[in]  None
+ * @param[out] None
+ * @retval     None
+ *
+ * @par Description
+ * @details    This function is called by CoInitOS() to start the DWT cycle
+ *             counter that stamps the records.
+ *******************************************************************************
+ */
+void TraceStart(void)
+{
+    NVIC_DEMCR |= NVIC_DEMCR_TRCENA;    /* Enable the DWT                     */
+    DWT_CTRL   |= DWT_CTRL_CYCCNTENA;   /* Start the cycle counter            */
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Log an event
+ * @param[in]  event    TRACE_xxx.
+ * @param[in]  id       Object the event is about.
+ * @param[in]  arg      Argument of the event.
+ * @param[out] None
+ * @retval     None
+ *
+ * @par Description
+ * @details    This function is called by the kernel through TRACE() and
+ *             TRACE_ARG(),from tasks and ISRs. If the buffer is full the
+ *             record is dropped and counted.
+ *******************************************************************************
+ */
+void TraceEvent(U8 event,U8 id,U16 arg)
+{
+    U32         mask,head,need;
+    P_TRACE_REC prec;
+
+    mask    = TraceLock();
+    head    = TraceHead;
+    need    = (TraceLost != 0) ? 2 : 1; /* Room for a TRACE_LOST record too?  */
+    if(CFG_TRACE_SIZE - (head - TraceTail) < need)
+    {
+        TraceLost++;                    /* Buffer full,drop the record        */
+        TraceUnlock(mask);
+        return;
+    }
+    if(need == 2)
+    {
+        prec        = &TraceBuf[head & TRACE_MASK];
+        prec->time  = DWT_CYCCNT;
+        prec->event = TRACE_LOST;
+        prec->id    = 0;
+        prec->arg   = (TraceLost > 0xFFFF) ? 0xFFFF : (U16)TraceLost;
+        TraceLost   = 0;
+        head++;
+    }
+    prec        = &TraceBuf[head & TRACE_MASK];
+    prec->time  = DWT_CYCCNT;
+    prec->event = event;
+    prec->id    = id;
+    prec->arg   = arg;
+    TraceHead   = head + 1;
+    TraceUnlock(mask);
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Log an event of the application
+ * @param[in]  event    TRACE_USER to 0xFF.
+ * @param[in]  id       Free for the application.
+ * @param[in]  arg      Free for the application.
+ * @param[out] None
+ * @retval     E_INVALID_PARAMETER  event is a kernel event.
+ * @retval     E_OK                 Event logged or counted as dropped.
+ *
+ * @par Description
+ * @details    This function is called by tasks and ISRs to mark their own
+ *             events in the trace.
+ *******************************************************************************
+ */
+StatusType CoTraceEvent(U8 event,U8 id,U16 arg)
+{
+    if(event < TRACE_USER)
+    {
+        return E_INVALID_PARAMETER;
+    }
+    TraceEvent(event,id,arg);
+    return E_OK;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Get the oldest records
+ * @param[in]  None
+ * @param[out] rec      The first record.
+ * @retval     The number of records that follow each other in memory from
+ *             rec,0 if the trace is empty.
+ *
+ * @par Description
+ * @details    This function is called by the one reader of the trace. The
+ *             records stay valid until CoTraceFree() is called,so they can be
+ *             sent with DMA without copying. Records that wrap around the end
+ *             of the buffer are returned by the next call.
+ *******************************************************************************
+ */
+U32 CoTracePeek(void** rec)
+{
+    U32 tail,count;
+    tail  = TraceTail;
+    count = TraceHead - tail;
+    if(count > CFG_TRACE_SIZE - (tail & TRACE_MASK))
+    {
+        count = CFG_TRACE_SIZE - (tail & TRACE_MASK);
+    }
+    *rec = &TraceBuf[tail & TRACE_MASK];
+    return count;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Free the oldest records
+ * @param[in]  count    Records that have been read,as many as CoTracePeek()
+ *                      returned at most.
+ * @param[out] None
+ * @retval     None
+ *
+ * @par Description
+ * @details    This function is called by the reader of the trace to give the
+ *             room of the records back to the writers.
+ *******************************************************************************
+ */
+void CoTraceFree(U32 count)
+{
+    TraceTail = TraceTail + count;
+}
+
+#endif
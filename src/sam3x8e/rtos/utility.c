@@ -39,10 +39,11 @@ void CoTickToTime(U32 ticks,U8* hour,U8* minute,U8* sec,U16* millsec)
 {
     U32 totalTime;
     
-    /* Convert ticks to time*/
-    totalTime = ticks * (1000/CFG_SYSTICK_FREQ);
-    *millsec  = (U16) (totalTime % 1000);
-    totalTime = totalTime/1000;
+    /* Convert ticks to time,exact for any tick rate and tick count. The
+       divisions are by constants,so they compile to multiply-shifts.        */
+    totalTime = ticks / CFG_SYSTICK_FREQ;
+    *millsec  = (U16) ((ticks - totalTime*CFG_SYSTICK_FREQ) * 1000 
+                       / CFG_SYSTICK_FREQ);
     *sec      = (U8) (totalTime % 60);
     totalTime = totalTime/60;
     *minute   = (U8) (totalTime % 60);
@@ -77,8 +78,11 @@ StatusType  CoTimeToTick(U8 hour,U8 minute,U8 sec,U16 millsec,U32* ticks)
 #endif
 
     /* Convert time to ticks */
-    *ticks = (U32)(((hour*3600) + (minute*60) + (sec)) * (CFG_SYSTICK_FREQ)\
-              + (millsec*CFG_SYSTICK_FREQ + 500)/1000);
+    if(TIME_TO_TICKS(hour,minute,sec,millsec) > 0xFFFFFFFF)
+    {
+        return E_INVALID_PARAMETER;     /* Longer than the tick counter       */
+    }
+    *ticks = (U32)TIME_TO_TICKS(hour,minute,sec,millsec);
     return E_OK;
 }
 #endif    /* CFG_TIME_TO_TICK_EN  */
@@ -0,0 +1,254 @@
+/**
+ *******************************************************************************
+ * @file       wheel.c
+ * @version    V1.13    
+ * @date       2026.10.14
+ * @brief      timer wheel implementation code of CooCox CoOS kernel.	
+ *******************************************************************************
+ * @copy
+ *
+ * INTERNAL FILE,DON'T PUBLIC.
+ * 
+ * <h2><center>&copy; COPYRIGHT 2009 CooCox </center></h2>
+ *******************************************************************************
+ */ 
+
+
+/*---------------------------- Include ---------------------------------------*/
+#include "coocox.h"
+
+#if CFG_TMR_WHEEL_EN >0
+
+/*---------------------------- Variable Define -------------------------------*/
+/*!< Slot heads,level L covers expiries up to 2^(WHEEL_BITS*(L+1)) ticks.    */
+P_WHEEL_NODE  WheelSlot[WHEEL_LEVELS][WHEEL_SIZE];
+U32           WheelTime  = 0;           /*!< Tick the wheel has reached.      */
+U32           WheelCount = 0;           /*!< Number of nodes in the wheel.    */
+
+
+/**
+ *******************************************************************************
+ * @brief      Put a node in the slot of its expiry	 
+ * @param[in]  node     The node,with its expiry set.	 
+ * @param[out] None   
+ * @retval     None	 	 
+ *
+ * @par Description
+ * @details    This function is called to link a node into the lowest level
+ *             that covers its expiry from WheelTime.Expiries beyond the
+ *             range go to the top level and come back down when their slot
+ *             is cascaded.
+ *******************************************************************************
+ */
+static void WheelPlace(P_WHEEL_NODE node)
+{
+    U32 delta;
+    U8  level;
+    P_WHEEL_NODE *slot;
+    
+    delta = node->expire - WheelTime;
+    for(level = 0; level < WHEEL_LEVELS - 1; level++)
+    {
+        if(delta < (1u << (WHEEL_BITS * (level + 1))))
+            break;
+    }
+    slot = &WheelSlot[level][(node->expire >> (WHEEL_BITS * level)) & WHEEL_MASK];
+    
+    node->prev = NULL;                  /* Insert at head of the slot         */
+    node->next = *slot;
+    if(*slot != NULL)
+    {
+        (*slot)->prev = node;
+    }
+    *slot      = node;
+    node->slot = slot;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Unlink a node from its slot	 
+ * @param[in]  node     The node.	 
+ * @param[out] None   
+ * @retval     None	 	 
+ *******************************************************************************
+ */
+static void WheelUnlink(P_WHEEL_NODE node)
+{
+    if(node->prev == NULL)              /* Is the first item of the slot?     */
+    {
+        *node->slot = node->next;
+    }
+    else
+    {
+        node->prev->next = node->next;
+    }
+    if(node->next != NULL)
+    {
+        node->next->prev = node->prev;
+    }
+    node->next = NULL;
+    node->prev = NULL;
+    node->slot = NULL;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Insert a node into the timer wheel	 
+ * @param[in]  node     The node,its type and owner set.	 
+ * @param[in]  ticks    Ticks to the expiry (>0).	 
+ * @param[out] None   
+ * @retval     None	 	 
+ *
+ * @par Description
+ * @details    This function is called,with the scheduler locked,to start
+ *             the delay of a task or a timer.The expiry is counted from
+ *             OSTickCnt,so ticks the wheel has still to catch up on count.
+ *******************************************************************************
+ */
+void WheelInsert(P_WHEEL_NODE node,U32 ticks)
+{
+    node->expire = (U32)OSTickCnt + ticks;
+    WheelPlace(node);
+    WheelCount++;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Remove a node from the timer wheel	 
+ * @param[in]  node     The node.	 
+ * @param[out] None   
+ * @retval     None	 	 
+ *
+ * @par Description
+ * @details    This function is called,with the scheduler locked,to cancel
+ *             a delay.It does nothing if the node isn't in the wheel.
+ *******************************************************************************
+ */
+void WheelRemove(P_WHEEL_NODE node)
+{
+    if(node->slot == NULL)              /* Is the node in the wheel?          */
+    {
+        return;                         /* No,do nothing                      */
+    }
+    WheelUnlink(node);
+    WheelCount--;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Get the ticks left to the expiry of a node	 
+ * @param[in]  node     The node.	 
+ * @param[out] None   
+ * @retval     The ticks left,0 if the node isn't in the wheel.	 	 
+ *******************************************************************************
+ */
+U32 WheelGetTicks(P_WHEEL_NODE node)
+{
+    if(node->slot == NULL)
+    {
+        return 0;
+    }
+    return node->expire - (U32)OSTickCnt;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Get the ticks to the next tick that has work	 
+ * @param[in]  None	 
+ * @param[out] None   
+ * @retval     Ticks to the next expiry or cascade,INVALID_VALUE if the wheel
+ *             is empty.	 	 
+ *
+ * @par Description
+ * @details    This function is called by the tickless IDLE task.It scans at
+ *             most the WHEEL_SIZE slots of the first level.
+ *******************************************************************************
+ */
+U32 WheelNextTicks(void)
+{
+    U32 ticks,time;
+    
+    if(WheelCount == 0)                 /* Is the wheel empty?                */
+    {
+        return INVALID_VALUE;
+    }
+    if(WheelTime != (U32)OSTickCnt)     /* Are ticks left to catch up on?     */
+    {
+        return 1;
+    }
+    for(ticks = 1; ticks < WHEEL_SIZE; ticks++)
+    {
+        time = WheelTime + ticks;
+        if(((time & WHEEL_MASK) == 0) || (WheelSlot[0][time & WHEEL_MASK] != NULL))
+            break;
+    }
+    return ticks;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Dispose the timer wheel	 
+ * @param[in]  None	 
+ * @param[out] None 
+ * @retval     None 
+ *
+ * @par Description
+ * @details    This function is called to bring the wheel up to OSTickCnt.
+ *             At every tick the slots of the upper levels that come around
+ *             are cascaded,then the nodes of the first level slot expire.
+ *******************************************************************************
+ */
+void WheelDispose(void)
+{
+    P_WHEEL_NODE node,next;
+    P_WHEEL_NODE *slot;
+    U8  level;
+    
+    while(WheelTime != (U32)OSTickCnt)
+    {
+        WheelTime++;
+        
+        /* Move the nodes of the upper slots that come around down a level    */
+        for(level = 1; level < WHEEL_LEVELS; level++)
+        {
+            if((WheelTime & ((1u << (WHEEL_BITS * level)) - 1)) != 0)
+                break;
+            slot  = &WheelSlot[level][(WheelTime >> (WHEEL_BITS * level)) & WHEEL_MASK];
+            node  = *slot;
+            *slot = NULL;
+            while(node != NULL)
+            {
+                next = node->next;
+                WheelPlace(node);
+                node = next;
+            }
+        }
+        
+        /* All the nodes of the first level slot expire now                   */
+        slot = &WheelSlot[0][WheelTime & WHEEL_MASK];
+        while(*slot != NULL)
+        {
+            node = *slot;
+            WheelUnlink(node);
+            WheelCount--;
+            if(node->type == WHEEL_TYPE_TASK)
+            {
+                DelayExpire((P_OSTCB)node->owner);
+            }
+#if CFG_TMR_EN > 0
+            else
+            {
+                TmrExpire((P_TmrCtrl)node->owner);
+            }
+#endif
+        }
+    }
+}
+
+#endif
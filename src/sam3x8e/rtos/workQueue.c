@@ -0,0 +1,227 @@
+/**
+ *******************************************************************************
+ * @file       workQueue.c
+ * @version    V1.13
+ * @date       2026.10.14
+ * @brief      Work queue implementation code of CooCox CoOS kernel.
+ *******************************************************************************
+ * @copy
+ *
+ * INTERNAL FILE,DON'T PUBLIC.
+ *
+ * <h2><center>&copy; COPYRIGHT 2009 CooCox </center></h2>
+ *******************************************************************************
+ */
+
+
+/*---------------------------- Include ---------------------------------------*/
+#include "coocox.h"
+
+
+#if CFG_WORK_QUEUE_EN > 0
+/*---------------------------- Variable Define -------------------------------*/
+WORKER      WorkerTbl[CFG_MAX_WORKER] = {{0}};  /*!< Worker table             */
+OS_WorkerID WorkerFreeID = 0;           /*!< Point to next valid worker ID.   */
+
+/* Keeps the compiler from moving the copy of an item past the index.         */
+#define WorkBarrier()   __asm volatile ("" ::: "memory")
+
+
+/**
+ *******************************************************************************
+ * @brief      Worker task
+ * @param[in]  pdata   Worker ID.
+ * @param[out] None
+ * @retval     None
+ *
+ * @par Description
+ * @details    A worker waits on its semaphore and runs one item per post.
+ *             Only the worker moves head,so it takes an item without
+ *             disabling interrupts.
+ *******************************************************************************
+ */
+static void WorkerTask(void* pdata)
+{
+    P_WORKER  pw;
+    WORK_ITEM work;
+
+    pw = &WorkerTbl[(U32)pdata];
+    for(;;)
+    {
+        CoPendSem(pw->semID,0);         /* Wait for an item                   */
+        work = pw->item[pw->head & WORK_MASK];
+        WorkBarrier();
+        pw->head++;                     /* Free the cell of the item          */
+        work.func(work.arg);            /* Run the item                       */
+    }
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Put an item in the queue of a worker
+ * @param[in]  pw      Worker.
+ * @param[in]  func    Function to call.
+ * @param[in]  arg     Its argument.
+ * @param[out] None
+ * @retval     TRUE    Item queued.
+ * @retval     FALSE   The queue is full.
+ *******************************************************************************
+ */
+static BOOL PutWork(P_WORKER pw,FUNCPtr func,void* arg)
+{
+    P_WORK_ITEM pitem;
+
+    IRQ_DISABLE_SAVE();                 /* Tasks and ISRs queue items         */
+    if((pw->tail - pw->head) == CFG_WORK_QUEUE_SIZE)
+    {
+        IRQ_ENABLE_RESTORE();
+        return FALSE;
+    }
+    pitem       = &pw->item[pw->tail & WORK_MASK];
+    pitem->func = func;
+    pitem->arg  = arg;
+    pw->tail++;
+    IRQ_ENABLE_RESTORE();
+    return TRUE;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Create a worker
+ * @param[in]  prio      Priority of the worker task.
+ * @param[in]  stk       Top of the stack of the worker task.
+ * @param[in]  stkSize   Words of the stack.
+ * @param[out] None
+ * @retval     E_CREATE_FAIL  Create worker fail.
+ * @retval     others         Create worker successful.
+ *
+ * @par Description
+ * @details    This function is called to create a worker task and its queue.
+ *             It uses one task and one semaphore.
+ *******************************************************************************
+ */
+OS_WorkerID CoCreateWorker(U8 prio,OS_STK* stk,U16 stkSize)
+{
+    OS_WorkerID id;
+    P_WORKER    pw;
+    OS_EventID  semID;
+    OS_TID      taskID;
+
+    OsSchedLock();
+    if(WorkerFreeID >= CFG_MAX_WORKER)  /* Is there a free worker?            */
+    {
+        OsSchedUnlock();
+        return E_CREATE_FAIL;           /* No,error return                    */
+    }
+    id    = WorkerFreeID;
+    pw    = &WorkerTbl[id];
+    semID = CoCreateSem(0,CFG_WORK_QUEUE_SIZE,EVENT_SORT_TYPE_FIFO);
+    if(semID == E_CREATE_FAIL)
+    {
+        OsSchedUnlock();
+        return E_CREATE_FAIL;
+    }
+    pw->head  = 0;                      /* Initialize the queue as empty      */
+    pw->tail  = 0;
+    pw->semID = semID;
+
+    /* The task starts once the scheduler is unlocked                         */
+    taskID = CoCreateTask(WorkerTask,(void*)(U32)id,prio,stk,stkSize);
+    if(taskID == E_CREATE_FAIL)
+    {
+        CoDelSem(semID,OPT_DEL_ANYWAY);
+        OsSchedUnlock();
+        return E_CREATE_FAIL;
+    }
+    pw->taskID = taskID;
+    WorkerFreeID++;
+    OsSchedUnlock();
+    return id;
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Queue an item to a worker
+ * @param[in]  id      Worker ID.
+ * @param[in]  func    Function the worker calls.
+ * @param[in]  arg     Argument of the function.
+ * @param[out] None
+ * @retval     E_INVALID_ID         Invalid worker ID.
+ * @retval     E_INVALID_PARAMETER  func is NULL.
+ * @retval     E_QUEUE_FULL         The queue of the worker is full.
+ * @retval     E_OK                 Item queued.
+ *
+ * @par Description
+ * @details    This function is called by a task to have func(arg) run by a
+ *             worker,after the items queued to it before.
+ *******************************************************************************
+ */
+StatusType CoQueueWork(OS_WorkerID id,FUNCPtr func,void* arg)
+{
+    P_WORKER pw;
+
+#if CFG_PAR_CHECKOUT_EN >0
+    if(id >= WorkerFreeID)
+    {
+        return E_INVALID_ID;
+    }
+    if(func == NULL)
+    {
+        return E_INVALID_PARAMETER;
+    }
+#endif
+    pw = &WorkerTbl[id];
+    if(PutWork(pw,func,arg) == FALSE)
+    {
+        return E_QUEUE_FULL;
+    }
+    return CoPostSem(pw->semID);        /* Wake the worker                    */
+}
+
+
+/**
+ *******************************************************************************
+ * @brief      Queue an item to a worker in ISR
+ * @param[in]  id      Worker ID.
+ * @param[in]  func    Function the worker calls.
+ * @param[in]  arg     Argument of the function.
+ * @param[out] None
+ * @retval     E_INVALID_ID         Invalid worker ID.
+ * @retval     E_INVALID_PARAMETER  func is NULL.
+ * @retval     E_QUEUE_FULL         The queue of the worker is full.
+ * @retval     E_OK                 Item queued.
+ *
+ * @par Description
+ * @details    This function is called in ISR to defer work to a worker. The
+ *             semaphore of the worker is posted through the service request
+ *             queue,where the posts are merged,so it can't fill up.
+ *******************************************************************************
+ */
+#if CFG_MAX_SERVICE_REQUEST > 0
+StatusType isr_QueueWork(OS_WorkerID id,FUNCPtr func,void* arg)
+{
+    P_WORKER pw;
+
+#if CFG_PAR_CHECKOUT_EN >0
+    if(id >= WorkerFreeID)
+    {
+        return E_INVALID_ID;
+    }
+    if(func == NULL)
+    {
+        return E_INVALID_PARAMETER;
+    }
+#endif
+    pw = &WorkerTbl[id];
+    if(PutWork(pw,func,arg) == FALSE)
+    {
+        return E_QUEUE_FULL;
+    }
+    return isr_PostSem(pw->semID);      /* Wake the worker                    */
+}
+#endif
+
+#endif
@@ -0,0 +1,60 @@
+/*
+ * smc.c
+ *
+ * Date:	14 October 2026
+ */
+
+#include "smc.h"
+#include "id.h"
+#include "pmc.h"
+
+// Chip selects set up by smc_init_cs(), each holds the peripheral clock
+static uint32_t configured;
+
+uint8_t smc_init_cs(uint32_t cs, const smc_settings_t *settings) {
+	smc_cs_reg_t *reg;
+	uint32_t mode = SMC_MODE_READ_MODE | SMC_MODE_WRITE_MODE;
+
+	if (cs >= SMC_CHIP_SELECTS || settings->bus_width > SMC_BUS_16 ||
+		settings->nwe_setup > 0x3Fu || settings->nrd_setup > 0x3Fu ||
+		settings->nwe_pulse == 0 || settings->nwe_pulse > 0x7Fu ||
+		settings->nrd_pulse == 0 || settings->nrd_pulse > 0x7Fu ||
+		settings->nwe_cycle > 0x7Fu || settings->nrd_cycle > 0x7Fu ||
+		settings->nwe_cycle < settings->nwe_setup + settings->nwe_pulse ||
+		settings->nrd_cycle < settings->nrd_setup + settings->nrd_pulse) {
+		return 0;
+	}
+	if (!(configured & (1u << cs))) {
+		pmc_acquire_peripheral_clock(ID_SMC_SDRAMC);
+		configured |= (1u << cs);
+	}
+	if (settings->bus_width == SMC_BUS_16) {
+		mode |= SMC_MODE_DBW_16;
+	}
+	reg = &SMC->SMC_CS[cs];
+	// NCS is active from the start to the end of each cycle
+	reg->SMC_SETUP = SMC_SETUP_NWE_SETUP(settings->nwe_setup) |
+			SMC_SETUP_NRD_SETUP(settings->nrd_setup);
+	reg->SMC_PULSE = SMC_PULSE_NWE_PULSE(settings->nwe_pulse) |
+			SMC_PULSE_NCS_WR_PULSE(settings->nwe_cycle) |
+			SMC_PULSE_NRD_PULSE(settings->nrd_pulse) |
+			SMC_PULSE_NCS_RD_PULSE(settings->nrd_cycle);
+	reg->SMC_CYCLE = SMC_CYCLE_NWE_CYCLE(settings->nwe_cycle) |
+			SMC_CYCLE_NRD_CYCLE(settings->nrd_cycle);
+	reg->SMC_MODE = mode;
+	return 1;
+}
+
+void smc_deinit_cs(uint32_t cs) {
+	if (cs < SMC_CHIP_SELECTS && (configured & (1u << cs))) {
+		configured &= ~(1u << cs);
+		pmc_release_peripheral_clock(ID_SMC_SDRAMC);
+	}
+}
+
+uint32_t smc_ns_to_cycles(uint32_t ns, uint32_t mck) {
+	uint32_t cycles = (uint32_t) (((uint64_t) ns * mck + 999999999u) /
+			1000000000u);
+
+	return cycles ? cycles : 1;
+}
@@ -0,0 +1,152 @@
+/**
+ * @file smc.h
+ * @brief SMC - Static Memory Controller
+ * @details The SMC drives the external bus interface (EBI): an access to
+ * the memory window of a chip select becomes a bus cycle with the data on
+ * D0-D7 (D0-D15 with a 16-bit bus), the address on A0-A23, the chip select
+ * NCS0-NCS3 and the strobes NWE and NRD, all timed by the SMC. A store to the
+ * window is one write cycle, so a device like the controller of a TFT can be
+ * written with plain stores or by the DMAC.
+ *
+ * The timings are counted in cycles of the master clock. A write cycle of
+ * nwe_cycle cycles lowers NWE nwe_setup cycles after the address and NCS are
+ * set and keeps it low for nwe_pulse cycles, the data is latched by the
+ * device when NWE rises. NCS stays low for the whole cycle, which is why a
+ * cycle is limited to the 127 cycles of its pulse.
+ *
+ * @pre The EBI pins must be given to peripheral A with the PIO (e.g. D0-D7
+ * on PC2-PC9 and NWE on PC18), and the chip select and address lines that
+ * are used.
+ * @date 14 October 2026
+ */
+
+#ifndef SMC_H_
+#define SMC_H_
+
+#include <inttypes.h>
+#include "periph.h"
+
+///@cond
+// Pointer to registers of the SMC, base address 0x400E0000
+#define SMC ((smc_reg_t *) PERIPH_ADDR(0x400E0000U))
+
+#define SMC_SETUP_NWE_SETUP(x)		((x) & 0x3Fu)
+#define SMC_SETUP_NCS_WR_SETUP(x)	(((x) & 0x3Fu) << 8)
+#define SMC_SETUP_NRD_SETUP(x)		(((x) & 0x3Fu) << 16)
+#define SMC_SETUP_NCS_RD_SETUP(x)	(((x) & 0x3Fu) << 24)
+#define SMC_PULSE_NWE_PULSE(x)		((x) & 0x7Fu)
+#define SMC_PULSE_NCS_WR_PULSE(x)	(((x) & 0x7Fu) << 8)
+#define SMC_PULSE_NRD_PULSE(x)		(((x) & 0x7Fu) << 16)
+#define SMC_PULSE_NCS_RD_PULSE(x)	(((x) & 0x7Fu) << 24)
+#define SMC_CYCLE_NWE_CYCLE(x)		((x) & 0x1FFu)
+#define SMC_CYCLE_NRD_CYCLE(x)		(((x) & 0x1FFu) << 16)
+#define SMC_MODE_READ_MODE			(0x1u << 0)
+#define SMC_MODE_WRITE_MODE			(0x1u << 1)
+#define SMC_MODE_DBW_16				(0x1u << 12)
+///@endcond
+
+/// Number of chip selects
+#define SMC_CHIP_SELECTS	(4u)
+
+/**
+ * Start of the memory window of a chip select, 16 MB each.
+ * @param cs The chip select (0-3).
+ */
+#define SMC_CS_ADDR(cs)		(0x60000000u + ((uint32_t) (cs) << 24))
+
+///@{
+/**
+ * Width of the data bus (see smc_settings_t).
+ */
+#define SMC_BUS_8			(0)	///< D0-D7
+#define SMC_BUS_16			(1)	///< D0-D15
+///@}
+
+///@cond
+/*
+ * Timing registers of one chip select
+ */
+typedef struct smc_cs_reg {
+	// Setup Register, offset 0x0070 + cs * 0x14
+	uint32_t SMC_SETUP;
+	// Pulse Register, offset 0x0074 + cs * 0x14
+	uint32_t SMC_PULSE;
+	// Cycle Register, offset 0x0078 + cs * 0x14
+	uint32_t SMC_CYCLE;
+	// Timings Register, offset 0x007C + cs * 0x14
+	uint32_t SMC_TIMINGS;
+	// Mode Register, offset 0x0080 + cs * 0x14
+	uint32_t SMC_MODE;
+} smc_cs_reg_t;
+
+/*
+ * Mapping of the SMC registers, the NAND Flash Controller part is left out
+ * Base address: 0x400E0000
+ */
+typedef struct smc_reg {
+	// SMC NFC Configuration Register, offset 0x0000
+	uint32_t SMC_CFG;
+	// SMC NFC Control Register, offset 0x0004
+	uint32_t SMC_CTRL;
+	// SMC NFC Status Register, offset 0x0008
+	uint32_t SMC_SR;
+	// reserved, offset 0x000C-0x006C
+	uint32_t reserved1[25];
+	// Chip select timings, offset 0x0070-0x010C
+	smc_cs_reg_t SMC_CS[8];
+	// reserved, offset 0x0110-0x01E0
+	uint32_t reserved2[53];
+	// Write Protect Mode Register, offset 0x01E4
+	uint32_t SMC_WPMR;
+	// Write Protect Status Register, offset 0x01E8
+	uint32_t SMC_WPSR;
+} smc_reg_t;
+///@endcond
+
+/**
+ * Timings and bus of a chip select, in cycles of the master clock.
+ */
+typedef struct smc_settings {
+	/** Width of the data bus, use prefix: SMC_BUS_ */
+	uint32_t bus_width;
+	/** Cycles from the address and NCS to the fall of NWE (0-63) */
+	uint32_t nwe_setup;
+	/** Cycles NWE is low (1-127) */
+	uint32_t nwe_pulse;
+	/** Cycles of a whole write, at least nwe_setup + nwe_pulse (1-127) */
+	uint32_t nwe_cycle;
+	/** Cycles from the address and NCS to the fall of NRD (0-63) */
+	uint32_t nrd_setup;
+	/** Cycles NRD is low (1-127) */
+	uint32_t nrd_pulse;
+	/** Cycles of a whole read, at least nrd_setup + nrd_pulse (1-127) */
+	uint32_t nrd_cycle;
+} smc_settings_t;
+
+/**
+ * Sets up a chip select: NCS follows the whole cycle, the writes are
+ * controlled by NWE and the reads by NRD. The peripheral clock of the SMC
+ * is acquired for the first setup of the chip select.
+ * @param cs The chip select (0-3).
+ * @param settings The bus and the timings.
+ * @return error (1 = SUCCESS, 0 = FAIL, invalid chip select or timings)
+ */
+uint8_t smc_init_cs(uint32_t cs, const smc_settings_t *settings);
+
+/**
+ * Releases the peripheral clock of the SMC acquired by smc_init_cs() for a
+ * chip select.
+ * @param cs The chip select (0-3).
+ */
+void smc_deinit_cs(uint32_t cs);
+
+/**
+ * Gets the cycles of the master clock for a time, rounded up, to fill in
+ * smc_settings_t.
+ * @param ns The time in nanoseconds.
+ * @param mck Master clock frequency (Hz).
+ * @return The number of cycles, at least 1.
+ */
+uint32_t smc_ns_to_cycles(uint32_t ns, uint32_t mck);
+
+#endif
@@ -22,45 +22,69 @@
  */
 
 #include "spi.h"
+#include "dmac.h"
+#include "id.h"
+#include "io_req.h"
+#include "irq.h"
+
+// NVIC Interrupt Set/Clear-Enable Registers, one bit per peripheral ID
+#define NVIC_ISER(id)	(((volatile uint32_t *) PERIPH_ADDR(0xE000E100U))[(id) >> 5])
+#define NVIC_ICER(id)	(((volatile uint32_t *) PERIPH_ADDR(0xE000E180U))[(id) >> 5])
+
+// Sent when no transmit buffer is given
+static const uint16_t dummy_tx = 0xFFFFu;
+// Received words are written here when no receive buffer is given
+static uint32_t dummy_rx;
+static spi_callback_t transfer_callback;
+// Completed when the transfer of spi_transfer_req() is done
+static io_req_t *transfer_req;
+// The DMAC channels of spi_transfer() are claimed
+static uint8_t dmac_claimed;
+// Interrupt handlers of SPI0 and SPI1
+static spi_handler_t handlers[2];
+
+// The slave of spi_slave_start()
+static struct {
+	spi_slave_settings_t settings;
+	uint32_t csr;
+	uint8_t width;
+	// buffer of the frame in progress
+	uint8_t filling;
+	const void *reply;
+	uint32_t reply_len;
+	spi_slave_stats_t stats;
+} slave;
+
+// keep dmac_channel_alloc() off the channels of spi_transfer()
+static void claim_dmac_channels(void) {
+	if (!dmac_claimed) {
+		(void) dmac_channel_claim(SPI_DMAC_TX_CHANNEL);
+		(void) dmac_channel_claim(SPI_DMAC_RX_CHANNEL);
+		dmac_claimed = 1;
+	}
+}
 
 uint8_t spi_init(spi_reg_t *spi, const spi_settings_t *settings) {
-	// These settings are not implemented in this API and are therefore
-	// hardcoded to the following:
-	// -> set to master
-	spi->SPI_MR |= (0x1U << 0);
-	// -> set to fixed peripheral select
-	spi->SPI_MR &= ~(0x1U << 1);
-	// -> set chip select decoding 'off'
-	spi->SPI_MR &= ~(0x1U << 2);
-	// -> set mode fault detection 'off'
-	spi->SPI_MR |= (0x1U << 4);
-	// -> set Wait Data Read Before Transfer 'off' (send data at any time)
-	spi->SPI_MR &= ~(0x1U << 5);
-
-	// set Delay Between Chip Selects
-	spi_set_delay_between_cs(spi, settings->delay_between_cs);
-	// Initially select none of the selectors (slaves)
-	spi_select_slave(spi, SPI_SELECTOR_NONE);
+	// Master, mode fault detection 'off', Wait Data Read Before Transfer
+	// 'off' (send data at any time) and initially none of the selectors
+	// (slaves) selected, keeping the loopback mode
+	spi->SPI_MR = (spi->SPI_MR & SPI_MR_LLB_MASK) | spi_mr_value(settings);
+	claim_dmac_channels();
 	return 1;
 }
 
 uint8_t spi_init_selector(spi_reg_t *spi,
 		const spi_selector_settings_t *settings) {
-	// Set the clock polarity for the transfer
-	spi_set_selector_clk_polarity(spi, settings->selector, settings->CPOL);
-	// Set the clock phase for the transfer
-	spi_set_selector_clk_phase(spi, settings->selector, settings->NCPHA);
-	// Set the baud rate of the transfer
-	spi_set_selector_baud_rate(spi, settings->selector, settings->baud_rate);
-	// Set the amount of bits to transfer
-	spi_set_selector_bit_length(spi, settings->selector,
-			settings->bits_pr_transfer);
-	// Set delay before spi clock starts after CS assertion
-	spi_set_selector_delay_clk_start(spi, settings->selector,
-			settings->delay_clk);
-	// Set delay between consecutive transfers
-	spi_set_selector_delay_transfers(spi, settings->selector,
-			settings->delay_transfers);
+	uint32_t *p_reg;
+
+	if (settings->selector > 3 || settings->CPOL > 1 || settings->NCPHA > 1 ||
+			settings->bits_pr_transfer > 8) {
+		return 0; // Error
+	}
+	p_reg = (&spi->SPI_CSR0) + settings->selector;
+	// All fields with one write, the chip select options are kept
+	*p_reg = (*p_reg & (SPI_CSRx_CSNAAT_MASK | SPI_CSRx_CSAAT_MASK)) |
+			spi_csr_value(settings);
 	return 1;
 }
 
@@ -84,14 +108,11 @@ uint8_t spi_set_selector_baud_rate(spi_reg_t *spi, uint8_t selector,
 	if (selector > 3) {
 		return 0; // Error
 	}
-	if (baud_rate > 255) {
-		baud_rate = 255;
-	}
 	// Calculate the pointer for the selector based on the first
 	// selector register being the offset.
 	p_reg = (&spi->SPI_CSR0) + selector; // pointer increment of 0 to 3.
 	// Bitwise operation to set the delay for the calculated register to use
-	*p_reg = ((~SPI_CSRx_SCBR_MASK) & *p_reg) | (baud_rate << 8);
+	*p_reg = ((~SPI_CSRx_SCBR_MASK) & *p_reg) | spi_csr_scbr(baud_rate);
 	return 1; // No error
 }
 
@@ -176,69 +197,100 @@ uint8_t spi_set_selector_bit_length(spi_reg_t *spi, uint8_t selector,
 }
 
 uint8_t spi_set_delay_between_cs(spi_reg_t *spi, uint16_t delay) {
-	uint32_t divisor;
 	// If the value is below 12 ns, it's OK. The MCU will adjust it itself to
 	// the minimum value of 12 ns.
-	if (delay > 3036) {
-		delay = 3036;
-	}
-	// Calculate the divisor having though of round-downs with integers
-	divisor = ((delay * 84U) / 1000U);
 	// Bitwise operation to set the delay for the calculated register to use
-	spi->SPI_MR = ((~SPI_MR_DLYBCS_MASK) & spi->SPI_MR) | (divisor << 24);
+	spi->SPI_MR = ((~SPI_MR_DLYBCS_MASK) & spi->SPI_MR) | spi_mr_dlybcs(delay);
 	return 1; // No error
 }
 
 uint8_t spi_set_selector_delay_clk_start(spi_reg_t *spi, uint8_t selector,
 		uint16_t delay) {
 	uint32_t *p_reg;
-	uint32_t divisor;
 	// Boundary test. Higher than these values will result in error or
 	// register corruption, because the selector is used to calculate a
 	// pointer.
 	if (selector > 3) {
 		return 0; // Error
 	}
-	if (delay > 3036) {
-		delay = 3036;
-	}
 	// Calculate the pointer for the selector based on the first
 	// selector register being the offset.
 	p_reg = (&spi->SPI_CSR0) + selector; // pointer increment of 0 to 3.
-	// Calculate the divisor having though of round-downs with integers
-	divisor = ((delay * 84U) / 1000U);
 	// Bitwise operation to set the delay for the calculated register to use
-	*p_reg = ((~SPI_CSRx_DLYBS_MASK) & *p_reg) | (divisor << 16);
+	*p_reg = ((~SPI_CSRx_DLYBS_MASK) & *p_reg) | spi_csr_dlybs(delay);
 	return 1; // No error
 }
 
 uint8_t spi_set_selector_delay_transfers(spi_reg_t *spi, uint8_t selector,
 		uint32_t delay) {
 	uint32_t *p_reg;
-	uint32_t divisor;
 	// Boundary test. Higher than these values will result in error or
 	// register corruption, because the selector is used to calculate a
 	// pointer.
 	if (selector > 3) {
 		return 0; // Error
 	}
-	if (delay > 97143) {
-		delay = 97143;
-	}
 	// Calculate the pointer for the selector based on the first
 	// selector register being the offset.
 	p_reg = (&spi->SPI_CSR0) + selector; // pointer increment of 0 to 3.
-	// Calculate the divisor having though of round-downs with integers
-	divisor = ((delay * 84U) / 32U) / 1000U;
 	// Bitwise operation to set the delay for the calculated register to use
-	*p_reg = ((~SPI_CSRx_DLYBCT_MASK) & *p_reg) | (divisor << 24);
+	*p_reg = ((~SPI_CSRx_DLYBCT_MASK) & *p_reg) | spi_csr_dlybct(delay);
 	return 1; // No error
 }
 
+/*
+ * The PCS field for a slave, in SPI_MR or SPI_TDR. Without decoding the
+ * line of the slave is the lowest zero, with decoding it is the number.
+ */
+static inline uint32_t slave_pcs(spi_reg_t *spi, uint8_t slave) {
+	if (spi->SPI_MR & SPI_MR_PCSDEC_MASK) {
+		return ((uint32_t) slave & 0xFu) << 16;
+	}
+	return (0b1111u >> (4 - slave)) << 16;
+}
+
+/*
+ * The chip select register used by a slave, or 0 if there is no such slave.
+ */
+static uint32_t *slave_csr(spi_reg_t *spi, uint8_t slave) {
+	if (spi->SPI_MR & SPI_MR_PCSDEC_MASK) {
+		return (slave < SPI_DECODED_SLAVES) ? (&spi->SPI_CSR0) + (slave >> 2) : 0;
+	}
+	return (slave <= SPI_SELECTOR_3) ? (&spi->SPI_CSR0) + slave : 0;
+}
+
 uint8_t spi_select_slave(spi_reg_t *spi, uint8_t slave) {
 	spi->SPI_MR = ((~SPI_MR_PCS_MASK) & spi->SPI_MR);
-	spi->SPI_MR = ((~SPI_MR_PCS_MASK) & spi->SPI_MR)
-			| ((0b1111u >> (4 - slave)) << 16);
+	spi->SPI_MR = ((~SPI_MR_PCS_MASK) & spi->SPI_MR) | slave_pcs(spi, slave);
+	return 1;
+}
+
+uint32_t spi_tdr_word(spi_reg_t *spi, uint8_t slave, uint16_t data,
+		uint8_t last) {
+	return slave_pcs(spi, slave) | (last ? SPI_TDR_LASTXFER_MASK : 0) | data;
+}
+
+uint8_t spi_build_tdr_words(spi_reg_t *spi, uint8_t slave, const void *data,
+		uint32_t *words, uint32_t len, uint8_t last) {
+	const uint32_t *csr = slave_csr(spi, slave);
+	uint32_t pcs, i;
+
+	if (!csr) {
+		return 0;
+	}
+	pcs = slave_pcs(spi, slave);
+	if (*csr & SPI_CSRx_BITS_MASK) {
+		for (i = 0; i < len; i++) {
+			words[i] = pcs | ((const uint16_t *) data)[i];
+		}
+	} else {
+		for (i = 0; i < len; i++) {
+			words[i] = pcs | ((const uint8_t *) data)[i];
+		}
+	}
+	if (last && len > 0) {
+		words[len - 1] |= SPI_TDR_LASTXFER_MASK;
+	}
 	return 1;
 }
 
@@ -304,3 +356,249 @@ uint8_t spi_close_selector(spi_reg_t *spi) {
 	return 1;
 }
 
+
+static void transfer_done(uint32_t channel, void *arg) {
+	(void) channel;
+	if (transfer_callback) {
+		transfer_callback((spi_reg_t *) arg);
+	}
+}
+
+uint8_t spi_transfer(spi_reg_t *spi, uint8_t selector, const void *tx,
+		void *rx, uint32_t len) {
+	if (!spi_transfer_async(spi, selector, tx, rx, len, 0)) {
+		return 0;
+	}
+	while (spi_transfer_busy());
+	return 1;
+}
+
+uint8_t spi_transfer_async(spi_reg_t *spi, uint8_t selector, const void *tx,
+		void *rx, uint32_t len, spi_callback_t callback) {
+	dmac_transfer_t tx_transfer, rx_transfer;
+	const uint32_t *csr = slave_csr(spi, selector);
+	uint8_t variable = (spi->SPI_MR & SPI_MR_PS_MASK) != 0;
+
+	if ((!variable && !csr) || (variable && !tx) || spi_transfer_busy()) {
+		return 0;
+	}
+	// The receive channel finishes last, it is started first so that no word
+	// is missed. Both use the same width: bytes for 8 bits, otherwise
+	// halfwords, and whole registers with variable peripheral select
+	rx_transfer.src = &spi->SPI_RDR;
+	rx_transfer.dst = rx ? rx : &dummy_rx;
+	rx_transfer.count = len;
+	if (variable) {
+		rx_transfer.width = DMAC_WIDTH_WORD;
+	} else {
+		rx_transfer.width = (*csr & SPI_CSRx_BITS_MASK) ?
+				DMAC_WIDTH_HALFWORD : DMAC_WIDTH_BYTE;
+	}
+	rx_transfer.flow = DMAC_PER2MEM;
+	rx_transfer.src_incr = 0;
+	rx_transfer.dst_incr = (rx != 0);
+	rx_transfer.per = (spi == SPI0) ? DMAC_PER_SPI0_RX : DMAC_PER_SPI1_RX;
+
+	tx_transfer.src = tx ? tx : &dummy_tx;
+	tx_transfer.dst = &spi->SPI_TDR;
+	tx_transfer.count = len;
+	tx_transfer.width = rx_transfer.width;
+	tx_transfer.flow = DMAC_MEM2PER;
+	tx_transfer.src_incr = (tx != 0);
+	tx_transfer.dst_incr = 0;
+	tx_transfer.per = (spi == SPI0) ? DMAC_PER_SPI0_TX : DMAC_PER_SPI1_TX;
+
+	if (!variable) {
+		spi_select_slave(spi, selector);
+	}
+	// Throw away an old word and clear the overrun status
+	(void) PERIPH_REG(spi->SPI_RDR);
+	(void) PERIPH_REG(spi->SPI_SR);
+
+	transfer_callback = callback;
+	if (!dmac_start(SPI_DMAC_RX_CHANNEL, &rx_transfer,
+			callback ? transfer_done : 0, spi)) {
+		return 0;
+	}
+	if (!dmac_start(SPI_DMAC_TX_CHANNEL, &tx_transfer, 0, 0)) {
+		dmac_abort(SPI_DMAC_RX_CHANNEL);
+		return 0;
+	}
+	return 1;
+}
+
+static void transfer_req_done(spi_reg_t *spi) {
+	(void) spi;
+	io_req_complete(transfer_req, 1);
+}
+
+uint8_t spi_transfer_req(spi_reg_t *spi, uint8_t selector, const void *tx,
+		void *rx, uint32_t len, io_req_t *req) {
+	if (spi_transfer_busy() || !io_req_start(req)) {
+		return 0;
+	}
+	transfer_req = req;
+	if (!spi_transfer_async(spi, selector, tx, rx, len, transfer_req_done)) {
+		io_req_cancel(req);
+		return 0;
+	}
+	return 1;
+}
+
+uint8_t spi_transfer_busy(void) {
+	return dmac_busy(SPI_DMAC_RX_CHANNEL) || dmac_busy(SPI_DMAC_TX_CHANNEL);
+}
+
+void spi_set_handler(spi_reg_t *spi, spi_handler_t handler) {
+	uint32_t id = (spi == SPI0) ? ID_SPI0 : ID_SPI1;
+
+	if (handler == 0) {
+		NVIC_ICER(id) = (0x1u << (id & 0x1Fu));
+	}
+	handlers[spi == SPI1] = handler;
+	if (handler != 0) {
+		NVIC_ISER(id) = (0x1u << (id & 0x1Fu));
+	}
+}
+
+/*
+ * Arms the receive channel with the buffer of the next frame, then the
+ * transmit channel, which loads the first word into SPI_TDR right away.
+ */
+static uint8_t slave_arm(spi_reg_t *spi) {
+	dmac_transfer_t rx_transfer, tx_transfer;
+
+	rx_transfer.src = &spi->SPI_RDR;
+	rx_transfer.dst = slave.settings.rx[slave.filling];
+	rx_transfer.count = slave.settings.size;
+	rx_transfer.width = slave.width;
+	rx_transfer.flow = DMAC_PER2MEM;
+	rx_transfer.src_incr = 0;
+	rx_transfer.dst_incr = 1;
+	rx_transfer.per = (spi == SPI0) ? DMAC_PER_SPI0_RX : DMAC_PER_SPI1_RX;
+
+	tx_transfer.src = slave.reply ? slave.reply : &dummy_tx;
+	tx_transfer.dst = &spi->SPI_TDR;
+	tx_transfer.count = slave.reply ? slave.reply_len : slave.settings.size;
+	tx_transfer.width = slave.width;
+	tx_transfer.flow = DMAC_MEM2PER;
+	tx_transfer.src_incr = (slave.reply != 0);
+	tx_transfer.dst_incr = 0;
+	tx_transfer.per = (spi == SPI0) ? DMAC_PER_SPI0_TX : DMAC_PER_SPI1_TX;
+
+	if (!dmac_start(SPI_DMAC_RX_CHANNEL, &rx_transfer, 0, 0)) {
+		return 0;
+	}
+	if (!dmac_start(SPI_DMAC_TX_CHANNEL, &tx_transfer, 0, 0)) {
+		dmac_abort(SPI_DMAC_RX_CHANNEL);
+		return 0;
+	}
+	return 1;
+}
+
+/*
+ * Resets the SPI to an enabled slave without data, the word the DMAC has
+ * put into SPI_TDR for a frame that did not come is dropped.
+ */
+static void slave_reset(spi_reg_t *spi) {
+	spi->SPI_CR = SPI_CR_SWRST_MASK;
+	spi->SPI_MR = 0;
+	spi->SPI_CSR0 = slave.csr;
+}
+
+static void slave_handler(spi_reg_t *spi) {
+	// reading the status clears NSSR and OVRES
+	uint32_t status = spi->SPI_SR;
+	uint32_t len;
+	void *rx;
+
+	if (!(status & SPI_SR_NSSR_MASK)) {
+		return;
+	}
+	len = dmac_stop(SPI_DMAC_RX_CHANNEL);
+	dmac_abort(SPI_DMAC_TX_CHANNEL);
+	slave.stats.frames++;
+	// the buffer filled up and the SPI kept receiving
+	if (len == slave.settings.size &&
+			(status & (SPI_SR_RDRF_MASK | SPI_SR_OVRES_MASK))) {
+		slave.stats.overruns++;
+	}
+	rx = slave.settings.rx[slave.filling];
+	slave.filling ^= 1u;
+
+	slave_reset(spi);
+	(void) slave_arm(spi);
+	spi->SPI_IER = SPI_SR_NSSR_MASK;
+	spi->SPI_CR = SPI_CR_SPIEN_MASK;
+	slave.settings.callback(spi, rx, len, slave.settings.arg);
+}
+
+uint8_t spi_slave_start(spi_reg_t *spi, const spi_slave_settings_t *settings) {
+	if ((spi != SPI0 && spi != SPI1) || settings->CPOL > 1 ||
+			settings->NCPHA > 1 || settings->bits_pr_transfer > SPI_BITS_16 ||
+			!settings->rx[0] || !settings->rx[1] || settings->size == 0 ||
+			settings->size > 4095 || !settings->callback ||
+			spi_transfer_busy()) {
+		return 0;
+	}
+	claim_dmac_channels();
+	spi_set_handler(spi, 0);
+	slave.settings = *settings;
+	slave.csr = spi_csr_mode(settings->CPOL, settings->NCPHA) |
+			spi_csr_bits(settings->bits_pr_transfer);
+	slave.width = (settings->bits_pr_transfer != SPI_BITS_8) ?
+			DMAC_WIDTH_HALFWORD : DMAC_WIDTH_BYTE;
+	slave.filling = 0;
+	slave.stats.frames = 0;
+	slave.stats.overruns = 0;
+
+	slave_reset(spi);
+	if (!slave_arm(spi)) {
+		return 0;
+	}
+	spi->SPI_IER = SPI_SR_NSSR_MASK;
+	spi_set_handler(spi, slave_handler);
+	spi->SPI_CR = SPI_CR_SPIEN_MASK;
+	return 1;
+}
+
+uint8_t spi_slave_set_reply(const void *tx, uint32_t len) {
+	uint32_t primask;
+
+	if (tx && (len == 0 || len > 4095)) {
+		return 0;
+	}
+	// the pair is read by the interrupt
+	primask = irq_save();
+	slave.reply = tx;
+	slave.reply_len = len;
+	irq_restore(primask);
+	return 1;
+}
+
+void spi_slave_get_stats(spi_slave_stats_t *stats) {
+	uint32_t primask = irq_save();
+
+	*stats = slave.stats;
+	irq_restore(primask);
+}
+
+void spi_slave_stop(spi_reg_t *spi) {
+	spi->SPI_IDR = SPI_SR_NSSR_MASK;
+	spi_set_handler(spi, 0);
+	dmac_abort(SPI_DMAC_RX_CHANNEL);
+	dmac_abort(SPI_DMAC_TX_CHANNEL);
+	spi->SPI_CR = SPI_CR_SPIDIS_MASK;
+}
+
+void SPI0_Handler(void) {
+	if (handlers[0]) {
+		handlers[0](SPI0);
+	}
+}
+
+void SPI1_Handler(void) {
+	if (handlers[1]) {
+		handlers[1](SPI1);
+	}
+}
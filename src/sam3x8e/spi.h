@@ -24,14 +24,30 @@ s */
 #ifndef INTTYPES_H_
 #define INTTYPES_H_
 #include <inttypes.h>
+#include "periph.h"
+#include "io_req.h"
 #endif /* INTTYPES_H_ */
 
+///@{
+/**
+ * The DMAC channels used by spi_transfer() and spi_transfer_async().
+ * The SPI has no PDC channels, the DMA Controller is used instead.
+ * spi_init() claims them with dmac_channel_claim().
+ */
+#ifndef SPI_DMAC_TX_CHANNEL
+#define SPI_DMAC_TX_CHANNEL			(0)
+#endif
+#ifndef SPI_DMAC_RX_CHANNEL
+#define SPI_DMAC_RX_CHANNEL			(1)
+#endif
+///@}
+
 ///\cond
 /**
  * These are the base addresses for the two SPI peripherals
  */
-#define SPI0				((spi_reg_t *) 0x40008000u)
-#define SPI1				((spi_reg_t *) 0x4000C000u)
+#define SPI0				((spi_reg_t *) PERIPH_ADDR(0x40008000u))
+#define SPI1				((spi_reg_t *) PERIPH_ADDR(0x4000C000u))
 /**
  * SPI register mapping
  */
@@ -70,6 +86,19 @@ typedef struct spi_settings {
 	 * rounded down.
 	 */
 	uint8_t delay_between_cs;	///< Used to set the delay between chip selects
+	/**
+	 * Fixed or variable peripheral select. With variable peripheral select
+	 * the slave is given in every word written to SPI_TDR, see
+	 * spi_tdr_word(), instead of with spi_select_slave().
+	 * (Use the predefined values with prefix: SPI_PS_)
+	 */
+	uint8_t peripheral_select;
+	/**
+	 * Set to 1 if the four chip select lines drive an external 4-to-16
+	 * decoder. Slaves 0-14 can then be selected, and slave n uses the
+	 * settings of selector n / 4.
+	 */
+	uint8_t cs_decode;
 } spi_settings_t;
 /**
  * @typedef spi_selector_settings_t
@@ -154,6 +183,8 @@ typedef struct spi_selector_settings {
  * Masks for SPI_TDR
  */
 #define SPI_TDR_TD_MASK				(0xFFFFu << 0)
+#define SPI_TDR_PCS_MASK			(0xFu << 16)
+#define SPI_TDR_LASTXFER_MASK		(1u << 24)
 ///@}
 ///@{
 /**
@@ -161,6 +192,8 @@ typedef struct spi_selector_settings {
  */
 #define SPI_SR_RDRF_MASK			(1u << 0)
 #define SPI_SR_TDRF_MASK			(1u << 1)
+#define SPI_SR_OVRES_MASK			(1u << 3)
+#define SPI_SR_NSSR_MASK			(1u << 8)
 #define SPI_SR_TXEMPTY_MASK			(1u << 9)
 #define SPI_SR_SPIENS_MASK			(1u << 16)
 ///@}
@@ -197,6 +230,17 @@ typedef struct spi_selector_settings {
 #define SPI_SELECTOR_2				(2u) //(0b1011)
 #define SPI_SELECTOR_3				(3u) //(0b0111)
 #define SPI_SELECTOR_NONE			(4u) //(0b1111)
+/// No slave, when the chip selects are decoded (cs_decode = 1).
+#define SPI_SELECTOR_DECODED_NONE	(15u)
+/// The number of slaves when the chip selects are decoded.
+#define SPI_DECODED_SLAVES			(15u)
+///@}
+///@{
+/**
+ * Peripheral select modes for spi_settings_t.
+ */
+#define SPI_PS_FIXED				(0u)
+#define SPI_PS_VARIABLE				(1u)
 ///@}
 ///@{
 /**
@@ -241,6 +285,74 @@ typedef struct spi_selector_settings {
 #define SPI_BITS_16					(8u)
 ///@}
 
+///@{
+/**
+ * Field encoders of SPI_MR and SPI_CSRx. They only compute a value, so all
+ * fields of a register are combined and written with one store, and with
+ * constant arguments they are folded at compile time. The delays are in ns
+ * at 84 MHz, limited and rounded down like the spi_set_ functions do.
+ */
+static inline uint32_t spi_mr_dlybcs(uint32_t delay) {
+	if (delay > 3036) {
+		delay = 3036;
+	}
+	return ((delay * 84U) / 1000U) << 24;
+}
+
+static inline uint32_t spi_csr_mode(uint32_t polarity, uint32_t phase) {
+	return (polarity & 0x1u) | ((phase & 0x1u) << 1);
+}
+
+static inline uint32_t spi_csr_bits(uint32_t bit_count) {
+	return (bit_count << 4) & SPI_CSRx_BITS_MASK;
+}
+
+static inline uint32_t spi_csr_scbr(uint32_t baud_rate) {
+	if (baud_rate > 255) {
+		baud_rate = 255;
+	}
+	return baud_rate << 8;
+}
+
+static inline uint32_t spi_csr_dlybs(uint32_t delay) {
+	if (delay > 3036) {
+		delay = 3036;
+	}
+	return ((delay * 84U) / 1000U) << 16;
+}
+
+static inline uint32_t spi_csr_dlybct(uint32_t delay) {
+	if (delay > 97143) {
+		delay = 97143;
+	}
+	return (((delay * 84U) / 32U) / 1000U) << 24;
+}
+
+/**
+ * The SPI_MR value of spi_init(): master, no mode fault detection and no
+ * slave selected. The loopback bit is not included.
+ */
+static inline uint32_t spi_mr_value(const spi_settings_t *settings) {
+	return SPI_MR_MSTR_MASK | SPI_MR_MODFDIS_MASK | SPI_MR_PCS_MASK |
+			((settings->peripheral_select == SPI_PS_VARIABLE) ?
+					SPI_MR_PS_MASK : 0) |
+			(settings->cs_decode ? SPI_MR_PCSDEC_MASK : 0) |
+			spi_mr_dlybcs(settings->delay_between_cs);
+}
+
+/**
+ * The SPI_CSRx value of spi_init_selector(), without the chip select
+ * options (see spi_set_selector_option()).
+ */
+static inline uint32_t spi_csr_value(const spi_selector_settings_t *settings) {
+	return spi_csr_mode(settings->CPOL, settings->NCPHA) |
+			spi_csr_bits(settings->bits_pr_transfer) |
+			spi_csr_scbr(settings->baud_rate) |
+			spi_csr_dlybs(settings->delay_clk) |
+			spi_csr_dlybct(settings->delay_transfers);
+}
+///@}
+
 /**
  * This function initializes the SPI peripheral.
  *
@@ -248,6 +360,7 @@ typedef struct spi_selector_settings {
  * (Use one of predefined values with prefix: SPI)
  * @param settings This is a struct of type spi_settings_t with different
  * setting for the initialization of the peripheral.
+ * SPI_MR is written once, see spi_mr_value().
  * @return error (1 = SUCCESS, 0 = FAIL)
  */
 uint8_t spi_init(spi_reg_t *spi, const spi_settings_t *settings);
@@ -264,8 +377,10 @@ uint8_t spi_init(spi_reg_t *spi, const spi_settings_t *settings);
  * @param spi The base-address of the SPI-peripheral that shall be used.
  * (Use one of predefined values with prefix: SPI)
  * @param settings This is a struct of type spi_selector_settings_t with the
- * needed parameters for the initialization of the selector.
- * @return error (1 = SUCCESS, 0 = FAIL)
+ * needed parameters for the initialization of the selector. SPI_CSRx is
+ * written once, see spi_csr_value().
+ * @return error (1 = SUCCESS, 0 = FAIL, invalid selector, polarity, phase or
+ * bit length)
  */
 uint8_t spi_init_selector(spi_reg_t *spi,
 		const spi_selector_settings_t *settings);
@@ -444,9 +559,43 @@ uint8_t spi_set_selector_delay_transfers(spi_reg_t *spi, uint8_t selector,
  * (Use one of predefined values with prefix: SPI)
  * @param slave This parameter defines which selector to assert.
  * (Use one of the predefines values with prefix: SPI_SELECTOR_)
+ * With decoded chip selects this is the slave 0-14, or
+ * SPI_SELECTOR_DECODED_NONE.
  * @return error (1 = SUCCESS, 0 = FAIL)
  */
 uint8_t spi_select_slave(spi_reg_t *spi, uint8_t slave);
+/**
+ * Builds a word for SPI_TDR in variable peripheral select mode. The word
+ * holds the chip select of the slave, which is encoded for
+ * cs_decode as set with spi_init(), and optionally LASTXFER to release the
+ * chip select after the word.
+ *
+ * @param spi The base-address of the SPI-peripheral that shall be used.
+ * (Use one of predefined values with prefix: SPI)
+ * @param slave The slave, 0-3 (prefix SPI_SELECTOR_) or 0-14 if decoded.
+ * @param data The data of max length 16-bit.
+ * @param last 1 to release the chip select after this word.
+ * @return The word for SPI_TDR.
+ */
+uint32_t spi_tdr_word(spi_reg_t *spi, uint8_t slave, uint16_t data,
+		uint8_t last);
+/**
+ * Fills a buffer with words for SPI_TDR, to interleave transfers to several
+ * slaves in one buffer sent with spi_transfer(). The data is bytes (uint8_t)
+ * if the selector of the slave uses 8 bits per transfer, otherwise halfwords
+ * (uint16_t).
+ *
+ * @param spi The base-address of the SPI-peripheral that shall be used.
+ * (Use one of predefined values with prefix: SPI)
+ * @param slave The slave, 0-3 (prefix SPI_SELECTOR_) or 0-14 if decoded.
+ * @param data The data.
+ * @param words The buffer for the words, one uint32_t per word.
+ * @param len The number of words.
+ * @param last 1 to release the chip select after the last word.
+ * @return error (1 = SUCCESS, 0 = FAIL, invalid slave)
+ */
+uint8_t spi_build_tdr_words(spi_reg_t *spi, uint8_t slave, const void *data,
+		uint32_t *words, uint32_t len, uint8_t last);
 /**
  * Write a data of max 16 bits in length.
  * If subsequent write are performed, be sure to check the if transfer buffer
@@ -548,6 +697,173 @@ uint8_t spi_reset(spi_reg_t *spi);
  * @return error (1 = SUCCESS and 0 = FAIL)
  */
 uint8_t spi_close_selector(spi_reg_t *spi);
+/**
+ * Called from the DMAC interrupt when a transfer started with
+ * spi_transfer_async() is done.
+ * @param spi The SPI that did the transfer.
+ */
+typedef void (*spi_callback_t)(spi_reg_t *spi);
+/**
+ * Transfers a block of words with the DMA Controller and waits (polls) until
+ * the last word has been received.
+ * The selector is selected with spi_select_slave() and the words are bytes
+ * (uint8_t) if the selector uses 8 bits per transfer, otherwise halfwords
+ * (uint16_t). The received words are stored in rx, which may be equal to tx.
+ *
+ * With variable peripheral select the selector is not used: tx holds words
+ * from spi_build_tdr_words() and rx receives the full SPI_RDR words, both
+ * one uint32_t per word. tx must then be given.
+ *
+ * @pre dmac_init() must be called first and the selector must be initialized.
+ * @param spi The base-address of the SPI-peripheral that shall be used.
+ * (Use one of predefined values with prefix: SPI)
+ * @param selector The slave, 0-3 (prefix SPI_SELECTOR_) or 0-14 if decoded.
+ * @param tx The words to send, 0 to send 0xFFFF.
+ * @param rx Buffer for the received words, 0 to discard them.
+ * @param len The number of words (1-4095).
+ * @return error (1 = SUCCESS and 0 = FAIL)
+ */
+uint8_t spi_transfer(spi_reg_t *spi, uint8_t selector, const void *tx,
+		void *rx, uint32_t len);
+/**
+ * Starts a transfer like spi_transfer() but returns immediately.
+ * The buffers must stay valid until the transfer is done, which is indicated
+ * by the callback or by spi_transfer_busy().
+ *
+ * @param spi The base-address of the SPI-peripheral that shall be used.
+ * (Use one of predefined values with prefix: SPI)
+ * @param selector The slave, 0-3 (prefix SPI_SELECTOR_) or 0-14 if decoded.
+ * @param tx The words to send, 0 to send 0xFFFF.
+ * @param rx Buffer for the received words, 0 to discard them.
+ * @param len The number of words (1-4095).
+ * @param callback Called from the interrupt when done, or 0.
+ * @return error (1 = SUCCESS and 0 = FAIL, a transfer is already running)
+ */
+uint8_t spi_transfer_async(spi_reg_t *spi, uint8_t selector, const void *tx,
+		void *rx, uint32_t len, spi_callback_t callback);
+/**
+ * @return Returns 1 while a transfer started with spi_transfer_async() is not
+ * done.
+ */
+uint8_t spi_transfer_busy(void);
+/**
+ * Starts a transfer like spi_transfer_async(), its completion is the request.
+ * The result of the request is 1 when the last word has been received.
+ *
+ * @param spi The base-address of the SPI-peripheral that shall be used.
+ * (Use one of predefined values with prefix: SPI)
+ * @param selector The slave, 0-3 (prefix SPI_SELECTOR_) or 0-14 if decoded.
+ * @param tx The words to send, 0 to send 0xFFFF.
+ * @param rx Buffer for the received words, 0 to discard them.
+ * @param len The number of words (1-4095).
+ * @param req The request, set up with io_req_init().
+ * @return error (1 = SUCCESS and 0 = FAIL, a transfer is already running or
+ * the request is busy)
+ */
+uint8_t spi_transfer_req(spi_reg_t *spi, uint8_t selector, const void *tx,
+		void *rx, uint32_t len, io_req_t *req);
+/**
+ * Called from the interrupt of an SPI.
+ * @param spi The SPI.
+ */
+typedef void (*spi_handler_t)(spi_reg_t *spi);
+/**
+ * Sets the function that handles the interrupt of an SPI and enables the
+ * interrupt in the NVIC, or disables it if the handler is 0. Used by
+ * spi_queue_init() and spi_slave_start(), an SPI has one of them at a time.
+ *
+ * @param spi The base-address of the SPI-peripheral that shall be used.
+ * (Use one of predefined values with prefix: SPI)
+ * @param handler The handler, or 0.
+ */
+void spi_set_handler(spi_reg_t *spi, spi_handler_t handler);
+/**
+ * Called from the SPI interrupt when the master has ended a frame by
+ * raising NSS, see spi_slave_start().
+ * @param spi The SPI.
+ * @param rx The receive buffer of the frame. It is not written again until
+ * the callback of the next frame has returned.
+ * @param len The number of words received, at most the size of the buffer.
+ * @param arg The argument of the settings.
+ */
+typedef void (*spi_slave_callback_t)(spi_reg_t *spi, void *rx, uint32_t len,
+		void *arg);
+/**
+ * @typedef spi_slave_settings_t
+ * The settings of spi_slave_start(), they are copied.
+ */
+typedef struct spi_slave_settings {
+	/** Clock polarity, 0 or 1, see spi_selector_settings_t */
+	uint8_t CPOL;
+	/** Clock phase, 0 or 1, see spi_selector_settings_t */
+	uint8_t NCPHA;
+	/** Bits per word (prefix: SPI_BITS_), bytes for 8, halfwords above */
+	uint8_t bits_pr_transfer;
+	/** The two receive buffers, the frames go to them in turn */
+	void *rx[2];
+	/** Words of each receive buffer (1-4095) */
+	uint32_t size;
+	/** Called at the end of each frame */
+	spi_slave_callback_t callback;
+	/** Passed to the callback */
+	void *arg;
+} spi_slave_settings_t;
+/**
+ * @typedef spi_slave_stats_t
+ * The frames since spi_slave_start().
+ */
+typedef struct spi_slave_stats {
+	/** Frames ended by NSS */
+	uint32_t frames;
+	/** Frames longer than the receive buffer, the rest was dropped */
+	uint32_t overruns;
+} spi_slave_stats_t;
+/**
+ * Makes the SPI a slave of an external master, e.g. the SPI of a Linux host
+ * (spidev). The receive and transmit channels of the DMAC are armed before
+ * the master lowers NSS, so the words of a frame are moved at the rate of
+ * the master's clock without the CPU. When the master raises NSS again the
+ * SPI interrupt stops both channels, calls the callback with the buffer of
+ * the frame and arms the channels for the next frame with the other buffer.
+ * The master must leave NSS high for the few microseconds this takes.
+ *
+ * Each frame sends the reply of spi_slave_set_reply(), or 0xFF words
+ * without one.
+ *
+ * @pre dmac_init() must be called first. NPCS0 (NSS), SPCK, MISO and MOSI
+ * must be given to the SPI with the PIO. The SPI and the DMAC channels of
+ * spi_transfer() are used by the slave until spi_slave_stop().
+ * @param spi The base-address of the SPI-peripheral that shall be used.
+ * (Use one of predefined values with prefix: SPI)
+ * @param settings The slave settings.
+ * @return error (1 = SUCCESS and 0 = FAIL, invalid settings or a transfer
+ * is running)
+ */
+uint8_t spi_slave_start(spi_reg_t *spi, const spi_slave_settings_t *settings);
+/**
+ * Sets the words sent in each frame from the next one on. A frame the
+ * master starts before the callback of the current one has returned still
+ * sends the old reply.
+ *
+ * @param tx The words, bytes or halfwords like the receive buffers. They
+ * must stay valid until the next call, 0 to send 0xFF words.
+ * @param len The number of words (1-4095). After them the SPI underruns
+ * and repeats a word it shifted before.
+ * @return error (1 = SUCCESS and 0 = FAIL, invalid length)
+ */
+uint8_t spi_slave_set_reply(const void *tx, uint32_t len);
+/**
+ * @param stats Receives the frames since spi_slave_start().
+ */
+void spi_slave_get_stats(spi_slave_stats_t *stats);
+/**
+ * Stops the slave, a frame in progress is dropped. The SPI is disabled and
+ * must be initialized again with spi_init() for master transfers.
+ *
+ * @param spi The base-address of the SPI-peripheral that shall be used.
+ * (Use one of predefined values with prefix: SPI)
+ */
+void spi_slave_stop(spi_reg_t *spi);
 
 
 #endif /* SPI_H_ */
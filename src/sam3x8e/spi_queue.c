@@ -0,0 +1,152 @@
+/*
+ * spi_queue.c
+ *
+ * Date:	14 October 2026
+ */
+
+#include "spi_queue.h"
+#include "irq.h"
+#if SPI_QUEUE_COOS
+#include "rtos/CoOS.h"
+#endif
+
+/*
+ * The queue of one SPI. head is the transaction in progress, index the
+ * word of it that is being transferred.
+ */
+typedef struct {
+	spi_transaction_t *head;
+	spi_transaction_t *tail;
+	uint32_t index;
+	uint8_t wide;
+} spi_queue_state_t;
+
+static spi_queue_state_t states[2];
+
+static inline spi_queue_state_t *queue_state(spi_reg_t *spi) {
+	return &states[spi == SPI1];
+}
+
+static void queue_handler(spi_reg_t *spi);
+
+static void write_word(spi_reg_t *spi, spi_queue_state_t *s) {
+	const spi_transaction_t *t = s->head;
+	uint16_t data = 0xFFFFu;
+
+	if (t->tx) {
+		data = s->wide ? ((const uint16_t *) t->tx)[s->index]
+				: ((const uint8_t *) t->tx)[s->index];
+	}
+	spi->SPI_TDR = spi_tdr_word(spi, t->selector, data,
+			s->index == t->len - 1 && !(t->flags & SPI_TRANSACTION_KEEP_CS));
+}
+
+static void start_transaction(spi_reg_t *spi, spi_queue_state_t *s) {
+	uint8_t selector = s->head->selector;
+	uint32_t csr;
+
+	// a decoded slave n uses the settings of selector n / 4
+	if (spi->SPI_MR & SPI_MR_PCSDEC_MASK) {
+		selector >>= 2;
+	}
+	csr = *((&spi->SPI_CSR0) + selector);
+
+	s->index = 0;
+	s->wide = (csr & SPI_CSRx_BITS_MASK) != 0;
+	write_word(spi, s);
+}
+
+uint8_t spi_queue_init(spi_reg_t *spi) {
+	if (spi != SPI0 && spi != SPI1) {
+		return 0;
+	}
+	spi->SPI_MR |= SPI_MR_PS_MASK;
+	spi_set_handler(spi, queue_handler);
+	return 1;
+}
+
+uint8_t spi_queue_submit(spi_reg_t *spi, spi_transaction_t *transaction) {
+	spi_queue_state_t *s = queue_state(spi);
+	uint8_t slaves = (spi->SPI_MR & SPI_MR_PCSDEC_MASK) ?
+			SPI_DECODED_SLAVES : SPI_SELECTOR_3 + 1;
+	uint32_t primask;
+
+	if (transaction->selector >= slaves || transaction->len == 0) {
+		return 0;
+	}
+	transaction->next = 0;
+	transaction->done = 0;
+
+	primask = irq_save();
+	if (s->tail) {
+		s->tail->next = transaction;
+		s->tail = transaction;
+	} else {
+		s->head = s->tail = transaction;
+		// throw away an old word, so RDRF is set by this transaction
+		(void) PERIPH_REG(spi->SPI_RDR);
+		start_transaction(spi, s);
+		spi->SPI_IER = SPI_SR_RDRF_MASK;
+	}
+	irq_restore(primask);
+	return 1;
+}
+
+uint8_t spi_queue_transfer(spi_reg_t *spi, spi_transaction_t *transaction) {
+	if (!spi_queue_submit(spi, transaction)) {
+		return 0;
+	}
+#if SPI_QUEUE_COOS
+	if (transaction->flag != SPI_QUEUE_NO_FLAG) {
+		CoWaitForSingleFlag(transaction->flag, 0);
+	}
+#endif
+	while (!transaction->done);
+	return 1;
+}
+
+uint8_t spi_queue_idle(spi_reg_t *spi) {
+	return queue_state(spi)->head == 0;
+}
+
+static void spi_queue_handler(spi_reg_t *spi, spi_queue_state_t *s) {
+	spi_transaction_t *t = s->head;
+	uint32_t data;
+
+	if (!t || !(spi->SPI_SR & SPI_SR_RDRF_MASK)) {
+		return;
+	}
+	data = spi->SPI_RDR & SPI_RDR_RD_MASK;
+	if (t->rx) {
+		if (s->wide) {
+			((uint16_t *) t->rx)[s->index] = (uint16_t) data;
+		} else {
+			((uint8_t *) t->rx)[s->index] = (uint8_t) data;
+		}
+	}
+	if (++s->index < t->len) {
+		write_word(spi, s);
+		return;
+	}
+
+	// The transaction may be reused as soon as done is set
+	s->head = t->next;
+	if (!s->head) {
+		s->tail = 0;
+	}
+	t->done = 1;
+#if SPI_QUEUE_COOS
+	if (t->flag != SPI_QUEUE_NO_FLAG) {
+		isr_SetFlag(t->flag);
+	}
+#endif
+	if (s->head) {
+		start_transaction(spi, s);
+	} else {
+		spi->SPI_IDR = SPI_SR_RDRF_MASK;
+	}
+}
+
+static void queue_handler(spi_reg_t *spi) {
+	spi_queue_handler(spi, queue_state(spi));
+}
@@ -0,0 +1,116 @@
+/**
+ * @file spi_queue.h
+ * @brief SPI - Transaction queue
+ * @details Lets several tasks share one SPI with slaves on different
+ * selectors. A task describes a transaction (selector, buffers, length) and
+ * submits it; the transactions are done back-to-back in the order they were
+ * submitted, from the SPI interrupt, without the tasks reconfiguring the
+ * peripheral between them.
+ *
+ * The queue uses variable peripheral select: the selector is written with
+ * every word in SPI_TDR, so each transaction uses the clock, phase and bit
+ * length of its own selector (SPI_CSRx). The chip select is released with
+ * LASTXFER after the last word of a transaction, unless
+ * SPI_TRANSACTION_KEEP_CS is given.
+ *
+ * A task waiting in spi_queue_transfer() blocks on a CoOS event flag given
+ * in the transaction instead of spinning.
+ *
+ * @pre The SPI and its selectors must be initialized with spi.h and
+ * enabled. spi_transfer() can not be used on the same SPI while the queue
+ * is used, as it needs fixed peripheral select.
+ * @pre CoOS delivery requires CFG_MAX_SERVICE_REQUEST > 0 and an event flag
+ * created with CoCreateFlag(1, 0) (auto reset) for every waiting task.
+ * @date 14 October 2026
+ */
+
+#ifndef SPI_QUEUE_H_
+#define SPI_QUEUE_H_
+
+#include <inttypes.h>
+#include "spi.h"
+
+/*
+ * Set to 0 to build without the CoOS event flags, e.g. when the RTOS is not
+ * linked into the application.
+ */
+#ifndef SPI_QUEUE_COOS
+#define SPI_QUEUE_COOS				(1)
+#endif
+
+/// No event flag is set when the transaction is done.
+#define SPI_QUEUE_NO_FLAG			(0xFFu)
+
+///@{
+/**
+ * Flags of a transaction.
+ */
+/// Keep the chip select asserted after the last word.
+#define SPI_TRANSACTION_KEEP_CS		(1u << 0)
+///@}
+
+/**
+ * @typedef spi_transaction_t
+ * One transaction. The words are bytes (uint8_t) if the selector uses 8 bits
+ * per transfer, otherwise halfwords (uint16_t). The transaction and its
+ * buffers must stay valid until done is set.
+ */
+typedef struct spi_transaction {
+	/** The words to send, 0 to send 0xFFFF. */
+	const void *tx;
+	/** Buffer for the received words, 0 to discard them. May equal tx. */
+	void *rx;
+	/** The number of words. */
+	uint32_t len;
+	/** The slave, 0-3 (prefix SPI_SELECTOR_) or 0-14 if decoded. */
+	uint8_t selector;
+	/** Flags (prefix SPI_TRANSACTION_). */
+	uint8_t flags;
+	/** CoOS event flag set when done, or SPI_QUEUE_NO_FLAG. */
+	uint8_t flag;
+	/** Set to 1 from the interrupt when the transaction is done. */
+	volatile uint8_t done;
+	/** Used by the queue. */
+	struct spi_transaction *next;
+} spi_transaction_t;
+
+/**
+ * Switches the SPI to variable peripheral select and enables its interrupt
+ * in the NVIC.
+ *
+ * @param spi The base-address of the SPI-peripheral that shall be used.
+ * (Use one of predefined values with prefix: SPI)
+ * @return error (1 = SUCCESS, 0 = FAIL)
+ */
+uint8_t spi_queue_init(spi_reg_t *spi);
+
+/**
+ * Appends a transaction to the queue and returns. If the SPI is idle the
+ * transaction is started immediately.
+ *
+ * @param spi The base-address of the SPI-peripheral that shall be used.
+ * (Use one of predefined values with prefix: SPI)
+ * @param transaction The transaction.
+ * @return error (1 = SUCCESS, 0 = FAIL, invalid selector or length)
+ */
+uint8_t spi_queue_submit(spi_reg_t *spi, spi_transaction_t *transaction);
+
+/**
+ * Submits a transaction and waits until it is done. The calling task blocks
+ * on the event flag of the transaction, if it has one.
+ *
+ * @param spi The base-address of the SPI-peripheral that shall be used.
+ * (Use one of predefined values with prefix: SPI)
+ * @param transaction The transaction.
+ * @return error (1 = SUCCESS, 0 = FAIL, invalid selector or length)
+ */
+uint8_t spi_queue_transfer(spi_reg_t *spi, spi_transaction_t *transaction);
+
+/**
+ * @param spi The base-address of the SPI-peripheral that shall be used.
+ * (Use one of predefined values with prefix: SPI)
+ * @return 1 if there are no queued transactions, otherwise 0
+ */
+uint8_t spi_queue_idle(spi_reg_t *spi);
+
+#endif /* SPI_QUEUE_H_ */
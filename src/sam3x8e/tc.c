@@ -8,63 +8,24 @@
  */
 
 #include "tc.h"
+#include "id.h"
+
+// NVIC Interrupt Set/Clear-Enable Registers, one bit per peripheral ID
+#define NVIC_ISER(id)	(((volatile uint32_t *) PERIPH_ADDR(0xE000E100U))[(id) >> 5])
+#define NVIC_ICER(id)	(((volatile uint32_t *) PERIPH_ADDR(0xE000E180U))[(id) >> 5])
+
+// Interrupt handler of each channel, in peripheral ID order from ID_TC0
+static tc_handler_t handlers[TC_INSTANCES * MAX_CHANNELS];
 
-// TODO: make macro mask function, works for now but mask is better
 void tc_conf_channel(tc_channel_settings_t* set, tc_reg_t *tc, uint32_t channel) {
-	if (channel > MAX_CHANNELS){
+	if (channel >= MAX_CHANNELS){
 		return;
 	}
-	tc_channel_reg_t *tc_ch = tc->TC_CHANNEL + channel;
-
-	// Common parameters
-	tc_ch->TC_CMR = (set->tcclks << TC_CMR_TCCLKS_POS);
-	tc_ch->TC_CMR |= (set->wave << TC_CMR_WAVE_POS);
-	tc_ch->TC_CMR |= (set->clki << TC_CMR_CLKI_POS);
-	tc_ch->TC_CMR |= (set->burst << TC_CMR_BURST_POS);
-
-	if (set->wave == TC_CMR_CAPTURE_MODE){
-		tc_ch->TC_CMR |= (set->ldbstop << TC_CMR_LDBSTOP_POS);
-		tc_ch->TC_CMR |= (set->ldbdis << TC_CMR_LDBDIS_POS);
-		tc_ch->TC_CMR |= (set->etrgedg << TC_CMR_ETRGEDG_POS);
-		tc_ch->TC_CMR |= (set->abetrg << TC_CMR_ABETRG_POS);
-		tc_ch->TC_CMR |= (set->cpctrg << TC_CMR_CPCTRG_POS);
-		tc_ch->TC_CMR |= (set->ldra << TC_CMR_LDRA_POS);
-		tc_ch->TC_CMR |= (set->ldrb << TC_CMR_LDRB_POS);
-	}
-	else if (set->wave == TC_CMR_WAVEFORM_MODE){
-		tc_ch->TC_CMR |= (set->cpcstop << TC_CMR_CPCSTOP_POS);
-		tc_ch->TC_CMR |= (set->cpcdis << TC_CMR_CPCDIS_POS);
-		tc_ch->TC_CMR |= (set->eevtedg << TC_CMR_EEVTEDG_POS);
-		tc_ch->TC_CMR |= (set->eevt << TC_CMR_EEVT_POS);
-		tc_ch->TC_CMR |= (set->enetrg << TC_CMR_ENETRG_POS);
-		tc_ch->TC_CMR |= (set->wavsel << TC_CMR_WAVSEL_POS);
-		tc_ch->TC_CMR |= (set->acpa << TC_CMR_ACPA_POS);
-		tc_ch->TC_CMR |= (set->acpc << TC_CMR_ACPC_POS);
-		tc_ch->TC_CMR |= (set->aeevt << TC_CMR_AEEVT_POS);
-		tc_ch->TC_CMR |= (set->aswtrg << TC_CMR_ASWTRG_POS);
-		tc_ch->TC_CMR |= (set->bcpb << TC_CMR_BCPB_POS);
-		tc_ch->TC_CMR |= (set->bcpc << TC_CMR_BCPC_POS);
-		tc_ch->TC_CMR |= (set->beevt << TC_CMR_BEEVT_POS);
-		tc_ch->TC_CMR |= (set->bswtrg << TC_CMR_BSWTRG_POS);
-	}
+	tc->TC_CHANNEL[channel].TC_CMR = tc_cmr_value(set);
 }
 
 void tc_conf_block(tc_block_settings_t* set, tc_reg_t *tc){
-	tc->TC_BMR = (set->tc0xc0s << TC_BMR_TC0XC0S_POS);
-	tc->TC_BMR |= (set->tc1xc1s << TC_BMR_TC1XC1S_POS);
-	tc->TC_BMR |= (set->tc2xc2s << TC_BMR_TC2XCS2_POS);
-	tc->TC_BMR |= (set->qden << TC_BMR_QDEN_POS);
-	tc->TC_BMR |= (set->posen << TC_BMR_POSEN_POS);
-	tc->TC_BMR |= (set->speeden << TC_BMR_SPEEDEN_POS);
-	tc->TC_BMR |= (set->qdtrans << TC_BMR_QDTRANS_POS);
-	tc->TC_BMR |= (set->edgpha << TC_BMR_EDGPHA_POS);
-	tc->TC_BMR |= (set->inva << TC_BMR_INVA_POS);
-	tc->TC_BMR |= (set->invb << TC_BMR_INVB_POS);
-	tc->TC_BMR |= (set->invidx << TC_BMR_INVIDX_POS);
-	tc->TC_BMR |= (set->swap << TC_BMR_SWAP_POS);
-	tc->TC_BMR |= (set->idxphb << TC_BMR_IDXPHB_POS);
-	tc->TC_BMR |= (set->filter << TC_BMR_FILTER_POS);
-	tc->TC_BMR |= (set->maxfilt << TC_BMR_MAXFILT_POS);
+	tc->TC_BMR = tc_bmr_value(set);
 }
 
 void tc_enable_clock(tc_reg_t *tc, uint32_t channel) {
@@ -134,3 +95,136 @@ void tc_write_reg_c(tc_reg_t * tc, uint32_t channel, uint32_t value){
 		tc->TC_CHANNEL[channel].TC_RC = value;
 	}
 }
+
+uint32_t tc_calc_rate(uint32_t mck, uint32_t hz){
+	uint32_t rc;
+	if (hz == 0){
+		return 0;
+	}
+	// rounded to the nearest count of MCK/2
+	rc = (mck / 2 + hz / 2) / hz;
+	if (rc < 2){
+		return 0;
+	}
+	return rc;
+}
+
+uint32_t tc_set_trigger_rate(tc_reg_t *tc, uint32_t channel, uint32_t mck,
+		uint32_t hz){
+	uint32_t rc = tc_calc_rate(mck, hz);
+	if (channel >= MAX_CHANNELS || rc == 0){
+		return 0;
+	}
+	tc_channel_reg_t *tc_ch = tc->TC_CHANNEL + channel;
+
+	tc_ch->TC_CCR = TC_CCR_CLKDIS;
+	tc_ch->TC_CMR = (TC_CMR_TCCLKS_TCLK1 << TC_CMR_TCCLKS_POS) |
+			(TC_CMR_WAVEFORM_MODE << TC_CMR_WAVE_POS) |
+			(TC_CMR_WAVESEL_UP_RC << TC_CMR_WAVSEL_POS) |
+			(TC_CMR_ACPA_CLEAR << TC_CMR_ACPA_POS) |
+			(TC_CMR_ACPC_SET << TC_CMR_ACPC_POS);
+	tc_ch->TC_RA = rc / 2;
+	tc_ch->TC_RC = rc;
+	tc_ch->TC_CCR = TC_CCR_CLKEN | TC_CCR_SWTRG;
+	return (mck / 2) / rc;
+}
+
+void tc_timestamp_start(tc_reg_t *tc){
+	tc_channel_reg_t *low = tc->TC_CHANNEL + TC_CHANNEL_0;
+	tc_channel_reg_t *high = tc->TC_CHANNEL + TC_CHANNEL_1;
+
+	low->TC_CCR = TC_CCR_CLKDIS;
+	high->TC_CCR = TC_CCR_CLKDIS;
+	// RA compare sets TIOA0 in the middle, RC compare clears it at 0
+	low->TC_CMR = (TC_CMR_TCCLKS_TCLK1 << TC_CMR_TCCLKS_POS) |
+			(TC_CMR_WAVEFORM_MODE << TC_CMR_WAVE_POS) |
+			(TC_CMR_WAVESEL_UP << TC_CMR_WAVSEL_POS) |
+			(TC_CMR_ACPA_SET << TC_CMR_ACPA_POS) |
+			(TC_CMR_ACPC_CLEAR << TC_CMR_ACPC_POS);
+	low->TC_RA = TC_TIMESTAMP_MID;
+	low->TC_RC = 0;
+	// Channel 1 counts the rising edges of TIOA0
+	tc->TC_BMR = (tc->TC_BMR & ~TC_BMR_TC1XC1S_MASK) |
+			(TC_BMR_TC1XC1S_TIOA0 << TC_BMR_TC1XC1S_POS);
+	high->TC_CMR = (TC_CMR_TCCLKS_XC1 << TC_CMR_TCCLKS_POS) |
+			(TC_CMR_WAVEFORM_MODE << TC_CMR_WAVE_POS) |
+			(TC_CMR_WAVESEL_UP << TC_CMR_WAVSEL_POS);
+	high->TC_CCR = TC_CCR_CLKEN | TC_CCR_SWTRG;
+	low->TC_CCR = TC_CCR_CLKEN | TC_CCR_SWTRG;
+}
+
+void tc_timestamp_stop(tc_reg_t *tc){
+	tc->TC_CHANNEL[TC_CHANNEL_0].TC_CCR = TC_CCR_CLKDIS;
+	tc->TC_CHANNEL[TC_CHANNEL_1].TC_CCR = TC_CCR_CLKDIS;
+}
+
+// Whether a channel 0 value is too close to the count of channel 1
+#define NEAR_MID(cv)	((uint32_t) ((cv) - (TC_TIMESTAMP_MID - \
+		TC_TIMESTAMP_GUARD)) < 2 * TC_TIMESTAMP_GUARD)
+
+uint64_t tc_timestamp_read(tc_reg_t *tc){
+	tc_channel_reg_t *low = tc->TC_CHANNEL + TC_CHANNEL_0;
+	tc_channel_reg_t *high = tc->TC_CHANNEL + TC_CHANNEL_1;
+	uint32_t first, halves, last;
+
+	do {
+		first = PERIPH_REG(low->TC_CV);
+		halves = PERIPH_REG(high->TC_CV);
+		last = PERIPH_REG(low->TC_CV);
+	} while (((first ^ last) & TC_TIMESTAMP_MID) || NEAR_MID(first) ||
+			NEAR_MID(last));
+	// Channel 1 is one ahead in the upper half of channel 0
+	return ((uint64_t) (halves - (last >> 31)) << 32) | last;
+}
+
+uint64_t tc_timestamp_to_ns(uint64_t ticks, uint32_t mck){
+	uint32_t hz = mck / 2;
+	// split in seconds, so ticks * 10^9 does not overflow
+	return (ticks / hz) * 1000000000ull +
+			((ticks % hz) * 1000000000ull) / hz;
+}
+
+// Index of a channel in handlers, peripheral ID minus ID_TC0
+static uint32_t handler_index(tc_reg_t *tc, uint32_t channel){
+	return ((uint32_t) tc - (uint32_t) TC0) /
+			((uint32_t) TC1 - (uint32_t) TC0) * MAX_CHANNELS + channel;
+}
+
+void tc_set_handler(tc_reg_t *tc, uint32_t channel, tc_handler_t handler){
+	uint32_t id;
+	if (channel >= MAX_CHANNELS){
+		return;
+	}
+	id = ID_TC0 + handler_index(tc, channel);
+	if (handler == 0){
+		NVIC_ICER(id) = (0x1u << (id & 0x1Fu));
+	}
+	handlers[id - ID_TC0] = handler;
+	if (handler != 0){
+		NVIC_ISER(id) = (0x1u << (id & 0x1Fu));
+	}
+}
+
+tc_handler_t tc_get_handler(tc_reg_t *tc, uint32_t channel){
+	if (channel >= MAX_CHANNELS){
+		return 0;
+	}
+	return handlers[handler_index(tc, channel)];
+}
+
+static void dispatch(tc_reg_t *tc, uint32_t channel){
+	tc_handler_t handler = handlers[handler_index(tc, channel)];
+	if (handler != 0){
+		handler(tc, channel);
+	}
+}
+
+void TC0_Handler(void){ dispatch(TC0, TC_CHANNEL_0); }
+void TC1_Handler(void){ dispatch(TC0, TC_CHANNEL_1); }
+void TC2_Handler(void){ dispatch(TC0, TC_CHANNEL_2); }
+void TC3_Handler(void){ dispatch(TC1, TC_CHANNEL_0); }
+void TC4_Handler(void){ dispatch(TC1, TC_CHANNEL_1); }
+void TC5_Handler(void){ dispatch(TC1, TC_CHANNEL_2); }
+void TC6_Handler(void){ dispatch(TC2, TC_CHANNEL_0); }
+void TC7_Handler(void){ dispatch(TC2, TC_CHANNEL_1); }
+void TC8_Handler(void){ dispatch(TC2, TC_CHANNEL_2); }
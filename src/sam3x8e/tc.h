@@ -14,11 +14,12 @@
 #define TC_H_
 
 #include <inttypes.h>
+#include "periph.h"
 
 // Pointer to base addresses of the three Timer Counters.
-#define TC0 ((tc_reg_t *) 0x40080000U) ///< Instance of TC0
-#define TC1 ((tc_reg_t *) 0x40084000U) ///< Instance of TC1
-#define TC2 ((tc_reg_t *) 0x40088000U) ///< Instance of TC2
+#define TC0 ((tc_reg_t *) PERIPH_ADDR(0x40080000U)) ///< Instance of TC0
+#define TC1 ((tc_reg_t *) PERIPH_ADDR(0x40084000U)) ///< Instance of TC1
+#define TC2 ((tc_reg_t *) PERIPH_ADDR(0x40088000U)) ///< Instance of TC2
 
 // Valid channels for each TC instance
 #define TC_CHANNEL_0	(0) ///< TC channel 0
@@ -62,6 +63,14 @@
 #define TC_CMR_WAVESEL_UPDOWN	(1) ///< UPDOWN mode without automatic trigger on RC Compare
 #define TC_CMR_WAVESEL_UP_RC	(2) ///< UP mode with automatic trigger on RC Compare
 #define TC_CMR_WAVESEL_UPDOWN_RC (3) ///< UPDOWN mode with automatic trigger on RC Compare
+#define TC_CMR_ACPA_NONE		(0) ///< RA compare does not affect TIOA
+#define TC_CMR_ACPA_SET			(1) ///< RA compare sets TIOA
+#define TC_CMR_ACPA_CLEAR		(2) ///< RA compare clears TIOA
+#define TC_CMR_ACPA_TOGGLE		(3) ///< RA compare toggles TIOA
+#define TC_CMR_ACPC_NONE		(0) ///< RC compare does not affect TIOA
+#define TC_CMR_ACPC_SET			(1) ///< RC compare sets TIOA
+#define TC_CMR_ACPC_CLEAR		(2) ///< RC compare clears TIOA
+#define TC_CMR_ACPC_TOGGLE		(3) ///< RC compare toggles TIOA
 
 // TC Block Mode Register
 #define TC_BMR_TC0XC0S_TCLK0	(0) ///< Signal connected to XC0: TCLK0
@@ -84,6 +93,13 @@
 #define TC_CMR_WAVEFORM_MODE	(1)
 #define TC_CMR_CAPTURE_MODE		(0)
 #define TC_BCR_SYNC				(1)
+#define TC_BMR_TC1XC1S_MASK		(0x3u << 2)
+#define TC_INSTANCES			(3)
+
+// Timestamp: channel 1 counts when channel 0 passes the middle of its range
+#define TC_TIMESTAMP_MID		(0x80000000u)
+// Counts around the middle in which channel 1 may not have counted yet
+#define TC_TIMESTAMP_GUARD		(16u)
 
 // Parameter positions
 #define TC_CMR_WAVE_POS			(15)
@@ -114,7 +130,7 @@
 
 #define TC_BMR_TC0XC0S_POS		(0)
 #define TC_BMR_TC1XC1S_POS		(2)
-#define TC_BMR_TC2XCS2_POS		(3)
+#define TC_BMR_TC2XCS2_POS		(4)
 #define TC_BMR_QDEN_POS			(8)
 #define TC_BMR_POSEN_POS		(9)
 #define TC_BMR_SPEEDEN_POS		(10)
@@ -425,7 +441,73 @@ typedef struct tc_block_settings {
 } tc_block_settings_t;
 
 /**
- * Configures a specified counter channel with provided settings.
+ * Composes the Channel Mode Register value of channel settings, to be
+ * written with one store. Only the fields of the mode (capture or
+ * waveform) in set->wave are used. With constant settings the value is
+ * folded at compile time.
+ * @param set Settings for the channel.
+ * @return The TC_CMR value.
+ */
+static inline uint32_t tc_cmr_value(const tc_channel_settings_t *set) {
+	uint32_t cmr = (set->tcclks << TC_CMR_TCCLKS_POS) |
+			(set->wave << TC_CMR_WAVE_POS) |
+			(set->clki << TC_CMR_CLKI_POS) |
+			(set->burst << TC_CMR_BURST_POS);
+
+	if (set->wave == TC_CMR_CAPTURE_MODE) {
+		cmr |= (set->ldbstop << TC_CMR_LDBSTOP_POS) |
+				(set->ldbdis << TC_CMR_LDBDIS_POS) |
+				(set->etrgedg << TC_CMR_ETRGEDG_POS) |
+				(set->abetrg << TC_CMR_ABETRG_POS) |
+				(set->cpctrg << TC_CMR_CPCTRG_POS) |
+				(set->ldra << TC_CMR_LDRA_POS) |
+				(set->ldrb << TC_CMR_LDRB_POS);
+	} else if (set->wave == TC_CMR_WAVEFORM_MODE) {
+		cmr |= (set->cpcstop << TC_CMR_CPCSTOP_POS) |
+				(set->cpcdis << TC_CMR_CPCDIS_POS) |
+				(set->eevtedg << TC_CMR_EEVTEDG_POS) |
+				(set->eevt << TC_CMR_EEVT_POS) |
+				(set->enetrg << TC_CMR_ENETRG_POS) |
+				(set->wavsel << TC_CMR_WAVSEL_POS) |
+				(set->acpa << TC_CMR_ACPA_POS) |
+				(set->acpc << TC_CMR_ACPC_POS) |
+				(set->aeevt << TC_CMR_AEEVT_POS) |
+				(set->aswtrg << TC_CMR_ASWTRG_POS) |
+				(set->bcpb << TC_CMR_BCPB_POS) |
+				(set->bcpc << TC_CMR_BCPC_POS) |
+				(set->beevt << TC_CMR_BEEVT_POS) |
+				(set->bswtrg << TC_CMR_BSWTRG_POS);
+	}
+	return cmr;
+}
+
+/**
+ * Composes the Block Mode Register value of block settings, see
+ * tc_cmr_value().
+ * @param set Settings for the block.
+ * @return The TC_BMR value.
+ */
+static inline uint32_t tc_bmr_value(const tc_block_settings_t *set) {
+	return (set->tc0xc0s << TC_BMR_TC0XC0S_POS) |
+			(set->tc1xc1s << TC_BMR_TC1XC1S_POS) |
+			(set->tc2xc2s << TC_BMR_TC2XCS2_POS) |
+			(set->qden << TC_BMR_QDEN_POS) |
+			(set->posen << TC_BMR_POSEN_POS) |
+			(set->speeden << TC_BMR_SPEEDEN_POS) |
+			(set->qdtrans << TC_BMR_QDTRANS_POS) |
+			(set->edgpha << TC_BMR_EDGPHA_POS) |
+			(set->inva << TC_BMR_INVA_POS) |
+			(set->invb << TC_BMR_INVB_POS) |
+			(set->invidx << TC_BMR_INVIDX_POS) |
+			(set->swap << TC_BMR_SWAP_POS) |
+			(set->idxphb << TC_BMR_IDXPHB_POS) |
+			(set->filter << TC_BMR_FILTER_POS) |
+			(set->maxfilt << TC_BMR_MAXFILT_POS);
+}
+
+/**
+ * Configures a specified counter channel with provided settings, with one
+ * write of TC_CMR.
  * @param set Settings for timer counter channel.
  * Should be a struct of type tc_channel_settings_t.
  * @param tc Timer counter instance.
@@ -434,7 +516,8 @@ typedef struct tc_block_settings {
 void tc_conf_channel(tc_channel_settings_t* set, tc_reg_t *tc, uint32_t channel);
 
 /**
- * Configures a specified timer instance with provided settings.
+ * Configures a specified timer instance with provided settings, with one
+ * write of TC_BMR.
  * @param set Settings for timer counter block.
  * Should be a struct of type tc_block_settings_t.
  * @param tc Timer counter instance.
@@ -524,4 +607,88 @@ void tc_write_reg_b(tc_reg_t * tc, uint32_t channel, uint32_t value);
  */
 void tc_write_reg_c(tc_reg_t * tc, uint32_t channel, uint32_t value);
 
+/**
+ * Calculates the register C value that makes a channel count at TIMER_CLOCK1
+ * (MCK/2) overflow at the requested rate.
+ * @param mck Master clock frequency in Hz.
+ * @param hz Requested rate in Hz.
+ * @return The register C value, or 0 if the rate cannot be reached.
+ */
+uint32_t tc_calc_rate(uint32_t mck, uint32_t hz);
+
+/**
+ * Configures a channel to produce a rising edge on TIOA at the requested
+ * rate and starts it. Each edge can trigger a peripheral, e.g. an ADC
+ * conversion (see adc_set_sample_rate()), without any interrupt.
+ * The channel is clocked by TIMER_CLOCK1 (MCK/2) in waveform mode: RC compare
+ * sets TIOA and restarts the counter, RA compare (half of RC) clears it.
+ * @param tc Timer counter instance.
+ * @param channel Channel to configure.
+ * @param mck Master clock frequency in Hz.
+ * @param hz Requested rate in Hz.
+ * @return The actual rate in Hz, or 0 if the rate cannot be reached.
+ */
+uint32_t tc_set_trigger_rate(tc_reg_t *tc, uint32_t channel, uint32_t mck,
+		uint32_t hz);
+
+/**
+ * Called from the interrupt of a channel.
+ * @param tc Timer counter instance.
+ * @param channel The channel.
+ */
+typedef void (*tc_handler_t)(tc_reg_t *tc, uint32_t channel);
+
+/**
+ * Sets the function that handles the interrupt of a channel and enables
+ * the interrupt in the NVIC, or disables it if the handler is 0. The
+ * interrupt of channel 0 also carries the quadrature decoder interrupts of
+ * the instance.
+ * @param tc Timer counter instance.
+ * @param channel The channel.
+ * @param handler The handler, or 0.
+ */
+void tc_set_handler(tc_reg_t *tc, uint32_t channel, tc_handler_t handler);
+
+/**
+ * The handler of the interrupt of a channel.
+ * @param tc Timer counter instance.
+ * @param channel The channel.
+ * @return The handler, or 0 if there is none.
+ */
+tc_handler_t tc_get_handler(tc_reg_t *tc, uint32_t channel);
+
+/**
+ * Starts a free-running 64-bit timestamp counter on channel 0 and 1 of a
+ * TC instance. Channel 0 counts TIMER_CLOCK1 (MCK/2) over its full 32 bits
+ * and raises TIOA0 half-way through each turn. Channel 1 counts these edges
+ * through XC1, so no interrupt is needed. Use TC1 or TC2 if TC0 triggers the
+ * ADC or the DACC.
+ * @param tc Timer counter instance, its channel 0 and 1 clocks enabled in
+ * the PMC.
+ */
+void tc_timestamp_start(tc_reg_t *tc);
+
+/**
+ * Stops the timestamp counter.
+ * @param tc Timer counter instance.
+ */
+void tc_timestamp_stop(tc_reg_t *tc);
+
+/**
+ * Reads the timestamp counter. Lock-free: the two channels are read again
+ * if an interrupt or the carry from channel 0 to 1 came in between, so it
+ * can be called from tasks and interrupts alike.
+ * @param tc Timer counter instance.
+ * @return The number of MCK/2 periods since tc_timestamp_start().
+ */
+uint64_t tc_timestamp_read(tc_reg_t *tc);
+
+/**
+ * Converts a number of timestamp periods to nanoseconds.
+ * @param ticks Timestamp periods (MCK/2).
+ * @param mck Master clock frequency in Hz.
+ * @return The time in nanoseconds.
+ */
+uint64_t tc_timestamp_to_ns(uint64_t ticks, uint32_t mck);
+
 #endif
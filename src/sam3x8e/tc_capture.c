@@ -0,0 +1,150 @@
+/*
+ * tc_capture.c
+ *
+ * Date:	14 October 2026
+ */
+
+#include "tc_capture.h"
+
+///@cond
+#define TC_SR_LOVRS		(0x1u << 1)
+#define TC_SR_LDRAS		(0x1u << 5)
+#define TC_SR_LDRBS		(0x1u << 6)
+///@endcond
+
+// Capture of each channel, in peripheral ID order (TC0 channel 0 is ID_TC0)
+static tc_capture_t *active[TC_INSTANCES * MAX_CHANNELS];
+
+static uint32_t channel_index(tc_reg_t *tc, uint32_t channel){
+	uint32_t instance = ((uint32_t) tc - (uint32_t) TC0) /
+			((uint32_t) TC1 - (uint32_t) TC0);
+	return instance * MAX_CHANNELS + channel;
+}
+
+static void capture_handler(tc_reg_t *tc, uint32_t channel);
+
+uint8_t tc_capture_start(tc_capture_t *cap, tc_reg_t *tc, uint32_t channel,
+		tc_capture_pulse_t *pulses, uint32_t size){
+	uint32_t index;
+	tc_channel_reg_t *tc_ch;
+
+	if (cap == 0 || pulses == 0 || channel >= MAX_CHANNELS ||
+			(tc != TC0 && tc != TC1 && tc != TC2) ||
+			size == 0 || (size & (size - 1))){
+		return 0;
+	}
+	index = channel_index(tc, channel);
+	if (active[index] != 0 || tc_get_handler(tc, channel) != 0){
+		return 0;
+	}
+	cap->tc = tc;
+	cap->channel = channel;
+	cap->pulses = pulses;
+	cap->mask = size - 1;
+	cap->head = 0;
+	cap->tail = 0;
+	cap->overruns = 0;
+	cap->rise = 0;
+	cap->measured = 0;
+
+	tc_ch = tc->TC_CHANNEL + channel;
+	tc_ch->TC_CCR = TC_CCR_CLKDIS;
+	tc_ch->TC_IDR = ~0u;
+	tc_ch->TC_CMR = (TC_CMR_TCCLKS_TCLK1 << TC_CMR_TCCLKS_POS) |
+			(TC_CMR_CAPTURE_MODE << TC_CMR_WAVE_POS) |
+			(TC_CMR_LDRA_RISING << TC_CMR_LDRA_POS) |
+			(TC_CMR_LDRB_FALLING << TC_CMR_LDRB_POS);
+	(void) PERIPH_REG(tc_ch->TC_SR);
+	active[index] = cap;
+	tc_ch->TC_IER = TC_SR_LDRAS | TC_SR_LDRBS | TC_SR_LOVRS;
+	tc_set_handler(tc, channel, capture_handler);
+	tc_ch->TC_CCR = TC_CCR_CLKEN | TC_CCR_SWTRG;
+	return 1;
+}
+
+void tc_capture_stop(tc_capture_t *cap){
+	uint32_t index = channel_index(cap->tc, cap->channel);
+	tc_channel_reg_t *tc_ch = cap->tc->TC_CHANNEL + cap->channel;
+
+	tc_ch->TC_IDR = ~0u;
+	tc_ch->TC_CCR = TC_CCR_CLKDIS;
+	tc_set_handler(cap->tc, cap->channel, 0);
+	active[index] = 0;
+}
+
+uint32_t tc_capture_available(const tc_capture_t *cap){
+	return cap->head - cap->tail;
+}
+
+uint8_t tc_capture_read(tc_capture_t *cap, tc_capture_pulse_t *pulse){
+	uint32_t tail = cap->tail;
+
+	if (cap->head == tail){
+		return 0;
+	}
+	*pulse = cap->pulses[tail & cap->mask];
+	cap->tail = tail + 1;
+	return 1;
+}
+
+uint8_t tc_capture_measure(tc_capture_t *cap, uint32_t mck,
+		tc_capture_measurement_t *m){
+	tc_capture_pulse_t pulse;
+	uint32_t first = cap->last_rise;
+	uint32_t periods = 0;
+	uint8_t measured = cap->measured;
+
+	// Only the first and the last pulse matter for the mean period
+	while (tc_capture_read(cap, &pulse)){
+		if (measured){
+			periods++;
+		} else {
+			first = pulse.rise;
+			measured = 1;
+		}
+		cap->last_rise = pulse.rise;
+		cap->measured = 1;
+		m->high = pulse.fall - pulse.rise;
+	}
+	if (periods == 0 || pulse.rise == first){
+		return 0;
+	}
+	m->pulses = periods;
+	// differences modulo 2^32 handle the wrap of the counter
+	m->period = (pulse.rise - first) / periods;
+	m->duty = (uint32_t) (((uint64_t) m->high << 16) / m->period);
+	m->frequency_mhz = (uint32_t) ((uint64_t) (mck / 2) * 1000 * periods /
+			(pulse.rise - first));
+	return 1;
+}
+
+/*
+ * Stores the edges of a channel. SR is read once, reading it clears the load
+ * flags.
+ */
+static void capture_handler(tc_reg_t *tc, uint32_t channel){
+	tc_capture_t *cap = active[channel_index(tc, channel)];
+	tc_channel_reg_t *tc_ch = tc->TC_CHANNEL + channel;
+	uint32_t status, head;
+
+	status = tc_ch->TC_SR;
+	if (cap == 0){
+		return;
+	}
+	if (status & TC_SR_LOVRS){
+		cap->overruns++;
+	}
+	if (status & TC_SR_LDRAS){
+		cap->rise = tc_ch->TC_RA;
+	}
+	if (status & TC_SR_LDRBS){
+		head = cap->head;
+		if (head - cap->tail > cap->mask){
+			cap->overruns++;
+		} else {
+			cap->pulses[head & cap->mask].rise = cap->rise;
+			cap->pulses[head & cap->mask].fall = tc_ch->TC_RB;
+			cap->head = head + 1;
+		}
+	}
+}
@@ -0,0 +1,111 @@
+/**
+ * @file tc_capture.h
+ * @brief TC - Interrupt driven input capture
+ * @details Measures pulses on the TIOA pin of a TC channel in capture mode.
+ * The channel counts TIMER_CLOCK1 (MCK/2) and loads RA on the rising and RB
+ * on the falling edge. The TC interrupt stores every pulse (both edge
+ * timestamps) in a ring buffer, nothing is computed there. The period, high
+ * time, duty cycle and frequency are computed when they are read with
+ * tc_capture_measure(). The timestamps wrap after 2^32 counts (about 102 s),
+ * differences are taken modulo 2^32, so one period may not be longer.
+ *
+ * The interrupt takes two entries per pulse, which follows pulses well above
+ * 100 kHz. Pulses that come while the ring buffer is full are counted as
+ * overruns.
+ *
+ * @pre Enable the peripheral clock of the channel in the PMC and set the
+ * TIOA pin to its peripheral function with the PIO.
+ * @date 14 October 2026
+ */
+
+#ifndef TC_CAPTURE_H_
+#define TC_CAPTURE_H_
+
+#include <inttypes.h>
+#include "tc.h"
+
+/**
+ * The timestamps of a pulse, in MCK/2 counts.
+ */
+typedef struct {
+	uint32_t rise; ///< Counter at the rising edge (RA)
+	uint32_t fall; ///< Counter at the falling edge (RB)
+} tc_capture_pulse_t;
+
+/**
+ * State of a capture, see tc_capture_start().
+ */
+typedef struct {
+	tc_reg_t *tc;
+	uint32_t channel;
+	tc_capture_pulse_t *pulses;
+	uint32_t mask;
+	// head is written by the interrupt only, tail by the reader only
+	volatile uint32_t head;
+	volatile uint32_t tail;
+	volatile uint32_t overruns;
+	uint32_t rise;
+	// rising edge of the last pulse that has been measured
+	uint32_t last_rise;
+	uint8_t measured;
+} tc_capture_t;
+
+/**
+ * Measurement of the pulses since the previous tc_capture_measure().
+ */
+typedef struct {
+	uint32_t pulses; ///< The number of periods measured
+	uint32_t period; ///< Mean period, in MCK/2 counts
+	uint32_t high; ///< High time of the last pulse, in MCK/2 counts
+	uint32_t duty; ///< Duty cycle of the last pulse, 65536 = 100 %
+	uint32_t frequency_mhz; ///< Mean frequency, in millihertz
+} tc_capture_measurement_t;
+
+/**
+ * Starts capturing pulses on TIOA of a channel.
+ * @param cap The capture state.
+ * @param tc Timer counter instance.
+ * @param channel Channel to capture with.
+ * @param pulses The ring buffer.
+ * @param size The number of pulses in the ring buffer, a power of two.
+ * @return 1 on success, 0 if the parameters are invalid or the channel is
+ * capturing already.
+ */
+uint8_t tc_capture_start(tc_capture_t *cap, tc_reg_t *tc, uint32_t channel,
+		tc_capture_pulse_t *pulses, uint32_t size);
+
+/**
+ * Stops a capture. The pulses in the ring buffer can still be read.
+ * @param cap The capture state.
+ */
+void tc_capture_stop(tc_capture_t *cap);
+
+/**
+ * The number of pulses in the ring buffer.
+ * @param cap The capture state.
+ * @return The number of pulses.
+ */
+uint32_t tc_capture_available(const tc_capture_t *cap);
+
+/**
+ * Takes the oldest pulse out of the ring buffer.
+ * @param cap The capture state.
+ * @param pulse The pulse.
+ * @return 1 if there was a pulse, otherwise 0.
+ */
+uint8_t tc_capture_read(tc_capture_t *cap, tc_capture_pulse_t *pulse);
+
+/**
+ * Takes all pulses out of the ring buffer and measures them: the mean period
+ * and frequency since the previous measurement and the high time and duty
+ * cycle of the last pulse.
+ * @param cap The capture state.
+ * @param mck Master clock frequency in Hz.
+ * @param m The measurement.
+ * @return 1 if a period has been measured, 0 if fewer than two pulses have
+ * been captured since the start.
+ */
+uint8_t tc_capture_measure(tc_capture_t *cap, uint32_t mck,
+		tc_capture_measurement_t *m);
+
+#endif
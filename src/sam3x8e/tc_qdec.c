@@ -0,0 +1,126 @@
+/*
+ * tc_qdec.c
+ *
+ * Date:	14 October 2026
+ */
+
+#include "tc_qdec.h"
+
+///@cond
+#define TC_QDEC_EVENTS			(QDEC_EVENT_INDEX | QDEC_EVENT_DIRCHG | \
+		QDEC_EVENT_QERR)
+///@endcond
+
+// Callback of each instance
+static qdec_callback_t callbacks[TC_INSTANCES];
+
+static uint32_t instance_index(tc_reg_t *tc){
+	return ((uint32_t) tc - (uint32_t) TC0) /
+			((uint32_t) TC1 - (uint32_t) TC0);
+}
+
+uint8_t qdec_init(qdec_settings_t *set, tc_reg_t *tc, uint32_t mck){
+	tc_channel_reg_t *position = tc->TC_CHANNEL + TC_CHANNEL_0;
+	tc_channel_reg_t *revolutions = tc->TC_CHANNEL + TC_CHANNEL_1;
+	tc_channel_reg_t *time_base = tc->TC_CHANNEL + TC_CHANNEL_2;
+	uint32_t rc = 0;
+
+	if (set->filter > TC_BMR_FILTER_MAX || set->edgpha > 1 ||
+			set->index > 1){
+		return 0;
+	}
+	if (set->speed_period != 0){
+		// TIOA2 toggles on RC compare, so it rises every 2 * RC
+		rc = (uint32_t) ((uint64_t) set->speed_period * (mck / 2) /
+				2000000);
+		if (rc < 2){
+			return 0;
+		}
+	}
+	position->TC_CCR = TC_CCR_CLKDIS;
+	revolutions->TC_CCR = TC_CCR_CLKDIS;
+	time_base->TC_CCR = TC_CCR_CLKDIS;
+
+	tc->TC_BMR = (0x1u << TC_BMR_QDEN_POS) |
+			(0x1u << TC_BMR_POSEN_POS) |
+			((set->speed_period != 0) << TC_BMR_SPEEDEN_POS) |
+			(set->edgpha << TC_BMR_EDGPHA_POS) |
+			(set->inva << TC_BMR_INVA_POS) |
+			(set->invb << TC_BMR_INVB_POS) |
+			(set->swap << TC_BMR_SWAP_POS) |
+			((set->filter != 0) << TC_BMR_FILTER_POS) |
+			(set->filter << TC_BMR_MAXFILT_POS);
+
+	// The trigger of channel 0 is IDX, or TIOA2 when measuring speed
+	position->TC_CMR = (TC_CMR_TCCLKS_XC0 << TC_CMR_TCCLKS_POS) |
+			(TC_CMR_CAPTURE_MODE << TC_CMR_WAVE_POS) |
+			(0x1u << TC_CMR_ABETRG_POS);
+	if (set->speed_period != 0){
+		position->TC_CMR |= (TC_CMR_ETREDG_RISING << TC_CMR_ETRGEDG_POS) |
+				(TC_CMR_LDRA_RISING << TC_CMR_LDRA_POS);
+		time_base->TC_CMR = (TC_CMR_TCCLKS_TCLK1 << TC_CMR_TCCLKS_POS) |
+				(TC_CMR_WAVEFORM_MODE << TC_CMR_WAVE_POS) |
+				(TC_CMR_WAVESEL_UP_RC << TC_CMR_WAVSEL_POS) |
+				(TC_CMR_ACPC_TOGGLE << TC_CMR_ACPC_POS);
+		time_base->TC_RC = rc;
+	} else if (set->index){
+		position->TC_CMR |= (TC_CMR_ETREDG_RISING << TC_CMR_ETRGEDG_POS);
+	}
+	revolutions->TC_CMR = (TC_CMR_TCCLKS_XC0 << TC_CMR_TCCLKS_POS) |
+			(TC_CMR_CAPTURE_MODE << TC_CMR_WAVE_POS);
+
+	position->TC_CCR = TC_CCR_CLKEN | TC_CCR_SWTRG;
+	if (set->index){
+		revolutions->TC_CCR = TC_CCR_CLKEN | TC_CCR_SWTRG;
+	}
+	if (set->speed_period != 0){
+		time_base->TC_CCR = TC_CCR_CLKEN | TC_CCR_SWTRG;
+	}
+	return 1;
+}
+
+int32_t qdec_read_position(tc_reg_t *tc){
+	return (int32_t) tc->TC_CHANNEL[TC_CHANNEL_0].TC_CV;
+}
+
+int32_t qdec_read_revolutions(tc_reg_t *tc){
+	return (int32_t) tc->TC_CHANNEL[TC_CHANNEL_1].TC_CV;
+}
+
+int32_t qdec_read_speed(tc_reg_t *tc){
+	return (int32_t) tc->TC_CHANNEL[TC_CHANNEL_0].TC_RA;
+}
+
+/*
+ * The decoder interrupts come on channel 0. QISR is read once, reading it
+ * clears the events.
+ */
+static void qdec_handler(tc_reg_t *tc, uint32_t channel){
+	uint32_t events = tc->TC_QISR;
+	qdec_callback_t callback = callbacks[instance_index(tc)];
+
+	(void) channel;
+	if (callback != 0 && (events & tc->TC_QIMR)){
+		callback(tc, events & (tc->TC_QIMR | QDEC_DIRECTION));
+	}
+}
+
+uint8_t qdec_set_callback(tc_reg_t *tc, uint32_t events,
+		qdec_callback_t callback){
+	tc_handler_t handler = tc_get_handler(tc, TC_CHANNEL_0);
+
+	if (handler != 0 && handler != qdec_handler){
+		return 0;
+	}
+	tc->TC_QIDR = TC_QDEC_EVENTS;
+	if (events == 0 || callback == 0){
+		tc_set_handler(tc, TC_CHANNEL_0, 0);
+		callbacks[instance_index(tc)] = 0;
+		return 1;
+	}
+	callbacks[instance_index(tc)] = callback;
+	(void) PERIPH_REG(tc->TC_QISR);
+	tc_set_handler(tc, TC_CHANNEL_0, qdec_handler);
+	tc->TC_QIER = events & TC_QDEC_EVENTS;
+	return 1;
+}
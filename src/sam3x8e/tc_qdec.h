@@ -0,0 +1,120 @@
+/**
+ * @file tc_qdec.h
+ * @brief TC - Quadrature decoder
+ * @details Reads an incremental encoder with the quadrature decoder of a TC
+ * instance, so the hardware counts every edge. The phases go to TIOA0 (PHA)
+ * and TIOB0 (PHB) of the instance and the index to TIOA1 (IDX). Channel 0
+ * counts the position up and down, channel 1 the revolutions when an index
+ * is used, and channel 2 is the time base of the speed measurement.
+ *
+ * @pre Enable the peripheral clocks of the three channels of the instance in
+ * the PMC and set the pins to their peripheral function with the PIO.
+ * @date 14 October 2026
+ */
+
+#ifndef TC_QDEC_H_
+#define TC_QDEC_H_
+
+#include <inttypes.h>
+#include "tc.h"
+
+///@{
+/**
+ * Quadrature decoder events, bits of TC_QISR. QDEC_DIRECTION is a level:
+ * set while the position counts down.
+ */
+#define QDEC_EVENT_INDEX		(0x1u << 0) ///< Index pulse
+#define QDEC_EVENT_DIRCHG		(0x1u << 1) ///< Direction change
+#define QDEC_EVENT_QERR			(0x1u << 2) ///< Both phases changed at once
+#define QDEC_DIRECTION			(0x1u << 8) ///< Counting down
+///@}
+
+///@cond
+#define TC_BMR_FILTER_MAX		(63)
+///@endcond
+
+/**
+ * Settings of the quadrature decoder.
+ */
+typedef struct qdec_settings {
+	/**
+	 * Edges counted.
+	 * 0: edges of PHA and PHB (4 counts per encoder line).
+	 * 1: edges of PHA only (2 counts per encoder line).
+	 */
+	uint32_t edgpha;
+	/**
+	 * Index.
+	 * 0: the position counts freely, channel 1 is not used.
+	 * 1: IDX resets the position and channel 1 counts revolutions.
+	 */
+	uint32_t index;
+	/**
+	 * Inverted phA, phB and swapped phases, see tc_block_settings_t.
+	 */
+	uint32_t inva;
+	uint32_t invb;
+	uint32_t swap;
+	/**
+	 * Input filter.
+	 * 0: the inputs are not filtered.
+	 * 1..63: pulses shorter than filter + 1 MCK periods are discarded.
+	 */
+	uint32_t filter;
+	/**
+	 * Time base of the speed measurement in microseconds, 0 disables it.
+	 * The speed measurement resets the position every time base, so the
+	 * position is then only the count since the last time base.
+	 */
+	uint32_t speed_period;
+} qdec_settings_t;
+
+/**
+ * Called from the interrupt of channel 0 for the enabled events.
+ * @param tc Timer counter instance.
+ * @param events The events, prefix QDEC_EVENT_, and QDEC_DIRECTION.
+ */
+typedef void (*qdec_callback_t)(tc_reg_t *tc, uint32_t events);
+
+/**
+ * Sets up the quadrature decoder of an instance and starts counting.
+ * @param set The settings.
+ * @param tc Timer counter instance.
+ * @param mck Master clock frequency in Hz, for the speed time base.
+ * @return 1 on success, 0 if the settings are invalid.
+ */
+uint8_t qdec_init(qdec_settings_t *set, tc_reg_t *tc, uint32_t mck);
+
+/**
+ * Reads the position.
+ * @param tc Timer counter instance.
+ * @return The position in counts, negative below the start position.
+ */
+int32_t qdec_read_position(tc_reg_t *tc);
+
+/**
+ * Reads the number of revolutions (index pulses), with settings.index = 1.
+ * @param tc Timer counter instance.
+ * @return The revolutions, negative when turning backwards.
+ */
+int32_t qdec_read_revolutions(tc_reg_t *tc);
+
+/**
+ * Reads the speed, with settings.speed_period set.
+ * @param tc Timer counter instance.
+ * @return The counts in the last time base, negative when counting down.
+ */
+int32_t qdec_read_speed(tc_reg_t *tc);
+
+/**
+ * Calls a function on quadrature decoder events. Reading TC_QISR clears the
+ * events, so it must not be read elsewhere while the callback is set.
+ * @param tc Timer counter instance.
+ * @param events The events, prefix QDEC_EVENT_, or 0 to disable them.
+ * @param callback The function.
+ * @return 1 on success, 0 if channel 0 has another interrupt handler.
+ */
+uint8_t qdec_set_callback(tc_reg_t *tc, uint32_t events,
+		qdec_callback_t callback);
+
+#endif
@@ -0,0 +1,172 @@
+/*
+ * tc_timer.c
+ *
+ * Date:	14 October 2026
+ */
+
+#include "tc_timer.h"
+#include "id.h"
+#include "irq.h"
+
+// NVIC Interrupt Set-Pending Registers, one bit per peripheral ID
+#define NVIC_ISPR(id)	(((volatile uint32_t *) PERIPH_ADDR(0xE000E200U))[(id) >> 5])
+
+///@cond
+#define TC_SR_CPCS		(0x1u << 4)
+#define TC_TIMER_MAX	(0x7FFFFFFFu)
+///@endcond
+
+// The service, one per application. The list is changed by tasks and the
+// interrupt, so it is changed with interrupts disabled.
+static struct {
+	tc_channel_reg_t *channel;
+	uint32_t id;
+	uint32_t ticks_per_us;
+	// timers sorted by deadline, the earliest first
+	tc_timer_t *head;
+} service;
+
+// Whether deadline a is before deadline b, modulo 2^32
+#define BEFORE(a, b)	((int32_t) ((a) - (b)) < 0)
+
+static void timer_handler(tc_reg_t *tc, uint32_t channel);
+
+uint8_t tc_timer_init(tc_reg_t *tc, uint32_t channel, uint32_t mck){
+	tc_channel_reg_t *tc_ch;
+
+	if (channel >= MAX_CHANNELS || tc_get_handler(tc, channel) != 0){
+		return 0;
+	}
+	tc_ch = tc->TC_CHANNEL + channel;
+	service.channel = tc_ch;
+	service.id = ID_TC0 + ((uint32_t) tc - (uint32_t) TC0) /
+			((uint32_t) TC1 - (uint32_t) TC0) * MAX_CHANNELS + channel;
+	service.ticks_per_us = mck / 2 / 1000000;
+	service.head = 0;
+
+	// Free-running, RC compare only raises the interrupt
+	tc_ch->TC_CCR = TC_CCR_CLKDIS;
+	tc_ch->TC_IDR = ~0u;
+	tc_ch->TC_CMR = (TC_CMR_TCCLKS_TCLK1 << TC_CMR_TCCLKS_POS) |
+			(TC_CMR_WAVEFORM_MODE << TC_CMR_WAVE_POS) |
+			(TC_CMR_WAVESEL_UP << TC_CMR_WAVSEL_POS);
+	(void) PERIPH_REG(tc_ch->TC_SR);
+	tc_set_handler(tc, channel, timer_handler);
+	tc_ch->TC_CCR = TC_CCR_CLKEN | TC_CCR_SWTRG;
+	return 1;
+}
+
+uint32_t tc_timer_now(void){
+	return service.channel->TC_CV;
+}
+
+uint32_t tc_timer_us(uint32_t micros){
+	return micros * service.ticks_per_us;
+}
+
+/*
+ * Removes a timer from the list, with interrupts disabled.
+ */
+static void unlink(tc_timer_t *timer){
+	tc_timer_t **link = &service.head;
+
+	while (*link != 0 && *link != timer){
+		link = &(*link)->next;
+	}
+	if (*link == timer){
+		*link = timer->next;
+	}
+	timer->active = 0;
+}
+
+/*
+ * Inserts a timer after the timers with the same or an earlier deadline,
+ * with interrupts disabled.
+ */
+static void insert(tc_timer_t *timer){
+	tc_timer_t **link = &service.head;
+
+	while (*link != 0 && !BEFORE(timer->deadline, (*link)->deadline)){
+		link = &(*link)->next;
+	}
+	timer->next = *link;
+	*link = timer;
+	timer->active = 1;
+}
+
+/*
+ * Sets RC to the earliest deadline. If it has passed already the compare
+ * would only match after a wrap, so the interrupt is made pending instead.
+ */
+static void schedule(void){
+	tc_channel_reg_t *tc_ch = service.channel;
+
+	if (service.head == 0){
+		tc_ch->TC_IDR = TC_SR_CPCS;
+		return;
+	}
+	tc_ch->TC_RC = service.head->deadline;
+	tc_ch->TC_IER = TC_SR_CPCS;
+	if (!BEFORE(tc_ch->TC_CV, service.head->deadline)){
+		NVIC_ISPR(service.id) = (0x1u << (service.id & 0x1Fu));
+	}
+}
+
+uint8_t tc_timer_start(tc_timer_t *timer, uint32_t delay, uint32_t period,
+		tc_timer_callback_t callback, void *arg){
+	uint32_t primask;
+
+	if (service.channel == 0 || timer == 0 || callback == 0 || delay == 0 ||
+			delay > TC_TIMER_MAX || period > TC_TIMER_MAX){
+		return 0;
+	}
+	primask = irq_save();
+	if (timer->active){
+		unlink(timer);
+	}
+	timer->deadline = service.channel->TC_CV + delay;
+	timer->period = period;
+	timer->callback = callback;
+	timer->arg = arg;
+	insert(timer);
+	schedule();
+	irq_restore(primask);
+	return 1;
+}
+
+void tc_timer_stop(tc_timer_t *timer){
+	uint32_t primask = irq_save();
+
+	if (timer->active){
+		unlink(timer);
+		schedule();
+	}
+	irq_restore(primask);
+}
+
+/*
+ * Calls the timers that have expired and sets RC to the next deadline.
+ */
+static void timer_handler(tc_reg_t *tc, uint32_t channel){
+	tc_channel_reg_t *tc_ch = tc->TC_CHANNEL + channel;
+	tc_timer_t *timer;
+	uint32_t primask;
+
+	(void) PERIPH_REG(tc_ch->TC_SR);
+	primask = irq_save();
+	while (service.head != 0 && !BEFORE(PERIPH_REG(tc_ch->TC_CV), service.head->deadline)){
+		timer = service.head;
+		service.head = timer->next;
+		timer->active = 0;
+		if (timer->period != 0){
+			timer->deadline += timer->period;
+			insert(timer);
+		}
+		// The callback may start and stop timers
+		irq_restore(primask);
+		timer->callback(timer, timer->arg);
+		primask = irq_save();
+	}
+	schedule();
+	irq_restore(primask);
+}
@@ -0,0 +1,91 @@
+/**
+ * @file tc_timer.h
+ * @brief TC - High resolution software timers
+ * @details One-shot and periodic timers with callbacks at MCK/2 resolution
+ * (24 ns at 84 MHz), for protocol timeouts and bit timing that the CoOS
+ * tick (CFG_SYSTICK_FREQ, 10 ms) cannot deliver. One TC channel counts
+ * freely and its RC compare is set to the earliest deadline of a sorted
+ * list of timers. After the timers that expired have been called, RC is set
+ * to the next deadline.
+ *
+ * The callbacks are called from the TC interrupt. They may start and stop
+ * timers, also their own. Deadlines must be less than 2^31 counts ahead
+ * (about 51 s at 84 MHz).
+ *
+ * @pre Enable the peripheral clock of the channel in the PMC.
+ * @date 14 October 2026
+ */
+
+#ifndef TC_TIMER_H_
+#define TC_TIMER_H_
+
+#include <inttypes.h>
+#include "tc.h"
+
+struct tc_timer;
+
+/**
+ * Called from the TC interrupt when a timer expires.
+ * @param timer The timer.
+ * @param arg The argument given with tc_timer_start().
+ */
+typedef void (*tc_timer_callback_t)(struct tc_timer *timer, void *arg);
+
+/**
+ * A timer. The members are used by the service, the memory must stay valid
+ * while the timer is running.
+ */
+typedef struct tc_timer {
+	uint32_t deadline;
+	uint32_t period;
+	tc_timer_callback_t callback;
+	void *arg;
+	struct tc_timer *next;
+	uint8_t active;
+} tc_timer_t;
+
+/**
+ * Starts the timer service on a channel.
+ * @param tc Timer counter instance.
+ * @param channel The channel, its interrupt must be free.
+ * @param mck Master clock frequency in Hz.
+ * @return 1 on success, 0 if the channel is invalid or its interrupt is used.
+ */
+uint8_t tc_timer_init(tc_reg_t *tc, uint32_t channel, uint32_t mck);
+
+/**
+ * The time of the timer service.
+ * @return The counter, in MCK/2 counts.
+ */
+uint32_t tc_timer_now(void);
+
+/**
+ * Converts microseconds to counts of the timer service.
+ * @param micros The time in microseconds.
+ * @return The time in MCK/2 counts.
+ */
+uint32_t tc_timer_us(uint32_t micros);
+
+/**
+ * Starts a timer, or restarts it if it is running.
+ * @param timer The timer.
+ * @param delay The time until the first expiry, in MCK/2 counts (see
+ * tc_timer_us()).
+ * @param period The time between the following expiries, or 0 for a
+ * one-shot timer. The period is kept without drift.
+ * @param callback The function to call.
+ * @param arg The argument of the function.
+ * @return 1 on success, 0 if the service is not started or delay is 0 or
+ * too long.
+ */
+uint8_t tc_timer_start(tc_timer_t *timer, uint32_t delay, uint32_t period,
+		tc_timer_callback_t callback, void *arg);
+
+/**
+ * Stops a timer. The callback is not called after this returns, unless it
+ * is running at the time.
+ * @param timer The timer.
+ */
+void tc_timer_stop(tc_timer_t *timer);
+
+#endif
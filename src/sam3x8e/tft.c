@@ -5,101 +5,431 @@
  */
 
 #include "tft.h"
+#include "ramfunc.h"
+#include "pio_fast.h"
+#include "pmc.h"
+#include "delay.h"
+#if TFT_SMC_DMAC
+#include "dmac.h"
+#endif
+
+// Largest run of pixels of one DMAC transfer
+#define TFT_SMC_DMAC_BLOCK		(4095u)
+// Start of the SRAM, pixels below it are in flash
+#define TFT_SRAM_START			(0x20000000u)
+
+// The span buffers of the SPI backend, big-endian pixels
+static uint8_t spi_span[2][TFT_SPI_SPAN * 2];
+
+// Commands to initialize the screen on the parallel backends
+static const uint16_t panel_init[] = {
+	TFT_SEQ_CMD(0x11, 1), 0x2004,
+	TFT_SEQ_CMD(0x13, 1), 0xCC00,
+	TFT_SEQ_CMD(0x15, 1), 0x2600,
+	TFT_SEQ_CMD(0x14, 1), 0x252A,
+	TFT_SEQ_CMD(0x12, 1), 0x0033,
+	TFT_SEQ_CMD(0x13, 1), 0xCC04,
+	TFT_SEQ_CMD(0x13, 1), 0xCC06,
+	TFT_SEQ_CMD(0x13, 1), 0xCC4F,
+	TFT_SEQ_CMD(0x13, 1), 0x674F,
+	TFT_SEQ_CMD(0x11, 1), 0x2003,
+	TFT_SEQ_CMD(0x30, 1), 0x2609,
+	TFT_SEQ_CMD(0x31, 1), 0x242C,
+	TFT_SEQ_CMD(0x32, 1), 0x1F23,
+	TFT_SEQ_CMD(0x33, 1), 0x2425,
+	TFT_SEQ_CMD(0x34, 1), 0x2226,
+	TFT_SEQ_CMD(0x35, 1), 0x2523,
+	TFT_SEQ_CMD(0x36, 1), 0x1C1A,
+	TFT_SEQ_CMD(0x37, 1), 0x131D,
+	TFT_SEQ_CMD(0x38, 1), 0x0B11,
+	TFT_SEQ_CMD(0x39, 1), 0x1210,
+	TFT_SEQ_CMD(0x3A, 1), 0x1315,
+	TFT_SEQ_CMD(0x3B, 1), 0x3619,
+	TFT_SEQ_CMD(0x3C, 1), 0x0D00,
+	TFT_SEQ_CMD(0x3D, 1), 0x000D,
+	TFT_SEQ_CMD(0x16, 1), 0x0007,
+	TFT_SEQ_CMD(0x02, 1), 0x0013,
+	TFT_SEQ_CMD(0x03, 1), 0x0003,
+	TFT_SEQ_CMD(0x01, 1), 0x0127,
+	TFT_SEQ_CMD(0x08, 1), 0x0303,
+	TFT_SEQ_CMD(0x0A, 1), 0x000B,
+	TFT_SEQ_CMD(0x0B, 1), 0x0003,
+	TFT_SEQ_CMD(0x0C, 1), 0x0000,
+	TFT_SEQ_CMD(0x41, 1), 0x0000,
+	TFT_SEQ_CMD(0x50, 1), 0x0000,
+	TFT_SEQ_CMD(0x60, 1), 0x0005,
+	TFT_SEQ_CMD(0x70, 1), 0x000B,
+	TFT_SEQ_CMD(0x71, 1), 0x0000,
+	TFT_SEQ_CMD(0x78, 1), 0x0000,
+	TFT_SEQ_CMD(0x7A, 1), 0x0000,
+	TFT_SEQ_CMD(0x79, 1), 0x0007,
+	TFT_SEQ_CMD(0x07, 1), 0x0051,
+	TFT_SEQ_CMD(0x07, 1), 0x0053,
+	TFT_SEQ_CMD(0x79, 1), 0x0000,
+	TFT_SEQ_CMD(0x22, 0)
+};
+
+// Commands to initialize an ILI9341-class screen after its software reset
+static const uint16_t ili9341_init[] = {
+	TFT_SEQ_DELAY(5),
+	TFT_SEQ_CMD(0x11, 0),			// sleep out
+	TFT_SEQ_DELAY(120),
+	TFT_SEQ_CMD8(0x3A, 1), 0x55,	// 16 bits per pixel
+	TFT_SEQ_CMD8(0x36, 1), 0x48,	// portrait, BGR
+	TFT_SEQ_CMD(0x29, 0)			// display on
+};
+
+#define SEQ_WORDS(seq)	(sizeof(seq) / sizeof((seq)[0]))
+
+// The whole screen scrolls, with no offset, like after a reset
+static void tft_scroll_reset(tft_screen *screen) {
+	screen->scroll_top = 0;
+	screen->scroll_lines = screen->height + 1;
+	screen->scroll_offset = 0;
+}
 
 void tft_init(tft_screen *screen) {
+	tft_init_bus(screen);
+	tft_scroll_reset(screen);
+
 	pio_set_pin((pio_reg_t *)screen->PORT_WR, screen->PIN_WR, 1);	//WR high
-	pio_set_pin((pio_reg_t *)screen->PORT_CS, screen->PIN_CS, 0);	//CS low
-
-	//write commands to initialize screen
-	tft_write_com(screen, 0x11); tft_write_data(screen, 0x2004);
-	tft_write_com(screen, 0x13); tft_write_data(screen, 0xCC00);
-	tft_write_com(screen, 0x15); tft_write_data(screen, 0x2600);
-	tft_write_com(screen, 0x14); tft_write_data(screen, 0x252A);
-	tft_write_com(screen, 0x12); tft_write_data(screen, 0x0033);
-	tft_write_com(screen, 0x13); tft_write_data(screen, 0xCC04);
-	tft_write_com(screen, 0x13); tft_write_data(screen, 0xCC06);
-	tft_write_com(screen, 0x13); tft_write_data(screen, 0xCC4F);
-	tft_write_com(screen, 0x13); tft_write_data(screen, 0x674F);
-	tft_write_com(screen, 0x11); tft_write_data(screen, 0x2003);
-	tft_write_com(screen, 0x30); tft_write_data(screen, 0x2609);
-	tft_write_com(screen, 0x31); tft_write_data(screen, 0x242C);
-	tft_write_com(screen, 0x32); tft_write_data(screen, 0x1F23);
-	tft_write_com(screen, 0x33); tft_write_data(screen, 0x2425);
-	tft_write_com(screen, 0x34); tft_write_data(screen, 0x2226);
-	tft_write_com(screen, 0x35); tft_write_data(screen, 0x2523);
-	tft_write_com(screen, 0x36); tft_write_data(screen, 0x1C1A);
-	tft_write_com(screen, 0x37); tft_write_data(screen, 0x131D);
-	tft_write_com(screen, 0x38); tft_write_data(screen, 0x0B11);
-	tft_write_com(screen, 0x39); tft_write_data(screen, 0x1210);
-	tft_write_com(screen, 0x3A); tft_write_data(screen, 0x1315);
-	tft_write_com(screen, 0x3B); tft_write_data(screen, 0x3619);
-	tft_write_com(screen, 0x3C); tft_write_data(screen, 0x0D00);
-	tft_write_com(screen, 0x3D); tft_write_data(screen, 0x000D);
-	tft_write_com(screen, 0x16); tft_write_data(screen, 0x0007);
-	tft_write_com(screen, 0x02); tft_write_data(screen, 0x0013);
-	tft_write_com(screen, 0x03); tft_write_data(screen, 0x0003);
-	tft_write_com(screen, 0x01); tft_write_data(screen, 0x0127);
-	tft_write_com(screen, 0x08); tft_write_data(screen, 0x0303);
-	tft_write_com(screen, 0x0A); tft_write_data(screen, 0x000B);
-	tft_write_com(screen, 0x0B); tft_write_data(screen, 0x0003);
-	tft_write_com(screen, 0x0C); tft_write_data(screen, 0x0000);
-	tft_write_com(screen, 0x41); tft_write_data(screen, 0x0000);
-	tft_write_com(screen, 0x50); tft_write_data(screen, 0x0000);
-	tft_write_com(screen, 0x60); tft_write_data(screen, 0x0005);
-	tft_write_com(screen, 0x70); tft_write_data(screen, 0x000B);
-	tft_write_com(screen, 0x71); tft_write_data(screen, 0x0000);
-	tft_write_com(screen, 0x78); tft_write_data(screen, 0x0000);
-	tft_write_com(screen, 0x7A); tft_write_data(screen, 0x0000);
-	tft_write_com(screen, 0x79); tft_write_data(screen, 0x0007);
-	tft_write_com(screen, 0x07); tft_write_data(screen, 0x0051);
-	tft_write_com(screen, 0x07); tft_write_data(screen, 0x0053);
-	tft_write_com(screen, 0x79); tft_write_data(screen, 0x0000);
-	tft_write_com(screen, 0x22);
-
-	pio_set_pin((pio_reg_t *)screen->PORT_CS, screen->PIN_CS, 1);	//CS high
+	tft_select(screen, 1);
+	tft_write_seq(screen, panel_init, SEQ_WORDS(panel_init));
+	tft_select(screen, 0);
 }
 
-void tft_clear(tft_screen *screen) {
-	pio_set_pin((pio_reg_t *)screen->PORT_CS, screen->PIN_CS, 0);
-	uint16_t x,y;
-	tft_set_xy(screen, 0, (uint16_t) screen->width, 0, (uint16_t) screen->height);
-	for(x = 0; x <= screen->width; x++) {
-		for(y = 0; y <= screen->height; y++) {
-			tft_write_data(screen, 0x0000);
-		}
+uint8_t tft_init_smc(tft_screen *screen, uint32_t cs, uint32_t rs_line,
+		uint32_t bus_width) {
+	uint32_t mck = pmc_get_mck_freq();
+	smc_settings_t settings;
+	uint32_t base;
+
+	if (rs_line == 0 || rs_line > 23) {
+		return 0;
 	}
-	pio_set_pin((pio_reg_t *)screen->PORT_CS, screen->PIN_CS, 1);
+	settings.bus_width = bus_width;
+	settings.nwe_setup = smc_ns_to_cycles(TFT_SMC_WR_SETUP_NS, mck);
+	settings.nwe_pulse = smc_ns_to_cycles(TFT_SMC_WR_PULSE_NS, mck);
+	settings.nwe_cycle = smc_ns_to_cycles(TFT_SMC_WR_CYCLE_NS, mck);
+	if (settings.nwe_cycle < settings.nwe_setup + settings.nwe_pulse) {
+		settings.nwe_cycle = settings.nwe_setup + settings.nwe_pulse;
+	}
+	// the screen is not read, the read timings only have to be valid
+	settings.nrd_setup = settings.nwe_setup;
+	settings.nrd_pulse = settings.nwe_pulse;
+	settings.nrd_cycle = settings.nwe_cycle;
+	if (!smc_init_cs(cs, &settings)) {
+		return 0;
+	}
+	// RS is an address line, A0 changes within the two cycles of a word
+	base = SMC_CS_ADDR(cs);
+	screen->smc_com = (volatile uint16_t *) base;
+	screen->smc_data = (volatile uint16_t *) (base | (1u << rs_line));
+	screen->smc_wide = (bus_width == SMC_BUS_16);
+	screen->smc_dmac = TFT_SMC_NO_DMAC;
+#if TFT_SMC_DMAC
+	dmac_init();
+	if (!dmac_channel_alloc(&screen->smc_dmac)) {
+		screen->smc_dmac = TFT_SMC_NO_DMAC;
+	}
+#endif
+	screen->bus_backend = TFT_BUS_SMC;
+	tft_scroll_reset(screen);
+	tft_write_seq(screen, panel_init, SEQ_WORDS(panel_init));
+	return 1;
+}
+
+uint8_t tft_init_spi(tft_screen *screen, spi_reg_t *spi, uint8_t selector) {
+	uint8_t com = 0x01;
+
+	screen->spi = spi;
+	screen->spi_selector = selector;
+	screen->spi_next = 0;
+	screen->bus_backend = TFT_BUS_SPI;
+	tft_scroll_reset(screen);
+
+	// software reset, also checks the selector
+	pio_set_pin((pio_reg_t *)screen->PORT_RS, screen->PIN_RS, 0);
+	if (!spi_transfer(spi, selector, &com, 0, 1)) {
+		return 0;
+	}
+	tft_write_seq(screen, ili9341_init, SEQ_WORDS(ili9341_init));
+	return 1;
+}
+
+
+void tft_clear(tft_screen *screen) {
+	tft_fast_fill(screen, 0x0000);
 }
 
 void tft_write(tft_screen *screen, uint16_t x, uint16_t y, uint16_t color) {
-	pio_set_pin((pio_reg_t *)screen->PORT_CS, screen->PIN_CS, 0);
+	tft_select(screen, 1);
 	tft_set_xy(screen, x, x, y, y);
 	tft_write_data(screen, color);
 }
 
-/*uint32_t tft_read_input(tft_screen *screen, uint32_t *x, uint32_t *y) {
-	return 0;
-}*/
+void tft_fill_rect(tft_screen *screen, uint16_t x, uint16_t y, uint16_t w,
+		uint16_t h, uint16_t color) {
+	uint32_t x2 = (uint32_t) x + w - 1;
+	uint32_t y2 = (uint32_t) y + h - 1;
+
+	// nothing to draw?
+	if ((w == 0) || (h == 0) || (x > screen->width) || (y > screen->height)) {
+		return;
+	}
+	// clip to the screen
+	if (x2 > screen->width) {
+		x2 = screen->width;
+	}
+	if (y2 > screen->height) {
+		y2 = screen->height;
+	}
+
+	tft_select(screen, 1);
+	tft_set_xy(screen, x, (uint16_t) x2, y, (uint16_t) y2);
+	tft_stream_color(screen, color, (x2 - x + 1) * (y2 - y + 1));
+	tft_select(screen, 0);
+}
+
+void tft_hline(tft_screen *screen, uint16_t x, uint16_t y, uint16_t len,
+		uint16_t color) {
+	tft_fill_rect(screen, x, y, len, 1, color);
+}
+
+void tft_vline(tft_screen *screen, uint16_t x, uint16_t y, uint16_t len,
+		uint16_t color) {
+	tft_fill_rect(screen, x, y, 1, len, color);
+}
+
+void tft_write_span(tft_screen *screen, uint16_t x, uint16_t y, uint16_t len,
+		const uint16_t *pixels) {
+	uint32_t x2 = (uint32_t) x + len - 1;
+
+	if ((len == 0) || (x > screen->width) || (y > screen->height)) {
+		return;
+	}
+	if (x2 > screen->width) {
+		x2 = screen->width;
+	}
+
+	tft_select(screen, 1);
+	tft_set_xy(screen, x, (uint16_t) x2, y, y);
+	tft_stream_pixels(screen, pixels, x2 - x + 1);
+	tft_select(screen, 0);
+}
+
+void tft_fast_fill(tft_screen *screen, uint16_t color) {
+	tft_fill_rect(screen, 0, 0, (uint16_t) (screen->width + 1),
+			(uint16_t) (screen->height + 1), color);
+}
+
+uint8_t tft_scroll_set_area(tft_screen *screen, uint16_t top, uint16_t bottom) {
+	uint32_t rows = screen->height + 1;
+
+	if ((uint32_t) top + bottom >= rows) {
+		return 0;
+	}
+	if (screen->bus_backend != TFT_BUS_SPI && (top || bottom)) {
+		return 0;
+	}
+	screen->scroll_top = top;
+	screen->scroll_lines = rows - top - bottom;
+	screen->scroll_offset = 0;
+
+	tft_select(screen, 1);
+	if (screen->bus_backend == TFT_BUS_SPI) {
+		// vertical scrolling definition, then the start address
+		const uint16_t seq[] = {
+			TFT_SEQ_CMD(0x33, 3), top, (uint16_t) screen->scroll_lines, bottom,
+			TFT_SEQ_CMD(0x37, 1), top
+		};
+		tft_write_seq(screen, seq, SEQ_WORDS(seq));
+	} else {
+		// vertical scroll control
+		const uint16_t seq[] = {
+			TFT_SEQ_CMD(0x41, 1), 0x0000
+		};
+		tft_write_seq(screen, seq, SEQ_WORDS(seq));
+	}
+	tft_select(screen, 0);
+	return 1;
+}
+
+void tft_scroll_to(tft_screen *screen, uint32_t offset) {
+	offset %= screen->scroll_lines;
+	screen->scroll_offset = offset;
+
+	tft_select(screen, 1);
+	if (screen->bus_backend == TFT_BUS_SPI) {
+		// vertical scrolling start address, a row of the memory
+		const uint16_t seq[] = {
+			TFT_SEQ_CMD(0x37, 1), (uint16_t) (screen->scroll_top + offset)
+		};
+		tft_write_seq(screen, seq, SEQ_WORDS(seq));
+	} else {
+		const uint16_t seq[] = {
+			TFT_SEQ_CMD(0x41, 1), (uint16_t) offset
+		};
+		tft_write_seq(screen, seq, SEQ_WORDS(seq));
+	}
+	tft_select(screen, 0);
+}
+
+uint16_t tft_scroll_row(const tft_screen *screen, uint16_t y) {
+	uint32_t row = y;
+
+	if (row < screen->scroll_top ||
+		row >= screen->scroll_top + screen->scroll_lines) {
+		return y;
+	}
+	row -= screen->scroll_top;
+	row = (row + screen->scroll_offset) % screen->scroll_lines;
+	return (uint16_t) (screen->scroll_top + row);
+}
 
 // The funcitons below should not be used by the API user
 // They are only intended as "helper" functions for the tft-api
 
 void tft_set_xy(tft_screen *screen, uint16_t x1, uint16_t x2, uint16_t y1, uint16_t y2) {
-	tft_write_com(screen, 0x46); tft_write_data(screen, (uint16_t) ((x2 << 8) | x1) );
-	tft_write_com(screen, 0x47); tft_write_data(screen, y2 );
-	tft_write_com(screen, 0x48); tft_write_data(screen, y1 );
-	tft_write_com(screen, 0x20); tft_write_data(screen, x1 );
-	tft_write_com(screen, 0x21); tft_write_data(screen, y1 );
-	tft_write_com(screen, 0x22);
+	if (screen->bus_backend == TFT_BUS_SPI) {
+		// column and page address set, then memory write
+		const uint16_t seq[] = {
+			TFT_SEQ_CMD(0x2A, 2), x1, x2,
+			TFT_SEQ_CMD(0x2B, 2), y1, y2,
+			TFT_SEQ_CMD(0x2C, 0)
+		};
+		tft_write_seq(screen, seq, SEQ_WORDS(seq));
+	} else {
+		const uint16_t seq[] = {
+			TFT_SEQ_CMD(0x46, 1), (uint16_t) ((x2 << 8) | x1),
+			TFT_SEQ_CMD(0x47, 1), y2,
+			TFT_SEQ_CMD(0x48, 1), y1,
+			TFT_SEQ_CMD(0x20, 1), x1,
+			TFT_SEQ_CMD(0x21, 1), y1,
+			TFT_SEQ_CMD(0x22, 0)
+		};
+		tft_write_seq(screen, seq, SEQ_WORDS(seq));
+	}
+}
+
+void tft_select(tft_screen *screen, uint8_t select) {
+	if (screen->bus_backend == TFT_BUS_PIO) {
+		pio_set_pin((pio_reg_t *)screen->PORT_CS, screen->PIN_CS, !select);
+	} else if (screen->bus_backend == TFT_BUS_SPI && !select) {
+		while (spi_transfer_busy());
+	}
+}
+
+/*
+ * Sends bytes on the SPI backend after the last span, RS is left as it is.
+ */
+static void tft_spi_write(tft_screen *screen, const uint8_t *bytes,
+		uint32_t count) {
+	while (spi_transfer_busy());
+	spi_transfer(screen->spi, (uint8_t) screen->spi_selector, bytes, 0, count);
+}
+
+/*
+ * Sets RS after the last span, for a command (0) or data (1).
+ */
+static void tft_spi_rs(tft_screen *screen, uint32_t level) {
+	pio_reg_t *port = (pio_reg_t *)screen->PORT_RS;
+
+	// a span in flight is data, so RS is already high for more data
+	if (((port->PIO_ODSR >> screen->PIN_RS) & 0x1u) != level) {
+		while (spi_transfer_busy());
+		pio_set_pin(port, screen->PIN_RS, level);
+	}
+}
+
+static void tft_spi_command(tft_screen *screen, uint8_t com,
+		const uint8_t *params, uint32_t count) {
+	tft_spi_rs(screen, 0);
+	tft_spi_write(screen, &com, 1);
+	if (count) {
+		tft_spi_rs(screen, 1);
+		tft_spi_write(screen, params, count);
+	}
+}
+
+/*
+ * Sends a 16-bit word on the SPI backend, high byte first.
+ */
+static void tft_spi_word(tft_screen *screen, uint16_t data) {
+	uint8_t bytes[2] = { (uint8_t) (data >> 8), (uint8_t) data };
+
+	tft_spi_write(screen, bytes, 2);
+}
+
+/*
+ * tft_stream_pixels() and tft_stream_color() (pixels 0) on the SPI backend.
+ * Each span is swapped into the free buffer while the other one is sent,
+ * the last one is left to the DMAC.
+ */
+static void tft_spi_stream(tft_screen *screen, const uint16_t *pixels,
+		uint16_t color, uint32_t count) {
+	// each buffer holds the color after its first span
+	uint32_t fresh = 2;
+	uint32_t n, i;
+	uint8_t *buf;
+
+	tft_spi_rs(screen, 1);
+	while (count) {
+		n = (count < TFT_SPI_SPAN) ? count : TFT_SPI_SPAN;
+		buf = spi_span[screen->spi_next];
+		if (pixels) {
+			for (i = 0; i < n; i++) {
+				buf[2 * i] = (uint8_t) (pixels[i] >> 8);
+				buf[2 * i + 1] = (uint8_t) pixels[i];
+			}
+			pixels += n;
+		} else if (fresh) {
+			for (i = 0; i < TFT_SPI_SPAN; i++) {
+				buf[2 * i] = (uint8_t) (color >> 8);
+				buf[2 * i + 1] = (uint8_t) color;
+			}
+			fresh--;
+		}
+		while (spi_transfer_busy());
+		spi_transfer_async(screen->spi, (uint8_t) screen->spi_selector, buf, 0,
+				n * 2, 0);
+		screen->spi_next ^= 1u;
+		count -= n;
+	}
+}
+
+/*
+ * The store of a word on the SMC backend. On an 8-bit bus the SMC sends
+ * the low byte (lower address) first, so the bytes are swapped.
+ */
+static inline uint16_t tft_smc_word(tft_screen *screen, uint16_t data) {
+	return screen->smc_wide ? data : (uint16_t) ((data << 8) | (data >> 8));
 }
 
 void tft_write_com(tft_screen *screen, uint8_t com) {
+	if (screen->bus_backend == TFT_BUS_SMC) {
+		*screen->smc_com = tft_smc_word(screen, com);
+		return;
+	}
+	if (screen->bus_backend == TFT_BUS_SPI) {
+		tft_spi_command(screen, com, 0, 0);
+		return;
+	}
 	//RS low
 	pio_set_pin((pio_reg_t *)screen->PORT_RS, screen->PIN_RS, 0);
 	tft_write_bus(screen, com);
 }
 
 void tft_write_data(tft_screen *screen, uint16_t data) {
+	if (screen->bus_backend == TFT_BUS_SMC) {
+		*screen->smc_data = tft_smc_word(screen, data);
+		return;
+	}
+	if (screen->bus_backend == TFT_BUS_SPI) {
+		tft_spi_rs(screen, 1);
+		tft_spi_word(screen, data);
+		return;
+	}
 	//RS high
 	pio_set_pin((pio_reg_t *)screen->PORT_RS, screen->PIN_RS, 1);
 	tft_write_bus(screen, data);
@@ -135,11 +465,316 @@ void tft_commit_bus(tft_screen *screen) {
 	pio_set_pin((pio_reg_t *)screen->PORT_WR, screen->PIN_WR, 1);
 }
 
-void tft_write_bus(tft_screen *screen, uint16_t data) {
-	tft_clear_bus(screen);
-	tft_set_bus(screen, (uint8_t)(data>>8));
-	tft_commit_bus(screen);
-	tft_clear_bus(screen);
-	tft_set_bus(screen, (uint8_t)data);
-	tft_commit_bus(screen);
+void tft_conf_pins(tft_screen *screen) {
+	const uint32_t ports[8] = {
+		screen->PORT_D0, screen->PORT_D1, screen->PORT_D2, screen->PORT_D3,
+		screen->PORT_D4, screen->PORT_D5, screen->PORT_D6, screen->PORT_D7
+	};
+	const uint32_t pins[8] = {
+		screen->PIN_D0, screen->PIN_D1, screen->PIN_D2, screen->PIN_D3,
+		screen->PIN_D4, screen->PIN_D5, screen->PIN_D6, screen->PIN_D7
+	};
+	pio_pin_cfg_t cfg[11];
+	uint32_t i;
+
+	// all pins are outputs, the control signals are inactive (high)
+	cfg[0] = (pio_pin_cfg_t) {(pio_reg_t *) screen->PORT_CS,
+		(uint8_t) screen->PIN_CS, PIO_CFG_OUTPUT, PIO_CFG_PULLUP | PIO_CFG_HIGH};
+	cfg[1] = (pio_pin_cfg_t) {(pio_reg_t *) screen->PORT_WR,
+		(uint8_t) screen->PIN_WR, PIO_CFG_OUTPUT, PIO_CFG_PULLUP | PIO_CFG_HIGH};
+	cfg[2] = (pio_pin_cfg_t) {(pio_reg_t *) screen->PORT_RS,
+		(uint8_t) screen->PIN_RS, PIO_CFG_OUTPUT, PIO_CFG_PULLUP | PIO_CFG_HIGH};
+	for (i = 0; i < 8; i++) {
+		cfg[3 + i] = (pio_pin_cfg_t) {(pio_reg_t *) ports[i],
+			(uint8_t) pins[i], PIO_CFG_OUTPUT, PIO_CFG_PULLUP};
+	}
+	pio_apply_config(cfg, 11);
+}
+
+void tft_init_bus(tft_screen *screen) {
+	const uint32_t ports[8] = {
+		screen->PORT_D0, screen->PORT_D1, screen->PORT_D2, screen->PORT_D3,
+		screen->PORT_D4, screen->PORT_D5, screen->PORT_D6, screen->PORT_D7
+	};
+	const uint32_t pins[8] = {
+		screen->PIN_D0, screen->PIN_D1, screen->PIN_D2, screen->PIN_D3,
+		screen->PIN_D4, screen->PIN_D5, screen->PIN_D6, screen->PIN_D7
+	};
+	tft_bus_group_t *group;
+	uint32_t i, j;
+
+	screen->bus_groups = 0;
+	// sort the data pins into one group per port
+	for (i = 0; i < 8; i++) {
+		for (j = 0; j < screen->bus_groups; j++) {
+			if (screen->bus[j].port == (pio_reg_t *) ports[i]) {
+				break;
+			}
+		}
+		group = &screen->bus[j];
+		if (j == screen->bus_groups) {
+			group->port = (pio_reg_t *) ports[i];
+			group->mask = 0;
+			group->count = 0;
+			screen->bus_groups++;
+		}
+		group->bit[group->count] = (uint8_t) i;
+		group->pin[group->count] = (uint8_t) pins[i];
+		group->mask |= (0x1u << pins[i]);
+		group->count++;
+	}
+
+	// D0-D7 on consecutive pins of one port? Then a shift is enough.
+	screen->bus_contiguous = 0;
+	screen->bus_shift = 0;
+	if ((screen->bus_groups == 1) && (pins[0] <= 24) &&
+		(screen->bus[0].mask == (0xFFu << pins[0]))) {
+		screen->bus_contiguous = 1;
+		for (i = 0; i < 8; i++) {
+			if (pins[i] != pins[0] + i) {
+				screen->bus_contiguous = 0;
+			}
+		}
+		screen->bus_shift = pins[0];
+	}
+
+	screen->bus_backend = TFT_BUS_PIO;
+	// only the data pins will be affected by writes to PIO_ODSR
+	for (j = 0; j < screen->bus_groups; j++) {
+		PIO_FAST_REG(screen->bus[j].port, PIO_OWER) = screen->bus[j].mask;
+	}
+}
+
+/*
+ * Put a byte on the data bus, one masked PIO_ODSR store per port. The bus
+ * and WR are written through volatile pointers, so that no store is merged
+ * or dropped between the WR pulses.
+ */
+static inline void tft_put_bus(tft_screen *screen, uint8_t value) {
+	tft_bus_group_t *group;
+	uint32_t levels;
+	uint32_t i, j;
+
+	if (screen->bus_contiguous) {
+		PIO_FAST_REG(screen->bus[0].port, PIO_ODSR) =
+				((uint32_t) value) << screen->bus_shift;
+		return;
+	}
+	for (j = 0; j < screen->bus_groups; j++) {
+		group = &screen->bus[j];
+		levels = 0;
+		for (i = 0; i < group->count; i++) {
+			levels |= (((uint32_t) value >> group->bit[i]) & 0x1u) << group->pin[i];
+		}
+		PIO_FAST_REG(group->port, PIO_ODSR) = levels;
+	}
+}
+
+/*
+ * Put a 16-bit word on the bus, high byte first, and pulse WR for each.
+ */
+static inline void tft_put_word(tft_screen *screen, uint16_t data) {
+	pio_reg_t *wr_port = (pio_reg_t *) screen->PORT_WR;
+	uint32_t wr_pin = (0x1u << screen->PIN_WR);
+
+	tft_put_bus(screen, (uint8_t)(data>>8));
+	//pulse WR
+	PIO_FAST_REG(wr_port, PIO_CODR) = wr_pin;
+	PIO_FAST_REG(wr_port, PIO_SODR) = wr_pin;
+	tft_put_bus(screen, (uint8_t)data);
+	PIO_FAST_REG(wr_port, PIO_CODR) = wr_pin;
+	PIO_FAST_REG(wr_port, PIO_SODR) = wr_pin;
+}
+
+RAMFUNC_HOT void tft_write_bus(tft_screen *screen, uint16_t data) {
+	if (screen->bus_backend == TFT_BUS_SMC) {
+		*screen->smc_data = tft_smc_word(screen, data);
+		return;
+	}
+	if (screen->bus_backend == TFT_BUS_SPI) {
+		tft_spi_word(screen, data);
+		return;
+	}
+	tft_put_word(screen, data);
+}
+
+RAMFUNC_HOT void tft_write_seq(tft_screen *screen, const uint16_t *seq,
+		uint32_t words) {
+	const uint16_t *end = seq + words;
+	pio_reg_t *rs_port = (pio_reg_t *) screen->PORT_RS;
+	uint32_t rs_pin = (0x1u << screen->PIN_RS);
+	uint8_t bytes[2 * 63];
+	uint32_t count, n;
+	uint16_t head;
+	uint8_t com;
+
+	while (seq < end) {
+		head = *seq++;
+		if (head & TFT_SEQ_WAIT) {
+			delay_ms(head & ~TFT_SEQ_WAIT);
+			continue;
+		}
+		com = (uint8_t) head;
+		count = (head >> 8) & 0x3Fu;
+		if (screen->bus_backend == TFT_BUS_SMC) {
+			*screen->smc_com = tft_smc_word(screen, com);
+			while (count--) {
+				*screen->smc_data = tft_smc_word(screen, *seq++);
+			}
+		} else if (screen->bus_backend == TFT_BUS_SPI) {
+			tft_spi_rs(screen, 0);
+			tft_spi_write(screen, &com, 1);
+			for (n = 0; count; count--) {
+				if (!(head & TFT_SEQ_BYTES)) {
+					bytes[n++] = (uint8_t) (*seq >> 8);
+				}
+				bytes[n++] = (uint8_t) *seq++;
+			}
+			if (n) {
+				tft_spi_rs(screen, 1);
+				tft_spi_write(screen, bytes, n);
+			}
+		} else {
+			PIO_FAST_REG(rs_port, PIO_CODR) = rs_pin;
+			tft_put_word(screen, com);
+			if (count) {
+				PIO_FAST_REG(rs_port, PIO_SODR) = rs_pin;
+				while (count--) {
+					tft_put_word(screen, *seq++);
+				}
+			}
+		}
+	}
+}
+
+#if TFT_SMC_DMAC
+/*
+ * Writes count words from src to the data address of the SMC with the DMAC,
+ * in blocks of TFT_SMC_DMAC_BLOCK. src is incremented if src_incr is 1.
+ *
+ * ret The number of words left when the DMAC could not be started.
+ */
+static uint32_t tft_smc_dmac(tft_screen *screen, const uint16_t *src,
+		uint32_t src_incr, uint32_t count) {
+	dmac_transfer_t transfer;
+
+	transfer.dst = (void *) screen->smc_data;
+	transfer.width = DMAC_WIDTH_HALFWORD;
+	transfer.flow = DMAC_MEM2MEM;
+	transfer.src_incr = src_incr;
+	transfer.dst_incr = 0;
+	transfer.per = 0;
+	while (count) {
+		transfer.src = src;
+		transfer.count = (count < TFT_SMC_DMAC_BLOCK) ?
+				count : TFT_SMC_DMAC_BLOCK;
+		if (!dmac_start(screen->smc_dmac, &transfer, 0, 0)) {
+			break;
+		}
+		while (dmac_busy(screen->smc_dmac));
+		if (src_incr) {
+			src += transfer.count;
+		}
+		count -= transfer.count;
+	}
+	return count;
+}
+#endif
+
+/*
+ * tft_stream_color() on the SMC backend, one store per pixel. A run of
+ * more than one window row goes to the DMAC.
+ */
+static void tft_smc_stream_color(tft_screen *screen, uint16_t color,
+		uint32_t count) {
+	volatile uint16_t *data = screen->smc_data;
+	uint16_t word = tft_smc_word(screen, color);
+
+#if TFT_SMC_DMAC
+	if (screen->smc_dmac != TFT_SMC_NO_DMAC && count > screen->width) {
+		count = tft_smc_dmac(screen, &word, 0, count);
+	}
+#endif
+	while (count--) {
+		*data = word;
+	}
+}
+
+/*
+ * tft_stream_pixels() on the SMC backend. The DMAC can only move the
+ * pixels as they are on a 16-bit bus, an 8-bit bus needs the bytes swapped,
+ * and it only reads them from SRAM.
+ */
+static void tft_smc_stream_pixels(tft_screen *screen, const uint16_t *pixels,
+		uint32_t count) {
+	volatile uint16_t *data = screen->smc_data;
+
+#if TFT_SMC_DMAC
+	uint32_t left;
+
+	if (screen->smc_dmac != TFT_SMC_NO_DMAC && screen->smc_wide &&
+		count > screen->width && (uint32_t) pixels >= TFT_SRAM_START) {
+		left = tft_smc_dmac(screen, pixels, 1, count);
+		pixels += count - left;
+		count = left;
+	}
+#endif
+	if (screen->smc_wide) {
+		while (count--) {
+			*data = *pixels++;
+		}
+	} else {
+		while (count--) {
+			*data = tft_smc_word(screen, *pixels++);
+		}
+	}
+}
+
+RAMFUNC_HOT void tft_stream_color(tft_screen *screen, uint16_t color, uint32_t count) {
+	pio_reg_t *wr_port = (pio_reg_t *) screen->PORT_WR;
+	uint32_t wr_pin = (0x1u << screen->PIN_WR);
+
+	if (screen->bus_backend == TFT_BUS_SMC) {
+		tft_smc_stream_color(screen, color, count);
+		return;
+	}
+	if (screen->bus_backend == TFT_BUS_SPI) {
+		tft_spi_stream(screen, 0, color, count);
+		return;
+	}
+	//RS high
+	pio_set_pin((pio_reg_t *)screen->PORT_RS, screen->PIN_RS, 1);
+
+	if ((color >> 8) == (color & 0xFFu)) {
+		// both bytes are equal (black, white...), only pulse WR
+		tft_put_bus(screen, (uint8_t) color);
+		while (count--) {
+			PIO_FAST_REG(wr_port, PIO_CODR) = wr_pin;
+			PIO_FAST_REG(wr_port, PIO_SODR) = wr_pin;
+			PIO_FAST_REG(wr_port, PIO_CODR) = wr_pin;
+			PIO_FAST_REG(wr_port, PIO_SODR) = wr_pin;
+		}
+	} else {
+		while (count--) {
+			tft_put_word(screen, color);
+		}
+	}
+}
+
+RAMFUNC_HOT void tft_stream_pixels(tft_screen *screen, const uint16_t *pixels,
+		uint32_t count) {
+	if (screen->bus_backend == TFT_BUS_SMC) {
+		tft_smc_stream_pixels(screen, pixels, count);
+		return;
+	}
+	if (screen->bus_backend == TFT_BUS_SPI) {
+		tft_spi_stream(screen, pixels, 0, count);
+		return;
+	}
+	//RS high
+	pio_set_pin((pio_reg_t *)screen->PORT_RS, screen->PIN_RS, 1);
+
+	while (count--) {
+		tft_put_word(screen, *pixels++);
+	}
 }
@@ -36,6 +36,31 @@
  *
  *	tft_init(&tft);
  *
+ * The bus can also be driven by the Static Memory Controller (smc.h) when
+ * the screen is wired to the EBI: D0-D7 (or D0-D15) to the data lines, WR to
+ * NWE, CS to a chip select and RS to an address line. Each write to the
+ * screen is then one store, timed by the SMC, and long runs of pixels are
+ * moved by the DMAC. The pins are given to peripheral A instead of being
+ * configured as outputs, then:
+ *
+ *	tft.width = 239;
+ *	tft.height = 319;
+ *	tft_init_smc(&tft, 0, 1, SMC_BUS_8);	// NCS0, RS on A1
+ *
+ * Screens with an ILI9341-class controller on SPI use the SPI backend. The
+ * SPI and the selector of the screen are set up by the application (8 bits
+ * per transfer, dmac_init() called), RS is the D/C pin of the screen and the
+ * only pin of tft_screen that is used:
+ *
+ *	tft.PORT_RS = PIOC; tft.PIN_RS = 22;
+ *	tft.width = 239;
+ *	tft.height = 319;
+ *	tft_init_spi(&tft, SPI0, SPI_SELECTOR_0);
+ *
+ * tft_fill_rect(), the blitter (tft_blit.h) and the framebuffer (tft_fb.h)
+ * work the same on all backends, they only use the window, stream and
+ * select functions below.
+ *
  * @author Theodor Lindquist
  * @date 30 October 2014
  *
@@ -46,6 +71,83 @@
 
 #include <inttypes.h>
 #include "sam3x8e/pio.h"
+#include "sam3x8e/smc.h"
+#include "sam3x8e/spi.h"
+
+/*
+ * Write timings of the controller of the screen for the SMC backend, in
+ * nanoseconds: the address to WR low, WR low and the whole write cycle.
+ */
+#ifndef TFT_SMC_WR_SETUP_NS
+#define TFT_SMC_WR_SETUP_NS		(10)
+#endif
+#ifndef TFT_SMC_WR_PULSE_NS
+#define TFT_SMC_WR_PULSE_NS		(30)
+#endif
+#ifndef TFT_SMC_WR_CYCLE_NS
+#define TFT_SMC_WR_CYCLE_NS		(66)
+#endif
+
+/*
+ * Set to 0 to build the SMC backend without the DMAC, the pixels are then
+ * all written by the CPU.
+ */
+#ifndef TFT_SMC_DMAC
+#define TFT_SMC_DMAC			(1)
+#endif
+
+/*
+ * Pixels of each of the two span buffers of the SPI backend. One span is
+ * byte-swapped into a buffer while the DMAC sends the other one. At most
+ * 2047, the DMAC sends up to 4095 bytes at a time.
+ */
+#ifndef TFT_SPI_SPAN
+#define TFT_SPI_SPAN			(64)
+#endif
+
+// Backend of the bus (see tft_screen)
+#define TFT_BUS_PIO				(0)
+#define TFT_BUS_SMC				(1)
+#define TFT_BUS_SPI				(2)
+
+// No DMAC channel is used by the SMC backend
+#define TFT_SMC_NO_DMAC			(0xFFu)
+
+/*
+ * Command sequences for tft_write_seq(), arrays of uint16_t. A command is a
+ * header word made with TFT_SEQ_CMD() or TFT_SEQ_CMD8(), followed by its
+ * count data words (0-63). With TFT_SEQ_CMD8() the SPI backend sends the
+ * low byte of each data word only, for the byte parameters of an ILI9341.
+ * TFT_SEQ_DELAY() waits 0-32767 ms.
+ */
+#define TFT_SEQ_BYTES			(0x4000u)
+#define TFT_SEQ_WAIT			(0x8000u)
+#define TFT_SEQ_CMD(com, count)	((uint16_t) ((com) | ((count) << 8)))
+#define TFT_SEQ_CMD8(com, count)	\
+	((uint16_t) (TFT_SEQ_CMD(com, count) | TFT_SEQ_BYTES))
+#define TFT_SEQ_DELAY(ms)		((uint16_t) (TFT_SEQ_WAIT | (ms)))
+
+///@cond
+// Max number of ports the eight data pins can be spread over
+#define TFT_BUS_MAX_GROUPS		(8)
+
+/*
+ * Data pins of the bus that share the same port. Filled in by tft_init(),
+ * so that a byte can be written to the port with a single masked store.
+ */
+typedef struct tft_bus_group {
+	// the port of the pins
+	pio_reg_t *port;
+	// all data pins on this port
+	uint32_t mask;
+	// number of data bits on this port
+	uint32_t count;
+	// data bit (0-7) of each pin
+	uint8_t bit[8];
+	// pin number (on the port) of each data bit
+	uint8_t pin[8];
+} tft_bus_group_t;
+///@endcond
 
 // Struct containing an instace of a tft screen
 typedef struct tft_screen {
@@ -84,6 +186,39 @@ typedef struct tft_screen {
 
 	uint32_t width;
 	uint32_t height;
+
+	// Precomputed bus layout, set up by tft_init()
+	tft_bus_group_t bus[TFT_BUS_MAX_GROUPS];
+	// number of used entries in bus
+	uint32_t bus_groups;
+	/*
+	 * 1 if D0-D7 are eight consecutive pins on the same port, the byte is
+	 * then written as (value << bus_shift) with one store.
+	 */
+	uint32_t bus_contiguous;
+	uint32_t bus_shift;
+
+	// TFT_BUS_PIO (tft_init()), TFT_BUS_SMC (tft_init_smc()) or
+	// TFT_BUS_SPI (tft_init_spi())
+	uint32_t bus_backend;
+	// SMC backend: the store addresses of RS low (command) and high (data)
+	volatile uint16_t *smc_com;
+	volatile uint16_t *smc_data;
+	// SMC backend: 1 for a 16-bit bus, one bus cycle per word
+	uint32_t smc_wide;
+	// SMC backend: DMAC channel for runs of pixels, or TFT_SMC_NO_DMAC
+	uint32_t smc_dmac;
+	// SPI backend: the SPI and the selector of the screen
+	spi_reg_t *spi;
+	uint32_t spi_selector;
+	// SPI backend: the span buffer to fill next
+	uint32_t spi_next;
+
+	// Vertical scroll area (rows), set up by tft_scroll_set_area()
+	uint32_t scroll_top;
+	uint32_t scroll_lines;
+	// row of the scroll area shown at its top, set by tft_scroll_to()
+	uint32_t scroll_offset;
 } tft_screen;
 
 /**
@@ -92,6 +227,34 @@ typedef struct tft_screen {
  */
 void tft_init(tft_screen *screen);
 
+/**
+ * Initialize the tft screen on the SMC backend. The chip select is set up
+ * with the TFT_SMC_WR_ timings at the current master clock, a DMAC channel
+ * is allocated for runs of pixels if one is free. On an 8-bit bus a word is
+ * written as two bus cycles, high byte first, like on the PIO backend.
+ * @param screen the screen instance, only width and height are used
+ * @param cs SMC chip select of CS (0-3)
+ * @param rs_line address line of RS (1-23)
+ * @param bus_width width of the bus, SMC_BUS_8 or SMC_BUS_16
+ * @return error (1 = SUCCESS, 0 = FAIL, invalid parameters)
+ */
+uint8_t tft_init_smc(tft_screen *screen, uint32_t cs, uint32_t rs_line,
+		uint32_t bus_width);
+
+/**
+ * Initialize a tft screen with an ILI9341-class controller on the SPI
+ * backend: reset, sleep out, 16 bits per pixel, display on. The pixels are
+ * sent with spi_transfer_async() in spans of TFT_SPI_SPAN, the span buffers
+ * are shared, so only one screen can use the SPI backend. Takes 125 ms.
+ * @pre The selector must be set up for 8 bits per transfer at the SPI clock
+ * of the screen, and RS be a PIO output.
+ * @param screen the screen instance, width, height and RS are used
+ * @param spi the SPI of the screen
+ * @param selector the selector of the screen, 0-3 (prefix SPI_SELECTOR_)
+ * @return error (1 = SUCCESS, 0 = FAIL, the selector is not set up)
+ */
+uint8_t tft_init_spi(tft_screen *screen, spi_reg_t *spi, uint8_t selector);
+
 /**
  * Clears the tft screen (fills it with black)
  * @param screen the screen instance
@@ -108,11 +271,105 @@ void tft_clear(tft_screen *screen);
 void tft_write(tft_screen *screen, uint16_t x, uint16_t y, uint16_t color);
 
 /**
- * Poll for input (not implemented)
+ * Fills a rectangle with one color. The address window is set once and the
+ * color is then streamed to the screen. The rectangle is clipped to the
+ * screen.
+ * @param screen screen instance
+ * @param x xpos of the upper left corner
+ * @param y ypos of the upper left corner
+ * @param w width of the rectangle (pixels)
+ * @param h height of the rectangle (pixels)
+ * @param color color of the rectangle, format: 0bRRRRRGGGGGBBBBB
+ */
+void tft_fill_rect(tft_screen *screen, uint16_t x, uint16_t y, uint16_t w,
+		uint16_t h, uint16_t color);
+
+/**
+ * Draws a horizontal line.
+ * @param screen screen instance
+ * @param x xpos of the leftmost pixel
+ * @param y ypos of the line
+ * @param len length of the line (pixels)
+ * @param color color of the line, format: 0bRRRRRGGGGGBBBBB
+ */
+void tft_hline(tft_screen *screen, uint16_t x, uint16_t y, uint16_t len,
+		uint16_t color);
+
+/**
+ * Draws a vertical line.
+ * @param screen screen instance
+ * @param x xpos of the line
+ * @param y ypos of the topmost pixel
+ * @param len length of the line (pixels)
+ * @param color color of the line, format: 0bRRRRRGGGGGBBBBB
+ */
+void tft_vline(tft_screen *screen, uint16_t x, uint16_t y, uint16_t len,
+		uint16_t color);
+
+/**
+ * Writes a horizontal span of pixels, starting at (x, y). The address window
+ * is set once and the pixel data is then streamed to the screen. Pixels that
+ * fall outside of the screen are not written.
+ * @param screen screen instance
+ * @param x xpos of the first pixel
+ * @param y ypos of the span
+ * @param len number of pixels
+ * @param pixels pixel data, format: 0bRRRRRGGGGGBBBBB
+ */
+void tft_write_span(tft_screen *screen, uint16_t x, uint16_t y, uint16_t len,
+		const uint16_t *pixels);
+
+/**
+ * Fills the whole screen with one color.
+ * @param screen screen instance
+ * @param color color of the screen, format: 0bRRRRRGGGGGBBBBB
+ */
+void tft_fast_fill(tft_screen *screen, uint16_t color);
+
+/**
+ * Sets up the vertical scroll area: the rows from top to the last row - bottom
+ * scroll, the top and bottom rows stay fixed. Every init function sets the
+ * whole screen as the scroll area, with no offset. On the SPI backend the
+ * ILI9341 takes the area with VSCRDEF (0x33). The controller of the parallel
+ * backends can only scroll the whole screen, the fixed areas must be 0.
+ * The offset is reset to 0.
+ * @param screen screen instance
+ * @param top number of fixed rows at the top of the screen
+ * @param bottom number of fixed rows at the bottom of the screen
+ * @return error (1 = SUCCESS, 0 = FAIL, the area is empty or the fixed areas
+ * are not supported by the backend)
+ */
+uint8_t tft_scroll_set_area(tft_screen *screen, uint16_t top, uint16_t bottom);
+
+/**
+ * Scrolls the scroll area: row top + offset of the screen memory is shown at
+ * the top of the area, the rows above it follow at the bottom. The screen
+ * memory is not changed, the drawing functions still take memory rows. A
+ * terminal view scrolls up by one text line of h rows with
+ * tft_scroll_to(screen, screen->scroll_offset + h) and only draws the text
+ * line from memory row tft_scroll_row(screen, last row - h + 1), which is
+ * contiguous when the number of rows of the area is a multiple of h.
+ * @param screen screen instance
+ * @param offset rows to scroll, taken modulo the rows of the scroll area
+ */
+void tft_scroll_to(tft_screen *screen, uint32_t offset);
+
+/**
+ * Gets the row of the screen memory shown on a row of the screen, with the
+ * scroll offset of tft_scroll_to().
+ * @param screen screen instance
+ * @param y row on the screen
+ * @return row in the screen memory, y for a row of the fixed areas
+ */
+uint16_t tft_scroll_row(const tft_screen *screen, uint16_t y);
+
+/**
+ * Poll for input, the latest point sampled in the background by the touch
+ * driver (see tft_touch.h). Does not block and takes no lock.
  * @param screen screen instance
  * @param x will contain the x-coordinate of the touch
  * @param y will contain the y-coordinate of the touch
- * @return true if touch is occuring
+ * @return true if touch is occuring, x and y are then set
  */
 uint32_t tft_read_input(tft_screen *screen, uint32_t *x, uint32_t *y);
 
@@ -124,15 +381,61 @@ void tft_write_data(tft_screen *screen, uint16_t data);
 
 void tft_set_xy(tft_screen *screen, uint16_t x1, uint16_t x2, uint16_t y1, uint16_t y2);
 
+/*
+ * Writes a command sequence (see TFT_SEQ_CMD()). RS is only changed at the
+ * start and the end of the data of each command, the words are written
+ * directly to the bus of the backend.
+ * @pre CS must be low.
+ */
+void tft_write_seq(tft_screen *screen, const uint16_t *seq, uint32_t words);
+
+/*
+ * Lowers (select 1) or raises (select 0) CS around a sequence of writes.
+ * Nothing is done on the SMC backend, where each bus cycle drives NCS. On
+ * the SPI backend, where the SPI drives CS, the end of a sequence waits
+ * for the last span to be sent.
+ */
+void tft_select(tft_screen *screen, uint8_t select);
+
 // bus functions
+
+/*
+ * Configures all pins of the screen as PIO outputs with pull-ups, in one
+ * pio_apply_config() call. CS, WR and RS start high (inactive). Call before
+ * tft_init() when the pins have not been configured by other code.
+ */
+void tft_conf_pins(tft_screen *screen);
+
+/*
+ * Resolves D0-D7 into the port/mask table used by tft_write_bus() and
+ * enables masked writes (PIO_OWER) on the data pins. Called by tft_init().
+ * Important! PIO_ODSR is written directly on the data ports, so no other
+ * pins on those ports should be enabled in PIO_OWSR.
+ */
+void tft_init_bus(tft_screen *screen);
+
 void tft_clear_bus(tft_screen *screen);
 
 void tft_set_bus(tft_screen *screen, uint8_t value);
 
 void tft_commit_bus(tft_screen *screen);
 
+/*
+ * Writes a word with WR pulses, RS is left as it is. The SMC backend
+ * writes it as data.
+ */
 void tft_write_bus(tft_screen *screen, uint16_t data);
 
-void tft_fast_fill(tft_screen *screen);
+/*
+ * Streams pixel data to the current address window (set by tft_set_xy()).
+ * tft_stream_color() writes the same color count times. On the SPI backend
+ * they return while the last span is still being sent, so the caller can
+ * prepare the next one.
+ * @pre CS must be low.
+ */
+void tft_stream_color(tft_screen *screen, uint16_t color, uint32_t count);
+
+void tft_stream_pixels(tft_screen *screen, const uint16_t *pixels,
+		uint32_t count);
 
 #endif //TFT_H_
@@ -0,0 +1,101 @@
+/*
+ * tft_blit.c
+ *
+ * TFT glyph and bitmap blitter.
+ *
+ * Date:	14 October 2026
+ */
+
+#include "tft_blit.h"
+
+/*
+ * Sets the address window for a w x h area and lowers CS.
+ * Returns 0 if the area doesn't fit on the screen.
+ */
+static uint32_t open_window(tft_screen *screen, uint16_t x, uint16_t y,
+		uint16_t w, uint16_t h) {
+	if ((w == 0) || (h == 0) ||
+		((uint32_t) x + w - 1 > screen->width) ||
+		((uint32_t) y + h - 1 > screen->height)) {
+		return 0;
+	}
+	tft_select(screen, 1);
+	tft_set_xy(screen, x, (uint16_t) (x + w - 1), y, (uint16_t) (y + h - 1));
+	return 1;
+}
+
+static void close_window(tft_screen *screen) {
+	tft_select(screen, 0);
+}
+
+uint32_t tft_draw_char(tft_screen *screen, const tft_font_t *font, uint16_t x,
+		uint16_t y, char chr, uint16_t fg, uint16_t bg) {
+	uint32_t row_bytes = (font->width + 7u) / 8u;
+	const uint8_t *row;
+	uint32_t run, level, bit;
+	uint32_t i, j;
+
+	if (((uint8_t) chr < font->first_char) ||
+		((uint8_t) chr > font->last_char)) {
+		return 0;
+	}
+	if (!open_window(screen, x, y, font->width, font->height)) {
+		return 0;
+	}
+
+	row = font->glyphs + ((uint8_t) chr - font->first_char) * row_bytes *
+			font->height;
+	for (j = 0; j < font->height; j++, row += row_bytes) {
+		// send each run of equal pixels in the row at once
+		level = (row[0] >> 7) & 0x1u;
+		run = 0;
+		for (i = 0; i < font->width; i++) {
+			bit = (row[i >> 3] >> (7u - (i & 7u))) & 0x1u;
+			if (bit != level) {
+				tft_stream_color(screen, level ? fg : bg, run);
+				level = bit;
+				run = 0;
+			}
+			run++;
+		}
+		tft_stream_color(screen, level ? fg : bg, run);
+	}
+	close_window(screen);
+	return 1;
+}
+
+uint16_t tft_draw_string(tft_screen *screen, const tft_font_t *font,
+		uint16_t x, uint16_t y, const char *str, uint16_t fg, uint16_t bg) {
+	while (*str != '\0') {
+		tft_draw_char(screen, font, x, y, *str, fg, bg);
+		x = (uint16_t) (x + font->width);
+		str++;
+	}
+	return x;
+}
+
+uint32_t tft_draw_bitmap(tft_screen *screen, uint16_t x, uint16_t y,
+		uint16_t w, uint16_t h, const uint16_t *pixels) {
+	if (!open_window(screen, x, y, w, h)) {
+		return 0;
+	}
+	tft_stream_pixels(screen, pixels, (uint32_t) w * h);
+	close_window(screen);
+	return 1;
+}
+
+uint32_t tft_draw_rle(tft_screen *screen, uint16_t x, uint16_t y,
+		const tft_rle_image_t *image) {
+	const uint16_t *run = image->data;
+	uint32_t i;
+
+	if (!open_window(screen, x, y, image->width, image->height)) {
+		return 0;
+	}
+	// the window wraps to the next row by itself
+	for (i = 0; i < image->runs; i++, run += 2) {
+		tft_stream_color(screen, run[1], run[0]);
+	}
+	close_window(screen);
+	return 1;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file tft_blit.h
+ * @brief TFT glyph and bitmap blitter
+ * @details Draws 1-bpp glyphs and RGB565 bitmaps (raw or RLE compressed)
+ * directly from flash to the TFT screen. Every glyph or bitmap gets one
+ * address window (tft_set_xy()) and the pixels are expanded and streamed on
+ * the fly: runs of equal pixels are sent with tft_stream_color(), so no RAM
+ * copy of the asset is needed.
+ *
+ * Fonts and images should be declared const, so they stay in flash.
+ *
+ * Glyph format: the glyphs of a font are stored after each other, starting
+ * with first_char. A glyph is height rows of (width + 7) / 8 bytes. The most
+ * significant bit of the first byte of a row is the leftmost pixel.
+ *
+ * RLE format: pairs of half-words {count, color}, the color is repeated
+ * count times. The runs follow the rows of the image and may continue on the
+ * next row. The run counts must add up to width * height.
+ *
+ * Important! Glyphs and bitmaps are only drawn if they fit on the screen.
+ *
+ * @pre Initialize the screen with tft_init().
+ *
+ * @date 14 October 2026
+ */
+
+#ifndef TFT_BLIT_H_
+#define TFT_BLIT_H_
+
+#include <inttypes.h>
+#include "tft.h"
+
+/**
+ * A 1-bpp fixed width font.
+ */
+typedef struct tft_font {
+	/** Width of a glyph (pixels). */
+	uint8_t width;
+	/** Height of a glyph (pixels). */
+	uint8_t height;
+	/** First character in the font. */
+	uint8_t first_char;
+	/** Last character in the font. */
+	uint8_t last_char;
+	/** Glyph bitmaps, see the glyph format. */
+	const uint8_t *glyphs;
+} tft_font_t;
+
+/**
+ * A RLE compressed RGB565 image.
+ */
+typedef struct tft_rle_image {
+	/** Width of the image (pixels). */
+	uint16_t width;
+	/** Height of the image (pixels). */
+	uint16_t height;
+	/** Number of {count, color} pairs in data. */
+	uint32_t runs;
+	/** Run data, see the RLE format. */
+	const uint16_t *data;
+} tft_rle_image_t;
+
+/**
+ * Draws one character.
+ * @param screen screen instance
+ * @param font the font to use
+ * @param x xpos of the upper left corner
+ * @param y ypos of the upper left corner
+ * @param chr the character to draw
+ * @param fg color of set pixels, format: 0bRRRRRGGGGGBBBBB
+ * @param bg color of cleared pixels, format: 0bRRRRRGGGGGBBBBB
+ * @return 1 if the character was drawn, 0 if it isn't in the font or
+ * doesn't fit on the screen
+ */
+uint32_t tft_draw_char(tft_screen *screen, const tft_font_t *font, uint16_t x,
+		uint16_t y, char chr, uint16_t fg, uint16_t bg);
+
+/**
+ * Draws a string, one address window per character. Characters that don't
+ * fit on the screen are skipped.
+ * @param screen screen instance
+ * @param font the font to use
+ * @param x xpos of the upper left corner of the first character
+ * @param y ypos of the upper left corner of the first character
+ * @param str the string to draw
+ * @param fg color of set pixels, format: 0bRRRRRGGGGGBBBBB
+ * @param bg color of cleared pixels, format: 0bRRRRRGGGGGBBBBB
+ * @return xpos after the last character
+ */
+uint16_t tft_draw_string(tft_screen *screen, const tft_font_t *font,
+		uint16_t x, uint16_t y, const char *str, uint16_t fg, uint16_t bg);
+
+/**
+ * Draws an uncompressed RGB565 bitmap.
+ * @param screen screen instance
+ * @param x xpos of the upper left corner
+ * @param y ypos of the upper left corner
+ * @param w width of the bitmap
+ * @param h height of the bitmap
+ * @param pixels w * h pixels, row by row
+ * @return 1 = SUCCESS, 0 = FAIL (doesn't fit on the screen)
+ */
+uint32_t tft_draw_bitmap(tft_screen *screen, uint16_t x, uint16_t y,
+		uint16_t w, uint16_t h, const uint16_t *pixels);
+
+/**
+ * Draws a RLE compressed RGB565 image.
+ * @param screen screen instance
+ * @param x xpos of the upper left corner
+ * @param y ypos of the upper left corner
+ * @param image the image to draw
+ * @return 1 = SUCCESS, 0 = FAIL (doesn't fit on the screen)
+ */
+uint32_t tft_draw_rle(tft_screen *screen, uint16_t x, uint16_t y,
+		const tft_rle_image_t *image);
+
+#endif /* TFT_BLIT_H_ */
@@ -0,0 +1,171 @@
+/*
+ * tft_fb.c
+ *
+ * TFT framebuffer with dirty-rectangle tracking.
+ *
+ * Date:	14 October 2026
+ */
+
+#include "tft_fb.h"
+
+///@cond
+#define TILE_INDEX(fb, tx, ty)	((uint32_t) (ty) * (fb)->tiles_x + (tx))
+///@endcond
+
+static void set_dirty(tft_fb_t *fb, uint32_t tile) {
+	fb->dirty[tile >> 5] |= (0x1u << (tile & 31u));
+}
+
+static void clear_dirty(tft_fb_t *fb, uint32_t tile) {
+	fb->dirty[tile >> 5] &= ~(0x1u << (tile & 31u));
+}
+
+uint32_t tft_fb_init(tft_fb_t *fb, tft_screen *screen, uint16_t x, uint16_t y,
+		uint16_t w, uint16_t h, uint16_t *buffer) {
+	uint32_t tiles_x = (w + TFT_FB_TILE_W - 1) / TFT_FB_TILE_W;
+	uint32_t tiles_y = (h + TFT_FB_TILE_H - 1) / TFT_FB_TILE_H;
+	uint32_t i;
+
+	// invalid parameters?
+	if ((w == 0) || (h == 0) || (tiles_x * tiles_y > TFT_FB_MAX_TILES) ||
+		((uint32_t) x + w - 1 > screen->width) ||
+		((uint32_t) y + h - 1 > screen->height)) {
+		return 0;
+	}
+
+	fb->screen = screen;
+	fb->x = x;
+	fb->y = y;
+	fb->w = w;
+	fb->h = h;
+	fb->pixels = buffer;
+	fb->tiles_x = (uint16_t) tiles_x;
+	fb->tiles_y = (uint16_t) tiles_y;
+	for (i = 0; i < TFT_FB_DIRTY_WORDS; i++) {
+		fb->dirty[i] = 0;
+	}
+	// the screen content is unknown, everything has to be sent once
+	tft_fb_mark_dirty(fb, 0, 0, w, h);
+	return 1;
+}
+
+void tft_fb_write(tft_fb_t *fb, uint16_t x, uint16_t y, uint16_t color) {
+	if ((x < fb->w) && (y < fb->h)) {
+		fb->pixels[(uint32_t) y * fb->w + x] = color;
+		set_dirty(fb, TILE_INDEX(fb, x / TFT_FB_TILE_W, y / TFT_FB_TILE_H));
+	}
+}
+
+uint16_t tft_fb_read(tft_fb_t *fb, uint16_t x, uint16_t y) {
+	if ((x < fb->w) && (y < fb->h)) {
+		return fb->pixels[(uint32_t) y * fb->w + x];
+	}
+	return 0;
+}
+
+void tft_fb_fill_rect(tft_fb_t *fb, uint16_t x, uint16_t y, uint16_t w,
+		uint16_t h, uint16_t color) {
+	uint32_t x2 = (uint32_t) x + w;
+	uint32_t y2 = (uint32_t) y + h;
+	uint32_t i, j;
+	uint16_t *row;
+
+	if ((w == 0) || (h == 0) || (x >= fb->w) || (y >= fb->h)) {
+		return;
+	}
+	// clip to the framebuffer
+	if (x2 > fb->w) {
+		x2 = fb->w;
+	}
+	if (y2 > fb->h) {
+		y2 = fb->h;
+	}
+	for (j = y; j < y2; j++) {
+		row = fb->pixels + j * fb->w;
+		for (i = x; i < x2; i++) {
+			row[i] = color;
+		}
+	}
+	tft_fb_mark_dirty(fb, x, y, (uint16_t) (x2 - x), (uint16_t) (y2 - y));
+}
+
+void tft_fb_mark_dirty(tft_fb_t *fb, uint16_t x, uint16_t y, uint16_t w,
+		uint16_t h) {
+	uint32_t x2 = (uint32_t) x + w;
+	uint32_t y2 = (uint32_t) y + h;
+	uint32_t tx, ty;
+
+	if ((w == 0) || (h == 0) || (x >= fb->w) || (y >= fb->h)) {
+		return;
+	}
+	if (x2 > fb->w) {
+		x2 = fb->w;
+	}
+	if (y2 > fb->h) {
+		y2 = fb->h;
+	}
+	for (ty = y / TFT_FB_TILE_H; ty <= (y2 - 1) / TFT_FB_TILE_H; ty++) {
+		for (tx = x / TFT_FB_TILE_W; tx <= (x2 - 1) / TFT_FB_TILE_W; tx++) {
+			set_dirty(fb, TILE_INDEX(fb, tx, ty));
+		}
+	}
+}
+
+uint32_t tft_fb_tile_dirty(tft_fb_t *fb, uint32_t tx, uint32_t ty) {
+	uint32_t tile;
+	if ((tx >= fb->tiles_x) || (ty >= fb->tiles_y)) {
+		return 0;
+	}
+	tile = TILE_INDEX(fb, tx, ty);
+	return ((fb->dirty[tile >> 5] >> (tile & 31u)) & 0x1u);
+}
+
+uint32_t tft_flush(tft_fb_t *fb) {
+	tft_screen *screen = fb->screen;
+	uint32_t sent = 0;
+	uint32_t tx, tx_end, ty;
+	uint32_t px1, px2, py1, py2, row;
+
+	tft_select(screen, 1);
+	for (ty = 0; ty < fb->tiles_y; ty++) {
+		tx = 0;
+		while (tx < fb->tiles_x) {
+			if (!tft_fb_tile_dirty(fb, tx, ty)) {
+				tx++;
+				continue;
+			}
+			// merge a run of dirty tiles into one window
+			tx_end = tx;
+			while ((tx_end + 1 < fb->tiles_x) &&
+					tft_fb_tile_dirty(fb, tx_end + 1, ty)) {
+				tx_end++;
+			}
+
+			px1 = tx * TFT_FB_TILE_W;
+			px2 = (tx_end + 1) * TFT_FB_TILE_W;
+			if (px2 > fb->w) {
+				px2 = fb->w;
+			}
+			py1 = ty * TFT_FB_TILE_H;
+			py2 = py1 + TFT_FB_TILE_H;
+			if (py2 > fb->h) {
+				py2 = fb->h;
+			}
+
+			tft_set_xy(screen, (uint16_t) (fb->x + px1),
+					(uint16_t) (fb->x + px2 - 1), (uint16_t) (fb->y + py1),
+					(uint16_t) (fb->y + py2 - 1));
+			for (row = py1; row < py2; row++) {
+				tft_stream_pixels(screen, fb->pixels + row * fb->w + px1,
+						px2 - px1);
+			}
+
+			for (; tx <= tx_end; tx++) {
+				clear_dirty(fb, TILE_INDEX(fb, tx, ty));
+				sent++;
+			}
+		}
+	}
+	tft_select(screen, 0);
+	return sent;
+}
@@ -0,0 +1,152 @@
+/**
+ * @file tft_fb.h
+ * @brief TFT framebuffer with dirty-rectangle tracking
+ * @details A RAM framebuffer for a rectangular region of a TFT screen. All
+ * drawing is done in RAM and the touched tiles are marked as dirty.
+ * tft_flush() then only sends the dirty tiles to the screen, using the
+ * window/stream path of tft.c. Horizontally adjacent dirty tiles are merged
+ * into one address window.
+ *
+ * A full 240x320 framebuffer needs 150 KB, which doesn't fit in the 96 KB
+ * SRAM of the SAM3X8E. Instead use one framebuffer per region of the screen
+ * that changes (a widget, a status bar...). The buffer memory is provided by
+ * the user, w * h half-words is needed. The tile size is set with
+ * TFT_FB_TILE_W and TFT_FB_TILE_H and the max number of tiles of a
+ * framebuffer with TFT_FB_MAX_TILES. All of these can be defined before
+ * including this file.
+ *
+ * Example, a 100x40 pixel region at (10, 10):
+ *
+ *	uint16_t fb_mem[100 * 40];
+ *	tft_fb_t fb;
+ *
+ *	tft_fb_init(&fb, &tft, 10, 10, 100, 40, fb_mem);
+ *	tft_fb_fill_rect(&fb, 0, 0, 100, 40, 0x0000);
+ *	tft_fb_write(&fb, 50, 20, 0xFFFF);
+ *	tft_flush(&fb);
+ *
+ * @pre Initialize the screen with tft_init().
+ *
+ * @date 14 October 2026
+ */
+
+#ifndef TFT_FB_H_
+#define TFT_FB_H_
+
+#include <inttypes.h>
+#include "tft.h"
+
+/// Width of a tile (pixels)
+#ifndef TFT_FB_TILE_W
+#define TFT_FB_TILE_W		(16)
+#endif
+
+/// Height of a tile (pixels)
+#ifndef TFT_FB_TILE_H
+#define TFT_FB_TILE_H		(16)
+#endif
+
+/// Max number of tiles in one framebuffer (a full screen is 15 x 20 tiles)
+#ifndef TFT_FB_MAX_TILES
+#define TFT_FB_MAX_TILES	(300)
+#endif
+
+///@cond
+#define TFT_FB_DIRTY_WORDS	((TFT_FB_MAX_TILES + 31) / 32)
+///@endcond
+
+/**
+ * Framebuffer instance.
+ */
+typedef struct tft_fb {
+	/** The screen the framebuffer belongs to. */
+	tft_screen *screen;
+	/** Position of the framebuffer on the screen. */
+	uint16_t x;
+	uint16_t y;
+	/** Size of the framebuffer (pixels). */
+	uint16_t w;
+	uint16_t h;
+	/** Pixel memory, w * h pixels, row by row. */
+	uint16_t *pixels;
+	/** Number of tiles in each direction. */
+	uint16_t tiles_x;
+	uint16_t tiles_y;
+	/** One bit per tile, set if the tile has to be flushed. */
+	uint32_t dirty[TFT_FB_DIRTY_WORDS];
+} tft_fb_t;
+
+/**
+ * Initializes a framebuffer. All tiles are marked as dirty.
+ * @param fb framebuffer instance
+ * @param screen the screen instance
+ * @param x xpos of the framebuffer on the screen
+ * @param y ypos of the framebuffer on the screen
+ * @param w width of the framebuffer
+ * @param h height of the framebuffer
+ * @param buffer pixel memory (w * h half-words)
+ * @return 1 = SUCCESS, 0 = FAIL (too many tiles or outside of the screen)
+ */
+uint32_t tft_fb_init(tft_fb_t *fb, tft_screen *screen, uint16_t x, uint16_t y,
+		uint16_t w, uint16_t h, uint16_t *buffer);
+
+/**
+ * Writes a pixel to the framebuffer.
+ * @param fb framebuffer instance
+ * @param x xpos (relative to the framebuffer)
+ * @param y ypos (relative to the framebuffer)
+ * @param color color of pixel, format: 0bRRRRRGGGGGBBBBB
+ */
+void tft_fb_write(tft_fb_t *fb, uint16_t x, uint16_t y, uint16_t color);
+
+/**
+ * Reads a pixel from the framebuffer.
+ * @param fb framebuffer instance
+ * @param x xpos (relative to the framebuffer)
+ * @param y ypos (relative to the framebuffer)
+ * @return color of the pixel, 0 if outside of the framebuffer
+ */
+uint16_t tft_fb_read(tft_fb_t *fb, uint16_t x, uint16_t y);
+
+/**
+ * Fills a rectangle of the framebuffer with one color. The rectangle is
+ * clipped to the framebuffer.
+ * @param fb framebuffer instance
+ * @param x xpos (relative to the framebuffer)
+ * @param y ypos (relative to the framebuffer)
+ * @param w width of the rectangle
+ * @param h height of the rectangle
+ * @param color color of the rectangle, format: 0bRRRRRGGGGGBBBBB
+ */
+void tft_fb_fill_rect(tft_fb_t *fb, uint16_t x, uint16_t y, uint16_t w,
+		uint16_t h, uint16_t color);
+
+/**
+ * Marks the tiles covering a rectangle as dirty. Use this after writing
+ * directly to fb->pixels.
+ * @param fb framebuffer instance
+ * @param x xpos (relative to the framebuffer)
+ * @param y ypos (relative to the framebuffer)
+ * @param w width of the rectangle
+ * @param h height of the rectangle
+ */
+void tft_fb_mark_dirty(tft_fb_t *fb, uint16_t x, uint16_t y, uint16_t w,
+		uint16_t h);
+
+/**
+ * Checks if a tile is dirty.
+ * @param fb framebuffer instance
+ * @param tx tile column
+ * @param ty tile row
+ * @return 1 if the tile is dirty, otherwise 0
+ */
+uint32_t tft_fb_tile_dirty(tft_fb_t *fb, uint32_t tx, uint32_t ty);
+
+/**
+ * Sends all dirty tiles to the screen and marks them as clean.
+ * @param fb framebuffer instance
+ * @return number of tiles that were sent
+ */
+uint32_t tft_flush(tft_fb_t *fb);
+
+#endif /* TFT_FB_H_ */
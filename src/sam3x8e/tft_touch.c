@@ -0,0 +1,253 @@
+/*
+ * tft_touch.c
+ *
+ * Date:	14 October 2026
+ */
+
+#include "tft_touch.h"
+#include "adc.h"
+#include "io_req.h"
+#include "pio.h"
+#if TFT_TOUCH_COOS
+#include "rtos/CoOS.h"
+#endif
+
+///@cond
+// Samples converted in each phase
+#define PHASE_SAMPLES	(TFT_TOUCH_SETTLE + TFT_TOUCH_SAMPLES)
+
+// The published point: touched, row and column
+#define POINT_TOUCHED	(0x1u << 31)
+#define POINT_X(point)	((point) & 0xFFFFu)
+#define POINT_Y(point)	(((point) >> 16) & 0x7FFFu)
+
+enum phase {
+	PHASE_DETECT,
+	PHASE_X,
+	PHASE_Y
+};
+///@endcond
+
+static struct {
+	tft_screen *screen;
+	const tft_touch_t *touch;
+	io_req_t req;
+	uint16_t samples[PHASE_SAMPLES];
+	enum phase phase;
+	volatile uint8_t running;
+	// the raw point of the X and Y phases, valid if has_point
+	uint16_t raw_x;
+	uint16_t raw_y;
+	uint8_t has_point;
+	uint8_t flag;
+	volatile uint32_t cycles;
+	// one word, so tft_read_input() needs no lock
+	volatile uint32_t point;
+} touch_state = { .flag = TFT_TOUCH_NO_FLAG };
+
+/*
+ * Median of the samples after the settling ones, the channel tags are
+ * removed. An insertion sort is enough for a few samples.
+ */
+static uint16_t median(const uint16_t *samples) {
+	uint16_t sorted[TFT_TOUCH_SAMPLES];
+	uint32_t i, j;
+
+	for (i = 0; i < TFT_TOUCH_SAMPLES; i++) {
+		uint16_t value = ADC_SAMPLE_VALUE(samples[TFT_TOUCH_SETTLE + i]);
+
+		for (j = i; j > 0 && sorted[j - 1] > value; j--) {
+			sorted[j] = sorted[j - 1];
+		}
+		sorted[j] = value;
+	}
+	return sorted[TFT_TOUCH_SAMPLES / 2];
+}
+
+/*
+ * Scales a raw value from min-max to 0-last, clamped.
+ */
+static uint32_t scale(uint16_t raw, uint16_t min, uint16_t max, uint32_t last) {
+	int32_t span = (int32_t) max - min;
+	int32_t pos = (int32_t) raw - min;
+
+	if (span == 0) {
+		return 0;
+	}
+	// a flipped axis has both negative
+	if (span < 0) {
+		span = -span;
+		pos = -pos;
+	}
+	if (pos <= 0) {
+		return 0;
+	}
+	if (pos >= span) {
+		return last;
+	}
+	return ((uint32_t) pos * last + (uint32_t) span / 2) / (uint32_t) span;
+}
+
+/*
+ * Drives the plates for a phase and starts its conversions.
+ */
+static void start_phase(enum phase phase) {
+	const tft_touch_t *t = touch_state.touch;
+	uint8_t channel;
+
+	// all four plates float, then the phase drives its pair
+	pio_conf_pin((pio_reg_t *) t->PORT_XP, t->PIN_XP, 1, 0);
+	pio_conf_pin((pio_reg_t *) t->PORT_XM, t->PIN_XM, 1, 0);
+	pio_conf_pin((pio_reg_t *) t->PORT_YP, t->PIN_YP, 1, 0);
+	pio_conf_pin((pio_reg_t *) t->PORT_YM, t->PIN_YM, 1, 0);
+	switch (phase) {
+	case PHASE_DETECT:
+		pio_set_pin((pio_reg_t *) t->PORT_XM, t->PIN_XM, 0);
+		pio_conf_pin((pio_reg_t *) t->PORT_XM, t->PIN_XM, 0, 0);
+		pio_conf_pin((pio_reg_t *) t->PORT_YP, t->PIN_YP, 1, 1);
+		channel = (uint8_t) t->CHANNEL_YP;
+		break;
+	case PHASE_X:
+		pio_set_pin((pio_reg_t *) t->PORT_XP, t->PIN_XP, 1);
+		pio_set_pin((pio_reg_t *) t->PORT_XM, t->PIN_XM, 0);
+		pio_conf_pin((pio_reg_t *) t->PORT_XP, t->PIN_XP, 0, 0);
+		pio_conf_pin((pio_reg_t *) t->PORT_XM, t->PIN_XM, 0, 0);
+		channel = (uint8_t) t->CHANNEL_YP;
+		break;
+	default:
+		pio_set_pin((pio_reg_t *) t->PORT_YP, t->PIN_YP, 1);
+		pio_set_pin((pio_reg_t *) t->PORT_YM, t->PIN_YM, 0);
+		pio_conf_pin((pio_reg_t *) t->PORT_YP, t->PIN_YP, 0, 0);
+		pio_conf_pin((pio_reg_t *) t->PORT_YM, t->PIN_YM, 0, 0);
+		channel = (uint8_t) t->CHANNEL_XP;
+		break;
+	}
+	touch_state.phase = phase;
+	// only the sensed plate is an analog input, the driven one is not
+	(void) adc_sequence_set(&channel, 1);
+	(void) adc_scan_req(touch_state.samples, PHASE_SAMPLES, &touch_state.req);
+}
+
+/*
+ * Takes a detect phase: publishes the point before it if the touch is still
+ * there, or releases the point.
+ */
+static enum phase detect(uint16_t value) {
+	tft_screen *screen = touch_state.screen;
+	const tft_touch_t *t = touch_state.touch;
+	uint32_t point = touch_state.point;
+
+	touch_state.cycles++;
+	if (value >= TFT_TOUCH_THRESHOLD) {
+		touch_state.point = point & ~POINT_TOUCHED;
+		touch_state.has_point = 0;
+		return PHASE_DETECT;
+	}
+	if (touch_state.has_point) {
+		touch_state.point = POINT_TOUCHED |
+				(scale(touch_state.raw_y, t->y_min, t->y_max,
+						screen->height) << 16) |
+				scale(touch_state.raw_x, t->x_min, t->x_max, screen->width);
+		touch_state.has_point = 0;
+#if TFT_TOUCH_COOS
+		if (!(point & POINT_TOUCHED) && touch_state.flag != TFT_TOUCH_NO_FLAG) {
+			isr_SetFlag(touch_state.flag);
+		}
+#endif
+	}
+	return PHASE_X;
+}
+
+/*
+ * Called from the ADC interrupt when the conversions of a phase are done.
+ */
+static void touch_done(io_req_t *req, void *arg) {
+	uint16_t value = median(touch_state.samples);
+	enum phase next;
+
+	(void) req;
+	(void) arg;
+	switch (touch_state.phase) {
+	case PHASE_DETECT:
+		next = detect(value);
+		break;
+	case PHASE_X:
+		touch_state.raw_x = value;
+		next = PHASE_Y;
+		break;
+	default:
+		touch_state.raw_y = value;
+		touch_state.has_point = 1;
+		next = PHASE_DETECT;
+		break;
+	}
+	if (touch_state.running) {
+		start_phase(next);
+	}
+}
+
+uint8_t tft_touch_start(tft_screen *screen, const tft_touch_t *touch,
+		uint32_t trigger, uint32_t hz) {
+	if (touch_state.running || touch->CHANNEL_XP > ADC_CHANNEL_MAX ||
+		touch->CHANNEL_YP > ADC_CHANNEL_MAX || trigger == ADC_TRIGGER_SOFTWARE ||
+		adc_set_sample_rate(trigger, hz) == 0) {
+		return 0;
+	}
+	touch_state.screen = screen;
+	touch_state.touch = touch;
+	touch_state.has_point = 0;
+	touch_state.cycles = 0;
+	touch_state.point = 0;
+	io_req_init(&touch_state.req, IO_REQ_NO_FLAG, touch_done, 0);
+
+	pio_enable_pin((pio_reg_t *) touch->PORT_XP, touch->PIN_XP);
+	pio_enable_pin((pio_reg_t *) touch->PORT_XM, touch->PIN_XM);
+	pio_enable_pin((pio_reg_t *) touch->PORT_YP, touch->PIN_YP);
+	pio_enable_pin((pio_reg_t *) touch->PORT_YM, touch->PIN_YM);
+	touch_state.running = 1;
+	start_phase(PHASE_DETECT);
+	if (touch_state.req.state != IO_REQ_BUSY) {
+		// a stream or scan holds the PDC channel of the ADC
+		touch_state.running = 0;
+		adc_sequence_disable();
+		return 0;
+	}
+	return 1;
+}
+
+void tft_touch_stop(void) {
+	const tft_touch_t *t = touch_state.touch;
+
+	if (!touch_state.running) {
+		return;
+	}
+	touch_state.running = 0;
+	// the trigger keeps running, so the phase started last is finished
+	while (touch_state.req.state == IO_REQ_BUSY);
+	adc_sequence_disable();
+	pio_conf_pin((pio_reg_t *) t->PORT_XP, t->PIN_XP, 1, 0);
+	pio_conf_pin((pio_reg_t *) t->PORT_XM, t->PIN_XM, 1, 0);
+	pio_conf_pin((pio_reg_t *) t->PORT_YP, t->PIN_YP, 1, 0);
+	pio_conf_pin((pio_reg_t *) t->PORT_YM, t->PIN_YM, 1, 0);
+	touch_state.point &= ~POINT_TOUCHED;
+}
+
+void tft_touch_set_flag(uint8_t flag) {
+	touch_state.flag = flag;
+}
+
+uint32_t tft_touch_cycles(void) {
+	return touch_state.cycles;
+}
+
+uint32_t tft_read_input(tft_screen *screen, uint32_t *x, uint32_t *y) {
+	uint32_t point = touch_state.point;
+
+	(void) screen;
+	if (!(point & POINT_TOUCHED)) {
+		return 0;
+	}
+	*x = POINT_X(point);
+	*y = POINT_Y(point);
+	return 1;
+}
@@ -0,0 +1,131 @@
+/**
+ * @file tft_touch.h
+ * @brief TFT resistive touch input
+ * @details Samples the plates of a 4-wire resistive touch panel with the ADC
+ * in the background. The conversions are started by a TC channel and stored
+ * by the PDC (see adc_scan_req()), the ADC interrupt only switches the plates
+ * between three phases and filters each of them with a median:
+ * - detect: X- low, Y+ pulled up and converted. A touch pulls Y+ low.
+ * - X: X+ high and X- low, the position is converted on Y+.
+ * - Y: Y+ high and Y- low, the position is converted on X+.
+ *
+ * The first TFT_TOUCH_SETTLE samples of a phase are thrown away while the
+ * plates settle, the median of the next TFT_TOUCH_SAMPLES is used. A point is
+ * only published when the detect phase after it still sees the touch, so the
+ * point of a lift-off is dropped. The latest point is one word that is
+ * written by the interrupt and read by tft_read_input() without a lock. A
+ * CoOS event flag can be set on each touch-down, so the UI task sleeps until
+ * the panel is touched instead of polling it:
+ * @code
+ *	tft_touch_set_flag(touch_flag);
+ *	tft_touch_start(&tft, &touch, ADC_TRIGGER_TIOA0, 10000);
+ *	CoWaitForSingleFlag(touch_flag, 0);
+ *	while (tft_read_input(&tft, &x, &y)) { ... }
+ * @endcode
+ *
+ * @pre Initialize the ADC with adc_init() and the same hardware trigger as
+ * given to tft_touch_start(). X+ and Y+ must be ADC inputs. The ADC, its
+ * sequence and its PDC channel are used by the touch driver until
+ * tft_touch_stop().
+ * @pre CoOS delivery requires CFG_MAX_SERVICE_REQUEST > 0 and an event flag
+ * created with CoCreateFlag(1, 0) (auto reset).
+ * @date 14 October 2026
+ */
+
+#ifndef TFT_TOUCH_H_
+#define TFT_TOUCH_H_
+
+#include <inttypes.h>
+#include "tft.h"
+
+/*
+ * Set to 0 to build without the CoOS event flag, e.g. when the RTOS is not
+ * linked into the application.
+ */
+#ifndef TFT_TOUCH_COOS
+#define TFT_TOUCH_COOS		(1)
+#endif
+
+// Samples thrown away after the plates are switched
+#ifndef TFT_TOUCH_SETTLE
+#define TFT_TOUCH_SETTLE	(2)
+#endif
+
+// Samples of each phase that the median is taken of, odd
+#ifndef TFT_TOUCH_SAMPLES
+#define TFT_TOUCH_SAMPLES	(7)
+#endif
+
+// A detect phase below this value is a touch (0-4095)
+#ifndef TFT_TOUCH_THRESHOLD
+#define TFT_TOUCH_THRESHOLD	(3000)
+#endif
+
+/// No event flag is set on a touch-down.
+#define TFT_TOUCH_NO_FLAG	(0xFFu)
+
+/**
+ * The pins of a touch panel and its calibration. The raw values are the
+ * 12-bit conversions at the edges of the screen, a min above its max flips
+ * the axis.
+ */
+typedef struct tft_touch {
+	uint32_t PORT_XP;
+	uint32_t PIN_XP;
+	/** ADC channel of X+ */
+	uint32_t CHANNEL_XP;
+
+	uint32_t PORT_XM;
+	uint32_t PIN_XM;
+
+	uint32_t PORT_YP;
+	uint32_t PIN_YP;
+	/** ADC channel of Y+ */
+	uint32_t CHANNEL_YP;
+
+	uint32_t PORT_YM;
+	uint32_t PIN_YM;
+
+	/** Raw X at column 0 and at the last column */
+	uint16_t x_min;
+	uint16_t x_max;
+	/** Raw Y at row 0 and at the last row */
+	uint16_t y_min;
+	uint16_t y_max;
+} tft_touch_t;
+
+/**
+ * Starts sampling the touch panel in the background. The trigger is set to
+ * the sample rate with adc_set_sample_rate(), with 10 kHz a point takes
+ * about 3 * (TFT_TOUCH_SETTLE + TFT_TOUCH_SAMPLES) / 10 ms.
+ * @param screen the screen, its width and height scale the points
+ * @param touch the pins and calibration, must stay valid until
+ * tft_touch_stop()
+ * @param trigger ADC_TRIGGER_TIOA0-2 or ADC_TRIGGER_PWM_EVENT0-1
+ * @param hz sample rate (Hz)
+ * @return error (1 = SUCCESS, 0 = FAIL, invalid channels or rate, the ADC is
+ * busy or the driver is running)
+ */
+uint8_t tft_touch_start(tft_screen *screen, const tft_touch_t *touch,
+		uint32_t trigger, uint32_t hz);
+
+/**
+ * Stops sampling after the current phase and gives the plates back as
+ * inputs without pull-ups. The last point is released.
+ */
+void tft_touch_stop(void);
+
+/**
+ * Sets a CoOS event flag to be set on each touch-down.
+ * @param flag The flag, or TFT_TOUCH_NO_FLAG.
+ */
+void tft_touch_set_flag(uint8_t flag);
+
+/**
+ * The number of detect phases since tft_touch_start(), it keeps counting
+ * while the panel is not touched.
+ * @return The number of detect phases.
+ */
+uint32_t tft_touch_cycles(void);
+
+#endif
@@ -0,0 +1,65 @@
+/*
+ * trace_uart.c
+ *
+ * Date:	14 October 2026
+ */
+
+#include "trace_uart.h"
+#include "uart.h"
+#include "rtos/CoOS.h"
+#include "irq.h"
+
+#if CFG_TRACE_EN > 0
+
+// Bytes of a record, TRACE_RECORD_SIZE in rtos/OsTrace.h
+#define RECORD_SIZE		(8)
+
+// Largest transfer of uart_write_dma(), in whole records
+#define TRACE_UART_MAX		(0xFFFF / RECORD_SIZE)
+
+// Records in flight on the UART
+static volatile uint32_t trace_sending;
+
+static void trace_uart_done(void);
+
+// Sends the oldest records, called with trace_sending == 0
+static uint8_t trace_uart_send(void) {
+	void *rec;
+	uint32_t count = CoTracePeek(&rec);
+
+	if (count == 0) {
+		return 0;
+	}
+	if (count > TRACE_UART_MAX) {
+		count = TRACE_UART_MAX;
+	}
+	trace_sending = count;
+	if (!uart_write_dma(rec, count * RECORD_SIZE, trace_uart_done)) {
+		trace_sending = 0;
+		return 0;
+	}
+	return 1;
+}
+
+static void trace_uart_done(void) {
+	CoTraceFree(trace_sending);
+	trace_sending = 0;
+	// keep going with the records logged in the meantime
+	trace_uart_send();
+}
+
+uint8_t trace_uart_flush(void) {
+	uint8_t result;
+	// the done interrupt must not start a transfer between the check and ours
+	uint32_t primask = irq_save();
+
+	if (trace_sending != 0) {
+		result = 1;
+	} else {
+		result = trace_uart_send();
+	}
+	irq_restore(primask);
+	return result;
+}
+
+#endif
@@ -0,0 +1,32 @@
+/**
+ * @file trace_uart.h
+ * @brief Streams the CoOS kernel trace over the UART
+ * @details The records of the kernel trace (CFG_TRACE_EN, see
+ * rtos/OsTrace.h) are sent with uart_write_dma() straight from the trace ring
+ * buffer, in the binary format described in rtos/OsTrace.h: 8 bytes per
+ * record, little-endian. When a transfer is done its records are freed and
+ * the records logged in the meantime are sent next, until the trace is
+ * empty.
+ *
+ * Call trace_uart_flush() periodically, e.g. from a low priority task or a
+ * CoOS timer, to start sending again after the trace ran empty. Records that
+ * are logged while the trace is full are dropped and reported by a
+ * TRACE_LOST record.
+ *
+ * @pre The UART must be initialized in interrupt mode and CFG_TRACE_EN set.
+ * @date 14 October 2026
+ */
+
+#ifndef TRACE_UART_H_
+#define TRACE_UART_H_
+
+#include <inttypes.h>
+
+/**
+ * Starts sending the records of the trace, if there are any and the UART
+ * has no PDC transfer in progress.
+ * @return 1 if a transfer was started or is in progress, otherwise 0.
+ */
+uint8_t trace_uart_flush(void);
+
+#endif
@@ -12,6 +12,56 @@
  */
 
 #include "twi.h"
+#include "pdc.h"
+#include "id.h"
+#if TWI_COOS
+#include "rtos/CoOS.h"
+#endif
+
+// NVIC Interrupt Set-Enable Register 0 (peripheral ID 0-31)
+#define NVIC_ISER0		(*((volatile uint32_t *) PERIPH_ADDR(0xE000E100U)))
+
+// State of the interrupt handler
+#define TWI_STATE_IDLE			(0)
+#define TWI_STATE_WRITE			(1)
+#define TWI_STATE_READ			(2)
+#define TWI_STATE_SLAVE			(3)
+
+// Kind of the current access in slave mode
+#define TWI_ACCESS_NONE			(0)
+#define TWI_ACCESS_WRITE		(1)
+#define TWI_ACCESS_READ			(2)
+
+/*
+ * Interrupt-driven transfer of one TWI instance. In slave mode, buffer and
+ * length are the register map and index is the register pointer.
+ */
+typedef struct {
+	uint8_t *buffer;
+	uint32_t length;
+	uint32_t index;
+	twi_callback_t callback;
+	// completed by twi_req_done(), the callback of the *_req() functions
+	io_req_t *req;
+	volatile uint8_t state;
+	uint8_t result;
+	uint8_t flag;
+	// slave mode
+	uint8_t access;
+	uint8_t first;
+	uint32_t start;
+	uint32_t count;
+	twi_slave_callback_t on_write;
+	twi_slave_callback_t on_read;
+} twi_state_t;
+
+static twi_state_t states[2] = {
+	{ .flag = TWI_NO_FLAG }, { .flag = TWI_NO_FLAG }
+};
+
+static inline twi_state_t *twi_state(twi_reg_t *twi) {
+	return &states[twi == TWI1];
+}
 
 void twi_set_device_address(twi_reg_t *twi, uint32_t dadr, uint32_t iadrsz) {
 	twi->TWI_MMR = 0;
@@ -70,60 +120,101 @@ uint8_t twi_set_clock(twi_reg_t *twi, uint32_t bus_speed, uint32_t mck) {
 	return 0;
 }
 
-void twi_init_master(twi_reg_t *twi) {
-	// disable Slave Mode
-	twi->TWI_CR = TWI_CR_SVDIS;
-	// enable Master Mode
-	twi->TWI_CR = TWI_CR_MSEN;
-}
 /*
-uint8_t twi_master_read(twi_reg_t *twi, twi_packet_t *packet){
-	uint32_t counter = 0;
+ * Minimum low and high times of SCL (ns) in the modes of the I2C
+ * specification.
+ */
+#define TWI_STANDARD_MODE_TLOW		(4700u)
+#define TWI_STANDARD_MODE_THIGH		(4000u)
+#define TWI_FAST_MODE_TLOW			(1300u)
+#define TWI_FAST_MODE_THIGH			(600u)
+#define TWI_FAST_MODE_PLUS_TLOW		(500u)
+#define TWI_FAST_MODE_PLUS_THIGH	(260u)
 
-	// Check for illegal values
-	if(packet->data_length==0){
-		return 0;
-	}
+// Number of master clock cycles for a time (ns), rounded up
+static uint32_t twi_ns_to_cycles(uint32_t ns, uint32_t mck) {
+	return (uint32_t) (((uint64_t) ns * mck + 999999999u) / 1000000000u);
+}
 
-	// Set read mode, slave address and internal address
-	twi->TWI_MMR = 0;
-	twi->TWI_MMR = TWI_MMR_MREAD(0x1u) | TWI_MMR_DADR(packet->chip) |
-			((TWI_MMR_IADRSZ(packet->address_length)) & TWI_MMR_IADRSZ(0x3u));
+uint32_t twi_calc_clock(uint32_t bus_speed, uint32_t mck, uint32_t *cwgr) {
+	uint32_t total, low, low_min, high_min;
+	uint32_t ckdiv, cldiv, chdiv, rest, period, error;
+	uint32_t best_error = 0xFFFFFFFFu, best_period = 0;
 
-	// Set internal address for remote chip
-	twi->TWI_IADR = 0;
-	twi->TWI_IADR = twi_convert_address(packet->address,
-			packet->address_length);
-
-	// Signal start of transfer
-	twi->TWI_CR = TWI_CR_START;
+	if (bus_speed == 0 || bus_speed > TWI_FAST_MODE_PLUS_SPEED) {
+		return 0;	// indicate "failure" !
+	}
+	if (bus_speed <= TWI_STANDARD_MODE_SPEED) {
+		low_min = twi_ns_to_cycles(TWI_STANDARD_MODE_TLOW, mck);
+		high_min = twi_ns_to_cycles(TWI_STANDARD_MODE_THIGH, mck);
+	} else if (bus_speed <= TWI_FAST_MODE_SPEED) {
+		low_min = twi_ns_to_cycles(TWI_FAST_MODE_TLOW, mck);
+		high_min = twi_ns_to_cycles(TWI_FAST_MODE_THIGH, mck);
+	} else {
+		low_min = twi_ns_to_cycles(TWI_FAST_MODE_PLUS_TLOW, mck);
+		high_min = twi_ns_to_cycles(TWI_FAST_MODE_PLUS_THIGH, mck);
+	}
 
-	while (counter < packet->data_length) {
-		if (twi->TWI_SR & TWI_SR_NACK) {
-			return 0;
-		}
+	/*
+	 * The period in master clock cycles is split in a low time of at least
+	 * half the period, and the rest for the high time. Each half is
+	 * (DIV * 2^CKDIV) + 4 cycles.
+	 */
+	total = (mck + bus_speed / 2) / bus_speed;
+	low = total / 2;
+	if (low < low_min) {
+		low = low_min;
+	}
+	if (low >= total || total - low < high_min) {
+		return 0;	// indicate "failure" !
+	}
 
-		// If this is the last byte.
-		if ((counter + 1) == packet->data_length) {
-			// Signal end of transfer
-			twi->TWI_CR = TWI_CR_STOP;
+	for (ckdiv = 0; ckdiv <= TWI_CWGR_CKDIV_MAX_VALUE; ckdiv++) {
+		// Clock Low Divider, rounded up to keep the minimum low time
+		cldiv = (low > 4) ? ((low - 4 + (1u << ckdiv) - 1) >> ckdiv) : 0;
+		if (cldiv > TWI_CWGR_CLDIV_MAX_VALUE ||
+			total < 8 + (cldiv << ckdiv)) {
+			continue;
 		}
-
-		// If a new byte has been received since last read.
-		if (twi->TWI_SR & TWI_SR_RXRDY) {
-			// Put data from TWI_RHR in buffer variable and increment the
-			// pointers address.
-			*packet->buffer++ = twi->TWI_RHR;
-			counter ++;
+		// Clock High Divider, the best of rounding down or up
+		rest = (total - 8 - (cldiv << ckdiv)) >> ckdiv;
+		for (chdiv = rest; chdiv <= rest + 1; chdiv++) {
+			if (chdiv > TWI_CWGR_CLDIV_MAX_VALUE ||
+				(chdiv << ckdiv) + 4 < high_min) {
+				continue;
+			}
+			period = ((cldiv + chdiv) << ckdiv) + 8;
+			error = (period > total) ? period - total : total - period;
+			if (error < best_error) {
+				best_error = error;
+				best_period = period;
+				*cwgr = TWI_CWGR_CLDIV(cldiv) | TWI_CWGR_CHDIV(chdiv) |
+						TWI_CWGR_CKDIV(ckdiv);
+			}
 		}
 	}
+	if (best_period == 0) {
+		return 0;	// indicate "failure" !
+	}
+	return mck / best_period;
+}
 
-	// Wait for Transmission Completed flag to be set
-	while (!(twi->TWI_SR & TWI_SR_TXCOMP));
+uint32_t twi_set_clock_exact(twi_reg_t *twi, uint32_t bus_speed, uint32_t mck) {
+	uint32_t cwgr;
+	uint32_t rate = twi_calc_clock(bus_speed, mck, &cwgr);
 
-	return 1;
+	if (rate) {
+		twi->TWI_CWGR = cwgr;
+	}
+	return rate;
+}
+
+void twi_init_master(twi_reg_t *twi) {
+	// disable Slave Mode
+	twi->TWI_CR = TWI_CR_SVDIS;
+	// enable Master Mode
+	twi->TWI_CR = TWI_CR_MSEN;
 }
-*/
 uint8_t twi_write_master(twi_reg_t *twi, uint8_t *buffer, uint32_t length) {
 	uint32_t status;
 	uint32_t i;
@@ -225,6 +316,335 @@ void twi_slave_write(twi_reg_t *twi, uint8_t *data){
 	}
 }
 */
+/*
+ * Common part of starting a transfer: addresses and the interrupt.
+ */
+static uint8_t twi_master_start(twi_reg_t *twi, const twi_packet_t *packet,
+		twi_callback_t callback, uint8_t state) {
+	twi_state_t *s = twi_state(twi);
+
+	if (s->state != TWI_STATE_IDLE || packet->length == 0 ||
+		packet->address_length > 3) {
+		return 1;	// indicate "failure" !
+	}
+	s->buffer = packet->buffer;
+	s->length = packet->length;
+	s->index = 0;
+	s->callback = callback;
+	s->result = TWI_RESULT_OK;
+	s->state = state;
+
+	twi_set_device_address(twi, packet->chip, packet->address_length);
+	if (state == TWI_STATE_READ) {
+		twi->TWI_MMR |= TWI_MMR_MASTER_READ;
+	}
+	twi_set_internal_address(twi, packet->address);
+	// clear old status
+	(void) PERIPH_REG(twi->TWI_SR);
+	NVIC_ISER0 = (1u << ((twi == TWI0) ? ID_TWI0 : ID_TWI1));
+	return 0;
+}
+
+uint8_t twi_master_read_async(twi_reg_t *twi, const twi_packet_t *packet,
+		twi_callback_t callback) {
+	if (twi_master_start(twi, packet, callback, TWI_STATE_READ)) {
+		return 1;
+	}
+	// with a single byte, STOP must be sent together with START
+	if (packet->length == 1) {
+		twi->TWI_CR = TWI_CR_START | TWI_CR_STOP;
+	} else {
+		twi->TWI_CR = TWI_CR_START;
+	}
+	twi->TWI_IER = TWI_SR_RXRDY | TWI_SR_NACK | TWI_SR_ARBLST | TWI_SR_OVRE;
+	return 0;
+}
+
+uint8_t twi_master_write_async(twi_reg_t *twi, const twi_packet_t *packet,
+		twi_callback_t callback) {
+	if (twi_master_start(twi, packet, callback, TWI_STATE_WRITE)) {
+		return 1;
+	}
+	// writing the first byte starts the transfer
+	twi->TWI_THR = packet->buffer[twi_state(twi)->index++];
+	twi->TWI_IER = TWI_SR_TXRDY | TWI_SR_NACK | TWI_SR_ARBLST;
+	return 0;
+}
+
+uint8_t twi_master_read_dma(twi_reg_t *twi, const twi_packet_t *packet,
+		twi_callback_t callback) {
+	if (packet->length < 3) {
+		return twi_master_read_async(twi, packet, callback);
+	}
+	if (twi_master_start(twi, packet, callback, TWI_STATE_READ)) {
+		return 1;
+	}
+	// the handler takes over for the last two bytes
+	pdc_rx_start(PDC_OF(twi), packet->buffer, packet->length - 2);
+	twi->TWI_CR = TWI_CR_START;
+	twi->TWI_IER = TWI_SR_ENDRX | TWI_SR_NACK | TWI_SR_ARBLST | TWI_SR_OVRE;
+	return 0;
+}
+
+uint8_t twi_master_write_dma(twi_reg_t *twi, const twi_packet_t *packet,
+		twi_callback_t callback) {
+	if (twi_master_start(twi, packet, callback, TWI_STATE_WRITE)) {
+		return 1;
+	}
+	// the first byte written by the PDC starts the transfer
+	pdc_tx_start(PDC_OF(twi), packet->buffer, packet->length);
+	twi->TWI_IER = TWI_SR_ENDTX | TWI_SR_NACK | TWI_SR_ARBLST;
+	return 0;
+}
+
+static void twi_req_done(twi_reg_t *twi, uint8_t result) {
+	io_req_complete(twi_state(twi)->req, result);
+}
+
+uint8_t twi_master_read_req(twi_reg_t *twi, const twi_packet_t *packet,
+		io_req_t *req) {
+	if (twi_master_busy(twi) || !io_req_start(req)) {
+		return 1;
+	}
+	twi_state(twi)->req = req;
+	if (twi_master_read_dma(twi, packet, twi_req_done)) {
+		io_req_cancel(req);
+		return 1;
+	}
+	return 0;
+}
+
+uint8_t twi_master_write_req(twi_reg_t *twi, const twi_packet_t *packet,
+		io_req_t *req) {
+	if (twi_master_busy(twi) || !io_req_start(req)) {
+		return 1;
+	}
+	twi_state(twi)->req = req;
+	if (twi_master_write_dma(twi, packet, twi_req_done)) {
+		io_req_cancel(req);
+		return 1;
+	}
+	return 0;
+}
+
+uint8_t twi_master_read(twi_reg_t *twi, const twi_packet_t *packet) {
+	if (twi_master_read_async(twi, packet, 0)) {
+		return 0xFF;
+	}
+	while (twi_master_busy(twi));
+	return twi_master_result(twi);
+}
+
+uint8_t twi_master_busy(twi_reg_t *twi) {
+	return twi_state(twi)->state != TWI_STATE_IDLE;
+}
+
+void twi_master_abort(twi_reg_t *twi) {
+	twi_state_t *s = twi_state(twi);
+
+	if (s->state == TWI_STATE_WRITE || s->state == TWI_STATE_READ) {
+		twi->TWI_IDR = 0xFFFFFFFFu;
+		pdc_stop(PDC_OF(twi));
+		s->result = TWI_RESULT_TIMEOUT;
+		s->state = TWI_STATE_IDLE;
+		// a waiting task must still wake up
+		if (s->callback == twi_req_done) {
+			io_req_complete(s->req, TWI_RESULT_TIMEOUT);
+		}
+	}
+}
+
+uint8_t twi_master_result(twi_reg_t *twi) {
+	return twi_state(twi)->result;
+}
+
+#if TWI_COOS
+void twi_set_flag(twi_reg_t *twi, uint8_t flag) {
+	twi_state(twi)->flag = flag;
+}
+#endif
+
+static void twi_master_done(twi_reg_t *twi, twi_state_t *s, uint8_t result) {
+	twi->TWI_IDR = 0xFFFFFFFFu;
+	pdc_stop(PDC_OF(twi));
+	s->result = result;
+	s->state = TWI_STATE_IDLE;
+	if (s->callback) {
+		s->callback(twi, result);
+	}
+#if TWI_COOS
+	if (s->flag != TWI_NO_FLAG) {
+		isr_SetFlag(s->flag);
+	}
+#endif
+}
+
+uint8_t twi_slave_start(twi_reg_t *twi, uint8_t slave_address, uint8_t *map,
+		uint32_t size, twi_slave_callback_t on_write,
+		twi_slave_callback_t on_read) {
+	twi_state_t *s = twi_state(twi);
+
+	if (s->state != TWI_STATE_IDLE || size == 0 || size > 256) {
+		return 1;	// indicate "failure" !
+	}
+	s->buffer = map;
+	s->length = size;
+	s->index = 0;
+	s->access = TWI_ACCESS_NONE;
+	s->on_write = on_write;
+	s->on_read = on_read;
+	s->state = TWI_STATE_SLAVE;
+
+	twi_init_slave(twi, slave_address);
+	(void) PERIPH_REG(twi->TWI_SR);
+	twi->TWI_IER = TWI_SR_SVACC;
+	NVIC_ISER0 = (1u << ((twi == TWI0) ? ID_TWI0 : ID_TWI1));
+	return 0;
+}
+
+void twi_slave_stop(twi_reg_t *twi) {
+	twi->TWI_IDR = 0xFFFFFFFFu;
+	twi->TWI_CR = TWI_CR_SVDIS;
+	twi_state(twi)->state = TWI_STATE_IDLE;
+}
+
+/*
+ * Ends the current access of the master, if any. A write is reported to the
+ * application.
+ */
+static void twi_slave_end_access(twi_reg_t *twi, twi_state_t *s) {
+	if (s->access == TWI_ACCESS_WRITE && s->count && s->on_write) {
+		s->on_write(twi, s->start, s->count);
+	}
+	s->access = TWI_ACCESS_NONE;
+}
+
+/*
+ * Bytes to the master are written when the peripheral stretches the clock
+ * (SCLWS), which only happens in a read, and bytes from the master are read
+ * on RXRDY. Seeing the other direction than the current access means a
+ * repeated start.
+ */
+static void twi_slave_handler(twi_reg_t *twi, twi_state_t *s, uint32_t status) {
+	uint32_t pending = status & twi->TWI_IMR;
+	uint8_t data;
+
+	if (pending & TWI_SR_SVACC) {
+		// start of an access, serve it until its end
+		twi->TWI_IDR = TWI_SR_SVACC;
+		twi->TWI_IER = TWI_SR_RXRDY | TWI_SR_SCLWS | TWI_SR_EOSACC;
+	}
+	if ((status & TWI_SR_RXRDY) && !(status & TWI_SR_SVREAD)) {
+		if (s->access != TWI_ACCESS_WRITE) {
+			twi_slave_end_access(twi, s);
+			s->access = TWI_ACCESS_WRITE;
+			s->first = 1;
+			s->count = 0;
+		}
+		data = (uint8_t) twi->TWI_RHR;
+		if (s->first) {
+			// the register that is written or read next
+			s->first = 0;
+			s->index = data % s->length;
+			s->start = s->index;
+		} else {
+			s->buffer[s->index] = data;
+			s->index = (s->index + 1) % s->length;
+			s->count++;
+		}
+	}
+	if ((status & TWI_SR_SCLWS) && (status & TWI_SR_SVREAD)) {
+		if (s->access != TWI_ACCESS_READ) {
+			twi_slave_end_access(twi, s);
+			s->access = TWI_ACCESS_READ;
+			if (s->on_read) {
+				s->on_read(twi, s->index, 0);
+			}
+		}
+		twi->TWI_THR = s->buffer[s->index];
+		s->index = (s->index + 1) % s->length;
+	}
+	if (pending & TWI_SR_EOSACC) {
+		twi_slave_end_access(twi, s);
+		twi->TWI_IDR = TWI_SR_RXRDY | TWI_SR_SCLWS | TWI_SR_EOSACC;
+		twi->TWI_IER = TWI_SR_SVACC;
+	}
+}
+
+static void twi_handler(twi_reg_t *twi, twi_state_t *s) {
+	// reading the status clears NACK, ARBLST and OVRE, so it is only read once
+	uint32_t status = twi->TWI_SR;
+	uint32_t pending = status & twi->TWI_IMR;
+
+	if (s->state == TWI_STATE_SLAVE) {
+		twi_slave_handler(twi, s, status);
+		return;
+	}
+
+	if (pending & TWI_SR_ARBLST) {
+		twi_master_done(twi, s, TWI_RESULT_ARBLST);
+		return;
+	}
+	if (pending & TWI_SR_NACK) {
+		// the peripheral has sent STOP itself
+		twi_master_done(twi, s, TWI_RESULT_NACK);
+		return;
+	}
+	if (pending & TWI_SR_OVRE) {
+		twi->TWI_CR = TWI_CR_STOP;
+		twi_master_done(twi, s, TWI_RESULT_OVERRUN);
+		return;
+	}
+	if (pending & TWI_SR_TXCOMP) {
+		twi_master_done(twi, s, TWI_RESULT_OK);
+		return;
+	}
+
+	// end of a PDC transfer, continue like a transfer without the PDC
+	if (pending & TWI_SR_ENDRX) {
+		pdc_rx_stop(PDC_OF(twi));
+		twi->TWI_IDR = TWI_SR_ENDRX;
+		s->index = s->length - 2;
+		twi->TWI_IER = TWI_SR_RXRDY;
+		return;
+	}
+	if (pending & TWI_SR_ENDTX) {
+		pdc_tx_stop(PDC_OF(twi));
+		twi->TWI_IDR = TWI_SR_ENDTX;
+		s->index = s->length;
+		twi->TWI_IER = TWI_SR_TXRDY;
+		return;
+	}
+
+	if (s->state == TWI_STATE_WRITE && (pending & TWI_SR_TXRDY)) {
+		if (s->index < s->length) {
+			twi->TWI_THR = s->buffer[s->index++];
+		} else {
+			// last byte acknowledged, send STOP
+			twi->TWI_CR = TWI_CR_STOP;
+			twi->TWI_IDR = TWI_SR_TXRDY;
+			twi->TWI_IER = TWI_SR_TXCOMP;
+		}
+	} else if (s->state == TWI_STATE_READ && (pending & TWI_SR_RXRDY)) {
+		s->buffer[s->index++] = (uint8_t) twi->TWI_RHR;
+		// STOP must be set while the last byte is being received
+		if (s->index == s->length - 1) {
+			twi->TWI_CR = TWI_CR_STOP;
+		} else if (s->index == s->length) {
+			twi->TWI_IDR = TWI_SR_RXRDY;
+			twi->TWI_IER = TWI_SR_TXCOMP;
+		}
+	}
+}
+
+void TWI0_Handler(void) {
+	twi_handler(TWI0, &states[0]);
+}
+
+void TWI1_Handler(void) {
+	twi_handler(TWI1, &states[1]);
+}
+
 void twi_reset(twi_reg_t *twi) {
 	twi->TWI_CR = TWI_CR_SWRST;
 }
@@ -14,13 +14,27 @@
 #define TWI_H_
 
 #include <inttypes.h>
+#include "periph.h"
+#include "io_req.h"
+
+/*
+ * Set to 0 to build without the CoOS event flag support, e.g. when the RTOS
+ * is not linked into the application.
+ */
+#ifndef TWI_COOS
+#define TWI_COOS	(1)
+#endif
+
+// No event flag is set when a transfer is done
+#define TWI_NO_FLAG	(0xFFu)
 
 // Base addresses to TWI registers
-#define TWI0 ((twi_reg_t *) 0x4008C000U)
-#define TWI1 ((twi_reg_t *) 0x40090000U)
+#define TWI0 ((twi_reg_t *) PERIPH_ADDR(0x4008C000U))
+#define TWI1 ((twi_reg_t *) PERIPH_ADDR(0x40090000U))
 
 #define TWI_STANDARD_MODE_SPEED 100000U
 #define TWI_FAST_MODE_SPEED 400000U
+#define TWI_FAST_MODE_PLUS_SPEED 1000000U
 
 // Control Register
 #define TWI_CR_START (0x1u << 0)
@@ -38,8 +52,19 @@
 #define TWI_SR_SVREAD 			(0x1u << 3)
 #define TWI_SR_SVACC 			(0x1u << 4)
 #define TWI_SR_GACC 			(0x1u << 5)
+#define TWI_SR_OVRE 			(0x1u << 6)
 #define TWI_SR_NACK 			(0x1u << 8)
+#define TWI_SR_ARBLST 			(0x1u << 9)
+#define TWI_SR_SCLWS 			(0x1u << 10)
 #define TWI_SR_EOSACC 			(0x1u << 11)
+#define TWI_SR_ENDRX 			(0x1u << 12)
+#define TWI_SR_ENDTX 			(0x1u << 13)
+
+// PDC Transfer Control Register
+#define TWI_PTCR_RXTEN			(0x1u << 0)
+#define TWI_PTCR_RXTDIS			(0x1u << 1)
+#define TWI_PTCR_TXTEN			(0x1u << 8)
+#define TWI_PTCR_TXTDIS			(0x1u << 9)
 
 // Slave Mode Register
 #define TWI_SMR_SADR(sadr)		(((sadr) & 127u) << 16)
@@ -104,8 +129,70 @@ typedef struct twi_reg {
 	uint32_t TWI_RHR;
 	// Transmit Holding Register, offset: 0x34
 	uint32_t TWI_THR;
+	// Reserved, offset: 0x38-0xFC
+	uint32_t reserved1[50];
+	// PDC Receive Pointer Register, offset: 0x100
+	uint32_t TWI_RPR;
+	// PDC Receive Counter Register, offset: 0x104
+	uint32_t TWI_RCR;
+	// PDC Transmit Pointer Register, offset: 0x108
+	uint32_t TWI_TPR;
+	// PDC Transmit Counter Register, offset: 0x10C
+	uint32_t TWI_TCR;
+	// PDC Receive Next Pointer Register, offset: 0x110
+	uint32_t TWI_RNPR;
+	// PDC Receive Next Counter Register, offset: 0x114
+	uint32_t TWI_RNCR;
+	// PDC Transmit Next Pointer Register, offset: 0x118
+	uint32_t TWI_TNPR;
+	// PDC Transmit Next Counter Register, offset: 0x11C
+	uint32_t TWI_TNCR;
+	// PDC Transfer Control Register, offset: 0x120
+	uint32_t TWI_PTCR;
+	// PDC Transfer Status Register, offset: 0x124
+	uint32_t TWI_PTSR;
 } twi_reg_t;
 
+// Results of an interrupt-driven transfer
+#define TWI_RESULT_OK			(0)
+#define TWI_RESULT_NACK			(1)
+#define TWI_RESULT_ARBLST		(2)
+#define TWI_RESULT_OVERRUN		(3)
+#define TWI_RESULT_TIMEOUT		(4)
+
+/*
+ * A transfer with a slave device. The internal address (0-3 bytes) is sent
+ * after the device address; for a read it is followed by a repeated start,
+ * which makes a read with an internal address a combined write-then-read.
+ */
+typedef struct twi_packet {
+	// Device address of the slave device
+	uint8_t chip;
+	// Internal address of the slave device
+	uint32_t address;
+	// Internal Address Size (0-3 bytes)
+	uint8_t address_length;
+	// Data to write, or where to store the data that is read
+	uint8_t *buffer;
+	// Number of bytes (at least 1)
+	uint32_t length;
+} twi_packet_t;
+
+/*
+ * Called from the TWI interrupt when a transfer is done.
+ * result is one of the values with prefix TWI_RESULT_.
+ */
+typedef void (*twi_callback_t)(twi_reg_t *twi, uint8_t result);
+
+/*
+ * Called from the TWI interrupt in slave mode. For a write from the master,
+ * reg is the first register written and count the number of bytes, called
+ * at the end of the access. For a read, it is called before the first byte
+ * is sent, with count 0, so the registers can be updated.
+ */
+typedef void (*twi_slave_callback_t)(twi_reg_t *twi, uint32_t reg,
+		uint32_t count);
+
 /**
  * @brief Set address of the slave device.
  * @param twi Pointer to a TWI instance.
@@ -130,6 +217,31 @@ void twi_set_internal_address(twi_reg_t *twi, uint32_t iadr);
  */
 uint8_t twi_set_clock(twi_reg_t *twi, uint32_t bus_speed, uint32_t mck);
 
+/**
+ * @brief Calculate the dividers for a TWI bus speed.
+ * @details Searches CKDIV, CLDIV and CHDIV for the clock period closest to
+ * the desired one. The low and high times of SCL are split to meet the
+ * minimum times of the bus speed's mode (standard mode up to 100 kHz, fast
+ * mode up to 400 kHz, fast mode plus up to 1 MHz), which makes the low time
+ * longer than the high time in fast mode.
+ * @param bus_speed The desired TWI bus speed (Hz)
+ * @param mck Master Clock frequency (Hz)
+ * @param cwgr Where to store the value for the Clock Waveform Generator
+ * Register.
+ * @return The achieved bus speed (Hz), 0 = Failure (invalid parameters)
+ */
+uint32_t twi_calc_clock(uint32_t bus_speed, uint32_t mck, uint32_t *cwgr);
+
+/**
+ * @brief Set the TWI bus speed as close as possible to the desired speed.
+ * @details Uses twi_calc_clock().
+ * @param twi Pointer to a TWI instance.
+ * @param bus_speed The desired TWI bus speed (Hz), up to 1 MHz
+ * @param mck Master Clock frequency (Hz)
+ * @return The achieved bus speed (Hz), 0 = Failure (invalid parameters)
+ */
+uint32_t twi_set_clock_exact(twi_reg_t *twi, uint32_t bus_speed, uint32_t mck);
+
 /**
  * @brief Initialize TWI instance as master.
  * @param twi Pointer to a TWI instance.
@@ -137,12 +249,121 @@ uint8_t twi_set_clock(twi_reg_t *twi, uint32_t bus_speed, uint32_t mck);
 void twi_init_master(twi_reg_t *twi);
 
 /**
- * @brief Read multiple bytes from a slave device.
+ * @brief Read multiple bytes from a slave device, and wait until done.
+ * @details Uses the interrupt-driven transfer of twi_master_read_async().
+ * @param twi Pointer to a TWI instance.
+ * @param packet Which address to read from and where to store the data.
+ * @return 0 = Success, otherwise the failure (prefix TWI_RESULT_) or
+ * 0xFF on invalid parameters
+ */
+uint8_t twi_master_read(twi_reg_t *twi, const twi_packet_t *packet);
+
+/**
+ * @brief Start reading (as Master) from a slave device.
+ * @details The transfer is done by the TWI interrupt and the function returns
+ * immediately. Completion is signalled through the callback, the event flag
+ * set with twi_set_flag() and twi_master_busy(). The buffer of the packet
+ * must remain valid until then, the packet itself may be reused.
+ * @param twi Pointer to a TWI instance.
+ * @param packet Which address to read from and where to store the data.
+ * @param callback Called when done, or 0.
+ * @return 0 = Success, 1 = Failure (busy or invalid parameters)
+ */
+uint8_t twi_master_read_async(twi_reg_t *twi, const twi_packet_t *packet,
+		twi_callback_t callback);
+
+/**
+ * @brief Start writing (as Master) to a slave device.
+ * @details Works like twi_master_read_async().
+ * @param twi Pointer to a TWI instance.
+ * @param packet Which address to write to and the data.
+ * @param callback Called when done, or 0.
+ * @return 0 = Success, 1 = Failure (busy or invalid parameters)
+ */
+uint8_t twi_master_write_async(twi_reg_t *twi, const twi_packet_t *packet,
+		twi_callback_t callback);
+
+/**
+ * @brief Start reading (as Master) from a slave device with the PDC.
+ * @details Works like twi_master_read_async(), but all bytes except the last
+ * two are moved by the PDC. The last two are read by the interrupt handler,
+ * as STOP must be sent while the last byte is received. Transfers of less
+ * than three bytes use the interrupt handler only.
+ * @param twi Pointer to a TWI instance.
+ * @param packet Which address to read from and where to store the data.
+ * @param callback Called when done, or 0.
+ * @return 0 = Success, 1 = Failure (busy or invalid parameters)
+ */
+uint8_t twi_master_read_dma(twi_reg_t *twi, const twi_packet_t *packet,
+		twi_callback_t callback);
+
+/**
+ * @brief Start writing (as Master) to a slave device with the PDC.
+ * @details Works like twi_master_write_async(), but the bytes are moved by
+ * the PDC. STOP is sent from the interrupt handler when the last byte has
+ * been acknowledged.
+ * @param twi Pointer to a TWI instance.
+ * @param packet Which address to write to and the data.
+ * @param callback Called when done, or 0.
+ * @return 0 = Success, 1 = Failure (busy or invalid parameters)
+ */
+uint8_t twi_master_write_dma(twi_reg_t *twi, const twi_packet_t *packet,
+		twi_callback_t callback);
+
+/**
+ * @brief Start reading (as Master) from a slave device, completing a request.
+ * @details Works like twi_master_read_dma(). The result of the request is
+ * one of the values with prefix TWI_RESULT_, also after twi_master_abort().
  * @param twi Pointer to a TWI instance.
  * @param packet Which address to read from and where to store the data.
- * @return 1=pass, 0=NACK detected or illegal values
+ * @param req The request, set up with io_req_init().
+ * @return 0 = Success, 1 = Failure (busy, request busy or invalid parameters)
  */
-//uint8_t twi_master_read(twi_reg_t *twi, twi_packet_t *packet);
+uint8_t twi_master_read_req(twi_reg_t *twi, const twi_packet_t *packet,
+		io_req_t *req);
+
+/**
+ * @brief Start writing (as Master) to a slave device, completing a request.
+ * @details Works like twi_master_write_dma() and twi_master_read_req().
+ * @param twi Pointer to a TWI instance.
+ * @param packet Which address to write to and the data.
+ * @param req The request, set up with io_req_init().
+ * @return 0 = Success, 1 = Failure (busy, request busy or invalid parameters)
+ */
+uint8_t twi_master_write_req(twi_reg_t *twi, const twi_packet_t *packet,
+		io_req_t *req);
+
+/**
+ * @brief Check if an interrupt-driven transfer is in progress.
+ * @param twi Pointer to a TWI instance.
+ * @return 1 = busy, 0 = done
+ */
+uint8_t twi_master_busy(twi_reg_t *twi);
+
+/**
+ * @brief Stop an interrupt-driven transfer without calling its callback.
+ * @details Used when the bus is stuck and no interrupt comes. The TWI
+ * should be reset afterwards. The request of a transfer started with
+ * twi_master_read_req() or twi_master_write_req() is completed.
+ * @param twi Pointer to a TWI instance.
+ */
+void twi_master_abort(twi_reg_t *twi);
+
+/**
+ * @brief Result of the last interrupt-driven transfer.
+ * @param twi Pointer to a TWI instance.
+ * @return One of the values with prefix TWI_RESULT_.
+ */
+uint8_t twi_master_result(twi_reg_t *twi);
+
+#if TWI_COOS
+/**
+ * @brief Set a CoOS event flag (isr_SetFlag()) when a transfer is done.
+ * @param twi Pointer to a TWI instance.
+ * @param flag The flag, or TWI_NO_FLAG.
+ */
+void twi_set_flag(twi_reg_t *twi, uint8_t flag);
+#endif
 
 /**
  * @brief Write (as Master) multiple bytes to a slave device.
@@ -168,6 +389,32 @@ void twi_init_slave(twi_reg_t *twi, uint8_t slave_address);
  */
 void twi_read_slave(twi_reg_t *twi, uint8_t *buffer, uint32_t *length);
 
+/**
+ * @brief Start interrupt-driven slave mode with a register map.
+ * @details The driver answers the master from the TWI interrupt. The first
+ * byte of a write from the master selects the register, the following bytes
+ * are stored in the map from there on. A read returns the bytes of the map
+ * from the selected register. The register pointer wraps at the end of the
+ * map. A write of the register followed by a repeated start and a read is
+ * handled as well.
+ * @param twi Pointer to a TWI instance.
+ * @param slave_address Device address of the slave device on the TWI bus.
+ * @param map The registers, must remain valid until twi_slave_stop().
+ * @param size Number of registers (1-256).
+ * @param on_write Called after the master has written registers, or 0.
+ * @param on_read Called before the master reads registers, or 0.
+ * @return 0 = Success, 1 = Failure (busy or invalid parameters)
+ */
+uint8_t twi_slave_start(twi_reg_t *twi, uint8_t slave_address, uint8_t *map,
+		uint32_t size, twi_slave_callback_t on_write,
+		twi_slave_callback_t on_read);
+
+/**
+ * @brief Stop interrupt-driven slave mode.
+ * @param twi Pointer to a TWI instance.
+ */
+void twi_slave_stop(twi_reg_t *twi);
+
 /**
  * @brief Write data to the TWI bus.
  * @param twi Pointer to a TWI instance.
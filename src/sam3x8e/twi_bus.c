@@ -0,0 +1,208 @@
+/*
+ * twi_bus.c
+ *
+ * Date:	14 October 2026
+ */
+
+#include "twi_bus.h"
+#include "pio.h"
+#include "delay.h"
+#include "irq.h"
+#if TWI_BUS_COOS
+#include "rtos/CoOS.h"
+#endif
+
+// Clock pulses that free a slave in the middle of a byte
+#define TWI_BUS_RECOVERY_CLOCKS	(9)
+// Half of a 100 kHz clock period
+#define TWI_BUS_HALF_PERIOD_US	(5)
+
+// The queue of one TWI instance and its pins
+typedef struct {
+	twi_transaction_t *head;
+	twi_transaction_t *tail;
+	pio_reg_t *port;
+	uint8_t sda;
+	uint8_t scl;
+} twi_bus_t;
+
+static twi_bus_t buses[2];
+
+static inline twi_bus_t *twi_bus(twi_reg_t *twi) {
+	return &buses[twi == TWI1];
+}
+
+static void transfer_done(twi_reg_t *twi, uint8_t result);
+
+static void start_head(twi_reg_t *twi, twi_bus_t *b) {
+	twi_transaction_t *t = b->head;
+
+	if (t->direction == TWI_BUS_READ) {
+		twi_master_read_dma(twi, &t->packet, transfer_done);
+	} else {
+		twi_master_write_dma(twi, &t->packet, transfer_done);
+	}
+}
+
+/*
+ * Frees the bus: clocks SCL until SDA is released, generates a STOP and
+ * resets the peripheral with its clock settings kept.
+ */
+static void recover_bus(twi_reg_t *twi, twi_bus_t *b) {
+	uint32_t cwgr = twi->TWI_CWGR;
+	uint32_t i;
+	pio_pin_cfg_t pins[2] = {
+		{ b->port, b->sda, PIO_CFG_OUTPUT, PIO_CFG_OPEN_DRAIN | PIO_CFG_HIGH },
+		{ b->port, b->scl, PIO_CFG_OUTPUT, PIO_CFG_OPEN_DRAIN | PIO_CFG_HIGH },
+	};
+
+	twi_master_abort(twi);
+	pio_apply_config(pins, 2);
+	for (i = 0; i < TWI_BUS_RECOVERY_CLOCKS; i++) {
+		if (pio_read_pin(b->port, b->sda)) {
+			break;
+		}
+		pio_set_pin(b->port, b->scl, 0);
+		delay_micros(TWI_BUS_HALF_PERIOD_US);
+		pio_set_pin(b->port, b->scl, 1);
+		delay_micros(TWI_BUS_HALF_PERIOD_US);
+	}
+	// STOP: SDA goes high while SCL is high
+	pio_set_pin(b->port, b->sda, 0);
+	delay_micros(TWI_BUS_HALF_PERIOD_US);
+	pio_set_pin(b->port, b->sda, 1);
+	delay_micros(TWI_BUS_HALF_PERIOD_US);
+
+	pins[0].mode = PIO_CFG_PERIPH_A;
+	pins[0].flags = 0;
+	pins[1].mode = PIO_CFG_PERIPH_A;
+	pins[1].flags = 0;
+	pio_apply_config(pins, 2);
+	twi_reset(twi);
+	twi->TWI_CWGR = cwgr;
+	twi_init_master(twi);
+}
+
+/*
+ * Retries the transaction at the head of the queue after a bus recovery,
+ * or completes it and starts the next one.
+ */
+static void finish_head(twi_reg_t *twi, twi_bus_t *b, uint8_t result) {
+	twi_transaction_t *t = b->head;
+
+	if (result != TWI_RESULT_OK) {
+		recover_bus(twi, b);
+		if (t->attempts < TWI_BUS_RETRIES) {
+			t->attempts++;
+			start_head(twi, b);
+			return;
+		}
+	}
+	// The transaction may be reused as soon as done is set
+	b->head = t->next;
+	if (!b->head) {
+		b->tail = 0;
+	}
+	t->result = result;
+	t->done = 1;
+#if TWI_BUS_COOS
+	if (t->flag != TWI_NO_FLAG) {
+		isr_SetFlag(t->flag);
+	}
+#endif
+	if (b->head) {
+		start_head(twi, b);
+	}
+}
+
+static void transfer_done(twi_reg_t *twi, uint8_t result) {
+	twi_bus_t *b = twi_bus(twi);
+
+	if (b->head) {
+		finish_head(twi, b, result);
+	}
+}
+
+uint8_t twi_bus_init(twi_reg_t *twi) {
+	twi_bus_t *b = twi_bus(twi);
+
+	if (twi == TWI0) {
+		b->port = PIOA;
+		b->sda = 17;
+		b->scl = 18;
+	} else if (twi == TWI1) {
+		b->port = PIOB;
+		b->sda = 12;
+		b->scl = 13;
+	} else {
+		return 1;	// indicate "failure" !
+	}
+	b->head = b->tail = 0;
+	return 0;
+}
+
+uint8_t twi_bus_submit(twi_reg_t *twi, twi_transaction_t *transaction) {
+	twi_bus_t *b = twi_bus(twi);
+	uint32_t primask;
+
+	if (transaction->packet.length == 0 ||
+		transaction->packet.address_length > 3) {
+		return 1;	// indicate "failure" !
+	}
+	transaction->next = 0;
+	transaction->done = 0;
+	transaction->attempts = 0;
+
+	primask = irq_save();
+	if (b->tail) {
+		b->tail->next = transaction;
+		b->tail = transaction;
+	} else {
+		b->head = b->tail = transaction;
+		start_head(twi, b);
+	}
+	irq_restore(primask);
+	return 0;
+}
+
+uint8_t twi_bus_transfer(twi_reg_t *twi, twi_transaction_t *transaction) {
+	uint32_t waited = 0;
+
+	if (twi_bus_submit(twi, transaction)) {
+		return 0xFF;
+	}
+	while (!transaction->done) {
+#if TWI_BUS_COOS
+		if (transaction->flag != TWI_NO_FLAG) {
+			if (CoWaitForSingleFlag(transaction->flag, TWI_BUS_TIMEOUT)
+					== E_TIMEOUT && twi_bus(twi)->head == transaction) {
+				twi_bus_recover(twi);
+			}
+			continue;
+		}
+#endif
+		delay_ms(1);
+		// only the transaction in progress can be stuck
+		if (++waited >= TWI_BUS_TIMEOUT && twi_bus(twi)->head == transaction) {
+			twi_bus_recover(twi);
+			waited = 0;
+		}
+	}
+	return transaction->result;
+}
+
+void twi_bus_recover(twi_reg_t *twi) {
+	twi_bus_t *b = twi_bus(twi);
+	uint32_t primask = irq_save();
+
+	if (b->head) {
+		finish_head(twi, b, TWI_RESULT_TIMEOUT);	// recovers the bus
+	} else {
+		recover_bus(twi, b);
+	}
+	irq_restore(primask);
+}
+
+uint8_t twi_bus_idle(twi_reg_t *twi) {
+	return twi_bus(twi)->head == 0;
+}
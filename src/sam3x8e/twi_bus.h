@@ -0,0 +1,113 @@
+/**
+ * @file twi_bus.h
+ * @brief TWI - Bus manager
+ * @details Lets several tasks share one TWI master with different devices.
+ * A task describes a transaction (packet and direction) and submits it; the
+ * manager does the transactions back-to-back in the order they were
+ * submitted, with the PDC transfers of twi.h, started from the TWI
+ * interrupt so there are no gaps between them.
+ *
+ * A transaction that ends with NACK or lost arbitration is retried after a
+ * bus recovery: SCL is clocked by the PIO until a slave holding SDA low lets
+ * go, a STOP is generated and the TWI is reset with its clock settings kept.
+ * A stuck bus gives no interrupt at all, so a waiting task that times out
+ * (TWI_BUS_TIMEOUT) recovers the bus and retries in the same way.
+ *
+ * @pre The TWI must be initialized as master with twi_set_clock() and
+ * twi_init_master(), and its pins given to the peripheral (TWI0: PA17 SDA,
+ * PA18 SCL, TWI1: PB12 SDA, PB13 SCL) with the PIO clock enabled.
+ * @pre CoOS delivery requires CFG_MAX_SERVICE_REQUEST > 0 and an event flag
+ * created with CoCreateFlag(1, 0) (auto reset) for every waiting task.
+ * @date 14 October 2026
+ */
+
+#ifndef TWI_BUS_H_
+#define TWI_BUS_H_
+
+#include <inttypes.h>
+#include "twi.h"
+
+/*
+ * Set to 0 to build without the CoOS event flags, e.g. when the RTOS is not
+ * linked into the application.
+ */
+#ifndef TWI_BUS_COOS
+#define TWI_BUS_COOS			(1)
+#endif
+
+// Number of retries after the first attempt has failed
+#ifndef TWI_BUS_RETRIES
+#define TWI_BUS_RETRIES			(2)
+#endif
+
+// How long a task waits for its transaction in progress before recovering
+// the bus (CoOS ticks with an event flag, otherwise milliseconds). 256 bytes
+// take 23 ms at 100 kHz.
+#ifndef TWI_BUS_TIMEOUT
+#define TWI_BUS_TIMEOUT			(50)
+#endif
+
+// Direction of a transaction
+#define TWI_BUS_WRITE			(0)
+#define TWI_BUS_READ			(1)
+
+/*
+ * One transaction. The transaction and the buffer of the packet must stay
+ * valid until done is set.
+ */
+typedef struct twi_transaction {
+	// The device, internal address and data
+	twi_packet_t packet;
+	// TWI_BUS_WRITE or TWI_BUS_READ
+	uint8_t direction;
+	// CoOS event flag set when done, or TWI_NO_FLAG
+	uint8_t flag;
+	// Set to 1 from the interrupt when the transaction is done
+	volatile uint8_t done;
+	// Result when done (prefix TWI_RESULT_)
+	volatile uint8_t result;
+	// Used by the manager
+	uint8_t attempts;
+	struct twi_transaction *next;
+} twi_transaction_t;
+
+/**
+ * @brief Initialize the bus manager for a TWI instance.
+ * @param twi Pointer to a TWI instance.
+ * @return 0 = Success, 1 = Failure (invalid TWI instance)
+ */
+uint8_t twi_bus_init(twi_reg_t *twi);
+
+/**
+ * @brief Append a transaction to the queue and return.
+ * @param twi Pointer to a TWI instance.
+ * @param transaction The transaction.
+ * @return 0 = Success, 1 = Failure (invalid parameters)
+ */
+uint8_t twi_bus_submit(twi_reg_t *twi, twi_transaction_t *transaction);
+
+/**
+ * @brief Submit a transaction and wait until it is done.
+ * @details The calling task blocks on the event flag of the transaction, if
+ * it has one. The bus is recovered if the transaction isn't done in time.
+ * @param twi Pointer to a TWI instance.
+ * @param transaction The transaction.
+ * @return 0 = Success, otherwise the failure (prefix TWI_RESULT_) or
+ * 0xFF on invalid parameters
+ */
+uint8_t twi_bus_transfer(twi_reg_t *twi, twi_transaction_t *transaction);
+
+/**
+ * @brief Recover a stuck bus and retry (or fail) the current transaction.
+ * @param twi Pointer to a TWI instance.
+ */
+void twi_bus_recover(twi_reg_t *twi);
+
+/**
+ * @brief Check if the queue is empty.
+ * @param twi Pointer to a TWI instance.
+ * @return 1 = no transactions, 0 = transactions queued
+ */
+uint8_t twi_bus_idle(twi_reg_t *twi);
+
+#endif
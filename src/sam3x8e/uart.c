@@ -8,6 +8,61 @@
  */ 
 
 #include "uart.h"
+#include "pdc.h"
+#include "ring.h"
+#if UART_COOS
+#include "rtos/CoOS.h"
+#endif
+
+///@cond
+// NVIC Interrupt Set/Clear-Enable Registers 0 (peripheral ID 0-31)
+#define NVIC_ISER0		(*((volatile uint32_t *) PERIPH_ADDR(0xE000E100U)))
+#define NVIC_ICER0		(*((volatile uint32_t *) PERIPH_ADDR(0xE000E180U)))
+// Peripheral ID/IRQ number of the UART
+#define UART_IRQ		(8)
+
+#define UART_NO_SEM		(0xFFu)
+///@endcond
+
+// Single producer, single consumer ring buffers, the handler is one side
+static uint8_t tx_data[UART_TX_BUFFER_SIZE];
+static uint8_t rx_data[UART_RX_BUFFER_SIZE];
+static ring_t tx_ring = RING_INIT(tx_data, UART_TX_BUFFER_SIZE);
+static ring_t rx_ring = RING_INIT(rx_data, UART_RX_BUFFER_SIZE);
+#if UART_COOS
+static volatile uint8_t rx_sem = UART_NO_SEM;
+#endif
+
+// PDC transmission states
+#define DMA_TX_IDLE		(0)
+#define DMA_TX_QUEUED	(1)
+#define DMA_TX_ACTIVE	(2)
+
+static volatile uint32_t dma_tx_state = DMA_TX_IDLE;
+static volatile uint32_t dma_tx_mark;	// tx_ring.head when queued
+static const void *dma_tx_buf;
+static uint32_t dma_tx_len;
+static uart_dma_callback_t dma_tx_callback;
+// completed by the callback of uart_write_dma_req()
+static io_req_t *dma_tx_req;
+
+// baud rate of uart_init(), kept for a change of the master clock
+static uint32_t baud_rate;
+
+static uint8_t *dma_rx_buf;
+static uint32_t dma_rx_size;
+static uint32_t dma_rx_tail;
+static uint32_t dma_rx_last;
+
+static void start_dma_tx(void) {
+	dma_tx_state = DMA_TX_ACTIVE;
+	pdc_tx_start(PDC_OF(UART), dma_tx_buf, dma_tx_len);
+	UART->UART_IER = UART_SR_ENDTX;
+}
+
+static void uart_clock_changed(uint32_t mck) {
+	UART->UART_BRGR = 0xFFFFu & ((mck >> 4) / baud_rate);
+}
 
 void uart_init(const uart_settings_t *settings) {
 	/*
@@ -18,6 +73,8 @@ void uart_init(const uart_settings_t *settings) {
 					UART_CR_RXDIS | UART_CR_TXDIS;
 	// configure baud rate
 	UART->UART_BRGR = UART_BRGR_CD(settings->baud_rate);
+	baud_rate = settings->baud_rate;
+	pmc_add_clock_notifier(uart_clock_changed);
 	// configure mode
 	UART->UART_MR = UART_MR_CHMODE(settings->ch_mode);
 	// enable receiver and transmitter
@@ -48,3 +105,199 @@ char uart_read_char(void) {
 	char chr = (char) UART->UART_RHR;
 	return chr;
 }
+
+void uart_enable_interrupt_mode(void) {
+	ring_reset(&tx_ring);
+	ring_reset(&rx_ring);
+	// the transmitter interrupt is enabled when there is something to send
+	UART->UART_IDR = UART_SR_TXRDY;
+	UART->UART_IER = UART_SR_RXRDY;
+	NVIC_ISER0 = (1u << UART_IRQ);
+}
+
+void uart_disable_interrupt_mode(void) {
+	// wait until the buffered characters have been sent
+	while (ring_count(&tx_ring) != 0);
+	UART->UART_IDR = UART_SR_RXRDY | UART_SR_TXRDY;
+	NVIC_ICER0 = (1u << UART_IRQ);
+}
+
+uint32_t uart_write(const void *buf, uint32_t len) {
+	len = ring_write(&tx_ring, buf, len);
+	if (len > 0) {
+		UART->UART_IER = UART_SR_TXRDY;
+	}
+	return len;
+}
+
+uint32_t uart_read(void *buf, uint32_t len) {
+	return ring_read(&rx_ring, buf, len);
+}
+
+uint32_t uart_rx_available(void) {
+	return ring_count(&rx_ring);
+}
+
+uint32_t uart_tx_pending(void) {
+	return ring_count(&tx_ring);
+}
+
+uint8_t uart_write_dma(const void *buf, uint32_t len,
+		uart_dma_callback_t callback) {
+	if (dma_tx_state != DMA_TX_IDLE || len == 0 || len > 0xFFFFu) {
+		return 0;
+	}
+	dma_tx_buf = buf;
+	dma_tx_len = len;
+	dma_tx_callback = callback;
+	NVIC_ISER0 = (1u << UART_IRQ);
+
+	if (ring_count(&tx_ring) == 0) {
+		start_dma_tx();
+	} else {
+		// wait for the transmitter interrupt to empty the ring buffer
+		dma_tx_mark = tx_ring.head;
+		dma_tx_state = DMA_TX_QUEUED;
+		UART->UART_IER = UART_SR_TXRDY;
+	}
+	return 1;
+}
+
+static void dma_tx_req_done(void) {
+	io_req_complete(dma_tx_req, 1);
+}
+
+uint8_t uart_write_dma_req(const void *buf, uint32_t len, io_req_t *req) {
+	if (dma_tx_state != DMA_TX_IDLE || !io_req_start(req)) {
+		return 0;
+	}
+	dma_tx_req = req;
+	if (!uart_write_dma(buf, len, dma_tx_req_done)) {
+		io_req_cancel(req);
+		return 0;
+	}
+	return 1;
+}
+
+uint32_t uart_write_dma_busy(void) {
+	return (dma_tx_state != DMA_TX_IDLE);
+}
+
+uint8_t uart_dma_rx_start(void *buf, uint32_t size) {
+	uint32_t half = size / 2;
+
+	if (size < 2 || size > 0xFFFEu || (size & 1)) {
+		return 0;
+	}
+	UART->UART_IDR = UART_SR_RXRDY | UART_SR_ENDRX;
+	pdc_rx_stop(PDC_OF(UART));
+	dma_rx_buf = (uint8_t *) buf;
+	dma_rx_size = size;
+	dma_rx_tail = 0;
+	dma_rx_last = 0;
+
+	pdc_rx_start_ping_pong(PDC_OF(UART), dma_rx_buf, dma_rx_buf + half, half);
+	UART->UART_IER = UART_SR_ENDRX;
+	NVIC_ISER0 = (1u << UART_IRQ);
+	return 1;
+}
+
+void uart_dma_rx_stop(void) {
+	UART->UART_IDR = UART_SR_ENDRX;
+	pdc_rx_stop(PDC_OF(UART));
+	dma_rx_size = 0;
+}
+
+/*
+ * Position in the circular buffer where the PDC writes the next character.
+ */
+static uint32_t dma_rx_head(void) {
+	uint32_t head = pdc_rx_position(PDC_OF(UART)) - (uint32_t) dma_rx_buf;
+	return (head >= dma_rx_size) ? 0 : head;
+}
+
+uint32_t uart_dma_rx_read(void *buf, uint32_t len) {
+	uint8_t *dst = (uint8_t *) buf;
+	uint32_t head, n = 0;
+
+	if (dma_rx_size == 0) {
+		return 0;
+	}
+	head = dma_rx_head();
+	while (dma_rx_tail != head && n < len) {
+		dst[n++] = dma_rx_buf[dma_rx_tail];
+		if (++dma_rx_tail == dma_rx_size) {
+			dma_rx_tail = 0;
+		}
+	}
+	return n;
+}
+
+uint32_t uart_dma_rx_idle(void) {
+	uint32_t head, idle;
+
+	if (dma_rx_size == 0) {
+		return 0;
+	}
+	head = dma_rx_head();
+	idle = (head == dma_rx_last) && (head != dma_rx_tail);
+	dma_rx_last = head;
+	return idle;
+}
+
+#if UART_COOS
+void uart_set_rx_semaphore(uint8_t sem) {
+	rx_sem = sem;
+}
+#endif
+
+void UART_Handler(void) {
+	uint32_t status = UART->UART_SR & UART->UART_IMR;
+	uint8_t chr;
+
+	if (status & UART_SR_RXRDY) {
+		// a full buffer drops the new character
+		if (ring_push(&rx_ring, (uint8_t) UART->UART_RHR)) {
+#if UART_COOS
+			if (rx_sem != UART_NO_SEM) {
+				isr_PostSem(rx_sem);
+			}
+#endif
+		}
+	}
+	if (status & UART_SR_TXRDY) {
+		if (dma_tx_state == DMA_TX_ACTIVE) {
+			// resumed by the end of the PDC transfer
+			UART->UART_IDR = UART_SR_TXRDY;
+		} else if (dma_tx_state == DMA_TX_QUEUED &&
+				tx_ring.tail == dma_tx_mark) {
+			UART->UART_IDR = UART_SR_TXRDY;
+			start_dma_tx();
+		} else if (ring_pop(&tx_ring, &chr)) {
+			UART->UART_THR = chr;
+		} else {
+			UART->UART_IDR = UART_SR_TXRDY;
+		}
+	}
+	if (status & UART_SR_ENDTX) {
+		UART->UART_IDR = UART_SR_ENDTX;
+		pdc_tx_stop(PDC_OF(UART));
+		dma_tx_state = DMA_TX_IDLE;
+		if (ring_count(&tx_ring) != 0) {
+			UART->UART_IER = UART_SR_TXRDY;
+		}
+		if (dma_tx_callback) {
+			dma_tx_callback();
+		}
+	}
+	if (status & UART_SR_ENDRX) {
+		// the finished half is the one after the half being filled now
+		if (pdc_rx_position(PDC_OF(UART)) - (uint32_t) dma_rx_buf <
+				dma_rx_size / 2) {
+			pdc_rx_next(PDC_OF(UART), dma_rx_buf + dma_rx_size / 2,
+					dma_rx_size / 2);
+		} else {
+			pdc_rx_next(PDC_OF(UART), dma_rx_buf, dma_rx_size / 2);
+		}
+	}
+}
@@ -22,16 +22,34 @@
 #define UART_H_
 
 #include <inttypes.h>
+#include "periph.h"
+#include "pmc.h"
+#include "io_req.h"
 
-// Pointer to registers of the UART peripheral.
-#define UART ((uart_reg_t *) 0x400E0800U)
+/*
+ * Size of the ring buffers used in interrupt mode. Must be a power of 2.
+ */
+#ifndef UART_TX_BUFFER_SIZE
+#define UART_TX_BUFFER_SIZE		(256)
+#endif
+#ifndef UART_RX_BUFFER_SIZE
+#define UART_RX_BUFFER_SIZE		(128)
+#endif
 
-///@cond
 /*
- * CPU Clock frequency - only for temporary usage! Should be replaced by
- * a common function!
+ * Set to 0 to build without the CoOS semaphore support, e.g. when the RTOS
+ * is not linked into the application.
  */
-#define CPU_HZ	(84000000UL)
+#ifndef UART_COOS
+#define UART_COOS				(1)
+#endif
+
+// Pointer to registers of the UART peripheral.
+#define UART ((uart_reg_t *) PERIPH_ADDR(0x400E0800U))
+
+///@cond
+// CPU Clock frequency, the master clock of the PMC
+#define CPU_HZ	((unsigned long) pmc_get_mck_freq())
 
 // UART Control Register - Reset Receiver
 #define UART_CR_RSTRX 					(1u << 2)
@@ -87,6 +105,18 @@
 #define UART_SR_RXRDY 					(1u << 0)
 // Transmitter Ready?
 #define UART_SR_TXRDY 					(1u << 1)
+// End of Receiver Transfer (PDC)
+#define UART_SR_ENDRX 					(1u << 3)
+// End of Transmitter Transfer (PDC)
+#define UART_SR_ENDTX 					(1u << 4)
+// Transmitter Empty?
+#define UART_SR_TXEMPTY 				(1u << 9)
+
+// PDC Transfer Control Register - Receiver/Transmitter Transfer Enable/Disable
+#define UART_PTCR_RXTEN					(1u << 0)
+#define UART_PTCR_RXTDIS				(1u << 1)
+#define UART_PTCR_TXTEN					(1u << 8)
+#define UART_PTCR_TXTDIS				(1u << 9)
 
 /*
  * UART Baud Rate Generator Register - Clock Divisor
@@ -119,6 +149,27 @@ typedef struct uart_reg {
 	uint32_t UART_THR;
 	// Baud Rate Generator Register, offset 0x0020
 	uint32_t UART_BRGR;
+	uint32_t reserved1[55];
+	// Receive Pointer Register, offset 0x0100
+	uint32_t UART_RPR;
+	// Receive Counter Register, offset 0x0104
+	uint32_t UART_RCR;
+	// Transmit Pointer Register, offset 0x0108
+	uint32_t UART_TPR;
+	// Transmit Counter Register, offset 0x010C
+	uint32_t UART_TCR;
+	// Receive Next Pointer Register, offset 0x0110
+	uint32_t UART_RNPR;
+	// Receive Next Counter Register, offset 0x0114
+	uint32_t UART_RNCR;
+	// Transmit Next Pointer Register, offset 0x0118
+	uint32_t UART_TNPR;
+	// Transmit Next Counter Register, offset 0x011C
+	uint32_t UART_TNCR;
+	// Transfer Control Register, offset 0x0120
+	uint32_t UART_PTCR;
+	// Transfer Status Register, offset 0x0124
+	uint32_t UART_PTSR;
 } uart_reg_t;
 
 ///@endcond
@@ -148,6 +199,7 @@ typedef struct uart_settings {
  * @pre Disable the PIO from controlling PA8 (RX-pin) and PA9 (TX-pin).
  * @pre Enable pull-up on PA8 (RX-pin) - only when reading from UART on the
  * Arduino Due!
+ * The baud rate is set up again when the clock profile of the PMC changes.
  */
 void uart_init(const uart_settings_t *settings);
 
@@ -185,4 +237,138 @@ void uart_write_str(char *str);
  */
 char uart_read_char(void);
 
+/**
+ * Switches the UART to interrupt mode. Received characters are put in a
+ * ring buffer by the interrupt handler and uart_write() only copies the
+ * characters into a ring buffer, which the interrupt handler sends.
+ * The polled functions above must not be used while the UART is in
+ * interrupt mode, since the handler is reading RHR and writing THR.
+ * @pre Initialize the UART with uart_init().
+ */
+void uart_enable_interrupt_mode(void);
+
+/**
+ * Switches the UART back to polled mode, after all buffered characters have
+ * been sent. Characters left in the receive buffer are discarded.
+ */
+void uart_disable_interrupt_mode(void);
+
+/**
+ * Puts characters in the transmit buffer, without waiting.
+ * @param buf The characters.
+ * @param len Number of characters.
+ * @return Number of characters accepted, less than len if the buffer is full.
+ * @pre Interrupt mode, see uart_enable_interrupt_mode().
+ */
+uint32_t uart_write(const void *buf, uint32_t len);
+
+/**
+ * Takes characters from the receive buffer, without waiting.
+ * @param buf Where to put the characters.
+ * @param len Maximum number of characters.
+ * @return Number of characters read, 0 if the buffer is empty.
+ * @pre Interrupt mode, see uart_enable_interrupt_mode().
+ */
+uint32_t uart_read(void *buf, uint32_t len);
+
+/**
+ * @return Number of characters in the receive buffer.
+ */
+uint32_t uart_rx_available(void);
+
+/**
+ * @return Number of characters waiting in the transmit buffer.
+ */
+uint32_t uart_tx_pending(void);
+
+/**
+ * Called from the interrupt handler when a PDC transmission is finished.
+ */
+typedef void (*uart_dma_callback_t)(void);
+
+/**
+ * Sends a buffer with the PDC, without copying it and without any CPU work
+ * per character. The buffer must not be changed until the callback has
+ * been called.
+ *
+ * This works both in polled mode and in interrupt mode. In interrupt mode
+ * the characters already in the transmit ring buffer are sent first, then
+ * the PDC transfer, then characters written with uart_write() later. That
+ * way small writes can go through the ring buffer and large ones directly
+ * from memory, in the order they were made.
+ *
+ * @param buf The characters.
+ * @param len Number of characters (1-65535).
+ * @param callback Called when done, may be 0.
+ * @return 1 if the transfer was started or queued, 0 if a transfer is
+ * already in progress or len is invalid.
+ */
+uint8_t uart_write_dma(const void *buf, uint32_t len,
+		uart_dma_callback_t callback);
+
+/**
+ * Sends a buffer with the PDC like uart_write_dma(), its completion is the
+ * request. The result of the request is 1 when the last character has been
+ * handed to the transmitter.
+ *
+ * @param buf The characters.
+ * @param len Number of characters (1-65535).
+ * @param req The request, set up with io_req_init().
+ * @return 1 if the transfer was started or queued, 0 if a transfer is
+ * already in progress, the request is busy or len is invalid.
+ */
+uint8_t uart_write_dma_req(const void *buf, uint32_t len, io_req_t *req);
+
+/**
+ * @return 1 if a PDC transmission is queued or in progress, otherwise 0.
+ */
+uint32_t uart_write_dma_busy(void);
+
+/**
+ * Starts receiving into a circular buffer with the PDC. The buffer is used
+ * as two halves and the interrupt handler chains them together, so the
+ * receiver runs without CPU work per character. The received characters are
+ * taken out with uart_dma_rx_read(). If the reader falls more than a whole
+ * buffer behind, the oldest characters are overwritten.
+ *
+ * The receiver interrupt of the interrupt mode is disabled.
+ * @param buf The buffer.
+ * @param size Size of the buffer, an even number (2-65534).
+ * @return 1 if the receiver was started, 0 if size is invalid.
+ */
+uint8_t uart_dma_rx_start(void *buf, uint32_t size);
+
+/**
+ * Stops the circular PDC receiver.
+ */
+void uart_dma_rx_stop(void);
+
+/**
+ * Takes characters received by the PDC out of the circular buffer.
+ * @param buf Where to put the characters.
+ * @param len Maximum number of characters.
+ * @return Number of characters read.
+ */
+uint32_t uart_dma_rx_read(void *buf, uint32_t len);
+
+/**
+ * Idle line detection for the circular PDC receiver. The UART has no
+ * receiver timeout, so call this periodically, e.g. from a timer, with a
+ * period longer than a character time.
+ * @return 1 if there are unread characters and nothing has been received
+ * since the previous call, i.e. a message has probably ended, otherwise 0.
+ */
+uint32_t uart_dma_rx_idle(void);
+
+#if UART_COOS
+/**
+ * Posts a CoOS semaphore (isr_PostSem()) for every received character, so a
+ * reader task can sleep on CoPendSem() instead of polling.
+ * @param sem The semaphore, created with CoCreateSem(). Give 0xFF to stop
+ * posting.
+ * @pre CFG_MAX_SERVICE_REQUEST > 0 in OsConfig.h.
+ */
+void uart_set_rx_semaphore(uint8_t sem);
+#endif
+
 #endif
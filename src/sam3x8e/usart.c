@@ -0,0 +1,501 @@
+/*
+ * usart.c
+ *
+ * Date:	14 October 2026
+ */
+
+#include "usart.h"
+#include "pdc.h"
+#include "id.h"
+#include "pmc.h"
+#if USART_COOS
+#include "rtos/CoOS.h"
+#endif
+
+///@cond
+// NVIC Interrupt Set-Enable Register 0 (peripheral ID 0-31)
+#define NVIC_ISER0		(*((volatile uint32_t *) PERIPH_ADDR(0xE000E100U)))
+
+// Master clock of the current clock profile, see pmc.h
+#define USART_MCK		((unsigned long) pmc_get_mck_freq())
+
+#define USART_NO_SEM	(0xFFu)
+
+// RTS is released when the receive ring buffer has less free space than this
+#define USART_RTS_MARGIN	(USART_RX_BUFFER_SIZE / 4)
+
+// PDC transmission states
+#define DMA_TX_IDLE		(0)
+#define DMA_TX_QUEUED	(1)
+#define DMA_TX_ACTIVE	(2)
+///@endcond
+
+/*
+ * Single producer, single consumer ring buffer. The indices are free-running
+ * and only written by one side each, so no locking is needed.
+ */
+typedef struct {
+	volatile uint32_t head;	// written by the producer
+	volatile uint32_t tail;	// written by the consumer
+} usart_ring_t;
+
+/*
+ * Driver state of one USART.
+ */
+typedef struct {
+	usart_ring_t tx_ring, rx_ring;
+	uint8_t tx_data[USART_TX_BUFFER_SIZE];
+	uint8_t rx_data[USART_RX_BUFFER_SIZE];
+	volatile uint8_t rts_released;
+	volatile uint8_t sem;
+	uint32_t baud_rate;			// of usart_init(), 0 before
+
+	volatile uint32_t dma_tx_state;
+	uint32_t dma_tx_mark;		// tx_ring.head when queued
+	const void *dma_tx_buf;
+	uint32_t dma_tx_len;
+	usart_callback_t dma_tx_callback;
+
+	uint8_t *dma_rx_buf;
+	uint32_t dma_rx_size;
+	uint32_t dma_rx_done;		// halves filled by the PDC, since start
+	uint32_t dma_rx_queued;		// halves given to the PDC, not yet filled
+	uint32_t dma_rx_read;		// characters read, since start
+	volatile uint8_t dma_rx_timeout;
+	usart_callback_t dma_rx_callback;
+} usart_state_t;
+
+static usart_state_t states[4] = {
+	[0 ... 3] = {.sem = USART_NO_SEM}
+};
+
+static uint32_t usart_index(usart_reg_t *usart) {
+	return (((uint32_t) usart) - ((uint32_t) USART0)) >> 14;
+}
+
+static uint32_t usart_irq(usart_reg_t *usart) {
+	return ID_USART0 + usart_index(usart);
+}
+
+uint32_t usart_calc_baud(uint32_t baud_rate, uint32_t *brgr) {
+	uint32_t over = 0;
+	// divisor in 1/8 steps: MCK / (16 * baud) * 8, rounded
+	uint32_t x = (USART_MCK + baud_rate) / (2 * baud_rate);
+
+	if ((x >> 3) == 0) {
+		// too fast for 16x, use 8x oversampling
+		over = 1;
+		x = (USART_MCK + baud_rate / 2) / baud_rate;
+		if ((x >> 3) == 0) {
+			x = 8;
+		}
+	}
+	if ((x >> 3) > 0xFFFFu) {
+		x = 0xFFFFu << 3;
+	}
+	*brgr = US_BRGR_CD(x >> 3) | US_BRGR_FP(x & 7);
+	return over;
+}
+
+/*
+ * Set up the baud rates of the initialized USARTs again after a change of
+ * the master clock.
+ */
+static void usart_clock_changed(uint32_t mck) {
+	usart_reg_t *usart;
+	uint32_t brgr;
+	uint32_t i;
+
+	// usart_calc_baud() takes the new clock from pmc_get_mck_freq()
+	(void) mck;
+	for (i = 0; i < 4; i++) {
+		if (states[i].baud_rate == 0) {
+			continue;
+		}
+		usart = (usart_reg_t *) (((uint32_t) USART0) + (i << 14));
+		if (usart_calc_baud(states[i].baud_rate, &brgr)) {
+			usart->US_MR |= US_MR_OVER_MASK;
+		} else {
+			usart->US_MR &= ~US_MR_OVER_MASK;
+		}
+		usart->US_BRGR = brgr;
+	}
+}
+
+uint8_t usart_init(usart_reg_t *usart, const usart_settings_t *settings) {
+	uint32_t brgr, mr;
+
+	if (settings->baud_rate == 0 || settings->data_bits < 5 ||
+		settings->data_bits > 9 || settings->parity > USART_PARITY_NO ||
+		settings->stop_bits > USART_STOP_2 ||
+		settings->mode > USART_MODE_HW_HANDSHAKING) {
+		return 0;
+	}
+	/*
+	 * reset receiver, transmitter and status bits,
+	 * disable receiver and transmitter
+	 */
+	usart->US_CR = US_CR_RSTRX_MASK | US_CR_RSTTX_MASK | US_CR_RSTSTA_MASK |
+			US_CR_RXDIS_MASK | US_CR_TXDIS_MASK;
+	usart->US_IDR = ~0u;
+	pdc_stop(PDC_OF(usart));
+
+	mr = US_MR_USART_MODE(settings->mode) | US_MR_PAR(settings->parity) |
+			US_MR_NBSTOP(settings->stop_bits) | US_MR_CHMODE(settings->ch_mode);
+	if (settings->data_bits == 9) {
+		mr |= US_MR_MODE9_MASK;
+	} else {
+		mr |= US_MR_CHRL(settings->data_bits);
+	}
+	if (usart_calc_baud(settings->baud_rate, &brgr)) {
+		mr |= US_MR_OVER_MASK;
+	}
+	usart->US_MR = mr;
+	usart->US_BRGR = brgr;
+	states[usart_index(usart)].baud_rate = settings->baud_rate;
+	pmc_add_clock_notifier(usart_clock_changed);
+
+	// enable receiver and transmitter
+	usart->US_CR = US_CR_RXEN_MASK | US_CR_TXEN_MASK;
+	return 1;
+}
+
+uint32_t usart_tx_ready(usart_reg_t *usart) {
+	return (usart->US_CSR & US_CSR_TXRDY_MASK) != 0;
+}
+
+uint32_t usart_rx_ready(usart_reg_t *usart) {
+	return (usart->US_CSR & US_CSR_RXRDY_MASK) != 0;
+}
+
+void usart_write_char(usart_reg_t *usart, uint16_t chr) {
+	usart->US_THR = chr;
+}
+
+uint16_t usart_read_char(usart_reg_t *usart) {
+	return (uint16_t) (usart->US_RHR & 0x1FFu);
+}
+
+void usart_write_str(usart_reg_t *usart, const char *str) {
+	while (*str != '\0') {
+		while (!usart_tx_ready(usart));
+		usart_write_char(usart, (uint8_t) *str);
+		str++;
+	}
+}
+
+static uint8_t software_rts(usart_reg_t *usart) {
+	return (usart->US_MR & US_MR_USART_MODE(0xF)) == USART_MODE_NORMAL;
+}
+
+void usart_enable_interrupt_mode(usart_reg_t *usart) {
+	usart_state_t *s = &states[usart_index(usart)];
+
+	s->tx_ring.head = s->tx_ring.tail = 0;
+	s->rx_ring.head = s->rx_ring.tail = 0;
+	s->rts_released = 0;
+	if (software_rts(usart)) {
+		usart->US_CR = US_CR_RTSEN_MASK;
+	}
+	// the transmitter interrupt is enabled when there is something to send
+	usart->US_IDR = US_CSR_TXRDY_MASK;
+	usart->US_IER = US_CSR_RXRDY_MASK;
+	NVIC_ISER0 = (1u << usart_irq(usart));
+}
+
+void usart_disable_interrupt_mode(usart_reg_t *usart) {
+	usart_state_t *s = &states[usart_index(usart)];
+
+	while (s->tx_ring.head != s->tx_ring.tail);
+	usart->US_IDR = US_CSR_RXRDY_MASK | US_CSR_TXRDY_MASK;
+}
+
+uint32_t usart_write(usart_reg_t *usart, const void *buf, uint32_t len) {
+	usart_state_t *s = &states[usart_index(usart)];
+	const uint8_t *src = (const uint8_t *) buf;
+	uint32_t head = s->tx_ring.head;
+	uint32_t space = USART_TX_BUFFER_SIZE - (head - s->tx_ring.tail);
+	uint32_t i;
+
+	if (len > space) {
+		len = space;
+	}
+	for (i = 0; i < len; i++) {
+		s->tx_data[(head + i) & (USART_TX_BUFFER_SIZE - 1)] = src[i];
+	}
+	s->tx_ring.head = head + len;
+	if (len > 0) {
+		usart->US_IER = US_CSR_TXRDY_MASK;
+	}
+	return len;
+}
+
+uint32_t usart_read(usart_reg_t *usart, void *buf, uint32_t len) {
+	usart_state_t *s = &states[usart_index(usart)];
+	uint8_t *dst = (uint8_t *) buf;
+	uint32_t tail = s->rx_ring.tail;
+	uint32_t available = s->rx_ring.head - tail;
+	uint32_t i;
+
+	if (len > available) {
+		len = available;
+	}
+	for (i = 0; i < len; i++) {
+		dst[i] = s->rx_data[(tail + i) & (USART_RX_BUFFER_SIZE - 1)];
+	}
+	s->rx_ring.tail = tail + len;
+
+	// let the sender continue when there is room again
+	if (s->rts_released && (available - len) < USART_RX_BUFFER_SIZE / 2) {
+		s->rts_released = 0;
+		usart->US_CR = US_CR_RTSEN_MASK;
+	}
+	return len;
+}
+
+uint32_t usart_rx_available(usart_reg_t *usart) {
+	usart_state_t *s = &states[usart_index(usart)];
+	return s->rx_ring.head - s->rx_ring.tail;
+}
+
+static void start_dma_tx(usart_reg_t *usart, usart_state_t *s) {
+	s->dma_tx_state = DMA_TX_ACTIVE;
+	pdc_tx_start(PDC_OF(usart), s->dma_tx_buf, s->dma_tx_len);
+	usart->US_IER = US_CSR_ENDTX_MASK;
+}
+
+uint8_t usart_write_dma(usart_reg_t *usart, const void *buf, uint32_t len,
+		usart_callback_t callback) {
+	usart_state_t *s = &states[usart_index(usart)];
+
+	if (s->dma_tx_state != DMA_TX_IDLE || len == 0 || len > 0xFFFFu) {
+		return 0;
+	}
+	s->dma_tx_buf = buf;
+	s->dma_tx_len = len;
+	s->dma_tx_callback = callback;
+	NVIC_ISER0 = (1u << usart_irq(usart));
+
+	if (s->tx_ring.head == s->tx_ring.tail) {
+		start_dma_tx(usart, s);
+	} else {
+		// wait for the transmitter interrupt to empty the ring buffer
+		s->dma_tx_mark = s->tx_ring.head;
+		s->dma_tx_state = DMA_TX_QUEUED;
+		usart->US_IER = US_CSR_TXRDY_MASK;
+	}
+	return 1;
+}
+
+uint32_t usart_write_dma_busy(usart_reg_t *usart) {
+	return (states[usart_index(usart)].dma_tx_state != DMA_TX_IDLE);
+}
+
+uint8_t usart_dma_rx_start(usart_reg_t *usart, void *buf, uint32_t size,
+		uint32_t timeout, usart_callback_t callback) {
+	usart_state_t *s = &states[usart_index(usart)];
+	uint32_t half = size / 2;
+
+	if (size < 2 || size > 0xFFFEu || (size & 1) || timeout > 0xFFFFu) {
+		return 0;
+	}
+	usart->US_IDR = US_CSR_RXRDY_MASK | US_CSR_ENDRX_MASK |
+			US_CSR_TIMEOUT_MASK;
+	pdc_rx_stop(PDC_OF(usart));
+	s->dma_rx_buf = (uint8_t *) buf;
+	s->dma_rx_size = size;
+	s->dma_rx_done = 0;
+	s->dma_rx_queued = 2;
+	s->dma_rx_read = 0;
+	s->dma_rx_timeout = 0;
+	s->dma_rx_callback = callback;
+
+	pdc_rx_start_ping_pong(PDC_OF(usart), s->dma_rx_buf, s->dma_rx_buf + half,
+			half);
+
+	// the timeout starts counting after the next received character
+	usart->US_RTOR = timeout;
+	if (timeout) {
+		usart->US_CR = US_CR_STTTO_MASK;
+	}
+	usart->US_IER = US_CSR_ENDRX_MASK | (timeout ? US_CSR_TIMEOUT_MASK : 0);
+	NVIC_ISER0 = (1u << usart_irq(usart));
+	return 1;
+}
+
+void usart_dma_rx_stop(usart_reg_t *usart) {
+	usart_state_t *s = &states[usart_index(usart)];
+
+	usart->US_IDR = US_CSR_ENDRX_MASK | US_CSR_TIMEOUT_MASK;
+	pdc_rx_stop(PDC_OF(usart));
+	usart->US_RTOR = 0;
+	s->dma_rx_size = 0;
+}
+
+/*
+ * Books the halves the PDC has filled and gives halves that have been read
+ * back to the PDC. Returns the number of characters filled since start.
+ * Must not be interrupted by the handler of the same USART.
+ */
+static uint32_t service_rx(usart_reg_t *usart, usart_state_t *s) {
+	uint32_t half = s->dma_rx_size / 2;
+	// RNCR before RCR: if the PDC switches halves in between, the filled
+	// count comes out too low instead of too high
+	uint32_t rncr = usart->US_RNCR;
+	uint32_t rcr = usart->US_RCR;
+	uint32_t outstanding = (rcr > 0) + (rncr > 0);
+	uint32_t filled, issued;
+
+	if (outstanding < s->dma_rx_queued) {
+		s->dma_rx_done += s->dma_rx_queued - outstanding;
+		s->dma_rx_queued = outstanding;
+	}
+	filled = s->dma_rx_done * half + (rcr > 0 ? half - rcr : 0);
+
+	while (PERIPH_REG(usart->US_RNCR) == 0 && s->dma_rx_queued < 2) {
+		issued = s->dma_rx_done + s->dma_rx_queued;
+		// the half before in the same place must have been read
+		if (issued > 0 && s->dma_rx_read < (issued - 1) * half) {
+			break;
+		}
+		pdc_rx_next(PDC_OF(usart), s->dma_rx_buf + (issued & 1) * half, half);
+		s->dma_rx_queued++;
+	}
+	return filled;
+}
+
+uint32_t usart_dma_rx_read(usart_reg_t *usart, void *buf, uint32_t len) {
+	usart_state_t *s = &states[usart_index(usart)];
+	uint8_t *dst = (uint8_t *) buf;
+	uint32_t available, index, n = 0;
+
+	if (s->dma_rx_size == 0) {
+		return 0;
+	}
+	// keep the interrupt handler away while the counters are updated
+	usart->US_IDR = US_CSR_ENDRX_MASK;
+	available = service_rx(usart, s) - s->dma_rx_read;
+	index = s->dma_rx_read % s->dma_rx_size;
+	while (n < len && n < available) {
+		dst[n++] = s->dma_rx_buf[index];
+		if (++index == s->dma_rx_size) {
+			index = 0;
+		}
+	}
+	s->dma_rx_read += n;
+	(void) service_rx(usart, s);
+	if (usart->US_RNCR != 0) {
+		usart->US_IER = US_CSR_ENDRX_MASK;
+	}
+	return n;
+}
+
+uint32_t usart_dma_rx_idle(usart_reg_t *usart) {
+	usart_state_t *s = &states[usart_index(usart)];
+	uint32_t idle = s->dma_rx_timeout;
+
+	if (!idle && (usart->US_IMR & US_CSR_TIMEOUT_MASK) == 0 &&
+		(usart->US_CSR & US_CSR_TIMEOUT_MASK)) {
+		// polled use, without interrupt
+		usart->US_CR = US_CR_STTTO_MASK;
+		idle = 1;
+	}
+	s->dma_rx_timeout = 0;
+	return idle;
+}
+
+#if USART_COOS
+void usart_set_rx_semaphore(usart_reg_t *usart, uint8_t sem) {
+	states[usart_index(usart)].sem = sem;
+}
+#endif
+
+static void usart_handler(usart_reg_t *usart, usart_state_t *s) {
+	uint32_t status = usart->US_CSR & usart->US_IMR;
+	uint32_t index;
+
+	if (status & US_CSR_RXRDY_MASK) {
+		index = s->rx_ring.head;
+		// a full buffer drops the new character
+		if (index - s->rx_ring.tail < USART_RX_BUFFER_SIZE) {
+			s->rx_data[index & (USART_RX_BUFFER_SIZE - 1)] =
+					(uint8_t) usart->US_RHR;
+			s->rx_ring.head = ++index;
+#if USART_COOS
+			if (s->sem != USART_NO_SEM) {
+				isr_PostSem(s->sem);
+			}
+#endif
+		} else {
+			(void) PERIPH_REG(usart->US_RHR);
+		}
+		if (!s->rts_released && software_rts(usart) &&
+			USART_RX_BUFFER_SIZE - (index - s->rx_ring.tail)
+				< USART_RTS_MARGIN) {
+			s->rts_released = 1;
+			usart->US_CR = US_CR_RTSDIS_MASK;
+		}
+	}
+	if (status & US_CSR_TXRDY_MASK) {
+		index = s->tx_ring.tail;
+		if (s->dma_tx_state == DMA_TX_ACTIVE) {
+			// resumed by the end of the PDC transfer
+			usart->US_IDR = US_CSR_TXRDY_MASK;
+		} else if (s->dma_tx_state == DMA_TX_QUEUED &&
+				index == s->dma_tx_mark) {
+			usart->US_IDR = US_CSR_TXRDY_MASK;
+			start_dma_tx(usart, s);
+		} else if (index != s->tx_ring.head) {
+			usart->US_THR = s->tx_data[index & (USART_TX_BUFFER_SIZE - 1)];
+			s->tx_ring.tail = index + 1;
+		} else {
+			usart->US_IDR = US_CSR_TXRDY_MASK;
+		}
+	}
+	if (status & US_CSR_ENDTX_MASK) {
+		usart->US_IDR = US_CSR_ENDTX_MASK;
+		pdc_tx_stop(PDC_OF(usart));
+		s->dma_tx_state = DMA_TX_IDLE;
+		if (s->tx_ring.head != s->tx_ring.tail) {
+			usart->US_IER = US_CSR_TXRDY_MASK;
+		}
+		if (s->dma_tx_callback) {
+			s->dma_tx_callback(usart);
+		}
+	}
+	if (status & US_CSR_ENDRX_MASK) {
+		(void) service_rx(usart, s);
+		if (usart->US_RNCR == 0) {
+			// no free half, usart_dma_rx_read() continues
+			usart->US_IDR = US_CSR_ENDRX_MASK;
+		}
+	}
+	if (status & US_CSR_TIMEOUT_MASK) {
+		usart->US_CR = US_CR_STTTO_MASK;
+		s->dma_rx_timeout = 1;
+#if USART_COOS
+		if (s->sem != USART_NO_SEM) {
+			isr_PostSem(s->sem);
+		}
+#endif
+		if (s->dma_rx_callback) {
+			s->dma_rx_callback(usart);
+		}
+	}
+}
+
+void USART0_Handler(void) {
+	usart_handler(USART0, &states[0]);
+}
+
+void USART1_Handler(void) {
+	usart_handler(USART1, &states[1]);
+}
+
+void USART2_Handler(void) {
+	usart_handler(USART2, &states[2]);
+}
+
+void USART3_Handler(void) {
+	usart_handler(USART3, &states[3]);
+}
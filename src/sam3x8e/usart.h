@@ -0,0 +1,356 @@
+/**
+ * @file usart.h
+ * @brief USART - Universal Synchronous Asynchronous Receiver Transmitter
+ * @details An API for the four USART peripherals (USART0-3) of the SAM3X8E,
+ * in asynchronous mode. Every function takes a pointer to the USART, in the
+ * same way as the SPI API.
+ *
+ * Compared to the UART the USARTs support much higher baud rates (up to
+ * MCK / 8 = 10.5 Mbaud), 5-9 data bits, RS-485 direction control, hardware
+ * handshaking (RTS/CTS) and a receiver timeout. There are three ways of
+ * moving data, like for the UART:
+ * - polled: usart_write_char(), usart_read_char() etc.
+ * - interrupt mode: non-blocking usart_write()/usart_read() with ring
+ * buffers, see usart_enable_interrupt_mode().
+ * - PDC: usart_write_dma() and usart_dma_rx_start().
+ *
+ * @pre The API does not handle its dependencies on other peripherals. The
+ * programmer must first turn on the clock of the USART in PMC and hand over
+ * its pins (TXD, RXD and if used RTS/CTS) to the peripheral with PIO.
+ * @date 14 October 2026
+ */
+
+#ifndef USART_H_
+#define USART_H_
+
+#include <inttypes.h>
+#include "periph.h"
+
+/*
+ * Size of the ring buffers of each USART in interrupt mode. Must be a power
+ * of 2.
+ */
+#ifndef USART_TX_BUFFER_SIZE
+#define USART_TX_BUFFER_SIZE	(128)
+#endif
+#ifndef USART_RX_BUFFER_SIZE
+#define USART_RX_BUFFER_SIZE	(128)
+#endif
+
+/*
+ * Set to 0 to build without the CoOS semaphore support, e.g. when the RTOS
+ * is not linked into the application.
+ */
+#ifndef USART_COOS
+#define USART_COOS				(1)
+#endif
+
+///\cond
+/**
+ * These are the base addresses for the four USART peripherals
+ */
+#define USART0				((usart_reg_t *) PERIPH_ADDR(0x40098000u))
+#define USART1				((usart_reg_t *) PERIPH_ADDR(0x4009C000u))
+#define USART2				((usart_reg_t *) PERIPH_ADDR(0x400A0000u))
+#define USART3				((usart_reg_t *) PERIPH_ADDR(0x400A4000u))
+/**
+ * USART register mapping
+ */
+typedef struct usart_reg {
+	uint32_t US_CR;			///< 0x00, Control Register
+	uint32_t US_MR;			///< 0x04, Mode Register
+	uint32_t US_IER;		///< 0x08, Interrupt Enable Register
+	uint32_t US_IDR;		///< 0x0C, Interrupt Disable Register
+	uint32_t US_IMR;		///< 0x10, Interrupt Mask Register
+	uint32_t US_CSR;		///< 0x14, Channel Status Register
+	uint32_t US_RHR;		///< 0x18, Receiver Holding Register
+	uint32_t US_THR;		///< 0x1C, Transmitter Holding Register
+	uint32_t US_BRGR;		///< 0x20, Baud Rate Generator Register
+	uint32_t US_RTOR;		///< 0x24, Receiver Time-out Register
+	uint32_t US_TTGR;		///< 0x28, Transmitter Timeguard Register
+	uint32_t reserved0[5];	///< 0x2C-0x3C, Reserved
+	uint32_t US_FIDI;		///< 0x40, FI DI Ratio Register
+	uint32_t US_NER;		///< 0x44, Number of Errors Register
+	uint32_t reserved1;		///< 0x48, Reserved
+	uint32_t US_IF;			///< 0x4C, IrDA Filter Register
+	uint32_t US_MAN;		///< 0x50, Manchester Configuration Register
+	uint32_t US_LINMR;		///< 0x54, LIN Mode Register
+	uint32_t US_LINIR;		///< 0x58, LIN Identifier Register
+	uint32_t reserved2[34];	///< 0x5C-0xE0, Reserved
+	uint32_t US_WPMR;		///< 0xE4, Write Protect Mode Register
+	uint32_t US_WPSR;		///< 0xE8, Write Protect Status Register
+	uint32_t reserved3[4];	///< 0xEC-0xF8, Reserved
+	uint32_t US_VERSION;	///< 0xFC, Version Register
+	uint32_t US_RPR;		///< 0x100, Receive Pointer Register
+	uint32_t US_RCR;		///< 0x104, Receive Counter Register
+	uint32_t US_TPR;		///< 0x108, Transmit Pointer Register
+	uint32_t US_TCR;		///< 0x10C, Transmit Counter Register
+	uint32_t US_RNPR;		///< 0x110, Receive Next Pointer Register
+	uint32_t US_RNCR;		///< 0x114, Receive Next Counter Register
+	uint32_t US_TNPR;		///< 0x118, Transmit Next Pointer Register
+	uint32_t US_TNCR;		///< 0x11C, Transmit Next Counter Register
+	uint32_t US_PTCR;		///< 0x120, Transfer Control Register
+	uint32_t US_PTSR;		///< 0x124, Transfer Status Register
+} usart_reg_t;
+
+///@{
+/**
+ * Masks for US_CR
+ */
+#define US_CR_RSTRX_MASK		(1u << 2)
+#define US_CR_RSTTX_MASK		(1u << 3)
+#define US_CR_RXEN_MASK			(1u << 4)
+#define US_CR_RXDIS_MASK		(1u << 5)
+#define US_CR_TXEN_MASK			(1u << 6)
+#define US_CR_TXDIS_MASK		(1u << 7)
+#define US_CR_RSTSTA_MASK		(1u << 8)
+#define US_CR_STTTO_MASK		(1u << 11)
+#define US_CR_RTSEN_MASK		(1u << 18)
+#define US_CR_RTSDIS_MASK		(1u << 19)
+///@}
+///@{
+/**
+ * Fields of US_MR
+ */
+#define US_MR_USART_MODE(mode)	((0xFu & (mode)) << 0)
+#define US_MR_CHRL(bits)		((0x3u & ((bits) - 5)) << 6)
+#define US_MR_PAR(parity)		((0x7u & (parity)) << 9)
+#define US_MR_NBSTOP(stop)		((0x3u & (stop)) << 12)
+#define US_MR_CHMODE(mode)		((0x3u & (mode)) << 14)
+#define US_MR_MODE9_MASK		(1u << 17)
+#define US_MR_OVER_MASK			(1u << 19)
+///@}
+///@{
+/**
+ * Masks for US_CSR, US_IER, US_IDR and US_IMR
+ */
+#define US_CSR_RXRDY_MASK		(1u << 0)
+#define US_CSR_TXRDY_MASK		(1u << 1)
+#define US_CSR_ENDRX_MASK		(1u << 3)
+#define US_CSR_ENDTX_MASK		(1u << 4)
+#define US_CSR_OVRE_MASK		(1u << 5)
+#define US_CSR_FRAME_MASK		(1u << 6)
+#define US_CSR_PARE_MASK		(1u << 7)
+#define US_CSR_TIMEOUT_MASK		(1u << 8)
+#define US_CSR_TXEMPTY_MASK		(1u << 9)
+#define US_CSR_RXBUFF_MASK		(1u << 12)
+#define US_CSR_CTS_MASK			(1u << 23)
+///@}
+///@{
+/**
+ * Fields of US_BRGR
+ */
+#define US_BRGR_CD(cd)			((0xFFFFu & (cd)) << 0)
+#define US_BRGR_FP(fp)			((0x7u & (fp)) << 16)
+///@}
+///@{
+/**
+ * Masks for US_PTCR
+ */
+#define US_PTCR_RXTEN_MASK		(1u << 0)
+#define US_PTCR_RXTDIS_MASK		(1u << 1)
+#define US_PTCR_TXTEN_MASK		(1u << 8)
+#define US_PTCR_TXTDIS_MASK		(1u << 9)
+///@}
+///\endcond
+
+///@{
+/**
+ * Operating modes, for usart_settings_t.mode
+ */
+#define USART_MODE_NORMAL			(0x0)	///< plain asynchronous
+#define USART_MODE_RS485			(0x1)	///< RTS high while sending
+#define USART_MODE_HW_HANDSHAKING	(0x2)	///< RTS/CTS flow control
+///@}
+///@{
+/**
+ * Parity, for usart_settings_t.parity
+ */
+#define USART_PARITY_EVEN			(0)
+#define USART_PARITY_ODD			(1)
+#define USART_PARITY_SPACE			(2)
+#define USART_PARITY_MARK			(3)
+#define USART_PARITY_NO				(4)
+///@}
+///@{
+/**
+ * Stop bits, for usart_settings_t.stop_bits
+ */
+#define USART_STOP_1				(0)
+#define USART_STOP_1_5				(1)
+#define USART_STOP_2				(2)
+///@}
+///@{
+/**
+ * Channel modes, for usart_settings_t.ch_mode
+ */
+#define USART_CHMODE_NORMAL			(0)
+#define USART_CHMODE_AUTOMATIC		(1)
+#define USART_CHMODE_LOCAL_LOOPBACK	(2)
+#define USART_CHMODE_REMOTE_LOOPBACK (3)
+///@}
+
+/**
+ * @typedef usart_settings_t
+ * This structure defines the input variable to be used with the
+ * usart_init() function.
+ */
+typedef struct usart_settings {
+	/**
+	 * The baud rate. Rates above MCK / 16 (5.25 Mbaud) use 8x oversampling
+	 * and the fractional divider is used to get close to the rate.
+	 */
+	uint32_t baud_rate;
+	/**
+	 * USART_MODE_NORMAL, USART_MODE_RS485 or USART_MODE_HW_HANDSHAKING.
+	 * With hardware handshaking the transmitter waits for CTS and RTS is
+	 * driven by the PDC receiver (see usart_dma_rx_start()).
+	 */
+	uint8_t mode;
+	uint8_t data_bits;		///< 5 - 9
+	uint8_t parity;			///< Use the values with prefix: USART_PARITY_
+	uint8_t stop_bits;		///< Use the values with prefix: USART_STOP_
+	uint8_t ch_mode;		///< Use the values with prefix: USART_CHMODE_
+} usart_settings_t;
+
+/**
+ * Initializes a USART in asynchronous mode and enables the receiver and
+ * the transmitter.
+ * @param usart The USART (USART0 - USART3).
+ * @param settings The settings.
+ * The baud rate is set up again when the clock profile of the PMC changes.
+ * @return error (1  = SUCCESS, 0 = FAIL, invalid setting)
+ */
+uint8_t usart_init(usart_reg_t *usart, const usart_settings_t *settings);
+
+/**
+ * Calculates the content of US_BRGR and the OVER bit for a baud rate at the
+ * current master clock.
+ * @param baud_rate The baud rate.
+ * @param brgr Where to put the value of US_BRGR.
+ * @return 1 if 8x oversampling (OVER) is needed, 0 for 16x.
+ */
+uint32_t usart_calc_baud(uint32_t baud_rate, uint32_t *brgr);
+
+/**
+ * @return 1 if a character can be sent, otherwise 0.
+ */
+uint32_t usart_tx_ready(usart_reg_t *usart);
+
+/**
+ * @return 1 if a character has been received, otherwise 0.
+ */
+uint32_t usart_rx_ready(usart_reg_t *usart);
+
+/**
+ * Sends a character (up to 9 bits).
+ * @pre Call usart_tx_ready() to check if a character can be sent.
+ */
+void usart_write_char(usart_reg_t *usart, uint16_t chr);
+
+/**
+ * Reads a character (up to 9 bits).
+ * @pre Call usart_rx_ready() to check if a character can be read.
+ */
+uint16_t usart_read_char(usart_reg_t *usart);
+
+/**
+ * Sends a string of characters, waiting for each character.
+ */
+void usart_write_str(usart_reg_t *usart, const char *str);
+
+/**
+ * Switches the USART to interrupt mode, with ring buffers in both
+ * directions. The polled functions must not be used in interrupt mode.
+ * In USART_MODE_NORMAL the RTS pin is used to stop the sender when the
+ * receive ring buffer is almost full (software flow control of RTS).
+ */
+void usart_enable_interrupt_mode(usart_reg_t *usart);
+
+/**
+ * Switches the USART back to polled mode, after the transmit buffer has
+ * been sent.
+ */
+void usart_disable_interrupt_mode(usart_reg_t *usart);
+
+/**
+ * Puts characters in the transmit buffer, without waiting.
+ * @return Number of characters accepted.
+ */
+uint32_t usart_write(usart_reg_t *usart, const void *buf, uint32_t len);
+
+/**
+ * Takes characters from the receive buffer, without waiting.
+ * @return Number of characters read.
+ */
+uint32_t usart_read(usart_reg_t *usart, void *buf, uint32_t len);
+
+/**
+ * @return Number of characters in the receive buffer.
+ */
+uint32_t usart_rx_available(usart_reg_t *usart);
+
+/**
+ * Called from the interrupt handler when a PDC transfer or a receiver
+ * timeout is done.
+ */
+typedef void (*usart_callback_t)(usart_reg_t *usart);
+
+/**
+ * Sends a buffer with the PDC. Works in the same way as uart_write_dma():
+ * in interrupt mode the ring buffer content written before is sent first.
+ * @param len Number of characters (1-65535).
+ * @param callback Called when done, may be 0.
+ * @return 1 if started or queued, 0 if busy or len is invalid.
+ */
+uint8_t usart_write_dma(usart_reg_t *usart, const void *buf, uint32_t len,
+		usart_callback_t callback);
+
+/**
+ * @return 1 if a PDC transmission is queued or in progress, otherwise 0.
+ */
+uint32_t usart_write_dma_busy(usart_reg_t *usart);
+
+/**
+ * Starts receiving into a circular buffer with the PDC, used as two
+ * halves. A half is only given back to the PDC when usart_dma_rx_read() has
+ * emptied it, so nothing is overwritten; with hardware handshaking RTS
+ * stops the sender when both halves are full.
+ * @param buf The buffer.
+ * @param size Size of the buffer, an even number (2-65534).
+ * @param timeout Receiver timeout in bit periods (1-65535) after the last
+ * character, 0 disables it.
+ * @param callback Called on a receiver timeout (idle line), may be 0.
+ * @return 1 if started, 0 if a parameter is invalid.
+ */
+uint8_t usart_dma_rx_start(usart_reg_t *usart, void *buf, uint32_t size,
+		uint32_t timeout, usart_callback_t callback);
+
+/**
+ * Stops the circular PDC receiver.
+ */
+void usart_dma_rx_stop(usart_reg_t *usart);
+
+/**
+ * Takes characters received by the PDC out of the circular buffer.
+ * @return Number of characters read.
+ */
+uint32_t usart_dma_rx_read(usart_reg_t *usart, void *buf, uint32_t len);
+
+/**
+ * @return 1 if the receiver timeout has expired since the last call, i.e.
+ * the line has been idle after a character.
+ */
+uint32_t usart_dma_rx_idle(usart_reg_t *usart);
+
+#if USART_COOS
+/**
+ * Posts a CoOS semaphore (isr_PostSem()) for every character received in
+ * interrupt mode, and for every receiver timeout in PDC mode.
+ * @param sem The semaphore, created with CoCreateSem(). Give 0xFF to stop
+ * posting.
+ */
+void usart_set_rx_semaphore(usart_reg_t *usart, uint8_t sem);
+#endif
+
+#endif /* USART_H_ */
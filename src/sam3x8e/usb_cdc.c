@@ -0,0 +1,709 @@
+/*
+ * usb_cdc.c
+ *
+ * Date:	14 October 2026
+ */
+
+#include "usb_cdc.h"
+#include "pmc.h"
+#include "id.h"
+#include "ramfunc.h"
+#include "irq.h"
+#if USB_CDC_COOS
+#include "rtos/CoOS.h"
+#endif
+
+///@cond
+// NVIC Interrupt Set-Enable Register 1 (peripheral ID 32-63)
+#define NVIC_ISER1		(*((volatile uint32_t *) PERIPH_ADDR(0xE000E104U)))
+// NVIC Interrupt Clear-Enable Register 1 (peripheral ID 32-63)
+#define NVIC_ICER1		(*((volatile uint32_t *) PERIPH_ADDR(0xE000E184U)))
+
+// UTMI PLL and USB clock of the PMC
+#define CKGR_UCKR_UPLLEN		(0x1u << 16)
+#define CKGR_UCKR_UPLLCOUNT(x)	(((x) & 0xFu) << 20)
+#define PMC_SR_LOCKU			(0x1u << 6)
+#define PMC_USB_USBS			(0x1u << 0)
+#define PMC_SCER_UOTGCLK		(0x1u << 5)
+
+// Loops to wait for the PLL lock and the UOTGHS clock
+#define USB_CDC_TIMEOUT			(1000000u)
+
+// The endpoints
+#define EP_CTRL					(0u)
+#define EP_DATA_IN				(1u)
+#define EP_DATA_OUT				(2u)
+#define EP_NOTIFY				(3u)
+// DMA channel n serves endpoint n, DEVDMA[0] is channel 1
+#define DMA_DATA_IN				(EP_DATA_IN - 1u)
+// BUFF_LENGTH is 16 bits
+#define DMA_MAX_LENGTH			(0xFFFFu)
+
+#define EP0_SIZE				(64u)
+#define EP_BULK_SIZE_HS			(512u)
+#define EP_BULK_SIZE_FS			(64u)
+#define EP_NOTIFY_SIZE			(16u)
+// EPSIZE field of DEVEPTCFG: 8 << x bytes
+#define EPSIZE_16				(1u)
+#define EPSIZE_64				(3u)
+#define EPSIZE_512				(6u)
+
+// Standard and CDC requests
+#define REQ_GET_STATUS			(0x00u)
+#define REQ_CLEAR_FEATURE		(0x01u)
+#define REQ_SET_FEATURE			(0x03u)
+#define REQ_SET_ADDRESS			(0x05u)
+#define REQ_GET_DESCRIPTOR		(0x06u)
+#define REQ_GET_CONFIGURATION	(0x08u)
+#define REQ_SET_CONFIGURATION	(0x09u)
+#define REQ_GET_INTERFACE		(0x0Au)
+#define REQ_SET_INTERFACE		(0x0Bu)
+#define REQ_SET_LINE_CODING		(0x20u)
+#define REQ_GET_LINE_CODING		(0x21u)
+#define REQ_SET_CONTROL_LINE	(0x22u)
+// bmRequestType: type and recipient
+#define REQ_TYPE_MASK			(0x60u)
+#define REQ_TYPE_STANDARD		(0x00u)
+#define REQ_TYPE_CLASS			(0x20u)
+#define REQ_RECIPIENT_MASK		(0x1Fu)
+#define REQ_RECIPIENT_ENDPOINT	(0x02u)
+
+#define DESC_DEVICE				(1u)
+#define DESC_CONFIGURATION		(2u)
+#define DESC_STRING				(3u)
+#define DESC_DEVICE_QUALIFIER	(6u)
+
+// wMaxPacketSize of the bulk endpoints in the configuration descriptor
+#define CONFIG_OUT_SIZE_OFFSET	(57u)
+#define CONFIG_IN_SIZE_OFFSET	(64u)
+
+#define LINE_CODING_SIZE		(7u)
+#define CONTROL_LINE_DTR		(0x1u)
+///@endcond
+
+/*
+ * A setup packet of the control endpoint.
+ */
+typedef struct {
+	uint8_t bmRequestType;
+	uint8_t bRequest;
+	uint16_t wValue;
+	uint16_t wIndex;
+	uint16_t wLength;
+} usb_setup_t;
+
+// State of the control endpoint
+enum ctrl_state {
+	CTRL_IDLE,
+	CTRL_DATA_IN,		// sending the data of a request
+	CTRL_STATUS_OUT,	// waiting for the status packet of the host
+	CTRL_DATA_OUT,		// waiting for the data of a request
+	CTRL_STATUS_IN		// sending the status packet
+};
+
+static const uint8_t device_desc[] = {
+	18, DESC_DEVICE, 0x00, 0x02,	// USB 2.0
+	0x02, 0x00, 0x00,				// CDC, the interfaces tell the rest
+	EP0_SIZE,
+	USB_CDC_VID & 0xFF, USB_CDC_VID >> 8, USB_CDC_PID & 0xFF, USB_CDC_PID >> 8,
+	0x00, 0x01,						// release 1.00
+	1, 2, 0,						// manufacturer, product, no serial
+	1								// configurations
+};
+
+static const uint8_t qualifier_desc[] = {
+	10, DESC_DEVICE_QUALIFIER, 0x00, 0x02, 0x02, 0x00, 0x00, EP0_SIZE, 1, 0
+};
+
+// The bulk sizes are set for the speed after each bus reset
+static uint8_t config_desc[] = {
+	9, DESC_CONFIGURATION, 67, 0, 2, 1, 0, 0x80, 50,	// bus powered, 100 mA
+	// communication interface, abstract control model
+	9, 4, 0, 0, 1, 0x02, 0x02, 0x00, 0,
+	5, 0x24, 0x00, 0x10, 0x01,		// header, CDC 1.10
+	5, 0x24, 0x01, 0x00, 1,			// call management, data interface 1
+	4, 0x24, 0x02, 0x02,			// ACM: line coding and serial state
+	5, 0x24, 0x06, 0, 1,			// union of interface 0 and 1
+	7, 5, 0x80 | EP_NOTIFY, 0x03, EP_NOTIFY_SIZE, 0, 8,
+	// data interface
+	9, 4, 1, 0, 2, 0x0A, 0x00, 0x00, 0,
+	7, 5, EP_DATA_OUT, 0x02, EP_BULK_SIZE_HS & 0xFF, EP_BULK_SIZE_HS >> 8, 0,
+	7, 5, 0x80 | EP_DATA_IN, 0x02, EP_BULK_SIZE_HS & 0xFF,
+	EP_BULK_SIZE_HS >> 8, 0
+};
+
+static const uint8_t lang_desc[] = { 4, DESC_STRING, 0x09, 0x04 };
+static const char *const strings[] = { "sam3x8e", "CDC telemetry" };
+
+static volatile enum ctrl_state ctrl_state;
+static const uint8_t *ctrl_data;
+static uint32_t ctrl_left;
+static uint8_t ctrl_zlp;
+static uint8_t ctrl_buf[EP0_SIZE];
+static uint8_t pending_address;
+static uint8_t configuration;
+static volatile uint8_t control_lines;
+// 115200 baud, 1 stop bit, no parity, 8 data bits
+static uint8_t line_coding[LINE_CODING_SIZE] = {
+	0x00, 0xC2, 0x01, 0x00, 0, 0, 8
+};
+static uint32_t bulk_size;
+
+// Single producer, single consumer ring buffers with free-running indices
+static uint8_t tx_data[USB_CDC_TX_BUFFER_SIZE];
+static uint8_t rx_data[USB_CDC_RX_BUFFER_SIZE];
+static volatile uint32_t tx_head, tx_tail, rx_head, rx_tail;
+// bytes of the transfer of the DMA channel, 0 when it is idle
+static volatile uint32_t tx_dma_len;
+static volatile uint8_t rx_sem = USB_CDC_NO_SEM;
+
+/*
+ * Starts the DMA channel of the IN endpoint on the data up to the end of the
+ * ring buffer, if it is idle. Called with the interrupts disabled.
+ */
+static void start_tx(void) {
+	uint32_t tail = tx_tail;
+	uint32_t len = tx_head - tail;
+	uint32_t index = tail & (USB_CDC_TX_BUFFER_SIZE - 1);
+	uotghs_dma_reg_t *dma = &UOTGHS->DEVDMA[DMA_DATA_IN];
+
+	if (tx_dma_len || !configuration || len == 0) {
+		return;
+	}
+	if (len > USB_CDC_TX_BUFFER_SIZE - index) {
+		len = USB_CDC_TX_BUFFER_SIZE - index;
+	}
+	if (len > DMA_MAX_LENGTH) {
+		len = DMA_MAX_LENGTH;
+	}
+	tx_dma_len = len;
+	dma->DEVDMAADDRESS = (uint32_t) &tx_data[index];
+	// the last bank is sent at the end of the buffer, even if not full
+	dma->DEVDMACONTROL = UOTGHS_DMA_BUFF_LENGTH(len) | UOTGHS_DMA_END_B_EN |
+			UOTGHS_DMA_END_BUFFIT | UOTGHS_DMA_CHANN_ENB;
+}
+
+static uint8_t configure_ep(uint32_t ep, uint32_t cfg) {
+	UOTGHS->DEVEPT |= UOTGHS_DEVEPT_EPEN(ep);
+	UOTGHS->DEVEPTCFG[ep] = cfg | UOTGHS_DEVEPTCFG_ALLOC;
+	return (UOTGHS->DEVEPTISR[ep] & UOTGHS_DEVEPTISR_CFGOK) != 0;
+}
+
+static void configure_ep0(void) {
+	(void) configure_ep(EP_CTRL, UOTGHS_DEVEPTCFG_EPSIZE(EPSIZE_64) |
+			UOTGHS_DEVEPTCFG_CTRL);
+	UOTGHS->DEVEPTIER[EP_CTRL] = UOTGHS_DEVEPTISR_RXSTPI;
+	UOTGHS->DEVIER = UOTGHS_DEVISR_PEP(EP_CTRL);
+	ctrl_state = CTRL_IDLE;
+}
+
+static void disable_data_eps(void) {
+	uint32_t ep;
+
+	UOTGHS->DEVDMA[DMA_DATA_IN].DEVDMACONTROL = 0;
+	tx_dma_len = 0;
+	for (ep = EP_DATA_IN; ep <= EP_NOTIFY; ep++) {
+		UOTGHS->DEVIDR = UOTGHS_DEVISR_PEP(ep);
+		UOTGHS->DEVEPT &= ~UOTGHS_DEVEPT_EPEN(ep);
+		UOTGHS->DEVEPTCFG[ep] = 0;
+	}
+	UOTGHS->DEVIDR = UOTGHS_DEVISR_DMA(EP_DATA_IN);
+	configuration = 0;
+	control_lines = 0;
+}
+
+/*
+ * Allocates the endpoints of the configuration, in increasing order as the
+ * DPRAM requires.
+ */
+static uint8_t configure_data_eps(void) {
+	uint32_t size = (bulk_size == EP_BULK_SIZE_HS) ? EPSIZE_512 : EPSIZE_64;
+
+	if (!configure_ep(EP_DATA_IN, UOTGHS_DEVEPTCFG_EPSIZE(size) |
+			UOTGHS_DEVEPTCFG_EPBK_2 | UOTGHS_DEVEPTCFG_EPDIR_IN |
+			UOTGHS_DEVEPTCFG_AUTOSW | UOTGHS_DEVEPTCFG_BLK) ||
+		!configure_ep(EP_DATA_OUT, UOTGHS_DEVEPTCFG_EPSIZE(size) |
+			UOTGHS_DEVEPTCFG_EPBK_2 | UOTGHS_DEVEPTCFG_BLK) ||
+		!configure_ep(EP_NOTIFY, UOTGHS_DEVEPTCFG_EPSIZE(EPSIZE_16) |
+			UOTGHS_DEVEPTCFG_EPDIR_IN | UOTGHS_DEVEPTCFG_INTRPT)) {
+		disable_data_eps();
+		return 0;
+	}
+	UOTGHS->DEVEPTIER[EP_DATA_OUT] = UOTGHS_DEVEPTISR_RXOUTI;
+	UOTGHS->DEVIER = UOTGHS_DEVISR_PEP(EP_DATA_OUT) |
+			UOTGHS_DEVISR_DMA(EP_DATA_IN);
+	return 1;
+}
+
+/*
+ * Sends the next packet of the data stage, a packet shorter than EP0_SIZE
+ * ends it.
+ */
+static void ctrl_send_packet(void) {
+	volatile uint8_t *fifo = UOTGHS_FIFO(EP_CTRL);
+	uint32_t n = (ctrl_left > EP0_SIZE) ? EP0_SIZE : ctrl_left;
+	uint32_t i, last;
+
+	for (i = 0; i < n; i++) {
+		*fifo++ = ctrl_data[i];
+	}
+	ctrl_data += n;
+	ctrl_left -= n;
+	// a full packet that ends the data may need a zero length packet after it
+	last = (ctrl_left == 0) && (n < EP0_SIZE || !ctrl_zlp);
+	if (ctrl_left == 0 && n == EP0_SIZE) {
+		ctrl_zlp = 0;
+	}
+	UOTGHS->DEVEPTICR[EP_CTRL] = UOTGHS_DEVEPTISR_TXINI;
+	if (last) {
+		// the host sends the status packet
+		ctrl_state = CTRL_STATUS_OUT;
+		UOTGHS->DEVEPTIDR[EP_CTRL] = UOTGHS_DEVEPTISR_TXINI;
+		UOTGHS->DEVEPTIER[EP_CTRL] = UOTGHS_DEVEPTISR_RXOUTI;
+	} else {
+		UOTGHS->DEVEPTIER[EP_CTRL] = UOTGHS_DEVEPTISR_TXINI;
+	}
+}
+
+static void ctrl_send(const uint8_t *data, uint32_t len, uint16_t w_length) {
+	if (len > w_length) {
+		len = w_length;
+	}
+	ctrl_data = data;
+	ctrl_left = len;
+	// a stage of whole packets that is shorter than asked for ends with a
+	// zero length packet
+	ctrl_zlp = (len < w_length) && (len % EP0_SIZE == 0);
+	ctrl_state = CTRL_DATA_IN;
+	ctrl_send_packet();
+}
+
+// Sends the zero length status packet of a request without data
+static void ctrl_send_status(void) {
+	ctrl_state = CTRL_STATUS_IN;
+	UOTGHS->DEVEPTICR[EP_CTRL] = UOTGHS_DEVEPTISR_TXINI;
+	UOTGHS->DEVEPTIER[EP_CTRL] = UOTGHS_DEVEPTISR_TXINI;
+}
+
+static void ctrl_stall(void) {
+	ctrl_state = CTRL_IDLE;
+	UOTGHS->DEVEPTIER[EP_CTRL] = UOTGHS_DEVEPTIER_STALLRQ;
+}
+
+// A string descriptor in UTF-16 from an ASCII string
+static uint32_t string_desc(const char *str) {
+	uint32_t len = 2;
+
+	while (*str && len < EP0_SIZE) {
+		ctrl_buf[len++] = (uint8_t) *str++;
+		ctrl_buf[len++] = 0;
+	}
+	ctrl_buf[0] = (uint8_t) len;
+	ctrl_buf[1] = DESC_STRING;
+	return len;
+}
+
+static void get_descriptor(const usb_setup_t *setup) {
+	uint32_t index = setup->wValue & 0xFFu;
+
+	switch (setup->wValue >> 8) {
+	case DESC_DEVICE:
+		ctrl_send(device_desc, sizeof(device_desc), setup->wLength);
+		break;
+	case DESC_CONFIGURATION:
+		ctrl_send(config_desc, sizeof(config_desc), setup->wLength);
+		break;
+	case DESC_DEVICE_QUALIFIER:
+		ctrl_send(qualifier_desc, sizeof(qualifier_desc), setup->wLength);
+		break;
+	case DESC_STRING:
+		if (index == 0) {
+			ctrl_send(lang_desc, sizeof(lang_desc), setup->wLength);
+		} else if (index <= sizeof(strings) / sizeof(strings[0])) {
+			ctrl_send(ctrl_buf, string_desc(strings[index - 1]),
+					setup->wLength);
+		} else {
+			ctrl_stall();
+		}
+		break;
+	default:
+		// other speed configurations are not described
+		ctrl_stall();
+		break;
+	}
+}
+
+static void standard_request(const usb_setup_t *setup) {
+	uint32_t ep = setup->wIndex & 0xFu;
+	uint32_t endpoint = ((setup->bmRequestType & REQ_RECIPIENT_MASK) ==
+			REQ_RECIPIENT_ENDPOINT);
+
+	switch (setup->bRequest) {
+	case REQ_GET_STATUS:
+		ctrl_buf[0] = 0;
+		ctrl_buf[1] = 0;
+		if (endpoint && ep <= EP_NOTIFY &&
+			(UOTGHS->DEVEPTIMR[ep] & UOTGHS_DEVEPTIER_STALLRQ)) {
+			ctrl_buf[0] = 1;
+		}
+		ctrl_send(ctrl_buf, 2, setup->wLength);
+		break;
+	case REQ_CLEAR_FEATURE:
+	case REQ_SET_FEATURE:
+		// only the halt of an endpoint
+		if (!endpoint || ep == EP_CTRL || ep > EP_NOTIFY) {
+			ctrl_stall();
+		} else if (setup->bRequest == REQ_SET_FEATURE) {
+			UOTGHS->DEVEPTIER[ep] = UOTGHS_DEVEPTIER_STALLRQ;
+			ctrl_send_status();
+		} else {
+			UOTGHS->DEVEPTIER[ep] = UOTGHS_DEVEPTIER_RSTDT;
+			UOTGHS->DEVEPTIDR[ep] = UOTGHS_DEVEPTIER_STALLRQ;
+			ctrl_send_status();
+		}
+		break;
+	case REQ_SET_ADDRESS:
+		// the address is taken after the status stage
+		pending_address = (uint8_t) (setup->wValue & 0x7Fu);
+		UOTGHS->DEVCTRL = (UOTGHS->DEVCTRL & ~UOTGHS_DEVCTRL_UADD(0x7Fu)) |
+				UOTGHS_DEVCTRL_UADD(pending_address);
+		ctrl_send_status();
+		break;
+	case REQ_GET_DESCRIPTOR:
+		get_descriptor(setup);
+		break;
+	case REQ_GET_CONFIGURATION:
+		ctrl_buf[0] = configuration;
+		ctrl_send(ctrl_buf, 1, setup->wLength);
+		break;
+	case REQ_SET_CONFIGURATION:
+		disable_data_eps();
+		if (setup->wValue == 1) {
+			if (!configure_data_eps()) {
+				ctrl_stall();
+				break;
+			}
+			configuration = 1;
+			start_tx();
+		} else if (setup->wValue != 0) {
+			ctrl_stall();
+			break;
+		}
+		ctrl_send_status();
+		break;
+	case REQ_GET_INTERFACE:
+		ctrl_buf[0] = 0;
+		ctrl_send(ctrl_buf, 1, setup->wLength);
+		break;
+	case REQ_SET_INTERFACE:
+		// the interfaces have no alternate settings
+		if (setup->wValue == 0) {
+			ctrl_send_status();
+		} else {
+			ctrl_stall();
+		}
+		break;
+	default:
+		ctrl_stall();
+		break;
+	}
+}
+
+static void class_request(const usb_setup_t *setup) {
+	switch (setup->bRequest) {
+	case REQ_SET_LINE_CODING:
+		ctrl_state = CTRL_DATA_OUT;
+		UOTGHS->DEVEPTIER[EP_CTRL] = UOTGHS_DEVEPTISR_RXOUTI;
+		break;
+	case REQ_GET_LINE_CODING:
+		ctrl_send(line_coding, LINE_CODING_SIZE, setup->wLength);
+		break;
+	case REQ_SET_CONTROL_LINE:
+		control_lines = (uint8_t) setup->wValue;
+		ctrl_send_status();
+		break;
+	default:
+		ctrl_stall();
+		break;
+	}
+}
+
+static void ctrl_setup(void) {
+	volatile uint8_t *fifo = UOTGHS_FIFO(EP_CTRL);
+	uint8_t raw[8];
+	usb_setup_t setup;
+	uint32_t i;
+
+	for (i = 0; i < sizeof(raw); i++) {
+		raw[i] = *fifo++;
+	}
+	UOTGHS->DEVEPTICR[EP_CTRL] = UOTGHS_DEVEPTISR_RXSTPI;
+	// a new request ends the one before
+	UOTGHS->DEVEPTIDR[EP_CTRL] = UOTGHS_DEVEPTISR_TXINI |
+			UOTGHS_DEVEPTISR_RXOUTI;
+	setup.bmRequestType = raw[0];
+	setup.bRequest = raw[1];
+	setup.wValue = (uint16_t) (raw[2] | (raw[3] << 8));
+	setup.wIndex = (uint16_t) (raw[4] | (raw[5] << 8));
+	setup.wLength = (uint16_t) (raw[6] | (raw[7] << 8));
+	pending_address = 0;
+
+	switch (setup.bmRequestType & REQ_TYPE_MASK) {
+	case REQ_TYPE_STANDARD:
+		standard_request(&setup);
+		break;
+	case REQ_TYPE_CLASS:
+		class_request(&setup);
+		break;
+	default:
+		ctrl_stall();
+		break;
+	}
+}
+
+static void ctrl_handler(void) {
+	uint32_t isr = UOTGHS->DEVEPTISR[EP_CTRL] & UOTGHS->DEVEPTIMR[EP_CTRL];
+	volatile uint8_t *fifo = UOTGHS_FIFO(EP_CTRL);
+	uint32_t i, n;
+
+	if (isr & UOTGHS_DEVEPTISR_RXSTPI) {
+		ctrl_setup();
+		return;
+	}
+	if (isr & UOTGHS_DEVEPTISR_RXOUTI) {
+		if (ctrl_state == CTRL_DATA_OUT) {
+			n = UOTGHS_DEVEPTISR_BYCT(UOTGHS->DEVEPTISR[EP_CTRL]);
+			for (i = 0; i < n && i < LINE_CODING_SIZE; i++) {
+				line_coding[i] = *fifo++;
+			}
+			UOTGHS->DEVEPTICR[EP_CTRL] = UOTGHS_DEVEPTISR_RXOUTI;
+			UOTGHS->DEVEPTIDR[EP_CTRL] = UOTGHS_DEVEPTISR_RXOUTI;
+			ctrl_send_status();
+		} else {
+			// the status packet of the host ends a request with data
+			UOTGHS->DEVEPTICR[EP_CTRL] = UOTGHS_DEVEPTISR_RXOUTI;
+			UOTGHS->DEVEPTIDR[EP_CTRL] = UOTGHS_DEVEPTISR_RXOUTI;
+			ctrl_state = CTRL_IDLE;
+		}
+	}
+	if (isr & UOTGHS_DEVEPTISR_TXINI) {
+		if (ctrl_state == CTRL_DATA_IN) {
+			ctrl_send_packet();
+		} else if (ctrl_state == CTRL_STATUS_IN) {
+			// the status packet is sent
+			UOTGHS->DEVEPTIDR[EP_CTRL] = UOTGHS_DEVEPTISR_TXINI;
+			if (pending_address) {
+				UOTGHS->DEVCTRL |= UOTGHS_DEVCTRL_ADDEN;
+				pending_address = 0;
+			}
+			ctrl_state = CTRL_IDLE;
+		} else {
+			UOTGHS->DEVEPTIDR[EP_CTRL] = UOTGHS_DEVEPTISR_TXINI;
+		}
+	}
+}
+
+/*
+ * Copies a received packet into the receive ring buffer. Without room the
+ * bank stays busy and its interrupt is disabled until usb_cdc_read() makes
+ * room, the host waits meanwhile.
+ */
+static void rx_handler(void) {
+	volatile uint8_t *fifo = UOTGHS_FIFO(EP_DATA_OUT);
+	uint32_t n = UOTGHS_DEVEPTISR_BYCT(UOTGHS->DEVEPTISR[EP_DATA_OUT]);
+	uint32_t head = rx_head;
+	uint32_t i;
+
+	if (USB_CDC_RX_BUFFER_SIZE - (head - rx_tail) < n) {
+		UOTGHS->DEVEPTIDR[EP_DATA_OUT] = UOTGHS_DEVEPTISR_RXOUTI;
+		return;
+	}
+	for (i = 0; i < n; i++) {
+		rx_data[(head + i) & (USB_CDC_RX_BUFFER_SIZE - 1)] = *fifo++;
+	}
+	rx_head = head + n;
+	UOTGHS->DEVEPTICR[EP_DATA_OUT] = UOTGHS_DEVEPTISR_RXOUTI;
+	// frees the bank for the next packet
+	UOTGHS->DEVEPTIDR[EP_DATA_OUT] = UOTGHS_DEVEPTIER_FIFOCON;
+#if USB_CDC_COOS
+	if (rx_sem != USB_CDC_NO_SEM) {
+		isr_PostSem(rx_sem);
+	}
+#endif
+}
+
+static void bus_reset(void) {
+	uint32_t size;
+
+	disable_data_eps();
+	bulk_size = ((UOTGHS->SR & UOTGHS_SR_SPEED_MASK) == UOTGHS_SR_SPEED_HIGH) ?
+			EP_BULK_SIZE_HS : EP_BULK_SIZE_FS;
+	size = bulk_size;
+	config_desc[CONFIG_OUT_SIZE_OFFSET] = (uint8_t) size;
+	config_desc[CONFIG_OUT_SIZE_OFFSET + 1] = (uint8_t) (size >> 8);
+	config_desc[CONFIG_IN_SIZE_OFFSET] = (uint8_t) size;
+	config_desc[CONFIG_IN_SIZE_OFFSET + 1] = (uint8_t) (size >> 8);
+	// the address is back to 0
+	UOTGHS->DEVCTRL &= ~(UOTGHS_DEVCTRL_ADDEN | UOTGHS_DEVCTRL_UADD(0x7Fu));
+	configure_ep0();
+}
+
+RAMFUNC_HOT void UOTGHS_Handler(void) {
+	uint32_t isr = UOTGHS->DEVISR & UOTGHS->DEVIMR;
+
+	if (isr & UOTGHS_DEVISR_EORST) {
+		UOTGHS->DEVICR = UOTGHS_DEVISR_EORST;
+		bus_reset();
+		return;
+	}
+	if (isr & UOTGHS_DEVISR_PEP(EP_CTRL)) {
+		ctrl_handler();
+	}
+	if (isr & UOTGHS_DEVISR_PEP(EP_DATA_OUT)) {
+		rx_handler();
+	}
+	if (isr & UOTGHS_DEVISR_DMA(EP_DATA_IN)) {
+		uotghs_dma_reg_t *dma = &UOTGHS->DEVDMA[DMA_DATA_IN];
+
+		// reading the status clears it
+		if (dma->DEVDMASTATUS & UOTGHS_DMA_END_BF_ST) {
+			tx_tail += tx_dma_len;
+			tx_dma_len = 0;
+			start_tx();
+		}
+	}
+}
+
+uint8_t usb_cdc_init(void) {
+	uint32_t timeout;
+
+	tx_head = tx_tail = rx_head = rx_tail = 0;
+	tx_dma_len = 0;
+	configuration = 0;
+	control_lines = 0;
+	bulk_size = EP_BULK_SIZE_FS;
+
+	// the UTMI PLL makes 480 MHz from the 12 MHz crystal
+	PMC->CKGR_UCKR = CKGR_UCKR_UPLLCOUNT(3) | CKGR_UCKR_UPLLEN;
+	timeout = USB_CDC_TIMEOUT;
+	while (!(PERIPH_REG(PMC->PMC_SR) & PMC_SR_LOCKU)) {
+		if (--timeout == 0) {
+			return 0;
+		}
+	}
+	// USB clock from the UPLL, undivided
+	PMC->PMC_USB = PMC_USB_USBS;
+	PMC->PMC_SCER = PMC_SCER_UOTGCLK;
+	pmc_acquire_peripheral_clock(ID_UOTGHS);
+
+	// device mode, whatever the ID pin tells
+	UOTGHS->CTRL = UOTGHS_CTRL_UIMOD_DEVICE | UOTGHS_CTRL_OTGPADE |
+			UOTGHS_CTRL_USBE | UOTGHS_CTRL_FRZCLK;
+	UOTGHS->CTRL &= ~UOTGHS_CTRL_FRZCLK;
+	timeout = USB_CDC_TIMEOUT;
+	while (!(PERIPH_REG(UOTGHS->SR) & UOTGHS_SR_CLKUSABLE)) {
+		if (--timeout == 0) {
+			usb_cdc_deinit();
+			return 0;
+		}
+	}
+	// high speed when the host can, the address is 0
+	UOTGHS->DEVCTRL = UOTGHS_DEVCTRL_DETACH;
+	UOTGHS->DEVICR = 0xFFFFFFFFu;
+	UOTGHS->DEVIER = UOTGHS_DEVISR_EORST;
+	NVIC_ISER1 = (0x1u << (ID_UOTGHS - 32));
+	UOTGHS->DEVCTRL &= ~UOTGHS_DEVCTRL_DETACH;
+	return 1;
+}
+
+void usb_cdc_deinit(void) {
+	NVIC_ICER1 = (0x1u << (ID_UOTGHS - 32));
+	UOTGHS->DEVCTRL |= UOTGHS_DEVCTRL_DETACH;
+	UOTGHS->DEVIDR = 0xFFFFFFFFu;
+	disable_data_eps();
+	UOTGHS->CTRL = UOTGHS_CTRL_FRZCLK;
+	pmc_release_peripheral_clock(ID_UOTGHS);
+	PMC->PMC_SCDR = PMC_SCER_UOTGCLK;
+	tx_head = tx_tail = rx_head = rx_tail = 0;
+}
+
+uint32_t usb_cdc_connected(void) {
+	return configuration && (control_lines & CONTROL_LINE_DTR);
+}
+
+uint32_t usb_cdc_high_speed(void) {
+	return bulk_size == EP_BULK_SIZE_HS;
+}
+
+uint32_t usb_cdc_write(const void *buf, uint32_t len) {
+	const uint8_t *src = (const uint8_t *) buf;
+	uint32_t head = tx_head;
+	uint32_t room = USB_CDC_TX_BUFFER_SIZE - (head - tx_tail);
+	uint32_t i, primask;
+
+	if (len > room) {
+		len = room;
+	}
+	for (i = 0; i < len; i++) {
+		tx_data[(head + i) & (USB_CDC_TX_BUFFER_SIZE - 1)] = src[i];
+	}
+	tx_head = head + len;
+	primask = irq_save();
+	start_tx();
+	irq_restore(primask);
+	return len;
+}
+
+void usb_cdc_write_str(char *str) {
+	uint32_t len = 0, done;
+
+	while (str[len]) {
+		len++;
+	}
+	while (len && usb_cdc_connected()) {
+		done = usb_cdc_write(str, len);
+		str += done;
+		len -= done;
+	}
+}
+
+int usb_cdc_putchar(int c) {
+	char chr = (char) c;
+
+	while (usb_cdc_connected() && usb_cdc_write(&chr, 1) == 0);
+	return c;
+}
+
+uint32_t usb_cdc_read(void *buf, uint32_t len) {
+	uint8_t *dst = (uint8_t *) buf;
+	uint32_t tail = rx_tail;
+	uint32_t n = rx_head - tail;
+	uint32_t i;
+
+	if (len > n) {
+		len = n;
+	}
+	for (i = 0; i < len; i++) {
+		dst[i] = rx_data[(tail + i) & (USB_CDC_RX_BUFFER_SIZE - 1)];
+	}
+	rx_tail = tail + len;
+	// a packet left in the bank for lack of room is taken now
+	if (configuration) {
+		UOTGHS->DEVEPTIER[EP_DATA_OUT] = UOTGHS_DEVEPTISR_RXOUTI;
+	}
+	return len;
+}
+
+uint32_t usb_cdc_rx_available(void) {
+	return rx_head - rx_tail;
+}
+
+uint32_t usb_cdc_tx_pending(void) {
+	return tx_head - tx_tail;
+}
+
+#if USB_CDC_COOS
+void usb_cdc_set_rx_semaphore(uint8_t sem) {
+	rx_sem = sem;
+}
+#endif
@@ -0,0 +1,288 @@
+/**
+ * @file usb_cdc.h
+ * @brief USB CDC-ACM device on the UOTGHS
+ * @details The native USB port of the Due enumerates as a virtual serial
+ * port (e.g. /dev/ttyACM0 or a COM port) at high speed, 480 Mbit/s, or full
+ * speed on a full speed host. The data interface has a bulk IN and a bulk
+ * OUT endpoint with two banks of 512 bytes each (64 at full speed), so the
+ * host can read one bank while the next one is filled.
+ *
+ * usb_cdc_write() only copies into a ring buffer, the DMA channel of the IN
+ * endpoint sends the ring buffer to the banks without the CPU and the
+ * interrupt handler starts the next part when one is done. Received data is
+ * copied from the OUT banks into a ring buffer by the interrupt handler and
+ * read with usb_cdc_read(). A full buffer leaves the bank busy, so the host
+ * waits instead of data being lost. The line coding set by the host is
+ * stored and reported back, it has no effect.
+ *
+ * The CDC port can take over the output of the UART, as a transport for the
+ * logger and the test output:
+ * @code
+ *	#define LOGGER_WRITE(str)	usb_cdc_write_str(str)
+ *	#define UNITY_OUTPUT_CHAR	usb_cdc_putchar
+ * @endcode
+ * Both drop the output while no terminal is open (DTR is not set), so they
+ * do not block without a host.
+ *
+ * @pre The master clock must run from the crystal, which the UTMI PLL
+ * (480 MHz) is derived from: pmc_init_system_clock().
+ * @pre CoOS delivery requires CFG_MAX_SERVICE_REQUEST > 0 in OsConfig.h.
+ * @date 14 October 2026
+ */
+
+#ifndef USB_CDC_H_
+#define USB_CDC_H_
+
+#include <inttypes.h>
+#include "periph.h"
+
+/*
+ * Size of the ring buffers. Must be a power of 2.
+ */
+#ifndef USB_CDC_TX_BUFFER_SIZE
+#define USB_CDC_TX_BUFFER_SIZE	(8192)
+#endif
+#ifndef USB_CDC_RX_BUFFER_SIZE
+#define USB_CDC_RX_BUFFER_SIZE	(1024)
+#endif
+
+/*
+ * Vendor and product ID of the device, the default is the CDC example of
+ * the Atmel Software Framework, which the hosts know as a serial port.
+ */
+#ifndef USB_CDC_VID
+#define USB_CDC_VID				(0x03EBu)
+#endif
+#ifndef USB_CDC_PID
+#define USB_CDC_PID				(0x2404u)
+#endif
+
+/*
+ * Set to 0 to build without the CoOS semaphore support, e.g. when the RTOS
+ * is not linked into the application.
+ */
+#ifndef USB_CDC_COOS
+#define USB_CDC_COOS			(1)
+#endif
+
+/// No semaphore is posted for received data.
+#define USB_CDC_NO_SEM			(0xFFu)
+
+///@cond
+// Pointer to registers of the UOTGHS, base address 0x400AC000
+#define UOTGHS ((uotghs_reg_t *) PERIPH_ADDR(0x400AC000U))
+
+// FIFO of an endpoint in the DPRAM, 32 KB each
+#define UOTGHS_FIFO(ep)	\
+	((volatile uint8_t *) PERIPH_ADDR(0x20180000U + ((ep) << 15)))
+
+// Device General Control Register
+#define UOTGHS_DEVCTRL_UADD(x)		((x) & 0x7Fu)
+#define UOTGHS_DEVCTRL_ADDEN		(0x1u << 7)
+#define UOTGHS_DEVCTRL_DETACH		(0x1u << 8)
+#define UOTGHS_DEVCTRL_SPDCONF_MASK	(0x3u << 10)
+
+// Device Global Interrupt Registers
+#define UOTGHS_DEVISR_SUSP			(0x1u << 0)
+#define UOTGHS_DEVISR_EORST			(0x1u << 3)
+#define UOTGHS_DEVISR_WAKEUP		(0x1u << 4)
+#define UOTGHS_DEVISR_PEP(ep)		(0x1u << (12 + (ep)))
+#define UOTGHS_DEVISR_DMA(ch)		(0x1u << (24 + (ch)))
+
+// Device Endpoint Register
+#define UOTGHS_DEVEPT_EPEN(ep)		(0x1u << (ep))
+#define UOTGHS_DEVEPT_EPRST(ep)		(0x1u << (16 + (ep)))
+
+// Device Endpoint Configuration Register
+#define UOTGHS_DEVEPTCFG_ALLOC		(0x1u << 1)
+#define UOTGHS_DEVEPTCFG_EPBK_2		(0x1u << 2)
+#define UOTGHS_DEVEPTCFG_EPSIZE(x)	(((x) & 0x7u) << 4)
+#define UOTGHS_DEVEPTCFG_EPDIR_IN	(0x1u << 8)
+#define UOTGHS_DEVEPTCFG_AUTOSW		(0x1u << 9)
+#define UOTGHS_DEVEPTCFG_CTRL		(0x0u << 11)
+#define UOTGHS_DEVEPTCFG_BLK		(0x2u << 11)
+#define UOTGHS_DEVEPTCFG_INTRPT		(0x3u << 11)
+
+// Device Endpoint Interrupt Registers, the same bits clear, set or enable
+#define UOTGHS_DEVEPTISR_TXINI		(0x1u << 0)
+#define UOTGHS_DEVEPTISR_RXOUTI		(0x1u << 1)
+#define UOTGHS_DEVEPTISR_RXSTPI		(0x1u << 2)
+#define UOTGHS_DEVEPTISR_CFGOK		(0x1u << 18)
+#define UOTGHS_DEVEPTISR_BYCT(isr)	(((isr) >> 20) & 0x7FFu)
+#define UOTGHS_DEVEPTIER_FIFOCON	(0x1u << 14)
+#define UOTGHS_DEVEPTIER_RSTDT		(0x1u << 18)
+#define UOTGHS_DEVEPTIER_STALLRQ	(0x1u << 19)
+
+// Device DMA Channel Control and Status Registers
+#define UOTGHS_DMA_CHANN_ENB		(0x1u << 0)
+#define UOTGHS_DMA_END_B_EN			(0x1u << 3)
+#define UOTGHS_DMA_END_BUFFIT		(0x1u << 5)
+#define UOTGHS_DMA_BUFF_LENGTH(x)	(((x) & 0xFFFFu) << 16)
+#define UOTGHS_DMA_END_BF_ST		(0x1u << 5)
+
+// General Control Register
+#define UOTGHS_CTRL_OTGPADE			(0x1u << 12)
+#define UOTGHS_CTRL_FRZCLK			(0x1u << 14)
+#define UOTGHS_CTRL_USBE			(0x1u << 15)
+#define UOTGHS_CTRL_UIMOD_DEVICE	(0x1u << 25)
+
+// General Status Register
+#define UOTGHS_SR_SPEED_HIGH		(0x1u << 12)
+#define UOTGHS_SR_SPEED_MASK		(0x3u << 12)
+#define UOTGHS_SR_CLKUSABLE			(0x1u << 14)
+
+/*
+ * Registers of one DMA channel of the device
+ */
+typedef struct uotghs_dma_reg {
+	// Next Descriptor Address Register, offset 0x0300 + ch * 0x10
+	uint32_t DEVDMANXTDSC;
+	// Address Register, offset 0x0304 + ch * 0x10
+	uint32_t DEVDMAADDRESS;
+	// Control Register, offset 0x0308 + ch * 0x10
+	uint32_t DEVDMACONTROL;
+	// Status Register, offset 0x030C + ch * 0x10
+	uint32_t DEVDMASTATUS;
+} uotghs_dma_reg_t;
+
+/*
+ * Mapping of the UOTGHS registers used in device mode, the host part is
+ * left out
+ * Base address: 0x400AC000
+ */
+typedef struct uotghs_reg {
+	// Device General Control Register, offset 0x0000
+	uint32_t DEVCTRL;
+	// Device Global Interrupt Status Register, offset 0x0004
+	uint32_t DEVISR;
+	// Device Global Interrupt Clear Register, offset 0x0008
+	uint32_t DEVICR;
+	// Device Global Interrupt Set Register, offset 0x000C
+	uint32_t DEVIFR;
+	// Device Global Interrupt Mask Register, offset 0x0010
+	uint32_t DEVIMR;
+	// Device Global Interrupt Disable Register, offset 0x0014
+	uint32_t DEVIDR;
+	// Device Global Interrupt Enable Register, offset 0x0018
+	uint32_t DEVIER;
+	// Device Endpoint Register, offset 0x001C
+	uint32_t DEVEPT;
+	// Device Frame Number Register, offset 0x0020
+	uint32_t DEVFNUM;
+	// reserved, offset 0x0024-0x00FC
+	uint32_t reserved1[55];
+	// Device Endpoint Configuration Registers, offset 0x0100
+	uint32_t DEVEPTCFG[10];
+	uint32_t reserved2[2];
+	// Device Endpoint Status Registers, offset 0x0130
+	uint32_t DEVEPTISR[10];
+	uint32_t reserved3[2];
+	// Device Endpoint Clear Registers, offset 0x0160
+	uint32_t DEVEPTICR[10];
+	uint32_t reserved4[2];
+	// Device Endpoint Set Registers, offset 0x0190
+	uint32_t DEVEPTIFR[10];
+	uint32_t reserved5[2];
+	// Device Endpoint Mask Registers, offset 0x01C0
+	uint32_t DEVEPTIMR[10];
+	uint32_t reserved6[2];
+	// Device Endpoint Enable Registers, offset 0x01F0
+	uint32_t DEVEPTIER[10];
+	uint32_t reserved7[2];
+	// Device Endpoint Disable Registers, offset 0x0220
+	uint32_t DEVEPTIDR[10];
+	// reserved, offset 0x0248-0x030C
+	uint32_t reserved8[50];
+	// DMA channels 1-7, offset 0x0310-0x037C
+	uotghs_dma_reg_t DEVDMA[7];
+	// reserved (host registers), offset 0x0380-0x07FC
+	uint32_t reserved9[288];
+	// General Control Register, offset 0x0800
+	uint32_t CTRL;
+	// General Status Register, offset 0x0804
+	uint32_t SR;
+	// General Status Clear Register, offset 0x0808
+	uint32_t SCR;
+	// General Status Set Register, offset 0x080C
+	uint32_t SFR;
+} uotghs_reg_t;
+///@endcond
+
+/**
+ * Starts the UTMI PLL and the UOTGHS and attaches the device to the bus.
+ * Enumeration is done by the interrupt handler, poll usb_cdc_connected() to
+ * know when a terminal is open.
+ * @return error (1 = SUCCESS, 0 = FAIL, the UOTGHS clock is not usable)
+ */
+uint8_t usb_cdc_init(void);
+
+/**
+ * Detaches the device from the bus and stops the UOTGHS. The data in the
+ * ring buffers is dropped.
+ */
+void usb_cdc_deinit(void);
+
+/**
+ * @return 1 if the host has configured the device and a terminal is open
+ * (DTR is set), otherwise 0.
+ */
+uint32_t usb_cdc_connected(void);
+
+/**
+ * @return 1 if the device runs at high speed, 0 at full speed.
+ */
+uint32_t usb_cdc_high_speed(void);
+
+/**
+ * Copies data into the transmit ring buffer and starts sending it, if the
+ * device is configured. Does not block.
+ * @param buf The data.
+ * @param len Length of the data.
+ * @return The number of bytes copied, less than len if the buffer is full.
+ */
+uint32_t usb_cdc_write(const void *buf, uint32_t len);
+
+/**
+ * Writes a string, waiting for room in the transmit buffer. The string is
+ * dropped while no terminal is open. Can be used as LOGGER_WRITE().
+ * @param str The string.
+ */
+void usb_cdc_write_str(char *str);
+
+/**
+ * Writes a character like usb_cdc_write_str(). Can be used as
+ * UNITY_OUTPUT_CHAR.
+ * @param c The character.
+ * @return The character.
+ */
+int usb_cdc_putchar(int c);
+
+/**
+ * Takes received data from the receive ring buffer.
+ * @param buf Where to put the data.
+ * @param len Room in buf.
+ * @return The number of bytes taken.
+ */
+uint32_t usb_cdc_read(void *buf, uint32_t len);
+
+/**
+ * @return The number of bytes in the receive ring buffer.
+ */
+uint32_t usb_cdc_rx_available(void);
+
+/**
+ * @return The number of bytes in the transmit ring buffer, not yet sent.
+ */
+uint32_t usb_cdc_tx_pending(void);
+
+#if USB_CDC_COOS
+/**
+ * Posts a CoOS semaphore (isr_PostSem()) for every received packet, so a
+ * reader task can sleep on CoPendSem() instead of polling.
+ * @param sem The semaphore, created with CoCreateSem(). Give USB_CDC_NO_SEM
+ * to stop posting.
+ */
+void usb_cdc_set_rx_semaphore(uint8_t sem);
+#endif
+
+#endif
@@ -13,3 +13,24 @@
 void wdt_disable(void) {
 	WDT->WDT_MR = WDT_MR_WDDIS;
 }
+
+uint8_t wdt_init(uint32_t timeout_ms, uint32_t window_ms) {
+	uint32_t wdv = (timeout_ms * WDT_COUNTS_PER_S) / 1000;
+	uint32_t wdd = (window_ms < timeout_ms) ?
+			(window_ms * WDT_COUNTS_PER_S) / 1000 : wdv;
+
+	if (timeout_ms > 16000 || wdv == 0 || wdv > 0xFFFu) {
+		return 0;
+	}
+	WDT->WDT_MR = WDT_MR_WDV(wdv) | WDT_MR_WDD(wdd) | WDT_MR_WDRSTEN |
+			WDT_MR_WDDBGHLT;
+	return 1;
+}
+
+void wdt_restart(void) {
+	WDT->WDT_CR = WDT_CR_WDRSTT;
+}
+
+uint32_t wdt_status(void) {
+	return WDT->WDT_SR;
+}
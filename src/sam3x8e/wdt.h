@@ -1,8 +1,16 @@
 /**
 * @file wdt.h
 * @brief WDT - With the Watchdog API you can configure the Watchdog Timer
-* @details Important! The API is currently very limited. There's only
-* @details a function for disabling the Watchdog at the moment.
+* @details The Watchdog Timer counts down from the timeout at 256 Hz (the
+* slow clock divided by 128) and resets the system when it reaches 0,
+* unless wdt_restart() is called before. The timeout is up to 16 seconds.
+* With a window, a restart while more than the window is left counts as an
+* error too, so a program that restarts the watchdog in a tight loop is
+* caught as well.
+* @details The Mode Register can only be written once after a reset, so
+* either wdt_init() or wdt_disable() is called, and only once. See
+* wdt_sup.h for a supervisor that restarts the watchdog only when all the
+* tasks are alive.
 *
 * @author Mathias Beckius
 * @author Felix Ruponen
@@ -15,14 +23,35 @@
 #define WDT_H
 
 #include <inttypes.h>
+#include "periph.h"
 
 // Pointer to registers of the Watchdog peripheral.
-#define WDT	 ((wdt_reg_t *) 0x400E1A50U)
+#define WDT	 ((wdt_reg_t *) PERIPH_ADDR(0x400E1A50U))
 
 ///@cond
 
 // WDT_MR: Watchdog disable
 #define WDT_MR_WDDIS (1 << 15)
+// WDT_MR: Watchdog Counter Value
+#define WDT_MR_WDV(value) ((value) & 0xFFFu)
+// WDT_MR: Watchdog Fault Interrupt Enable
+#define WDT_MR_WDFIEN (1 << 12)
+// WDT_MR: Watchdog Reset Enable
+#define WDT_MR_WDRSTEN (1 << 13)
+// WDT_MR: Watchdog Delta Value, the window
+#define WDT_MR_WDD(value) (((value) & 0xFFFu) << 16)
+// WDT_MR: Watchdog Debug Halt
+#define WDT_MR_WDDBGHLT (1 << 28)
+
+// WDT_CR: Watchdog Restart, with the key
+#define WDT_CR_WDRSTT ((0xA5u << 24) | 1u)
+
+// WDT_SR: Watchdog Underflow, Watchdog Error
+#define WDT_SR_WDUNF (1 << 0)
+#define WDT_SR_WDERR (1 << 1)
+
+// Counts of the watchdog per second
+#define WDT_COUNTS_PER_S (256u)
 
 /*
  * Mapping of WDT registers
@@ -44,4 +73,27 @@ typedef struct wdt_reg {
  */
 void wdt_disable(void);
 
+/**
+ * Starts the Watchdog Timer. It resets the system when it is not restarted
+ * within the timeout, or restarted while more than the window is left.
+ * The watchdog halts while the core is halted by a debugger.
+ * @param timeout_ms The timeout in ms, 4 ms - 16 s
+ * @param window_ms The window in ms before the timeout where restarts are
+ * allowed, at least the timeout for no window
+ * @return 1 on success, 0 if the timeout is out of range.
+ */
+uint8_t wdt_init(uint32_t timeout_ms, uint32_t window_ms);
+
+/**
+ * Restarts the Watchdog Timer from its timeout.
+ */
+void wdt_restart(void);
+
+/**
+ * Get the status of the Watchdog Timer, the bits are cleared by the read.
+ * @return WDT_SR_WDUNF if it underflowed, WDT_SR_WDERR if it was restarted
+ * outside the window, since the last read.
+ */
+uint32_t wdt_status(void);
+
 #endif
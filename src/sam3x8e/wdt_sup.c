@@ -0,0 +1,102 @@
+/*
+ * wdt_sup.c
+ *
+ * Date:	14 October 2026
+ */
+
+#include "wdt_sup.h"
+
+volatile uint8_t wdt_sup_alive[WDT_SUP_MAX_TASKS];
+
+/*
+ * Supervision of one task.
+ */
+typedef struct {
+	uint32_t deadline;	// ticks, 0 for a free slot
+	uint32_t last;		// tick of the last check-in seen
+} wdt_sup_slot_t;
+
+static wdt_sup_slot_t slots[WDT_SUP_MAX_TASKS];
+static wdt_sup_failure_t on_failure;
+
+/*
+ * Take the check-ins, a slot is late when it has not checked in for longer
+ * than its deadline.
+ *
+ * ret The first late slot, WDT_SUP_INVALID if none
+ */
+static uint8_t check_slots(uint32_t now) {
+	uint8_t late = WDT_SUP_INVALID;
+	uint8_t i;
+
+	CoSchedLock();
+	for (i = 0; i < WDT_SUP_MAX_TASKS; i++) {
+		if (slots[i].deadline == 0) {
+			continue;
+		}
+		// A check-in between the read and the clear is lost, but the one
+		// read is newer
+		if (wdt_sup_alive[i]) {
+			wdt_sup_alive[i] = 0;
+			slots[i].last = now;
+		} else if (now - slots[i].last > slots[i].deadline &&
+				late == WDT_SUP_INVALID) {
+			late = i;
+		}
+	}
+	CoSchedUnlock();
+	return late;
+}
+
+static void supervisor_task(void *pdata) {
+	uint8_t late;
+
+	(void) pdata;
+	for (;;) {
+		late = check_slots((uint32_t) CoGetOSTime());
+		if (late != WDT_SUP_INVALID) {
+			if (on_failure != 0) {
+				on_failure(late);
+			}
+			// No more restarts, the watchdog resets the system
+			for (;;) {
+				CoTickDelay(WDT_SUP_PERIOD);
+			}
+		}
+		wdt_restart();
+		CoTickDelay(WDT_SUP_PERIOD);
+	}
+}
+
+uint8_t wdt_sup_start(uint8_t prio, OS_STK *stk, uint16_t stk_size,
+		wdt_sup_failure_t failure) {
+	on_failure = failure;
+	wdt_restart();
+	return CoCreateTask(supervisor_task, 0, prio, stk, stk_size) !=
+			E_CREATE_FAIL;
+}
+
+uint8_t wdt_sup_register(uint32_t deadline) {
+	uint8_t i;
+
+	if (deadline == 0) {
+		deadline = 1;
+	}
+	CoSchedLock();
+	for (i = 0; i < WDT_SUP_MAX_TASKS; i++) {
+		if (slots[i].deadline == 0) {
+			slots[i].last = (uint32_t) CoGetOSTime();
+			slots[i].deadline = deadline;
+			wdt_sup_alive[i] = 0;
+			break;
+		}
+	}
+	CoSchedUnlock();
+	return (i < WDT_SUP_MAX_TASKS) ? i : WDT_SUP_INVALID;
+}
+
+void wdt_sup_unregister(uint8_t id) {
+	if (id < WDT_SUP_MAX_TASKS) {
+		slots[id].deadline = 0;
+	}
+}
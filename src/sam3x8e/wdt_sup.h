@@ -0,0 +1,88 @@
+/**
+ * @file wdt_sup.h
+ * @brief WDT - Task-aware watchdog supervisor
+ * @details A CoOS task that restarts the Watchdog Timer only while all the
+ * registered tasks are alive. A task registers with its deadline and then
+ * checks in with wdt_sup_checkin() at least once per deadline, which is a
+ * single store. Every WDT_SUP_PERIOD ticks the supervisor takes the check-ins
+ * and restarts the watchdog if no task has missed its deadline. Once one has,
+ * the failure callback is called and the watchdog is no longer restarted, so
+ * it resets the system.
+ *
+ * The deadlines are measured in whole periods of the supervisor, a task is
+ * late after its deadline plus at most one period. The watchdog timeout must
+ * be longer than WDT_SUP_PERIOD, and a window of wdt_init() shorter than the
+ * timeout minus WDT_SUP_PERIOD would turn the restarts into errors.
+ *
+ * @pre wdt_init() and CoInitOS(), wdt_disable() must not have been called.
+ * @date 14 October 2026
+ */
+
+#ifndef WDT_SUP_H_
+#define WDT_SUP_H_
+
+#include <inttypes.h>
+#include "wdt.h"
+#include "rtos/CoOS.h"
+
+// Number of tasks that can be registered
+#ifndef WDT_SUP_MAX_TASKS
+#define WDT_SUP_MAX_TASKS		(8)
+#endif
+
+// Period of the supervisor in CoOS ticks
+#ifndef WDT_SUP_PERIOD
+#define WDT_SUP_PERIOD			(10)
+#endif
+
+/// Returned by wdt_sup_register() when no slot is free.
+#define WDT_SUP_INVALID			(0xFFu)
+
+/**
+ * Called by the supervisor when a task missed its deadline, e.g. to log it,
+ * before the watchdog resets the system.
+ * @param id The ID of the task from wdt_sup_register().
+ */
+typedef void (*wdt_sup_failure_t)(uint8_t id);
+
+///@cond
+// Set by the tasks, cleared by the supervisor
+extern volatile uint8_t wdt_sup_alive[WDT_SUP_MAX_TASKS];
+///@endcond
+
+/**
+ * Creates the supervisor task.
+ * @param prio Priority of the supervisor, above the supervised tasks so a
+ * busy task can't hold it off.
+ * @param stk Top of the stack of the supervisor.
+ * @param stk_size Words of the stack.
+ * @param failure Called when a task missed its deadline, or 0.
+ * @return 1 on success, 0 if the task could not be created.
+ */
+uint8_t wdt_sup_start(uint8_t prio, OS_STK *stk, uint16_t stk_size,
+		wdt_sup_failure_t failure);
+
+/**
+ * Registers a task with its deadline, it counts as checked in now.
+ * @param deadline Longest time between two check-ins in CoOS ticks.
+ * @return The ID to check in with, WDT_SUP_INVALID if all the slots
+ * (WDT_SUP_MAX_TASKS) are used.
+ */
+uint8_t wdt_sup_register(uint32_t deadline);
+
+/**
+ * Removes a task from the supervision, e.g. before it is deleted.
+ * @param id The ID from wdt_sup_register().
+ */
+void wdt_sup_unregister(uint8_t id);
+
+/**
+ * Checks a task in, it is alive. Inline and a single store, so tasks at
+ * high rates can check in every cycle. May be called from interrupts.
+ * @param id The ID from wdt_sup_register().
+ */
+static inline void wdt_sup_checkin(uint8_t id) {
+	wdt_sup_alive[id] = 1;
+}
+
+#endif
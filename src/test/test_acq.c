@@ -0,0 +1,131 @@
+/*
+ * Acquisition scheduler unit tests
+ *
+ * The reads go to SPI0 in loopback (set up by the SPI tests), so the data of
+ * each record is the 0xFF sent after the address.
+ *
+ * Date:	14 October 2026
+ */
+
+#include "unity/unity.h"
+#include "sam3x8e/acq.h"
+#include "sam3x8e/delay.h"
+#include "test/test_acq.h"
+
+static uint8_t fast_data[64];
+static uint8_t slow_data[64];
+static ring_t fast_ring = RING_INIT(fast_data, sizeof(fast_data));
+static ring_t slow_ring = RING_INIT(slow_data, sizeof(slow_data));
+
+static void wait_idle(acq_t *acq) {
+	uint32_t timeout;
+
+	for (timeout = 100; !acq_idle(acq) && timeout > 0; timeout--) {
+		delay_ms(1);
+	}
+}
+
+void test_acq_add(void) {
+	acq_t acq = { 0 };
+	acq_sensor_t good = { .spi = SPI0, .device = SPI_SELECTOR_0,
+			.address = 0x8F, .address_length = 1, .length = 2, .period = 1,
+			.out = &fast_ring };
+	acq_sensor_t bad;
+
+	bad = good;
+	bad.twi = TWI0;
+	TEST_ASSERT_FALSE(acq_add(&acq, &bad, 0));
+	bad = good;
+	bad.spi = 0;
+	TEST_ASSERT_FALSE(acq_add(&acq, &bad, 0));
+	bad = good;
+	bad.address_length = 4;
+	TEST_ASSERT_FALSE(acq_add(&acq, &bad, 0));
+	bad = good;
+	bad.length = 0;
+	TEST_ASSERT_FALSE(acq_add(&acq, &bad, 0));
+	bad = good;
+	bad.length = ACQ_MAX_FRAME;
+	TEST_ASSERT_FALSE(acq_add(&acq, &bad, 0));
+	bad = good;
+	bad.period = 0;
+	TEST_ASSERT_FALSE(acq_add(&acq, &bad, 0));
+	bad = good;
+	bad.out = 0;
+	TEST_ASSERT_FALSE(acq_add(&acq, &bad, 0));
+	TEST_ASSERT_EQUAL_PTR(0, acq.sensors);
+
+	TEST_ASSERT_TRUE(acq_add(&acq, &good, 0));
+	TEST_ASSERT_EQUAL_PTR(&good, acq.sensors);
+	acq_remove(&acq, &good);
+	TEST_ASSERT_EQUAL_PTR(0, acq.sensors);
+}
+
+/*
+ * Two sensors on one bus, every tick and every third tick. Each tick waits
+ * for the reads, so none is skipped.
+ */
+void test_acq_spi_loopback(void) {
+	acq_t acq = { 0 };
+	acq_sensor_t fast = { .spi = SPI0, .device = SPI_SELECTOR_0,
+			.address = 0x80A0, .address_length = 2, .length = 3, .period = 1,
+			.out = &fast_ring };
+	acq_sensor_t slow = { .spi = SPI0, .device = SPI_SELECTOR_0,
+			.address = 0x8F, .address_length = 1, .length = 6, .period = 3,
+			.out = &slow_ring };
+	uint8_t data[6];
+	uint32_t now, time, i;
+
+	spi_set_selector_bit_length(SPI0, SPI_SELECTOR_0, SPI_BITS_8);
+	spi_set_selector_baud_rate(SPI0, SPI_SELECTOR_0, 2);
+	spi_set_selector_delay_transfers(SPI0, SPI_SELECTOR_0, 0);
+	spi_set_selector_delay_clk_start(SPI0, SPI_SELECTOR_0, 0);
+	TEST_ASSERT_TRUE(spi_queue_init(SPI0));
+	ring_reset(&fast_ring);
+	ring_reset(&slow_ring);
+	TEST_ASSERT_TRUE(acq_add(&acq, &fast, 1000));
+	TEST_ASSERT_TRUE(acq_add(&acq, &slow, 1000));
+
+	for (now = 1000; now < 1006; now++) {
+		acq_tick(&acq, now);
+		wait_idle(&acq);
+	}
+	acq_poll(&acq);
+	TEST_ASSERT_EQUAL_UINT32(6, fast.stats.samples);
+	TEST_ASSERT_EQUAL_UINT32(2, slow.stats.samples);
+	TEST_ASSERT_EQUAL_UINT32(0, fast.stats.skipped + fast.stats.errors +
+			fast.stats.dropped);
+	TEST_ASSERT_EQUAL_UINT32(0, slow.stats.skipped + slow.stats.errors +
+			slow.stats.dropped);
+
+	for (i = 0; i < 6; i++) {
+		TEST_ASSERT_TRUE(acq_read(&fast, &time, data));
+		TEST_ASSERT_EQUAL_UINT32(1000 + i, time);
+		TEST_ASSERT_EQUAL_HEX8(0xFF, data[0]);
+		TEST_ASSERT_EQUAL_HEX8(0xFF, data[2]);
+	}
+	TEST_ASSERT_FALSE(acq_read(&fast, &time, data));
+	for (i = 0; i < 2; i++) {
+		TEST_ASSERT_TRUE(acq_read(&slow, &time, data));
+		TEST_ASSERT_EQUAL_UINT32(1000 + 3 * i, time);
+		TEST_ASSERT_EQUAL_HEX8(0xFF, data[5]);
+	}
+	TEST_ASSERT_FALSE(acq_read(&slow, 0, data));
+
+	// a full ring drops the new records and keeps the old ones
+	for (now = 1006; now < 1020; now++) {
+		acq_tick(&acq, now);
+		wait_idle(&acq);
+	}
+	acq_poll(&acq);
+	TEST_ASSERT_EQUAL_UINT32(sizeof(fast_data) / ACQ_RECORD_SIZE(3),
+			fast.stats.samples - 6);
+	TEST_ASSERT_TRUE(fast.stats.dropped > 0);
+	TEST_ASSERT_TRUE(acq_read(&fast, &time, data));
+	TEST_ASSERT_EQUAL_UINT32(1006, time);
+
+	acq_remove(&acq, &fast);
+	acq_remove(&acq, &slow);
+	// back to fixed peripheral select for the other tests
+	SPI0->SPI_MR &= ~SPI_MR_PS_MASK;
+}
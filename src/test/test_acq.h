@@ -0,0 +1,13 @@
+/*
+ * Acquisition scheduler unit tests
+ *
+ * Date:	14 October 2026
+ */
+
+#ifndef TEST_ACQ_H_
+#define TEST_ACQ_H_
+
+void test_acq_add(void);
+void test_acq_spi_loopback(void);
+
+#endif /* TEST_ACQ_H_ */
@@ -7,6 +7,13 @@
 
 #include "unity/unity.h"
 #include "test/test_adc.h"
+#include "sam3x8e/pmc.h"
+#include "sam3x8e/delay.h"
+#include "sam3x8e/tc.h"
+#include "test_cycles.h"
+
+#define STREAM_HALF_SAMPLES	(256)
+#define STREAM_HALVES		(8)
 
 /*
  * Checking that an ADC channel is enabled.
@@ -87,3 +94,360 @@ void test_adc_set_resolution_12_bit(void) {
 	// Test if ADC is set as 12 bit
 	TEST_ASSERT_FALSE(ADC->ADC_MR | (0x0u << 4));
 }
+
+static volatile uint32_t stream_callbacks;
+static volatile uint32_t stream_wrong_channel;
+
+static void check_stream_half(uint16_t *samples, uint32_t count) {
+	uint32_t i;
+	for (i = 0; i < count; i++) {
+		if (ADC_SAMPLE_CHANNEL(samples[i]) != ADC_CHANNEL_7) {
+			stream_wrong_channel++;
+		}
+	}
+	stream_callbacks++;
+}
+
+/*
+ * Test continuous acquisition of channel 7 (A0 on the Arduino Due) into
+ * PDC buffers. Every half should be reported and every sample should be
+ * tagged with the channel. The sample rate is printed.
+ */
+void test_adc_stream(void) {
+	static uint16_t buffer[2 * STREAM_HALF_SAMPLES];
+	adc_settings_t settings = {
+		.startup_time = ADC_MR_SUT8,
+		.prescaler = 1
+	};
+	uint32_t i, cycles;
+
+	pmc_enable_peripheral_clock(ID_ADC);
+	adc_init(&settings);
+	adc_enable_channel(ADC_CHANNEL_7);
+
+	stream_callbacks = 0;
+	stream_wrong_channel = 0;
+	TEST_ASSERT_FALSE(adc_stream_start(buffer, 0, check_stream_half));
+	TEST_ASSERT_TRUE(adc_stream_start(buffer, STREAM_HALF_SAMPLES,
+			check_stream_half));
+	test_cycles_start();
+	for (i = 0; i < 100 && adc_stream_halves() < STREAM_HALVES; i++) {
+		delay_ms(1);
+	}
+	cycles = test_cycles_read();
+	adc_stream_stop();
+
+	TEST_ASSERT_TRUE(adc_stream_halves() >= STREAM_HALVES);
+	TEST_ASSERT_EQUAL_UINT32(adc_stream_halves(), stream_callbacks);
+	TEST_ASSERT_EQUAL_UINT32(0, stream_wrong_channel);
+	test_cycles_print_rate("adc_stream: ",
+			adc_stream_halves() * STREAM_HALF_SAMPLES, cycles, " samples/s");
+
+	adc_disable_channel(ADC_CHANNEL_7);
+	ADC->ADC_EMR = 0;
+	ADC->ADC_MR = ADC_MR_RESET;
+}
+
+/*
+ * Test conversions triggered by TIOA of TC0 channel 0 at 100 kHz. After
+ * 21 ms about 2100 samples, i.e. 8 halves, should have been streamed.
+ */
+void test_adc_timer_trigger(void) {
+	static uint16_t buffer[2 * STREAM_HALF_SAMPLES];
+	adc_settings_t settings = {
+		.startup_time = ADC_MR_SUT8,
+		.prescaler = 1,
+		.trigger = ADC_TRIGGER_TIOA0
+	};
+	uint32_t halves;
+
+	pmc_enable_peripheral_clock(ID_ADC);
+	adc_init(&settings);
+	TEST_ASSERT_EQUAL_HEX32(ADC_MR_TRGEN | (1 << ADC_MR_TRGSEL_POS),
+			ADC->ADC_MR & (ADC_MR_TRGEN | ADC_MR_TRGSEL_MASK));
+	TEST_ASSERT_EQUAL_UINT32(0, adc_set_sample_rate(ADC_TRIGGER_ADTRG, 1000));
+	adc_enable_channel(ADC_CHANNEL_7);
+
+	stream_callbacks = 0;
+	stream_wrong_channel = 0;
+	TEST_ASSERT_TRUE(adc_stream_start(buffer, STREAM_HALF_SAMPLES,
+			check_stream_half));
+	TEST_ASSERT_EQUAL_UINT32(100000,
+			adc_set_sample_rate(ADC_TRIGGER_TIOA0, 100000));
+	delay_ms(21);
+	halves = adc_stream_halves();
+	adc_stream_stop();
+	tc_disable_clock(TC0, TC_CHANNEL_0);
+
+	TEST_ASSERT_TRUE(halves >= 7 && halves <= 9);
+	TEST_ASSERT_EQUAL_UINT32(0, stream_wrong_channel);
+
+	adc_disable_channel(ADC_CHANNEL_7);
+	ADC->ADC_EMR = 0;
+	ADC->ADC_MR = ADC_MR_RESET;
+}
+
+/*
+ * Test the user sequencer with channel 7, 6 and 7 again, and a scan of it
+ * into one row per slot.
+ */
+void test_adc_sequence(void) {
+	const uint8_t channels[] = { ADC_CHANNEL_7, ADC_CHANNEL_6, ADC_CHANNEL_7 };
+	uint16_t out[3 * 4];
+	adc_settings_t settings = {
+		.startup_time = ADC_MR_SUT8,
+		.prescaler = 1
+	};
+	uint32_t i;
+
+	pmc_enable_peripheral_clock(ID_ADC);
+	adc_init(&settings);
+	TEST_ASSERT_FALSE(adc_scan(out, 4));
+	TEST_ASSERT_FALSE(adc_sequence_set(channels, 0));
+	TEST_ASSERT_FALSE(adc_sequence_set(channels, ADC_SEQUENCE_MAX + 1));
+	TEST_ASSERT_TRUE(adc_sequence_set(channels, 3));
+	TEST_ASSERT_EQUAL_HEX32(0x767, ADC->ADC_SEQR1);
+	TEST_ASSERT_EQUAL_HEX32(0, ADC->ADC_SEQR2);
+	TEST_ASSERT_EQUAL_HEX32(0x7, ADC->ADC_CHSR);
+	TEST_ASSERT_BITS_HIGH(ADC_MR_USEQ, ADC->ADC_MR);
+
+	for (i = 0; i < 3 * 4; i++) {
+		out[i] = 0xFFFF;
+	}
+	TEST_ASSERT_TRUE(adc_scan(out, 4));
+	for (i = 0; i < 3 * 4; i++) {
+		TEST_ASSERT_TRUE(out[i] <= 0xFFF);
+	}
+
+	adc_sequence_disable();
+	TEST_ASSERT_BITS_LOW(ADC_MR_USEQ, ADC->ADC_MR);
+	TEST_ASSERT_EQUAL_HEX32(0, ADC->ADC_CHSR);
+	ADC->ADC_MR = ADC_MR_RESET;
+}
+
+/*
+ * Test sorting of tagged, interleaved samples into rows.
+ */
+void test_adc_deinterleave(void) {
+	const uint16_t samples[] = {
+		0x7001, 0x6002, 0x7003,
+		0x7011, 0x6012, 0x7013
+	};
+	uint16_t out[3 * 3] = { 0 };
+
+	adc_deinterleave(samples, 2, 3, out, 3);
+	TEST_ASSERT_EQUAL_HEX16(0x001, out[0]);
+	TEST_ASSERT_EQUAL_HEX16(0x011, out[1]);
+	TEST_ASSERT_EQUAL_HEX16(0, out[2]);
+	TEST_ASSERT_EQUAL_HEX16(0x002, out[3]);
+	TEST_ASSERT_EQUAL_HEX16(0x012, out[4]);
+	TEST_ASSERT_EQUAL_HEX16(0x003, out[6]);
+	TEST_ASSERT_EQUAL_HEX16(0x013, out[7]);
+	TEST_ASSERT_EQUAL_HEX16(0, out[8]);
+}
+
+/*
+ * Test boxcar decimation of samples alternating between 1024 and 3072, with
+ * tags. The mean is mid-scale, i.e. 0 in Q15.
+ */
+void test_adc_boxcar(void) {
+	uint16_t in[64];
+	q15_t out[16];
+	uint32_t i;
+
+	for (i = 0; i < 64; i++) {
+		in[i] = 0x7000 | ((i & 1) ? 3072 : 1024);
+	}
+	TEST_ASSERT_EQUAL_UINT32(16, adc_boxcar_q15(in, 64, 2, out));
+	TEST_ASSERT_EQUAL_INT16(0, out[0]);
+	TEST_ASSERT_EQUAL_INT16(0, out[15]);
+	TEST_ASSERT_EQUAL_UINT32(1, adc_boxcar_q15(in, 33, 5, out));
+	TEST_ASSERT_EQUAL_INT16(0, out[0]);
+	TEST_ASSERT_EQUAL_UINT32(0, adc_boxcar_q15(in, 64, 17, out));
+
+	adc_to_q15(in, 5, out);
+	TEST_ASSERT_EQUAL_INT16(-16384, out[0]);
+	TEST_ASSERT_EQUAL_INT16(16384, out[1]);
+	TEST_ASSERT_EQUAL_INT16(-16384, out[4]);
+}
+
+/*
+ * Test a CIC decimator with full-scale input fed in pieces. After the
+ * stages have settled the output is the full-scale Q31 value.
+ */
+void test_adc_cic(void) {
+	adc_cic_t cic;
+	uint16_t in[64];
+	q31_t out[12];
+	uint32_t i, n = 0;
+
+	TEST_ASSERT_FALSE(adc_cic_init(&cic, 0, 2));
+	TEST_ASSERT_FALSE(adc_cic_init(&cic, 5, 2));
+	TEST_ASSERT_FALSE(adc_cic_init(&cic, 4, 6));
+	TEST_ASSERT_TRUE(adc_cic_init(&cic, 4, 5));
+	for (i = 0; i < 64; i++) {
+		in[i] = 4095;
+	}
+	n += adc_cic_q31(&cic, in, 50, out + n);
+	n += adc_cic_q31(&cic, in, 64, out + n);
+	n += adc_cic_q31(&cic, in, 64, out + n);
+	n += adc_cic_q31(&cic, in, 14, out + n);
+	TEST_ASSERT_EQUAL_UINT32(6, n);
+	TEST_ASSERT_EQUAL_INT32(2047 << 20, out[4]);
+	TEST_ASSERT_EQUAL_INT32(2047 << 20, out[5]);
+}
+
+/*
+ * Test moving averages over four Q15 values and two Q31 values.
+ */
+void test_adc_moving_average(void) {
+	adc_moving_average_t ma;
+	q15_t history15[4] = { 0 };
+	q15_t in15[7] = { 400, 400, 400, 400, 800, 800, 800 };
+	q31_t history31[2] = { 0 };
+	q31_t in31[3] = { 1 << 30, 1 << 30, -(1 << 30) };
+	uint32_t i;
+
+	TEST_ASSERT_FALSE(adc_moving_average_init(&ma, history15, 17));
+	TEST_ASSERT_TRUE(adc_moving_average_init(&ma, history15, 2));
+	adc_moving_average_q15(&ma, in15, 7, in15);
+	for (i = 0; i < 7; i++) {
+		TEST_ASSERT_EQUAL_INT16(100 * (i + 1), in15[i]);
+	}
+
+	TEST_ASSERT_TRUE(adc_moving_average_init(&ma, history31, 1));
+	adc_moving_average_q31(&ma, in31, 3, in31);
+	TEST_ASSERT_EQUAL_INT32(1 << 29, in31[0]);
+	TEST_ASSERT_EQUAL_INT32(1 << 30, in31[1]);
+	TEST_ASSERT_EQUAL_INT32(0, in31[2]);
+}
+
+/*
+ * Test a decimator fed through the stream callback, with halves that do
+ * not line up with the blocks.
+ */
+void test_adc_decimator(void) {
+	static adc_decimator_t dec;
+	static q31_t blocks[2 * 4];
+	uint16_t half[24];
+	uint32_t i;
+
+	for (i = 0; i < 24; i++) {
+		half[i] = 4095;
+	}
+	TEST_ASSERT_TRUE(adc_cic_init(&dec.cic, 1, 2));
+	TEST_ASSERT_FALSE(adc_filter_attach(&dec, blocks, 4, 1,
+			ADC_FILTER_NO_QUEUE));
+	TEST_ASSERT_TRUE(adc_filter_attach(&dec, blocks, 4, 2,
+			ADC_FILTER_NO_QUEUE));
+	// 24 samples are 6 decimated samples
+	adc_filter_stream_callback(half, 24);
+	TEST_ASSERT_EQUAL_UINT32(1, dec.published);
+	TEST_ASSERT_EQUAL_UINT32(2, dec.fill);
+	adc_filter_stream_callback(half, 24);
+	TEST_ASSERT_EQUAL_UINT32(3, dec.published);
+	TEST_ASSERT_EQUAL_UINT32(0, dec.fill);
+	TEST_ASSERT_EQUAL_INT32(2047 << 20, blocks[0]);
+	TEST_ASSERT_EQUAL_INT32(2047 << 20, blocks[7]);
+
+	adc_filter_detach();
+	adc_filter_stream_callback(half, 24);
+	TEST_ASSERT_EQUAL_UINT32(3, dec.published);
+}
+
+/*
+ * Test the comparison window on channel 7 with a window that contains every
+ * value, so the first conversion gives one event.
+ */
+void test_adc_compare_window(void) {
+	adc_settings_t settings = {
+		.startup_time = ADC_MR_SUT8,
+		.prescaler = 1
+	};
+
+	pmc_enable_peripheral_clock(ID_ADC);
+	adc_init(&settings);
+	adc_enable_channel(ADC_CHANNEL_7);
+	TEST_ASSERT_FALSE(adc_compare_start(4, ADC_CHANNEL_7, 0, 0xFFF));
+	TEST_ASSERT_FALSE(adc_compare_start(ADC_COMPARE_IN, 16, 0, 0xFFF));
+	TEST_ASSERT_FALSE(adc_compare_start(ADC_COMPARE_IN, ADC_CHANNEL_7, 0,
+			0x1000));
+	TEST_ASSERT_TRUE(adc_compare_start(ADC_COMPARE_IN, ADC_CHANNEL_7, 0,
+			0xFFF));
+	TEST_ASSERT_EQUAL_HEX32(0x0FFF0000, ADC->ADC_CWR);
+	TEST_ASSERT_EQUAL_HEX32(ADC_COMPARE_IN | (ADC_CHANNEL_7 << 4),
+			ADC->ADC_EMR & (ADC_EMR_CMPMODE_MASK | ADC_EMR_CMPSEL_MASK |
+					ADC_EMR_CMPALL));
+
+	adc_start();
+	delay_micros(100);
+	adc_start();
+	delay_micros(100);
+	TEST_ASSERT_EQUAL_UINT32(1, adc_compare_events());
+	adc_compare_arm();
+	adc_start();
+	delay_micros(100);
+	TEST_ASSERT_EQUAL_UINT32(2, adc_compare_events());
+
+	adc_compare_stop();
+	adc_disable_channel(ADC_CHANNEL_7);
+	ADC->ADC_EMR = 0;
+	ADC->ADC_CWR = 0;
+	ADC->ADC_MR = ADC_MR_RESET;
+}
+
+/*
+ * Test the timing chosen for bursts: 12 bits while it keeps up with the
+ * rate, then 10 bits, and nothing for a rate or tracking time out of reach.
+ * A conversion started from fast wake-up still completes.
+ */
+void test_adc_burst(void) {
+	adc_burst_settings_t settings = { .rate = 500000, .tracking_ns = 0,
+			.power = ADC_POWER_FAST_WAKEUP, .settling = ADC_SETTLING_5 };
+	uint32_t mr, timeout;
+
+	ADC->ADC_MR = ADC_MR_RESET;
+	TEST_ASSERT_TRUE(adc_set_burst(&settings) >= 500000);
+	TEST_ASSERT_EQUAL_UINT32(ADC_RESOLUTION_12_BIT, adc_get_resolution());
+	TEST_ASSERT_TRUE(ADC->ADC_MR & ADC_MR_SLEEP);
+	TEST_ASSERT_TRUE(ADC->ADC_MR & ADC_MR_FWUP);
+	TEST_ASSERT_EQUAL_HEX32(ADC_SETTLING_5 << ADC_MR_SETTLING_POS,
+			ADC->ADC_MR & ADC_MR_SETTLING_MASK);
+	TEST_ASSERT_EQUAL_HEX32(0, ADC->ADC_MR & ADC_MR_TRACKTIM_MASK);
+
+	settings.rate = 1100000;
+	TEST_ASSERT_TRUE(adc_set_burst(&settings) >= 1100000);
+	TEST_ASSERT_EQUAL_UINT32(ADC_RESOLUTION_10_BIT, adc_get_resolution());
+
+	// out of reach, the mode register is kept
+	mr = ADC->ADC_MR;
+	settings.rate = 2000000;
+	TEST_ASSERT_EQUAL_UINT32(0, adc_set_burst(&settings));
+	settings.rate = 1000;
+	settings.tracking_ns = 10000;
+	TEST_ASSERT_EQUAL_UINT32(0, adc_set_burst(&settings));
+	settings.tracking_ns = 0;
+	settings.power = ADC_POWER_FAST_WAKEUP + 1;
+	TEST_ASSERT_EQUAL_UINT32(0, adc_set_burst(&settings));
+	TEST_ASSERT_EQUAL_HEX32(mr, ADC->ADC_MR);
+
+	// a longer tracking time for a slow source
+	settings.power = ADC_POWER_FAST_WAKEUP;
+	settings.tracking_ns = 300;
+	TEST_ASSERT_TRUE(adc_set_burst(&settings) >= 1000);
+	TEST_ASSERT_TRUE(ADC->ADC_MR & ADC_MR_TRACKTIM_MASK);
+
+	adc_set_resolution(ADC_RESOLUTION_10_BIT);
+	adc_enable_channel(ADC_CHANNEL_7);
+	(void) ADC->ADC_LCDR;
+	adc_start();
+	for (timeout = 100; !(ADC->ADC_ISR & ADC_ISR_DRDY) && timeout > 0;
+			timeout--) {
+		delay_micros(10);
+	}
+	TEST_ASSERT_TRUE(ADC->ADC_ISR & ADC_ISR_DRDY);
+	TEST_ASSERT_TRUE((ADC->ADC_LCDR & 0xFFFu) <= 0x3FFu);
+
+	adc_disable_channel(ADC_CHANNEL_7);
+	ADC->ADC_MR = ADC_MR_RESET;
+}
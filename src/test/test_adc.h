@@ -9,9 +9,20 @@
  */
 
 #include "sam3x8e/adc.h"
+#include "sam3x8e/adc_filter.h"
 
 void test_adc_channel_enabled(void);
 void test_adc_channel_disabled(void);
 void test_adc_channel_status(void);
 void test_adc_set_resolution_12_bit(void);
 void test_adc_set_resolution_10_bit(void);
+void test_adc_stream(void);
+void test_adc_timer_trigger(void);
+void test_adc_sequence(void);
+void test_adc_deinterleave(void);
+void test_adc_boxcar(void);
+void test_adc_cic(void);
+void test_adc_moving_average(void);
+void test_adc_decimator(void);
+void test_adc_compare_window(void);
+void test_adc_burst(void);
@@ -0,0 +1,344 @@
+/*
+ * Micro-benchmark harness and benchmarks of the drivers and CoOS
+ *
+ * Date:	14 October 2026
+ */
+
+#include "unity/unity.h"
+#include "sam3x8e/pmc.h"
+#include "sam3x8e/pio.h"
+#include "sam3x8e/pio_fast.h"
+#include "sam3x8e/uart.h"
+#include "sam3x8e/dsp.h"
+#include "sam3x8e/rtos/CoOS.h"
+#include "test_cycles.h"
+#include "test_bench.h"
+
+// Toggles of the GPIO benchmarks per run
+#define BENCH_TOGGLES		(100u)
+// Characters of the UART benchmark per run
+#define BENCH_UART_CHARS	(16u)
+// Priority of the helper task of the context switch benchmark
+#define BENCH_HELPER_PRIO	(9)
+#define BENCH_HELPER_STK	(128)
+// Samples of a block of the DSP benchmarks, taps of their FIR filters
+#define BENCH_DSP_BLOCK		(256u)
+#define BENCH_DSP_TAPS		(32u)
+
+static void empty_run(void *arg) {
+	(void) arg;
+	__asm volatile ("" ::: "memory");
+}
+
+// Cycles of timing one run of an empty function
+static uint32_t run_overhead(void) {
+	uint32_t i, start, cycles, overhead = 0xFFFFFFFFu;
+
+	for (i = 0; i < 8; i++) {
+		start = test_cycles_read();
+		empty_run(0);
+		cycles = test_cycles_read() - start;
+		if (cycles < overhead) {
+			overhead = cycles;
+		}
+	}
+	return overhead;
+}
+
+void bench_run(bench_fn_t fn, void *arg, uint32_t runs,
+		bench_result_t *result) {
+	uint32_t samples[BENCH_MAX_RUNS];
+	uint32_t i, j, start, cycles, overhead;
+
+	if (runs > BENCH_MAX_RUNS) {
+		runs = BENCH_MAX_RUNS;
+	}
+	if (runs == 0) {
+		runs = 1;
+	}
+	test_cycles_start();
+	overhead = run_overhead();
+	for (i = 0; i < runs; i++) {
+		start = test_cycles_read();
+		fn(arg);
+		cycles = test_cycles_read() - start;
+		cycles = (cycles > overhead) ? cycles - overhead : 0;
+		// insertion sort, the runs are few
+		for (j = i; j > 0 && samples[j - 1] > cycles; j--) {
+			samples[j] = samples[j - 1];
+		}
+		samples[j] = cycles;
+	}
+	result->min = samples[0];
+	result->median = samples[runs / 2];
+	result->max = samples[runs - 1];
+}
+
+void bench_print(const char *name, uint32_t ops, uint32_t runs,
+		const bench_result_t *result) {
+	UnityPrint("BENCH,");
+	UnityPrint(name);
+	UnityPrint(",");
+	UnityPrintNumberUnsigned(ops);
+	UnityPrint(",");
+	UnityPrintNumberUnsigned(runs);
+	UnityPrint(",");
+	UnityPrintNumberUnsigned(result->min);
+	UnityPrint(",");
+	UnityPrintNumberUnsigned(result->median);
+	UnityPrint(",");
+	UnityPrintNumberUnsigned(result->max);
+	UnityPrint("\n\r");
+}
+
+void bench_print_histogram(const char *name, uint32_t width,
+		const uint32_t *buckets, uint32_t count) {
+	uint32_t i;
+
+	UnityPrint("HIST,");
+	UnityPrint(name);
+	UnityPrint(",");
+	UnityPrintNumberUnsigned(width);
+	for (i = 0; i < count; i++) {
+		UnityPrint(",");
+		UnityPrintNumberUnsigned(buckets[i]);
+	}
+	UnityPrint("\n\r");
+}
+
+/*
+ * GPIO: the LED pin (PB27) toggled with pio_set_pin() and pio_fast_toggle().
+ */
+static void toggle_pio(void *arg) {
+	uint32_t i;
+
+	(void) arg;
+	for (i = 0; i < BENCH_TOGGLES / 2; i++) {
+		pio_set_pin(PIOB, 27, 1);
+		pio_set_pin(PIOB, 27, 0);
+	}
+}
+
+static void toggle_fast(void *arg) {
+	const pio_fast_pin_t led = PIO_FAST_PIN(PIOB, 27);
+	uint32_t i;
+
+	(void) arg;
+	for (i = 0; i < BENCH_TOGGLES; i++) {
+		pio_fast_toggle(led);
+	}
+}
+
+void test_bench_gpio_toggle(void) {
+	bench_result_t pio, fast;
+
+	pmc_acquire_peripheral_clock(ID_PIOB);
+	pio_conf_pin(PIOB, 27, 0, 0);
+	bench_run(toggle_pio, 0, BENCH_MAX_RUNS, &pio);
+	bench_run(toggle_fast, 0, BENCH_MAX_RUNS, &fast);
+	pio_set_pin(PIOB, 27, 0);
+	pmc_release_peripheral_clock(ID_PIOB);
+
+	bench_print("pio_set_pin", BENCH_TOGGLES, BENCH_MAX_RUNS, &pio);
+	bench_print("pio_fast_toggle", BENCH_TOGGLES, BENCH_MAX_RUNS, &fast);
+	TEST_ASSERT_TRUE(fast.median <= pio.median);
+}
+
+/*
+ * UART: characters sent and received in local loopback mode at 115200 baud.
+ */
+static void uart_loopback(void *arg) {
+	uint32_t *errors = (uint32_t *) arg;
+	uint32_t i;
+
+	for (i = 0; i < BENCH_UART_CHARS; i++) {
+		while (!uart_tx_ready());
+		uart_write_char((char) ('A' + i));
+		while (!uart_rx_ready());
+		if (uart_read_char() != (char) ('A' + i)) {
+			(*errors)++;
+		}
+	}
+}
+
+void test_bench_uart_loopback(void) {
+	uart_settings_t settings = {
+		.baud_rate = 115200,
+		.parity = UART_PARITY_NO,
+		.ch_mode = UART_CHMODE_LOCAL_LOOPBACK
+	};
+	bench_result_t result;
+	uint32_t errors = 0;
+
+	// let Unity's output go out before the loopback
+	while (!(PERIPH_REG(UART->UART_SR) & UART_SR_TXEMPTY));
+	uart_init(&settings);
+	bench_run(uart_loopback, &errors, 8, &result);
+	// back to Normal Mode, otherwise Unity won't work
+	settings.ch_mode = UART_CHMODE_NORMAL;
+	uart_init(&settings);
+
+	bench_print("uart_loopback", BENCH_UART_CHARS, 8, &result);
+	TEST_ASSERT_EQUAL_UINT32(0, errors);
+}
+
+/*
+ * DSP: the kernels on a block of BENCH_DSP_BLOCK samples, the ops of a
+ * BENCH line are samples, so the median divided by them is the cycles per
+ * sample (per point for the FFT).
+ */
+static struct {
+	dsp_fir_q15_t fir;
+	dsp_fir_q31_t fir31;
+	dsp_biquad_q15_t bq;
+	dsp_biquad_q31_t bq31;
+	q15_t block[2 * BENCH_DSP_BLOCK];
+	q31_t block31[BENCH_DSP_BLOCK];
+} dsp;
+
+static void fir_q15(void *arg) {
+	(void) arg;
+	dsp_fir_q15(&dsp.fir, dsp.block, dsp.block, BENCH_DSP_BLOCK);
+}
+
+static void fir_q31(void *arg) {
+	(void) arg;
+	dsp_fir_q31(&dsp.fir31, dsp.block31, dsp.block31, BENCH_DSP_BLOCK);
+}
+
+static void biquad_q15(void *arg) {
+	(void) arg;
+	dsp_biquad_q15(&dsp.bq, dsp.block, dsp.block, BENCH_DSP_BLOCK);
+}
+
+static void biquad_q31(void *arg) {
+	(void) arg;
+	dsp_biquad_q31(&dsp.bq31, dsp.block31, dsp.block31, BENCH_DSP_BLOCK);
+}
+
+static void fft_q15(void *arg) {
+	(void) arg;
+	(void) dsp_fft_q15(dsp.block, BENCH_DSP_BLOCK, 0);
+}
+
+static void rms_q15(void *arg) {
+	*(q15_t *) arg = dsp_rms_q15(dsp.block, BENCH_DSP_BLOCK);
+}
+
+void test_bench_dsp(void) {
+	static q15_t coeffs[BENCH_DSP_TAPS];
+	static q31_t coeffs31[BENCH_DSP_TAPS];
+	static q15_t state[BENCH_DSP_TAPS - 1 + BENCH_DSP_BLOCK];
+	static q31_t state31[BENCH_DSP_TAPS - 1 + BENCH_DSP_BLOCK];
+	// two low-pass sections, coefficients halved
+	static const q15_t bq_coeffs[10] = {
+		41, 82, 41, 29491, -13271, 41, 82, 41, 29491, -13271
+	};
+	static const q31_t bq_coeffs31[10] = {
+		2684355, 5368709, 2684355, 1932735283, -869730877,
+		2684355, 5368709, 2684355, 1932735283, -869730877
+	};
+	q15_t bq_state[8], rms = 0;
+	q31_t bq_state31[8];
+	bench_result_t result;
+	uint32_t i;
+
+	for (i = 0; i < BENCH_DSP_TAPS; i++) {
+		coeffs[i] = (q15_t) (0x7FFF / BENCH_DSP_TAPS);
+		coeffs31[i] = (q31_t) (0x7FFFFFFF / BENCH_DSP_TAPS);
+	}
+	for (i = 0; i < 2 * BENCH_DSP_BLOCK; i++) {
+		dsp.block[i] = (q15_t) ((i * 2654435761u) >> 17);
+	}
+	for (i = 0; i < BENCH_DSP_BLOCK; i++) {
+		dsp.block31[i] = (q31_t) (i * 2654435761u) >> 1;
+	}
+	TEST_ASSERT_TRUE(dsp_fir_q15_init(&dsp.fir, coeffs, BENCH_DSP_TAPS, state,
+			BENCH_DSP_BLOCK));
+	TEST_ASSERT_TRUE(dsp_fir_q31_init(&dsp.fir31, coeffs31, BENCH_DSP_TAPS,
+			state31, BENCH_DSP_BLOCK));
+	TEST_ASSERT_TRUE(dsp_biquad_q15_init(&dsp.bq, 2, bq_coeffs, bq_state, 1));
+	TEST_ASSERT_TRUE(dsp_biquad_q31_init(&dsp.bq31, 2, bq_coeffs31,
+			bq_state31, 1));
+
+	bench_run(fir_q15, 0, 8, &result);
+	bench_print("dsp_fir_q15_32", BENCH_DSP_BLOCK, 8, &result);
+	bench_run(fir_q31, 0, 8, &result);
+	bench_print("dsp_fir_q31_32", BENCH_DSP_BLOCK, 8, &result);
+	bench_run(biquad_q15, 0, 8, &result);
+	bench_print("dsp_biquad_q15_2", BENCH_DSP_BLOCK, 8, &result);
+	bench_run(biquad_q31, 0, 8, &result);
+	bench_print("dsp_biquad_q31_2", BENCH_DSP_BLOCK, 8, &result);
+	bench_run(fft_q15, 0, 8, &result);
+	bench_print("dsp_fft_q15_256", BENCH_DSP_BLOCK, 8, &result);
+	bench_run(rms_q15, &rms, 8, &result);
+	bench_print("dsp_rms_q15", BENCH_DSP_BLOCK, 8, &result);
+	// the spectrum of the block is not silent
+	TEST_ASSERT_TRUE(rms > 0);
+}
+
+/*
+ * CoOS: context switches, semaphores, queues and the kernel heap.
+ */
+static OS_EventID helper_sem;
+static OS_STK helper_stk[BENCH_HELPER_STK];
+
+// Waits on the semaphore again at once, each post switches in and out
+static void helper_task(void *pdata) {
+	(void) pdata;
+	for (;;) {
+		CoPendSem(helper_sem, 0);
+	}
+}
+
+static void context_switch(void *arg) {
+	(void) arg;
+	CoPostSem(helper_sem);
+}
+
+static void sem_post_pend(void *arg) {
+	OS_EventID sem = *(OS_EventID *) arg;
+
+	CoPostSem(sem);
+	CoPendSem(sem, 0);
+}
+
+static void queue_post_pend(void *arg) {
+	OS_EventID queue = *(OS_EventID *) arg;
+	StatusType err;
+
+	CoPostQueueMail(queue, arg);
+	(void) CoPendQueueMail(queue, 0, &err);
+}
+
+static void kmalloc_free(void *arg) {
+	(void) arg;
+	CoKfree(CoKmalloc(32));
+}
+
+void test_bench_coos(void) {
+	static void *queue_buf[4];
+	bench_result_t result;
+	OS_EventID sem, queue;
+
+	helper_sem = CoCreateSem(0, 1, EVENT_SORT_TYPE_FIFO);
+	sem = CoCreateSem(0, 1, EVENT_SORT_TYPE_FIFO);
+	queue = CoCreateQueue(queue_buf, 4, EVENT_SORT_TYPE_FIFO);
+	if (helper_sem == E_CREATE_FAIL || sem == E_CREATE_FAIL ||
+		queue == E_CREATE_FAIL) {
+		UnityPrint("BENCH objects not created\n\r");
+		return;
+	}
+	CoCreateTask(helper_task, 0, BENCH_HELPER_PRIO,
+			&helper_stk[BENCH_HELPER_STK - 1], BENCH_HELPER_STK);
+
+	// a post that wakes a higher priority task: two context switches
+	bench_run(context_switch, 0, BENCH_MAX_RUNS, &result);
+	bench_print("coos_context_switch", 2, BENCH_MAX_RUNS, &result);
+	bench_run(sem_post_pend, &sem, BENCH_MAX_RUNS, &result);
+	bench_print("coos_sem_post_pend", 1, BENCH_MAX_RUNS, &result);
+	bench_run(queue_post_pend, &queue, BENCH_MAX_RUNS, &result);
+	bench_print("coos_queue_post_pend", 1, BENCH_MAX_RUNS, &result);
+	bench_run(kmalloc_free, 0, BENCH_MAX_RUNS, &result);
+	bench_print("coos_kmalloc_free", 1, BENCH_MAX_RUNS, &result);
+}
@@ -0,0 +1,60 @@
+/*
+ * Micro-benchmark harness
+ *
+ * Times a function over a number of runs with the DWT cycle counter and
+ * prints the minimum, median and maximum cycles of one run, one line per
+ * benchmark that a script can compare with an earlier run:
+ *
+ *		BENCH,<name>,<ops per run>,<runs>,<min>,<median>,<max>
+ *
+ * Distributions follow their BENCH line as a histogram, the count of each
+ * bucket of width cycles from 0 on:
+ *
+ *		HIST,<name>,<width>,<count>,<count>,...
+ *
+ * The cycles of an empty run are subtracted. Interrupts stay enabled, the
+ * median hides the runs they hit.
+ *
+ * Date:	14 October 2026
+ */
+
+#ifndef TEST_BENCH_H_
+#define TEST_BENCH_H_
+
+#include <inttypes.h>
+
+// Most runs of one benchmark
+#define BENCH_MAX_RUNS		(31)
+
+// A function to time, called once per run
+typedef void (*bench_fn_t)(void *arg);
+
+// Cycles of one run
+typedef struct {
+	uint32_t min;
+	uint32_t median;
+	uint32_t max;
+} bench_result_t;
+
+// Times runs calls of fn(arg), at most BENCH_MAX_RUNS.
+void bench_run(bench_fn_t fn, void *arg, uint32_t runs,
+		bench_result_t *result);
+
+// Prints the BENCH line of a result, ops is the number of operations a run
+// does (e.g. bytes), runs the number of runs or samples of the result.
+void bench_print(const char *name, uint32_t ops, uint32_t runs,
+		const bench_result_t *result);
+
+// Prints the HIST line of count buckets of width cycles each.
+void bench_print_histogram(const char *name, uint32_t width,
+		const uint32_t *buckets, uint32_t count);
+
+void test_bench_gpio_toggle(void);
+void test_bench_uart_loopback(void);
+void test_bench_dsp(void);
+
+// CoOS benchmarks, called from a task of priority 10 or lower (higher
+// number), see test_coos_man.txt
+void test_bench_coos(void);
+
+#endif
@@ -0,0 +1,51 @@
+/*
+ * Bit-band unit tests
+ *
+ * Date:	14 October 2026
+ */
+
+#include "unity/unity.h"
+#include "sam3x8e/bitband.h"
+#include "sam3x8e/pio.h"
+#include "sam3x8e/pmc.h"
+#include "test/test_bitband.h"
+
+// in SRAM1, the second bank of the bit-band region
+static volatile uint32_t word;
+
+/*
+ * Single bits of a word in SRAM change, the others stay.
+ */
+void test_bitband_sram(void) {
+	volatile uint32_t stack_word = 0xF0F0F0F0u;
+
+	word = 0;
+	bitband_set(&word, 0);
+	bitband_set(&word, 31);
+	TEST_ASSERT_EQUAL_HEX32(0x80000001u, word);
+	bitband_clear(&word, 0);
+	bitband_write(&word, 7, 1);
+	TEST_ASSERT_EQUAL_HEX32(0x80000080u, word);
+	TEST_ASSERT_EQUAL_UINT32(1, bitband_read(&word, 31));
+	TEST_ASSERT_EQUAL_UINT32(0, bitband_read(&word, 30));
+
+	bitband_clear(&stack_word, 4);
+	bitband_set(&stack_word, 0);
+	TEST_ASSERT_EQUAL_HEX32(0xF0F0F0E1u, stack_word);
+}
+
+/*
+ * A bit of a peripheral register, the peripheral select of a pin.
+ */
+void test_bitband_register(void) {
+	uint32_t absr;
+
+	pmc_enable_peripheral_clock(ID_PIOB);
+	absr = PIOB->PIO_ABSR;
+	bitband_set(&PIOB->PIO_ABSR, 16);
+	TEST_ASSERT_EQUAL_HEX32(absr | (0x1u << 16), PIOB->PIO_ABSR);
+	TEST_ASSERT_EQUAL_UINT32(1, bitband_read(&PIOB->PIO_ABSR, 16));
+	bitband_clear(&PIOB->PIO_ABSR, 16);
+	TEST_ASSERT_EQUAL_HEX32(absr & ~(0x1u << 16), PIOB->PIO_ABSR);
+	PIOB->PIO_ABSR = absr;
+}
@@ -0,0 +1,13 @@
+/*
+ * Bit-band unit tests
+ *
+ * Date:	14 October 2026
+ */
+
+#ifndef TEST_BITBAND_H_
+#define TEST_BITBAND_H_
+
+void test_bitband_sram(void);
+void test_bitband_register(void);
+
+#endif
@@ -0,0 +1,61 @@
+/*
+ * CAN unit tests
+ *
+ * Only the setup of the controller is tested, the frames need a bus (see
+ * test_can_man.txt).
+ *
+ * Date:	14 October 2026
+ */
+
+#include "unity/unity.h"
+#include "sam3x8e/can.h"
+#include "test/test_can.h"
+
+/*
+ * 500 kbit/s at 84 MHz is 21 time quanta of 8 cycles: sync, 8 propagation,
+ * 8 phase 1 and 4 phase 2, the sample point is at 81 %.
+ */
+void test_can_init(void) {
+	TEST_ASSERT_FALSE(can_init(CAN0, 0));
+	// the prescaler would be above 128
+	TEST_ASSERT_FALSE(can_init(CAN0, 10000));
+	TEST_ASSERT_TRUE(can_init(CAN0, 500000));
+	TEST_ASSERT_EQUAL_HEX32(CAN_BR_BRP(7) | CAN_BR_SJW(3) | CAN_BR_PROPAG(7) |
+			CAN_BR_PHASE1(7) | CAN_BR_PHASE2(3), CAN0->CAN_BR);
+	TEST_ASSERT_TRUE(CAN0->CAN_MR & CAN_MR_CANEN);
+	TEST_ASSERT_EQUAL_UINT32(0, can_rx_available(CAN0));
+	can_deinit(CAN0);
+	TEST_ASSERT_FALSE(CAN0->CAN_MR & CAN_MR_CANEN);
+}
+
+void test_can_mailboxes(void) {
+	can_frame_t frame = { .id = 0x123, .dlc = 2, .data = { 1, 2 } };
+
+	TEST_ASSERT_TRUE(can_init(CAN1, 250000));
+	TEST_ASSERT_FALSE(can_rx_mailbox(CAN1, 8, 0x100, 0x700, 0));
+	TEST_ASSERT_TRUE(can_rx_mailbox(CAN1, 0, 0x100, 0x700, 0));
+	TEST_ASSERT_EQUAL_HEX32(CAN_MMR_MOT_RX, CAN1->CAN_MB[0].CAN_MMR);
+	TEST_ASSERT_EQUAL_HEX32(CAN_MID_STD(0x700) | CAN_MID_MIDE,
+			CAN1->CAN_MB[0].CAN_MAM);
+	TEST_ASSERT_EQUAL_HEX32(CAN_MID_STD(0x100), CAN1->CAN_MB[0].CAN_MID);
+	TEST_ASSERT_TRUE(CAN1->CAN_IMR & CAN_SR_MB(0));
+	TEST_ASSERT_TRUE(can_rx_mailbox(CAN1, 1, 0x18DAF110, 0x1FFFFF00, 1));
+	TEST_ASSERT_EQUAL_HEX32(0x18DAF110 | CAN_MID_MIDE, CAN1->CAN_MB[1].CAN_MID);
+
+	TEST_ASSERT_FALSE(can_tx_mailbox(CAN1, 7, CAN_PRIORITY_MAX + 1));
+	TEST_ASSERT_TRUE(can_tx_mailbox(CAN1, 7, 2));
+	TEST_ASSERT_EQUAL_HEX32(CAN_MMR_MOT_TX | CAN_MMR_PRIOR(2),
+			CAN1->CAN_MB[7].CAN_MMR);
+	TEST_ASSERT_FALSE(CAN1->CAN_IMR & CAN_SR_MB(7));
+
+	// not a transmit mailbox, and too much data
+	TEST_ASSERT_FALSE(can_write(CAN1, 0, &frame));
+	frame.dlc = 9;
+	TEST_ASSERT_FALSE(can_write(CAN1, 7, &frame));
+	TEST_ASSERT_FALSE(can_read(CAN1, &frame));
+
+	can_disable_mailbox(CAN1, 0);
+	TEST_ASSERT_EQUAL_HEX32(CAN_MMR_MOT_DISABLED, CAN1->CAN_MB[0].CAN_MMR);
+	TEST_ASSERT_FALSE(CAN1->CAN_IMR & CAN_SR_MB(0));
+	can_deinit(CAN1);
+}
@@ -0,0 +1,13 @@
+/*
+ * CAN unit tests
+ *
+ * Date:	14 October 2026
+ */
+
+#ifndef TEST_CAN_H_
+#define TEST_CAN_H_
+
+void test_can_init(void);
+void test_can_mailboxes(void);
+
+#endif
@@ -0,0 +1,132 @@
+/*
+ * CRC unit tests
+ *
+ * Date:	14 October 2026
+ */
+
+#include "unity/unity.h"
+#include "sam3x8e/crc.h"
+#include "test/test_bench.h"
+#include "test/test_crc.h"
+
+// Bytes of the benchmark buffer
+#define CRC_BENCH_LENGTH	(1024u)
+
+// The data of the check values of the catalogue of CRCs
+static const char check[] = "123456789";
+
+static crc_table_t table;
+static uint8_t buffer[CRC_BENCH_LENGTH + 4];
+
+/*
+ * The three CRCs in flash give their check values.
+ */
+void test_crc_check_values(void) {
+	TEST_ASSERT_EQUAL_HEX32(0xCBF43926u, crc_compute(&crc32_ieee, check, 9));
+	TEST_ASSERT_EQUAL_HEX32(0x29B1u, crc_compute(&crc16_ccitt, check, 9));
+	TEST_ASSERT_EQUAL_HEX32(0xF4u, crc_compute(&crc8_smbus, check, 9));
+	// no data, the initial value after the final XOR
+	TEST_ASSERT_EQUAL_HEX32(0x0u, crc_compute(&crc32_ieee, check, 0));
+	TEST_ASSERT_EQUAL_HEX32(0xFFFFu, crc_compute(&crc16_ccitt, check, 0));
+}
+
+/*
+ * Data of any alignment split at any byte gives the CRC of the whole.
+ */
+void test_crc_pieces(void) {
+	const crc_t *crcs[3] = { &crc32_ieee, &crc16_ccitt, &crc8_smbus };
+	uint32_t whole, state, offset, split, i, c;
+
+	for (i = 0; i < 64; i++) {
+		buffer[i] = (uint8_t) ((i * 2654435761u) >> 24);
+	}
+	for (c = 0; c < 3; c++) {
+		whole = crc_compute(crcs[c], buffer, 60);
+		for (offset = 1; offset < 4; offset++) {
+			for (i = 60; i > 0; i--) {
+				buffer[i - 1 + offset] = buffer[i - 1];
+			}
+			TEST_ASSERT_EQUAL_HEX32(whole,
+					crc_compute(crcs[c], buffer + offset, 60));
+			for (i = 0; i < 60; i++) {
+				buffer[i] = buffer[i + offset];
+			}
+		}
+		for (split = 0; split <= 60; split += 7) {
+			state = crc_start(crcs[c]);
+			state = crc_update(crcs[c], state, buffer, split);
+			state = crc_update(crcs[c], state, buffer + split, 60 - split);
+			TEST_ASSERT_EQUAL_HEX32(whole, crc_final(crcs[c], state));
+		}
+	}
+}
+
+/*
+ * Tables built in RAM are those in flash, other CRCs give their check
+ * values.
+ */
+void test_crc_table_init(void) {
+	crc_t crc;
+	uint32_t k, i;
+
+	TEST_ASSERT_TRUE(crc_table_init(&crc, table, 32, 0x04C11DB7u, 0xFFFFFFFFu,
+			0xFFFFFFFFu, 1));
+	for (k = 0; k < 4; k++) {
+		for (i = 0; i < 256; i++) {
+			TEST_ASSERT_EQUAL_HEX32(crc32_ieee.table[k][i], table[k][i]);
+		}
+	}
+	TEST_ASSERT_TRUE(crc_table_init(&crc, table, 16, 0x1021u, 0xFFFFu, 0, 0));
+	for (k = 0; k < 4; k++) {
+		for (i = 0; i < 256; i++) {
+			TEST_ASSERT_EQUAL_HEX32(crc16_ccitt.table[k][i], table[k][i]);
+		}
+	}
+	// CRC-32C (iSCSI), CRC-16/ARC, CRC-12/DECT
+	TEST_ASSERT_TRUE(crc_table_init(&crc, table, 32, 0x1EDC6F41u, 0xFFFFFFFFu,
+			0xFFFFFFFFu, 1));
+	TEST_ASSERT_EQUAL_HEX32(0xE3069283u, crc_compute(&crc, check, 9));
+	TEST_ASSERT_TRUE(crc_table_init(&crc, table, 16, 0x8005u, 0, 0, 1));
+	TEST_ASSERT_EQUAL_HEX32(0xBB3Du, crc_compute(&crc, check, 9));
+	TEST_ASSERT_TRUE(crc_table_init(&crc, table, 12, 0x80Fu, 0, 0, 0));
+	TEST_ASSERT_EQUAL_HEX32(0xF5Bu, crc_compute(&crc, check, 9));
+
+	TEST_ASSERT_FALSE(crc_table_init(&crc, table, 7, 0x09u, 0, 0, 0));
+	TEST_ASSERT_FALSE(crc_table_init(&crc, table, 33, 0x09u, 0, 0, 0));
+}
+
+// A CRC and its result of a benchmark run
+typedef struct {
+	const crc_t *crc;
+	uint32_t value;
+} crc_bench_t;
+
+static void crc_bench(void *arg) {
+	crc_bench_t *bench = (crc_bench_t *) arg;
+
+	bench->value = crc_compute(bench->crc, buffer, CRC_BENCH_LENGTH);
+}
+
+/*
+ * Cycles of a CRC of 1 KiB.
+ */
+void test_crc_bench(void) {
+	static const char *names[3] = {
+		"crc32_ieee_1k", "crc16_ccitt_1k", "crc8_smbus_1k"
+	};
+	crc_bench_t benches[3] = {
+		{ &crc32_ieee, 0 }, { &crc16_ccitt, 0 }, { &crc8_smbus, 0 }
+	};
+	bench_result_t result;
+	uint32_t i;
+
+	for (i = 0; i < CRC_BENCH_LENGTH; i++) {
+		buffer[i] = (uint8_t) i;
+	}
+	for (i = 0; i < 3; i++) {
+		bench_run(crc_bench, &benches[i], 8, &result);
+		bench_print(names[i], CRC_BENCH_LENGTH, 8, &result);
+		TEST_ASSERT_EQUAL_HEX32(crc_compute(benches[i].crc, buffer,
+				CRC_BENCH_LENGTH), benches[i].value);
+	}
+}
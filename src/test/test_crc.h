@@ -0,0 +1,15 @@
+/*
+ * CRC unit tests
+ *
+ * Date:	14 October 2026
+ */
+
+#ifndef TEST_CRC_H_
+#define TEST_CRC_H_
+
+void test_crc_check_values(void);
+void test_crc_pieces(void);
+void test_crc_table_init(void);
+void test_crc_bench(void);
+
+#endif /* TEST_CRC_H_ */
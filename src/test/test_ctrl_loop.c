@@ -0,0 +1,132 @@
+/*
+ * Control loop unit tests
+ *
+ * The loop runs on channel 0 of the PWM at 10 kHz and converts ADC channel
+ * 7, the timing under load is tested by hand (see test_ctrl_loop_man.txt).
+ *
+ * Date:	14 October 2026
+ */
+
+#include "unity/unity.h"
+#include "sam3x8e/ctrl_loop.h"
+#include "sam3x8e/delay.h"
+#include "sam3x8e/id.h"
+#include "sam3x8e/pmc.h"
+#include "sam3x8e/pwm.h"
+#include "test/test_ctrl_loop.h"
+
+static const uint8_t channels[] = { ADC_CHANNEL_7 };
+static volatile uint32_t computes;
+static volatile uint32_t wrong_count;
+
+/*
+ * Counts the iterations and drives channel 1 with the iteration number.
+ */
+static void compute(const uint16_t *samples, uint32_t count,
+		uint32_t duty_cycles[]) {
+	if (count != 1 || samples[0] > 0xFFFu) {
+		wrong_count++;
+	}
+	computes++;
+	duty_cycles[PWM_CHANNEL_1] = computes & 0xFFu;
+}
+
+static const ctrl_loop_config_t config = {
+	.channels = channels,
+	.count = 1,
+	.event_line = PWM_EVENT_LINE_0,
+	.comparison = 2,
+	.event_value = 100,
+	.pwm_channels = (1 << PWM_CHANNEL_1),
+	.compute = compute
+};
+
+static void setup(uint32_t trigger) {
+	adc_settings_t settings = {
+		.startup_time = ADC_MR_SUT8,
+		.prescaler = 1,
+		.trigger = trigger
+	};
+
+	pmc_enable_peripheral_clock(ID_ADC);
+	pmc_enable_peripheral_clock(ID_PWM);
+	adc_init(&settings);
+	pwm_reset_peripheral();
+	pwm_set_channel_frequency(PWM_CHANNEL_0, 10000);
+	pwm_enable_channel(PWM_CHANNEL_0);
+}
+
+static void teardown(void) {
+	pwm_reset_peripheral();
+	ADC->ADC_EMR = 0;
+	ADC->ADC_MR = ADC_MR_RESET;
+}
+
+/*
+ * The loop needs a running, left aligned channel 0 and an ADC triggered by
+ * its event line.
+ */
+void test_ctrl_loop_invalid(void) {
+	ctrl_loop_config_t bad = config;
+
+	setup(ADC_TRIGGER_PWM_EVENT1);
+	TEST_ASSERT_FALSE(ctrl_loop_start(&config));
+	teardown();
+
+	setup(ADC_TRIGGER_PWM_EVENT0);
+	bad.count = 0;
+	TEST_ASSERT_FALSE(ctrl_loop_start(&bad));
+	bad = config;
+	bad.event_value = pwm_get_channel_period(PWM_CHANNEL_0);
+	TEST_ASSERT_FALSE(ctrl_loop_start(&bad));
+	bad = config;
+	bad.compute = 0;
+	TEST_ASSERT_FALSE(ctrl_loop_start(&bad));
+	pwm_disable_channel(PWM_CHANNEL_0);
+	TEST_ASSERT_FALSE(ctrl_loop_start(&config));
+	pwm_set_channel_alignment(PWM_CHANNEL_0, PWM_CHANNEL_ALIGN_CENTER);
+	pwm_enable_channel(PWM_CHANNEL_0);
+	TEST_ASSERT_FALSE(ctrl_loop_start(&config));
+	teardown();
+}
+
+/*
+ * About 100 iterations in 10 ms, each well within its period, and none
+ * after the stop.
+ */
+void test_ctrl_loop_run(void) {
+	ctrl_loop_stats_t stats;
+	uint32_t iterations;
+
+	setup(ADC_TRIGGER_PWM_EVENT0);
+	computes = 0;
+	wrong_count = 0;
+	TEST_ASSERT_TRUE(ctrl_loop_start(&config));
+	TEST_ASSERT_FALSE(ctrl_loop_start(&config));
+	TEST_ASSERT_BITS_HIGH(1 << 2, PWM->PWM_ELMR0);
+	delay_ms(10);
+	ctrl_loop_stop();
+	ctrl_loop_get_stats(&stats);
+	iterations = stats.iterations;
+
+	TEST_ASSERT_EQUAL_UINT32(0, PWM->PWM_ELMR0 & (1 << 2));
+	TEST_ASSERT_TRUE(iterations >= 95 && iterations <= 102);
+	TEST_ASSERT_EQUAL_UINT32(computes, iterations);
+	TEST_ASSERT_EQUAL_UINT32(0, wrong_count);
+	TEST_ASSERT_EQUAL_UINT32(0, stats.late);
+	TEST_ASSERT_EQUAL_UINT32(0, stats.missed);
+	TEST_ASSERT_EQUAL_UINT32(8400, stats.period);
+	TEST_ASSERT_TRUE(stats.latency_max < stats.period - config.event_value);
+	TEST_ASSERT_TRUE(stats.latency_last <= stats.latency_max);
+	TEST_ASSERT_EQUAL_UINT32(computes & 0xFFu,
+			pwm_read_channel(PWM_CHANNEL_1));
+
+	delay_ms(2);
+	ctrl_loop_get_stats(&stats);
+	TEST_ASSERT_EQUAL_UINT32(iterations, stats.iterations);
+	ctrl_loop_reset_stats();
+	ctrl_loop_get_stats(&stats);
+	TEST_ASSERT_EQUAL_UINT32(0, stats.iterations);
+	TEST_ASSERT_EQUAL_UINT32(0, stats.latency_max);
+	teardown();
+}
@@ -0,0 +1,13 @@
+/*
+ * Control loop unit tests
+ *
+ * Date:	14 October 2026
+ */
+
+#ifndef TEST_CTRL_LOOP_H_
+#define TEST_CTRL_LOOP_H_
+
+void test_ctrl_loop_invalid(void);
+void test_ctrl_loop_run(void);
+
+#endif
@@ -0,0 +1,48 @@
+/*
+ * Cycle counting for the benchmark tests.
+ *
+ * Uses the DWT cycle counter of the Cortex-M3, which runs at the CPU clock.
+ *
+ * Date:	14 October 2026
+ */
+
+#ifndef TEST_CYCLES_H_
+#define TEST_CYCLES_H_
+
+#include <inttypes.h>
+#include "unity/unity.h"
+#include "sam3x8e/uart.h"
+
+///@cond
+#define TEST_DEMCR			(*((volatile uint32_t *) PERIPH_ADDR(0xE000EDFCU)))
+#define TEST_DEMCR_TRCENA	(0x1u << 24)
+#define TEST_DWT_CTRL		(*((volatile uint32_t *) PERIPH_ADDR(0xE0001000U)))
+#define TEST_DWT_CYCCNT		(*((volatile uint32_t *) PERIPH_ADDR(0xE0001004U)))
+///@endcond
+
+// Count of the cycle counter at test_cycles_start(), the counter itself is
+// never reset since the runner times each test with it too
+static uint32_t test_cycles_base;
+
+// Starts the cycle counter and counts from now.
+static inline void test_cycles_start(void) {
+	TEST_DEMCR |= TEST_DEMCR_TRCENA;
+	TEST_DWT_CTRL |= 0x1u;
+	test_cycles_base = TEST_DWT_CYCCNT;
+}
+
+// Number of cycles since test_cycles_start().
+static inline uint32_t test_cycles_read(void) {
+	return TEST_DWT_CYCCNT - test_cycles_base;
+}
+
+// Prints "<label><count * CPU_HZ / cycles><unit>" as a rate per second.
+static inline void test_cycles_print_rate(char *label, uint32_t count,
+		uint32_t cycles, char *unit) {
+	UnityPrint(label);
+	UnityPrintNumberUnsigned((uint32_t) (((uint64_t) count * CPU_HZ) / cycles));
+	UnityPrint(unit);
+	UnityPrint("\n\r");
+}
+
+#endif /* TEST_CYCLES_H_ */
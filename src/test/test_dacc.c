@@ -9,6 +9,9 @@
 #include "test/test_dacc.h"
 #include "sam3x8e/pmc.h"
 #include "sam3x8e/dacc.h"
+#include "sam3x8e/dacc_dds.h"
+#include "sam3x8e/delay.h"
+#include "sam3x8e/tc.h"
 #include "unity/unity.h"
 
 static void init_dacc(void) {
@@ -98,3 +101,200 @@ void test_dacc_channel_1_disabled2(void) {
 	// disable Peripheral clock for DACC
 	pmc_disable_peripheral_clock(ID_DACC);
 }
+
+#define STREAM_HALF_SAMPLES	(256)
+
+static uint32_t stream_callbacks;
+
+static void count_stream_half(uint16_t *samples, uint32_t count) {
+	(void) samples;
+	(void) count;
+	stream_callbacks++;
+}
+
+/*
+ * Test streaming a sawtooth to channel 0 in word transfer mode, triggered
+ * by TIOA of TC0 channel 1 at 100 kHz. After 21 ms about 2100 samples, i.e.
+ * 8 halves, should have been sent.
+ */
+void test_dacc_stream(void) {
+	static uint32_t words[STREAM_HALF_SAMPLES];
+	uint16_t *buffer = (uint16_t *) words;
+	const dacc_settings_t dacc_settings = {
+		.speed_mode = 1,
+		.refresh = 1,
+		.startup_time = 8,
+		.word_transfer = 1,
+		.trigger = DACC_TRIGGER_TIOA1
+	};
+	uint32_t i, halves;
+
+	pmc_enable_peripheral_clock(ID_DACC);
+	dacc_init(&dacc_settings);
+	TEST_ASSERT_EQUAL_HEX32(DACC_MR_TRGEN | (2 << DACC_MR_TRGSEL_POS),
+			DACC->DACC_MR & 0xFu);
+	dacc_select_channel(DACC_CHANNEL_0);
+	dacc_enable_channel(DACC_CHANNEL_0);
+	for (i = 0; i < 2 * STREAM_HALF_SAMPLES; i++) {
+		buffer[i] = (i * 8) & DACC_MAX_RESOLUTION;
+	}
+
+	stream_callbacks = 0;
+	TEST_ASSERT_FALSE(dacc_stream_start(buffer, 255, count_stream_half));
+	TEST_ASSERT_FALSE(dacc_stream_start(buffer + 1, 256, count_stream_half));
+	TEST_ASSERT_TRUE(dacc_stream_start(buffer, STREAM_HALF_SAMPLES,
+			count_stream_half));
+	TEST_ASSERT_EQUAL_UINT32(STREAM_HALF_SAMPLES / 2, DACC->DACC_TNCR);
+	TEST_ASSERT_EQUAL_UINT32(100000,
+			dacc_set_sample_rate(DACC_TRIGGER_TIOA1, 100000));
+	delay_ms(21);
+	halves = dacc_stream_halves();
+	dacc_stream_stop();
+	tc_disable_clock(TC0, TC_CHANNEL_1);
+
+	TEST_ASSERT_TRUE(halves >= 7 && halves <= 9);
+	TEST_ASSERT_EQUAL_UINT32(halves, stream_callbacks);
+
+	dacc_disable_channel(DACC_CHANNEL_0);
+	pmc_disable_peripheral_clock(ID_DACC);
+}
+
+/*
+ * Test the phase accumulator: at 1/256 of the sample rate every sample is
+ * the next table entry, and a new frequency goes on from the same phase.
+ */
+void test_dacc_dds_fill(void) {
+	dacc_dds_t dds;
+	uint16_t out[8];
+	uint32_t i;
+
+	TEST_ASSERT_EQUAL_HEX32(0x01000000, dacc_dds_increment(1000, 256000));
+	TEST_ASSERT_EQUAL_HEX32(0, dacc_dds_increment(128000, 256000));
+	TEST_ASSERT_FALSE(dacc_dds_init(&dds, dacc_dds_sine, 0, 256000, 1000));
+	TEST_ASSERT_TRUE(dacc_dds_init(&dds, dacc_dds_sine, DACC_DDS_TABLE_LOG2,
+			256000, 1000));
+
+	dacc_dds_fill(&dds, out, 5);
+	for (i = 0; i < 5; i++) {
+		TEST_ASSERT_EQUAL_UINT16(dacc_dds_sine[i], out[i]);
+	}
+	TEST_ASSERT_FALSE(dacc_dds_set_frequency(&dds, 200000));
+	TEST_ASSERT_TRUE(dacc_dds_set_frequency(&dds, 2000));
+	dacc_dds_fill(&dds, out, 8);
+	for (i = 0; i < 8; i++) {
+		TEST_ASSERT_EQUAL_UINT16(dacc_dds_sine[5 + 2 * i], out[i]);
+	}
+	TEST_ASSERT_EQUAL_UINT16(4095, dacc_dds_triangle[128]);
+}
+
+/*
+ * Test a 1 kHz sine streamed at 100 kHz, with a frequency change while it
+ * is streaming. The halves must keep coming.
+ */
+void test_dacc_dds_stream(void) {
+	static uint32_t words[STREAM_HALF_SAMPLES];
+	const dacc_settings_t dacc_settings = {
+		.speed_mode = 1,
+		.refresh = 1,
+		.startup_time = 8,
+		.word_transfer = 1,
+		.trigger = DACC_TRIGGER_TIOA1
+	};
+	dacc_dds_t dds;
+	uint32_t halves;
+
+	pmc_enable_peripheral_clock(ID_DACC);
+	dacc_init(&dacc_settings);
+	dacc_select_channel(DACC_CHANNEL_0);
+	dacc_enable_channel(DACC_CHANNEL_0);
+	TEST_ASSERT_TRUE(dacc_dds_init(&dds, dacc_dds_sine, DACC_DDS_TABLE_LOG2,
+			100000, 1000));
+	TEST_ASSERT_TRUE(dacc_dds_start(&dds, (uint16_t *) words,
+			STREAM_HALF_SAMPLES));
+	TEST_ASSERT_EQUAL_UINT32(100000,
+			dacc_set_sample_rate(DACC_TRIGGER_TIOA1, 100000));
+	delay_ms(11);
+	halves = dacc_stream_halves();
+	TEST_ASSERT_TRUE(halves >= 3);
+	TEST_ASSERT_TRUE(dacc_dds_set_frequency(&dds, 1500));
+	delay_ms(11);
+	TEST_ASSERT_TRUE(dacc_stream_halves() >= halves + 3);
+	dacc_dds_stop();
+	tc_disable_clock(TC0, TC_CHANNEL_1);
+
+	dacc_disable_channel(DACC_CHANNEL_0);
+	pmc_disable_peripheral_clock(ID_DACC);
+}
+
+/*
+ * Selecting channel 1 and then channel 0 must leave channel 0 selected.
+ */
+void test_dacc_select_channel(void) {
+	init_dacc();
+	dacc_select_channel(DACC_CHANNEL_1);
+	TEST_ASSERT_EQUAL_HEX32(DACC_CHANNEL_1 << DACC_MR_USER_SEL_POS,
+			DACC->DACC_MR & DACC_MR_USER_SEL_MASK);
+	dacc_select_channel(DACC_CHANNEL_0);
+	TEST_ASSERT_EQUAL_HEX32(DACC_CHANNEL_0 << DACC_MR_USER_SEL_POS,
+			DACC->DACC_MR & DACC_MR_USER_SEL_MASK);
+	pmc_disable_peripheral_clock(ID_DACC);
+}
+
+/*
+ * Test interleaving of two channels into tagged samples.
+ */
+void test_dacc_interleave(void) {
+	const uint16_t ch0[3] = { 0x000, 0x123, 0xFFF };
+	const uint16_t ch1[3] = { 0xFFF, 0x456, 0x000 };
+	uint16_t out[6];
+
+	dacc_interleave(ch0, ch1, out, 3);
+	TEST_ASSERT_EQUAL_HEX16(0x0000, out[0]);
+	TEST_ASSERT_EQUAL_HEX16(0x1FFF, out[1]);
+	TEST_ASSERT_EQUAL_HEX16(0x0123, out[2]);
+	TEST_ASSERT_EQUAL_HEX16(0x1456, out[3]);
+	TEST_ASSERT_EQUAL_HEX16(0x0FFF, out[4]);
+	TEST_ASSERT_EQUAL_HEX16(0x1000, out[5]);
+}
+
+/*
+ * Test streaming both channels from one tagged buffer, triggered at
+ * 100 kHz (50 kHz per channel). After 21 ms about 2100 samples, i.e. 8
+ * halves, should have been sent.
+ */
+void test_dacc_tagged_stream(void) {
+	static uint32_t words[STREAM_HALF_SAMPLES];
+	uint16_t *buffer = (uint16_t *) words;
+	const dacc_settings_t dacc_settings = {
+		.speed_mode = 1,
+		.refresh = 1,
+		.startup_time = 8,
+		.word_transfer = 1,
+		.trigger = DACC_TRIGGER_TIOA1,
+		.tag_mode = 1
+	};
+	uint32_t i, halves;
+
+	pmc_enable_peripheral_clock(ID_DACC);
+	dacc_init(&dacc_settings);
+	TEST_ASSERT_BITS_HIGH(DACC_MR_TAG, DACC->DACC_MR);
+	dacc_enable_channel(DACC_CHANNEL_0);
+	dacc_enable_channel(DACC_CHANNEL_1);
+	for (i = 0; i < STREAM_HALF_SAMPLES; i++) {
+		buffer[2 * i] = DACC_TAGGED(DACC_CHANNEL_0, i * 16);
+		buffer[2 * i + 1] = DACC_TAGGED(DACC_CHANNEL_1, 4095 - i * 16);
+	}
+
+	TEST_ASSERT_TRUE(dacc_stream_start(buffer, STREAM_HALF_SAMPLES, 0));
+	TEST_ASSERT_EQUAL_UINT32(100000,
+			dacc_set_sample_rate(DACC_TRIGGER_TIOA1, 100000));
+	delay_ms(21);
+	halves = dacc_stream_halves();
+	dacc_stream_stop();
+	tc_disable_clock(TC0, TC_CHANNEL_1);
+	TEST_ASSERT_TRUE(halves >= 7 && halves <= 9);
+
+	dacc_disable_channel(DACC_CHANNEL_0);
+	dacc_disable_channel(DACC_CHANNEL_1);
+	pmc_disable_peripheral_clock(ID_DACC);
+}
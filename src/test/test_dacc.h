@@ -17,5 +17,11 @@ void test_dacc_disable_channel_0(void);
 void test_dacc_disable_channel_1(void);
 void test_dacc_channel_0_disabled2(void);
 void test_dacc_channel_1_disabled2(void);
+void test_dacc_stream(void);
+void test_dacc_dds_fill(void);
+void test_dacc_dds_stream(void);
+void test_dacc_select_channel(void);
+void test_dacc_interleave(void);
+void test_dacc_tagged_stream(void);
 
 #endif
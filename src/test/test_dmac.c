@@ -0,0 +1,146 @@
+/*
+ * DMAC unit tests
+ *
+ * The transfers are memory to memory, so no peripheral is needed.
+ *
+ * Date:	14 October 2026
+ */
+
+#include "unity/unity.h"
+#include "sam3x8e/dmac.h"
+#include "test/test_dmac.h"
+
+#define TEST_LENGTH		(32)
+#define TEST_TIMEOUT	(1000000u)
+
+static uint32_t src[3][TEST_LENGTH];
+static uint32_t dst[3 * TEST_LENGTH];
+static dmac_desc_t desc[3];
+static volatile uint32_t calls;
+
+static void count_call(uint32_t channel, void *arg) {
+	(void) channel;
+	(void) arg;
+	calls++;
+}
+
+static void fill_buffers(void) {
+	uint32_t i, j;
+
+	for (i = 0; i < 3; i++) {
+		for (j = 0; j < TEST_LENGTH; j++) {
+			src[i][j] = (i << 16) | (j * 7 + 1);
+		}
+	}
+	for (i = 0; i < 3 * TEST_LENGTH; i++) {
+		dst[i] = 0;
+	}
+	calls = 0;
+}
+
+static void word_copy(dmac_transfer_t *t, const void *from, void *to) {
+	t->src = from;
+	t->dst = to;
+	t->count = TEST_LENGTH;
+	t->width = DMAC_WIDTH_WORD;
+	t->flow = DMAC_MEM2MEM;
+	t->src_incr = 1;
+	t->dst_incr = 1;
+	t->per = 0;
+}
+
+void test_dmac_channel_alloc(void) {
+	uint32_t got[DMAC_CHANNELS], n, i, channel;
+
+	// some channels may be claimed by drivers already
+	for (n = 0; n < DMAC_CHANNELS && dmac_channel_alloc(&got[n]); n++) {
+		for (i = 0; i < n; i++) {
+			TEST_ASSERT_NOT_EQUAL(got[i], got[n]);
+		}
+	}
+	TEST_ASSERT_TRUE(n > 0);
+	TEST_ASSERT_FALSE(dmac_channel_alloc(&channel));
+	TEST_ASSERT_FALSE(dmac_channel_claim(got[0]));
+	TEST_ASSERT_FALSE(dmac_channel_claim(DMAC_CHANNELS));
+	for (i = 0; i < n; i++) {
+		dmac_channel_free(got[i]);
+	}
+	TEST_ASSERT_TRUE(dmac_channel_claim(got[0]));
+	dmac_channel_free(got[0]);
+}
+
+void test_dmac_mem2mem(void) {
+	dmac_transfer_t t;
+	uint32_t channel, timeout, i;
+
+	dmac_init();
+	TEST_ASSERT_TRUE(dmac_channel_alloc(&channel));
+	fill_buffers();
+	word_copy(&t, src[0], dst);
+	TEST_ASSERT_TRUE(dmac_start(channel, &t, count_call, 0));
+	for (timeout = TEST_TIMEOUT; calls == 0 && timeout; timeout--);
+	TEST_ASSERT_EQUAL_UINT32(1, calls);
+	TEST_ASSERT_FALSE(dmac_busy(channel));
+	for (i = 0; i < TEST_LENGTH; i++) {
+		TEST_ASSERT_EQUAL_HEX32(src[0][i], dst[i]);
+	}
+	// invalid transfers
+	t.count = 0;
+	TEST_ASSERT_FALSE(dmac_start(channel, &t, 0, 0));
+	t.count = 4096;
+	TEST_ASSERT_FALSE(dmac_start(channel, &t, 0, 0));
+	dmac_channel_free(channel);
+	dmac_deinit();
+}
+
+void test_dmac_chain(void) {
+	dmac_transfer_t t;
+	uint32_t channel, timeout, i;
+
+	dmac_init();
+	TEST_ASSERT_TRUE(dmac_channel_alloc(&channel));
+	fill_buffers();
+	// gather the three sources into one buffer
+	for (i = 0; i < 3; i++) {
+		word_copy(&t, src[i], &dst[i * TEST_LENGTH]);
+		TEST_ASSERT_TRUE(dmac_desc_set(&desc[i], &t,
+				(i < 2) ? &desc[i + 1] : 0));
+	}
+	TEST_ASSERT_TRUE(dmac_start_chain(channel, &desc[0], 0, DMAC_CHAIN_END,
+			count_call, 0));
+	for (timeout = TEST_TIMEOUT; calls == 0 && timeout; timeout--);
+	TEST_ASSERT_EQUAL_UINT32(1, calls);
+	TEST_ASSERT_FALSE(dmac_busy(channel));
+	for (i = 0; i < 3 * TEST_LENGTH; i++) {
+		TEST_ASSERT_EQUAL_HEX32(src[i / TEST_LENGTH][i % TEST_LENGTH], dst[i]);
+	}
+	dmac_channel_free(channel);
+	dmac_deinit();
+}
+
+void test_dmac_ping_pong(void) {
+	dmac_transfer_t t;
+	uint32_t channel, timeout, i;
+
+	dmac_init();
+	TEST_ASSERT_TRUE(dmac_channel_alloc(&channel));
+	fill_buffers();
+	// two buffers in a ring, it runs until aborted
+	word_copy(&t, src[0], &dst[0]);
+	TEST_ASSERT_TRUE(dmac_desc_set(&desc[0], &t, &desc[1]));
+	word_copy(&t, src[1], &dst[TEST_LENGTH]);
+	TEST_ASSERT_TRUE(dmac_desc_set(&desc[1], &t, &desc[0]));
+	TEST_ASSERT_TRUE(dmac_start_chain(channel, &desc[0], 0, DMAC_CHAIN_EACH,
+			count_call, 0));
+	for (timeout = TEST_TIMEOUT; dmac_buffers_done(channel) < 4 && timeout;
+			timeout--);
+	TEST_ASSERT_TRUE(dmac_busy(channel));
+	dmac_abort(channel);
+	TEST_ASSERT_TRUE(dmac_buffers_done(channel) >= 4);
+	TEST_ASSERT_EQUAL_UINT32(dmac_buffers_done(channel), calls);
+	for (i = 0; i < 2 * TEST_LENGTH; i++) {
+		TEST_ASSERT_EQUAL_HEX32(src[i / TEST_LENGTH][i % TEST_LENGTH], dst[i]);
+	}
+	dmac_channel_free(channel);
+	dmac_deinit();
+}
@@ -0,0 +1,15 @@
+/*
+ * DMAC unit tests
+ *
+ * Date:	14 October 2026
+ */
+
+#ifndef TEST_DMAC_H_
+#define TEST_DMAC_H_
+
+void test_dmac_channel_alloc(void);
+void test_dmac_mem2mem(void);
+void test_dmac_chain(void);
+void test_dmac_ping_pong(void);
+
+#endif
@@ -0,0 +1,163 @@
+/*
+ * DSP unit tests
+ *
+ * The cycles per sample of the kernels are printed by test_bench_dsp().
+ *
+ * Date:	14 October 2026
+ */
+
+#include "unity/unity.h"
+#include "sam3x8e/dsp.h"
+#include "test/test_dsp.h"
+
+#define FFT_POINTS	(256)
+
+/*
+ * The impulse response is the coefficients, also when it crosses from one
+ * block to the next, and odd and even block lengths give the same output.
+ */
+void test_dsp_fir(void) {
+	const q15_t coeffs[5] = { 8192, -4096, 2048, 1024, 1000 };
+	const q31_t coeffs31[3] = { 1 << 30, 1 << 29, -(1 << 29) };
+	q15_t state[4 + 8], in[8] = { 0 }, out[8];
+	q31_t state31[2 + 4], in31[4] = { 0 }, out31[4];
+	dsp_fir_q15_t fir;
+	dsp_fir_q31_t fir31;
+
+	TEST_ASSERT_FALSE(dsp_fir_q15_init(&fir, coeffs, 0, state, 8));
+	TEST_ASSERT_TRUE(dsp_fir_q15_init(&fir, coeffs, 5, state, 8));
+	in[6] = 0x7FFF;
+	dsp_fir_q15(&fir, in, out, 7);
+	TEST_ASSERT_EQUAL_INT16(0, out[5]);
+	TEST_ASSERT_EQUAL_INT16(8191, out[6]);
+	in[6] = 0;
+	dsp_fir_q15(&fir, in, out, 4);
+	TEST_ASSERT_EQUAL_INT16(-4096, out[0]);
+	TEST_ASSERT_EQUAL_INT16(2047, out[1]);
+	TEST_ASSERT_EQUAL_INT16(1023, out[2]);
+	TEST_ASSERT_EQUAL_INT16(999, out[3]);
+
+	TEST_ASSERT_TRUE(dsp_fir_q31_init(&fir31, coeffs31, 3, state31, 4));
+	in31[0] = 1 << 30;
+	dsp_fir_q31(&fir31, in31, out31, 4);
+	TEST_ASSERT_EQUAL_INT32(1 << 29, out31[0]);
+	TEST_ASSERT_EQUAL_INT32(1 << 28, out31[1]);
+	TEST_ASSERT_EQUAL_INT32(-(1 << 28), out31[2]);
+	TEST_ASSERT_EQUAL_INT32(0, out31[3]);
+}
+
+/*
+ * A resonant second order low-pass (poles at 0.9, coefficients halved)
+ * settles at its DC gain of 1, a first order one at 1 too.
+ */
+void test_dsp_biquad(void) {
+	// b0 = 0.01, a1 = 1.8, a2 = -0.81, divided by 2
+	const q31_t coeffs31[5] = { 10737418, 0, 0, 1932735283, -869730877 };
+	// b0 = 0.5, a1 = 0.5
+	const q15_t coeffs[5] = { 16384, 0, 0, 16384, 0 };
+	static q31_t block31[500];
+	q15_t block[40];
+	q31_t state31[4];
+	q15_t state[4];
+	dsp_biquad_q31_t bq31;
+	dsp_biquad_q15_t bq;
+	uint32_t i;
+
+	TEST_ASSERT_FALSE(dsp_biquad_q15_init(&bq, 1, coeffs, state, 8));
+	TEST_ASSERT_TRUE(dsp_biquad_q15_init(&bq, 1, coeffs, state, 0));
+	for (i = 0; i < 40; i++) {
+		block[i] = 16000;
+	}
+	dsp_biquad_q15(&bq, block, block, 40);
+	TEST_ASSERT_EQUAL_INT16(8000, block[0]);
+	TEST_ASSERT_INT_WITHIN(2, 16000, block[39]);
+
+	TEST_ASSERT_TRUE(dsp_biquad_q31_init(&bq31, 1, coeffs31, state31, 1));
+	// in blocks, the history carries over
+	for (i = 0; i < 4; i++) {
+		uint32_t k;
+
+		for (k = 0; k < 500; k++) {
+			block31[k] = 1 << 29;
+		}
+		dsp_biquad_q31(&bq31, block31, block31, 500);
+	}
+	TEST_ASSERT_INT_WITHIN(1 << 12, 1 << 29, block31[499]);
+}
+
+/*
+ * A cosine at bin 5 gives bins 5 and -5 of half its amplitude, divided by
+ * the points. The inverse of one bin is a rotating phasor.
+ */
+void test_dsp_fft(void) {
+	static q15_t data[2 * FFT_POINTS];
+	// cos(2 pi 5 i / 256) * 16000, by the angle addition
+	int32_t c = 32767, s = 0, cn, sn;
+	const int32_t c5 = 32521, s5 = 4011;
+	uint32_t i;
+
+	TEST_ASSERT_FALSE(dsp_fft_q15(data, 128, 0));
+	TEST_ASSERT_FALSE(dsp_fft_q15(data, 4096, 0));
+	for (i = 0; i < FFT_POINTS; i++) {
+		data[2 * i] = (q15_t) ((c * 16000) >> 15);
+		data[2 * i + 1] = 0;
+		cn = (c * c5 - s * s5) >> 15;
+		sn = (s * c5 + c * s5) >> 15;
+		c = cn;
+		s = sn;
+	}
+	TEST_ASSERT_TRUE(dsp_fft_q15(data, FFT_POINTS, 0));
+	TEST_ASSERT_INT_WITHIN(100, 8000, data[2 * 5]);
+	TEST_ASSERT_INT_WITHIN(100, 8000, data[2 * (FFT_POINTS - 5)]);
+	for (i = 0; i < FFT_POINTS; i++) {
+		if (i != 5 && i != FFT_POINTS - 5) {
+			TEST_ASSERT_INT_WITHIN(50, 0, data[2 * i]);
+		}
+		TEST_ASSERT_INT_WITHIN(50, 0, data[2 * i + 1]);
+	}
+
+	for (i = 0; i < 2 * FFT_POINTS; i++) {
+		data[i] = 0;
+	}
+	data[2 * 64] = 0x7FFF;
+	TEST_ASSERT_TRUE(dsp_fft_q15(data, FFT_POINTS, 1));
+	// a quarter turn per point, 1/256 each
+	TEST_ASSERT_INT_WITHIN(2, 128, data[0]);
+	TEST_ASSERT_INT_WITHIN(2, 128, data[2 * 1 + 1]);
+	TEST_ASSERT_INT_WITHIN(2, -128, data[2 * 2]);
+	TEST_ASSERT_INT_WITHIN(2, -128, data[2 * 3 + 1]);
+}
+
+/*
+ * A square wave of amplitude 0.5 has an RMS of 0.5, the peak of -1.0 is
+ * saturated.
+ */
+void test_dsp_rms_peak(void) {
+	q15_t square[63];
+	q31_t square31[64];
+	q15_t cplx[4] = { 16384, 16384, -32768, -32768 };
+	q31_t mag[2];
+	uint32_t i, index;
+
+	for (i = 0; i < 63; i++) {
+		square[i] = (i & 1) ? -16384 : 16384;
+	}
+	for (i = 0; i < 64; i++) {
+		square31[i] = (i & 1) ? -(1 << 30) : (1 << 30);
+	}
+	TEST_ASSERT_EQUAL_INT16(16384, dsp_rms_q15(square, 63));
+	TEST_ASSERT_EQUAL_INT32(1 << 30, dsp_rms_q31(square31, 64));
+
+	TEST_ASSERT_EQUAL_INT16(16384, dsp_peak_q15(square, 63, &index));
+	TEST_ASSERT_EQUAL_UINT32(0, index);
+	square[10] = -32768;
+	TEST_ASSERT_EQUAL_INT16(0x7FFF, dsp_peak_q15(square, 63, &index));
+	TEST_ASSERT_EQUAL_UINT32(10, index);
+	square31[7] = (q31_t) 0x80000000u;
+	TEST_ASSERT_EQUAL_INT32(0x7FFFFFFF, dsp_peak_q31(square31, 64, &index));
+	TEST_ASSERT_EQUAL_UINT32(7, index);
+
+	dsp_cmplx_mag_squared_q15(cplx, mag, 2);
+	TEST_ASSERT_EQUAL_INT32(1 << 30, mag[0]);
+	TEST_ASSERT_EQUAL_INT32(0x7FFFFFFF, mag[1]);
+}
@@ -0,0 +1,15 @@
+/*
+ * DSP unit tests
+ *
+ * Date:	14 October 2026
+ */
+
+#ifndef TEST_DSP_H_
+#define TEST_DSP_H_
+
+void test_dsp_fir(void);
+void test_dsp_biquad(void);
+void test_dsp_fft(void);
+void test_dsp_rms_peak(void);
+
+#endif
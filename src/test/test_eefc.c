@@ -9,6 +9,8 @@
 #include "unity/unity.h"
 #include "test_eefc.h"
 #include "sam3x8e/eefc.h"
+#include "sam3x8e/eefc_buf.h"
+#include "sam3x8e/pmc.h"
 
 /*
  * This test is just checking if the right value was written to the registers.
@@ -20,3 +22,60 @@ void test_eefc_set_flash_wait_state(void) {
 	TEST_ASSERT_TRUE(((EEFC0->EEFC_FMR) & bit_mask) == expected_value);
 	TEST_ASSERT_TRUE(((EEFC1->EEFC_FMR) & bit_mask) == expected_value);
 }
+
+/*
+ * The fewest wait states of the frequency limits and of the clocks the PMC
+ * sets.
+ */
+void test_eefc_wait_states(void) {
+	TEST_ASSERT_EQUAL_UINT32(0, eefc_wait_states(PMC_FAST_RC_FREQ));
+	TEST_ASSERT_EQUAL_UINT32(0, eefc_wait_states(19000000u));
+	TEST_ASSERT_EQUAL_UINT32(1, eefc_wait_states(19000001u));
+	TEST_ASSERT_EQUAL_UINT32(2, eefc_wait_states(64000000u));
+	TEST_ASSERT_EQUAL_UINT32(3, eefc_wait_states(80000000u));
+	TEST_ASSERT_EQUAL_UINT32(4, eefc_wait_states(SYS_CLK_FREQ));
+	TEST_ASSERT_EQUAL_UINT32(4, eefc_wait_states(120000000u));
+}
+
+/*
+ * The unique identifier reads the same twice and is not erased flash.
+ */
+void test_eefc_unique_id(void) {
+	uint32_t id1[4], id2[4];
+	eefc_read_unique_id(id1);
+	eefc_read_unique_id(id2);
+	TEST_ASSERT_EQUAL_HEX32_ARRAY(id1, id2, 4);
+	TEST_ASSERT_FALSE(id1[0] == 0xFFFFFFFFu && id1[1] == 0xFFFFFFFFu &&
+			id1[2] == 0xFFFFFFFFu && id1[3] == 0xFFFFFFFFu);
+}
+
+/*
+ * Small writes to the last page of the flash are programmed in one go on
+ * the flush, the flash holds them afterwards.
+ */
+void test_eefc_buf_write(void) {
+	uint32_t page = EEFC_FLASH_START + 2 * EEFC_BANK_SIZE - EEFC_PAGE_SIZE;
+	const uint8_t *flash = (const uint8_t *) page;
+	eefc_buf_t buf;
+	uint8_t byte;
+	uint32_t i;
+
+	TEST_ASSERT_EQUAL(0, eefc_is_locked(page));
+	TEST_ASSERT_EQUAL(1, eefc_erase_page(page));
+	TEST_ASSERT_EQUAL_HEX8(0xFF, flash[0]);
+
+	eefc_buf_init(&buf);
+	for (i = 0; i < 16; i++) {
+		byte = (uint8_t) (i * 7);
+		TEST_ASSERT_EQUAL(1, eefc_buf_write(&buf, page + i, &byte, 1));
+	}
+	TEST_ASSERT_EQUAL(0, buf.programs);
+	eefc_buf_read(&buf, page + 5, &byte, 1);
+	TEST_ASSERT_EQUAL(35, byte);
+	TEST_ASSERT_EQUAL(1, eefc_buf_flush(&buf));
+	TEST_ASSERT_EQUAL(1, buf.programs);
+	for (i = 0; i < 16; i++) {
+		TEST_ASSERT_EQUAL((uint8_t) (i * 7), flash[i]);
+	}
+	TEST_ASSERT_EQUAL_HEX8(0xFF, flash[16]);
+}
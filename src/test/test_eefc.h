@@ -10,5 +10,8 @@
 #define TEST_EEFC_H_
 
 void test_eefc_set_flash_wait_state(void);
+void test_eefc_wait_states(void);
+void test_eefc_unique_id(void);
+void test_eefc_buf_write(void);
 
 #endif
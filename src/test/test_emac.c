@@ -0,0 +1,85 @@
+/*
+ * EMAC unit tests
+ *
+ * The Due has no PHY, so no frame goes out or comes in. Only the rings and
+ * the ownership of their buffers are tested, the frames are tested by hand
+ * (see test_emac_man.txt).
+ *
+ * Date:	14 October 2026
+ */
+
+#include "unity/unity.h"
+#include "sam3x8e/emac.h"
+#include "test/test_emac.h"
+
+#define SPARE_BUFS		(2)
+#define POOL_BUFS		(EMAC_RX_DESCS + SPARE_BUFS)
+
+static const uint8_t mac[6] = { 0x02, 0x00, 0x00, 0x12, 0x34, 0x56 };
+
+// The memory partitions of CoOS cannot be deleted, the pool is made once
+static const buf_pool_t *test_pool(void) {
+	static uint32_t memory[BUF_POOL_WORDS(EMAC_RX_UNIT, POOL_BUFS)];
+	static buf_pool_t pool;
+	static uint8_t created;
+
+	if (!created) {
+		TEST_ASSERT_TRUE(buf_pool_init(&pool, memory, EMAC_RX_UNIT,
+				POOL_BUFS));
+		created = 1;
+	}
+	return &pool;
+}
+
+// Counts the free buffers of a pool
+static uint32_t free_bufs(const buf_pool_t *pool) {
+	buf_t *bufs[POOL_BUFS];
+	uint32_t count = 0, n;
+
+	while (count < POOL_BUFS && (bufs[count] = buf_alloc(pool)) != 0) {
+		count++;
+	}
+	for (n = 0; n < count; n++) {
+		buf_release(bufs[n]);
+	}
+	return count;
+}
+
+void test_emac_init(void) {
+	const buf_pool_t *pool = test_pool();
+	emac_frame_t frame;
+
+	TEST_ASSERT_EQUAL_UINT32(POOL_BUFS, free_bufs(pool));
+	TEST_ASSERT_TRUE(emac_init(mac, pool));
+	// every receive descriptor holds a buffer
+	TEST_ASSERT_EQUAL_UINT32(SPARE_BUFS, free_bufs(pool));
+	TEST_ASSERT_EQUAL_HEX32(0x12000002, EMAC->EMAC_SA[0].EMAC_SAB);
+	TEST_ASSERT_EQUAL_HEX32(0x5634, EMAC->EMAC_SA[0].EMAC_SAT);
+	TEST_ASSERT_TRUE(EMAC->EMAC_NCR & EMAC_NCR_RE);
+	TEST_ASSERT_TRUE(EMAC->EMAC_NCR & EMAC_NCR_TE);
+	// MDC at 1.3 MHz from 84 MHz
+	TEST_ASSERT_EQUAL_HEX32(EMAC_NCFGR_CLK(3),
+			EMAC->EMAC_NCFGR & EMAC_NCFGR_CLK_MASK);
+	TEST_ASSERT_FALSE(emac_receive(&frame));
+	TEST_ASSERT_EQUAL_UINT32(EMAC_TX_DESCS, emac_tx_free());
+	emac_deinit();
+	TEST_ASSERT_EQUAL_UINT32(POOL_BUFS, free_bufs(pool));
+}
+
+void test_emac_send(void) {
+	const buf_pool_t *pool = test_pool();
+	buf_t *buf;
+
+	TEST_ASSERT_TRUE(emac_init(mac, pool));
+	buf = buf_alloc(pool);
+	TEST_ASSERT_NOT_NULL(buf);
+	// shorter than the header
+	TEST_ASSERT_NOT_NULL(buf_put(buf, 13));
+	TEST_ASSERT_FALSE(emac_send(buf));
+	TEST_ASSERT_NOT_NULL(buf_put(buf, 47));
+	TEST_ASSERT_TRUE(emac_send(buf));
+	// the frame holds the buffer until it is sent or the EMAC is stopped
+	TEST_ASSERT_EQUAL_UINT32(SPARE_BUFS - 1, free_bufs(pool));
+	emac_deinit();
+	TEST_ASSERT_EQUAL_UINT32(POOL_BUFS, free_bufs(pool));
+}
@@ -0,0 +1,13 @@
+/*
+ * EMAC unit tests
+ *
+ * Date:	14 October 2026
+ */
+
+#ifndef TEST_EMAC_H_
+#define TEST_EMAC_H_
+
+void test_emac_init(void);
+void test_emac_send(void);
+
+#endif
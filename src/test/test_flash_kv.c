@@ -0,0 +1,108 @@
+/*
+ * Flash key-value store unit tests
+ *
+ * Date:	14 October 2026
+ */
+
+#include "unity/unity.h"
+#include "sam3x8e/eefc.h"
+#include "sam3x8e/flash_kv.h"
+#include "test/test_flash_kv.h"
+
+// Two sectors of 4 KB below the page used by the EEFC tests
+#define KV_SECTOR		(0x1000u)
+#define KV_START		(EEFC_FLASH_START + 2 * EEFC_BANK_SIZE - 0x4000u)
+#define KV_KEYS			(8)
+
+static flash_kv_t kv;
+static uint32_t kv_index[KV_KEYS];
+
+/*
+ * A region without a valid sector header mounts as an empty store.
+ */
+void test_flash_kv_mount_empty(void) {
+	uint32_t addr;
+	uint32_t value;
+
+	for (addr = KV_START; addr < KV_START + 2 * KV_SECTOR;
+			addr += EEFC_PAGE_SIZE) {
+		TEST_ASSERT_EQUAL(1, eefc_erase_page(addr));
+	}
+	TEST_ASSERT_EQUAL(0, flash_kv_mount(&kv, KV_START, KV_SECTOR, 1,
+			kv_index, KV_KEYS));
+	TEST_ASSERT_EQUAL(1, flash_kv_mount(&kv, KV_START, KV_SECTOR, 2,
+			kv_index, KV_KEYS));
+	TEST_ASSERT_EQUAL(0, flash_kv_read(&kv, 0, &value, 4, 0));
+}
+
+/*
+ * A value reads back, the latest write of a key wins.
+ */
+void test_flash_kv_write_read(void) {
+	uint32_t value = 1;
+	uint32_t length;
+	char text[8];
+
+	TEST_ASSERT_EQUAL(1, flash_kv_write(&kv, 2, &value, 4));
+	value = 2;
+	TEST_ASSERT_EQUAL(1, flash_kv_write(&kv, 2, &value, 4));
+	TEST_ASSERT_EQUAL(1, flash_kv_write(&kv, 3, "abcde", 6));
+	TEST_ASSERT_EQUAL(0, flash_kv_write(&kv, KV_KEYS, &value, 4));
+
+	value = 0;
+	TEST_ASSERT_EQUAL(1, flash_kv_read(&kv, 2, &value, 4, &length));
+	TEST_ASSERT_EQUAL(2, value);
+	TEST_ASSERT_EQUAL(4, length);
+	TEST_ASSERT_EQUAL(1, flash_kv_read(&kv, 3, text, sizeof(text), &length));
+	TEST_ASSERT_EQUAL_STRING("abcde", text);
+	TEST_ASSERT_EQUAL(6, length);
+}
+
+/*
+ * A new mount finds the values written before.
+ */
+void test_flash_kv_remount(void) {
+	uint32_t value = 0;
+
+	TEST_ASSERT_EQUAL(1, flash_kv_mount(&kv, KV_START, KV_SECTOR, 2,
+			kv_index, KV_KEYS));
+	TEST_ASSERT_EQUAL(1, flash_kv_read(&kv, 2, &value, 4, 0));
+	TEST_ASSERT_EQUAL(2, value);
+}
+
+/*
+ * Updates that fill the active sector move the latest values to the other
+ * one, nothing is lost.
+ */
+void test_flash_kv_compact(void) {
+	uint32_t value;
+	char text[8];
+
+	// 12 bytes a record, a sector holds about 340
+	for (value = 0; value < 1000; value++) {
+		TEST_ASSERT_EQUAL(1, flash_kv_write(&kv, value % 2, &value, 4));
+	}
+	TEST_ASSERT_TRUE(kv.compactions >= 2);
+	TEST_ASSERT_EQUAL(1, flash_kv_mount(&kv, KV_START, KV_SECTOR, 2,
+			kv_index, KV_KEYS));
+	TEST_ASSERT_EQUAL(1, flash_kv_read(&kv, 0, &value, 4, 0));
+	TEST_ASSERT_EQUAL(998, value);
+	TEST_ASSERT_EQUAL(1, flash_kv_read(&kv, 1, &value, 4, 0));
+	TEST_ASSERT_EQUAL(999, value);
+	TEST_ASSERT_EQUAL(1, flash_kv_read(&kv, 3, text, sizeof(text), 0));
+	TEST_ASSERT_EQUAL_STRING("abcde", text);
+}
+
+/*
+ * A deleted key has no value, also after a mount.
+ */
+void test_flash_kv_delete(void) {
+	uint32_t value;
+
+	TEST_ASSERT_EQUAL(1, flash_kv_delete(&kv, 3));
+	TEST_ASSERT_EQUAL(0, flash_kv_read(&kv, 3, &value, 4, 0));
+	TEST_ASSERT_EQUAL(1, flash_kv_mount(&kv, KV_START, KV_SECTOR, 2,
+			kv_index, KV_KEYS));
+	TEST_ASSERT_EQUAL(0, flash_kv_read(&kv, 3, &value, 4, 0));
+	TEST_ASSERT_EQUAL(1, flash_kv_read(&kv, 2, &value, 4, 0));
+}
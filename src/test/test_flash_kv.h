@@ -0,0 +1,16 @@
+/*
+ * Flash key-value store unit tests
+ *
+ * Date:	14 October 2026
+ */
+
+#ifndef TEST_FLASH_KV_H_
+#define TEST_FLASH_KV_H_
+
+void test_flash_kv_mount_empty(void);
+void test_flash_kv_write_read(void);
+void test_flash_kv_remount(void);
+void test_flash_kv_compact(void);
+void test_flash_kv_delete(void);
+
+#endif
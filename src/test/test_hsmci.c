@@ -0,0 +1,28 @@
+/*
+ * HSMCI unit tests
+ *
+ * The Due has no card slot, the tests run without a card. The transfers
+ * are tested by hand with a card (see test_hsmci_man.txt).
+ *
+ * Date:	14 October 2026
+ */
+
+#include "unity/unity.h"
+#include "sam3x8e/hsmci.h"
+#include "test/test_hsmci.h"
+
+/*
+ * Without a card the identification times out, and nothing can be read,
+ * written or streamed.
+ */
+void test_hsmci_no_card(void) {
+	static uint32_t data[HSMCI_BLOCK_SIZE / 4];
+
+	TEST_ASSERT_FALSE(hsmci_init());
+	TEST_ASSERT_EQUAL_UINT32(0, hsmci_blocks());
+	TEST_ASSERT_FALSE(hsmci_read_blocks(0, data, 1));
+	TEST_ASSERT_FALSE(hsmci_write_blocks(0, data, 1));
+	TEST_ASSERT_FALSE(hsmci_stream_open(0, 1));
+	TEST_ASSERT_FALSE(hsmci_stream_close());
+	TEST_ASSERT_EQUAL_UINT32(0, hsmci_stream_written());
+}
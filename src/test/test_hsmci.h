@@ -0,0 +1,12 @@
+/*
+ * HSMCI unit tests
+ *
+ * Date:	14 October 2026
+ */
+
+#ifndef TEST_HSMCI_H_
+#define TEST_HSMCI_H_
+
+void test_hsmci_no_card(void);
+
+#endif
@@ -0,0 +1,278 @@
+/*
+ * Interrupt latency and jitter harness
+ *
+ * Date:	14 October 2026
+ */
+
+#include "unity/unity.h"
+#include "sam3x8e/dmac.h"
+#include "sam3x8e/id.h"
+#include "sam3x8e/logger.h"
+#include "sam3x8e/pmc.h"
+#include "sam3x8e/spi.h"
+#include "sam3x8e/tc.h"
+#include "sam3x8e/rtos/CoOS.h"
+#include "test_bench.h"
+#include "test_latency.h"
+
+// The interrupt, counting MCK/2 from the RC compare
+#define LATENCY_TC			TC1
+#define LATENCY_CHANNEL		TC_CHANNEL_2
+#define TC_SR_CPCS			(0x1u << 4)
+// Words of a DMA transfer of the SPI load
+#define LATENCY_SPI_LENGTH	(64u)
+// Mails of a round of the queue load
+#define LATENCY_QUEUE_MAILS	(4u)
+
+static struct {
+	latency_result_t *result;
+	// period in MCK/2 counts
+	uint32_t period;
+	uint64_t last;
+	volatile uint32_t count;
+} meas;
+
+static struct {
+	uint8_t tx[LATENCY_SPI_LENGTH];
+	uint8_t rx[LATENCY_SPI_LENGTH];
+	void *queue_buf[LATENCY_QUEUE_MAILS];
+	OS_EventID queue;
+	uint8_t has_queue;
+} load;
+
+static void hist_clear(latency_hist_t *hist) {
+	uint32_t i;
+
+	hist->samples = 0;
+	hist->min = 0xFFFFFFFFu;
+	hist->max = 0;
+	for (i = 0; i < LATENCY_BUCKETS; i++) {
+		hist->buckets[i] = 0;
+	}
+}
+
+static void hist_add(latency_hist_t *hist, uint32_t cycles) {
+	uint32_t bucket = cycles / LATENCY_BUCKET_CYCLES;
+
+	if (bucket >= LATENCY_BUCKETS) {
+		bucket = LATENCY_BUCKETS - 1;
+	}
+	hist->buckets[bucket]++;
+	hist->samples++;
+	if (cycles < hist->min) {
+		hist->min = cycles;
+	}
+	if (cycles > hist->max) {
+		hist->max = cycles;
+	}
+}
+
+// The lower bound of the bucket of the middle sample
+static uint32_t hist_median(const latency_hist_t *hist) {
+	uint32_t i, seen = 0;
+
+	for (i = 0; i < LATENCY_BUCKETS; i++) {
+		seen += hist->buckets[i];
+		if (seen > hist->samples / 2) {
+			break;
+		}
+	}
+	return i * LATENCY_BUCKET_CYCLES;
+}
+
+static void tick(tc_reg_t *tc, uint32_t channel) {
+	tc_channel_reg_t *tc_ch = tc->TC_CHANNEL + channel;
+	// read first, everything after the entry adds to it
+	uint32_t since = tc_ch->TC_CV;
+	uint64_t now = tc_timestamp_read(tc);
+	uint32_t interval, deviation;
+
+	(void) tc_ch->TC_SR;
+	if (meas.count >= LATENCY_IRQS) {
+		tc_ch->TC_IDR = TC_SR_CPCS;
+		return;
+	}
+	// one MCK/2 count is two CPU cycles
+	hist_add(&meas.result->latency, since * 2);
+	if (meas.count > 0) {
+		interval = (uint32_t) (now - meas.last);
+		deviation = (interval > meas.period) ? interval - meas.period :
+				meas.period - interval;
+		hist_add(&meas.result->jitter, deviation * 2);
+	}
+	meas.last = now;
+	meas.count++;
+}
+
+static void spi_load_init(void) {
+	const spi_settings_t settings = { .delay_between_cs = 0 };
+	const spi_selector_settings_t selector = {
+		.selector = SPI_SELECTOR_0,
+		.baud_rate = 2,
+		.CPOL = SPI_POLARITY_LOW,
+		.NCPHA = SPI_PHASE_LOW,
+		.delay_transfers = 0,
+		.delay_clk = 0,
+		.bits_pr_transfer = SPI_BITS_8
+	};
+
+	pmc_enable_peripheral_clock(ID_SPI0);
+	spi_reset(SPI0);
+	spi_init(SPI0, &settings);
+	spi_init_selector(SPI0, &selector);
+	spi_enable(SPI0);
+	spi_enable_loopback(SPI0);
+	spi_select_slave(SPI0, SPI_SELECTOR_0);
+	dmac_init();
+}
+
+// One round of the loads, between the interrupts
+static void run_loads(uint32_t loads) {
+	uint32_t i;
+	StatusType err;
+
+	if (loads & LATENCY_LOAD_UART) {
+		LOG("latency %u\r", meas.count);
+		(void) logger_flush();
+	}
+	if ((loads & LATENCY_LOAD_SPI_DMA) && !spi_transfer_busy()) {
+		(void) spi_transfer_async(SPI0, SPI_SELECTOR_0, load.tx, load.rx,
+				LATENCY_SPI_LENGTH, 0);
+	}
+	if (loads & LATENCY_LOAD_QUEUE) {
+		for (i = 0; i < LATENCY_QUEUE_MAILS; i++) {
+			(void) CoPostQueueMail(load.queue, &load);
+		}
+		for (i = 0; i < LATENCY_QUEUE_MAILS; i++) {
+			(void) CoAcceptQueueMail(load.queue, &err);
+		}
+	}
+}
+
+uint8_t latency_measure(uint32_t loads, latency_result_t *result) {
+	tc_channel_reg_t *tc_ch = LATENCY_TC->TC_CHANNEL + LATENCY_CHANNEL;
+	uint64_t start, timeout;
+
+	if (tc_get_handler(LATENCY_TC, LATENCY_CHANNEL) != 0) {
+		return 0;
+	}
+	if (loads & LATENCY_LOAD_SPI_DMA) {
+		spi_load_init();
+	}
+	if ((loads & LATENCY_LOAD_QUEUE) && !load.has_queue) {
+		load.queue = CoCreateQueue(load.queue_buf, LATENCY_QUEUE_MAILS,
+				EVENT_SORT_TYPE_FIFO);
+		if (load.queue == (OS_EventID) E_CREATE_FAIL) {
+			return 0;
+		}
+		load.has_queue = 1;
+	}
+	hist_clear(&result->latency);
+	hist_clear(&result->jitter);
+	meas.result = result;
+	meas.period = pmc_get_mck_freq() / 2 / 1000000 * LATENCY_PERIOD_US;
+	meas.count = 0;
+
+	(void) pmc_acquire_peripheral_clock(ID_TC3);
+	(void) pmc_acquire_peripheral_clock(ID_TC4);
+	(void) pmc_acquire_peripheral_clock(ID_TC5);
+	tc_timestamp_start(LATENCY_TC);
+	tc_ch->TC_CCR = TC_CCR_CLKDIS;
+	tc_ch->TC_IDR = ~0u;
+	tc_ch->TC_CMR = (TC_CMR_TCCLKS_TCLK1 << TC_CMR_TCCLKS_POS) |
+			(TC_CMR_WAVEFORM_MODE << TC_CMR_WAVE_POS) |
+			(TC_CMR_WAVESEL_UP_RC << TC_CMR_WAVSEL_POS);
+	tc_ch->TC_RC = meas.period - 1;
+	(void) tc_ch->TC_SR;
+	tc_set_handler(LATENCY_TC, LATENCY_CHANNEL, tick);
+	tc_ch->TC_IER = TC_SR_CPCS;
+	tc_ch->TC_CCR = TC_CCR_CLKEN | TC_CCR_SWTRG;
+
+	// twice the time of all interrupts
+	start = tc_timestamp_read(LATENCY_TC);
+	timeout = 2ull * LATENCY_IRQS * meas.period;
+	while (meas.count < LATENCY_IRQS &&
+			tc_timestamp_read(LATENCY_TC) - start < timeout) {
+		run_loads(loads);
+	}
+
+	tc_ch->TC_IDR = TC_SR_CPCS;
+	tc_ch->TC_CCR = TC_CCR_CLKDIS;
+	tc_set_handler(LATENCY_TC, LATENCY_CHANNEL, 0);
+	tc_timestamp_stop(LATENCY_TC);
+	(void) pmc_release_peripheral_clock(ID_TC5);
+	(void) pmc_release_peripheral_clock(ID_TC4);
+	(void) pmc_release_peripheral_clock(ID_TC3);
+	while (spi_transfer_busy());
+	return meas.count == LATENCY_IRQS;
+}
+
+static void print_hist(const char *kind, const char *name,
+		const latency_hist_t *hist) {
+	bench_result_t summary;
+	char label[40];
+	uint32_t i = 0, j = 0;
+
+	while (kind[j] != '\0' && i < sizeof(label) - 1) {
+		label[i++] = kind[j++];
+	}
+	j = 0;
+	while (name[j] != '\0' && i < sizeof(label) - 1) {
+		label[i++] = name[j++];
+	}
+	label[i] = '\0';
+	summary.min = (hist->samples != 0) ? hist->min : 0;
+	summary.median = hist_median(hist);
+	summary.max = hist->max;
+	bench_print(label, 1, hist->samples, &summary);
+	bench_print_histogram(label, LATENCY_BUCKET_CYCLES, hist->buckets,
+			LATENCY_BUCKETS);
+}
+
+void latency_print(const char *name, const latency_result_t *result) {
+	print_hist("irq_latency_", name, &result->latency);
+	print_hist("irq_jitter_", name, &result->jitter);
+}
+
+static void measure_and_print(const char *name, uint32_t loads) {
+	static latency_result_t result;
+	uint32_t period_cycles = LATENCY_PERIOD_US * (pmc_get_mck_freq() / 1000000);
+
+	TEST_ASSERT_TRUE(latency_measure(loads, &result));
+	latency_print(name, &result);
+	TEST_ASSERT_EQUAL_UINT32(LATENCY_IRQS, result.latency.samples);
+	TEST_ASSERT_EQUAL_UINT32(LATENCY_IRQS - 1, result.jitter.samples);
+	// no interrupt came after the next one was due
+	TEST_ASSERT_TRUE(result.latency.max < period_cycles);
+}
+
+void test_latency_idle(void) {
+	measure_and_print("idle", LATENCY_LOAD_NONE);
+}
+
+void test_latency_uart(void) {
+	measure_and_print("uart", LATENCY_LOAD_UART);
+	UnityPrint("\n\r");
+}
+
+void test_latency_spi_dma(void) {
+	measure_and_print("spi_dma", LATENCY_LOAD_SPI_DMA);
+}
+
+void test_latency_coos(void) {
+	static latency_result_t result;
+
+	if (!latency_measure(LATENCY_LOAD_NONE, &result)) {
+		UnityPrint("BENCH latency not measured\n\r");
+		return;
+	}
+	latency_print("coos_idle", &result);
+	(void) latency_measure(LATENCY_LOAD_QUEUE, &result);
+	latency_print("coos_queue", &result);
+	(void) latency_measure(LATENCY_LOAD_QUEUE | LATENCY_LOAD_SPI_DMA, &result);
+	latency_print("coos_queue_spi_dma", &result);
+	(void) latency_measure(LATENCY_LOAD_QUEUE | LATENCY_LOAD_SPI_DMA |
+			LATENCY_LOAD_UART, &result);
+	UnityPrint("\n\r");
+	latency_print("coos_all", &result);
+}
@@ -0,0 +1,72 @@
+/*
+ * Interrupt latency and jitter harness
+ *
+ * Channel 2 of TC1 raises an interrupt every LATENCY_PERIOD_US, its counter
+ * restarts at the RC compare, so its value on entry of the handler is the
+ * latency. Channel 0 and 1 run the 64-bit timestamp counter, the jitter is
+ * the difference between the time from one entry to the next and the
+ * period. Both are sorted into histograms of LATENCY_BUCKETS buckets while
+ * the caller's loop runs the background loads, and printed as BENCH lines
+ * in CPU cycles:
+ *
+ *		BENCH,irq_latency_<load>,1,<samples>,<min>,<median>,<max>
+ *		HIST,irq_latency_<load>,<bucket cycles>,<count>,<count>,...
+ *
+ * The median is the lower bound of its bucket. The latency includes the
+ * dispatch of tc.c to the handler.
+ *
+ * Date:	14 October 2026
+ */
+
+#ifndef TEST_LATENCY_H_
+#define TEST_LATENCY_H_
+
+#include <inttypes.h>
+
+// Period of the interrupt
+#define LATENCY_PERIOD_US		(50u)
+// Interrupts of one measurement
+#define LATENCY_IRQS			(4000u)
+// Buckets of a histogram, the last one also counts all that are longer
+#define LATENCY_BUCKETS			(16u)
+// Width of a bucket in CPU cycles
+#define LATENCY_BUCKET_CYCLES	(16u)
+
+// Background loads, one bit each
+#define LATENCY_LOAD_NONE		(0u)
+// LOG() and logger_flush() to the UART
+#define LATENCY_LOAD_UART		(0x1u << 0)
+// Back-to-back DMA transfers of SPI0 in loopback mode
+#define LATENCY_LOAD_SPI_DMA	(0x1u << 1)
+// CoPostQueueMail() and CoAcceptQueueMail(), needs a running CoOS
+#define LATENCY_LOAD_QUEUE		(0x1u << 2)
+
+// A histogram in CPU cycles
+typedef struct {
+	uint32_t samples;
+	uint32_t min;
+	uint32_t max;
+	uint32_t buckets[LATENCY_BUCKETS];
+} latency_hist_t;
+
+typedef struct {
+	latency_hist_t latency;
+	latency_hist_t jitter;
+} latency_result_t;
+
+// Measures LATENCY_IRQS interrupts under the loads, returns 1 if all came
+// in time.
+uint8_t latency_measure(uint32_t loads, latency_result_t *result);
+
+// Prints the BENCH and HIST lines of latency and jitter, name is the load.
+void latency_print(const char *name, const latency_result_t *result);
+
+void test_latency_idle(void);
+void test_latency_uart(void);
+void test_latency_spi_dma(void);
+
+// All loads with the queue traffic, called from a CoOS task, see
+// test_coos_man.txt
+void test_latency_coos(void);
+
+#endif
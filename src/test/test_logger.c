@@ -0,0 +1,58 @@
+/*
+ * Logger unit tests
+ *
+ * Date:	14 October 2026
+ */
+
+#include "unity/unity.h"
+#include "sam3x8e/logger.h"
+#include "test/test_logger.h"
+
+void test_logger_format(void) {
+	char out[48];
+	const uint32_t args[4] = {(uint32_t) -42, 0xBEEF, 'k', (uint32_t) "str"};
+
+	logger_format(out, sizeof(out), "%d %x %c %s %%", args);
+	TEST_ASSERT_EQUAL_STRING("-42 beef k str %", out);
+
+	logger_format(out, sizeof(out), "[%5d][%08X][%03d]", args);
+	TEST_ASSERT_EQUAL_STRING("[  -42][0000BEEF][107]", out);
+}
+
+void test_logger_format_truncates(void) {
+	char out[6];
+	const uint32_t args[1] = {123456};
+
+	TEST_ASSERT_EQUAL_UINT32(5, logger_format(out, sizeof(out), "n=%u", args));
+	TEST_ASSERT_EQUAL_STRING("n=123", out);
+}
+
+void test_logger_record_and_flush(void) {
+	logger_flush();
+	TEST_ASSERT_TRUE(LOG("logger test %u of %u\n\r", 1, 2));
+	TEST_ASSERT_TRUE(LOG("logger test without arguments\n\r"));
+	TEST_ASSERT_EQUAL_UINT32(2, logger_flush());
+	TEST_ASSERT_EQUAL_UINT32(0, logger_flush());
+}
+
+void test_logger_full_buffer(void) {
+	uint32_t i, dropped = logger_dropped();
+
+	for (i = 0; i < LOGGER_RECORDS; i++) {
+		TEST_ASSERT_TRUE(LOG("record %u\n\r", i));
+	}
+	TEST_ASSERT_FALSE(LOG("one too many\n\r"));
+	TEST_ASSERT_EQUAL_UINT32(dropped + 1, logger_dropped());
+	TEST_ASSERT_EQUAL_UINT32(LOGGER_RECORDS, logger_flush());
+}
+
+void test_logger_append_crc(void) {
+	char line[20] = "adc 3: 127\n\r";
+	char small[14] = "adc 3: 127\n\r";
+
+	TEST_ASSERT_EQUAL_UINT32(17, logger_append_crc(line, sizeof(line)));
+	TEST_ASSERT_EQUAL_STRING("adc 3: 127*C12E\n\r", line);
+	// no room, the line stays
+	TEST_ASSERT_EQUAL_UINT32(12, logger_append_crc(small, sizeof(small)));
+	TEST_ASSERT_EQUAL_STRING("adc 3: 127\n\r", small);
+}
@@ -0,0 +1,16 @@
+/*
+ * Logger unit tests
+ *
+ * Date:	14 October 2026
+ */
+
+#ifndef TEST_LOGGER_H_
+#define TEST_LOGGER_H_
+
+void test_logger_format(void);
+void test_logger_format_truncates(void);
+void test_logger_record_and_flush(void);
+void test_logger_full_buffer(void);
+void test_logger_append_crc(void);
+
+#endif /* TEST_LOGGER_H_ */
@@ -11,6 +11,11 @@
 #include "unity/unity.h"
 #include "sam3x8e/pmc.h"
 #include "sam3x8e/pio.h"
+#include "sam3x8e/pio_fast.h"
+#include "sam3x8e/pio_irq.h"
+#include "sam3x8e/pio_capture.h"
+#include "sam3x8e/delay.h"
+#include "test_cycles.h"
 #include "test_pio.h"
 
 void test_pio_enable_pin(void) {
@@ -138,3 +143,148 @@ void test_pio_conf_multiple_pins(void){
 
 
 
+
+#define TOGGLE_COUNT	(1000u)
+
+void test_pio_toggle_rate(void) {
+	static const pio_fast_pin_t pin = PIO_FAST_PIN(PIOB, 17);
+	uint32_t slow, fast, i;
+
+	pio_enable_pin(PIOB, 17);
+	pio_conf_pin(PIOB, 17, 0, 0);
+
+	// toggle with pio.c
+	test_cycles_start();
+	for (i = 0; i < TOGGLE_COUNT; i++) {
+		pio_set_pin(PIOB, 17, 1);
+		pio_set_pin(PIOB, 17, 0);
+	}
+	slow = test_cycles_read();
+
+	// toggle with pio_fast.h
+	test_cycles_start();
+	for (i = 0; i < TOGGLE_COUNT; i++) {
+		pio_fast_set(pin);
+		pio_fast_clear(pin);
+	}
+	fast = test_cycles_read();
+
+	test_cycles_print_rate("pio_set_pin: ", TOGGLE_COUNT, slow, " toggles/s");
+	test_cycles_print_rate("pio_fast:    ", TOGGLE_COUNT, fast, " toggles/s");
+
+	pio_fast_set(pin);
+	TEST_ASSERT_TRUE(PIOB->PIO_ODSR & pin.mask);
+	pio_fast_toggle(pin);
+	TEST_ASSERT_FALSE(PIOB->PIO_ODSR & pin.mask);
+	pio_fast_write(pin, 1);
+	TEST_ASSERT_TRUE(PIOB->PIO_ODSR & pin.mask);
+	pio_fast_clear(pin);
+	TEST_ASSERT_FALSE(PIOB->PIO_ODSR & pin.mask);
+
+	pio_disable_pin(PIOB, 17);
+
+	TEST_ASSERT_TRUE(fast < slow);
+}
+
+static volatile uint32_t irq_count;
+
+static void count_irq(pio_reg_t *port, uint32_t pin, void *arg) {
+	(void) port;
+	(void) arg;
+	if (pin == 17) {
+		irq_count++;
+	}
+}
+
+void test_pio_interrupt(void) {
+	pmc_enable_peripheral_clock(ID_PIOB);
+	pio_enable_pin(PIOB, 17);
+	pio_conf_pin(PIOB, 17, 0, 0);
+	pio_set_pin(PIOB, 17, 0);
+	irq_count = 0;
+
+	TEST_ASSERT_TRUE(pio_attach_interrupt(PIOB, 17, PIO_IRQ_RISING_EDGE,
+			count_irq, 0));
+	TEST_ASSERT_FALSE(pio_attach_interrupt(PIOB, 32, PIO_IRQ_RISING_EDGE,
+			count_irq, 0));
+
+	// the input change detection also sees the output level of the pin
+	pio_set_pin(PIOB, 17, 1);
+	delay_ms(1);
+	pio_set_pin(PIOB, 17, 0);	// falling edge, should be ignored
+	delay_ms(1);
+	TEST_ASSERT_EQUAL_UINT32(1, irq_count);
+
+	pio_detach_interrupt(PIOB, 17);
+	pio_set_pin(PIOB, 17, 1);
+	delay_ms(1);
+	TEST_ASSERT_EQUAL_UINT32(1, irq_count);
+
+	pio_set_pin(PIOB, 17, 0);
+	pio_disable_pin(PIOB, 17);
+	pmc_disable_peripheral_clock(ID_PIOB);
+}
+
+static uint8_t stop_capture(void *half, uint32_t index) {
+	(void) half;
+	(void) index;
+	return 0;
+}
+
+void test_pio_capture(void) {
+	pio_capture_t cap;
+	uint8_t buffer[8];
+
+	// invalid configurations
+	TEST_ASSERT_FALSE(pio_capture_init(&cap, PIOD, 0, 3,
+			PIO_CAPTURE_ALWAYS, PIOB, 17, PIO_CAPTURE_RISING));
+	TEST_ASSERT_FALSE(pio_capture_init(&cap, PIOD, 25, PIO_CAPTURE_BYTE,
+			PIO_CAPTURE_ALWAYS, PIOB, 17, PIO_CAPTURE_RISING));
+	TEST_ASSERT_TRUE(pio_capture_init(&cap, PIOD, 0, PIO_CAPTURE_BYTE,
+			PIO_CAPTURE_ALWAYS, PIOB, 17, PIO_CAPTURE_RISING));
+	TEST_ASSERT_EQUAL_UINT32(0xFF, cap.data_mask);
+
+	// a clock that never toggles must time out
+	pmc_enable_peripheral_clock(ID_PIOB);
+	pio_enable_pin(PIOB, 17);
+	pio_conf_pin(PIOB, 17, 0, 0);
+	pio_set_pin(PIOB, 17, 0);
+	pio_capture_set_timeout(&cap, 1000);
+	TEST_ASSERT_FALSE(pio_capture_start(&cap, buffer, 4, stop_capture));
+
+	pio_disable_pin(PIOB, 17);
+	pmc_disable_peripheral_clock(ID_PIOB);
+}
+
+void test_pio_apply_config(void) {
+	const pio_pin_cfg_t table[] = {
+		{PIOD, 0, PIO_CFG_OUTPUT, PIO_CFG_HIGH},
+		{PIOD, 1, PIO_CFG_INPUT, PIO_CFG_PULLUP},
+		{PIOB, 15, PIO_CFG_OUTPUT, 0},
+		{PIOB, 16, PIO_CFG_PERIPH_B, 0},
+		{PIOB, 15, PIO_CFG_OUTPUT, PIO_CFG_HIGH}	// overrides the first PB15
+	};
+	const pio_pin_cfg_t invalid[] = {
+		{PIOD, 32, PIO_CFG_OUTPUT, 0}
+	};
+
+	TEST_ASSERT_FALSE(pio_apply_config(invalid, 1));
+	TEST_ASSERT_TRUE(pio_apply_config(table, 5));
+
+	TEST_ASSERT_TRUE(PIOD->PIO_PSR & (0x1u << 0));
+	TEST_ASSERT_TRUE(PIOD->PIO_OSR & (0x1u << 0));
+	TEST_ASSERT_TRUE(PIOD->PIO_ODSR & (0x1u << 0));
+	TEST_ASSERT_FALSE(PIOD->PIO_OSR & (0x1u << 1));
+	TEST_ASSERT_FALSE(PIOD->PIO_PUSR & (0x1u << 1));	// 0 = pull-up enabled
+	TEST_ASSERT_TRUE(PIOB->PIO_ODSR & (0x1u << 15));
+	TEST_ASSERT_FALSE(PIOB->PIO_PSR & (0x1u << 16));
+	TEST_ASSERT_TRUE(PIOB->PIO_ABSR & (0x1u << 16));
+
+	// reset
+	pio_set_pin(PIOD, 0, 0);
+	pio_set_pin(PIOB, 15, 0);
+	pio_disable_pin(PIOD, 0);
+	pio_disable_pin(PIOD, 1);
+	pio_disable_pin(PIOB, 15);
+	PIOB->PIO_ABSR &= ~(0x1u << 16);
+}
@@ -19,5 +19,9 @@ void test_pio_read_pin(void);	//testing pio_read_*
 void test_pio_set_output(void);	//testing pio_set_*
 void test_pio_set_outputs(void);
 void test_pio_conf_multiple_pins(void);
+void test_pio_toggle_rate(void);	// pio.c vs pio_fast.h
+void test_pio_interrupt(void);	// testing pio_attach_interrupt
+void test_pio_capture(void);	// testing pio_capture_*
+void test_pio_apply_config(void);
 
 #endif /* TEST_PIO_H_ */
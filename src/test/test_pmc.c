@@ -8,6 +8,7 @@
 
 #include "unity/unity.h"
 #include "sam3x8e/pmc.h"
+#include "sam3x8e/eefc.h"
 #include "test/test_pmc.h"
 
 /*
@@ -99,3 +100,51 @@ void test_pmc_PWM_disabled2(void) {
 	// The peripheral should be disabled by now!
 	TEST_ASSERT_FALSE(pmc_peripheral_clock_enabled(ID_PWM));
 }
+
+/*
+ * The clock of PIOB stays enabled until its last user releases it.
+ */
+void test_pmc_clock_users(void) {
+	TEST_ASSERT_EQUAL_UINT32(1, pmc_acquire_peripheral_clock(ID_PIOB));
+	TEST_ASSERT_EQUAL_UINT32(2, pmc_acquire_peripheral_clock(ID_PIOB));
+	TEST_ASSERT_TRUE(pmc_peripheral_clock_enabled(ID_PIOB));
+	TEST_ASSERT_EQUAL_UINT32(1, pmc_release_peripheral_clock(ID_PIOB));
+	TEST_ASSERT_TRUE(pmc_peripheral_clock_enabled(ID_PIOB));
+	TEST_ASSERT_EQUAL_UINT32(0, pmc_release_peripheral_clock(ID_PIOB));
+	TEST_ASSERT_FALSE(pmc_peripheral_clock_enabled(ID_PIOB));
+	// a clock without users is left as it is
+	TEST_ASSERT_EQUAL_UINT32(0, pmc_release_peripheral_clock(ID_PIOB));
+	TEST_ASSERT_EQUAL_UINT32(0, pmc_acquire_peripheral_clock(ID_MAX + 1));
+}
+
+static uint32_t notified_mck;
+
+static void notifier(uint32_t mck) {
+	notified_mck = mck;
+}
+
+/*
+ * Each clock profile sets its master clock and the fewest Flash Wait States,
+ * and the notifiers are called with the new frequency. It ends with the
+ * default profile again.
+ */
+void test_pmc_clock_profiles(void) {
+	static const uint32_t freqs[PMC_PROFILES] = {
+		84000000u, 48000000u, 12000000u, 4000000u
+	};
+	uint32_t profile;
+
+	TEST_ASSERT_TRUE(pmc_add_clock_notifier(notifier));
+	TEST_ASSERT_EQUAL_UINT32(PMC_PROFILE_84MHZ, pmc_get_clock_profile());
+	for (profile = PMC_PROFILES; profile-- > 0;) {
+		notified_mck = 0;
+		TEST_ASSERT_TRUE(pmc_set_clock_profile(profile));
+		TEST_ASSERT_EQUAL_UINT32(profile, pmc_get_clock_profile());
+		TEST_ASSERT_EQUAL_UINT32(freqs[profile], pmc_get_mck_freq());
+		TEST_ASSERT_EQUAL_UINT32(freqs[profile], notified_mck);
+		TEST_ASSERT_EQUAL_UINT32(eefc_wait_states(freqs[profile]),
+				(EEFC0->EEFC_FMR >> 8) & 0xFu);
+	}
+	TEST_ASSERT_FALSE(pmc_set_clock_profile(PMC_PROFILES));
+	TEST_ASSERT_EQUAL_UINT32(SYS_CLK_FREQ, pmc_get_mck_freq());
+}
@@ -14,6 +14,8 @@ void test_pmc_enable_PIOB(void);
 void test_pmc_PIOB_enabled(void);
 void test_pmc_disable_PIOB(void);
 void test_pmc_PIOB_disabled2(void);
+void test_pmc_clock_users(void);
+void test_pmc_clock_profiles(void);
 
 void test_pmc_PWM_disabled1(void);
 void test_pmc_enable_PWM(void);
@@ -10,6 +10,7 @@
 
 #include "sam3x8e/pmc.h"
 #include "sam3x8e/pwm.h"
+#include "sam3x8e/delay.h"
 #include "unity/unity.h"
 #include "test_pwm.h"
 
@@ -95,3 +96,207 @@ void test_pwm_set_frequency(){
 	TEST_ASSERT_EQUAL_UINT32(3360,
 					pwm_get_channel_period(PWM_CHANNEL_3));
 }
+
+void test_pwm_set_event_rate(){
+	pwm_reset_peripheral();
+	TEST_ASSERT_EQUAL_UINT32(0, pwm_set_event_rate(2, 25000));
+	TEST_ASSERT_EQUAL_UINT32(0, pwm_set_event_rate(PWM_EVENT_LINE_1, 0));
+	TEST_ASSERT_EQUAL_UINT32(25000,
+			pwm_set_event_rate(PWM_EVENT_LINE_1, 25000));
+	TEST_ASSERT_EQUAL_UINT32(3360, pwm_get_channel_period(PWM_CHANNEL_0));
+	TEST_ASSERT_EQUAL_HEX32(0x2, PWM->PWM_ELMR1 & PWM_ELMRx_CSEL_MASK);
+	TEST_ASSERT_BITS_HIGH(PWM_CMPMx_CEN_MASK, PWM->PWM_CMPM1);
+	TEST_ASSERT_BITS_HIGH((1<<PWM_CHANNEL_0), PWM->PWM_SR);
+	pwm_reset_peripheral();
+	TEST_ASSERT_EQUAL_HEX32(0, PWM->PWM_ELMR1);
+}
+
+void test_pwm_solve_timing(){
+	static const pwm_timing_t table[] = {
+		PWM_TIMING(25000, PWM_DUTY(1, 4), PWM_CHANNEL_ALIGN_LEFT),
+		PWM_TIMING(50, PWM_DUTY(1, 2), PWM_CHANNEL_ALIGN_CENTER)
+	};
+	pwm_timing_t timing;
+
+	TEST_ASSERT_TRUE(pwm_solve_timing(25000, PWM_DUTY(1, 4),
+			PWM_CHANNEL_ALIGN_LEFT, &timing));
+	TEST_ASSERT_EQUAL_UINT32(3360, timing.period);
+	TEST_ASSERT_EQUAL_UINT32(840, timing.duty_cycle);
+	TEST_ASSERT_EQUAL_UINT32(PWM_PRES_MCK_DIV_1, timing.prescaler);
+	TEST_ASSERT_EQUAL_UINT32(table[0].period, timing.period);
+	TEST_ASSERT_EQUAL_UINT32(table[0].duty_cycle, timing.duty_cycle);
+
+	// 840000 cycles per half period need MCK/16
+	TEST_ASSERT_TRUE(pwm_solve_timing(50, PWM_DUTY(1, 2),
+			PWM_CHANNEL_ALIGN_CENTER, &timing));
+	TEST_ASSERT_EQUAL_UINT32(PWM_PRES_MCK_DIV_16, timing.prescaler);
+	TEST_ASSERT_EQUAL_UINT32(52500, timing.period);
+	TEST_ASSERT_EQUAL_UINT32(26250, timing.duty_cycle);
+	TEST_ASSERT_EQUAL_UINT32(table[1].prescaler, timing.prescaler);
+	TEST_ASSERT_EQUAL_UINT32(table[1].period, timing.period);
+
+	TEST_ASSERT_FALSE(pwm_solve_timing(0, 0, PWM_CHANNEL_ALIGN_LEFT, &timing));
+	TEST_ASSERT_FALSE(pwm_solve_timing(1, 0, PWM_CHANNEL_ALIGN_LEFT, &timing));
+}
+
+void test_pwm_apply_timing(){
+	pwm_timing_t timing;
+
+	pwm_reset_peripheral();
+	pwm_solve_timing(25000, PWM_DUTY(1, 4), PWM_CHANNEL_ALIGN_LEFT, &timing);
+	TEST_ASSERT_TRUE(pwm_apply_timing(PWM_CHANNEL_3, &timing));
+	TEST_ASSERT_EQUAL_UINT32(3360, pwm_get_channel_period(PWM_CHANNEL_3));
+	TEST_ASSERT_EQUAL_UINT32(840, pwm_read_channel(PWM_CHANNEL_3));
+	pwm_enable_channel(PWM_CHANNEL_3);
+
+	// Same prescaler, the channel keeps running
+	pwm_solve_timing(30000, PWM_DUTY(1, 2), PWM_CHANNEL_ALIGN_LEFT, &timing);
+	TEST_ASSERT_TRUE(pwm_apply_timing(PWM_CHANNEL_3, &timing));
+	TEST_ASSERT_TRUE(pwm_channel_enabled(PWM_CHANNEL_3));
+	delay_micros(100);
+	TEST_ASSERT_EQUAL_UINT32(2800, pwm_get_channel_period(PWM_CHANNEL_3));
+	TEST_ASSERT_EQUAL_UINT32(1400, pwm_read_channel(PWM_CHANNEL_3));
+
+	// Another prescaler, the channel is restarted
+	pwm_solve_timing(100, PWM_DUTY(1, 2), PWM_CHANNEL_ALIGN_LEFT, &timing);
+	TEST_ASSERT_TRUE(pwm_apply_timing(PWM_CHANNEL_3, &timing));
+	TEST_ASSERT_TRUE(pwm_channel_enabled(PWM_CHANNEL_3));
+	TEST_ASSERT_EQUAL_UINT32(timing.prescaler,
+			pwm_get_channel_prescaler(PWM_CHANNEL_3));
+	TEST_ASSERT_FALSE(pwm_apply_timing(8, &timing));
+	pwm_reset_peripheral();
+}
+
+void test_pwm_sync_channels(){
+	pwm_reset_peripheral();
+	TEST_ASSERT_FALSE(pwm_sync_channels(0x100, PWM_SYNC_UPDATE_MANUAL, 0));
+	TEST_ASSERT_FALSE(pwm_sync_channels(0x6, 3, 0));
+	TEST_ASSERT_FALSE(pwm_sync_channels(0x6, PWM_SYNC_UPDATE_AUTO, 16));
+
+	// Channel 0 is always part of the group
+	TEST_ASSERT_TRUE(pwm_sync_channels(0x6, PWM_SYNC_UPDATE_AUTO, 3));
+	TEST_ASSERT_EQUAL_HEX32(0x7, PWM->PWM_SCM & PWM_SCM_SYNC_MASK);
+	TEST_ASSERT_EQUAL_HEX32(PWM_SYNC_UPDATE_AUTO << 16,
+			PWM->PWM_SCM & PWM_SCM_UPDM_MASK);
+	TEST_ASSERT_EQUAL_UINT32(3, PWM->PWM_SCUP & PWM_SCUP_UPR_MASK);
+
+	// Not in PDC mode
+	static uint16_t duties[2];
+	TEST_ASSERT_FALSE(pwm_sync_dma_start(duties, 1, 0));
+	TEST_ASSERT_TRUE(pwm_sync_update());
+	pwm_reset_peripheral();
+	TEST_ASSERT_EQUAL_HEX32(0, PWM->PWM_SCM);
+}
+
+void test_pwm_sync_dma(){
+	// Two updates per half, a duty cycle for channel 0 and 1 in each
+	static uint16_t duties[2 * 2 * 2] = {
+		 840, 1680,  840, 1680,
+		 840, 1680,  840, 1680 };
+
+	pwm_reset_peripheral();
+	TEST_ASSERT_EQUAL_UINT32(1, pwm_set_channel_frequency(PWM_CHANNEL_0, 25000));
+	TEST_ASSERT_TRUE(pwm_sync_channels(1<<PWM_CHANNEL_1, PWM_SYNC_UPDATE_PDC, 0));
+	TEST_ASSERT_FALSE(pwm_sync_dma_start(0, 2, 0));
+	TEST_ASSERT_FALSE(pwm_sync_dma_start(duties, 0, 0));
+	TEST_ASSERT_TRUE(pwm_sync_dma_start(duties, 2, 0));
+	pwm_enable_channel(PWM_CHANNEL_0);
+
+	// 40 us per period, one update per period
+	delay_micros(1000);
+	pwm_sync_dma_stop();
+	TEST_ASSERT_TRUE(pwm_sync_dma_halves() > 4);
+	TEST_ASSERT_BITS_HIGH((1<<PWM_CHANNEL_1), PWM->PWM_SR);
+	TEST_ASSERT_EQUAL_UINT32(840, pwm_read_channel(PWM_CHANNEL_0));
+	TEST_ASSERT_EQUAL_UINT32(1680, pwm_read_channel(PWM_CHANNEL_1));
+	pwm_reset_peripheral();
+}
+
+void test_pwm_dead_time(){
+	pwm_reset_peripheral();
+	pwm_set_channel_period(PWM_CHANNEL_2, 1000);
+	pwm_set_channel_duty_cycle(PWM_CHANNEL_2, 400);
+	// Longer than the low or the high part of the period
+	TEST_ASSERT_FALSE(pwm_set_channel_dead_time(PWM_CHANNEL_2, 601, 10));
+	TEST_ASSERT_FALSE(pwm_set_channel_dead_time(PWM_CHANNEL_2, 10, 401));
+	TEST_ASSERT_FALSE(pwm_set_channel_dead_time(8, 10, 10));
+	TEST_ASSERT_TRUE(pwm_set_channel_dead_time(PWM_CHANNEL_2, 20, 30));
+	TEST_ASSERT_BITS_HIGH(PWM_CMRx_DTE_MASK, PWM->PWM_CMR2);
+	TEST_ASSERT_EQUAL_HEX32(20 | (30 << 16), PWM->PWM_DT2);
+
+	// The polarity must not touch the dead-time or the prescaler
+	pwm_set_channel_prescaler(PWM_CHANNEL_2, PWM_PRES_MCK_DIV_8);
+	pwm_set_channel_polarity(PWM_CHANNEL_2, PWM_CHANNEL_POLARITY_HIGH);
+	TEST_ASSERT_BITS_HIGH(PWM_CMRx_DTE_MASK, PWM->PWM_CMR2);
+	TEST_ASSERT_EQUAL_UINT32(PWM_PRES_MCK_DIV_8,
+			pwm_get_channel_prescaler(PWM_CHANNEL_2));
+
+	TEST_ASSERT_TRUE(pwm_set_channel_dead_time(PWM_CHANNEL_2, 0, 0));
+	TEST_ASSERT_BITS_LOW(PWM_CMRx_DTE_MASK, PWM->PWM_CMR2);
+	pwm_reset_peripheral();
+}
+
+void test_pwm_fault(){
+	pwm_reset_peripheral();
+	TEST_ASSERT_FALSE(pwm_set_fault_mode(0x100, 0, 0));
+	TEST_ASSERT_TRUE(pwm_set_fault_mode(PWM_FAULT_INPUT_0,
+			PWM_FAULT_INPUT_0 | PWM_FAULT_INPUT_1, PWM_FAULT_INPUT_1));
+	TEST_ASSERT_EQUAL_HEX32(0x00020301, PWM->PWM_FMR);
+
+	TEST_ASSERT_FALSE(pwm_set_channel_fault(8, PWM_FAULT_INPUT_0,
+			PWM_FAULT_OUTPUT_LOW, PWM_FAULT_OUTPUT_LOW));
+	TEST_ASSERT_FALSE(pwm_set_channel_fault(PWM_CHANNEL_1, PWM_FAULT_INPUT_0,
+			2, PWM_FAULT_OUTPUT_LOW));
+	TEST_ASSERT_TRUE(pwm_set_channel_fault(PWM_CHANNEL_1,
+			PWM_FAULT_INPUT_0 | PWM_FAULT_INPUT_1, PWM_FAULT_OUTPUT_LOW,
+			PWM_FAULT_OUTPUT_HIGH));
+	TEST_ASSERT_TRUE(pwm_set_channel_fault(PWM_CHANNEL_5, PWM_FAULT_INPUT_2,
+			PWM_FAULT_OUTPUT_HIGH, PWM_FAULT_OUTPUT_LOW));
+	TEST_ASSERT_EQUAL_HEX32(0x00000300, PWM->PWM_FPE1);
+	TEST_ASSERT_EQUAL_HEX32(0x00000400, PWM->PWM_FPE2);
+	TEST_ASSERT_EQUAL_HEX32((1 << 5) | (1 << (16 + 1)), PWM->PWM_FPV);
+	TEST_ASSERT_TRUE(pwm_clear_fault(PWM_FAULT_INPUT_ALL));
+	pwm_reset_peripheral();
+	TEST_ASSERT_EQUAL_HEX32(0, PWM->PWM_FPE1);
+	TEST_ASSERT_EQUAL_HEX32(0, PWM->PWM_FMR);
+}
+
+void test_pwm_event_compare(){
+	pwm_reset_peripheral();
+	TEST_ASSERT_FALSE(pwm_set_event_compare(2, 2, 100, 0));
+	TEST_ASSERT_FALSE(pwm_set_event_compare(PWM_EVENT_LINE_0, 8, 100, 0));
+	TEST_ASSERT_FALSE(pwm_set_event_compare(PWM_EVENT_LINE_0, 2, 100, 2));
+	TEST_ASSERT_TRUE(pwm_set_event_compare(PWM_EVENT_LINE_0, 2, 100, 1));
+	TEST_ASSERT_TRUE(pwm_set_event_compare(PWM_EVENT_LINE_0, 3, 200, 0));
+	TEST_ASSERT_EQUAL_HEX32(100 | PWM_CMPVx_CVM_MASK, PWM->PWM_CMPV2);
+	TEST_ASSERT_EQUAL_HEX32(200, PWM->PWM_CMPV3);
+	TEST_ASSERT_BITS_HIGH(PWM_CMPMx_CEN_MASK, PWM->PWM_CMPM2);
+	TEST_ASSERT_EQUAL_HEX32((1 << 2) | (1 << 3), PWM->PWM_ELMR0);
+	pwm_reset_peripheral();
+	TEST_ASSERT_EQUAL_HEX32(0, PWM->PWM_CMPM3);
+}
+
+void test_pwm_set_duty_cycles(){
+	const uint32_t duties[8] = { 100, 200, 300, 400, 500, 600, 700, 800 };
+	const uint32_t next[8] = { 150, 250, 350, 450, 550, 650, 750, 850 };
+
+	pwm_reset_peripheral();
+	TEST_ASSERT_FALSE(pwm_set_duty_cycles(0x100, duties));
+	TEST_ASSERT_FALSE(pwm_set_duty_cycles(0x3, 0));
+
+	// Disabled channels are written at once, channel 2 is not in the mask
+	TEST_ASSERT_TRUE(pwm_set_duty_cycles(0xFB, duties));
+	TEST_ASSERT_EQUAL_UINT32(100, pwm_read_channel(PWM_CHANNEL_0));
+	TEST_ASSERT_EQUAL_UINT32(0, pwm_read_channel(PWM_CHANNEL_2));
+	TEST_ASSERT_EQUAL_UINT32(800, pwm_read_channel(PWM_CHANNEL_7));
+
+	// Synchronous channels take the new duty cycles together
+	TEST_ASSERT_EQUAL_UINT32(1, pwm_set_channel_frequency(PWM_CHANNEL_0, 25000));
+	TEST_ASSERT_TRUE(pwm_sync_channels(0x3, PWM_SYNC_UPDATE_MANUAL, 0));
+	pwm_enable_channel(PWM_CHANNEL_0);
+	TEST_ASSERT_TRUE(pwm_set_duty_cycles(0x3, next));
+	delay_micros(100);
+	TEST_ASSERT_EQUAL_UINT32(150, pwm_read_channel(PWM_CHANNEL_0));
+	TEST_ASSERT_EQUAL_UINT32(250, pwm_read_channel(PWM_CHANNEL_1));
+	pwm_reset_peripheral();
+}
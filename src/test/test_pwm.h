@@ -18,6 +18,15 @@ void test_pwm_channel_alignment(void);
 void test_pwm_channel_period(void);
 void test_pwm_set_clkx(void);
 void test_pwm_set_frequency(void);
+void test_pwm_set_event_rate(void);
+void test_pwm_solve_timing(void);
+void test_pwm_apply_timing(void);
+void test_pwm_sync_channels(void);
+void test_pwm_sync_dma(void);
+void test_pwm_dead_time(void);
+void test_pwm_fault(void);
+void test_pwm_event_compare(void);
+void test_pwm_set_duty_cycles(void);
 
 #endif
 
@@ -0,0 +1,123 @@
+/*
+ * Ring buffer unit tests
+ *
+ * Date:	14 October 2026
+ */
+
+#include "unity/unity.h"
+#include "sam3x8e/ring.h"
+#include "test/test_ring.h"
+
+static uint8_t data[16];
+static ring_cell_t cells[8];
+
+void test_ring_push_pop(void) {
+	ring_t ring;
+	uint8_t byte;
+	uint32_t i;
+
+	TEST_ASSERT_FALSE(ring_init(&ring, data, 12));
+	TEST_ASSERT_TRUE(ring_init(&ring, data, sizeof(data)));
+	TEST_ASSERT_FALSE(ring_pop(&ring, &byte));
+	for (i = 0; i < sizeof(data); i++) {
+		TEST_ASSERT_TRUE(ring_push(&ring, (uint8_t) i));
+	}
+	TEST_ASSERT_FALSE(ring_push(&ring, 0xAA));
+	TEST_ASSERT_EQUAL_UINT32(16, ring_count(&ring));
+	TEST_ASSERT_EQUAL_UINT32(0, ring_space(&ring));
+	byte = 0xFF;
+	TEST_ASSERT_TRUE(ring_peek(&ring, &byte));
+	TEST_ASSERT_EQUAL_UINT8(0, byte);
+	for (i = 0; i < sizeof(data); i++) {
+		byte = 0xFF;
+		TEST_ASSERT_TRUE(ring_pop(&ring, &byte));
+		TEST_ASSERT_EQUAL_UINT8(i, byte);
+	}
+	TEST_ASSERT_FALSE(ring_pop(&ring, &byte));
+	TEST_ASSERT_EQUAL_UINT32(0, ring_count(&ring));
+}
+
+/*
+ * Bulk writes and reads across the end of the buffer, the indices past
+ * their wrap from 0xFFFFFFFF to 0.
+ */
+void test_ring_bulk(void) {
+	ring_t ring = RING_INIT(data, sizeof(data));
+	const uint8_t src[20] = {
+		1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20
+	};
+	uint8_t dst[20];
+	uint32_t i;
+
+	ring.head = ring.tail = 0xFFFFFFF6u;
+	TEST_ASSERT_EQUAL_UINT32(16, ring_write(&ring, src, sizeof(src)));
+	TEST_ASSERT_EQUAL_UINT32(0, ring_write(&ring, src, 1));
+	TEST_ASSERT_EQUAL_UINT32(5, ring_read(&ring, dst, 5));
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(src, dst, 5);
+	TEST_ASSERT_EQUAL_UINT32(4, ring_write(&ring, src + 16, 4));
+	TEST_ASSERT_EQUAL_UINT32(15, ring_read(&ring, dst, sizeof(dst)));
+	for (i = 0; i < 15; i++) {
+		TEST_ASSERT_EQUAL_UINT8(src[5 + i], dst[i]);
+	}
+	TEST_ASSERT_EQUAL_UINT32(0, ring_count(&ring));
+}
+
+/*
+ * The spans stop at the end of the buffer and at the other side's index.
+ */
+void test_ring_spans(void) {
+	ring_t ring = RING_INIT(data, sizeof(data));
+	const uint8_t *in;
+	uint8_t *out;
+	uint32_t i;
+
+	ring.head = ring.tail = 10;
+	TEST_ASSERT_EQUAL_UINT32(6, ring_write_span(&ring, &out));
+	TEST_ASSERT_EQUAL_PTR(data + 10, out);
+	for (i = 0; i < 6; i++) {
+		out[i] = (uint8_t) i;
+	}
+	ring_write_commit(&ring, 6);
+	TEST_ASSERT_EQUAL_UINT32(10, ring_write_span(&ring, &out));
+	TEST_ASSERT_EQUAL_PTR(data, out);
+	out[0] = 6;
+	ring_write_commit(&ring, 1);
+
+	TEST_ASSERT_EQUAL_UINT32(6, ring_read_span(&ring, &in));
+	TEST_ASSERT_EQUAL_PTR(data + 10, in);
+	TEST_ASSERT_EQUAL_UINT8(0, in[0]);
+	ring_read_release(&ring, 6);
+	TEST_ASSERT_EQUAL_UINT32(1, ring_read_span(&ring, &in));
+	TEST_ASSERT_EQUAL_UINT8(6, in[0]);
+	ring_read_release(&ring, 1);
+	TEST_ASSERT_EQUAL_UINT32(0, ring_read_span(&ring, &in));
+}
+
+void test_ring_mpsc(void) {
+	ring_mpsc_t queue;
+	uint32_t values[8];
+	uint32_t value, lap, i;
+
+	TEST_ASSERT_FALSE(ring_mpsc_init(&queue, cells, 6));
+	TEST_ASSERT_TRUE(ring_mpsc_init(&queue, cells, 8));
+	TEST_ASSERT_FALSE(ring_mpsc_pop(&queue, &value));
+	// a few laps, the cells are freed for the next one
+	for (lap = 0; lap < 3; lap++) {
+		for (i = 0; i < 8; i++) {
+			TEST_ASSERT_TRUE(ring_mpsc_push(&queue, 100 * lap + i));
+		}
+		TEST_ASSERT_FALSE(ring_mpsc_push(&queue, 0));
+		TEST_ASSERT_EQUAL_UINT32(lap + 1, queue.dropped);
+		TEST_ASSERT_EQUAL_UINT32(8, ring_mpsc_count(&queue));
+		value = 0xFFFFFFFFu;
+		TEST_ASSERT_TRUE(ring_mpsc_pop(&queue, &value));
+		TEST_ASSERT_EQUAL_UINT32(100 * lap, value);
+		TEST_ASSERT_EQUAL_UINT32(7, ring_mpsc_pop_n(&queue, values, 8));
+		for (i = 0; i < 7; i++) {
+			TEST_ASSERT_EQUAL_UINT32(100 * lap + i + 1, values[i]);
+		}
+	}
+	// a claimed cell that is not yet written holds up the consumer
+	queue.head++;
+	TEST_ASSERT_FALSE(ring_mpsc_pop(&queue, &value));
+}
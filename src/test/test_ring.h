@@ -0,0 +1,15 @@
+/*
+ * Ring buffer unit tests
+ *
+ * Date:	14 October 2026
+ */
+
+#ifndef TEST_RING_H_
+#define TEST_RING_H_
+
+void test_ring_push_pop(void);
+void test_ring_bulk(void);
+void test_ring_spans(void);
+void test_ring_mpsc(void);
+
+#endif /* TEST_RING_H_ */
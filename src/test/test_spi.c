@@ -19,6 +19,13 @@
 #include "sam3x8e/spi.h"
 #include "test/test_spi.h"
 #include "sam3x8e/delay.h"
+#include "sam3x8e/dmac.h"
+#include "sam3x8e/spi_queue.h"
+#include "test_cycles.h"
+#include "test_bench.h"
+
+#define DMA_TEST_LENGTH		(64)
+#define DMA_BENCH_LENGTH	(1024)
 
 void spi_setup(void) {
 	pmc_enable_peripheral_clock(ID_SPI0);
@@ -258,3 +265,320 @@ void test_spi_baud_rate_change(void) {
 	delay_ms(1);
 	TEST_ASSERT_EQUAL_HEX32(data1, spi_read(SPI0));
 }
+
+static volatile uint8_t transfer_callbacks;
+
+static void count_transfer(spi_reg_t *spi) {
+	(void) spi;
+	transfer_callbacks++;
+}
+
+/*
+ * Selector 0 with 8 bits and no delays, as fast as the loopback allows.
+ */
+static void spi_dma_selector_init(uint32_t bits) {
+	spi_set_selector_bit_length(SPI0, SPI_SELECTOR_0, bits);
+	spi_set_selector_baud_rate(SPI0, SPI_SELECTOR_0, 2);
+	spi_set_selector_delay_transfers(SPI0, SPI_SELECTOR_0, 0);
+	spi_set_selector_delay_clk_start(SPI0, SPI_SELECTOR_0, 0);
+}
+
+void test_spi_transfer_dma(void) {
+	uint8_t tx[DMA_TEST_LENGTH], rx[DMA_TEST_LENGTH];
+	uint16_t tx16[DMA_TEST_LENGTH], rx16[DMA_TEST_LENGTH];
+	uint32_t i, timeout;
+
+	dmac_init();
+	spi_dma_selector_init(SPI_BITS_8);
+	for (i = 0; i < DMA_TEST_LENGTH; i++) {
+		tx[i] = (uint8_t) (i * 7 + 1);
+		rx[i] = 0;
+		tx16[i] = (uint16_t) (i * 1031 + 3);
+		rx16[i] = 0;
+	}
+	// Polled, bytes
+	TEST_ASSERT_TRUE(spi_transfer(SPI0, SPI_SELECTOR_0, tx, rx, DMA_TEST_LENGTH));
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(tx, rx, DMA_TEST_LENGTH);
+	// Invalid parameters
+	TEST_ASSERT_FALSE(spi_transfer(SPI0, SPI_SELECTOR_NONE, tx, rx, 1));
+	TEST_ASSERT_FALSE(spi_transfer(SPI0, SPI_SELECTOR_0, tx, rx, 0));
+	// Nothing to send, nothing to keep
+	TEST_ASSERT_TRUE(spi_transfer(SPI0, SPI_SELECTOR_0, 0, rx, DMA_TEST_LENGTH));
+	TEST_ASSERT_EQUAL_HEX8(0xFF, rx[DMA_TEST_LENGTH - 1]);
+	TEST_ASSERT_TRUE(spi_transfer(SPI0, SPI_SELECTOR_0, tx, 0, DMA_TEST_LENGTH));
+
+	// Interrupt with callback, halfwords
+	spi_dma_selector_init(SPI_BITS_16);
+	transfer_callbacks = 0;
+	TEST_ASSERT_TRUE(spi_transfer_async(SPI0, SPI_SELECTOR_0, tx16, rx16,
+			DMA_TEST_LENGTH, count_transfer));
+	TEST_ASSERT_FALSE(spi_transfer_async(SPI0, SPI_SELECTOR_0, tx16, rx16,
+			DMA_TEST_LENGTH, count_transfer));
+	for (timeout = 100; transfer_callbacks == 0 && timeout > 0; timeout--) {
+		delay_ms(1);
+	}
+	TEST_ASSERT_EQUAL_UINT8(1, transfer_callbacks);
+	TEST_ASSERT_FALSE(spi_transfer_busy());
+	TEST_ASSERT_EQUAL_HEX16_ARRAY(tx16, rx16, DMA_TEST_LENGTH);
+}
+
+void test_spi_dma_benchmark(void) {
+	static uint8_t tx[DMA_BENCH_LENGTH], rx[DMA_BENCH_LENGTH];
+	uint32_t i, word, dma;
+
+	spi_dma_selector_init(SPI_BITS_8);
+	spi_select_slave(SPI0, SPI_SELECTOR_0);
+	for (i = 0; i < DMA_BENCH_LENGTH; i++) {
+		tx[i] = (uint8_t) i;
+	}
+	// One word at a time
+	(void) spi_read(SPI0);
+	test_cycles_start();
+	for (i = 0; i < DMA_BENCH_LENGTH; i++) {
+		while (!spi_tx_ready(SPI0));
+		spi_write(SPI0, tx[i]);
+		while (!spi_rx_ready(SPI0));
+		rx[i] = (uint8_t) spi_read(SPI0);
+	}
+	word = test_cycles_read();
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(tx, rx, DMA_BENCH_LENGTH);
+
+	// One block with the DMAC
+	for (i = 0; i < DMA_BENCH_LENGTH; i++) {
+		rx[i] = 0;
+	}
+	test_cycles_start();
+	TEST_ASSERT_TRUE(spi_transfer(SPI0, SPI_SELECTOR_0, tx, rx, DMA_BENCH_LENGTH));
+	dma = test_cycles_read();
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(tx, rx, DMA_BENCH_LENGTH);
+
+	test_cycles_print_rate("spi_write/spi_read: ", DMA_BENCH_LENGTH, word, " bytes/s");
+	test_cycles_print_rate("spi_transfer:       ", DMA_BENCH_LENGTH, dma, " bytes/s");
+}
+
+static uint8_t bench_tx[DMA_TEST_LENGTH], bench_rx[DMA_TEST_LENGTH];
+
+static void spi_bench_transfer(void *arg) {
+	(void) arg;
+	spi_transfer(SPI0, SPI_SELECTOR_0, bench_tx, bench_rx, DMA_TEST_LENGTH);
+}
+
+/*
+ * Cycles of a DMA transfer of DMA_TEST_LENGTH bytes in loopback.
+ */
+void test_spi_bench_transfer(void) {
+	bench_result_t result;
+	uint32_t i;
+
+	spi_dma_selector_init(SPI_BITS_8);
+	spi_select_slave(SPI0, SPI_SELECTOR_0);
+	for (i = 0; i < DMA_TEST_LENGTH; i++) {
+		bench_tx[i] = (uint8_t) (i * 7);
+	}
+	bench_run(spi_bench_transfer, 0, 16, &result);
+	bench_print("spi_transfer", DMA_TEST_LENGTH, 16, &result);
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(bench_tx, bench_rx, DMA_TEST_LENGTH);
+}
+
+void test_spi_queue(void) {
+	uint8_t tx0[8] = { 1, 2, 3, 4, 5, 6, 7, 8 }, rx0[8] = { 0 };
+	uint16_t tx1[4] = { 0x1FF, 0x0AA, 0x155, 0x001 }, rx1[4] = { 0 };
+	uint8_t rx2[4] = { 0 };
+	spi_transaction_t t0 = { .tx = tx0, .rx = rx0, .len = 8,
+			.selector = SPI_SELECTOR_0, .flag = SPI_QUEUE_NO_FLAG };
+	spi_transaction_t t1 = { .tx = tx1, .rx = rx1, .len = 4,
+			.selector = SPI_SELECTOR_1, .flag = SPI_QUEUE_NO_FLAG };
+	spi_transaction_t t2 = { .tx = 0, .rx = rx2, .len = 4,
+			.selector = SPI_SELECTOR_0, .flag = SPI_QUEUE_NO_FLAG };
+	spi_transaction_t bad = { .len = 1, .selector = SPI_SELECTOR_NONE };
+	uint32_t timeout;
+
+	// selector 0 uses 8 bits, selector 1 still uses 9 bits
+	spi_dma_selector_init(SPI_BITS_8);
+	TEST_ASSERT_TRUE(spi_queue_init(SPI0));
+	TEST_ASSERT_TRUE(spi_queue_idle(SPI0));
+	TEST_ASSERT_FALSE(spi_queue_submit(SPI0, &bad));
+
+	TEST_ASSERT_TRUE(spi_queue_submit(SPI0, &t0));
+	TEST_ASSERT_TRUE(spi_queue_submit(SPI0, &t1));
+	TEST_ASSERT_TRUE(spi_queue_submit(SPI0, &t2));
+	for (timeout = 100; !t2.done && timeout > 0; timeout--) {
+		delay_ms(1);
+	}
+	TEST_ASSERT_TRUE(t0.done && t1.done && t2.done);
+	TEST_ASSERT_TRUE(spi_queue_idle(SPI0));
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(tx0, rx0, 8);
+	TEST_ASSERT_EQUAL_HEX16_ARRAY(tx1, rx1, 4);
+	TEST_ASSERT_EQUAL_HEX8(0xFF, rx2[3]);
+
+	// Blocking, without an event flag
+	t0.rx = rx2;
+	t0.len = 4;
+	TEST_ASSERT_TRUE(spi_queue_transfer(SPI0, &t0));
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(tx0, rx2, 4);
+
+	// back to fixed peripheral select for the other tests
+	SPI0->SPI_MR &= ~SPI_MR_PS_MASK;
+}
+
+void test_spi_selector_value(void) {
+	static const spi_selector_settings_t selector_2 = {
+		.selector = SPI_SELECTOR_2,
+		.CPOL = SPI_POLARITY_HIGH,
+		.NCPHA = SPI_PHASE_LOW,
+		.baud_rate = 8,
+		.bits_pr_transfer = SPI_BITS_9,
+		.delay_clk = 492,	// 41 MCK
+		.delay_transfers = 381	// 1 * 32 MCK
+	};
+	spi_selector_settings_t invalid = selector_2;
+
+	TEST_ASSERT_EQUAL_HEX32(0x1u | (1u << 4) | (8u << 8) | (41u << 16) |
+			(1u << 24), spi_csr_value(&selector_2));
+	// one write, the chip select option is kept
+	spi_set_selector_option(SPI0, SPI_SELECTOR_2, SPI_OPTION_KEEP_CS_ACTIVE);
+	TEST_ASSERT_TRUE(spi_init_selector(SPI0, &selector_2));
+	TEST_ASSERT_EQUAL_HEX32(spi_csr_value(&selector_2) | SPI_CSRx_CSAAT_MASK,
+			SPI0->SPI_CSR2);
+	invalid.bits_pr_transfer = 9;
+	TEST_ASSERT_FALSE(spi_init_selector(SPI0, &invalid));
+	invalid = selector_2;
+	invalid.selector = 4;
+	TEST_ASSERT_FALSE(spi_init_selector(SPI0, &invalid));
+	spi_set_selector_option(SPI0, SPI_SELECTOR_2, SPI_OPTION_DISABLE_CS_OPTIONS);
+}
+
+void test_spi_tdr_words(void) {
+	uint8_t data8[3] = { 0x12, 0x34, 0x56 };
+	uint32_t words[3];
+
+	// Without decoding, selector n is the lowest zero in PCS (xxx0, xx01, ...)
+	TEST_ASSERT_EQUAL_HEX32(0x000000AB, spi_tdr_word(SPI0, SPI_SELECTOR_0, 0xAB, 0));
+	TEST_ASSERT_EQUAL_HEX32(0x01010001, spi_tdr_word(SPI0, SPI_SELECTOR_1, 0x1, 1));
+	TEST_ASSERT_EQUAL_HEX32(0x00070000, spi_tdr_word(SPI0, SPI_SELECTOR_3, 0, 0));
+	TEST_ASSERT_TRUE(spi_build_tdr_words(SPI0, SPI_SELECTOR_0, data8, words, 3, 1));
+	TEST_ASSERT_EQUAL_HEX32(0x00000012, words[0]);
+	TEST_ASSERT_EQUAL_HEX32(0x00000034, words[1]);
+	TEST_ASSERT_EQUAL_HEX32(0x01000056, words[2]);
+	TEST_ASSERT_FALSE(spi_build_tdr_words(SPI0, SPI_SELECTOR_NONE, data8, words, 3, 1));
+
+	// With decoding, the slave number is written as it is
+	SPI0->SPI_MR |= SPI_MR_PCSDEC_MASK;
+	TEST_ASSERT_EQUAL_HEX32(0x00090042, spi_tdr_word(SPI0, 9, 0x42, 0));
+	TEST_ASSERT_TRUE(spi_build_tdr_words(SPI0, 14, data8, words, 1, 0));
+	TEST_ASSERT_EQUAL_HEX32(0x000E0012, words[0]);
+	TEST_ASSERT_FALSE(spi_build_tdr_words(SPI0, 15, data8, words, 1, 0));
+	SPI0->SPI_MR &= ~SPI_MR_PCSDEC_MASK;
+}
+
+void test_spi_variable_ps_dma(void) {
+	const spi_settings_t setting = { .delay_between_cs = 12,
+			.peripheral_select = SPI_PS_VARIABLE, };
+	const spi_settings_t fixed = { .delay_between_cs = 12, };
+	uint8_t data0[4] = { 0xA1, 0xB2, 0xC3, 0xD4 };
+	uint16_t data1[2] = { 0x1A5, 0x05A };
+	uint32_t tx[6], rx[6];
+	uint32_t i;
+
+	spi_init(SPI0, &setting);
+	spi_dma_selector_init(SPI_BITS_8);
+	TEST_ASSERT_TRUE(SPI0->SPI_MR & SPI_MR_PS_MASK);
+	// One buffer with words for two slaves with different bit lengths
+	TEST_ASSERT_TRUE(spi_build_tdr_words(SPI0, SPI_SELECTOR_0, data0, tx, 4, 1));
+	TEST_ASSERT_TRUE(spi_build_tdr_words(SPI0, SPI_SELECTOR_1, data1, tx + 4, 2, 1));
+	for (i = 0; i < 6; i++) {
+		rx[i] = 0;
+	}
+	TEST_ASSERT_FALSE(spi_transfer(SPI0, SPI_SELECTOR_0, 0, rx, 6));
+	TEST_ASSERT_TRUE(spi_transfer(SPI0, SPI_SELECTOR_0, tx, rx, 6));
+	for (i = 0; i < 4; i++) {
+		TEST_ASSERT_EQUAL_HEX16(data0[i], rx[i] & SPI_RDR_RD_MASK);
+	}
+	for (i = 0; i < 2; i++) {
+		TEST_ASSERT_EQUAL_HEX16(data1[i], rx[i + 4] & SPI_RDR_RD_MASK);
+	}
+
+	spi_init(SPI0, &fixed);
+	TEST_ASSERT_FALSE(SPI0->SPI_MR & SPI_MR_PS_MASK);
+}
+
+static volatile uint8_t req_callbacks;
+
+static void count_req(io_req_t *req, void *arg) {
+	(void) req;
+	(void) arg;
+	req_callbacks++;
+}
+
+void test_spi_transfer_req(void) {
+	uint8_t tx[DMA_TEST_LENGTH], rx[DMA_TEST_LENGTH];
+	io_req_t req;
+	uint32_t i;
+
+	dmac_init();
+	spi_dma_selector_init(SPI_BITS_8);
+	for (i = 0; i < DMA_TEST_LENGTH; i++) {
+		tx[i] = (uint8_t) (i * 5 + 2);
+		rx[i] = 0;
+	}
+	req_callbacks = 0;
+	io_req_init(&req, IO_REQ_NO_FLAG, count_req, 0);
+	TEST_ASSERT_FALSE(io_req_wait(&req, 0));
+	TEST_ASSERT_TRUE(spi_transfer_req(SPI0, SPI_SELECTOR_0, tx, rx,
+			DMA_TEST_LENGTH, &req));
+	// Busy transfer and busy request
+	TEST_ASSERT_FALSE(spi_transfer_req(SPI0, SPI_SELECTOR_0, tx, rx,
+			DMA_TEST_LENGTH, &req));
+	TEST_ASSERT_TRUE(io_req_wait(&req, 0));
+	TEST_ASSERT_TRUE(io_req_poll(&req));
+	TEST_ASSERT_EQUAL_UINT8(1, req.result);
+	TEST_ASSERT_EQUAL_UINT8(1, req_callbacks);
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(tx, rx, DMA_TEST_LENGTH);
+	// A failed start leaves the request idle
+	TEST_ASSERT_FALSE(spi_transfer_req(SPI0, SPI_SELECTOR_NONE, tx, rx, 1,
+			&req));
+	TEST_ASSERT_FALSE(io_req_poll(&req));
+	TEST_ASSERT_FALSE(io_req_wait(&req, 0));
+}
+
+static void ignore_frame(spi_reg_t *spi, void *rx, uint32_t len, void *arg) {
+	(void) spi;
+	(void) rx;
+	(void) len;
+	(void) arg;
+}
+
+/*
+ * Invalid slave settings are refused before the SPI is touched, it stays a
+ * master.
+ */
+void test_spi_slave_settings(void) {
+	static uint8_t rx[2][16];
+	spi_slave_settings_t settings = {
+		.CPOL = 0, .NCPHA = 1, .bits_pr_transfer = SPI_BITS_8,
+		.rx = { rx[0], rx[1] }, .size = sizeof(rx[0]),
+		.callback = ignore_frame, .arg = 0
+	};
+	spi_slave_settings_t bad;
+
+	bad = settings;
+	bad.CPOL = 2;
+	TEST_ASSERT_FALSE(spi_slave_start(SPI0, &bad));
+	bad = settings;
+	bad.bits_pr_transfer = SPI_BITS_16 + 1;
+	TEST_ASSERT_FALSE(spi_slave_start(SPI0, &bad));
+	bad = settings;
+	bad.rx[1] = 0;
+	TEST_ASSERT_FALSE(spi_slave_start(SPI0, &bad));
+	bad = settings;
+	bad.size = 4096;
+	TEST_ASSERT_FALSE(spi_slave_start(SPI0, &bad));
+	bad = settings;
+	bad.callback = 0;
+	TEST_ASSERT_FALSE(spi_slave_start(SPI0, &bad));
+	TEST_ASSERT_TRUE(SPI0->SPI_MR & SPI_MR_MSTR_MASK);
+
+	TEST_ASSERT_FALSE(spi_slave_set_reply(rx[0], 0));
+	TEST_ASSERT_FALSE(spi_slave_set_reply(rx[0], 4096));
+	TEST_ASSERT_TRUE(spi_slave_set_reply(0, 0));
+}
@@ -30,5 +30,19 @@ void test_spi_correct_transmission(void);
 void test_spi_variable_bit_lenght_transmission(void);
 void test_spi_polarity_phase_change(void);
 void test_spi_baud_rate_change(void);
+// DMA transfers
+void test_spi_transfer_dma(void);
+void test_spi_dma_benchmark(void);
+void test_spi_bench_transfer(void);
+// Transaction queue
+void test_spi_queue(void);
+// Variable peripheral select
+void test_spi_tdr_words(void);
+void test_spi_selector_value(void);
+void test_spi_variable_ps_dma(void);
+// Completion request
+void test_spi_transfer_req(void);
+// Slave mode
+void test_spi_slave_settings(void);
 
 #endif
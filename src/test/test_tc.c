@@ -60,6 +60,33 @@ void test_tc_conf_block(void) {
 	TEST_ASSERT_FALSE(TC0->TC_BMR);
 }
 
+void test_tc_mode_values(void) {
+	static const tc_channel_settings_t wave = {
+		.wave = TC_CMR_WAVEFORM_MODE,
+		.tcclks = TC_CMR_TCCLKS_TCLK1,
+		.wavsel = TC_CMR_WAVESEL_UP_RC,
+		.acpc = TC_CMR_ACPC_TOGGLE,
+		// capture fields, not used in waveform mode
+		.ldra = 1
+	};
+	static const tc_block_settings_t block = {
+		.tc1xc1s = TC_BMR_TC1XC1S_TIOA0,
+		.tc2xc2s = TC_BMR_TC2XC2S_TIOA1
+	};
+
+	TEST_ASSERT_EQUAL_HEX32((1u << 15) | (2u << 13) | (3u << 18),
+			tc_cmr_value(&wave));
+	tc_conf_channel((tc_channel_settings_t *) &wave, TC0, TC_CHANNEL_1);
+	TEST_ASSERT_EQUAL_HEX32(tc_cmr_value(&wave),
+			TC0->TC_CHANNEL[TC_CHANNEL_1].TC_CMR);
+	// TC2XC2S is in bits 4 and 5
+	TEST_ASSERT_EQUAL_HEX32((2u << 2) | (2u << 4), tc_bmr_value(&block));
+	tc_conf_block((tc_block_settings_t *) &block, TC0);
+	TEST_ASSERT_EQUAL_HEX32(tc_bmr_value(&block), TC0->TC_BMR);
+	tc_conf_channel(&(tc_channel_settings_t) { 0 }, TC0, TC_CHANNEL_1);
+	tc_conf_block(&(tc_block_settings_t) { 0 }, TC0);
+}
+
 void test_tc_enable_clock(void) {
 	tc_enable_clock(TC0, TC_CHANNEL_0);
 	tc_enable_clock(TC0, TC_CHANNEL_1);
@@ -274,3 +301,208 @@ void test_register(void){
 	tc_disable_clock(TC2, TC_CHANNEL_2);
 
 }
+
+void test_tc_calc_rate(void) {
+	TEST_ASSERT_EQUAL_UINT32(42000, tc_calc_rate(84000000, 1000));
+	TEST_ASSERT_EQUAL_UINT32(952, tc_calc_rate(84000000, 44100));
+	TEST_ASSERT_EQUAL_UINT32(0, tc_calc_rate(84000000, 0));
+	TEST_ASSERT_EQUAL_UINT32(0, tc_calc_rate(84000000, 30000000));
+}
+
+void test_tc_set_trigger_rate(void) {
+	tc_channel_reg_t *tc_ch = TC0->TC_CHANNEL + TC_CHANNEL_2;
+
+	pmc_enable_peripheral_clock(ID_TC2);
+	TEST_ASSERT_EQUAL_UINT32(0, tc_set_trigger_rate(TC0, 3, 84000000, 1000));
+	TEST_ASSERT_EQUAL_UINT32(44117,
+			tc_set_trigger_rate(TC0, TC_CHANNEL_2, 84000000, 44100));
+	TEST_ASSERT_EQUAL_UINT32(952, tc_ch->TC_RC);
+	TEST_ASSERT_EQUAL_UINT32(476, tc_ch->TC_RA);
+	TEST_ASSERT_EQUAL_HEX32((TC_CMR_WAVEFORM_MODE << TC_CMR_WAVE_POS) |
+			(TC_CMR_WAVESEL_UP_RC << TC_CMR_WAVSEL_POS) |
+			(TC_CMR_ACPA_CLEAR << TC_CMR_ACPA_POS) |
+			(TC_CMR_ACPC_SET << TC_CMR_ACPC_POS), tc_ch->TC_CMR);
+	TEST_ASSERT_TRUE(tc_ch->TC_SR & TC_SR_CLKSTA_ENABLED);
+	tc_disable_clock(TC0, TC_CHANNEL_2);
+	tc_ch->TC_CMR = 0;
+}
+
+void test_tc_timestamp(void) {
+	uint64_t first, second;
+
+	pmc_enable_peripheral_clock(ID_TC6);
+	pmc_enable_peripheral_clock(ID_TC7);
+	tc_timestamp_start(TC2);
+	first = tc_timestamp_read(TC2);
+	delay_micros(1000);
+	second = tc_timestamp_read(TC2);
+	// 1 ms is 42000 periods of MCK/2
+	TEST_ASSERT_TRUE(second > first);
+	TEST_ASSERT_UINT_WITHIN(500, 42000, (uint32_t) (second - first));
+	TEST_ASSERT_EQUAL_UINT32(0, (uint32_t) (second >> 32));
+	TEST_ASSERT_EQUAL_HEX32(TC_BMR_TC1XC1S_TIOA0 << TC_BMR_TC1XC1S_POS,
+			TC2->TC_BMR & TC_BMR_TC1XC1S_MASK);
+	tc_timestamp_stop(TC2);
+	TEST_ASSERT_FALSE(TC2->TC_CHANNEL[TC_CHANNEL_0].TC_SR & TC_SR_CLKSTA_ENABLED);
+}
+
+void test_tc_timestamp_to_ns(void) {
+	TEST_ASSERT_EQUAL_UINT32(1000, (uint32_t) tc_timestamp_to_ns(42, 84000000));
+	TEST_ASSERT_EQUAL_UINT32(23, (uint32_t) tc_timestamp_to_ns(1, 84000000));
+	// 300 s is more than a full turn of channel 0
+	TEST_ASSERT_TRUE(tc_timestamp_to_ns(42000000ull * 300, 84000000) ==
+			300000000000ull);
+}
+
+void test_tc_capture_start(void) {
+	static tc_capture_pulse_t pulses[8];
+	tc_capture_t cap, other;
+
+	pmc_enable_peripheral_clock(ID_TC8);
+	TEST_ASSERT_FALSE(tc_capture_start(&cap, TC2, 3, pulses, 8));
+	TEST_ASSERT_FALSE(tc_capture_start(&cap, TC2, TC_CHANNEL_2, pulses, 6));
+	TEST_ASSERT_FALSE(tc_capture_start(&cap, TC2, TC_CHANNEL_2, 0, 8));
+	TEST_ASSERT_TRUE(tc_capture_start(&cap, TC2, TC_CHANNEL_2, pulses, 8));
+	// RA and RB loading and overrun interrupts
+	TEST_ASSERT_EQUAL_HEX32(0x62, TC2->TC_CHANNEL[TC_CHANNEL_2].TC_IMR);
+	TEST_ASSERT_TRUE(TC2->TC_CHANNEL[TC_CHANNEL_2].TC_SR & TC_SR_CLKSTA_ENABLED);
+	TEST_ASSERT_FALSE(tc_capture_start(&other, TC2, TC_CHANNEL_2, pulses, 8));
+	TEST_ASSERT_EQUAL_UINT32(0, tc_capture_available(&cap));
+	tc_capture_stop(&cap);
+	TEST_ASSERT_EQUAL_HEX32(0, TC2->TC_CHANNEL[TC_CHANNEL_2].TC_IMR);
+	TEST_ASSERT_TRUE(tc_capture_start(&other, TC2, TC_CHANNEL_2, pulses, 8));
+	tc_capture_stop(&other);
+}
+
+void test_tc_capture_measure(void) {
+	static tc_capture_pulse_t pulses[4];
+	tc_capture_t cap;
+	tc_capture_measurement_t m;
+	tc_capture_pulse_t pulse;
+
+	pmc_enable_peripheral_clock(ID_TC8);
+	TEST_ASSERT_TRUE(tc_capture_start(&cap, TC2, TC_CHANNEL_2, pulses, 4));
+	tc_capture_stop(&cap);
+	TEST_ASSERT_FALSE(tc_capture_measure(&cap, 84000000, &m));
+
+	// 100 kHz, 25 % high, across the wrap of the counter
+	pulses[0].rise = 0xFFFFFF00u;
+	pulses[0].fall = 0xFFFFFF00u + 105;
+	pulses[1].rise = 0xFFFFFF00u + 420;
+	pulses[1].fall = 0xFFFFFF00u + 525;
+	pulses[2].rise = 0xFFFFFF00u + 840;
+	pulses[2].fall = 0xFFFFFF00u + 945;
+	cap.head = 3;
+	TEST_ASSERT_EQUAL_UINT32(3, tc_capture_available(&cap));
+	TEST_ASSERT_TRUE(tc_capture_read(&cap, &pulse));
+	TEST_ASSERT_EQUAL_HEX32(0xFFFFFF00u, pulse.rise);
+	TEST_ASSERT_TRUE(tc_capture_measure(&cap, 84000000, &m));
+	TEST_ASSERT_EQUAL_UINT32(1, m.pulses);
+	TEST_ASSERT_EQUAL_UINT32(420, m.period);
+	TEST_ASSERT_EQUAL_UINT32(105, m.high);
+	TEST_ASSERT_EQUAL_UINT32(16384, m.duty);
+	TEST_ASSERT_EQUAL_UINT32(100000000, m.frequency_mhz);
+
+	// The next measurement continues from the last pulse
+	pulses[3].rise = 0xFFFFFF00u + 1260;
+	pulses[3].fall = 0xFFFFFF00u + 1470;
+	cap.head = 4;
+	TEST_ASSERT_TRUE(tc_capture_measure(&cap, 84000000, &m));
+	TEST_ASSERT_EQUAL_UINT32(420, m.period);
+	TEST_ASSERT_EQUAL_UINT32(32768, m.duty);
+	TEST_ASSERT_FALSE(tc_capture_measure(&cap, 84000000, &m));
+}
+
+void test_tc_qdec_init(void) {
+	qdec_settings_t invalid = { .filter = 64 };
+	qdec_settings_t settings = {
+			.edgpha = 1,
+			.index = 1,
+			.filter = 4,
+			.speed_period = 1000
+	};
+
+	pmc_enable_peripheral_clock(ID_TC6);
+	pmc_enable_peripheral_clock(ID_TC7);
+	pmc_enable_peripheral_clock(ID_TC8);
+	TEST_ASSERT_FALSE(qdec_init(&invalid, TC2, 84000000));
+	TEST_ASSERT_TRUE(qdec_init(&settings, TC2, 84000000));
+	// QDEN, POSEN, SPEEDEN, EDGPHA, FILTER and MAXFILT = 4
+	TEST_ASSERT_EQUAL_HEX32(0x00481700, TC2->TC_BMR);
+	// 1 ms time base, TIOA2 toggles every 0.5 ms
+	TEST_ASSERT_EQUAL_UINT32(21000, TC2->TC_CHANNEL[TC_CHANNEL_2].TC_RC);
+	TEST_ASSERT_TRUE(TC2->TC_CHANNEL[TC_CHANNEL_0].TC_SR & TC_SR_CLKSTA_ENABLED);
+	TEST_ASSERT_TRUE(TC2->TC_CHANNEL[TC_CHANNEL_1].TC_SR & TC_SR_CLKSTA_ENABLED);
+	TEST_ASSERT_TRUE(TC2->TC_CHANNEL[TC_CHANNEL_2].TC_SR & TC_SR_CLKSTA_ENABLED);
+
+	// No encoder is connected
+	delay_micros(2000);
+	TEST_ASSERT_EQUAL_INT32(0, qdec_read_speed(TC2));
+	TEST_ASSERT_EQUAL_INT32(0, qdec_read_revolutions(TC2));
+	TC2->TC_BMR = 0;
+	tc_disable_clock(TC2, TC_CHANNEL_0);
+	tc_disable_clock(TC2, TC_CHANNEL_1);
+	tc_disable_clock(TC2, TC_CHANNEL_2);
+}
+
+static void qdec_callback(tc_reg_t *tc, uint32_t events) {
+	(void) tc;
+	(void) events;
+}
+
+static void other_handler(tc_reg_t *tc, uint32_t channel) {
+	(void) tc;
+	(void) channel;
+}
+
+void test_tc_qdec_callback(void) {
+	TEST_ASSERT_TRUE(qdec_set_callback(TC2, QDEC_EVENT_INDEX |
+			QDEC_EVENT_DIRCHG, qdec_callback));
+	TEST_ASSERT_EQUAL_HEX32(QDEC_EVENT_INDEX | QDEC_EVENT_DIRCHG,
+			TC2->TC_QIMR);
+	TEST_ASSERT_TRUE(tc_get_handler(TC2, TC_CHANNEL_0) != 0);
+	TEST_ASSERT_TRUE(qdec_set_callback(TC2, 0, 0));
+	TEST_ASSERT_EQUAL_HEX32(0, TC2->TC_QIMR);
+	TEST_ASSERT_TRUE(tc_get_handler(TC2, TC_CHANNEL_0) == 0);
+
+	// Channel 0 is taken by another handler
+	tc_set_handler(TC2, TC_CHANNEL_0, other_handler);
+	TEST_ASSERT_FALSE(qdec_set_callback(TC2, QDEC_EVENT_QERR, qdec_callback));
+	tc_set_handler(TC2, TC_CHANNEL_0, 0);
+}
+
+static void count_expiry(tc_timer_t *timer, void *arg) {
+	(void) timer;
+	(*(volatile uint32_t *) arg)++;
+}
+
+void test_tc_timer(void) {
+	tc_timer_t once, periodic;
+	volatile uint32_t once_count = 0, periodic_count = 0;
+
+	pmc_enable_peripheral_clock(ID_TC5);
+	TEST_ASSERT_FALSE(tc_timer_init(TC1, 3, 84000000));
+	TEST_ASSERT_TRUE(tc_timer_init(TC1, TC_CHANNEL_2, 84000000));
+	TEST_ASSERT_EQUAL_UINT32(420, tc_timer_us(10));
+	TEST_ASSERT_FALSE(tc_timer_start(&once, 0, 0, count_expiry,
+			(void *) &once_count));
+
+	TEST_ASSERT_TRUE(tc_timer_start(&once, tc_timer_us(100), 0, count_expiry,
+			(void *) &once_count));
+	TEST_ASSERT_TRUE(tc_timer_start(&periodic, tc_timer_us(50),
+			tc_timer_us(50), count_expiry, (void *) &periodic_count));
+	delay_micros(60);
+	TEST_ASSERT_EQUAL_UINT32(0, once_count);
+	TEST_ASSERT_EQUAL_UINT32(1, periodic_count);
+	delay_micros(940);
+	tc_timer_stop(&periodic);
+	TEST_ASSERT_EQUAL_UINT32(1, once_count);
+	TEST_ASSERT_UINT_WITHIN(1, 20, periodic_count);
+
+	// A stopped timer is not called any more
+	periodic_count = 0;
+	delay_micros(200);
+	TEST_ASSERT_EQUAL_UINT32(0, periodic_count);
+	tc_set_handler(TC1, TC_CHANNEL_2, 0);
+	tc_disable_clock(TC1, TC_CHANNEL_2);
+}
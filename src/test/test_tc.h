@@ -6,9 +6,13 @@
  */
 
 #include "sam3x8e/tc.h"
+#include "sam3x8e/tc_capture.h"
+#include "sam3x8e/tc_qdec.h"
+#include "sam3x8e/tc_timer.h"
 
 void test_tc_conf_channel(void);
 void test_tc_conf_block(void);
+void test_tc_mode_values(void);
 void test_tc_enable_clock(void);
 void test_tc_disable_clock(void);
 void test_tc_start_clock(void);
@@ -16,3 +20,12 @@ void test_tc_counter_stopped(void);
 void test_tc_read_counter_value(void);
 void test_tc_sync(void);
 void test_register(void);
+void test_tc_calc_rate(void);
+void test_tc_set_trigger_rate(void);
+void test_tc_timestamp(void);
+void test_tc_timestamp_to_ns(void);
+void test_tc_capture_start(void);
+void test_tc_capture_measure(void);
+void test_tc_qdec_init(void);
+void test_tc_qdec_callback(void);
+void test_tc_timer(void);
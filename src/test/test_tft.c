@@ -8,11 +8,41 @@
 #include "unity/unity.h"
 #include "sam3x8e/pio.h"
 #include "sam3x8e/tft.h"
+#include "sam3x8e/tft_blit.h"
+#include "sam3x8e/tft_touch.h"
+#include "sam3x8e/adc.h"
+#include "sam3x8e/pmc.h"
+#include "sam3x8e/tc.h"
+#include "sam3x8e/dmac.h"
 #include "sam3x8e/delay.h"
+#include "test_cycles.h"
+#include "test_bench.h"
 #include "test_tft.h"
 
+// Number of pixels used when measuring the bus throughput
+#define BENCH_PIXELS	(2000u)
+
 tft_screen tft;
 
+// 8x8 font with the characters '+' and ','
+static const uint8_t test_glyphs[] = {
+	0x00, 0x18, 0x18, 0x7E, 0x7E, 0x18, 0x18, 0x00,	// '+'
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x30	// ','
+};
+static const tft_font_t test_font = {
+	.width = 8, .height = 8, .first_char = '+', .last_char = ',',
+	.glyphs = test_glyphs
+};
+
+// 16x4 image, red/white stripes, runs continue on the next row
+static const uint16_t test_rle_data[] = {
+	24, 0xF800, 16, 0xFFFF, 24, 0xF800
+};
+static const tft_rle_image_t test_rle = {
+	.width = 16, .height = 4, .runs = 3, .data = test_rle_data
+};
+
+
 void test_tft_setup(void) {
 	tft.PORT_CS = (uint32_t)PIOA;
 	tft.PIN_CS = 22;
@@ -41,28 +71,7 @@ void test_tft_setup(void) {
 }
 
 void test_tft_setup2(void) {
-	pio_enable_pin((pio_reg_t *) tft.PORT_CS, tft.PIN_CS);
-	pio_conf_pin((pio_reg_t *) tft.PORT_CS, tft.PIN_CS, 0, 1);
-	pio_enable_pin((pio_reg_t *) tft.PORT_WR, tft.PIN_WR);
-	pio_conf_pin((pio_reg_t *) tft.PORT_WR, tft.PIN_WR, 0, 1);
-	pio_enable_pin((pio_reg_t *) tft.PORT_RS, tft.PIN_RS);
-	pio_conf_pin((pio_reg_t *) tft.PORT_RS, tft.PIN_RS, 0, 1);
-	pio_enable_pin((pio_reg_t *) tft.PORT_D0, tft.PIN_D0);
-	pio_conf_pin((pio_reg_t *) tft.PORT_D0, tft.PIN_D0, 0, 1);
-	pio_enable_pin((pio_reg_t *) tft.PORT_D1, tft.PIN_D1);
-	pio_conf_pin((pio_reg_t *) tft.PORT_D1, tft.PIN_D1, 0, 1);
-	pio_enable_pin((pio_reg_t *) tft.PORT_D2, tft.PIN_D2);
-	pio_conf_pin((pio_reg_t *) tft.PORT_D2, tft.PIN_D2, 0, 1);
-	pio_enable_pin((pio_reg_t *) tft.PORT_D3, tft.PIN_D3);
-	pio_conf_pin((pio_reg_t *) tft.PORT_D3, tft.PIN_D3, 0, 1);
-	pio_enable_pin((pio_reg_t *) tft.PORT_D4, tft.PIN_D4);
-	pio_conf_pin((pio_reg_t *) tft.PORT_D4, tft.PIN_D4, 0, 1);
-	pio_enable_pin((pio_reg_t *) tft.PORT_D5, tft.PIN_D5);
-	pio_conf_pin((pio_reg_t *) tft.PORT_D5, tft.PIN_D5, 0, 1);
-	pio_enable_pin((pio_reg_t *) tft.PORT_D6, tft.PIN_D6);
-	pio_conf_pin((pio_reg_t *) tft.PORT_D6, tft.PIN_D6, 0, 1);
-	pio_enable_pin((pio_reg_t *) tft.PORT_D7, tft.PIN_D7);
-	pio_conf_pin((pio_reg_t *) tft.PORT_D7, tft.PIN_D7, 0, 1);
+	tft_conf_pins(&tft);
 }
 
 void test_tft_init(void) {
@@ -88,6 +97,49 @@ void test_tft_write(void) {
 	TEST_ASSERT_TRUE(1);
 }
 
+void test_tft_fill_rect(void) {
+	// Screen should have a red square and a green and a blue line after this
+	tft_fill_rect(&tft, 20, 120, 80, 80, 0xF800);
+	tft_hline(&tft, 0, 220, 240, 0x07E0);
+	tft_vline(&tft, 200, 0, 320, 0x001F);
+	// clipped, should not wrap around
+	tft_fill_rect(&tft, 230, 310, 100, 100, 0xFFFF);
+	delay_ms(3000);
+	TEST_ASSERT_TRUE(1);
+}
+
+void test_tft_write_span(void) {
+	// Screen should have a gradient from black to white after this
+	uint16_t span[32];
+	uint16_t i, y;
+	for (i = 0; i < 32; i++) {
+		span[i] = (uint16_t) ((i << 11) | ((i << 1) << 5) | i);
+	}
+	for (y = 240; y < 260; y++) {
+		tft_write_span(&tft, 100, y, 32, span);
+	}
+	delay_ms(3000);
+	TEST_ASSERT_TRUE(1);
+}
+
+void test_tft_draw_string(void) {
+	// Screen should have the text "+,+,+," after this
+	TEST_ASSERT_EQUAL(10 + 6 * 8,
+			tft_draw_string(&tft, &test_font, 10, 266, "+,+,+,", 0xFFFF, 0x0000));
+	// not in the font
+	TEST_ASSERT_EQUAL(0, tft_draw_char(&tft, &test_font, 10, 266, 'A', 0, 0));
+	// doesn't fit on the screen
+	TEST_ASSERT_EQUAL(0, tft_draw_char(&tft, &test_font, 236, 0, '+', 0, 0));
+	delay_ms(3000);
+}
+
+void test_tft_draw_rle(void) {
+	// Screen should have a red/white/red striped box after this
+	TEST_ASSERT_EQUAL(1, tft_draw_rle(&tft, 10, 280, &test_rle));
+	TEST_ASSERT_EQUAL(0, tft_draw_rle(&tft, 230, 280, &test_rle));
+	delay_ms(3000);
+}
+
 void test_tft_set_bus(void) {
 	tft_set_bus(&tft, 0b11010011);
 
@@ -101,3 +153,181 @@ void test_tft_clear_bus(void) {
 
 	TEST_ASSERT_FALSE( PIOC->PIO_ODSR & (0x1u << tft.PIN_D5) );
 }
+
+static void tft_bench_fill(void *arg) {
+	tft_fill_rect(&tft, 0, 0, 100, 100, *(uint16_t *) arg);
+}
+
+/*
+ * Cycles of a 100 x 100 fill, the screen flashes red and blue.
+ */
+void test_tft_bench_fill(void) {
+	bench_result_t red, blue;
+	uint16_t color;
+
+	color = 0xF800;
+	bench_run(tft_bench_fill, &color, 4, &red);
+	color = 0x001F;
+	bench_run(tft_bench_fill, &color, 4, &blue);
+	bench_print("tft_fill_rect_red", 100 * 100, 4, &red);
+	bench_print("tft_fill_rect_blue", 100 * 100, 4, &blue);
+	TEST_ASSERT_TRUE(red.median > 0);
+}
+
+static void tft_bench_set_xy(void *arg) {
+	(void) arg;
+	tft_select(&tft, 1);
+	tft_set_xy(&tft, 10, 109, 20, 119);
+	tft_select(&tft, 0);
+}
+
+/*
+ * Cycles of setting a window, one command sequence.
+ */
+void test_tft_bench_set_xy(void) {
+	bench_result_t result;
+
+	bench_run(tft_bench_set_xy, 0, 8, &result);
+	bench_print("tft_set_xy", 1, 8, &result);
+	TEST_ASSERT_TRUE(result.median > 0);
+}
+
+void test_tft_bus_benchmark(void) {
+	uint32_t i, slow, fast;
+
+	tft_init_bus(&tft);
+
+	// legacy path: one pio_set_pin() call per data pin
+	test_cycles_start();
+	for (i = 0; i < BENCH_PIXELS; i++) {
+		tft_clear_bus(&tft);
+		tft_set_bus(&tft, 0xF8);
+		tft_commit_bus(&tft);
+		tft_clear_bus(&tft);
+		tft_set_bus(&tft, 0x1F);
+		tft_commit_bus(&tft);
+	}
+	slow = test_cycles_read();
+
+	// port-wide path: one masked store per port
+	test_cycles_start();
+	for (i = 0; i < BENCH_PIXELS; i++) {
+		tft_write_bus(&tft, 0xF81F);
+	}
+	fast = test_cycles_read();
+
+	test_cycles_print_rate("pio_set_pin bus: ", BENCH_PIXELS, slow, " pixels/s");
+	test_cycles_print_rate("port-wide bus:   ", BENCH_PIXELS, fast, " pixels/s");
+
+	// low byte (0x1F) should be left on the bus: D0 high, D5 low
+	TEST_ASSERT_TRUE( PIOA->PIO_ODSR & (0x1u << tft.PIN_D0) );
+	TEST_ASSERT_FALSE( PIOC->PIO_ODSR & (0x1u << tft.PIN_D5) );
+	TEST_ASSERT_TRUE(fast < slow);
+
+	// equal bytes: the byte is put on the bus once, then WR is pulsed twice
+	// per pixel
+	test_cycles_start();
+	tft_stream_color(&tft, 0xFFFF, BENCH_PIXELS);
+	fast = test_cycles_read();
+	test_cycles_print_rate("equal-byte fill: ", BENCH_PIXELS, fast, " pixels/s");
+	TEST_ASSERT_TRUE(PIOC->PIO_ODSR & (0x1u << tft.PIN_D5));
+}
+
+/*
+ * The SMC backend on NCS3, which has no device on the Due: the stores and
+ * the DMAC transfers go out on the bus and end without an answer. Prints
+ * the fill rate next to the one of the PIO backend.
+ */
+void test_tft_smc(void) {
+	static uint16_t row[240];
+	tft_screen smc_tft;
+	uint32_t i, cycles;
+
+	smc_tft.width = tft.width;
+	smc_tft.height = tft.height;
+	TEST_ASSERT_FALSE(tft_init_smc(&smc_tft, 4, 1, SMC_BUS_8));
+	TEST_ASSERT_FALSE(tft_init_smc(&smc_tft, 3, 0, SMC_BUS_8));
+	TEST_ASSERT_TRUE(tft_init_smc(&smc_tft, 3, 1, SMC_BUS_16));
+	TEST_ASSERT_TRUE(SMC->SMC_CS[3].SMC_MODE & SMC_MODE_DBW_16);
+	if (smc_tft.smc_dmac != TFT_SMC_NO_DMAC) {
+		dmac_channel_free(smc_tft.smc_dmac);
+	}
+	TEST_ASSERT_TRUE(tft_init_smc(&smc_tft, 3, 1, SMC_BUS_8));
+	TEST_ASSERT_FALSE(SMC->SMC_CS[3].SMC_MODE & SMC_MODE_DBW_16);
+	TEST_ASSERT_EQUAL_HEX32(SMC_CS_ADDR(3) | 0x2u,
+			(uint32_t) smc_tft.smc_data);
+
+	test_cycles_start();
+	tft_fill_rect(&smc_tft, 0, 0, 100, 100, 0xF800);
+	cycles = test_cycles_read();
+	test_cycles_print_rate("smc fill:        ", 100 * 100, cycles, " pixels/s");
+	for (i = 0; i < 240; i++) {
+		row[i] = (uint16_t) i;
+	}
+	tft_write_span(&smc_tft, 0, 0, 240, row);
+	if (smc_tft.smc_dmac != TFT_SMC_NO_DMAC) {
+		TEST_ASSERT_FALSE(dmac_busy(smc_tft.smc_dmac));
+		dmac_channel_free(smc_tft.smc_dmac);
+	}
+	smc_deinit_cs(3);
+}
+
+void test_tft_scroll(void) {
+	uint32_t rows = tft.height + 1;
+
+	TEST_ASSERT_FALSE(tft_scroll_set_area(&tft, 0, (uint16_t) rows));
+	// the parallel controller only scrolls the whole screen
+	TEST_ASSERT_FALSE(tft_scroll_set_area(&tft, 16, 0));
+	TEST_ASSERT_TRUE(tft_scroll_set_area(&tft, 0, 0));
+	TEST_ASSERT_EQUAL_UINT32(rows, tft.scroll_lines);
+
+	tft_scroll_to(&tft, 8);
+	TEST_ASSERT_EQUAL_UINT16(8, tft_scroll_row(&tft, 0));
+	TEST_ASSERT_EQUAL_UINT16(7, tft_scroll_row(&tft, (uint16_t) (rows - 1)));
+	// one text line scrolled in, only its rows are drawn
+	tft_fill_rect(&tft, 0, tft_scroll_row(&tft, (uint16_t) (rows - 8)),
+			(uint16_t) (tft.width + 1), 8, 0x07E0);
+	tft_scroll_to(&tft, rows + 8);
+	TEST_ASSERT_EQUAL_UINT32(8, tft.scroll_offset);
+	tft_scroll_to(&tft, 0);
+	TEST_ASSERT_EQUAL_UINT16(0, tft_scroll_row(&tft, 0));
+}
+
+/*
+ * Samples a touch panel on A0 (X+), A2 (X-), A1 (Y+) and A3 (Y-) at
+ * 10 kHz. Without a touch the detect phase repeats about every 0.9 ms.
+ */
+void test_tft_touch(void) {
+	static const tft_touch_t touch = {
+		.PORT_XP = (uint32_t) PIOA, .PIN_XP = 16, .CHANNEL_XP = ADC_CHANNEL_7,
+		.PORT_XM = (uint32_t) PIOA, .PIN_XM = 23,
+		.PORT_YP = (uint32_t) PIOA, .PIN_YP = 24, .CHANNEL_YP = ADC_CHANNEL_6,
+		.PORT_YM = (uint32_t) PIOA, .PIN_YM = 22,
+		.x_min = 300, .x_max = 3800, .y_min = 3700, .y_max = 250
+	};
+	tft_touch_t bad = touch;
+	adc_settings_t settings = {
+		.startup_time = ADC_MR_SUT8,
+		.prescaler = 1,
+		.trigger = ADC_TRIGGER_TIOA0
+	};
+	uint32_t x, y;
+
+	pmc_enable_peripheral_clock(ID_ADC);
+	adc_init(&settings);
+	bad.CHANNEL_XP = 16;
+	TEST_ASSERT_FALSE(tft_touch_start(&tft, &bad, ADC_TRIGGER_TIOA0, 10000));
+	TEST_ASSERT_FALSE(tft_touch_start(&tft, &touch, ADC_TRIGGER_SOFTWARE,
+			10000));
+
+	TEST_ASSERT_TRUE(tft_touch_start(&tft, &touch, ADC_TRIGGER_TIOA0, 10000));
+	TEST_ASSERT_FALSE(tft_touch_start(&tft, &touch, ADC_TRIGGER_TIOA0, 10000));
+	delay_ms(20);
+	TEST_ASSERT_FALSE(tft_read_input(&tft, &x, &y));
+	tft_touch_stop();
+	TEST_ASSERT_TRUE(tft_touch_cycles() >= 15);
+	tc_disable_clock(TC0, TC_CHANNEL_0);
+
+	ADC->ADC_EMR = 0;
+	ADC->ADC_MR = ADC_MR_RESET;
+}
@@ -14,7 +14,17 @@ void test_tft_setup2(void);
 void test_tft_init(void);
 void test_tft_clear(void);
 void test_tft_write(void);
+void test_tft_fill_rect(void);
+void test_tft_write_span(void);
+void test_tft_draw_string(void);
+void test_tft_draw_rle(void);
 void test_tft_set_bus(void);
 void test_tft_clear_bus(void);
+void test_tft_bus_benchmark(void);
+void test_tft_bench_fill(void);
+void test_tft_bench_set_xy(void);
+void test_tft_smc(void);
+void test_tft_scroll(void);
+void test_tft_touch(void);
 
 #endif //TEST_TFT_H_
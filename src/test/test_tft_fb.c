@@ -0,0 +1,88 @@
+/*
+ * TFT framebuffer unit tests
+ *
+ * Date:	14 October 2026
+ */
+
+#include "unity/unity.h"
+#include "sam3x8e/tft.h"
+#include "sam3x8e/tft_fb.h"
+#include "sam3x8e/delay.h"
+#include "test/test_tft_fb.h"
+
+// Framebuffer of 3 x 2 tiles, the last column and row are not full
+#define FB_W	(TFT_FB_TILE_W * 2 + 4)
+#define FB_H	(TFT_FB_TILE_H + 4)
+
+// The screen is set up by the TFT tests
+extern tft_screen tft;
+
+static uint16_t fb_mem[FB_W * FB_H];
+static tft_fb_t fb;
+
+// Flush the framebuffer without touching the screen, by marking all clean
+static void clean_all(void) {
+	uint32_t i;
+	for (i = 0; i < TFT_FB_DIRTY_WORDS; i++) {
+		fb.dirty[i] = 0;
+	}
+}
+
+void test_tft_fb_init(void) {
+	TEST_ASSERT_EQUAL(1, tft_fb_init(&fb, &tft, 40, 40, FB_W, FB_H, fb_mem));
+	TEST_ASSERT_EQUAL(3, fb.tiles_x);
+	TEST_ASSERT_EQUAL(2, fb.tiles_y);
+	// everything must be sent the first time
+	TEST_ASSERT_TRUE(tft_fb_tile_dirty(&fb, 0, 0));
+	TEST_ASSERT_TRUE(tft_fb_tile_dirty(&fb, 2, 1));
+}
+
+void test_tft_fb_init_too_large(void) {
+	tft_fb_t big;
+	// outside of the screen
+	TEST_ASSERT_EQUAL(0, tft_fb_init(&big, &tft, 200, 0, 100, 10, fb_mem));
+	TEST_ASSERT_EQUAL(0, tft_fb_init(&big, &tft, 0, 0, 0, 10, fb_mem));
+}
+
+void test_tft_fb_write_marks_tile(void) {
+	tft_fb_init(&fb, &tft, 40, 40, FB_W, FB_H, fb_mem);
+	clean_all();
+
+	tft_fb_write(&fb, TFT_FB_TILE_W + 1, TFT_FB_TILE_H + 1, 0x1234);
+
+	TEST_ASSERT_EQUAL_HEX16(0x1234,
+			tft_fb_read(&fb, TFT_FB_TILE_W + 1, TFT_FB_TILE_H + 1));
+	TEST_ASSERT_TRUE(tft_fb_tile_dirty(&fb, 1, 1));
+	TEST_ASSERT_FALSE(tft_fb_tile_dirty(&fb, 0, 0));
+	TEST_ASSERT_FALSE(tft_fb_tile_dirty(&fb, 2, 1));
+	// outside of the framebuffer, nothing happens
+	tft_fb_write(&fb, FB_W, 0, 0xFFFF);
+	TEST_ASSERT_FALSE(tft_fb_tile_dirty(&fb, 2, 0));
+}
+
+void test_tft_fb_fill_rect_marks_tiles(void) {
+	tft_fb_init(&fb, &tft, 40, 40, FB_W, FB_H, fb_mem);
+	clean_all();
+
+	// crosses the border between tile column 0 and 1 in the first row
+	tft_fb_fill_rect(&fb, TFT_FB_TILE_W - 2, 0, 4, 2, 0xF800);
+
+	TEST_ASSERT_TRUE(tft_fb_tile_dirty(&fb, 0, 0));
+	TEST_ASSERT_TRUE(tft_fb_tile_dirty(&fb, 1, 0));
+	TEST_ASSERT_FALSE(tft_fb_tile_dirty(&fb, 2, 0));
+	TEST_ASSERT_FALSE(tft_fb_tile_dirty(&fb, 0, 1));
+	TEST_ASSERT_EQUAL_HEX16(0xF800, tft_fb_read(&fb, TFT_FB_TILE_W + 1, 1));
+}
+
+void test_tft_fb_flush(void) {
+	// Screen should have a white square with a red centre after this
+	tft_fb_init(&fb, &tft, 40, 40, FB_W, FB_H, fb_mem);
+	tft_fb_fill_rect(&fb, 0, 0, FB_W, FB_H, 0xFFFF);
+	TEST_ASSERT_EQUAL(6, tft_flush(&fb));
+
+	tft_fb_fill_rect(&fb, 4, 4, 8, 8, 0xF800);
+	// only the first tile has changed
+	TEST_ASSERT_EQUAL(1, tft_flush(&fb));
+	TEST_ASSERT_EQUAL(0, tft_flush(&fb));
+	delay_ms(3000);
+}
@@ -0,0 +1,16 @@
+/*
+ * TFT framebuffer unit tests
+ *
+ * Date:	14 October 2026
+ */
+
+#ifndef TEST_TFT_FB_H_
+#define TEST_TFT_FB_H_
+
+void test_tft_fb_init(void);
+void test_tft_fb_init_too_large(void);
+void test_tft_fb_write_marks_tile(void);
+void test_tft_fb_fill_rect_marks_tiles(void);
+void test_tft_fb_flush(void);
+
+#endif
@@ -11,8 +11,13 @@
 #include "sam3x8e/twi.h"
 #include "sam3x8e/pio.h"
 #include "sam3x8e/pmc.h"
+#include "sam3x8e/delay.h"
+#include "sam3x8e/twi_bus.h"
 #include "test/test_twi.h"
 
+// There is no device with this address on the bus
+#define TWI_ABSENT_CHIP		(0x7Eu)
+
 static void twi_init(void){
 	pmc_enable_peripheral_clock(ID_TWI0);
 	pio_conf_pin_to_peripheral(PIOA, PIO_PERIPH_A, 17);	// SDA
@@ -124,6 +129,51 @@ void test_twi_set_clock_valid_parameters(void) {
 	TEST_ASSERT_TRUE((reg1 & (7u << 16)) == 0);
 }
 
+/*
+ * This test performs a control of:
+ * 	1) are the dividers for common bus speeds the expected ones?
+ * 	2) is the low time longer than the high time in fast mode?
+ * 	3) is the achieved bus speed returned?
+ * 	4) will invalid parameters be denied?
+ */
+void test_twi_calc_clock(void) {
+	uint32_t cwgr = 0;
+	// standard mode, CKDIV = 1 as CLDIV would not fit in 8 bits
+	TEST_ASSERT_EQUAL_UINT32(100000, twi_calc_clock(100000, 84000000, &cwgr));
+	TEST_ASSERT_EQUAL_HEX32(0x1D0D0, cwgr);
+	TEST_ASSERT_EQUAL_UINT32(50000, twi_calc_clock(50000, 84000000, &cwgr));
+	TEST_ASSERT_EQUAL_HEX32(0x2D1D1, cwgr);
+	// fast mode, low time at least 1.3 us
+	TEST_ASSERT_EQUAL_UINT32(400000, twi_calc_clock(400000, 84000000, &cwgr));
+	TEST_ASSERT_EQUAL_HEX32(0x0606A, cwgr);
+	TEST_ASSERT_TRUE((cwgr & 0xFFu) > ((cwgr >> 8) & 0xFFu));
+	TEST_ASSERT_EQUAL_UINT32(400000, twi_calc_clock(400000, 48000000, &cwgr));
+	TEST_ASSERT_EQUAL_HEX32(0x0353B, cwgr);
+	// fast mode plus
+	TEST_ASSERT_EQUAL_UINT32(1000000,
+			twi_calc_clock(TWI_FAST_MODE_PLUS_SPEED, 84000000, &cwgr));
+	TEST_ASSERT_EQUAL_HEX32(0x02626, cwgr);
+	// not exactly achievable, closest is 10009 Hz with CKDIV = 5
+	TEST_ASSERT_EQUAL_UINT32(10009, twi_calc_clock(10000, 84000000, &cwgr));
+	TEST_ASSERT_EQUAL_HEX32(0x58284, cwgr);
+	// invalid parameters
+	TEST_ASSERT_EQUAL_UINT32(0, twi_calc_clock(0, 84000000, &cwgr));
+	TEST_ASSERT_EQUAL_UINT32(0, twi_calc_clock(1000001, 84000000, &cwgr));
+	TEST_ASSERT_EQUAL_UINT32(0, twi_calc_clock(400000, 800000, &cwgr));
+}
+
+/*
+ * Is the register set with the calculated dividers?
+ */
+void test_twi_set_clock_exact(void) {
+	TEST_ASSERT_EQUAL_UINT32(400000,
+			twi_set_clock_exact(TWI0, TWI_FAST_MODE_SPEED, 84000000));
+	TEST_ASSERT_EQUAL_HEX32(0x0606A, TWI0->TWI_CWGR);
+	// an invalid speed shouldn't change the register
+	TEST_ASSERT_EQUAL_UINT32(0, twi_set_clock_exact(TWI0, 0, 84000000));
+	TEST_ASSERT_EQUAL_HEX32(0x0606A, TWI0->TWI_CWGR);
+}
+
 /*
  * This test is semi-automatic and requires that SDA and SCL of
  * both TWI peripherals are connected.
@@ -200,6 +250,230 @@ void test_twi_send_receive_SEMI_AUTOMATIC(void) {
 
 	TEST_ASSERT_TRUE(data_in == data_out);*/
 }
+/*
+ * Will invalid packets be denied, without starting a transfer?
+ */
+void test_twi_master_async_invalid_parameters(void) {
+	uint8_t data[2] = { 0 };
+	twi_packet_t packet = {
+		.chip = TWI_ABSENT_CHIP,
+		.address = 0,
+		.address_length = 0,
+		.buffer = data,
+		.length = 0
+	};
+	// no data...
+	TEST_ASSERT_TRUE(twi_master_read_async(TWI0, &packet, 0) == 1);
+	TEST_ASSERT_TRUE(twi_master_write_async(TWI0, &packet, 0) == 1);
+	// ...or too long internal address shouldn't be accepted!
+	packet.length = 2;
+	packet.address_length = 4;
+	TEST_ASSERT_TRUE(twi_master_read_async(TWI0, &packet, 0) == 1);
+	TEST_ASSERT_TRUE(twi_master_read(TWI0, &packet) == 0xFF);
+	TEST_ASSERT_FALSE(twi_master_busy(TWI0));
+}
+
+static volatile uint8_t callback_result;
+
+static void store_result(twi_reg_t *twi, uint8_t result) {
+	(void) twi;
+	callback_result = result;
+}
+
+/*
+ * This test requires the pull-up resistors of TWI1 (pin 20 and 21 on the
+ * Arduino Due) and that no device answers to TWI_ABSENT_CHIP.
+ * A write and a combined write-then-read should both end with NACK from
+ * the interrupt handler.
+ */
+void test_twi_master_async_nack(void) {
+	uint32_t i;
+	uint8_t data[2] = { 0x12, 0x34 };
+	const twi_packet_t packet = {
+		.chip = TWI_ABSENT_CHIP,
+		.address = 0x10,
+		.address_length = 1,
+		.buffer = data,
+		.length = 2
+	};
+
+	twi_init();
+	twi_set_clock(TWI1, TWI_STANDARD_MODE_SPEED, 84000000);
+	twi_init_master(TWI1);
+
+	callback_result = 0xFF;
+	TEST_ASSERT_TRUE(twi_master_write_async(TWI1, &packet, store_result) == 0);
+	// a second transfer shouldn't be accepted while busy
+	TEST_ASSERT_TRUE(twi_master_write_async(TWI1, &packet, store_result) == 1);
+	for (i = 0; i < 100 && twi_master_busy(TWI1); i++) {
+		delay_ms(1);
+	}
+	TEST_ASSERT_FALSE(twi_master_busy(TWI1));
+	TEST_ASSERT_EQUAL_UINT8(TWI_RESULT_NACK, callback_result);
+
+	TEST_ASSERT_EQUAL_UINT8(TWI_RESULT_NACK, twi_master_read(TWI1, &packet));
+}
+/*
+ * This test has the same requirements as test_twi_master_async_nack().
+ * The PDC transfers should also end with NACK and leave the PDC disabled.
+ */
+void test_twi_master_dma_nack(void) {
+	uint32_t i;
+	uint8_t data[4] = { 0x12, 0x34, 0x56, 0x78 };
+	const twi_packet_t packet = {
+		.chip = TWI_ABSENT_CHIP,
+		.address = 0x10,
+		.address_length = 1,
+		.buffer = data,
+		.length = 4
+	};
+
+	// the PDC registers should be mapped at offset 0x100
+	TEST_ASSERT_EQUAL_HEX32(0x4008C120, (uint32_t) &TWI0->TWI_PTCR);
+
+	callback_result = 0xFF;
+	TEST_ASSERT_TRUE(twi_master_write_dma(TWI1, &packet, store_result) == 0);
+	for (i = 0; i < 100 && twi_master_busy(TWI1); i++) {
+		delay_ms(1);
+	}
+	TEST_ASSERT_EQUAL_UINT8(TWI_RESULT_NACK, callback_result);
+
+	callback_result = 0xFF;
+	TEST_ASSERT_TRUE(twi_master_read_dma(TWI1, &packet, store_result) == 0);
+	for (i = 0; i < 100 && twi_master_busy(TWI1); i++) {
+		delay_ms(1);
+	}
+	TEST_ASSERT_EQUAL_UINT8(TWI_RESULT_NACK, callback_result);
+	TEST_ASSERT_TRUE(TWI1->TWI_PTSR == 0);
+}
+
+static uint8_t slave_map[8];
+static volatile uint32_t slave_written_reg, slave_written_count;
+
+static void slave_written(twi_reg_t *twi, uint32_t reg, uint32_t count) {
+	(void) twi;
+	slave_written_reg = reg;
+	slave_written_count = count;
+}
+
+/*
+ * This test performs a control of:
+ * 	1) will an empty register map be denied?
+ * 	2) is the Slave Address set?
+ * 	3) are master transfers denied in slave mode?
+ */
+void test_twi_slave_start_stop(void) {
+	uint8_t data = 0;
+	const twi_packet_t packet = {
+		.chip = TWI_ABSENT_CHIP,
+		.buffer = &data,
+		.length = 1
+	};
+
+	TEST_ASSERT_TRUE(twi_slave_start(TWI0, 100, slave_map, 0, 0, 0) == 1);
+	TEST_ASSERT_TRUE(twi_slave_start(TWI0, 100, slave_map, 8, 0, 0) == 0);
+	TEST_ASSERT_TRUE(((TWI0->TWI_SMR >> 16) & 127u) == 100u);
+	TEST_ASSERT_TRUE(TWI0->TWI_IMR & TWI_SR_SVACC);
+	TEST_ASSERT_TRUE(twi_master_write_async(TWI0, &packet, 0) == 1);
+	twi_slave_stop(TWI0);
+	TEST_ASSERT_TRUE(TWI0->TWI_IMR == 0);
+	twi_init_master(TWI0);
+}
+
+/*
+ * This test is semi-automatic and requires that SDA and SCL of
+ * both TWI peripherals are connected. TWI0 is the master of the
+ * register map of TWI1.
+ */
+void test_twi_slave_register_map_SEMI_AUTOMATIC(void) {
+	uint32_t i;
+	uint8_t out[3] = { 2, 0xAA, 0xBB };
+	uint8_t in[2] = { 0 };
+	const twi_packet_t write = {
+		.chip = 100,
+		.buffer = out,
+		.length = 3
+	};
+	// write-then-read, the register is the internal address
+	const twi_packet_t read = {
+		.chip = 100,
+		.address = 2,
+		.address_length = 1,
+		.buffer = in,
+		.length = 2
+	};
+
+	twi_init();
+	TEST_ASSERT_TRUE(twi_slave_start(TWI1, 100, slave_map, 8,
+			slave_written, 0) == 0);
+	twi_set_clock(TWI0, TWI_STANDARD_MODE_SPEED, 84000000);
+	twi_init_master(TWI0);
+
+	TEST_ASSERT_TRUE(twi_master_write_async(TWI0, &write, 0) == 0);
+	for (i = 0; i < 100 && twi_master_busy(TWI0); i++) {
+		delay_ms(1);
+	}
+	TEST_ASSERT_EQUAL_UINT8(TWI_RESULT_OK, twi_master_result(TWI0));
+	delay_ms(1);
+	TEST_ASSERT_EQUAL_UINT32(2, slave_written_reg);
+	TEST_ASSERT_EQUAL_UINT32(2, slave_written_count);
+	TEST_ASSERT_EQUAL_HEX8(0xAA, slave_map[2]);
+	TEST_ASSERT_EQUAL_HEX8(0xBB, slave_map[3]);
+
+	TEST_ASSERT_EQUAL_UINT8(TWI_RESULT_OK, twi_master_read(TWI0, &read));
+	TEST_ASSERT_EQUAL_HEX8(0xAA, in[0]);
+	TEST_ASSERT_EQUAL_HEX8(0xBB, in[1]);
+	twi_slave_stop(TWI1);
+}
+
+/*
+ * This test has the same requirements as test_twi_master_async_nack().
+ * Queued transactions to an absent device should each be retried after a
+ * bus recovery and end with NACK, in the order they were submitted, and the
+ * TWI should keep its clock settings.
+ */
+void test_twi_bus_nack_recovery(void) {
+	uint32_t i;
+	uint32_t cwgr;
+	uint8_t data[4] = { 0 };
+	twi_transaction_t t0 = {
+		.packet = { .chip = TWI_ABSENT_CHIP, .buffer = data, .length = 4 },
+		.direction = TWI_BUS_WRITE,
+		.flag = TWI_NO_FLAG
+	};
+	twi_transaction_t t1 = {
+		.packet = { .chip = TWI_ABSENT_CHIP, .address = 1,
+				.address_length = 1, .buffer = data, .length = 4 },
+		.direction = TWI_BUS_READ,
+		.flag = TWI_NO_FLAG
+	};
+	twi_transaction_t bad = {
+		.packet = { .chip = TWI_ABSENT_CHIP, .buffer = data, .length = 0 },
+	};
+
+	twi_init();
+	twi_set_clock(TWI1, TWI_STANDARD_MODE_SPEED, 84000000);
+	twi_init_master(TWI1);
+	cwgr = TWI1->TWI_CWGR;
+	TEST_ASSERT_TRUE(twi_bus_init(TWI1) == 0);
+	TEST_ASSERT_TRUE(twi_bus_submit(TWI1, &bad) == 1);
+
+	TEST_ASSERT_TRUE(twi_bus_submit(TWI1, &t0) == 0);
+	TEST_ASSERT_TRUE(twi_bus_submit(TWI1, &t1) == 0);
+	for (i = 0; i < 100 && !t1.done; i++) {
+		delay_ms(1);
+	}
+	TEST_ASSERT_TRUE(t0.done && t1.done);
+	TEST_ASSERT_TRUE(twi_bus_idle(TWI1));
+	TEST_ASSERT_EQUAL_UINT8(TWI_RESULT_NACK, t0.result);
+	TEST_ASSERT_EQUAL_UINT8(TWI_RESULT_NACK, t1.result);
+	TEST_ASSERT_EQUAL_UINT8(TWI_BUS_RETRIES, t1.attempts);
+	TEST_ASSERT_EQUAL_HEX32(cwgr, TWI1->TWI_CWGR);
+
+	// blocking, without an event flag
+	TEST_ASSERT_EQUAL_UINT8(TWI_RESULT_NACK, twi_bus_transfer(TWI1, &t0));
+}
+
 /*
 
 void test_twi_master_init(twi_reg_t *twi){
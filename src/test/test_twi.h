@@ -14,7 +14,15 @@ void test_twi_set_device_address(void);
 void test_twi_set_internal_address(void);
 void test_twi_set_clock_invalid_parameters(void);
 void test_twi_set_clock_valid_parameters(void);
+void test_twi_calc_clock(void);
+void test_twi_set_clock_exact(void);
 void test_twi_init_slave(void);
 void test_twi_send_receive_SEMI_AUTOMATIC(void);
+void test_twi_master_async_invalid_parameters(void);
+void test_twi_master_async_nack(void);
+void test_twi_master_dma_nack(void);
+void test_twi_slave_start_stop(void);
+void test_twi_bus_nack_recovery(void);
+void test_twi_slave_register_map_SEMI_AUTOMATIC(void);
 
 #endif
@@ -53,3 +53,81 @@ void test_uart_send_receive_char_local_loopback_mode(void) {
 	TEST_ASSERT_TRUE(result_true);
 	TEST_ASSERT_FALSE(result_false);
 }
+
+/*
+ * Send and receive a string in Local Loopback mode, with interrupt mode and
+ * the ring buffers.
+ */
+void test_uart_interrupt_mode_local_loopback(void) {
+	const char *msg = "ring buffer";
+	char received[16] = {0};
+	uint32_t accepted, timeout = 1000000;
+
+	uart_settings_t uart_settings = {
+		.baud_rate = 115200,
+		.parity = UART_PARITY_NO,
+		.ch_mode = UART_CHMODE_LOCAL_LOOPBACK
+	};
+	while (!(uart_tx_ready()));		// let Unity finish its output
+	uart_init(&uart_settings);
+	uart_enable_interrupt_mode();
+
+	accepted = uart_write(msg, 11);
+	while (uart_rx_available() < 11 && --timeout);
+	uart_read(received, sizeof(received));
+
+	// back to polled Normal Mode (otherwise Unity won't work!)
+	uart_disable_interrupt_mode();
+	uart_settings.ch_mode = UART_CHMODE_NORMAL;
+	uart_init(&uart_settings);
+
+	TEST_ASSERT_EQUAL_UINT32(11, accepted);
+	TEST_ASSERT_EQUAL_STRING(msg, received);
+	TEST_ASSERT_EQUAL_UINT32(0, uart_rx_available());
+}
+
+static volatile uint32_t dma_done;
+
+static void dma_callback(void) {
+	dma_done = 1;
+}
+
+/*
+ * Send a string with the PDC and receive it into the circular PDC buffer,
+ * in Local Loopback mode.
+ */
+void test_uart_dma_local_loopback(void) {
+	const char *msg = "pdc transfer";
+	uint8_t rx_buffer[32];
+	char received[16] = {0};
+	uint32_t timeout = 1000000, count;
+	uint8_t started;
+
+	uart_settings_t uart_settings = {
+		.baud_rate = 115200,
+		.parity = UART_PARITY_NO,
+		.ch_mode = UART_CHMODE_LOCAL_LOOPBACK
+	};
+	while (!(uart_tx_ready()));		// let Unity finish its output
+	uart_init(&uart_settings);
+
+	dma_done = 0;
+	uart_dma_rx_start(rx_buffer, sizeof(rx_buffer));
+	started = uart_write_dma(msg, 12, dma_callback);
+	while (!dma_done && --timeout);
+	count = 0;
+	while (count < 12 && --timeout) {
+		count += uart_dma_rx_read(received + count, sizeof(received) - count);
+	}
+	uart_dma_rx_stop();
+
+	// change channel mode, back to Normal Mode (otherwise Unity won't work!)
+	uart_settings.ch_mode = UART_CHMODE_NORMAL;
+	uart_init(&uart_settings);
+
+	TEST_ASSERT_TRUE(started);
+	TEST_ASSERT_TRUE(dma_done);
+	TEST_ASSERT_FALSE(uart_write_dma_busy());
+	TEST_ASSERT_EQUAL_UINT32(12, count);
+	TEST_ASSERT_EQUAL_STRING(msg, received);
+}
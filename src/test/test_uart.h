@@ -10,5 +10,7 @@
 #define TEST_UART_H_
 
 void test_uart_send_receive_char_local_loopback_mode(void);
+void test_uart_interrupt_mode_local_loopback(void);
+void test_uart_dma_local_loopback(void);
 
 #endif
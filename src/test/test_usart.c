@@ -0,0 +1,109 @@
+/*
+ * USART unit tests
+ *
+ * All tests use USART0 in Local Loopback mode, so no wiring is needed.
+ *
+ * Date:	14 October 2026
+ */
+
+#include "unity/unity.h"
+#include "sam3x8e/pmc.h"
+#include "sam3x8e/usart.h"
+#include "test/test_usart.h"
+
+static const usart_settings_t loopback = {
+	.baud_rate = 1000000,
+	.mode = USART_MODE_NORMAL,
+	.data_bits = 8,
+	.parity = USART_PARITY_NO,
+	.stop_bits = USART_STOP_1,
+	.ch_mode = USART_CHMODE_LOCAL_LOOPBACK
+};
+
+void test_usart_calc_baud(void) {
+	uint32_t brgr, over;
+
+	// 115200: 84 MHz / 16 / 115200 = 45.57 -> CD 45, FP 5 (45.625)
+	over = usart_calc_baud(115200, &brgr);
+	TEST_ASSERT_EQUAL_UINT32(0, over);
+	TEST_ASSERT_EQUAL_UINT32(US_BRGR_CD(45) | US_BRGR_FP(5), brgr);
+
+	// 7 Mbaud needs 8x oversampling: 84 MHz / 8 / 7 MHz = 1.5
+	over = usart_calc_baud(7000000, &brgr);
+	TEST_ASSERT_EQUAL_UINT32(1, over);
+	TEST_ASSERT_EQUAL_UINT32(US_BRGR_CD(1) | US_BRGR_FP(4), brgr);
+}
+
+void test_usart_init_invalid(void) {
+	usart_settings_t settings = loopback;
+
+	settings.data_bits = 10;
+	TEST_ASSERT_FALSE(usart_init(USART0, &settings));
+	settings = loopback;
+	settings.baud_rate = 0;
+	TEST_ASSERT_FALSE(usart_init(USART0, &settings));
+}
+
+void test_usart_local_loopback(void) {
+	uint16_t chr;
+
+	pmc_enable_peripheral_clock(ID_USART0);
+	TEST_ASSERT_TRUE(usart_init(USART0, &loopback));
+
+	while (!usart_tx_ready(USART0));
+	usart_write_char(USART0, 'U');
+	while (!usart_rx_ready(USART0));
+	chr = usart_read_char(USART0);
+
+	pmc_disable_peripheral_clock(ID_USART0);
+	TEST_ASSERT_EQUAL_UINT32('U', chr);
+}
+
+void test_usart_interrupt_mode_local_loopback(void) {
+	const char *msg = "usart ring";
+	char received[16] = {0};
+	uint32_t accepted, timeout = 1000000;
+
+	pmc_enable_peripheral_clock(ID_USART0);
+	usart_init(USART0, &loopback);
+	usart_enable_interrupt_mode(USART0);
+
+	accepted = usart_write(USART0, msg, 10);
+	while (usart_rx_available(USART0) < 10 && --timeout);
+	usart_read(USART0, received, sizeof(received));
+
+	usart_disable_interrupt_mode(USART0);
+	pmc_disable_peripheral_clock(ID_USART0);
+
+	TEST_ASSERT_EQUAL_UINT32(10, accepted);
+	TEST_ASSERT_EQUAL_STRING(msg, received);
+}
+
+void test_usart_dma_local_loopback(void) {
+	const char *msg = "0123456789abcdefghij";	// more than one half
+	uint8_t rx_buffer[16];
+	char received[24] = {0};
+	uint32_t count = 0, timeout = 1000000;
+	uint8_t started;
+
+	pmc_enable_peripheral_clock(ID_USART0);
+	usart_init(USART0, &loopback);
+
+	usart_dma_rx_start(USART0, rx_buffer, sizeof(rx_buffer), 20, 0);
+	started = usart_write_dma(USART0, msg, 20, 0);
+	while (count < 20 && --timeout) {
+		count += usart_dma_rx_read(USART0, received + count,
+				sizeof(received) - count);
+	}
+	// the line goes idle after the last character
+	timeout = 1000000;
+	while (!usart_dma_rx_idle(USART0) && --timeout);
+	usart_dma_rx_stop(USART0);
+	pmc_disable_peripheral_clock(ID_USART0);
+
+	TEST_ASSERT_TRUE(started);
+	TEST_ASSERT_TRUE(timeout);
+	TEST_ASSERT_FALSE(usart_write_dma_busy(USART0));
+	TEST_ASSERT_EQUAL_UINT32(20, count);
+	TEST_ASSERT_EQUAL_STRING(msg, received);
+}
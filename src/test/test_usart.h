@@ -0,0 +1,16 @@
+/*
+ * USART unit tests
+ *
+ * Date:	14 October 2026
+ */
+
+#ifndef TEST_USART_H_
+#define TEST_USART_H_
+
+void test_usart_calc_baud(void);
+void test_usart_init_invalid(void);
+void test_usart_local_loopback(void);
+void test_usart_interrupt_mode_local_loopback(void);
+void test_usart_dma_local_loopback(void);
+
+#endif /* TEST_USART_H_ */
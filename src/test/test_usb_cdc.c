@@ -0,0 +1,43 @@
+/*
+ * USB CDC unit tests
+ *
+ * No terminal may be open on the native USB port while the tests run, the
+ * transfers are tested by hand (see test_usb_cdc_man.txt).
+ *
+ * Date:	14 October 2026
+ */
+
+#include "unity/unity.h"
+#include "sam3x8e/usb_cdc.h"
+#include "test/test_usb_cdc.h"
+
+void test_usb_cdc_init(void) {
+	TEST_ASSERT_TRUE(usb_cdc_init());
+	TEST_ASSERT_TRUE(UOTGHS->SR & UOTGHS_SR_CLKUSABLE);
+	TEST_ASSERT_FALSE(UOTGHS->DEVCTRL & UOTGHS_DEVCTRL_DETACH);
+	TEST_ASSERT_FALSE(usb_cdc_connected());
+	usb_cdc_deinit();
+	TEST_ASSERT_TRUE(UOTGHS->DEVCTRL & UOTGHS_DEVCTRL_DETACH);
+}
+
+/*
+ * Without a host the data stays in the ring buffer, and the string output
+ * is dropped instead of blocking.
+ */
+void test_usb_cdc_write_without_host(void) {
+	static uint8_t data[USB_CDC_TX_BUFFER_SIZE + 16];
+	uint8_t rx[4];
+
+	TEST_ASSERT_TRUE(usb_cdc_init());
+	TEST_ASSERT_EQUAL_UINT32(16, usb_cdc_write(data, 16));
+	TEST_ASSERT_EQUAL_UINT32(16, usb_cdc_tx_pending());
+	TEST_ASSERT_EQUAL_UINT32(USB_CDC_TX_BUFFER_SIZE - 16,
+			usb_cdc_write(data, sizeof(data)));
+	TEST_ASSERT_EQUAL_UINT32(0, usb_cdc_write(data, 1));
+	usb_cdc_write_str("dropped");
+	TEST_ASSERT_EQUAL_INT('x', usb_cdc_putchar('x'));
+	TEST_ASSERT_EQUAL_UINT32(USB_CDC_TX_BUFFER_SIZE, usb_cdc_tx_pending());
+	TEST_ASSERT_EQUAL_UINT32(0, usb_cdc_read(rx, sizeof(rx)));
+	usb_cdc_deinit();
+	TEST_ASSERT_EQUAL_UINT32(0, usb_cdc_tx_pending());
+}
@@ -0,0 +1,13 @@
+/*
+ * USB CDC unit tests
+ *
+ * Date:	14 October 2026
+ */
+
+#ifndef TEST_USB_CDC_H_
+#define TEST_USB_CDC_H_
+
+void test_usb_cdc_init(void);
+void test_usb_cdc_write_without_host(void);
+
+#endif
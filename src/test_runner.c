@@ -6,6 +6,7 @@
  * Date: 	29 September 2014
  */
 
+#include <string.h>
 #include "unity/unity.h"
 #include "test_runner.h"
 
@@ -15,25 +16,220 @@
 #include "test/test_adc.h"
 #include "test/test_dacc.h"
 #include "test/test_uart.h"
+#include "test/test_usart.h"
+#include "test/test_logger.h"
 #include "test/test_spi.h"
+#include "test/test_dmac.h"
 #include "test/test_eefc.h"
+#include "test/test_flash_kv.h"
 #include "test/test_pwm.h"
 #include "test/test_tc.h"
 #include "test/test_twi.h"
 #include "test/test_tft.h"
+#include "test/test_tft_fb.h"
+#include "test/test_can.h"
+#include "test/test_usb_cdc.h"
+#include "test/test_emac.h"
+#include "test/test_hsmci.h"
+#include "test/test_ctrl_loop.h"
+#include "test/test_dsp.h"
+#include "test/test_bitband.h"
+#include "test/test_latency.h"
+#include "test/test_crc.h"
+#include "test/test_ring.h"
+#include "test/test_acq.h"
+#include "test/test_bench.h"
+#include "test/test_cycles.h"
+#include "sam3x8e/wdt.h"
+
+// Most tests timed in one run
+#define TEST_RESULTS_MAX		(256)
+
+// Percent a test may be slower than its baseline before it is flagged
+#define TEST_REGRESSION_PERCENT	(10)
+
+///@cond
+// RSTC_SR: reset type, 2 after a watchdog reset
+#define TEST_RSTC_SR			(*((volatile uint32_t *) PERIPH_ADDR(0x400E1A04U)))
+#define TEST_RSTC_SR_RSTTYP(sr)	(((sr) >> 8) & 0x7u)
+#define TEST_RSTC_WDT_RST		(2)
+// General purpose backup registers, they survive a watchdog reset
+#define TEST_GPBR(n)	(*((volatile uint32_t *) PERIPH_ADDR(0x400E1A90U + 4 * (n))))
+#define TEST_GPBR_RUNNING		TEST_GPBR(0)
+#define TEST_GPBR_FAILURES		TEST_GPBR(1)
+///@endcond
+
+typedef struct {
+	const char *name;
+	uint32_t cycles;
+} test_baseline_t;
+
+/*
+ * Cycles of the tests on the Arduino Due at 84 MHz. Paste lines of the
+ * "Cycles" part of the summary here to record them; a test is flagged when
+ * it needs more than TEST_REGRESSION_PERCENT more.
+ */
+static const test_baseline_t baselines[] = {
+	{ 0, 0 }
+};
+
+static struct {
+	const char *name;
+	uint32_t cycles;
+} results[TEST_RESULTS_MAX];
+static uint32_t result_count;
+
+// Number of the test running, from 1; tests up to resume_after ran before
+// the watchdog reset
+static uint32_t test_number;
+static uint32_t resume_after;
+
+/*
+ * Like UnityDefaultTestRun(), but the test alone is timed, the buffered
+ * output is sent before it and the watchdog is restarted.
+ */
+static void test_run(UnityTestFunction func, const char *name, int line) {
+	volatile uint32_t start = 0;
+	uint32_t cycles;
+
+	if (++test_number <= resume_after) {
+		return;
+	}
+	unity_output_flush();
+	TEST_GPBR_RUNNING = test_number;
+	TEST_GPBR_FAILURES = Unity.TestFailures;
+	Unity.CurrentTestName = name;
+	Unity.CurrentTestLineNumber = (_U_UINT) line;
+	Unity.NumberOfTests++;
+	wdt_restart();
+	if (TEST_PROTECT()) {
+		start = TEST_DWT_CYCCNT;
+		func();
+	}
+	cycles = TEST_DWT_CYCCNT - start;
+	UnityConcludeTest();
+	if (result_count < TEST_RESULTS_MAX) {
+		results[result_count].name = name;
+		results[result_count].cycles = cycles;
+		result_count++;
+	}
+}
+
+#undef RUN_TEST
+#define RUN_TEST(func, line_num) test_run(func, #func, line_num)
+
+/*
+ * After a watchdog reset during a test, that test is counted as failed and
+ * the tests go on after it.
+ */
+static void test_resume(void) {
+	uint32_t running = TEST_GPBR_RUNNING;
+
+	if (running != 0 &&
+		TEST_RSTC_SR_RSTTYP(TEST_RSTC_SR) == TEST_RSTC_WDT_RST) {
+		resume_after = running;
+		Unity.NumberOfTests = running;
+		Unity.TestFailures = TEST_GPBR_FAILURES + 1;
+		unity_output_str("Test ");
+		UnityPrintNumberUnsigned(running);
+		unity_output_str(" timed out, the watchdog reset the board\n\r");
+	}
+}
+
+static uint32_t test_baseline(const char *name) {
+	const test_baseline_t *b;
+
+	for (b = baselines; b->name; b++) {
+		if (strcmp(b->name, name) == 0) {
+			return b->cycles;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Prints the cycles of each test, then the tests slower than their
+ * baseline.
+ */
+static void test_summary(void) {
+	uint32_t i, baseline, regressions = 0;
+
+	unity_output_str("Cycles\n\r");
+	for (i = 0; i < result_count; i++) {
+		unity_output_str("\t{ \"");
+		unity_output_str(results[i].name);
+		unity_output_str("\", ");
+		UnityPrintNumberUnsigned(results[i].cycles);
+		unity_output_str(" },\n\r");
+	}
+	for (i = 0; i < result_count; i++) {
+		baseline = test_baseline(results[i].name);
+		if (baseline != 0 && (uint64_t) results[i].cycles * 100 >
+				(uint64_t) baseline * (100 + TEST_REGRESSION_PERCENT)) {
+			unity_output_str("SLOWER ");
+			unity_output_str(results[i].name);
+			unity_output_str(": ");
+			UnityPrintNumberUnsigned(results[i].cycles);
+			unity_output_str(" cycles, baseline ");
+			UnityPrintNumberUnsigned(baseline);
+			unity_output_str("\n\r");
+			regressions++;
+		}
+	}
+	UnityPrintNumberUnsigned(regressions);
+	unity_output_str(" Regressions\n\r");
+	unity_output_str(regressions == 0 ? "OK\n\r" : "FAIL\n\r");
+}
 
 void run_tests(void) {
 	UnityBegin();
+	test_cycles_start();
+	test_resume();
 
 	// Run UART tests
 	Unity.TestFile = "test/test_uart.c";
 	RUN_TEST(test_uart_send_receive_char_local_loopback_mode, 0);
+	RUN_TEST(test_uart_interrupt_mode_local_loopback, 0);
+	RUN_TEST(test_uart_dma_local_loopback, 0);
+	HORIZONTAL_LINE_BREAK()
+	;
+
+	// Run USART tests
+	Unity.TestFile = "test/test_usart.c";
+	RUN_TEST(test_usart_calc_baud, 5);
+	RUN_TEST(test_usart_init_invalid, 5);
+	RUN_TEST(test_usart_local_loopback, 5);
+	RUN_TEST(test_usart_interrupt_mode_local_loopback, 5);
+	RUN_TEST(test_usart_dma_local_loopback, 5);
+	HORIZONTAL_LINE_BREAK()
+	;
+
+	// Run logger tests
+	Unity.TestFile = "test/test_logger.c";
+	RUN_TEST(test_logger_format, 6);
+	RUN_TEST(test_logger_format_truncates, 6);
+	RUN_TEST(test_logger_record_and_flush, 6);
+	RUN_TEST(test_logger_full_buffer, 6);
+	RUN_TEST(test_logger_append_crc, 141);
 	HORIZONTAL_LINE_BREAK()
 	;
 
 	// Run EEFC tests
 	Unity.TestFile = "test/test_eefc.c";
 	RUN_TEST(test_eefc_set_flash_wait_state, 10);
+	RUN_TEST(test_eefc_wait_states, 10);
+	RUN_TEST(test_eefc_unique_id, 10);
+	RUN_TEST(test_eefc_buf_write, 10);
+	HORIZONTAL_LINE_BREAK()
+	;
+
+	// Run flash key-value store tests
+	Unity.TestFile = "test/test_flash_kv.c";
+	RUN_TEST(test_flash_kv_mount_empty, 15);
+	RUN_TEST(test_flash_kv_write_read, 15);
+	RUN_TEST(test_flash_kv_remount, 15);
+	RUN_TEST(test_flash_kv_compact, 15);
+	RUN_TEST(test_flash_kv_delete, 15);
 	HORIZONTAL_LINE_BREAK()
 	;
 
@@ -44,6 +240,8 @@ void run_tests(void) {
 	RUN_TEST(test_pmc_PIOB_enabled, 20);
 	RUN_TEST(test_pmc_disable_PIOB, 20);
 	RUN_TEST(test_pmc_PIOB_disabled2, 20);
+	RUN_TEST(test_pmc_clock_users, 20);
+	RUN_TEST(test_pmc_clock_profiles, 20);
 	HORIZONTAL_LINE_BREAK()
 	;
 
@@ -57,6 +255,10 @@ void run_tests(void) {
 	RUN_TEST(test_pio_set_output, 30);
 	RUN_TEST(test_pio_set_outputs, 30);
 	RUN_TEST(test_pio_conf_multiple_pins, 30);
+	RUN_TEST(test_pio_toggle_rate, 30);
+	RUN_TEST(test_pio_interrupt, 30);
+	RUN_TEST(test_pio_capture, 30);
+	RUN_TEST(test_pio_apply_config, 30);
 	HORIZONTAL_LINE_BREAK()
 	;
 
@@ -70,6 +272,12 @@ void run_tests(void) {
 	RUN_TEST(test_dacc_disable_channel_1, 40);
 	RUN_TEST(test_dacc_channel_0_disabled2, 40);
 	RUN_TEST(test_dacc_channel_1_disabled2, 40);
+	RUN_TEST(test_dacc_stream, 40);
+	RUN_TEST(test_dacc_dds_fill, 40);
+	RUN_TEST(test_dacc_dds_stream, 40);
+	RUN_TEST(test_dacc_select_channel, 40);
+	RUN_TEST(test_dacc_interleave, 40);
+	RUN_TEST(test_dacc_tagged_stream, 40);
 	HORIZONTAL_LINE_BREAK()
 	;
 
@@ -80,6 +288,16 @@ void run_tests(void) {
 	RUN_TEST(test_adc_channel_status, 50);
 	RUN_TEST(test_adc_set_resolution_10_bit, 50);
 	RUN_TEST(test_adc_set_resolution_12_bit, 50);
+	RUN_TEST(test_adc_stream, 50);
+	RUN_TEST(test_adc_timer_trigger, 50);
+	RUN_TEST(test_adc_sequence, 50);
+	RUN_TEST(test_adc_deinterleave, 50);
+	RUN_TEST(test_adc_boxcar, 50);
+	RUN_TEST(test_adc_cic, 50);
+	RUN_TEST(test_adc_moving_average, 50);
+	RUN_TEST(test_adc_decimator, 50);
+	RUN_TEST(test_adc_compare_window, 50);
+	RUN_TEST(test_adc_burst, 149);
 	HORIZONTAL_LINE_BREAK()
 	;
 
@@ -94,17 +312,36 @@ void run_tests(void) {
 	RUN_TEST(test_pwm_channel_period, 60);
 	RUN_TEST(test_pwm_set_clkx, 60);
 	RUN_TEST(test_pwm_set_frequency, 60);
+	RUN_TEST(test_pwm_set_event_rate, 60);
+	RUN_TEST(test_pwm_solve_timing, 60);
+	RUN_TEST(test_pwm_apply_timing, 60);
+	RUN_TEST(test_pwm_sync_channels, 60);
+	RUN_TEST(test_pwm_sync_dma, 60);
+	RUN_TEST(test_pwm_dead_time, 60);
+	RUN_TEST(test_pwm_fault, 60);
+	RUN_TEST(test_pwm_event_compare, 60);
+	RUN_TEST(test_pwm_set_duty_cycles, 60);
 
 	// Run TC tests
 	Unity.TestFile = "test/test_tc.c";
 	RUN_TEST(test_tc_conf_channel, 70);
 	RUN_TEST(test_tc_conf_block, 70);
+	RUN_TEST(test_tc_mode_values, 70);
 	RUN_TEST(test_tc_enable_clock, 70);
 	RUN_TEST(test_tc_disable_clock, 70);
 	RUN_TEST(test_tc_start_clock, 70);
 	RUN_TEST(test_tc_counter_stopped, 70);
 	RUN_TEST(test_tc_read_counter_value, 70);
 	RUN_TEST(test_tc_sync, 70);
+	RUN_TEST(test_tc_calc_rate, 70);
+	RUN_TEST(test_tc_set_trigger_rate, 70);
+	RUN_TEST(test_tc_timestamp, 70);
+	RUN_TEST(test_tc_timestamp_to_ns, 70);
+	RUN_TEST(test_tc_capture_start, 70);
+	RUN_TEST(test_tc_capture_measure, 70);
+	RUN_TEST(test_tc_qdec_init, 70);
+	RUN_TEST(test_tc_qdec_callback, 70);
+	RUN_TEST(test_tc_timer, 70);
 	RUN_TEST(test_register, 70);
 	HORIZONTAL_LINE_BREAK()
 	;
@@ -116,7 +353,15 @@ void run_tests(void) {
 	RUN_TEST(test_twi_set_internal_address, 90);
 	RUN_TEST(test_twi_set_clock_invalid_parameters, 90);
 	RUN_TEST(test_twi_set_clock_valid_parameters, 90);
+	RUN_TEST(test_twi_calc_clock, 90);
+	RUN_TEST(test_twi_set_clock_exact, 90);
+	RUN_TEST(test_twi_master_async_invalid_parameters, 90);
+	RUN_TEST(test_twi_master_async_nack, 90);
+	RUN_TEST(test_twi_master_dma_nack, 90);
+	RUN_TEST(test_twi_slave_start_stop, 90);
+	RUN_TEST(test_twi_bus_nack_recovery, 90);
 	//RUN_TEST(test_twi_send_receive_SEMI_AUTOMATIC, 90);
+	//RUN_TEST(test_twi_slave_register_map_SEMI_AUTOMATIC, 90);
 	HORIZONTAL_LINE_BREAK()
 	;
 
@@ -137,6 +382,31 @@ void run_tests(void) {
 	RUN_TEST(test_spi_variable_bit_lenght_transmission, 100);
 	RUN_TEST(test_spi_polarity_phase_change, 100);
 	RUN_TEST(test_spi_baud_rate_change, 100);
+	RUN_TEST(test_spi_transfer_dma, 100);
+	RUN_TEST(test_spi_dma_benchmark, 100);
+	RUN_TEST(test_spi_bench_transfer, 100);
+	RUN_TEST(test_spi_queue, 100);
+	RUN_TEST(test_spi_tdr_words, 100);
+	RUN_TEST(test_spi_selector_value, 100);
+	RUN_TEST(test_spi_variable_ps_dma, 100);
+	RUN_TEST(test_spi_transfer_req, 100);
+	RUN_TEST(test_spi_slave_settings, 145);
+	HORIZONTAL_LINE_BREAK()
+	;
+
+	// Run acquisition tests, SPI0 is still in loopback
+	Unity.TestFile = "test/test_acq.c";
+	RUN_TEST(test_acq_add, 147);
+	RUN_TEST(test_acq_spi_loopback, 147);
+	HORIZONTAL_LINE_BREAK()
+	;
+
+	// Run DMAC tests
+	Unity.TestFile = "test/test_dmac.c";
+	RUN_TEST(test_dmac_channel_alloc, 105);
+	RUN_TEST(test_dmac_mem2mem, 105);
+	RUN_TEST(test_dmac_chain, 105);
+	RUN_TEST(test_dmac_ping_pong, 105);
 	HORIZONTAL_LINE_BREAK()
 	;
 
@@ -145,12 +415,119 @@ void run_tests(void) {
 	test_tft_setup();
 	RUN_TEST(test_tft_set_bus, 110);
 	RUN_TEST(test_tft_clear_bus, 110);
+	RUN_TEST(test_tft_bus_benchmark, 110);
 	//test_tft_setup2();
 	RUN_TEST(test_tft_init, 110);
 	RUN_TEST(test_tft_clear, 110);
 	RUN_TEST(test_tft_write, 110);
+	RUN_TEST(test_tft_fill_rect, 110);
+	RUN_TEST(test_tft_bench_fill, 110);
+	RUN_TEST(test_tft_bench_set_xy, 110);
+	RUN_TEST(test_tft_write_span, 110);
+	RUN_TEST(test_tft_draw_string, 110);
+	RUN_TEST(test_tft_draw_rle, 110);
+	RUN_TEST(test_tft_smc, 110);
+	RUN_TEST(test_tft_scroll, 110);
+	RUN_TEST(test_tft_touch, 110);
+	HORIZONTAL_LINE_BREAK()
+	;
+
+	// Run TFT framebuffer tests
+	Unity.TestFile = "test/test_tft_fb.c";
+	RUN_TEST(test_tft_fb_init, 120);
+	RUN_TEST(test_tft_fb_init_too_large, 120);
+	RUN_TEST(test_tft_fb_write_marks_tile, 120);
+	RUN_TEST(test_tft_fb_fill_rect_marks_tiles, 120);
+	RUN_TEST(test_tft_fb_flush, 120);
+	HORIZONTAL_LINE_BREAK()
+	;
+
+	// Run CAN tests
+	Unity.TestFile = "test/test_can.c";
+	RUN_TEST(test_can_init, 125);
+	RUN_TEST(test_can_mailboxes, 125);
+	HORIZONTAL_LINE_BREAK()
+	;
+
+	// Run USB CDC tests
+	Unity.TestFile = "test/test_usb_cdc.c";
+	RUN_TEST(test_usb_cdc_init, 127);
+	RUN_TEST(test_usb_cdc_write_without_host, 127);
+	HORIZONTAL_LINE_BREAK()
+	;
+
+	// Run EMAC tests
+	Unity.TestFile = "test/test_emac.c";
+	RUN_TEST(test_emac_init, 129);
+	RUN_TEST(test_emac_send, 129);
+	HORIZONTAL_LINE_BREAK()
+	;
+
+	// Run HSMCI tests
+	Unity.TestFile = "test/test_hsmci.c";
+	RUN_TEST(test_hsmci_no_card, 131);
+	HORIZONTAL_LINE_BREAK()
+	;
+
+	// Run control loop tests
+	Unity.TestFile = "test/test_ctrl_loop.c";
+	RUN_TEST(test_ctrl_loop_invalid, 133);
+	RUN_TEST(test_ctrl_loop_run, 133);
+	HORIZONTAL_LINE_BREAK()
+	;
+
+	// Run DSP tests
+	Unity.TestFile = "test/test_dsp.c";
+	RUN_TEST(test_dsp_fir, 135);
+	RUN_TEST(test_dsp_biquad, 135);
+	RUN_TEST(test_dsp_fft, 135);
+	RUN_TEST(test_dsp_rms_peak, 135);
+	HORIZONTAL_LINE_BREAK()
+	;
+
+	// Run bit-band tests
+	Unity.TestFile = "test/test_bitband.c";
+	RUN_TEST(test_bitband_sram, 137);
+	RUN_TEST(test_bitband_register, 137);
+	HORIZONTAL_LINE_BREAK()
+	;
+
+	// Run CRC tests
+	Unity.TestFile = "test/test_crc.c";
+	RUN_TEST(test_crc_check_values, 141);
+	RUN_TEST(test_crc_pieces, 141);
+	RUN_TEST(test_crc_table_init, 141);
+	RUN_TEST(test_crc_bench, 141);
+	HORIZONTAL_LINE_BREAK()
+	;
+
+	// Run ring buffer tests
+	Unity.TestFile = "test/test_ring.c";
+	RUN_TEST(test_ring_push_pop, 143);
+	RUN_TEST(test_ring_bulk, 143);
+	RUN_TEST(test_ring_spans, 143);
+	RUN_TEST(test_ring_mpsc, 143);
+	HORIZONTAL_LINE_BREAK()
+	;
+
+	// Run benchmarks
+	Unity.TestFile = "test/test_bench.c";
+	RUN_TEST(test_bench_gpio_toggle, 130);
+	RUN_TEST(test_bench_uart_loopback, 130);
+	RUN_TEST(test_bench_dsp, 130);
+	HORIZONTAL_LINE_BREAK()
+	;
+
+	// Run interrupt latency benchmarks
+	Unity.TestFile = "test/test_latency.c";
+	RUN_TEST(test_latency_idle, 139);
+	RUN_TEST(test_latency_uart, 139);
+	RUN_TEST(test_latency_spi_dma, 139);
 	HORIZONTAL_LINE_BREAK()
 	;
 
 	UnityEnd();
+	test_summary();
+	TEST_GPBR_RUNNING = 0;
+	unity_output_flush();
 }
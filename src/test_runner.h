@@ -10,11 +10,15 @@
 #ifndef TEST_RUNNER_H_
 #define TEST_RUNNER_H_
 
-#include "sam3x8e/uart.h"
+#include "unity/unity_output.h"
 
 #define HORIZONTAL_LINE_BREAK()	\
-	uart_write_str("-----------------------\n\r");
+	unity_output_str("-----------------------\n\r");
 
+/*
+ * Runs the tests and prints a summary of the cycles of each test, flagging
+ * the ones slower than their baseline in test_runner.c.
+ */
 void run_tests(void);
 
 #endif
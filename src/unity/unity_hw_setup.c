@@ -7,12 +7,16 @@
  */
 
 #include "unity_hw_setup.h"
-#include "sam3x8e/eefc.h"
 #include "sam3x8e/pmc.h"
 #include "sam3x8e/pio.h"
 #include "sam3x8e/uart.h"
 #include "sam3x8e/wdt.h"
 
+static const pio_pin_cfg_t uart_pins[] = {
+	{PIOA, 8, PIO_CFG_PERIPH_A, PIO_CFG_PULLUP},	//RX0
+	{PIOA, 9, PIO_CFG_PERIPH_A, 0}					//TX0
+};
+
 static void configure_uart(void) {
 	const uart_settings_t uart_settings = {
 		.baud_rate = 115200,
@@ -21,29 +25,28 @@ static void configure_uart(void) {
 	};
 
 	// enable Peripheral Clock for UART.
-	pmc_enable_peripheral_clock(ID_UART);
+	pmc_acquire_peripheral_clock(ID_UART);
 
-	// remove the pins from under the control of PIO
-	pio_disable_pin(PIOA, 8);	//RX0
-	pio_disable_pin(PIOA, 9);	//TX0
+	// hand the pins over to the UART (peripheral A)
+	pio_apply_config(uart_pins, 2);
 
 	// initialize UART
 	uart_init(&uart_settings);
 }
 
 void unity_hw_setup(void) {
-	/*
-	 * Set Flash Wait State, by defining the number of cycles
-	 * for read and write operations: FWS + 1
-	 */
-	eefc_set_flash_wait_state(EEFC0, 4);
-	eefc_set_flash_wait_state(EEFC1, 4);
-
-	// initialize system clock
-	pmc_init_system_clock();
+	// start the system clock, the crystal starts while the rest is set up
+	pmc_start_system_clock();
 
-	// disable the watchdog timer
+	// the watchdog ends a test that hangs, the runner restarts it per test
+#if UNITY_TEST_TIMEOUT_MS
+	wdt_init(UNITY_TEST_TIMEOUT_MS, UNITY_TEST_TIMEOUT_MS);
+#else
 	wdt_disable();
+#endif
+
+	// wait for the system clock, it sets the Flash Wait States
+	pmc_finish_system_clock();
 
 	// configure UART so Unity can use USB/RS-232 as output
 	configure_uart();
@@ -9,6 +9,16 @@
 #ifndef UNITY_HW_SETUP_H_
 #define UNITY_HW_SETUP_H_
 
+/*
+ * Longest time a test may run, in ms (4-16000). The watchdog resets the
+ * board when a test takes longer and the runner goes on with the next test.
+ * Set to 0 to disable the watchdog, e.g. when stepping with a debugger
+ * (it halts with the core anyway).
+ */
+#ifndef UNITY_TEST_TIMEOUT_MS
+#define UNITY_TEST_TIMEOUT_MS	(15000)
+#endif
+
 void unity_hw_setup(void);
 
 #endif
@@ -242,11 +242,10 @@ typedef UNITY_DOUBLE_TYPE _UD;
  * Originally this macro function was using 'putchar()',
  * which is defined in stdio.h
  * Modified by Mathias Beckius 2014-09-28
+ * Buffered, sent with the PDC between the tests (see unity_output.h)
  */
-#define UNITY_OUTPUT_CHAR(a) {	\
-	while (!uart_tx_ready());	\
-	uart_write_char(a);			\
-}
+#include "unity_output.h"
+#define UNITY_OUTPUT_CHAR(a) unity_output_char(a)
 	
 #else
 //If defined as something else, make sure we declare it here so it's ready for use
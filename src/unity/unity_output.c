@@ -0,0 +1,35 @@
+/*
+ * unity_output.c
+ *
+ * Date:	14 October 2026
+ */
+
+#include "unity_output.h"
+#include "sam3x8e/uart.h"
+
+static char buffer[UNITY_OUTPUT_SIZE];
+static uint32_t length;
+
+void unity_output_char(char chr) {
+	if (length == UNITY_OUTPUT_SIZE) {
+		unity_output_flush();
+	}
+	buffer[length++] = chr;
+}
+
+void unity_output_str(const char *str) {
+	while (*str != '\0') {
+		unity_output_char(*str++);
+	}
+}
+
+void unity_output_flush(void) {
+	if (length > 0 && uart_write_dma(buffer, length, 0)) {
+		while (uart_write_dma_busy()) {
+		}
+	}
+	length = 0;
+	// the transmitter still shifts out the last character
+	while (!(PERIPH_REG(UART->UART_SR) & UART_SR_TXEMPTY)) {
+	}
+}
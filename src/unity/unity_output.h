@@ -0,0 +1,32 @@
+/*
+ * unity_output.h
+ *
+ * Buffered output of Unity. The characters are collected in RAM while a
+ * test runs and sent with the PDC of the UART (uart_write_dma()) between
+ * the tests, so printing does not stall the tests or add to their cycle
+ * counts. The UART tests reconfigure the UART, so the runner flushes before
+ * each test and the UART is idle while a test runs.
+ *
+ * Date:	14 October 2026
+ */
+
+#ifndef UNITY_OUTPUT_H_
+#define UNITY_OUTPUT_H_
+
+#include <inttypes.h>
+
+// Characters buffered before a flush is forced, e.g. by a long report
+#ifndef UNITY_OUTPUT_SIZE
+#define UNITY_OUTPUT_SIZE	(4096)
+#endif
+
+// Adds a character to the buffer, flushes first if it is full.
+void unity_output_char(char chr);
+
+// Adds a string to the buffer, as is (CR and LF are not escaped).
+void unity_output_str(const char *str);
+
+// Sends the buffer and waits until the last character has left the UART.
+void unity_output_flush(void);
+
+#endif